@@ -0,0 +1,589 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisCpuDispatchBenchmark.h"
+
+#include <simpletest.h>
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+
+#include <KisSupportedArchitectures.h>
+#include <KoMultiArchBuildSupport.h>
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpaceTraits.h>
+#include <KoColorModelStandardIds.h>
+#include <KoCompositeOp.h>
+#include <KoCompositeOpAlphaDarken.h>
+#include <KoCompositeOpOver.h>
+#include <KoCompositeOpCopy2.h>
+#include <KoAlphaDarkenParamsWrapper.h>
+#include <KoOptimizedCompositeOpFactory.h>
+#include <KoAlphaMaskApplicatorFactory.h>
+#include <KoAlphaMaskApplicatorFactoryImpl.h>
+#include <KoOptimizedPixelDataScalerU8ToU16.h>
+#include <KoOptimizedPixelDataScalerU8ToU16Factory.h>
+#include <KoMixColorsOpImpl.h>
+#include <KoOptimizedMixColorsOpFactory.h>
+
+#include "kis_fixed_paint_device.h"
+#include "kis_brush_mask_applicator_base.h"
+#include "kis_circle_mask_generator.h"
+#include "kis_rect_mask_generator.h"
+#include "kis_gauss_circle_mask_generator.h"
+#include "kis_gauss_rect_mask_generator.h"
+#include "kis_curve_circle_mask_generator.h"
+#include "kis_curve_rect_mask_generator.h"
+#include "kis_cubic_curve.h"
+#include "krita_utils.h"
+#include "kis_debug.h"
+
+#include "KisCpuDispatchBenchmarkKernels.h"
+
+namespace {
+
+const int IMG_WIDTH = 1024;
+const int IMG_HEIGHT = 1024;
+const int TILE_SIZE = 64;
+
+QString runName(const QString &kernel, bool dispatched)
+{
+    return QString("%1 %2").arg(kernel, dispatched ? "dispatched" : "scalar");
+}
+
+QString dispatchedArchName()
+{
+    return KisSupportedArchitectures::bestArchName();
+}
+
+const KoColorSpace *rgbaColorSpace(const KoID &depthId)
+{
+    return KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), depthId.id(), "");
+}
+
+void fillRandomPixels(quint8 *data, int numPixels, const KoColorSpace *cs, std::mt19937 &gen)
+{
+    if (cs->colorDepthId() == Float32BitsColorDepthID) {
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        float *ptr = reinterpret_cast<float*>(data);
+        std::generate(ptr, ptr + numPixels * cs->channelCount(), [&] () { return dist(gen); });
+    } else {
+        std::uniform_int_distribution<int> dist(0, 255);
+        std::generate(data, data + numPixels * cs->pixelSize(), [&] () { return quint8(dist(gen)); });
+    }
+}
+
+template<class Traits>
+KoCompositeOp *createScalarCompositeOp(const QString &opId, const KoColorSpace *cs)
+{
+    if (opId == "over") {
+        return new KoCompositeOpOver<Traits>(cs);
+    } else if (opId == "alphadarken-hard") {
+        return new KoCompositeOpAlphaDarken<Traits, KoAlphaDarkenParamsWrapperHard>(cs);
+    } else if (opId == "alphadarken-creamy") {
+        return new KoCompositeOpAlphaDarken<Traits, KoAlphaDarkenParamsWrapperCreamy>(cs);
+    }
+
+    return new KoCompositeOpCopy2<Traits>(cs);
+}
+
+KoCompositeOp *createScalarCompositeOp(const QString &opId, const KoID &depthId, const KoColorSpace *cs)
+{
+    if (depthId == Integer8BitsColorDepthID) {
+        return createScalarCompositeOp<KoBgrU8Traits>(opId, cs);
+    } else if (depthId == Integer16BitsColorDepthID) {
+        return createScalarCompositeOp<KoBgrU16Traits>(opId, cs);
+    }
+
+    return createScalarCompositeOp<KoRgbF32Traits>(opId, cs);
+}
+
+KoCompositeOp *createDispatchedCompositeOp(const QString &opId, const KoID &depthId, const KoColorSpace *cs)
+{
+    using Factory = KoOptimizedCompositeOpFactory;
+    using FactoryFunc = KoCompositeOp* (*)(const KoColorSpace*);
+
+    const int index =
+        depthId == Integer8BitsColorDepthID ? 0 :
+        depthId == Integer16BitsColorDepthID ? 1 : 2;
+
+    FactoryFunc func = nullptr;
+
+    if (opId == "over") {
+        const FactoryFunc funcs[] = {&Factory::createOverOp32, &Factory::createOverOpU64, &Factory::createOverOp128};
+        func = funcs[index];
+    } else if (opId == "alphadarken-hard") {
+        const FactoryFunc funcs[] = {&Factory::createAlphaDarkenOpHard32, &Factory::createAlphaDarkenOpHardU64, &Factory::createAlphaDarkenOpHard128};
+        func = funcs[index];
+    } else if (opId == "alphadarken-creamy") {
+        const FactoryFunc funcs[] = {&Factory::createAlphaDarkenOpCreamy32, &Factory::createAlphaDarkenOpCreamyU64, &Factory::createAlphaDarkenOpCreamy128};
+        func = funcs[index];
+    } else {
+        const FactoryFunc funcs[] = {&Factory::createCopyOp32, &Factory::createCopyOpU64, &Factory::createCopyOp128};
+        func = funcs[index];
+    }
+
+    return func(cs);
+}
+
+template<class MaskGenerator, typename... Args>
+MaskGenerator *createMaskGenerator(bool dispatched, Args&&... args)
+{
+    MaskGenerator *generator = new MaskGenerator(std::forward<Args>(args)...);
+    if (!dispatched) {
+        generator->setMaskScalarApplicator();
+    }
+    return generator;
+}
+
+KisMaskGenerator *createMaskGenerator(const QString &generatorId, bool dispatched)
+{
+    const qreal diameter = 1000;
+    const qreal ratio = 1.0;
+    const qreal fade = 0.5;
+    const int spikes = 2;
+    const bool antialias = true;
+
+    const KisCubicCurve curve(QString("0,1;1,0"));
+
+    if (generatorId == "circle") {
+        return createMaskGenerator<KisCircleMaskGenerator>(dispatched, diameter, ratio, fade, fade, spikes, antialias);
+    } else if (generatorId == "rect") {
+        return createMaskGenerator<KisRectangleMaskGenerator>(dispatched, diameter, ratio, fade, fade, spikes, antialias);
+    } else if (generatorId == "gauss-circle") {
+        return createMaskGenerator<KisGaussCircleMaskGenerator>(dispatched, diameter, ratio, fade, fade, spikes, antialias);
+    } else if (generatorId == "gauss-rect") {
+        return createMaskGenerator<KisGaussRectangleMaskGenerator>(dispatched, diameter, ratio, fade, fade, spikes, antialias);
+    } else if (generatorId == "curve-circle") {
+        return createMaskGenerator<KisCurveCircleMaskGenerator>(dispatched, diameter, ratio, fade, fade, spikes, curve, antialias);
+    }
+
+    return createMaskGenerator<KisCurveRectangleMaskGenerator>(dispatched, diameter, ratio, fade, fade, spikes, curve, antialias);
+}
+
+KoAlphaMaskApplicatorBase *createScalarAlphaMaskApplicator(const KoID &depthId)
+{
+    if (depthId == Integer8BitsColorDepthID) {
+        return KoAlphaMaskApplicatorFactoryImpl<quint8, 4, 3>::create<xsimd::generic>();
+    } else if (depthId == Integer16BitsColorDepthID) {
+        return KoAlphaMaskApplicatorFactoryImpl<quint16, 4, 3>::create<xsimd::generic>();
+    }
+
+    return KoAlphaMaskApplicatorFactoryImpl<float, 4, 3>::create<xsimd::generic>();
+}
+
+KoMixColorsOp *createScalarMixColorsOp(const KoID &depthId)
+{
+    if (depthId == Integer8BitsColorDepthID) {
+        return new KoMixColorsOpImpl<KoBgrU8Traits>();
+    } else if (depthId == Integer16BitsColorDepthID) {
+        return new KoMixColorsOpImpl<KoBgrU16Traits>();
+    }
+
+    return new KoMixColorsOpImpl<KoRgbF32Traits>();
+}
+
+}
+
+template <typename Func>
+void KisCpuDispatchBenchmark::measure(const QString &kernel, const QString &isa, bool dispatched,
+                                      qint64 pixelsPerRun, Func func)
+{
+    QElapsedTimer timer;
+    qint64 elapsedNsecs = 0;
+    qint64 numPixels = 0;
+
+    QBENCHMARK {
+        timer.start();
+        func();
+        elapsedNsecs += timer.nsecsElapsed();
+        numPixels += pixelsPerRun;
+    }
+
+    // megapixels (or megavalues) per second
+    const double throughput = elapsedNsecs > 0 ? numPixels * 1000.0 / elapsedNsecs : 0.0;
+
+    if (!m_reports.contains(kernel)) {
+        m_kernels << kernel;
+    }
+
+    KernelReport &report = m_reports[kernel];
+
+    if (dispatched) {
+        report.isa = isa;
+        report.dispatchedThroughput = throughput;
+    } else {
+        report.scalarThroughput = throughput;
+    }
+}
+
+void KisCpuDispatchBenchmark::initTestCase()
+{
+    qDebug() << "Compiled for:" << KisSupportedArchitectures::baseArchName();
+    qDebug() << "Supported by CPU:" << KisSupportedArchitectures::supportedInstructionSets();
+    qDebug() << "Selected for dispatch:" << KisSupportedArchitectures::bestArchName();
+}
+
+void KisCpuDispatchBenchmark::cleanupTestCase()
+{
+    qDebug().noquote() << "";
+    qDebug().noquote() << "CPU dispatch coverage, throughput in Mpx/s (Mvalues/s for transfer functions)";
+    qDebug().noquote() << QString("%1 %2 %3 %4 %5")
+                          .arg("kernel", -56)
+                          .arg("dispatched ISA", -32)
+                          .arg("scalar", 10)
+                          .arg("dispatched", 10)
+                          .arg("speedup", 8);
+
+    Q_FOREACH (const QString &kernel, m_kernels) {
+        const KernelReport &report = m_reports[kernel];
+
+        const double speedup = report.scalarThroughput > 0 ?
+            report.dispatchedThroughput / report.scalarThroughput : 0.0;
+
+        qDebug().noquote() << QString("%1 %2 %3 %4 %5x")
+                              .arg(kernel, -56)
+                              .arg(report.isa, -32)
+                              .arg(report.scalarThroughput, 10, 'f', 1)
+                              .arg(report.dispatchedThroughput, 10, 'f', 1)
+                              .arg(speedup, 7, 'f', 2);
+    }
+}
+
+void KisCpuDispatchBenchmark::benchmarkCompositeOps_data()
+{
+    QTest::addColumn<QString>("opId");
+    QTest::addColumn<KoID>("depthId");
+    QTest::addColumn<bool>("dispatched");
+
+    const QStringList ops = {"over", "alphadarken-hard", "alphadarken-creamy", "copy"};
+    const QList<KoID> depths = {Integer8BitsColorDepthID, Integer16BitsColorDepthID, Float32BitsColorDepthID};
+
+    Q_FOREACH (const QString &opId, ops) {
+        Q_FOREACH (const KoID &depthId, depths) {
+            for (bool dispatched : {false, true}) {
+                const QString kernel = QString("composite %1 %2").arg(opId, depthId.id());
+                QTest::newRow(runName(kernel, dispatched).toLatin1().data()) << opId << depthId << dispatched;
+            }
+        }
+    }
+}
+
+void KisCpuDispatchBenchmark::benchmarkCompositeOps()
+{
+    QFETCH(QString, opId);
+    QFETCH(KoID, depthId);
+    QFETCH(bool, dispatched);
+
+    const KoColorSpace *cs = rgbaColorSpace(depthId);
+    const int pixelSize = cs->pixelSize();
+    const int numPixels = IMG_WIDTH * IMG_HEIGHT;
+
+    std::mt19937 gen(42);
+
+    QVector<quint8> src(numPixels * pixelSize);
+    QVector<quint8> dst(numPixels * pixelSize);
+    QVector<quint8> mask(numPixels);
+
+    fillRandomPixels(src.data(), numPixels, cs, gen);
+    fillRandomPixels(dst.data(), numPixels, cs, gen);
+    std::generate(mask.begin(), mask.end(), [&gen] () { return quint8(gen() & 0xff); });
+
+    QScopedPointer<KoCompositeOp> op(dispatched ?
+        createDispatchedCompositeOp(opId, depthId, cs) :
+        createScalarCompositeOp(opId, depthId, cs));
+
+    const int rowStride = IMG_WIDTH * pixelSize;
+
+    KoCompositeOp::ParameterInfo params;
+    params.dstRowStride = rowStride;
+    params.srcRowStride = rowStride;
+    params.maskRowStride = IMG_WIDTH;
+    params.rows = TILE_SIZE;
+    params.cols = TILE_SIZE;
+    params.opacity = 0.5f;
+    params.flow = 0.8f;
+
+    measure(QString("composite %1 %2").arg(opId, depthId.id()), dispatchedArchName(), dispatched, numPixels,
+        [&] () {
+            for (int y = 0; y < IMG_HEIGHT; y += TILE_SIZE) {
+                for (int x = 0; x < IMG_WIDTH; x += TILE_SIZE) {
+                    params.dstRowStart = dst.data() + y * rowStride + x * pixelSize;
+                    params.srcRowStart = src.data() + y * rowStride + x * pixelSize;
+                    params.maskRowStart = mask.data() + y * IMG_WIDTH + x;
+                    op->composite(params);
+                }
+            }
+        });
+}
+
+void KisCpuDispatchBenchmark::benchmarkMaskGenerators_data()
+{
+    QTest::addColumn<QString>("generatorId");
+    QTest::addColumn<bool>("dispatched");
+
+    const QStringList generators = {"circle", "rect", "gauss-circle", "gauss-rect", "curve-circle", "curve-rect"};
+
+    Q_FOREACH (const QString &generatorId, generators) {
+        for (bool dispatched : {false, true}) {
+            const QString kernel = QString("mask generator %1").arg(generatorId);
+            QTest::newRow(runName(kernel, dispatched).toLatin1().data()) << generatorId << dispatched;
+        }
+    }
+}
+
+void KisCpuDispatchBenchmark::benchmarkMaskGenerators()
+{
+    QFETCH(QString, generatorId);
+    QFETCH(bool, dispatched);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+    dev->setRect(QRect(0, 0, 1000, 1000));
+    dev->initialize();
+
+    MaskProcessingData data(dev, cs, nullptr,
+                            0.0, 1.0,
+                            500, 500, 0);
+
+    QScopedPointer<KisMaskGenerator> generator(createMaskGenerator(generatorId, dispatched));
+
+    KisBrushMaskApplicatorBase *applicator = generator->applicator();
+    applicator->initializeData(&data);
+
+    const QVector<QRect> rects = KritaUtils::splitRectIntoPatches(dev->bounds(), QSize(63, 63));
+
+    QString isa = dispatchedArchName();
+    if (!generator->shouldVectorize()) {
+        isa += " (scalar fallback)";
+    }
+
+    measure(QString("mask generator %1").arg(generatorId), isa, dispatched, dev->bounds().width() * dev->bounds().height(),
+        [&] () {
+            Q_FOREACH (const QRect &rc, rects) {
+                applicator->process(rc);
+            }
+        });
+}
+
+void KisCpuDispatchBenchmark::benchmarkAlphaMaskApplicators_data()
+{
+    QTest::addColumn<KoID>("depthId");
+    QTest::addColumn<bool>("fillWithColor");
+    QTest::addColumn<bool>("dispatched");
+
+    const QList<KoID> depths = {Integer8BitsColorDepthID, Integer16BitsColorDepthID, Float32BitsColorDepthID};
+
+    Q_FOREACH (const KoID &depthId, depths) {
+        for (bool fillWithColor : {false, true}) {
+            for (bool dispatched : {false, true}) {
+                const QString kernel = QString("alpha mask %1 %2")
+                    .arg(fillWithColor ? "fillInverseWithColor" : "applyInverse", depthId.id());
+                QTest::newRow(runName(kernel, dispatched).toLatin1().data()) << depthId << fillWithColor << dispatched;
+            }
+        }
+    }
+}
+
+void KisCpuDispatchBenchmark::benchmarkAlphaMaskApplicators()
+{
+    QFETCH(KoID, depthId);
+    QFETCH(bool, fillWithColor);
+    QFETCH(bool, dispatched);
+
+    const KoColorSpace *cs = rgbaColorSpace(depthId);
+    const int numPixels = IMG_WIDTH * IMG_HEIGHT;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    QVector<quint8> pixels(numPixels * cs->pixelSize());
+    QVector<float> alpha(numPixels);
+    QVector<quint8> color(cs->pixelSize());
+
+    fillRandomPixels(pixels.data(), numPixels, cs, gen);
+    fillRandomPixels(color.data(), 1, cs, gen);
+    std::generate(alpha.begin(), alpha.end(), [&] () { return dist(gen); });
+
+    QScopedPointer<KoAlphaMaskApplicatorBase> applicator(dispatched ?
+        KoAlphaMaskApplicatorFactory::create(depthId, 4, 3) :
+        createScalarAlphaMaskApplicator(depthId));
+
+    const QString kernel = QString("alpha mask %1 %2")
+        .arg(fillWithColor ? "fillInverseWithColor" : "applyInverse", depthId.id());
+
+    measure(kernel, dispatchedArchName(), dispatched, numPixels,
+        [&] () {
+            if (fillWithColor) {
+                applicator->fillInverseAlphaNormedFloatMaskWithColor(pixels.data(), alpha.data(), color.data(), numPixels);
+            } else {
+                applicator->applyInverseNormedFloatMask(pixels.data(), alpha.data(), numPixels);
+            }
+        });
+}
+
+void KisCpuDispatchBenchmark::benchmarkPixelDataScaler_data()
+{
+    QTest::addColumn<int>("channelsPerPixel");
+    QTest::addColumn<bool>("toU16");
+    QTest::addColumn<bool>("dispatched");
+
+    for (int channelsPerPixel : {4, 5}) {
+        for (bool toU16 : {true, false}) {
+            for (bool dispatched : {false, true}) {
+                const QString kernel = QString("scaler %1 %2")
+                    .arg(channelsPerPixel == 4 ? "rgba" : "cmyka", toU16 ? "U8->U16" : "U16->U8");
+                QTest::newRow(runName(kernel, dispatched).toLatin1().data()) << channelsPerPixel << toU16 << dispatched;
+            }
+        }
+    }
+}
+
+void KisCpuDispatchBenchmark::benchmarkPixelDataScaler()
+{
+    QFETCH(int, channelsPerPixel);
+    QFETCH(bool, toU16);
+    QFETCH(bool, dispatched);
+
+    const int numPixels = IMG_WIDTH * IMG_HEIGHT;
+
+    std::mt19937 gen(42);
+
+    QVector<quint8> u8Data(numPixels * channelsPerPixel);
+    QVector<quint16> u16Data(numPixels * channelsPerPixel);
+
+    std::generate(u8Data.begin(), u8Data.end(), [&gen] () { return quint8(gen() & 0xff); });
+    std::generate(u16Data.begin(), u16Data.end(), [&gen] () { return quint16(gen() & 0xffff); });
+
+    /**
+     * NOTE: the scalar version is compiled with the baseline flags of the
+     * benchmark, so on NEON platforms it is still vectorized.
+     */
+    QScopedPointer<KoOptimizedPixelDataScalerU8ToU16Base> scaler(
+        dispatched ?
+            (channelsPerPixel == 4 ?
+                 KoOptimizedPixelDataScalerU8ToU16Factory::createRgbaScaler() :
+                 KoOptimizedPixelDataScalerU8ToU16Factory::createCmykaScaler()) :
+            new KoOptimizedPixelDataScalerU8ToU16<xsimd::generic>(channelsPerPixel));
+
+    const QString kernel = QString("scaler %1 %2")
+        .arg(channelsPerPixel == 4 ? "rgba" : "cmyka", toU16 ? "U8->U16" : "U16->U8");
+
+    quint8 *u16Ptr = reinterpret_cast<quint8*>(u16Data.data());
+
+    measure(kernel, dispatchedArchName(), dispatched, numPixels,
+        [&] () {
+            if (toU16) {
+                scaler->convertU8ToU16(u8Data.data(), IMG_WIDTH * channelsPerPixel,
+                                       u16Ptr, IMG_WIDTH * channelsPerPixel * 2,
+                                       IMG_HEIGHT, IMG_WIDTH);
+            } else {
+                scaler->convertU16ToU8(u16Ptr, IMG_WIDTH * channelsPerPixel * 2,
+                                       u8Data.data(), IMG_WIDTH * channelsPerPixel,
+                                       IMG_HEIGHT, IMG_WIDTH);
+            }
+        });
+}
+
+void KisCpuDispatchBenchmark::benchmarkMixColorsOp_data()
+{
+    QTest::addColumn<KoID>("depthId");
+    QTest::addColumn<bool>("dispatched");
+
+    const QList<KoID> depths = {Integer8BitsColorDepthID, Integer16BitsColorDepthID, Float32BitsColorDepthID};
+
+    Q_FOREACH (const KoID &depthId, depths) {
+        for (bool dispatched : {false, true}) {
+            const QString kernel = QString("mix colors %1").arg(depthId.id());
+            QTest::newRow(runName(kernel, dispatched).toLatin1().data()) << depthId << dispatched;
+        }
+    }
+}
+
+void KisCpuDispatchBenchmark::benchmarkMixColorsOp()
+{
+    QFETCH(KoID, depthId);
+    QFETCH(bool, dispatched);
+
+    const KoColorSpace *cs = rgbaColorSpace(depthId);
+    const int numPixels = IMG_WIDTH * IMG_HEIGHT;
+    const int batchSize = 64;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> weightDist(0, 255);
+
+    QVector<quint8> pixels(numPixels * cs->pixelSize());
+    QVector<qint16> weights(batchSize);
+    QVector<quint8> result(cs->pixelSize());
+
+    fillRandomPixels(pixels.data(), numPixels, cs, gen);
+    std::generate(weights.begin(), weights.end(), [&] () { return qint16(weightDist(gen)); });
+    const int weightsSum = std::accumulate(weights.begin(), weights.end(), 0);
+
+    QScopedPointer<KoMixColorsOp> op(dispatched ?
+        KoOptimizedMixColorsOpFactory::createRgbaOp(depthId) :
+        createScalarMixColorsOp(depthId));
+
+    measure(QString("mix colors %1").arg(depthId.id()), dispatchedArchName(), dispatched, numPixels,
+        [&] () {
+            for (int i = 0; i < numPixels; i += batchSize) {
+                op->mixColors(pixels.data() + i * cs->pixelSize(), weights.data(), batchSize, result.data(), weightsSum);
+            }
+        });
+}
+
+void KisCpuDispatchBenchmark::benchmarkTransferFunctions_data()
+{
+    QTest::addColumn<QString>("curveId");
+    QTest::addColumn<bool>("dispatched");
+
+    const QStringList curves = {"PQ", "HLG", "SMPTE 428"};
+
+    Q_FOREACH (const QString &curveId, curves) {
+        for (bool dispatched : {false, true}) {
+            const QString kernel = QString("transfer function remove %1").arg(curveId);
+            QTest::newRow(runName(kernel, dispatched).toLatin1().data()) << curveId << dispatched;
+        }
+    }
+}
+
+void KisCpuDispatchBenchmark::benchmarkTransferFunctions()
+{
+    QFETCH(QString, curveId);
+    QFETCH(bool, dispatched);
+
+    const int numValues = IMG_WIDTH * IMG_HEIGHT;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+    QVector<float> source(numValues);
+    QVector<float> values(numValues);
+    std::generate(source.begin(), source.end(), [&] () { return dist(gen); });
+
+    const KisTransferFunctionKernels kernels = dispatched ?
+        createOptimizedClass<KisTransferFunctionKernelsFactory>() :
+        createScalarClass<KisTransferFunctionKernelsFactory>();
+
+    const KisTransferFunctionKernels::Kernel kernel =
+        curveId == "PQ" ? kernels.removeSmpte2048Curve :
+        curveId == "HLG" ? kernels.removeHLGCurve :
+        kernels.removeSMPTE_ST_428Curve;
+
+    measure(QString("transfer function remove %1").arg(curveId), kernels.archName, dispatched, numValues,
+        [&] () {
+            std::copy(source.begin(), source.end(), values.begin());
+            kernel(values.data(), numValues);
+        });
+}
+
+SIMPLE_TEST_MAIN(KisCpuDispatchBenchmark)
@@ -0,0 +1,65 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISCPUDISPATCHBENCHMARK_H
+#define KISCPUDISPATCHBENCHMARK_H
+
+#include <QObject>
+#include <QMap>
+#include <QStringList>
+
+/**
+ * Lists all the kernels that are dispatched at runtime via
+ * createOptimizedClass(), shows which instruction set every kernel
+ * has been created for on the current CPU and measures its throughput
+ * against the scalar (xsimd::generic) implementation.
+ *
+ * The summary table is printed in cleanupTestCase(). A speedup close
+ * to 1.0 means that the kernel has no vectorized implementation for
+ * the selected instruction set and falls back to the scalar code.
+ */
+class KisCpuDispatchBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkCompositeOps_data();
+    void benchmarkCompositeOps();
+
+    void benchmarkMaskGenerators_data();
+    void benchmarkMaskGenerators();
+
+    void benchmarkAlphaMaskApplicators_data();
+    void benchmarkAlphaMaskApplicators();
+
+    void benchmarkPixelDataScaler_data();
+    void benchmarkPixelDataScaler();
+
+    void benchmarkMixColorsOp_data();
+    void benchmarkMixColorsOp();
+
+    void benchmarkTransferFunctions_data();
+    void benchmarkTransferFunctions();
+
+private:
+    struct KernelReport {
+        QString isa;
+        double scalarThroughput = 0.0;
+        double dispatchedThroughput = 0.0;
+    };
+
+    template <typename Func>
+    void measure(const QString &kernel, const QString &isa, bool dispatched,
+                 qint64 pixelsPerRun, Func func);
+
+private:
+    QStringList m_kernels;
+    QMap<QString, KernelReport> m_reports;
+};
+
+#endif // KISCPUDISPATCHBENCHMARK_H
@@ -0,0 +1,109 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisCpuDispatchBenchmarkKernels.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+
+#include <KoColorTransferFunctions.h>
+
+namespace {
+
+template<typename _impl, typename EnableDummyType = void>
+struct TransferFunctionKernelsImpl
+{
+    template<typename ScalarFunc>
+    static ALWAYS_INLINE void process(float *data, int numValues, ScalarFunc scalarFunc)
+    {
+        for (int i = 0; i < numValues; i++) {
+            data[i] = scalarFunc(data[i]);
+        }
+    }
+
+    static void removeSmpte2048Curve(float *data, int numValues)
+    {
+        process(data, numValues, [] (float x) { return ::removeSmpte2048Curve(x); });
+    }
+
+    static void removeHLGCurve(float *data, int numValues)
+    {
+        process(data, numValues, [] (float x) { return ::removeHLGCurve(x); });
+    }
+
+    static void removeSMPTE_ST_428Curve(float *data, int numValues)
+    {
+        process(data, numValues, [] (float x) { return ::removeSMPTE_ST_428Curve(x); });
+    }
+};
+
+#if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+
+template<typename _impl>
+struct TransferFunctionKernelsImpl<
+    _impl,
+    typename std::enable_if<!std::is_same<_impl, xsimd::generic>::value>::type>
+{
+    using float_v = typename KoColorTransferFunctions<_impl>::float_v;
+
+    template<typename VectorFunc, typename ScalarFunc>
+    static ALWAYS_INLINE void process(float *data, int numValues, VectorFunc vectorFunc, ScalarFunc scalarFunc)
+    {
+        const int vectorBlock = numValues - numValues % static_cast<int>(float_v::size);
+
+        int i = 0;
+        for (; i < vectorBlock; i += static_cast<int>(float_v::size)) {
+            float_v x = float_v::load_unaligned(data + i);
+            vectorFunc(x);
+            x.store_unaligned(data + i);
+        }
+
+        for (; i < numValues; i++) {
+            data[i] = scalarFunc(data[i]);
+        }
+    }
+
+    static void removeSmpte2048Curve(float *data, int numValues)
+    {
+        process(data, numValues,
+                [] (float_v &x) { KoColorTransferFunctions<_impl>::removeSmpte2048Curve(x); },
+                [] (float x) { return ::removeSmpte2048Curve(x); });
+    }
+
+    static void removeHLGCurve(float *data, int numValues)
+    {
+        process(data, numValues,
+                [] (float_v &x) { KoColorTransferFunctions<_impl>::removeHLGCurve(x); },
+                [] (float x) { return ::removeHLGCurve(x); });
+    }
+
+    static void removeSMPTE_ST_428Curve(float *data, int numValues)
+    {
+        process(data, numValues,
+                [] (float_v &x) { KoColorTransferFunctions<_impl>::removeSMPTE_ST_428Curve(x); },
+                [] (float x) { return ::removeSMPTE_ST_428Curve(x); });
+    }
+};
+
+#endif // HAVE_XSIMD
+
+} // namespace
+
+template<typename _impl>
+KisTransferFunctionKernels KisTransferFunctionKernelsFactory::create()
+{
+    using Impl = TransferFunctionKernelsImpl<_impl>;
+
+    KisTransferFunctionKernels kernels;
+    kernels.archName = _impl::name();
+    kernels.removeSmpte2048Curve = &Impl::removeSmpte2048Curve;
+    kernels.removeHLGCurve = &Impl::removeHLGCurve;
+    kernels.removeSMPTE_ST_428Curve = &Impl::removeSMPTE_ST_428Curve;
+    return kernels;
+}
+
+template KisTransferFunctionKernels KisTransferFunctionKernelsFactory::create<xsimd::current_arch>();
+
+#endif // XSIMD_UNIVERSAL_BUILD_PASS
@@ -0,0 +1,37 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISCPUDISPATCHBENCHMARKKERNELS_H
+#define KISCPUDISPATCHBENCHMARKKERNELS_H
+
+#include <QString>
+#include <KoMultiArchBuildSupport.h>
+
+/**
+ * The transfer functions from KoColorTransferFunctions.h are not
+ * dispatched by the core libraries, they are inlined into per-arch
+ * code of the import plugins. This factory compiles the same inline
+ * functions for every architecture, so that the dispatch benchmark
+ * can measure them.
+ */
+struct KisTransferFunctionKernels
+{
+    using Kernel = void (*)(float *data, int numValues);
+
+    QString archName;
+    Kernel removeSmpte2048Curve = nullptr;
+    Kernel removeHLGCurve = nullptr;
+    Kernel removeSMPTE_ST_428Curve = nullptr;
+};
+
+class KisTransferFunctionKernelsFactory
+{
+public:
+    template<typename _impl>
+    static KisTransferFunctionKernels create();
+};
+
+#endif // KISCPUDISPATCHBENCHMARKKERNELS_H
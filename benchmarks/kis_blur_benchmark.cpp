@@ -25,6 +25,10 @@
 #include "kis_selection.h"
 #include <kis_iterator_ng.h>
 #include <KisGlobalResourcesInterface.h>
+#include <kis_gaussian_kernel.h>
+#include <KisRecursiveGaussian.h>
+#include <kis_transaction.h>
+#include <kis_convolution_painter.h>
 
 void KisBlurBenchmark::initTestCase()
 {
@@ -77,5 +81,39 @@ void KisBlurBenchmark::benchmarkFilter()
 }
 
 
+void KisBlurBenchmark::benchmarkGaussian_data()
+{
+    QTest::addColumn<qreal>("radius");
+    QTest::addColumn<bool>("useRecursive");
+
+    for (qreal radius : {10.0, 50.0, 200.0}) {
+        QTest::addRow("convolution_%d", int(radius)) << radius << false;
+        QTest::addRow("recursive_%d", int(radius)) << radius << true;
+    }
+}
+
+void KisBlurBenchmark::benchmarkGaussian()
+{
+    QFETCH(qreal, radius);
+    QFETCH(bool, useRecursive);
+
+    const QRect rect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+    const QBitArray channelFlags = m_colorSpace->channelFlags(true, true);
+
+    QBENCHMARK {
+        KisTransaction transaction(m_device);
+
+        if (useRecursive) {
+            KisRecursiveGaussian::apply(m_device, rect, radius, radius, channelFlags, 0, BORDER_IGNORE);
+        } else {
+            KisConvolutionKernelSP kernel = KisGaussianKernel::createUniform2DKernel(radius, radius);
+            KisConvolutionPainter painter(m_device);
+            painter.setChannelFlags(channelFlags);
+            painter.applyMatrix(kernel, m_device, rect.topLeft(), rect.topLeft(), rect.size(), BORDER_IGNORE);
+        }
+
+        transaction.revert();
+    }
+}
 
 SIMPLE_TEST_MAIN(KisBlurBenchmark)
@@ -30,6 +30,8 @@
 #include <KoCompositeOpCopy2.h>
 #include <KoOptimizedCompositeOpFactory.h>
 #include <KoAlphaDarkenParamsWrapper.h>
+#include <KoColorModelStandardIds.h>
+#include <KoConfig.h>
 
 // for posix_memalign()
 #include <stdlib.h>
@@ -162,6 +164,27 @@ struct RandomGenerator<double> : RandomGenerator<float>
     }
 };
 
+#ifdef HAVE_OPENEXR
+template <>
+struct RandomGenerator<half>
+{
+    RandomGenerator(int seed)
+        : m_rnd(seed)
+    {
+    }
+
+    half operator() () {
+        return half(m_rnd());
+    }
+
+    half unit() {
+        return KoColorSpaceMathsTraits<half>::unitValue;
+    }
+
+    RandomGenerator<float> m_rnd;
+};
+#endif
+
 
 template <typename channel_type>
 void generateDataLine(uint seed, int numPixels, quint8 *srcPixels, quint8 *dstPixels, quint8 *mask, AlphaRange srcAlphaRange, AlphaRange dstAlphaRange)
@@ -227,7 +250,8 @@ QVector<Tile> generateTiles(int size,
                             const int dstAlignmentShift,
                             AlphaRange srcAlphaRange,
                             AlphaRange dstAlphaRange,
-                            const quint32 pixelSize)
+                            const quint32 pixelSize,
+                            bool halfFloat = false)
 {
     QVector<Tile> tiles(size);
 
@@ -260,6 +284,12 @@ QVector<Tile> generateTiles(int size,
 
         if (pixelSize == 4) {
             generateDataLine<quint8>(1, numPixels, tiles[i].src, tiles[i].dst, tiles[i].mask, srcAlphaRange, dstAlphaRange);
+        } else if (pixelSize == 8 && halfFloat) {
+#ifdef HAVE_OPENEXR
+            generateDataLine<half>(1, numPixels, tiles[i].src, tiles[i].dst, tiles[i].mask, srcAlphaRange, dstAlphaRange);
+#else
+            qFatal("Half-float pixels are not supported by the build");
+#endif
         } else if (pixelSize == 8) {
             generateDataLine<quint16>(1, numPixels, tiles[i].src, tiles[i].dst, tiles[i].mask, srcAlphaRange, dstAlphaRange);
         } else if (pixelSize == 16) {
@@ -364,8 +394,9 @@ bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp
 {
     Q_ASSERT(op1->colorSpace()->pixelSize() == op2->colorSpace()->pixelSize());
     const quint32 pixelSize = op1->colorSpace()->pixelSize();
+    const bool halfFloat = op1->colorSpace()->colorDepthId() == Float16BitsColorDepthID;
     const int alignment = 16;
-    QVector<Tile> tiles = generateTiles(2, alignment, alignment, ALPHA_RANDOM, ALPHA_RANDOM, op1->colorSpace()->pixelSize());
+    QVector<Tile> tiles = generateTiles(2, alignment, alignment, ALPHA_RANDOM, ALPHA_RANDOM, pixelSize, halfFloat);
 
     KoCompositeOp::ParameterInfo params;
     params.dstRowStride  = 4 * rowStride;
@@ -392,6 +423,13 @@ bool compareTwoOps(bool haveMask, const KoCompositeOp *op1, const KoCompositeOp
     if (pixelSize == 4) {
         compareResult = compareTwoOpsPixels<quint8, Compare>(tiles, 10);
     }
+    else if (pixelSize == 8 && halfFloat) {
+#ifdef HAVE_OPENEXR
+        // the generic version rounds every intermediate result to half,
+        // the optimized one only the final value
+        compareResult = compareTwoOpsPixels<half, Compare>(tiles, half(5e-3f));
+#endif
+    }
     else if (pixelSize == 8) {
         compareResult = compareTwoOpsPixels<quint16, Compare>(tiles, 90);
     }
@@ -448,7 +486,8 @@ void benchmarkCompositeOp(const KoCompositeOp *op,
     QString testName = getTestName(haveMask, srcAlignmentShift, dstAlignmentShift, srcAlphaRange, dstAlphaRange);
 
     QVector<Tile> tiles =
-        generateTiles(numTiles, srcAlignmentShift, dstAlignmentShift, srcAlphaRange, dstAlphaRange, op->colorSpace()->pixelSize());
+        generateTiles(numTiles, srcAlignmentShift, dstAlignmentShift, srcAlphaRange, dstAlphaRange, op->colorSpace()->pixelSize(),
+                      op->colorSpace()->colorDepthId() == Float16BitsColorDepthID);
 
     const int tileOffset = 4 * (processRect.y() * rowStride + processRect.x());
 
@@ -845,6 +884,54 @@ void KisCompositionBenchmark::compareRgbF32OverOps()
     delete opAct;
 }
 
+void KisCompositionBenchmark::compareRgbF16AlphaDarkenOps()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createAlphaDarkenOpCreamyF16(cs);
+    KoCompositeOp *opExp = new KoCompositeOpAlphaDarken<KoRgbF16Traits, KoAlphaDarkenParamsWrapperCreamy>(cs);
+
+    QVERIFY(compareTwoOps(true, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+#else
+    QSKIP("Half-float color spaces are not supported by the build");
+#endif
+}
+
+void KisCompositionBenchmark::compareRgbF16OverOps()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createOverOpF16(cs);
+    KoCompositeOp *opExp = new KoCompositeOpOver<KoRgbF16Traits>(cs);
+
+    QVERIFY(compareTwoOps(false, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+#else
+    QSKIP("Half-float color spaces are not supported by the build");
+#endif
+}
+
+void KisCompositionBenchmark::compareRgbF16CopyOps()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *opAct = KoOptimizedCompositeOpFactory::createCopyOpF16(cs);
+    KoCompositeOp *opExp = new KoCompositeOpCopy2<KoRgbF16Traits>(cs);
+
+    QVERIFY(compareTwoOps(false, opAct, opExp));
+
+    delete opExp;
+    delete opAct;
+#else
+    QSKIP("Half-float color spaces are not supported by the build");
+#endif
+}
+
 void KisCompositionBenchmark::compareRgbU8CopyOps()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -1013,6 +1100,55 @@ void KisCompositionBenchmark::testRgbF32CompositeCopyOptimized()
     delete op;
 }
 
+void KisCompositionBenchmark::testRgbF16CompositeAlphaDarkenLegacy()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *op = new KoCompositeOpAlphaDarken<KoRgbF16Traits, KoAlphaDarkenParamsWrapperCreamy>(cs);
+    benchmarkCompositeOp(op, "RGBF16 Legacy");
+    delete op;
+#endif
+}
+
+void KisCompositionBenchmark::testRgbF16CompositeAlphaDarkenOptimized()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createAlphaDarkenOpCreamyF16(cs);
+    benchmarkCompositeOp(op, "RGBF16 Optimized");
+    delete op;
+#endif
+}
+
+void KisCompositionBenchmark::testRgbF16CompositeOverLegacy()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *op = new KoCompositeOpOver<KoRgbF16Traits>(cs);
+    benchmarkCompositeOp(op, "RGBF16 Legacy");
+    delete op;
+#endif
+}
+
+void KisCompositionBenchmark::testRgbF16CompositeOverOptimized()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    KoCompositeOp *op = KoOptimizedCompositeOpFactory::createOverOpF16(cs);
+    benchmarkCompositeOp(op, "RGBF16 Optimized");
+    delete op;
+#endif
+}
+
+void KisCompositionBenchmark::testRgbF16CompositeScreenReal()
+{
+#ifdef HAVE_OPENEXR
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", "F16", "");
+    const KoCompositeOp *op = cs->compositeOp(COMPOSITE_SCREEN);
+    benchmarkCompositeOp(op, "RGBF16 Real");
+#endif
+}
+
 void KisCompositionBenchmark::testRgb8CompositeAlphaDarkenReal_Aligned()
 {
     const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -37,15 +37,18 @@ private Q_SLOTS:
     void compareAlphaDarkenOpsNoMask();
     void compareRgbU16AlphaDarkenOps();
     void compareRgbF32AlphaDarkenOps();
+    void compareRgbF16AlphaDarkenOps();
 
     void compareOverOps();
     void compareOverOpsNoMask();
     void compareRgbU16OverOps();
     void compareRgbF32OverOps();
+    void compareRgbF16OverOps();
 
     void compareRgbU8CopyOps();
     void compareRgbU16CopyOps();
     void compareRgbF32CopyOps();
+    void compareRgbF16CopyOps();
 
     void testRgb8CompositeAlphaDarkenLegacy();
     void testRgb8CompositeAlphaDarkenOptimized();
@@ -71,6 +74,14 @@ private Q_SLOTS:
     void testRgbF32CompositeCopyLegacy();
     void testRgbF32CompositeCopyOptimized();
 
+    void testRgbF16CompositeAlphaDarkenLegacy();
+    void testRgbF16CompositeAlphaDarkenOptimized();
+
+    void testRgbF16CompositeOverLegacy();
+    void testRgbF16CompositeOverOptimized();
+
+    void testRgbF16CompositeScreenReal();
+
     void testRgb8CompositeAlphaDarkenReal_Aligned();
     void testRgb8CompositeOverReal_Aligned();
 
@@ -14,6 +14,7 @@
 #include <KoCompositeOpRegistry.h>
 #include "kis_datamanager.h"
 #include <KisGlobalResourcesInterface.h>
+#include <KisThreadPoolRunnableStrokeJobsExecutor.h>
 
 #define NUM_CYCLES 50
 #define WARMUP_CYCLES 2
@@ -114,6 +115,12 @@ void KisFilterSelectionsBenchmark::testFilter(const QString &name)
     testNoSelections(WARMUP_CYCLES);
     testNoSelections(NUM_CYCLES);
 
+    testConcurrentUsualSelections(WARMUP_CYCLES);
+    testConcurrentUsualSelections(NUM_CYCLES);
+
+    testConcurrentNoSelections(WARMUP_CYCLES);
+    testConcurrentNoSelections(NUM_CYCLES);
+
     testBitBltWOSelections(WARMUP_CYCLES);
     testBitBltWOSelections(NUM_CYCLES);
 
@@ -135,6 +142,7 @@ void KisFilterSelectionsBenchmark::testAll()
 
     testFilter("brightnesscontrast");
     testFilter("invert");
+    testFilter("blur");
 //    testFilter("levels");
 
 }
@@ -185,6 +193,56 @@ void KisFilterSelectionsBenchmark::testNoSelections(int num)
         dbgKrita << "No Selections:\t\t\t\t" << avTime;
 }
 
+void KisFilterSelectionsBenchmark::testConcurrentUsualSelections(int num)
+{
+    KisPaintDeviceSP projection =
+        new KisPaintDevice(m_device->colorSpace());
+
+    KisThreadPoolRunnableStrokeJobsExecutor executor;
+
+    double avTime;
+    KisTimeCounter timer;
+
+    QRect filterRect = m_selection->selectedExactRect();
+
+    timer.restart();
+    for (int i = 0; i < num; i++) {
+        KisTransaction transac(projection, 0);
+        m_filter->process(m_device, projection, m_selection, filterRect, m_configuration, 0, &executor);
+    }
+    avTime = double(timer.elapsed()) / num;
+
+    projection->convertToQImage(0).save("TFS__CONCURRENT_USUAL_SELECTIONS.png");
+
+    if (num > WARMUP_CYCLES || SHOW_WARMUPS)
+        dbgKrita << "Selections inside filter (concurrent):\t" << avTime;
+}
+
+void KisFilterSelectionsBenchmark::testConcurrentNoSelections(int num)
+{
+    KisPaintDeviceSP projection =
+        new KisPaintDevice(m_device->colorSpace());
+
+    KisThreadPoolRunnableStrokeJobsExecutor executor;
+
+    double avTime;
+    KisTimeCounter timer;
+
+    QRect filterRect = m_selection->selectedExactRect();
+
+    timer.restart();
+    for (int i = 0; i < num; i++) {
+        KisTransaction transac(projection, 0);
+        m_filter->process(m_device, projection, 0, filterRect, m_configuration, 0, &executor);
+    }
+    avTime = double(timer.elapsed()) / num;
+
+    projection->convertToQImage(0).save("TFS__CONCURRENT_NO_SELECTIONS.png");
+
+    if (num > WARMUP_CYCLES || SHOW_WARMUPS)
+        dbgKrita << "No Selections (concurrent):\t\t" << avTime;
+}
+
 void KisFilterSelectionsBenchmark::testGoodSelections(int num)
 {
 #if(USE_GOOD_SELECTIONS==1)
@@ -28,6 +28,8 @@ private:
     void testFilter(const QString &name);
     void testUsualSelections(int num);
     void testNoSelections(int num);
+    void testConcurrentUsualSelections(int num);
+    void testConcurrentNoSelections(int num);
     void testGoodSelections(int num);
     void testBitBltWOSelections(int num);
     void testBitBltSelections(int num);
@@ -5,11 +5,17 @@
  */
 
 #include <simpletest.h>
+#include <QtMath>
 
 #include "kis_mask_generator_benchmark.h"
 
 #include "kis_circle_mask_generator.h"
 #include "kis_rect_mask_generator.h"
+#include "kis_gauss_circle_mask_generator.h"
+#include "kis_gauss_rect_mask_generator.h"
+#include "kis_curve_circle_mask_generator.h"
+#include "kis_curve_rect_mask_generator.h"
+#include "kis_cubic_curve.h"
 
 void KisMaskGeneratorBenchmark::benchmarkCircle()
 {
@@ -67,6 +73,131 @@ void KisMaskGeneratorBenchmark::benchmarkSIMD_FadedBrush()
     benchmarkSIMD(0.5);
 }
 
+enum MaskShape {
+    Circle,
+    Rect,
+    GaussCircle,
+    GaussRect,
+    SoftCircle,
+    SoftRect
+};
+
+Q_DECLARE_METATYPE(MaskShape)
+
+template <typename MaskGenerator>
+void benchmarkGenerator(MaskGenerator &gen, bool useScalar)
+{
+    if (useScalar) {
+        gen.setMaskScalarApplicator();
+    }
+
+    const int size = qCeil(gen.diameter()) + 2;
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+    dev->setRect(QRect(0, 0, size, size));
+    dev->initialize();
+
+    MaskProcessingData data(dev, cs, nullptr,
+                            0.0, 1.0,
+                            0.5 * size, 0.5 * size, 0.3);
+
+    KisBrushMaskApplicatorBase *applicator = gen.applicator();
+    applicator->initializeData(&data);
+
+    QVector<QRect> rects = KritaUtils::splitRectIntoPatches(dev->bounds(), QSize(63, 63));
+
+    // the small dabs are too fast to be measured one by one
+    const int numRepeats = size < 64 ? 1000 : 1;
+
+    QBENCHMARK{
+        for (int i = 0; i < numRepeats; i++) {
+            Q_FOREACH (const QRect &rc, rects) {
+                applicator->process(rc);
+            }
+        }
+    }
+}
+
+void KisMaskGeneratorBenchmark::benchmarkSIMD_AllShapes_data()
+{
+    QTest::addColumn<MaskShape>("shape");
+    QTest::addColumn<qreal>("diameter");
+    QTest::addColumn<int>("spikes");
+    QTest::addColumn<bool>("useScalar");
+
+    const QVector<QPair<MaskShape, QString>> shapes = {
+        {Circle, "circle"},
+        {Rect, "rect"},
+        {GaussCircle, "gauss-circle"},
+        {GaussRect, "gauss-rect"},
+        {SoftCircle, "soft-circle"},
+        {SoftRect, "soft-rect"}
+    };
+
+    for (auto it = shapes.begin(); it != shapes.end(); ++it) {
+        for (int spikes : {2, 5}) {
+            // the small dab is supersampled
+            for (qreal diameter : {1000.0, 7.5}) {
+                for (bool useScalar : {false, true}) {
+                    const QString name = QString("%1-%2spikes-%3px-%4")
+                        .arg(it->second)
+                        .arg(spikes)
+                        .arg(diameter)
+                        .arg(useScalar ? "scalar" : "vector");
+
+                    QTest::addRow("%s", name.toLatin1().data())
+                        << it->first << diameter << spikes << useScalar;
+                }
+            }
+        }
+    }
+}
+
+void KisMaskGeneratorBenchmark::benchmarkSIMD_AllShapes()
+{
+    QFETCH(MaskShape, shape);
+    QFETCH(qreal, diameter);
+    QFETCH(int, spikes);
+    QFETCH(bool, useScalar);
+
+    const qreal fade = 0.5;
+    const KisCubicCurve curve(QString("0,1;1,0"));
+
+    switch (shape) {
+    case Circle: {
+        KisCircleMaskGenerator gen(diameter, 1.0, fade, fade, spikes, true);
+        benchmarkGenerator(gen, useScalar);
+        break;
+    }
+    case Rect: {
+        KisRectangleMaskGenerator gen(diameter, 1.0, fade, fade, spikes, true);
+        benchmarkGenerator(gen, useScalar);
+        break;
+    }
+    case GaussCircle: {
+        KisGaussCircleMaskGenerator gen(diameter, 1.0, fade, fade, spikes, true);
+        benchmarkGenerator(gen, useScalar);
+        break;
+    }
+    case GaussRect: {
+        KisGaussRectangleMaskGenerator gen(diameter, 1.0, fade, fade, spikes, true);
+        benchmarkGenerator(gen, useScalar);
+        break;
+    }
+    case SoftCircle: {
+        KisCurveCircleMaskGenerator gen(diameter, 1.0, fade, fade, spikes, curve, true);
+        benchmarkGenerator(gen, useScalar);
+        break;
+    }
+    case SoftRect: {
+        KisCurveRectangleMaskGenerator gen(diameter, 1.0, fade, fade, spikes, curve, true);
+        benchmarkGenerator(gen, useScalar);
+        break;
+    }
+    }
+}
+
 void KisMaskGeneratorBenchmark::benchmarkSquare()
 {
     KisRectangleMaskGenerator gen(1000, 0.5, 0.5, 0.5, 3, true);
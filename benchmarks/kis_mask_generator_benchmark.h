@@ -16,6 +16,8 @@ private Q_SLOTS:
     void benchmarkCircle();
     void benchmarkSIMD_SharpBrush();
     void benchmarkSIMD_FadedBrush();
+    void benchmarkSIMD_AllShapes_data();
+    void benchmarkSIMD_AllShapes();
     void benchmarkSquare();
 
 };
@@ -15,6 +15,7 @@ inline double drand48()
 #endif
 
 #include <QPainterPath>
+#include <QFileInfo>
 #include <simpletest.h>
 
 #include "kis_stroke_benchmark.h"
@@ -32,6 +33,7 @@ inline double drand48()
 
 #include <brushengine/kis_paint_information.h>
 #include <brushengine/kis_paintop_preset.h>
+#include <brushengine/KisStrokeRecording.h>
 
 #define GMP_IMAGE_WIDTH 3274
 #define GMP_IMAGE_HEIGHT 2067
@@ -70,6 +72,8 @@ void KisStrokeBenchmark::initTestCase()
     initLines(width,height);
     // for the rectangles test
     initRectangles(width, height);
+    // for the recorded strokes test
+    initRecording();
 }
 
 void KisStrokeBenchmark::init()
@@ -133,7 +137,71 @@ void KisStrokeBenchmark::initRectangles(int width, int height)
     }
 }
 
+/**
+ * The recorded strokes are replayed from the file passed in
+ * KRITA_STROKE_RECORDING environment variable. The strokes can be
+ * recorded by a build of Krita with RECORD_STROKES defined in
+ * kis_tool_freehand_helper.cpp. Every freehand stroke is then saved
+ * into a separate file in the directory set by KRITA_RECORD_STROKES.
+ *
+ * If no recording is passed, a synthetic one is generated from the
+ * curve used by benchmarkStroke() and saved into the output directory.
+ */
+void KisStrokeBenchmark::initRecording()
+{
+    m_recordingFileName = qEnvironmentVariable("KRITA_STROKE_RECORDING");
+    if (!m_recordingFileName.isEmpty()) return;
+
+    m_recordingFileName = m_outputPath + "synthetic_stroke.kisstroke";
+
+    KisStrokeRecording recording;
+    recording.beginStroke();
+
+    // a tablet event every 5 ms, 200 events per curve
+    const int numEvents = 200;
+    const qint64 eventInterval = 5000;
+
+    auto bezierPoint = [] (const QPointF &p0, const QPointF &p1, const QPointF &p2, const QPointF &p3, qreal t) {
+        const qreal s = 1.0 - t;
+        return s * s * s * p0 + 3 * s * s * t * p1 + 3 * s * t * t * p2 + t * t * t * p3;
+    };
 
+    KisPaintInformation prevPi(m_pi1.pos(), m_pi1.pressure(), 0, 0, 0, 0, 1.0, 0, 0);
+    qint64 timestamp = 0;
+
+    auto addCurve = [&] (const KisPaintInformation &start, const QPointF &control, const KisPaintInformation &end) {
+        for (int i = 1; i <= numEvents; i++) {
+            const qreal t = qreal(i) / numEvents;
+            timestamp += eventInterval;
+
+            const QPointF pos = bezierPoint(start.pos(), control, control, end.pos(), t);
+            const qreal pressure = start.pressure() + t * (end.pressure() - start.pressure());
+
+            // tilt and rotation swing a bit to exercise the sensors
+            const qreal xTilt = 30.0 * std::sin(t * M_PI);
+            const qreal yTilt = -20.0 * std::cos(t * M_PI);
+            const qreal rotation = 45.0 * t;
+
+            KisPaintInformation pi(pos, pressure, xTilt, yTilt, rotation, 0.0, 1.0, timestamp / 1000.0, 0.0);
+
+            KisStrokeRecording::Event event;
+            event.type = KisStrokeRecording::PaintLine;
+            event.timestamp = timestamp;
+            event.pi1 = prevPi;
+            event.pi2 = pi;
+            recording.addEvent(event);
+
+            prevPi = pi;
+        }
+    };
+
+    addCurve(m_pi1, m_c1, m_pi2);
+    addCurve(m_pi2, m_c2, m_pi3);
+
+    if (!recording.save(m_recordingFileName)) {
+        m_recordingFileName.clear();
+    }
+}
 
 void KisStrokeBenchmark::cleanupTestCase()
 {
@@ -584,6 +652,88 @@ void KisStrokeBenchmark::benchmarkStroke(QString presetFileName)
 #endif
 }
 
+void KisStrokeBenchmark::benchmarkRecording(QString presetFileName)
+{
+    KisStrokeRecording recording;
+    if (m_recordingFileName.isEmpty() || !recording.load(m_recordingFileName)) {
+        QSKIP("The stroke recording is not available");
+    }
+
+    KisPaintOpPresetSP preset(new KisPaintOpPreset(presetFileName));
+    bool loadedOk = preset->load(KisGlobalResourcesInterface::instance());
+    if (!loadedOk){
+        dbgKrita << "The preset was not loaded correctly. Done.";
+        return;
+    } else {
+        dbgKrita << "preset : " << presetFileName;
+    }
+
+    m_painter->setPaintOpPreset(preset, m_layer, m_image);
+
+    KisStrokeRecording::ReplayStatistics stats;
+
+    QBENCHMARK{
+        // the seed is the same for every run, so the result is always the same
+        stats = recording.replay(m_painter, 0);
+    }
+
+    qInfo().noquote() << QString("%1: %2 strokes, %3 events, %4 dabs, %5 ms, %6 dabs/sec, "
+                                 "dab latency p50 %7 us, p90 %8 us, p99 %9 us")
+        .arg(QFileInfo(presetFileName).fileName())
+        .arg(stats.numStrokes)
+        .arg(recording.numEvents())
+        .arg(stats.numDabs)
+        .arg(stats.wallTime / 1e6, 0, 'f', 2)
+        .arg(stats.dabsPerSecond(), 0, 'f', 0)
+        .arg(stats.latencyPercentile(50) / 1e3, 0, 'f', 1)
+        .arg(stats.latencyPercentile(90) / 1e3, 0, 'f', 1)
+        .arg(stats.latencyPercentile(99) / 1e3, 0, 'f', 1);
+
+#ifdef SAVE_OUTPUT
+    m_layer->paintDevice()->convertToQImage(0).save(m_outputPath + QFileInfo(presetFileName).fileName() + "_recording" + OUTPUT_FORMAT);
+#endif
+}
+
+/**
+ * The presets are passed in KRITA_STROKE_PRESETS environment variable
+ * as a list of paths separated with ';', otherwise a set of presets
+ * of different engines from the data directory is used
+ */
+void KisStrokeBenchmark::benchmarkRecordedStroke_data()
+{
+    QTest::addColumn<QString>("presetFileName");
+
+    QStringList presets = qEnvironmentVariable("KRITA_STROKE_PRESETS").split(';');
+    presets.removeAll(QString());
+
+    if (presets.isEmpty()) {
+        const QStringList defaultPresets = {
+            "autobrush_300px.kpp",
+            "softbrush_30px.kpp",
+            "AutoBrush_70px_rotated.kpp",
+            "hairybrush_thesis30px1.kpp",
+            "spray_30px21rasterParticles.kpp",
+            "colorsmudge.kpp",
+            "roundmarker40px.kpp",
+            "deform-default.kpp"
+        };
+
+        Q_FOREACH (const QString &preset, defaultPresets) {
+            presets << m_dataPath + preset;
+        }
+    }
+
+    Q_FOREACH (const QString &preset, presets) {
+        QTest::newRow(QFileInfo(preset).fileName().toLatin1()) << preset;
+    }
+}
+
+void KisStrokeBenchmark::benchmarkRecordedStroke()
+{
+    QFETCH(QString, presetFileName);
+    benchmarkRecording(presetFileName);
+}
+
 static const int COUNT = 1000000;
 void KisStrokeBenchmark::benchmarkRand48()
 {
@@ -42,10 +42,13 @@ private:
     QVector<QPoint> m_rectangleLeftLowerCorners;
     QVector<QPoint> m_rectangleRightUpperCorners;
 
+    QString m_recordingFileName;
+
 
     void initCurvePoints(int width, int height);
     void initLines(int width, int height);
     void initRectangles(int width, int height);
+    void initRecording();
 
     QString m_dataPath;
     QString m_outputPath;
@@ -56,6 +59,7 @@ private:
         inline void benchmarkLine(QString presetFileName);
         inline void benchmarkCircle(QString presetFileName);
         inline void benchmarkRectangle(QString presetFileName);
+        inline void benchmarkRecording(QString presetFileName);
 
 private Q_SLOTS:
     void initTestCase();
@@ -131,6 +135,10 @@ private Q_SLOTS:
     void benchmarkRand48();
 
     void benchmarkPresetCloning();
+
+    // Replay of the recorded strokes, see initRecording()
+    void benchmarkRecordedStroke_data();
+    void benchmarkRecordedStroke();
 };
 
 #endif
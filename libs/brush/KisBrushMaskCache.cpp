@@ -0,0 +1,228 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBrushMaskCache.h"
+
+#include <cmath>
+#include <limits>
+
+#include <QCache>
+#include <QGlobalStatic>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QtMath>
+
+#include <kis_assert.h>
+#include <kis_image_config.h>
+
+#include "KisBrushTipPyramid.h"
+#include "kis_qimage_pyramid.h"
+
+namespace {
+
+struct MaskKey {
+    QByteArray pyramidKey;
+    QSize size;
+    int scaleX {0};
+    int scaleY {0};
+    int angle {0};
+    int subPixelX {0};
+    int subPixelY {0};
+
+    bool operator==(const MaskKey &rhs) const {
+        return pyramidKey == rhs.pyramidKey &&
+            size == rhs.size &&
+            scaleX == rhs.scaleX &&
+            scaleY == rhs.scaleY &&
+            angle == rhs.angle &&
+            subPixelX == rhs.subPixelX &&
+            subPixelY == rhs.subPixelY;
+    }
+};
+
+inline uint qHash(const MaskKey &key, uint seed = 0)
+{
+    auto combine = [] (uint seed, uint value) {
+        return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    };
+
+    seed = ::qHash(key.pyramidKey, seed);
+    seed = combine(seed, ::qHash(key.size.width()));
+    seed = combine(seed, ::qHash(key.size.height()));
+    seed = combine(seed, ::qHash(key.scaleX));
+    seed = combine(seed, ::qHash(key.scaleY));
+    seed = combine(seed, ::qHash(key.angle));
+    seed = combine(seed, ::qHash(key.subPixelX));
+    seed = combine(seed, ::qHash(key.subPixelY));
+
+    return seed;
+}
+
+MaskKey calculateKey(const KisBrushTipPyramid *pyramid,
+                     const KisDabShape &shape,
+                     qreal subPixelX, qreal subPixelY)
+{
+    const qreal step = KisBrushMaskCache::maxDisplacement;
+    const QSize originalSize = pyramid->originalSize();
+
+    MaskKey key;
+    key.pyramidKey = pyramid->contentKey();
+    key.size = KisQImagePyramid::imageSize(originalSize, shape, subPixelX, subPixelY);
+
+    key.scaleX = qRound(shape.scaleX() * originalSize.width() / step);
+    key.scaleY = qRound(shape.scaleY() * originalSize.height() / step);
+
+    /**
+     * The rotation is quantized into a power-of-two number of steps,
+     * so that the right angles always fall into the exact buckets.
+     * The number of steps depends on the size of the mask, the farthest
+     * point of the mask should never move by more than one step.
+     */
+    const qreal radius = 0.5 * std::hypot(key.scaleX, key.scaleY) * step;
+    const qreal minNumAngleSteps = 2.0 * M_PI * radius / step;
+
+    int numAngleSteps = 4;
+    while (numAngleSteps < minNumAngleSteps) {
+        numAngleSteps *= 2;
+    }
+
+    qreal angle = std::fmod(shape.rotation(), 2.0 * M_PI);
+    if (angle < 0) {
+        angle += 2.0 * M_PI;
+    }
+
+    key.angle = qRound(angle / (2.0 * M_PI) * numAngleSteps) % numAngleSteps;
+
+    key.subPixelX = qRound(subPixelX / step);
+    key.subPixelY = qRound(subPixelY / step);
+
+    return key;
+}
+
+/**
+ * QCache counts the cost in ints, so the memory is
+ * accounted in KiB to support bigger budgets
+ */
+inline int costInKiB(qint64 bytes)
+{
+    return int(qMin<qint64>((bytes + 1023) / 1024, std::numeric_limits<int>::max()));
+}
+
+}
+
+struct KisBrushMaskCache::Private
+{
+    mutable QMutex mutex;
+    QCache<MaskKey, QImage> masks;
+    qint64 memoryBudget {0};
+
+    Statistics statistics;
+};
+
+Q_GLOBAL_STATIC(KisBrushMaskCache, s_instance)
+
+qreal KisBrushMaskCache::Statistics::hitRate() const
+{
+    const qint64 total = hits + misses;
+    return total > 0 ? qreal(hits) / total : 0.0;
+}
+
+KisBrushMaskCache::KisBrushMaskCache()
+    : m_d(new Private)
+{
+    setMemoryBudget(qint64(KisImageConfig(true).brushMaskCacheSize()) * 1024 * 1024);
+}
+
+KisBrushMaskCache::~KisBrushMaskCache()
+{
+}
+
+KisBrushMaskCache *KisBrushMaskCache::instance()
+{
+    return s_instance;
+}
+
+QImage KisBrushMaskCache::fetch(const KisBrushTipPyramid *pyramid,
+                                const KisDabShape &shape,
+                                qreal subPixelX, qreal subPixelY)
+{
+    if (pyramid->contentKey().isEmpty() || memoryBudget() <= 0) {
+        return pyramid->createImage(shape, subPixelX, subPixelY);
+    }
+
+    const MaskKey key = calculateKey(pyramid, shape, subPixelX, subPixelY);
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        QImage *cachedImage = m_d->masks.object(key);
+        if (cachedImage) {
+            m_d->statistics.hits++;
+            return *cachedImage;
+        }
+
+        m_d->statistics.misses++;
+    }
+
+    // the mask is generated outside the lock, it may take a while
+    const QImage image = pyramid->createImage(shape, subPixelX, subPixelY);
+
+    KIS_SAFE_ASSERT_RECOVER(image.size() == key.size) {
+        return image;
+    }
+
+    QMutexLocker l(&m_d->mutex);
+
+    // the mask might have been added by another thread in the meantime
+    if (!m_d->masks.contains(key)) {
+        const int numMasksBefore = m_d->masks.size();
+
+        // QCache doesn't keep objects that exceed the budget on its own
+        m_d->masks.insert(key, new QImage(image), costInKiB(image.sizeInBytes()));
+
+        m_d->statistics.evictions += qMax(0, numMasksBefore + 1 - m_d->masks.size());
+    }
+
+    return image;
+}
+
+void KisBrushMaskCache::setMemoryBudget(qint64 bytes)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->memoryBudget = bytes;
+    m_d->masks.setMaxCost(costInKiB(qMax<qint64>(0, bytes)));
+}
+
+qint64 KisBrushMaskCache::memoryBudget() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->memoryBudget;
+}
+
+void KisBrushMaskCache::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->masks.clear();
+}
+
+KisBrushMaskCache::Statistics KisBrushMaskCache::statistics() const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    Statistics stats = m_d->statistics;
+    stats.memoryUsage = qint64(m_d->masks.totalCost()) * 1024;
+    stats.numMasks = m_d->masks.size();
+
+    return stats;
+}
+
+void KisBrushMaskCache::resetStatistics()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->statistics = Statistics();
+}
@@ -0,0 +1,86 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBRUSHMASKCACHE_H
+#define KISBRUSHMASKCACHE_H
+
+#include <QImage>
+#include <QScopedPointer>
+
+#include <kis_dab_shape.h>
+#include <kritabrush_export.h>
+
+class KisBrushTipPyramid;
+
+/**
+ * A process-wide cache of the masks generated by the image-based brushes
+ * (KisGbrBrush, KisImagePipeBrush, KisPngBrush, KisSvgBrush, KisAbrBrush,
+ * KisTextBrush).
+ *
+ * KisDabCache reuses a dab only while painting a single stroke and only
+ * if the parameters of the dab barely change. Scaling and rotating the
+ * brush tip is expensive for big stamps, though, and the same masks are
+ * generated again on every stroke. This cache keeps the scaled and rotated
+ * masks between the strokes. The masks are shared by all the brushes with
+ * the same tip image, so different presets using the same brush share the
+ * cached masks as well.
+ *
+ * The masks are looked up by the buckets of their parameters. The buckets
+ * are chosen so that the contour of two masks in the same bucket differs
+ * by less than maxDisplacement pixels. The size of the returned mask is
+ * always equal to the size of the requested one.
+ *
+ * When the total size of the masks exceeds the memory budget, the least
+ * recently used masks are dropped. The cache is disabled when the budget
+ * is zero, \see KisImageConfig::brushMaskCacheSize()
+ */
+class BRUSH_EXPORT KisBrushMaskCache
+{
+public:
+    struct Statistics {
+        qint64 hits {0};
+        qint64 misses {0};
+        qint64 evictions {0};
+        qint64 memoryUsage {0}; // bytes
+        int numMasks {0};
+
+        qreal hitRate() const;
+    };
+
+    /**
+     * The maximum distance (in pixels) between the contours of
+     * two masks that share the cache bucket
+     */
+    static constexpr qreal maxDisplacement = 1.0 / 16.0;
+
+public:
+    KisBrushMaskCache();
+    ~KisBrushMaskCache();
+
+    static KisBrushMaskCache* instance();
+
+    /**
+     * \return the image \p pyramid would create for \p shape and the subpixel
+     * offsets, generating it only if there is no such mask in the cache yet
+     */
+    QImage fetch(const KisBrushTipPyramid *pyramid,
+                 const KisDabShape &shape,
+                 qreal subPixelX, qreal subPixelY);
+
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+
+    void clear();
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISBRUSHMASKCACHE_H
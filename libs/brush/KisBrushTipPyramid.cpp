@@ -0,0 +1,302 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBrushTipPyramid.h"
+
+#include <cmath>
+
+#include <QCryptographicHash>
+#include <QScopedPointer>
+#include <QTransform>
+
+#include <kis_assert.h>
+
+#include "KisBrushTipSampler.h"
+#include "kis_qimage_pyramid.h"
+
+namespace {
+
+const KisBrushTipSamplerBase *sampler()
+{
+    static const QScopedPointer<KisBrushTipSamplerBase> s_sampler(
+        createOptimizedClass<KisBrushTipSamplerFactory>());
+
+    return s_sampler.data();
+}
+
+/**
+ * Area-averaging weights of the source pixels that cover
+ * a single destination pixel
+ */
+struct AxisTaps {
+    int first {0};
+    int count {0};
+    float weights[4] {0.0f, 0.0f, 0.0f, 0.0f};
+};
+
+QVector<AxisTaps> calculateAxisTaps(int srcSize, int dstSize)
+{
+    const qreal ratio = qreal(srcSize) / dstSize;
+    QVector<AxisTaps> result(dstSize);
+
+    for (int i = 0; i < dstSize; i++) {
+        const qreal start = i * ratio;
+        const qreal end = (i + 1) * ratio;
+
+        AxisTaps &taps = result[i];
+        taps.first = static_cast<int>(start);
+
+        const int last = qMin(srcSize - 1, static_cast<int>(std::ceil(end)) - 1);
+        taps.count = qMin(4, last - taps.first + 1);
+
+        // the ratio never exceeds 3, so 4 taps are always enough
+        KIS_SAFE_ASSERT_RECOVER_NOOP(last - taps.first + 1 <= 4);
+
+        for (int j = 0; j < taps.count; j++) {
+            const int pos = taps.first + j;
+            taps.weights[j] = float((qMin<qreal>(end, pos + 1) - qMax<qreal>(start, pos)) / ratio);
+        }
+    }
+
+    return result;
+}
+
+}
+
+KisBrushTipMipLevel KisBrushTipPyramid::Level::view() const
+{
+    const int border = KisBrushTipMipLevel::border;
+
+    KisBrushTipMipLevel level;
+    level.width = size.width();
+    level.height = size.height();
+    level.rowStride = (size.width() + 2 * border) * 4;
+    level.pixels = data.constData() + border * level.rowStride + border * 4;
+
+    return level;
+}
+
+KisBrushTipPyramid::KisBrushTipPyramid(const QImage &baseImage, bool useSmoothingForEnlarging)
+    : m_originalSize(baseImage.size()),
+      m_useSmoothingForEnlarging(useSmoothingForEnlarging)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!baseImage.isNull());
+
+    {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+
+        const int header[] = {baseImage.width(), baseImage.height(), int(baseImage.format()), useSmoothingForEnlarging};
+        hash.addData(reinterpret_cast<const char*>(header), sizeof(header));
+
+        const int bytesPerRow = (baseImage.width() * baseImage.depth() + 7) / 8;
+        for (int y = 0; y < baseImage.height(); y++) {
+            hash.addData(reinterpret_cast<const char*>(baseImage.constScanLine(y)), bytesPerRow);
+        }
+
+        m_contentKey = hash.result();
+    }
+
+    m_levels.append(createBaseLevel(baseImage));
+
+    while (m_levels.last().size.width() > 1 &&
+           m_levels.last().size.height() > 1) {
+
+        m_levels.append(createDownsampledLevel(m_levels.last()));
+    }
+}
+
+KisBrushTipPyramid::~KisBrushTipPyramid()
+{
+}
+
+QSize KisBrushTipPyramid::originalSize() const
+{
+    return m_originalSize;
+}
+
+int KisBrushTipPyramid::numLevels() const
+{
+    return m_levels.size();
+}
+
+QByteArray KisBrushTipPyramid::contentKey() const
+{
+    return m_contentKey;
+}
+
+KisBrushTipPyramid::Level KisBrushTipPyramid::createLevel(const QSize &size)
+{
+    const int border = KisBrushTipMipLevel::border;
+
+    Level level;
+    level.size = size;
+    level.data.fill(0.0f, (size.width() + 2 * border) * (size.height() + 2 * border) * 4);
+
+    return level;
+}
+
+KisBrushTipPyramid::Level KisBrushTipPyramid::createBaseLevel(const QImage &image)
+{
+    const QImage srcImage = image.convertToFormat(QImage::Format_ARGB32);
+
+    Level level = createLevel(srcImage.size());
+    const KisBrushTipMipLevel view = level.view();
+
+    // the view points into the data of the level
+    float *dstRow = level.data.data() + (view.pixels - level.data.constData());
+
+    const float normCoeff = 1.0f / 255.0f;
+
+    for (int y = 0; y < view.height; y++) {
+        const QRgb *src = reinterpret_cast<const QRgb*>(srcImage.constScanLine(y));
+        float *dst = dstRow;
+
+        for (int x = 0; x < view.width; x++) {
+            const float alpha = qAlpha(*src) * normCoeff;
+
+            dst[0] = qRed(*src) * normCoeff * alpha;
+            dst[1] = qGreen(*src) * normCoeff * alpha;
+            dst[2] = qBlue(*src) * normCoeff * alpha;
+            dst[3] = alpha;
+
+            src++;
+            dst += 4;
+        }
+
+        dstRow += view.rowStride;
+    }
+
+    return level;
+}
+
+KisBrushTipPyramid::Level KisBrushTipPyramid::createDownsampledLevel(const Level &srcLevel)
+{
+    const KisBrushTipMipLevel src = srcLevel.view();
+    const QSize dstSize(qMax(1, src.width / 2), qMax(1, src.height / 2));
+
+    const QVector<AxisTaps> horizontalTaps = calculateAxisTaps(src.width, dstSize.width());
+    const QVector<AxisTaps> verticalTaps = calculateAxisTaps(src.height, dstSize.height());
+
+    // the horizontal pass
+    QVector<float> tmp(dstSize.width() * src.height * 4);
+
+    for (int y = 0; y < src.height; y++) {
+        const float *srcRow = src.pixels + y * src.rowStride;
+        float *dst = tmp.data() + y * dstSize.width() * 4;
+
+        for (const AxisTaps &taps : horizontalTaps) {
+            const float *srcPixel = srcRow + taps.first * 4;
+
+            for (int ch = 0; ch < 4; ch++) {
+                float value = 0.0f;
+                for (int i = 0; i < taps.count; i++) {
+                    value += taps.weights[i] * srcPixel[i * 4 + ch];
+                }
+                dst[ch] = value;
+            }
+
+            dst += 4;
+        }
+    }
+
+    // the vertical pass
+    Level level = createLevel(dstSize);
+    const KisBrushTipMipLevel view = level.view();
+    float *dstRow = level.data.data() + (view.pixels - level.data.constData());
+
+    const int tmpRowStride = dstSize.width() * 4;
+
+    for (const AxisTaps &taps : verticalTaps) {
+        const float *srcColumn = tmp.constData() + taps.first * tmpRowStride;
+
+        for (int x = 0; x < tmpRowStride; x++) {
+            float value = 0.0f;
+            for (int i = 0; i < taps.count; i++) {
+                value += taps.weights[i] * srcColumn[i * tmpRowStride + x];
+            }
+            dstRow[x] = value;
+        }
+
+        dstRow += view.rowStride;
+    }
+
+    return level;
+}
+
+int KisBrushTipPyramid::findNearestLevel(qreal scale, qreal *levelScale) const
+{
+    const qreal scale_epsilon = 1e-6;
+
+    qreal currentScale = 1.0;
+    int level = 0;
+    const int lastLevel = m_levels.size() - 1;
+
+    while ((0.5 * currentScale > scale ||
+            qAbs(0.5 * currentScale - scale) < scale_epsilon) &&
+           level < lastLevel) {
+
+        currentScale *= 0.5;
+        level++;
+    }
+
+    *levelScale = currentScale;
+    return level;
+}
+
+QImage KisBrushTipPyramid::createImage(KisDabShape const& shape,
+                                       qreal subPixelX, qreal subPixelY) const
+{
+    if (m_levels.isEmpty()) return QImage();
+
+    qreal levelScale = 1.0;
+    const int levelIndex = findNearestLevel(shape.scale(), &levelScale);
+    const Level &level = m_levels[levelIndex];
+
+    QTransform transform;
+    QSize dstSize;
+
+    KisQImagePyramid::calculateParams(shape, subPixelX, subPixelY,
+                                      m_originalSize, levelScale, level.size,
+                                      &transform, &dstSize);
+
+    QImage dstImage(dstSize, QImage::Format_ARGB32);
+
+    bool isInvertible = false;
+    const QTransform invertedTransform = transform.inverted(&isInvertible);
+
+    if (!isInvertible) {
+        dstImage.fill(0);
+        return dstImage;
+    }
+
+    const bool isEnlarging = levelIndex == 0 &&
+        qMax(shape.scaleX(), shape.scaleY()) > 1.0 + 1e-6;
+
+    const KisBrushTipSamplerBase::Filter filter =
+        !isEnlarging ? KisBrushTipSamplerBase::Bilinear :
+        m_useSmoothingForEnlarging ? KisBrushTipSamplerBase::Bicubic :
+        KisBrushTipSamplerBase::Nearest;
+
+    /**
+     * The centers of the pixels are at half-integer positions in
+     * the transform's coordinate system, while the sampler expects
+     * the centers of the source pixels to be at integers
+     */
+    const KisBrushTipMipLevel view = level.view();
+    const float du = invertedTransform.m11();
+    const float dv = invertedTransform.m12();
+
+    for (int y = 0; y < dstSize.height(); y++) {
+        const QPointF srcPos = invertedTransform.map(QPointF(0.5, y + 0.5)) - QPointF(0.5, 0.5);
+
+        sampler()->sampleRow(view, filter,
+                             srcPos.x(), srcPos.y(), du, dv,
+                             dstSize.width(),
+                             reinterpret_cast<quint32*>(dstImage.scanLine(y)));
+    }
+
+    return dstImage;
+}
@@ -0,0 +1,86 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBRUSHTIPPYRAMID_H
+#define KISBRUSHTIPPYRAMID_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QVector>
+
+#include <kis_dab_shape.h>
+#include <kritabrush_export.h>
+
+struct KisBrushTipMipLevel;
+
+/**
+ * A mip-chain of a predefined brush tip, used for generating the
+ * scaled and rotated masks of the dabs.
+ *
+ * Unlike KisQImagePyramid, the levels are stored as premultiplied
+ * float32 RGBA and the masks are resampled directly from them
+ * with the vectorized samplers (\see KisBrushTipSamplerBase), so
+ * generating a dab doesn't go through QPainter. The level is chosen
+ * so that it is never scaled down by more than a half: such levels
+ * are sampled bilinearly. Enlarging the brush samples the original
+ * image bicubically (or with the nearest neighbour, if smoothing
+ * is disabled).
+ *
+ * The geometry of the generated masks is the same as the geometry
+ * of the ones generated by KisQImagePyramid.
+ */
+class BRUSH_EXPORT KisBrushTipPyramid
+{
+public:
+    KisBrushTipPyramid() = default;
+    KisBrushTipPyramid(const QImage &baseImage, bool useSmoothingForEnlarging = true);
+    ~KisBrushTipPyramid();
+
+    /**
+     * \return the mask for the dab with \p shape. The image has
+     * QImage::Format_ARGB32 format and the size equal to
+     * KisQImagePyramid::imageSize()
+     */
+    QImage createImage(KisDabShape const& shape,
+                       qreal subPixelX, qreal subPixelY) const;
+
+    QSize originalSize() const;
+
+    int numLevels() const;
+
+    /**
+     * A hash of the base image and the pyramid options. Two pyramids
+     * with equal keys generate equal images, \see KisBrushMaskCache
+     */
+    QByteArray contentKey() const;
+
+private:
+    friend class KisBrushTipPyramidTest;
+
+    struct Level {
+        QSize size;
+
+        /// the pixels with the transparent border around
+        QVector<float> data;
+
+        KisBrushTipMipLevel view() const;
+    };
+
+    int findNearestLevel(qreal scale, qreal *levelScale) const;
+
+    static Level createLevel(const QSize &size);
+    static Level createBaseLevel(const QImage &image);
+    static Level createDownsampledLevel(const Level &srcLevel);
+
+private:
+    QSize m_originalSize;
+    bool m_useSmoothingForEnlarging {true};
+    QByteArray m_contentKey;
+
+    QVector<Level> m_levels;
+};
+
+#endif // KISBRUSHTIPPYRAMID_H
@@ -0,0 +1,319 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBrushTipSampler.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+
+#include <algorithm>
+#include <cmath>
+
+#include <QColor>
+
+namespace {
+
+using Filter = KisBrushTipSamplerBase::Filter;
+
+/**
+ * Catmull-Rom weights of the four taps around the sampling
+ * point, \p t is the distance to the second tap
+ */
+template<typename T>
+inline void cubicWeights(const T &t, T *w)
+{
+    const T t2 = t * t;
+    const T t3 = t2 * t;
+
+    w[0] = T(-0.5f) * t3 + t2 - T(0.5f) * t;
+    w[1] = T(1.5f) * t3 - T(2.5f) * t2 + T(1.0f);
+    w[2] = T(-1.5f) * t3 + T(2.0f) * t2 + T(0.5f) * t;
+    w[3] = T(0.5f) * t3 - T(0.5f) * t2;
+}
+
+/**
+ * The pixels farther than this distance from the level don't
+ * touch any of its pixels with any of the filters
+ */
+inline bool isNearLevel(const KisBrushTipMipLevel &level, float x, float y)
+{
+    return x > -2.0f && x < level.width + 1.0f &&
+        y > -2.0f && y < level.height + 1.0f;
+}
+
+inline quint32 packPixel(const float *pixel)
+{
+    const float alpha = qBound(0.0f, pixel[3], 1.0f);
+    const int alpha8 = static_cast<int>(alpha * 255.0f + 0.5f);
+
+    if (!alpha8) return 0;
+
+    const float k = 255.0f / alpha;
+
+    auto unpremultiply = [k] (float value) {
+        return static_cast<int>(qBound(0.0f, value * k, 255.0f) + 0.5f);
+    };
+
+    return qRgba(unpremultiply(pixel[0]), unpremultiply(pixel[1]), unpremultiply(pixel[2]), alpha8);
+}
+
+inline void samplePixel(const KisBrushTipMipLevel &level, Filter filter,
+                        float x, float y, float *result)
+{
+    std::fill(result, result + 4, 0.0f);
+
+    if (!isNearLevel(level, x, y)) return;
+
+    if (filter == KisBrushTipSamplerBase::Nearest) {
+        const int ix = static_cast<int>(std::floor(x + 0.5f));
+        const int iy = static_cast<int>(std::floor(y + 0.5f));
+
+        std::copy_n(level.pixels + iy * level.rowStride + ix * 4, 4, result);
+
+    } else if (filter == KisBrushTipSamplerBase::Bilinear) {
+        const int ix = static_cast<int>(std::floor(x));
+        const int iy = static_cast<int>(std::floor(y));
+        const float fx = x - ix;
+        const float fy = y - iy;
+
+        const float *p0 = level.pixels + iy * level.rowStride + ix * 4;
+        const float *p1 = p0 + level.rowStride;
+
+        for (int ch = 0; ch < 4; ch++) {
+            const float top = p0[ch] + fx * (p0[ch + 4] - p0[ch]);
+            const float bottom = p1[ch] + fx * (p1[ch + 4] - p1[ch]);
+            result[ch] = top + fy * (bottom - top);
+        }
+
+    } else {
+        const int ix = static_cast<int>(std::floor(x));
+        const int iy = static_cast<int>(std::floor(y));
+
+        float wx[4];
+        float wy[4];
+        cubicWeights(x - ix, wx);
+        cubicWeights(y - iy, wy);
+
+        const float *base = level.pixels + (iy - 1) * level.rowStride + (ix - 1) * 4;
+
+        for (int j = 0; j < 4; j++) {
+            const float *row = base + j * level.rowStride;
+
+            for (int i = 0; i < 4; i++) {
+                const float w = wx[i] * wy[j];
+
+                for (int ch = 0; ch < 4; ch++) {
+                    result[ch] += w * row[i * 4 + ch];
+                }
+            }
+        }
+    }
+}
+
+inline void sampleRowScalar(const KisBrushTipMipLevel &level, Filter filter,
+                            float u, float v, float du, float dv,
+                            int numPixels, quint32 *dst)
+{
+    float pixel[4];
+
+    for (int i = 0; i < numPixels; i++) {
+        samplePixel(level, filter, u + i * du, v + i * dv, pixel);
+        dst[i] = packPixel(pixel);
+    }
+}
+
+template<typename _impl, typename EnableDummyType = void>
+class KisBrushTipSampler : public KisBrushTipSamplerBase
+{
+public:
+    void sampleRow(const KisBrushTipMipLevel &level, Filter filter,
+                   float u, float v, float du, float dv,
+                   int numPixels, quint32 *dst) const override
+    {
+        sampleRowScalar(level, filter, u, v, du, dv, numPixels, dst);
+    }
+};
+
+#if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) && XSIMD_VERSION_MAJOR >= 10
+
+template<typename _impl>
+class KisBrushTipSampler<
+    _impl,
+    typename std::enable_if<!std::is_same<_impl, xsimd::generic>::value>::type>
+    : public KisBrushTipSamplerBase
+{
+    using float_v = xsimd::batch<float, _impl>;
+    using int_v = xsimd::batch<int, _impl>;
+    using float_m = typename float_v::batch_bool_type;
+
+public:
+    void sampleRow(const KisBrushTipMipLevel &level, Filter filter,
+                   float u, float v, float du, float dv,
+                   int numPixels, quint32 *dst) const override
+    {
+        constexpr int vectorSize = static_cast<int>(float_v::size);
+
+        const float_v laneIndex =
+            xsimd::batch_cast<float>(xsimd::detail::make_sequence_as_batch<int_v>());
+
+        const float_v minPos(-2.0f);
+        const float_v maxPosX(level.width + 1.0f);
+        const float_v maxPosY(level.height + 1.0f);
+
+        int i = 0;
+
+        for (; i + vectorSize <= numPixels; i += vectorSize) {
+            const float_v index = laneIndex + float_v(static_cast<float>(i));
+
+            float_v x = xsimd::fma(index, float_v(du), float_v(u));
+            float_v y = xsimd::fma(index, float_v(dv), float_v(v));
+
+            const float_m isNear = (x > minPos) & (x < maxPosX) & (y > minPos) & (y < maxPosY);
+
+            if (!xsimd::any(isNear)) {
+                std::fill(dst + i, dst + i + vectorSize, 0);
+                continue;
+            }
+
+            // keep the gathers of the rejected lanes inside the border
+            x = xsimd::min(xsimd::max(x, minPos), maxPosX);
+            y = xsimd::min(xsimd::max(y, minPos), maxPosY);
+
+            float_v pixel[4];
+
+            if (filter == Nearest) {
+                sampleNearest(level, x, y, pixel);
+            } else if (filter == Bilinear) {
+                sampleBilinear(level, x, y, pixel);
+            } else {
+                sampleBicubic(level, x, y, pixel);
+            }
+
+            pixel[3] = xsimd::select(isNear, pixel[3], float_v(0.0f));
+
+            packPixels(pixel).store_unaligned(reinterpret_cast<int*>(dst + i));
+        }
+
+        sampleRowScalar(level, filter, u + i * du, v + i * dv, du, dv, numPixels - i, dst + i);
+    }
+
+private:
+    static inline int_v pixelOffset(const KisBrushTipMipLevel &level, const float_v &x, const float_v &y)
+    {
+        return xsimd::batch_cast<int>(y) * int_v(level.rowStride) + xsimd::batch_cast<int>(x) * int_v(4);
+    }
+
+    static inline void sampleNearest(const KisBrushTipMipLevel &level,
+                                     const float_v &x, const float_v &y,
+                                     float_v *result)
+    {
+        const float_v half(0.5f);
+        const int_v offset = pixelOffset(level, xsimd::floor(x + half), xsimd::floor(y + half));
+
+        for (int ch = 0; ch < 4; ch++) {
+            result[ch] = float_v::gather(level.pixels + ch, offset);
+        }
+    }
+
+    static inline void sampleBilinear(const KisBrushTipMipLevel &level,
+                                      const float_v &x, const float_v &y,
+                                      float_v *result)
+    {
+        const float_v ix = xsimd::floor(x);
+        const float_v iy = xsimd::floor(y);
+        const float_v fx = x - ix;
+        const float_v fy = y - iy;
+
+        const int_v offset0 = pixelOffset(level, ix, iy);
+        const int_v offset1 = offset0 + int_v(level.rowStride);
+        const int_v nextPixel(4);
+
+        for (int ch = 0; ch < 4; ch++) {
+            const float *src = level.pixels + ch;
+
+            const float_v p00 = float_v::gather(src, offset0);
+            const float_v p10 = float_v::gather(src, offset0 + nextPixel);
+            const float_v p01 = float_v::gather(src, offset1);
+            const float_v p11 = float_v::gather(src, offset1 + nextPixel);
+
+            const float_v top = xsimd::fma(fx, p10 - p00, p00);
+            const float_v bottom = xsimd::fma(fx, p11 - p01, p01);
+            result[ch] = xsimd::fma(fy, bottom - top, top);
+        }
+    }
+
+    static inline void sampleBicubic(const KisBrushTipMipLevel &level,
+                                     const float_v &x, const float_v &y,
+                                     float_v *result)
+    {
+        const float_v ix = xsimd::floor(x);
+        const float_v iy = xsimd::floor(y);
+
+        float_v wx[4];
+        float_v wy[4];
+        cubicWeights(x - ix, wx);
+        cubicWeights(y - iy, wy);
+
+        const int_v base = pixelOffset(level, ix, iy) - int_v(level.rowStride + 4);
+
+        for (int ch = 0; ch < 4; ch++) {
+            const float *src = level.pixels + ch;
+            float_v sum(0.0f);
+
+            for (int j = 0; j < 4; j++) {
+                const int_v row = base + int_v(j * level.rowStride);
+                float_v rowSum(0.0f);
+
+                for (int i = 0; i < 4; i++) {
+                    rowSum = xsimd::fma(wx[i], float_v::gather(src, row + int_v(i * 4)), rowSum);
+                }
+
+                sum = xsimd::fma(wy[j], rowSum, sum);
+            }
+
+            result[ch] = sum;
+        }
+    }
+
+    /**
+     * The vectorized version of packPixel()
+     */
+    static inline int_v packPixels(const float_v *pixel)
+    {
+        const float_v zero(0.0f);
+        const float_v half(0.5f);
+        const float_v maxValue(255.0f);
+
+        const float_v alpha = xsimd::min(xsimd::max(pixel[3], zero), float_v(1.0f));
+        const float_v roundedAlpha = xsimd::fma(alpha, maxValue, half);
+        const int_v alpha8 = xsimd::batch_cast<int>(roundedAlpha);
+
+        const float_m isVisible = roundedAlpha >= float_v(1.0f);
+        const float_v k = xsimd::select(isVisible, maxValue / xsimd::max(alpha, float_v(1e-6f)), zero);
+
+        auto unpremultiply = [&] (const float_v &value) {
+            return xsimd::batch_cast<int>(xsimd::min(xsimd::max(value * k, zero), maxValue) + half);
+        };
+
+        return (alpha8 << 24) |
+            (unpremultiply(pixel[0]) << 16) |
+            (unpremultiply(pixel[1]) << 8) |
+            unpremultiply(pixel[2]);
+    }
+};
+
+#endif // HAVE_XSIMD
+
+} // namespace
+
+template<typename _impl>
+KisBrushTipSamplerBase *KisBrushTipSamplerFactory::create()
+{
+    return new KisBrushTipSampler<_impl>();
+}
+
+template KisBrushTipSamplerBase *KisBrushTipSamplerFactory::create<xsimd::current_arch>();
+
+#endif // XSIMD_UNIVERSAL_BUILD_PASS
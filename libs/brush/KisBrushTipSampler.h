@@ -0,0 +1,66 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBRUSHTIPSAMPLER_H
+#define KISBRUSHTIPSAMPLER_H
+
+#include <QtGlobal>
+#include <KoMultiArchBuildSupport.h>
+
+/**
+ * A level of KisBrushTipPyramid: premultiplied RGBA float32 pixels
+ * in [0, 1] range, surrounded by a transparent border of \p border
+ * pixels on every side.
+ */
+struct KisBrushTipMipLevel
+{
+    static constexpr int border = 4;
+
+    /// points to the pixel (0, 0), i.e. *inside* the border
+    const float *pixels {nullptr};
+    int width {0};
+    int height {0};
+
+    /// the distance between the rows in floats
+    int rowStride {0};
+};
+
+/**
+ * Resamples a row of the brush tip mask from a level of the pyramid.
+ *
+ * The source position of the i-th pixel of the row is (u + i * du,
+ * v + i * dv) in the coordinates of the level, where the center of
+ * the pixel (0, 0) is at (0, 0). The pixels outside the level are
+ * transparent.
+ *
+ * The result is written as unpremultiplied QImage::Format_ARGB32,
+ * the format KoColorSpace::fillGrayBrushWithColor() expects.
+ */
+class KisBrushTipSamplerBase
+{
+public:
+    enum Filter {
+        Nearest,
+        Bilinear,
+        Bicubic
+    };
+
+public:
+    virtual ~KisBrushTipSamplerBase() = default;
+
+    virtual void sampleRow(const KisBrushTipMipLevel &level, Filter filter,
+                           float u, float v, float du, float dv,
+                           int numPixels, quint32 *dst) const = 0;
+};
+
+class KisBrushTipSamplerFactory
+{
+public:
+    template<typename _impl>
+    static KisBrushTipSamplerBase *create();
+};
+
+#endif // KISBRUSHTIPSAMPLER_H
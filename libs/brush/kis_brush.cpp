@@ -35,6 +35,8 @@
 #include <brushengine/kis_paint_information.h>
 #include <kis_fixed_paint_device.h>
 #include <kis_qimage_pyramid.h>
+#include "KisBrushTipPyramid.h"
+#include "KisBrushMaskCache.h"
 #include <brushengine/kis_paintop_lod_limitations.h>
 #include <resources/KoAbstractGradient.h>
 #include <resources/KoCachedGradient.h>
@@ -127,7 +129,7 @@ struct KisBrush::Private {
         , threadingAllowed(true)
         , brushPyramid([] (const KisBrush* brush)
                        {
-                           return new KisQImagePyramid(brush->brushTipImage());
+                           return new KisBrushTipPyramid(brush->brushTipImage());
                        })
         , brushOutline(&detail::outlineFactory)
 
@@ -190,7 +192,7 @@ struct KisBrush::Private {
     bool threadingAllowed;
 
     QImage brushTipImage;
-    mutable KisLazySharedCacheStorageLinked<KisQImagePyramid, const KisBrush*> brushPyramid;
+    mutable KisLazySharedCacheStorageLinked<KisBrushTipPyramid, const KisBrush*> brushPyramid;
     mutable KisLazySharedCacheStorageLinked<KisOptimizedBrushOutline, const KisBrush*> brushOutline;
 };
 
@@ -595,10 +597,10 @@ void KisBrush::generateMaskAndApplyMaskOrCreateDab(KisFixedPaintDeviceSP dst,
     Q_UNUSED(info_);
     Q_UNUSED(softnessFactor);
 
-    QImage outputImage = d->brushPyramid.value(this)->createImage(KisDabShape(
-                                                                         shape.scale() * d->scale, shape.ratio(),
-                                                                         -normalizeAngle(shape.rotation() + d->angle)),
-                                                                     subPixelX, subPixelY);
+    QImage outputImage = KisBrushMaskCache::instance()->fetch(d->brushPyramid.value(this),
+                                                              KisDabShape(shape.scale() * d->scale, shape.ratio(),
+                                                                          -normalizeAngle(shape.rotation() + d->angle)),
+                                                              subPixelX, subPixelY);
 
     qint32 maskWidth = outputImage.width();
     qint32 maskHeight = outputImage.height();
@@ -697,7 +699,7 @@ KisFixedPaintDeviceSP KisBrush::paintDevice(const KoColorSpace * colorSpace,
     double angle = normalizeAngle(shape.rotation() + d->angle);
     double scale = shape.scale() * d->scale;
 
-    QImage outputImage = d->brushPyramid.value(this)->createImage(
+    QImage outputImage = KisBrushMaskCache::instance()->fetch(d->brushPyramid.value(this),
                 KisDabShape(scale, shape.ratio(), -angle), subPixelX, subPixelY);
 
     KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(colorSpace);
@@ -35,6 +35,7 @@ public:
 
 private:
     friend class KisGbrBrushTest;
+    friend class KisBrushTipPyramid;
     int findNearestLevel(qreal scale, qreal *baseScale) const;
     void appendPyramidLevel(const QImage &image);
 
@@ -0,0 +1,141 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBrushMaskCacheTest.h"
+
+#include <QPainter>
+
+#include "../KisBrushMaskCache.h"
+#include "../KisBrushTipPyramid.h"
+#include "../kis_qimage_pyramid.h"
+
+namespace {
+QImage createTipImage(int size, const QColor &color = Qt::black)
+{
+    QImage image(size, size, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    QPainter gc(&image);
+    gc.setRenderHint(QPainter::Antialiasing);
+    gc.setPen(Qt::NoPen);
+    gc.setBrush(color);
+    gc.drawEllipse(QRectF(2, 2, size - 4, size - 8));
+
+    return image;
+}
+}
+
+void KisBrushMaskCacheTest::testHits()
+{
+    KisBrushTipPyramid pyramid(createTipImage(64));
+    KisBrushMaskCache cache;
+    cache.setMemoryBudget(16 * 1024 * 1024);
+
+    const KisDabShape shape(0.7, 1.0, 0.3);
+
+    const QImage first = cache.fetch(&pyramid, shape, 0.25, 0.5);
+    const QImage second = cache.fetch(&pyramid, shape, 0.25, 0.5);
+
+    QCOMPARE(first, pyramid.createImage(shape, 0.25, 0.5));
+    QCOMPARE(second, first);
+
+    const KisBrushMaskCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.misses, qint64(1));
+    QCOMPARE(stats.hits, qint64(1));
+    QCOMPARE(stats.numMasks, 1);
+    QVERIFY(stats.memoryUsage >= first.sizeInBytes());
+    QCOMPARE(stats.hitRate(), 0.5);
+}
+
+void KisBrushMaskCacheTest::testBuckets()
+{
+    KisBrushTipPyramid pyramid(createTipImage(64));
+    KisBrushMaskCache cache;
+    cache.setMemoryBudget(16 * 1024 * 1024);
+
+    const QImage first = cache.fetch(&pyramid, KisDabShape(0.5, 1.0, 0.0), 0.0, 0.0);
+
+    // the displacement is way below KisBrushMaskCache::maxDisplacement
+    const KisDabShape closeShape(0.5 + 0.0001, 1.0, 0.0001);
+    const QImage second = cache.fetch(&pyramid, closeShape, 0.001, 0.001);
+
+    QCOMPARE(cache.statistics().hits, qint64(1));
+    QCOMPARE(second.size(), KisQImagePyramid::imageSize(pyramid.originalSize(), closeShape, 0.001, 0.001));
+
+    // a clearly different dab should never be reused
+    const KisDabShape farShape(0.5, 1.0, 0.5 * M_PI);
+    const QImage third = cache.fetch(&pyramid, farShape, 0.0, 0.0);
+
+    QCOMPARE(cache.statistics().hits, qint64(1));
+    QCOMPARE(third, pyramid.createImage(farShape, 0.0, 0.0));
+    QVERIFY(third != first);
+}
+
+void KisBrushMaskCacheTest::testSharedBetweenPyramids()
+{
+    KisBrushTipPyramid pyramid1(createTipImage(64));
+    KisBrushTipPyramid pyramid2(createTipImage(64));
+    KisBrushTipPyramid pyramid3(createTipImage(64, Qt::red));
+
+    KisBrushMaskCache cache;
+    cache.setMemoryBudget(16 * 1024 * 1024);
+
+    const KisDabShape shape(1.0, 1.0, 0.0);
+
+    cache.fetch(&pyramid1, shape, 0.0, 0.0);
+    cache.fetch(&pyramid2, shape, 0.0, 0.0);
+    QCOMPARE(cache.statistics().hits, qint64(1));
+
+    const QImage image = cache.fetch(&pyramid3, shape, 0.0, 0.0);
+    QCOMPARE(cache.statistics().hits, qint64(1));
+    QCOMPARE(image, pyramid3.createImage(shape, 0.0, 0.0));
+}
+
+void KisBrushMaskCacheTest::testEviction()
+{
+    KisBrushTipPyramid pyramid(createTipImage(64));
+    KisBrushMaskCache cache;
+
+    const qint64 maskSize = pyramid.createImage(KisDabShape(1.0, 1.0, 0.0), 0.0, 0.0).sizeInBytes();
+    cache.setMemoryBudget(3 * maskSize);
+
+    for (int i = 0; i < 10; i++) {
+        cache.fetch(&pyramid, KisDabShape(1.0, 1.0, 0.0), 0.0, 0.125 * i / 2);
+    }
+
+    KisBrushMaskCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.misses, qint64(10));
+    QVERIFY(stats.evictions > 0);
+    QVERIFY(stats.memoryUsage <= cache.memoryBudget() + stats.numMasks * 1024);
+    QCOMPARE(stats.numMasks, 10 - int(stats.evictions));
+
+    // the most recent mask is still there
+    cache.fetch(&pyramid, KisDabShape(1.0, 1.0, 0.0), 0.0, 0.125 * 9 / 2);
+    QCOMPARE(cache.statistics().hits, qint64(1));
+
+    cache.clear();
+    QCOMPARE(cache.statistics().numMasks, 0);
+    QCOMPARE(cache.statistics().memoryUsage, qint64(0));
+}
+
+void KisBrushMaskCacheTest::testDisabled()
+{
+    KisBrushTipPyramid pyramid(createTipImage(64));
+    KisBrushMaskCache cache;
+    cache.setMemoryBudget(0);
+
+    const KisDabShape shape(0.7, 1.0, 0.3);
+
+    QCOMPARE(cache.fetch(&pyramid, shape, 0.25, 0.5), pyramid.createImage(shape, 0.25, 0.5));
+    QCOMPARE(cache.fetch(&pyramid, shape, 0.25, 0.5), pyramid.createImage(shape, 0.25, 0.5));
+
+    const KisBrushMaskCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.hits, qint64(0));
+    QCOMPARE(stats.misses, qint64(0));
+    QCOMPARE(stats.numMasks, 0);
+}
+
+SIMPLE_TEST_MAIN(KisBrushMaskCacheTest)
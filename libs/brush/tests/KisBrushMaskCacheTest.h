@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBRUSHMASKCACHETEST_H
+#define KISBRUSHMASKCACHETEST_H
+
+#include <simpletest.h>
+
+class KisBrushMaskCacheTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testHits();
+    void testBuckets();
+    void testSharedBetweenPyramids();
+    void testEviction();
+    void testDisabled();
+};
+
+#endif // KISBRUSHMASKCACHETEST_H
@@ -0,0 +1,207 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBrushTipPyramidTest.h"
+
+#include <QPainter>
+
+#include "../KisBrushTipPyramid.h"
+#include "../kis_qimage_pyramid.h"
+
+namespace {
+QImage createTipImage(const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    QPainter gc(&image);
+    gc.setRenderHint(QPainter::Antialiasing);
+    gc.setPen(Qt::NoPen);
+
+    gc.setBrush(QColor(20, 40, 60, 255));
+    gc.drawEllipse(QRectF(QPointF(), size).adjusted(2, 2, -2, -2));
+
+    gc.setBrush(QColor(200, 100, 50, 128));
+    gc.drawRect(QRectF(QPointF(), size).adjusted(size.width() / 4, size.height() / 4, 0, 0));
+
+    return image;
+}
+
+qreal totalAlpha(const QImage &image)
+{
+    qreal result = 0;
+
+    for (int y = 0; y < image.height(); y++) {
+        const QRgb *pixel = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        for (int x = 0; x < image.width(); x++) {
+            result += qAlpha(pixel[x]);
+        }
+    }
+
+    return result;
+}
+}
+
+void KisBrushTipPyramidTest::testLevels()
+{
+    KisBrushTipPyramid pyramid(createTipImage(QSize(41, 17)));
+
+    QCOMPARE(pyramid.originalSize(), QSize(41, 17));
+    QCOMPARE(pyramid.numLevels(), 5);
+
+    const QVector<QSize> expectedSizes = {
+        QSize(41, 17), QSize(20, 8), QSize(10, 4), QSize(5, 2), QSize(2, 1)
+    };
+
+    for (int i = 0; i < pyramid.numLevels(); i++) {
+        const KisBrushTipPyramid::Level &level = pyramid.m_levels[i];
+        QCOMPARE(level.size, expectedSizes[i]);
+
+        // the downsampling must keep the average opacity of the level
+        qreal sum = 0;
+        for (int y = 0; y < level.size.height(); y++) {
+            const float *row = level.view().pixels + y * level.view().rowStride;
+            for (int x = 0; x < level.size.width(); x++) {
+                sum += row[4 * x + 3];
+            }
+        }
+
+        const qreal average = sum / (level.size.width() * level.size.height());
+        const qreal baseAverage = totalAlpha(createTipImage(QSize(41, 17))) / 255.0 / (41 * 17);
+        QVERIFY2(qAbs(average - baseAverage) < 0.05,
+                 qPrintable(QString("level %1: %2 vs %3").arg(i).arg(average).arg(baseAverage)));
+    }
+
+    qreal levelScale = 0.0;
+    QCOMPARE(pyramid.findNearestLevel(1.0, &levelScale), 0);
+    QCOMPARE(levelScale, 1.0);
+    QCOMPARE(pyramid.findNearestLevel(2.0, &levelScale), 0);
+    QCOMPARE(pyramid.findNearestLevel(0.5, &levelScale), 1);
+    QCOMPARE(levelScale, 0.5);
+    QCOMPARE(pyramid.findNearestLevel(0.3, &levelScale), 1);
+    QCOMPARE(pyramid.findNearestLevel(0.25 + 1e-7, &levelScale), 2);
+    QCOMPARE(pyramid.findNearestLevel(0.001, &levelScale), 4);
+}
+
+void KisBrushTipPyramidTest::testIdentityTransform()
+{
+    const QImage image = createTipImage(QSize(37, 29));
+    KisBrushTipPyramid pyramid(image);
+
+    const QImage result = pyramid.createImage(KisDabShape(), 0.0, 0.0);
+
+    QCOMPARE(result.format(), QImage::Format_ARGB32);
+    QCOMPARE(result.size(), image.size());
+
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            const QRgb expected = image.pixel(x, y);
+            const QRgb real = result.pixel(x, y);
+
+            QCOMPARE(qAlpha(real), qAlpha(expected));
+
+            if (qAlpha(expected)) {
+                QVERIFY(qAbs(qRed(real) - qRed(expected)) <= 1);
+                QVERIFY(qAbs(qGreen(real) - qGreen(expected)) <= 1);
+                QVERIFY(qAbs(qBlue(real) - qBlue(expected)) <= 1);
+            }
+        }
+    }
+}
+
+void KisBrushTipPyramidTest::testImageSize_data()
+{
+    QTest::addColumn<qreal>("scale");
+    QTest::addColumn<qreal>("ratio");
+    QTest::addColumn<qreal>("rotation");
+    QTest::addColumn<qreal>("subPixel");
+
+    QTest::newRow("identity") << 1.0 << 1.0 << 0.0 << 0.0;
+    QTest::newRow("subpixel") << 1.0 << 1.0 << 0.0 << 0.3;
+    QTest::newRow("downscale") << 0.37 << 1.0 << 0.0 << 0.0;
+    QTest::newRow("upscale") << 2.7 << 1.0 << 0.0 << 0.5;
+    QTest::newRow("ratio") << 0.8 << 0.5 << 0.0 << 0.0;
+    QTest::newRow("rotation") << 0.6 << 1.0 << 1.1 << 0.25;
+    QTest::newRow("rotation-ratio") << 1.3 << 0.7 << 4.0 << 0.75;
+}
+
+void KisBrushTipPyramidTest::testImageSize()
+{
+    QFETCH(qreal, scale);
+    QFETCH(qreal, ratio);
+    QFETCH(qreal, rotation);
+    QFETCH(qreal, subPixel);
+
+    const QSize size(150, 110);
+    KisBrushTipPyramid pyramid(createTipImage(size));
+    const KisDabShape shape(scale, ratio, rotation);
+
+    const QImage result = pyramid.createImage(shape, subPixel, subPixel);
+    QCOMPARE(result.size(), KisQImagePyramid::imageSize(size, shape, subPixel, subPixel));
+
+    KisQImagePyramid referencePyramid(createTipImage(size));
+    QCOMPARE(result.size(), referencePyramid.createImage(shape, subPixel, subPixel).size());
+}
+
+void KisBrushTipPyramidTest::testCoverage_data()
+{
+    testImageSize_data();
+}
+
+void KisBrushTipPyramidTest::testCoverage()
+{
+    QFETCH(qreal, scale);
+    QFETCH(qreal, ratio);
+    QFETCH(qreal, rotation);
+    QFETCH(qreal, subPixel);
+
+    const QSize size(150, 110);
+    const QImage image = createTipImage(size);
+    KisBrushTipPyramid pyramid(image);
+    const KisDabShape shape(scale, ratio, rotation);
+
+    /**
+     * The total opacity of the dab should follow its area, whatever
+     * level and filter the pyramid chooses
+     */
+    const qreal expected = totalAlpha(image) * shape.scaleX() * shape.scaleY();
+    const qreal real = totalAlpha(pyramid.createImage(shape, subPixel, subPixel));
+
+    QVERIFY2(qAbs(real - expected) < 0.02 * expected,
+             qPrintable(QString("%1 vs %2").arg(real).arg(expected)));
+}
+
+void KisBrushTipPyramidTest::testNearestEnlarging()
+{
+    QImage image(2, 1, QImage::Format_ARGB32);
+    image.setPixel(0, 0, qRgba(255, 0, 0, 255));
+    image.setPixel(1, 0, qRgba(0, 0, 255, 255));
+
+    KisBrushTipPyramid pyramid(image, false);
+
+    const QImage result = pyramid.createImage(KisDabShape(4.0, 1.0, 0.0), 0.0, 0.0);
+    QCOMPARE(result.size(), QSize(8, 4));
+
+    for (int y = 0; y < result.height(); y++) {
+        for (int x = 0; x < result.width(); x++) {
+            QCOMPARE(result.pixel(x, y), x < 4 ? image.pixel(0, 0) : image.pixel(1, 0));
+        }
+    }
+}
+
+void KisBrushTipPyramidTest::benchmarkHugeTip()
+{
+    KisBrushTipPyramid pyramid(createTipImage(QSize(2048, 2048)));
+    qsrand(1);
+
+    QBENCHMARK {
+        const qreal scale = 0.1 + qreal(qrand()) / RAND_MAX * 1.2;
+        const qreal rotation = qreal(qrand()) / RAND_MAX * 2 * M_PI;
+        QVERIFY(!pyramid.createImage(KisDabShape(scale, 1.0, rotation), 0.3, 0.6).isNull());
+    }
+}
+
+SIMPLE_TEST_MAIN(KisBrushTipPyramidTest)
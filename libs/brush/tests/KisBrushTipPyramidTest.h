@@ -0,0 +1,27 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBRUSHTIPPYRAMIDTEST_H
+#define KISBRUSHTIPPYRAMIDTEST_H
+
+#include <simpletest.h>
+
+class KisBrushTipPyramidTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testLevels();
+    void testIdentityTransform();
+    void testImageSize_data();
+    void testImageSize();
+    void testCoverage_data();
+    void testCoverage();
+    void testNearestEnlarging();
+
+    void benchmarkHugeTip();
+};
+
+#endif // KISBRUSHTIPPYRAMIDTEST_H
@@ -116,6 +116,7 @@ void KisGbrBrushTest::testImageGeneration()
 }
 
 #include "kis_qimage_pyramid.h"
+#include "KisBrushTipPyramid.h"
 
 void KisGbrBrushTest::benchmarkPyramidCreation()
 {
@@ -130,6 +131,18 @@ void KisGbrBrushTest::benchmarkPyramidCreation()
     }
 }
 
+void KisGbrBrushTest::benchmarkTipPyramidCreation()
+{
+    QScopedPointer<KisGbrBrush> brush(new KisGbrBrush(QString(FILES_DATA_DIR) + '/' + "testing_brush_512_bars.gbr"));
+    brush->load(KisGlobalResourcesInterface::instance());
+    QVERIFY(!brush->brushTipImage().isNull());
+
+    QBENCHMARK {
+        KisBrushTipPyramid pyramid(brush->brushTipImage());
+        QVERIFY(pyramid.numLevels() > 0); // avoid compiler elimination of unused code!
+    }
+}
+
 void KisGbrBrushTest::benchmarkScaling()
 {
     QScopedPointer<KisGbrBrush> brush(new KisGbrBrush(QString(FILES_DATA_DIR) + '/' + "testing_brush_512_bars.gbr"));
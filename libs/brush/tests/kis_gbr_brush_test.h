@@ -22,6 +22,7 @@ private Q_SLOTS:
     void testImageGeneration();
 
     void benchmarkPyramidCreation();
+    void benchmarkTipPyramidCreation();
     void benchmarkScaling();
     void benchmarkRotation();
     void benchmarkMaskScaling();
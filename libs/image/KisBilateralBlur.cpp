@@ -0,0 +1,418 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBilateralBlur.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QBitArray>
+#include <QRect>
+#include <QVector>
+#include <QtMath>
+
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
+
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_default_bounds_base.h"
+#include "KisPremultipliedChannelConverter.h"
+
+const qreal KisBilateralBlur::gridMinimumRadius = 4.0;
+
+namespace {
+
+/**
+ * The number of empty cells around the splatted data, which
+ * are needed for the blur kernel and the trilinear slicing
+ */
+const int gridPadding = 2;
+
+const int maxBlockSize = 256;
+const int minBlockSize = 64;
+const qint64 maxGridBytes = 32 * 1024 * 1024;
+
+const int rangeLutSize = 1024;
+
+struct SourceData
+{
+    QRect rect;
+    QVector<quint8> bytes;
+    QVector<float> values;
+    QVector<float> lightness;
+
+    inline int index(int x, int y) const {
+        return (y - rect.y()) * rect.width() + (x - rect.x());
+    }
+};
+
+void readSource(KisPaintDeviceSP device, const QRect &rect,
+                const KisPremultipliedChannelConverter &converter,
+                SourceData &data)
+{
+    const int numPixels = rect.width() * rect.height();
+
+    data.rect = rect;
+    data.bytes.resize(numPixels * converter.pixelSize);
+    data.values.resize(numPixels * converter.numChannels());
+    data.lightness.resize(numPixels);
+
+    device->readBytes(data.bytes.data(), rect);
+    converter.toFloat(data.bytes.constData(), data.values.data(), numPixels);
+
+    /**
+     * The lightness is used as the range dimension for all the
+     * channels, so the color channels are not shifted independently
+     */
+    QVector<quint16> lab(numPixels * 4);
+    device->colorSpace()->toLabA16(data.bytes.constData(),
+                                   reinterpret_cast<quint8*>(lab.data()),
+                                   numPixels);
+
+    for (int i = 0; i < numPixels; i++) {
+        data.lightness[i] = lab[4 * i] / 65535.0f;
+    }
+}
+
+void writeResult(KisPaintDeviceSP dst, const QRect &blockRect,
+                 const SourceData &src, const QVector<float> &result,
+                 const KisPremultipliedChannelConverter &converter)
+{
+    const int pixelSize = converter.pixelSize;
+    const int rowSize = blockRect.width() * pixelSize;
+    QVector<quint8> bytes(blockRect.height() * rowSize);
+
+    // the channels, which are not filtered, are kept as they are
+    for (int row = 0; row < blockRect.height(); row++) {
+        memcpy(bytes.data() + row * rowSize,
+               src.bytes.constData() + src.index(blockRect.x(), blockRect.y() + row) * pixelSize,
+               rowSize);
+    }
+
+    converter.fromFloat(result.constData(), bytes.data(), blockRect.width() * blockRect.height());
+    dst->writeBytes(bytes.constData(), blockRect);
+}
+
+QVector<float> rangeWeights(qreal rangeSigma)
+{
+    QVector<float> weights(rangeLutSize + 1);
+    for (int i = 0; i <= rangeLutSize; i++) {
+        const qreal d = qreal(i) / rangeLutSize;
+        weights[i] = std::exp(-0.5 * d * d / (rangeSigma * rangeSigma));
+    }
+    return weights;
+}
+
+/**
+ * The brute-force bilateral filter, which is cheap enough
+ * for the small radii
+ */
+void filterExact(const SourceData &src, const QRect &blockRect,
+                 qreal radius, qreal rangeSigma, int numChannels,
+                 QVector<float> &result)
+{
+    const int window = qCeil(radius);
+    const int windowSize = 2 * window + 1;
+    const qreal spatialSigma = 0.5 * radius;
+
+    QVector<float> spatialWeights(windowSize * windowSize);
+    for (int dy = -window; dy <= window; dy++) {
+        for (int dx = -window; dx <= window; dx++) {
+            spatialWeights[(dy + window) * windowSize + dx + window] =
+                std::exp(-0.5 * (dx * dx + dy * dy) / (spatialSigma * spatialSigma));
+        }
+    }
+
+    const QVector<float> range = rangeWeights(rangeSigma);
+    QVector<float> accumulator(numChannels);
+    float *dst = result.data();
+
+    for (int y = blockRect.top(); y <= blockRect.bottom(); y++) {
+        const int top = qMax(y - window, src.rect.top());
+        const int bottom = qMin(y + window, src.rect.bottom());
+
+        for (int x = blockRect.left(); x <= blockRect.right(); x++) {
+            const int left = qMax(x - window, src.rect.left());
+            const int right = qMin(x + window, src.rect.right());
+
+            const float lightness = src.lightness[src.index(x, y)];
+            std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+            float totalWeight = 0.0f;
+
+            for (int sy = top; sy <= bottom; sy++) {
+                const float *spatialRow = spatialWeights.constData() +
+                    (sy - y + window) * windowSize + (left - x + window);
+                int index = src.index(left, sy);
+
+                for (int i = 0; i <= right - left; i++, index++) {
+                    const int rangeIndex = qRound(std::abs(src.lightness[index] - lightness) * rangeLutSize);
+                    const float weight = spatialRow[i] * range[rangeIndex];
+                    const float *values = src.values.constData() + index * numChannels;
+
+                    for (int c = 0; c < numChannels; c++) {
+                        accumulator[c] += weight * values[c];
+                    }
+                    totalWeight += weight;
+                }
+            }
+
+            // the pixel itself always has the weight of 1.0
+            for (int c = 0; c < numChannels; c++) {
+                dst[c] = accumulator[c] / totalWeight;
+            }
+            dst += numChannels;
+        }
+    }
+}
+
+/**
+ * Blurs \p length cells, separated by \p step floats, with the
+ * [1 4 6 4 1] / 16 kernel. Every cell consists of \p width values.
+ * The cells outside the line are considered to be empty.
+ */
+void blurGridLine(float *data, int length, int step, int width, QVector<float> &buffer)
+{
+    buffer.resize(length * width);
+
+    for (int n = 0; n < length; n++) {
+        memcpy(buffer.data() + n * width, data + n * step, width * sizeof(float));
+    }
+
+    const float weights[5] = {1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16, 1.0f / 16};
+
+    for (int n = 0; n < length; n++) {
+        float *cell = data + n * step;
+        std::fill(cell, cell + width, 0.0f);
+
+        for (int k = qMax(0, n - 2); k <= qMin(length - 1, n + 2); k++) {
+            const float weight = weights[k - n + 2];
+            const float *srcCell = buffer.constData() + k * width;
+
+            for (int i = 0; i < width; i++) {
+                cell[i] += weight * srcCell[i];
+            }
+        }
+    }
+}
+
+inline int gridCell(qreal pos, qreal sampling)
+{
+    return int(std::floor(pos / sampling + 0.5));
+}
+
+/**
+ * The bilateral grid: Paris, S., Durand, F. "A Fast Approximation of
+ * the Bilateral Filter using a Signal Processing Approach", 2006.
+ *
+ * The pixels are splatted into a coarse 3D grid of (x, y, lightness),
+ * the grid is blurred along all the three axes and the result is
+ * sliced back with the trilinear interpolation. The cells are aligned
+ * to the image coordinates, so the neighbouring blocks produce the
+ * same values on their borders.
+ */
+void filterGrid(const SourceData &src, const QRect &blockRect,
+                qreal radius, qreal rangeSigma, int numChannels,
+                QVector<float> &result)
+{
+    const qreal spatialSampling = 0.5 * radius;
+    const int stride = numChannels + 1;
+
+    const int x0 = gridCell(src.rect.left(), spatialSampling) - gridPadding;
+    const int y0 = gridCell(src.rect.top(), spatialSampling) - gridPadding;
+    const int z0 = -gridPadding;
+
+    const int gridWidth = gridCell(src.rect.right(), spatialSampling) + gridPadding - x0 + 1;
+    const int gridHeight = gridCell(src.rect.bottom(), spatialSampling) + gridPadding - y0 + 1;
+    const int gridDepth = gridCell(1.0, rangeSigma) + gridPadding - z0 + 1;
+
+    const int rowStride = gridWidth * stride;
+    const int layerStride = gridHeight * rowStride;
+
+    QVector<float> grid(gridDepth * layerStride, 0.0f);
+
+    for (int y = src.rect.top(); y <= src.rect.bottom(); y++) {
+        const int gy = gridCell(y, spatialSampling) - y0;
+        int index = src.index(src.rect.left(), y);
+
+        for (int x = src.rect.left(); x <= src.rect.right(); x++, index++) {
+            const int gx = gridCell(x, spatialSampling) - x0;
+            const int gz = gridCell(src.lightness[index], rangeSigma) - z0;
+
+            float *cell = grid.data() + gz * layerStride + gy * rowStride + gx * stride;
+            const float *values = src.values.constData() + index * numChannels;
+
+            for (int c = 0; c < numChannels; c++) {
+                cell[c] += values[c];
+            }
+            cell[numChannels] += 1.0f;
+        }
+    }
+
+    QVector<float> buffer;
+
+    for (int z = 0; z < gridDepth; z++) {
+        for (int y = 0; y < gridHeight; y++) {
+            blurGridLine(grid.data() + z * layerStride + y * rowStride,
+                         gridWidth, stride, stride, buffer);
+        }
+        for (int x = 0; x < gridWidth; x++) {
+            blurGridLine(grid.data() + z * layerStride + x * stride,
+                         gridHeight, rowStride, stride, buffer);
+        }
+    }
+
+    for (int y = 0; y < gridHeight; y++) {
+        for (int x = 0; x < gridWidth; x++) {
+            blurGridLine(grid.data() + y * rowStride + x * stride,
+                         gridDepth, layerStride, stride, buffer);
+        }
+    }
+
+    QVector<float> accumulator(stride);
+    float *dst = result.data();
+
+    for (int y = blockRect.top(); y <= blockRect.bottom(); y++) {
+        const qreal fy = y / spatialSampling - y0;
+        const int iy = int(std::floor(fy));
+        const float ty = fy - iy;
+
+        for (int x = blockRect.left(); x <= blockRect.right(); x++) {
+            const qreal fx = x / spatialSampling - x0;
+            const int ix = int(std::floor(fx));
+            const float tx = fx - ix;
+
+            const int index = src.index(x, y);
+            const qreal fz = src.lightness[index] / rangeSigma - z0;
+            const int iz = qBound(0, int(std::floor(fz)), gridDepth - 2);
+            const float tz = qBound(0.0, fz - iz, 1.0);
+
+            std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+
+            for (int k = 0; k < 8; k++) {
+                const int dx = k & 0x1;
+                const int dy = (k >> 1) & 0x1;
+                const int dz = (k >> 2) & 0x1;
+
+                const float weight =
+                    (dx ? tx : 1.0f - tx) *
+                    (dy ? ty : 1.0f - ty) *
+                    (dz ? tz : 1.0f - tz);
+
+                const float *cell = grid.constData() +
+                    (iz + dz) * layerStride + (iy + dy) * rowStride + (ix + dx) * stride;
+
+                for (int c = 0; c < stride; c++) {
+                    accumulator[c] += weight * cell[c];
+                }
+            }
+
+            const float totalWeight = accumulator[numChannels];
+            const float *values = src.values.constData() + index * numChannels;
+
+            for (int c = 0; c < numChannels; c++) {
+                dst[c] = totalWeight > 1e-6f ? accumulator[c] / totalWeight : values[c];
+            }
+            dst += numChannels;
+        }
+    }
+}
+
+}
+
+int KisBilateralBlur::haloSize(qreal radius)
+{
+    /**
+     * The grid cell is affected by the pixels, which are up to
+     * 3.5 cells (of radius / 2 pixels) away from it: half of the
+     * cell comes from splatting, two from the blur and one from
+     * the trilinear interpolation.
+     */
+    return radius < gridMinimumRadius ? qCeil(radius) : qCeil(2.0 * radius);
+}
+
+void KisBilateralBlur::apply(KisPaintDeviceSP device,
+                             const QRect& rect,
+                             qreal radius, qreal threshold,
+                             const QBitArray &channelFlags,
+                             KoUpdater *progressUpdater)
+{
+    if (rect.isEmpty() || radius <= 0.0) return;
+
+    const KisPremultipliedChannelConverter converter(device->colorSpace(), channelFlags);
+    const int numChannels = converter.numChannels();
+    if (!numChannels) return;
+
+    const qreal rangeSigma = qMax(1.0, threshold) / (2.0 * 255.0);
+    const bool useGrid = radius >= gridMinimumRadius;
+    const int halo = haloSize(radius);
+
+    QRect sourceBounds = rect.adjusted(-halo, -halo, halo, halo);
+
+    /**
+     * The wraparound mode is handled by the paint device itself,
+     * otherwise the pixels outside the image are just skipped
+     * (the weights are normalized anyway)
+     */
+    if (!device->defaultBounds()->wrapAroundMode()) {
+        sourceBounds &= rect | device->defaultBounds()->bounds();
+    }
+
+    int blockSize = maxBlockSize;
+
+    if (useGrid) {
+        const qreal spatialSampling = 0.5 * radius;
+        const qint64 gridDepth = qCeil(1.0 / rangeSigma) + 2 * gridPadding + 2;
+
+        auto gridBytes = [&] (int size) {
+            const qint64 side = qCeil((size + 2 * halo) / spatialSampling) + 2 * gridPadding + 2;
+            return side * side * gridDepth * (numChannels + 1) * qint64(sizeof(float));
+        };
+
+        while (blockSize > minBlockSize && gridBytes(blockSize) > maxGridBytes) {
+            blockSize /= 2;
+        }
+    }
+
+    const int numBlocks =
+        ((rect.width() + blockSize - 1) / blockSize) *
+        ((rect.height() + blockSize - 1) / blockSize);
+    int doneBlocks = 0;
+
+    /**
+     * The blocks read the pixels of their neighbours,
+     * so the result is collected in a separate device
+     */
+    KisPaintDeviceSP dst = new KisPaintDevice(device->colorSpace());
+    dst->prepareClone(device);
+
+    SourceData src;
+    QVector<float> result;
+
+    for (int y = rect.top(); y <= rect.bottom(); y += blockSize) {
+        for (int x = rect.left(); x <= rect.right(); x += blockSize) {
+            const QRect blockRect = QRect(x, y, blockSize, blockSize) & rect;
+            const QRect sourceRect = blockRect.adjusted(-halo, -halo, halo, halo) & sourceBounds;
+
+            readSource(device, sourceRect, converter, src);
+            result.resize(blockRect.width() * blockRect.height() * numChannels);
+
+            if (useGrid) {
+                filterGrid(src, blockRect, radius, rangeSigma, numChannels, result);
+            } else {
+                filterExact(src, blockRect, radius, rangeSigma, numChannels, result);
+            }
+
+            writeResult(dst, blockRect, src, result, converter);
+
+            if (progressUpdater) {
+                progressUpdater->setProgress(100 * ++doneBlocks / numBlocks);
+            }
+        }
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), dst, device, rect);
+}
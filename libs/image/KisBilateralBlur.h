@@ -0,0 +1,61 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBILATERALBLUR_H
+#define KISBILATERALBLUR_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+class QBitArray;
+class KoUpdater;
+
+/**
+ * An edge-preserving (surface) blur. Every pixel is replaced with the
+ * average of its neighbours, weighted by both the spatial distance
+ * and the difference of the lightness, so the areas of similar
+ * tone are smoothed, but the edges between them are kept sharp.
+ *
+ * The spatial sigma is half of \p radius. The range sigma is half of
+ * \p threshold, which is measured in the levels of the lightness
+ * (0...255), so the neighbours that differ by more than \p threshold
+ * contribute less than 14% of their weight.
+ *
+ * The small radii are filtered exactly. The bigger ones use the
+ * bilateral grid by Paris and Durand, which has a linear cost,
+ * independent from the radius. The area is processed in blocks,
+ * which are aligned to the same grid, so the result doesn't depend
+ * on the way the rect is split.
+ */
+class KRITAIMAGE_EXPORT KisBilateralBlur
+{
+public:
+    /**
+     * The smallest radius the bilateral grid is used for
+     */
+    static const qreal gridMinimumRadius;
+
+    /**
+     * The distance of the farthest source pixel, which may
+     * affect the result of the filter
+     */
+    static int haloSize(qreal radius);
+
+    /**
+     * Filters \p rect of \p device in place. The pixels outside \p rect,
+     * which are up to haloSize() pixels away from it, are used as the
+     * source data. The pixels outside the bounds of the image don't
+     * take part in the filtering.
+     */
+    static void apply(KisPaintDeviceSP device,
+                      const QRect& rect,
+                      qreal radius, qreal threshold,
+                      const QBitArray &channelFlags,
+                      KoUpdater *progressUpdater);
+};
+
+#endif // KISBILATERALBLUR_H
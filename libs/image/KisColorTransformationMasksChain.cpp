@@ -0,0 +1,182 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisColorTransformationMasksChain.h"
+
+#include <QVector>
+
+#include <KoColorSpace.h>
+#include <KoColorTransformation.h>
+
+#include "kis_filter_mask.h"
+#include "kis_paint_device.h"
+#include "kis_busy_progress_indicator.h"
+#include "kis_sequential_iterator.h"
+#include "kis_selection.h"
+#include "kis_pixel_selection.h"
+#include "filter/kis_filter_registry.h"
+#include "filter/kis_color_transformation_filter.h"
+#include "filter/kis_color_transformation_configuration.h"
+
+
+struct KisColorTransformationMasksChain::Private
+{
+    const KoColorSpace *colorSpace = 0;
+
+    /**
+     * The transformations are either cached by the configurations
+     * (which are kept alive in \p configurations) or owned by the chain
+     */
+    QVector<KoColorTransformation*> transformations;
+    QVector<KoColorTransformation*> ownedTransformations;
+    QVector<KisFilterConfigurationSP> configurations;
+
+    void reset() {
+        qDeleteAll(ownedTransformations);
+        ownedTransformations.clear();
+        transformations.clear();
+        configurations.clear();
+    }
+};
+
+KisColorTransformationMasksChain::KisColorTransformationMasksChain(const KoColorSpace *colorSpace)
+    : m_d(new Private)
+{
+    m_d->colorSpace = colorSpace;
+}
+
+KisColorTransformationMasksChain::~KisColorTransformationMasksChain()
+{
+    m_d->reset();
+}
+
+namespace {
+
+/**
+ * Returns true if every pixel of \p rect is fully selected. The masks
+ * created in the UI always have a selection, which is usually the
+ * default white one with no pixel data at all, so the check is cheap
+ * in the common case.
+ */
+bool isFullySelected(KisSelectionSP selection, const QRect &rect)
+{
+    if (selection->hasShapeSelection()) return false;
+
+    KisPixelSelectionSP pixelSelection = selection->pixelSelection();
+    const QRect nonDefaultArea = pixelSelection->nonDefaultPixelArea();
+
+    // the pixels outside the non-default area are equal to the default one
+    if (*pixelSelection->defaultPixel().data() != MAX_SELECTED &&
+        !nonDefaultArea.contains(rect)) {
+
+        return false;
+    }
+
+    const QRect checkRect = nonDefaultArea & rect;
+    if (checkRect.isEmpty()) return true;
+
+    KisSequentialConstIterator it(pixelSelection, checkRect);
+    while (it.nextPixel()) {
+        if (*it.rawDataConst() != MAX_SELECTED) return false;
+    }
+
+    return true;
+}
+
+}
+
+bool KisColorTransformationMasksChain::canFuseMask(KisEffectMaskSP mask, const QRect &rect)
+{
+    KisFilterMask *filterMask = dynamic_cast<KisFilterMask*>(mask.data());
+    if (!filterMask) return false;
+
+    KisSelectionSP selection = filterMask->selection();
+
+    if (selection) {
+        // the user may be painting on the selection of the mask right now
+        KisIndirectPaintingSupport::ReadLocker l(filterMask);
+        if (filterMask->hasTemporaryTarget() || !isFullySelected(selection, rect)) {
+            return false;
+        }
+    }
+
+    KisFilterConfigurationSP config = filterMask->filter();
+    if (!config) return false;
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value(config->name());
+    return dynamic_cast<const KisColorTransformationFilter*>(filter.data());
+}
+
+void KisColorTransformationMasksChain::appendMask(KisEffectMaskSP mask)
+{
+    KisFilterMask *filterMask = dynamic_cast<KisFilterMask*>(mask.data());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(filterMask);
+
+    KisFilterConfigurationSP config = filterMask->filter();
+    KIS_SAFE_ASSERT_RECOVER_RETURN(config);
+
+    KisFilterSP filterSP = KisFilterRegistry::instance()->value(config->name());
+    const KisColorTransformationFilter *filter =
+        dynamic_cast<const KisColorTransformationFilter*>(filterSP.data());
+    KIS_SAFE_ASSERT_RECOVER_RETURN(filter);
+
+    if (filterMask->busyProgressIndicator()) {
+        filterMask->busyProgressIndicator()->update();
+    }
+
+    KoColorTransformation *transformation = 0;
+
+    // same as in KisColorTransformationFilter::processImpl()
+    const KisColorTransformationConfiguration *colorTransformationConfiguration =
+        dynamic_cast<const KisColorTransformationConfiguration*>(config.data());
+
+    if (colorTransformationConfiguration) {
+        transformation = colorTransformationConfiguration->colorTransformation(m_d->colorSpace, filter);
+    } else {
+        transformation = filter->createTransformation(m_d->colorSpace, config);
+        if (transformation) {
+            m_d->ownedTransformations.append(transformation);
+        }
+    }
+
+    if (transformation) {
+        m_d->transformations.append(transformation);
+        m_d->configurations.append(config);
+    }
+}
+
+bool KisColorTransformationMasksChain::isEmpty() const
+{
+    return m_d->transformations.isEmpty();
+}
+
+int KisColorTransformationMasksChain::size() const
+{
+    return m_d->transformations.size();
+}
+
+void KisColorTransformationMasksChain::apply(KisPaintDeviceSP device, const QRect &rect)
+{
+    if (!m_d->transformations.isEmpty() && !rect.isEmpty()) {
+        KisSequentialIterator it(device, rect);
+
+        int conseq = it.nConseqPixels();
+        while (it.nextPixels(conseq)) {
+            conseq = it.nConseqPixels();
+
+            /**
+             * The pixels of the current run stay in cache while
+             * they pass through all the transformations
+             */
+            quint8 *pixels = it.rawData();
+            for (int i = 0; i < m_d->transformations.size(); i++) {
+                m_d->transformations[i]->transform(pixels, pixels, conseq);
+            }
+        }
+    }
+
+    m_d->reset();
+}
@@ -0,0 +1,69 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISCOLORTRANSFORMATIONMASKSCHAIN_H
+#define KISCOLORTRANSFORMATIONMASKSCHAIN_H
+
+#include <QScopedPointer>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+class KoColorSpace;
+
+/**
+ * Fuses consecutive filter masks, which do nothing but a per-pixel
+ * color transformation, into a single pass over the pixels.
+ *
+ * Usually every filter mask copies the projection into a cache device,
+ * clears the projection and filters the cache device back into it. For
+ * a chain of color adjustments (curves, levels, HSV adjustment, etc.)
+ * it is enough to read every pixel once and push it through all the
+ * transformations while it is still in the cache.
+ *
+ * The result is the same as applying the masks one by one, because
+ * each transformation is still applied to the result of the previous
+ * one, only the intermediate devices are skipped.
+ *
+ * Only the filter masks of one layer are fused. The adjustment layers
+ * are separate nodes, which are composited into their parent with
+ * their own opacity and blending mode, so they are not fused.
+ */
+class KRITAIMAGE_EXPORT KisColorTransformationMasksChain
+{
+public:
+    KisColorTransformationMasksChain(const KoColorSpace *colorSpace);
+    ~KisColorTransformationMasksChain();
+
+    /**
+     * Returns true if \p mask can be added to the chain for \p rect: it
+     * is a filter mask, whose filter is a KisColorTransformationFilter,
+     * and it either has no selection or its selection is fully selected
+     * in \p rect (like the default white selection of a new mask).
+     */
+    static bool canFuseMask(KisEffectMaskSP mask, const QRect &rect);
+
+    /**
+     * Adds \p mask to the end of the chain. The mask must satisfy
+     * canFuseMask().
+     */
+    void appendMask(KisEffectMaskSP mask);
+
+    bool isEmpty() const;
+    int size() const;
+
+    /**
+     * Applies all the transformations of the chain to \p rect of
+     * \p device in place and resets the chain.
+     */
+    void apply(KisPaintDeviceSP device, const QRect &rect);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISCOLORTRANSFORMATIONMASKSCHAIN_H
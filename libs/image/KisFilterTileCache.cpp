@@ -0,0 +1,376 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisFilterTileCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QRect>
+#include <QSet>
+#include <QVector>
+
+#include <KoColorSpace.h>
+
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_default_bounds_base.h"
+#include "KisThreadPoolRunnableStrokeJobsExecutor.h"
+#include "filter/kis_filter.h"
+#include "filter/kis_filter_configuration.h"
+#include "filter/kis_color_transformation_filter.h"
+
+namespace {
+
+const int tileSize = 64;
+
+typedef QPair<int, int> TileIndex;
+
+inline int tileStart(int pos)
+{
+    // rounds the negative coordinates down as well
+    return pos & ~(tileSize - 1);
+}
+
+inline TileIndex tileIndex(const QRect &tileRect)
+{
+    return qMakePair(tileRect.x() / tileSize, tileRect.y() / tileSize);
+}
+
+/**
+ * The tiles of the paint device, which intersect \p rect,
+ * in the row-major order
+ */
+QVector<QRect> tilesOf(const QRect &rect)
+{
+    QVector<QRect> tiles;
+
+    for (int y = tileStart(rect.top()); y <= rect.bottom(); y += tileSize) {
+        for (int x = tileStart(rect.left()); x <= rect.right(); x += tileSize) {
+            tiles.append(QRect(x, y, tileSize, tileSize));
+        }
+    }
+
+    return tiles;
+}
+
+}
+
+/**
+ * The cached data of one level of detail
+ */
+struct LevelCache
+{
+    KisPaintDeviceSP source;
+    KisPaintDeviceSP results;
+    QSet<TileIndex> validTiles;
+
+    /**
+     * The tiles, which hold any data in source or results,
+     * with the stamp of their last use
+     */
+    QHash<TileIndex, quint64> tileUses;
+};
+
+struct KisFilterTileCache::Private
+{
+    QMutex mutex;
+
+    qint64 memoryLimit {0};
+
+    KisFilterConfigurationSP config;
+    const KoColorSpace *colorSpace {0};
+
+    QMap<int, LevelCache> levels;
+    quint64 useCounter {0};
+
+    int lastReusedTiles {0};
+
+    bool matches(KisFilterConfigurationSP config, const KoColorSpace *cs) const;
+    void reset(KisFilterConfigurationSP config, const KoColorSpace *cs);
+
+    LevelCache& level(int lod);
+
+    void invalidateChangedSource(KisFilterSP filter, LevelCache &level, int lod,
+                                 KisPaintDeviceSP src, const QRect &area);
+
+    void touchTiles(LevelCache &level, const QRect &rect, quint64 stamp, bool addMissing);
+    void evictTiles(KisFilterSP filter);
+};
+
+bool KisFilterTileCache::Private::matches(KisFilterConfigurationSP config, const KoColorSpace *cs) const
+{
+    return this->config &&
+        *colorSpace == *cs &&
+        this->config->compareTo(config.data());
+}
+
+void KisFilterTileCache::Private::reset(KisFilterConfigurationSP config, const KoColorSpace *cs)
+{
+    // the configuration may be changed in place by its owner later
+    this->config = config ? config->clone() : KisFilterConfigurationSP();
+    colorSpace = cs;
+
+    levels.clear();
+}
+
+LevelCache& KisFilterTileCache::Private::level(int lod)
+{
+    LevelCache &level = levels[lod];
+
+    if (!level.source) {
+        level.source = new KisPaintDevice(colorSpace);
+        level.results = new KisPaintDevice(colorSpace);
+    }
+
+    return level;
+}
+
+/**
+ * Compares the pixels of \p src to the stored source in \p area
+ * and drops the results of the tiles, which are affected by the
+ * changed pixels
+ */
+void KisFilterTileCache::Private::invalidateChangedSource(KisFilterSP filter, LevelCache &level, int lod,
+                                                          KisPaintDeviceSP src, const QRect &area)
+{
+    if (level.validTiles.isEmpty()) return;
+
+    const int pixelSize = src->pixelSize();
+    QVector<quint8> srcBytes;
+    QVector<quint8> storedBytes;
+
+    Q_FOREACH (const QRect &tile, tilesOf(area)) {
+        const QRect rect = tile & area;
+        const int numBytes = rect.width() * rect.height() * pixelSize;
+
+        srcBytes.resize(numBytes);
+        storedBytes.resize(numBytes);
+
+        src->readBytes(srcBytes.data(), rect);
+        level.source->readBytes(storedBytes.data(), rect);
+
+        if (!memcmp(srcBytes.constData(), storedBytes.constData(), numBytes)) continue;
+
+        const QRect changedRect = filter->changedRect(rect, config, lod);
+
+        Q_FOREACH (const QRect &changedTile, tilesOf(changedRect)) {
+            level.validTiles.remove(tileIndex(changedTile));
+        }
+    }
+}
+
+void KisFilterTileCache::Private::touchTiles(LevelCache &level, const QRect &rect, quint64 stamp, bool addMissing)
+{
+    Q_FOREACH (const QRect &tile, tilesOf(rect)) {
+        const TileIndex index = tileIndex(tile);
+
+        if (addMissing || level.tileUses.contains(index)) {
+            level.tileUses[index] = stamp;
+        }
+    }
+}
+
+/**
+ * Drops the least recently used tiles of all the levels until the
+ * cache fits into the memory limit
+ */
+void KisFilterTileCache::Private::evictTiles(KisFilterSP filter)
+{
+    // every tile may be allocated in both source and results
+    const qint64 tileBytes = 2 * qint64(tileSize) * tileSize * colorSpace->pixelSize();
+    const qint64 maxTiles = memoryLimit / tileBytes;
+
+    qint64 numTiles = 0;
+    for (auto it = levels.constBegin(); it != levels.constEnd(); ++it) {
+        numTiles += it->tileUses.size();
+    }
+
+    if (numTiles <= maxTiles) return;
+
+    struct TileUse {
+        quint64 stamp;
+        int lod;
+        TileIndex index;
+    };
+
+    std::vector<TileUse> uses;
+    uses.reserve(numTiles);
+
+    for (auto it = levels.constBegin(); it != levels.constEnd(); ++it) {
+        for (auto tileIt = it->tileUses.constBegin(); tileIt != it->tileUses.constEnd(); ++tileIt) {
+            uses.push_back({tileIt.value(), it.key(), tileIt.key()});
+        }
+    }
+
+    /**
+     * The cache is shrunk below the limit, so that the
+     * eviction doesn't happen on every update
+     */
+    const qint64 numEvicted = numTiles - maxTiles * 3 / 4;
+
+    std::nth_element(uses.begin(), uses.begin() + numEvicted - 1, uses.end(),
+                     [] (const TileUse &lhs, const TileUse &rhs) {
+                         return lhs.stamp < rhs.stamp;
+                     });
+
+    for (qint64 i = 0; i < numEvicted; i++) {
+        LevelCache &level = levels[uses[i].lod];
+        const QRect tile(uses[i].index.first * tileSize, uses[i].index.second * tileSize,
+                         tileSize, tileSize);
+
+        level.tileUses.remove(uses[i].index);
+        level.source->clear(tile);
+        level.results->clear(tile);
+
+        // the results, which were calculated from the dropped source pixels
+        Q_FOREACH (const QRect &changedTile, tilesOf(filter->changedRect(tile, config, uses[i].lod))) {
+            level.validTiles.remove(tileIndex(changedTile));
+        }
+    }
+}
+
+const qint64 KisFilterTileCache::defaultMemoryLimit = 256 * 1024 * 1024;
+
+KisFilterTileCache::KisFilterTileCache(qint64 memoryLimit)
+    : m_d(new Private)
+{
+    m_d->memoryLimit = memoryLimit;
+}
+
+KisFilterTileCache::~KisFilterTileCache()
+{
+}
+
+bool KisFilterTileCache::isSupported(KisFilterSP filter, KisPaintDeviceSP src)
+{
+    /**
+     * The filters, which need the whole area at once,
+     * don't support threading either
+     */
+    return filter &&
+        filter->supportsThreading() &&
+        !dynamic_cast<const KisColorTransformationFilter*>(filter.data()) &&
+        !src->defaultBounds()->wrapAroundMode();
+}
+
+void KisFilterTileCache::process(KisFilterSP filter,
+                                 KisFilterConfigurationSP config,
+                                 KisPaintDeviceSP src,
+                                 KisPaintDeviceSP dst,
+                                 const QRect &rect)
+{
+    if (rect.isEmpty()) return;
+
+    const int lod = src->defaultBounds()->currentLevelOfDetail();
+    const KoColorSpace *cs = src->colorSpace();
+
+    // the filters, which split the area into blocks themselves,
+    // process the blocks on the global thread pool
+    KisThreadPoolRunnableStrokeJobsExecutor executor;
+    KisRunnableStrokeJobsInterface *jobsInterface =
+        filter->supportsBlockedProcessing(config, lod) ? &executor : 0;
+
+    // the results are stored in the color space of the source
+    if (!(*dst->colorSpace() == *cs)) {
+        filter->process(src, dst, 0, rect, config, 0, jobsInterface);
+        return;
+    }
+
+    QVector<QRect> filterRects;
+    int reusedTiles = 0;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        if (!m_d->matches(config, cs)) {
+            m_d->reset(config, cs);
+        }
+
+        LevelCache &level = m_d->level(lod);
+        const QRect neededRect = filter->neededRect(rect, config, lod);
+
+        m_d->invalidateChangedSource(filter, level, lod, src, neededRect);
+        m_d->touchTiles(level, neededRect, ++m_d->useCounter, false);
+
+        Q_FOREACH (const QRect &tile, tilesOf(rect)) {
+            const QRect part = tile & rect;
+
+            if (level.validTiles.contains(tileIndex(tile))) {
+                KisPainter::copyAreaOptimized(part.topLeft(), level.results, dst, part);
+                reusedTiles++;
+            } else if (!filterRects.isEmpty() &&
+                       filterRects.last().top() == part.top() &&
+                       filterRects.last().right() + 1 == part.left()) {
+
+                // the neighbouring tiles of a row are filtered together
+                filterRects.last() |= part;
+            } else {
+                filterRects.append(part);
+            }
+        }
+
+        m_d->lastReusedTiles = reusedTiles;
+    }
+
+    if (!reusedTiles) {
+        filterRects = {rect};
+    }
+
+    Q_FOREACH (const QRect &filterRect, filterRects) {
+        filter->process(src, dst, 0, filterRect, config, 0, jobsInterface);
+    }
+
+    QMutexLocker l(&m_d->mutex);
+
+    // the configuration has been changed while we were filtering
+    if (!m_d->matches(config, cs)) return;
+
+    LevelCache &level = m_d->level(lod);
+    const quint64 stamp = ++m_d->useCounter;
+
+    Q_FOREACH (const QRect &filterRect, filterRects) {
+        const QRect sourceRect = filter->neededRect(filterRect, config, lod);
+
+        /**
+         * Another thread could have stored different source pixels
+         * here, so the tiles calculated from them are dropped before
+         * the pixels are overwritten
+         */
+        m_d->invalidateChangedSource(filter, level, lod, src, sourceRect);
+
+        KisPainter::copyAreaOptimized(sourceRect.topLeft(), src, level.source, sourceRect);
+        KisPainter::copyAreaOptimized(filterRect.topLeft(), dst, level.results, filterRect);
+        m_d->touchTiles(level, sourceRect, stamp, true);
+
+        // only the tiles, which have been filtered entirely, are valid
+        Q_FOREACH (const QRect &tile, tilesOf(filterRect)) {
+            if (filterRect.contains(tile)) {
+                level.validTiles.insert(tileIndex(tile));
+            }
+        }
+    }
+
+    m_d->evictTiles(filter);
+}
+
+void KisFilterTileCache::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->reset(KisFilterConfigurationSP(), 0);
+}
+
+int KisFilterTileCache::lastReusedTiles() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->lastReusedTiles;
+}
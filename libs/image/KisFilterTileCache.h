@@ -0,0 +1,93 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISFILTERTILECACHE_H
+#define KISFILTERTILECACHE_H
+
+#include <QScopedPointer>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+class QRect;
+
+/**
+ * Keeps the results of a filter per tile, so that the tiles, whose
+ * source pixels didn't change, are not filtered again.
+ *
+ * The paint devices don't track the revisions of their tiles, and the
+ * source of a filter mask is a temporary device anyway, so the cache
+ * keeps a copy of the source pixels the results were calculated from.
+ * The source of every requested tile is compared to that copy and
+ * only the tiles, whose needed rect contains changed pixels, are
+ * filtered again. The results are reset when the filter, its
+ * configuration or the color space changes. Every level of detail
+ * has its own copies, so switching between the preview and the full
+ * resolution doesn't drop the results of the other level.
+ *
+ * The comparison is much cheaper than any filter, which reads the
+ * neighbouring pixels, so the filter masks with heavy filters are
+ * updated faster when the layer is only partially changed.
+ *
+ * The cache holds up to two copies of the filtered area, which is
+ * the price for the speed. The memory is limited: when the copies
+ * grow over the limit, the least recently used tiles of all the
+ * levels are dropped, together with the results, which depend on
+ * their source pixels.
+ */
+class KRITAIMAGE_EXPORT KisFilterTileCache
+{
+public:
+    /**
+     * The memory limit of the caches of the filter masks, 256 MiB
+     */
+    static const qint64 defaultMemoryLimit;
+
+    /**
+     * @param memoryLimit the maximum size of the cached source and
+     *        results tiles in bytes
+     */
+    KisFilterTileCache(qint64 memoryLimit = defaultMemoryLimit);
+    ~KisFilterTileCache();
+
+    /**
+     * Returns true if the cache is worth using for \p filter. The
+     * per-pixel color transformations are cheaper than the comparison
+     * of the source pixels, and the wraparound mode makes the needed
+     * rects of the tiles overlap the whole image.
+     */
+    static bool isSupported(KisFilterSP filter, KisPaintDeviceSP src);
+
+    /**
+     * Filters \p rect of \p src into \p dst, the same way as
+     * KisFilter::process() does, but the cached results are reused
+     * for the tiles whose source pixels are unchanged.
+     *
+     * The method may be called from several threads at once.
+     */
+    void process(KisFilterSP filter,
+                 KisFilterConfigurationSP config,
+                 KisPaintDeviceSP src,
+                 KisPaintDeviceSP dst,
+                 const QRect &rect);
+
+    /**
+     * Drops all the cached results
+     */
+    void clear();
+
+    /**
+     * The number of tiles whose results were reused
+     * by the last call to process()
+     */
+    int lastReusedTiles() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISFILTERTILECACHE_H
@@ -0,0 +1,371 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisMotionBlur.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QBitArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+#include <QtMath>
+
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
+
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_default_bounds_base.h"
+#include "KisPremultipliedChannelConverter.h"
+#include "KisRunnableStrokeJobUtils.h"
+#include "KisRunnableStrokeJobsInterface.h"
+
+const qreal KisMotionBlur::minimumLength = 32.0;
+
+namespace {
+
+const int minBlockSize = 256;
+const int maxBlockSize = 512;
+
+/**
+ * The line is integrated along its primary axis, the one its
+ * projection is the longest on. The samples of the line are taken
+ * at the integer primary coordinates and are interpolated along
+ * the secondary axis.
+ */
+struct LineGeometry
+{
+    LineGeometry(qreal length, qreal angle)
+    {
+        const qreal cosAngle = std::cos(angle);
+        const qreal sinAngle = std::sin(angle);
+
+        steep = qAbs(sinAngle) > qAbs(cosAngle);
+
+        const qreal halfLength = 0.5 * length * (steep ? qAbs(sinAngle) : qAbs(cosAngle));
+        shear = steep ? cosAngle / sinAngle : sinAngle / cosAngle;
+
+        /**
+         * The rounding errors of a tiny shear (e.g. cos(pi / 2)) are
+         * amplified by the ranges calculated in filterBlock()
+         */
+        if (qAbs(shear) < 1e-6) {
+            shear = 0.0;
+        }
+
+        // the samples at the ends of the line are weighted partially
+        fullSamples = qFloor(halfLength);
+        endWeight = halfLength - fullSamples;
+        primaryReach = qCeil(halfLength);
+
+        // one pixel for each of the interpolations
+        secondaryReach = qCeil(primaryReach * qAbs(shear)) + 2;
+    }
+
+    inline QPoint toImage(int primary, int secondary) const {
+        return steep ? QPoint(secondary, primary) : QPoint(primary, secondary);
+    }
+
+    bool steep {false};
+    qreal shear {0.0};
+    int fullSamples {0};
+    qreal endWeight {0.0};
+    int primaryReach {0};
+    int secondaryReach {0};
+};
+
+struct SourceData
+{
+    QRect rect;
+    QVector<quint8> bytes;
+    QVector<float> values;
+
+    inline int index(int x, int y) const {
+        return (y - rect.y()) * rect.width() + (x - rect.x());
+    }
+
+    /**
+     * The pixels outside the data are the repeated edge pixels
+     */
+    inline const float* pixel(const QPoint &pt, int numChannels) const {
+        const int x = qBound(rect.left(), pt.x(), rect.right());
+        const int y = qBound(rect.top(), pt.y(), rect.bottom());
+        return values.constData() + index(x, y) * numChannels;
+    }
+};
+
+void readSource(KisPaintDeviceSP device, const QRect &rect,
+                const KisPremultipliedChannelConverter &converter,
+                SourceData &data)
+{
+    const int numPixels = rect.width() * rect.height();
+
+    data.rect = rect;
+    data.bytes.resize(numPixels * converter.pixelSize);
+    data.values.resize(numPixels * converter.numChannels());
+
+    device->readBytes(data.bytes.data(), rect);
+    converter.toFloat(data.bytes.constData(), data.values.data(), numPixels);
+}
+
+void writeResult(KisPaintDeviceSP dst, const QRect &blockRect,
+                 const SourceData &src, const QVector<float> &result,
+                 const KisPremultipliedChannelConverter &converter)
+{
+    const int pixelSize = converter.pixelSize;
+    const int rowSize = blockRect.width() * pixelSize;
+    QVector<quint8> bytes(blockRect.height() * rowSize);
+
+    // the channels, which are not filtered, are kept as they are
+    for (int row = 0; row < blockRect.height(); row++) {
+        memcpy(bytes.data() + row * rowSize,
+               src.bytes.constData() + src.index(blockRect.x(), blockRect.y() + row) * pixelSize,
+               rowSize);
+    }
+
+    converter.fromFloat(result.constData(), bytes.data(), blockRect.width() * blockRect.height());
+    dst->writeBytes(bytes.constData(), blockRect);
+}
+
+/**
+ * The pixel (p, s) of the block lies between the rows v and v + 1 of
+ * the sheared image, where v = floor(s - p * shear). The sheared rows
+ * are integrated one by one and every pixel is interpolated as soon
+ * as both of its rows are ready, so only two of them are stored.
+ */
+void filterBlock(const SourceData &src, const QRect &blockRect,
+                 const LineGeometry &g, int numChannels,
+                 QVector<float> &result)
+{
+    const int p0 = g.steep ? blockRect.top() : blockRect.left();
+    const int p1 = g.steep ? blockRect.bottom() : blockRect.right();
+    const int s0 = g.steep ? blockRect.left() : blockRect.top();
+    const int s1 = g.steep ? blockRect.right() : blockRect.bottom();
+
+    const qreal t = g.shear;
+    const int m = g.fullSamples;
+    const qreal f = g.endWeight;
+    const qreal norm = 1.0 / (2 * m + 1 + 2 * f);
+
+    auto shearedRow = [t] (int p, int s) {
+        return qFloor(s - p * t);
+    };
+
+    const int vMin = qMin(shearedRow(p0, s0), shearedRow(p1, s0));
+    const int vMax = qMax(shearedRow(p0, s1), shearedRow(p1, s1)) + 1;
+
+    const int numPrimary = p1 - p0 + 1;
+    const int maxSamples = numPrimary + 2 * g.primaryReach;
+
+    QVector<float> samples(maxSamples * numChannels);
+    QVector<double> prefix((maxSamples + 1) * numChannels);
+    QVector<float> previousRow(numPrimary * numChannels);
+    QVector<float> currentRow(numPrimary * numChannels);
+
+    result.resize(blockRect.width() * blockRect.height() * numChannels);
+
+    for (int v = vMin; v <= vMax; v++) {
+        /**
+         * The range of the pixels, which use the row v. It is
+         * calculated with a margin to avoid the rounding issues.
+         */
+        int lo = p0;
+        int hi = p1;
+
+        if (t != 0.0) {
+            const qreal a = (s0 - v - 1) / t;
+            const qreal b = (s1 - v + 1) / t;
+
+            // a tiny shear gives huge values, which don't fit into int
+            lo = qMax(p0, qFloor(qBound<qreal>(p0 - 2, qMin(a, b), p1 + 2)) - 1);
+            hi = qMin(p1, qCeil(qBound<qreal>(p0 - 2, qMax(a, b), p1 + 2)) + 1);
+        }
+
+        if (lo > hi) continue;
+
+        const int uStart = lo - g.primaryReach;
+        const int numSamples = hi - lo + 1 + 2 * g.primaryReach;
+
+        // shear and interpolate the samples of the row
+        for (int i = 0; i < numSamples; i++) {
+            const int u = uStart + i;
+            const qreal pos = v + u * t;
+            const int w = qFloor(pos);
+            const float frac = pos - w;
+
+            const float *first = src.pixel(g.toImage(u, w), numChannels);
+            const float *second = src.pixel(g.toImage(u, w + 1), numChannels);
+            float *sample = samples.data() + i * numChannels;
+
+            for (int c = 0; c < numChannels; c++) {
+                sample[c] = first[c] + frac * (second[c] - first[c]);
+            }
+        }
+
+        for (int c = 0; c < numChannels; c++) {
+            prefix[c] = 0.0;
+        }
+
+        for (int i = 0; i < numSamples; i++) {
+            for (int c = 0; c < numChannels; c++) {
+                prefix[(i + 1) * numChannels + c] =
+                    prefix[i * numChannels + c] + samples[i * numChannels + c];
+            }
+        }
+
+        // the sliding sums of the line
+        for (int p = lo; p <= hi; p++) {
+            const int i = p - uStart;
+            float *dst = currentRow.data() + (p - p0) * numChannels;
+
+            for (int c = 0; c < numChannels; c++) {
+                qreal sum = prefix[(i + m + 1) * numChannels + c] - prefix[(i - m) * numChannels + c];
+
+                if (f > 0.0) {
+                    sum += f * (samples[(i - m - 1) * numChannels + c] +
+                                samples[(i + m + 1) * numChannels + c]);
+                }
+
+                dst[c] = sum * norm;
+            }
+        }
+
+        // shear back the pixels lying between the rows v - 1 and v
+        if (v > vMin) {
+            for (int p = lo; p <= hi; p++) {
+                const float *first = previousRow.constData() + (p - p0) * numChannels;
+                const float *second = currentRow.constData() + (p - p0) * numChannels;
+
+                const int sStart = qMax(s0, qFloor(v - 1 + p * t) - 1);
+                const int sEnd = qMin(s1, qCeil(v + p * t) + 1);
+
+                for (int s = sStart; s <= sEnd; s++) {
+                    if (shearedRow(p, s) != v - 1) continue;
+
+                    const float frac = (s - p * t) - (v - 1);
+                    const QPoint pt = g.toImage(p, s);
+
+                    float *dst = result.data() +
+                        ((pt.y() - blockRect.y()) * blockRect.width() +
+                         (pt.x() - blockRect.x())) * numChannels;
+
+                    for (int c = 0; c < numChannels; c++) {
+                        dst[c] = first[c] + frac * (second[c] - first[c]);
+                    }
+                }
+            }
+        }
+
+        std::swap(previousRow, currentRow);
+    }
+}
+
+}
+
+QSize KisMotionBlur::haloSize(qreal length, qreal angle)
+{
+    const LineGeometry g(length, angle);
+
+    return g.steep ?
+        QSize(g.secondaryReach, g.primaryReach) :
+        QSize(g.primaryReach, g.secondaryReach);
+}
+
+void KisMotionBlur::apply(KisPaintDeviceSP device,
+                          const QRect &rect,
+                          qreal length, qreal angle,
+                          const QBitArray &channelFlags,
+                          KoUpdater *progressUpdater,
+                          KisRunnableStrokeJobsInterface *jobsInterface)
+{
+    if (rect.isEmpty() || length <= 0.0) return;
+
+    const KisPremultipliedChannelConverter converter(device->colorSpace(), channelFlags);
+    const int numChannels = converter.numChannels();
+    if (!numChannels) return;
+
+    const LineGeometry g(length, angle);
+    const QSize halo = haloSize(length, angle);
+
+    QRect sourceBounds = rect.adjusted(-halo.width(), -halo.height(), halo.width(), halo.height());
+
+    /**
+     * The wraparound mode is handled by the paint device itself,
+     * otherwise the edge pixels are repeated by SourceData::pixel()
+     */
+    if (!device->defaultBounds()->wrapAroundMode()) {
+        sourceBounds &= rect | device->defaultBounds()->bounds();
+    }
+
+    /**
+     * Every sheared row is read with the margin of the line length,
+     * so the blocks should be much longer than the line. The block
+     * size is a multiple of the tile size and the grid of the blocks
+     * is aligned to the image origin, so the concurrent jobs never
+     * write into the same tile.
+     */
+    const int blockSize = qBound(minBlockSize, (4 * g.primaryReach + 63) & ~63, maxBlockSize);
+
+    auto alignDown = [blockSize] (int pos) {
+        return pos >= 0 ? pos / blockSize * blockSize : -((-pos + blockSize - 1) / blockSize * blockSize);
+    };
+
+    QVector<QRect> blocks;
+    for (int y = alignDown(rect.top()); y <= rect.bottom(); y += blockSize) {
+        for (int x = alignDown(rect.left()); x <= rect.right(); x += blockSize) {
+            blocks.append(QRect(x, y, blockSize, blockSize) & rect);
+        }
+    }
+
+    /**
+     * The blocks read the pixels of their neighbours,
+     * so the result is collected in a separate device
+     */
+    KisPaintDeviceSP dst = new KisPaintDevice(device->colorSpace());
+    dst->prepareClone(device);
+
+    QMutex progressMutex;
+    int doneBlocks = 0;
+
+    auto processBlock = [&] (const QRect &blockRect) {
+        const QRect sourceRect =
+            blockRect.adjusted(-halo.width(), -halo.height(), halo.width(), halo.height()) & sourceBounds;
+
+        SourceData src;
+        QVector<float> result;
+
+        readSource(device, sourceRect, converter, src);
+        filterBlock(src, blockRect, g, numChannels, result);
+        writeResult(dst, blockRect, src, result, converter);
+
+        if (progressUpdater) {
+            QMutexLocker locker(&progressMutex);
+            progressUpdater->setProgress(100 * ++doneBlocks / blocks.size());
+        }
+    };
+
+    if (jobsInterface) {
+        QVector<KisRunnableStrokeJobData*> jobs;
+
+        Q_FOREACH (const QRect &blockRect, blocks) {
+            KritaUtils::addJobConcurrent(jobs, [processBlock, blockRect] () {
+                processBlock(blockRect);
+            });
+        }
+
+        jobsInterface->addRunnableJobs(jobs);
+    } else {
+        Q_FOREACH (const QRect &blockRect, blocks) {
+            processBlock(blockRect);
+        }
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), dst, device, rect);
+}
@@ -0,0 +1,68 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISMOTIONBLUR_H
+#define KISMOTIONBLUR_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+class QSize;
+class QBitArray;
+class KoUpdater;
+class KisRunnableStrokeJobsInterface;
+
+/**
+ * A motion blur, which averages the pixels along a line segment
+ * of the given length and angle, with the cost per pixel
+ * independent from the length.
+ *
+ * The image is sheared along the secondary axis, so that the
+ * lines of the given angle become the rows (or the columns) of the
+ * sheared image. The lines are integrated with the sliding sums and
+ * the result is sheared back. Both shears interpolate linearly, like
+ * the antialiased line of the explicit kernel does.
+ *
+ * The shear is calculated in the image coordinates and the area is
+ * processed in blocks, so the result doesn't depend on the way the
+ * rect is split.
+ */
+class KRITAIMAGE_EXPORT KisMotionBlur
+{
+public:
+    /**
+     * The shortest length the line integral is preferred for
+     * over the explicit convolution kernel
+     */
+    static const qreal minimumLength;
+
+    /**
+     * The distances of the farthest source pixels, which may
+     * affect the result of the filter
+     */
+    static QSize haloSize(qreal length, qreal angle);
+
+    /**
+     * Filters \p rect of \p device in place. The blur line is \p length
+     * pixels long and is rotated by \p angle (in radians). The pixels
+     * outside the bounds of the image are considered to be equal
+     * to the nearest pixels inside the bounds.
+     *
+     * If \p jobsInterface is not null, the blocks are filtered in its
+     * concurrent jobs. The interface must finish the jobs before
+     * addRunnableJobs() returns, like
+     * KisThreadPoolRunnableStrokeJobsExecutor does.
+     */
+    static void apply(KisPaintDeviceSP device,
+                      const QRect &rect,
+                      qreal length, qreal angle,
+                      const QBitArray &channelFlags,
+                      KoUpdater *progressUpdater,
+                      KisRunnableStrokeJobsInterface *jobsInterface = 0);
+};
+
+#endif // KISMOTIONBLUR_H
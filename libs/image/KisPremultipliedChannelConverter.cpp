@@ -0,0 +1,116 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisPremultipliedChannelConverter.h"
+
+#include <limits>
+
+#include <QBitArray>
+
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+
+#include "kis_assert.h"
+
+KisPremultipliedChannelConverter::KisPremultipliedChannelConverter(const KoColorSpace *colorSpace, const QBitArray &channelFlags)
+    : pixelSize(colorSpace->pixelSize())
+{
+    QBitArray flags = channelFlags;
+    if (flags.isEmpty()) {
+        flags = QBitArray(colorSpace->channelCount(), true);
+    }
+    KIS_ASSERT(static_cast<quint32>(flags.size()) == colorSpace->channelCount());
+
+    const QList<KoChannelInfo *> channelInfo = colorSpace->channels();
+    for (int c = 0; c < channelInfo.size(); ++c) {
+        if (flags.testBit(c)) {
+            channels.append(channelInfo[c]);
+        }
+    }
+
+    KisMathToolbox mathToolbox;
+
+    for (int i = 0; i < channels.size(); ++i) {
+        positions.append(channels[i]->pos());
+        minClamp.append(mathToolbox.minChannelValue(channels[i]));
+        maxClamp.append(mathToolbox.maxChannelValue(channels[i]));
+
+        if (channels[i]->channelType() == KoChannelInfo::ALPHA) {
+            alphaIndex = i;
+        }
+    }
+
+    toDoubleFuncPtr.resize(channels.size());
+    fromDoubleFuncPtr.resize(channels.size());
+    fromDoubleCheckNullFuncPtr.resize(channels.size());
+
+    bool result = mathToolbox.getToDoubleChannelPtr(channels, toDoubleFuncPtr);
+    result &= mathToolbox.getFromDoubleChannelPtr(channels, fromDoubleFuncPtr);
+    result &= mathToolbox.getFromDoubleCheckNullChannelPtr(channels, fromDoubleCheckNullFuncPtr);
+
+    KIS_ASSERT(result);
+}
+
+void KisPremultipliedChannelConverter::toFloat(const quint8 *src, float *dst, int numPixels) const
+{
+    const int channelCount = numChannels();
+
+    for (int i = 0; i < numPixels; i++) {
+        // no alpha is a rare case, so just multiply by 1.0 in that case
+        const double alpha = alphaIndex >= 0 ?
+            toDoubleFuncPtr[alphaIndex](src, positions[alphaIndex]) : 1.0;
+
+        for (int k = 0; k < channelCount; k++) {
+            dst[k] = k != alphaIndex ?
+                toDoubleFuncPtr[k](src, positions[k]) * alpha : alpha;
+        }
+
+        src += pixelSize;
+        dst += channelCount;
+    }
+}
+
+void KisPremultipliedChannelConverter::fromFloat(const float *src, quint8 *dst, int numPixels) const
+{
+    const int channelCount = numChannels();
+
+    for (int i = 0; i < numPixels; i++) {
+        if (alphaIndex >= 0) {
+            const qreal alpha = qBound(minClamp[alphaIndex],
+                                       qreal(src[alphaIndex]),
+                                       maxClamp[alphaIndex]);
+
+            bool alphaIsNullInDstSpace = false;
+            fromDoubleCheckNullFuncPtr[alphaIndex](dst, positions[alphaIndex],
+                                                   alpha, &alphaIsNullInDstSpace);
+
+            if (!alphaIsNullInDstSpace &&
+                alpha > std::numeric_limits<qreal>::epsilon()) {
+
+                const qreal alphaInv = 1.0 / alpha;
+
+                for (int k = 0; k < channelCount; k++) {
+                    if (k == alphaIndex) continue;
+                    fromDoubleFuncPtr[k](dst, positions[k],
+                                         qBound(minClamp[k], src[k] * alphaInv, maxClamp[k]));
+                }
+            } else {
+                for (int k = 0; k < channelCount; k++) {
+                    if (k == alphaIndex) continue;
+                    fromDoubleFuncPtr[k](dst, positions[k], 0.0);
+                }
+            }
+        } else {
+            for (int k = 0; k < channelCount; k++) {
+                fromDoubleFuncPtr[k](dst, positions[k],
+                                     qBound(minClamp[k], qreal(src[k]), maxClamp[k]));
+            }
+        }
+
+        src += channelCount;
+        dst += pixelSize;
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPREMULTIPLIEDCHANNELCONVERTER_H
+#define KISPREMULTIPLIEDCHANNELCONVERTER_H
+
+#include <QList>
+#include <QVector>
+
+#include "kritaimage_export.h"
+#include "kis_math_toolbox.h"
+
+class QBitArray;
+class KoColorSpace;
+class KoChannelInfo;
+
+/**
+ * Converts the pixels into the premultiplied floating point
+ * values of the selected channels and back, the same way
+ * as KisConvolutionWorkerFFT does. The float pixels contain
+ * numChannels() values each.
+ */
+class KRITAIMAGE_EXPORT KisPremultipliedChannelConverter
+{
+public:
+    KisPremultipliedChannelConverter(const KoColorSpace *colorSpace, const QBitArray &channelFlags);
+
+    inline int numChannels() const {
+        return channels.size();
+    }
+
+    void toFloat(const quint8 *src, float *dst, int numPixels) const;
+
+    /**
+     * Writes the selected channels of \p numPixels into \p dst. The
+     * rest of the channels of \p dst are left untouched.
+     */
+    void fromFloat(const float *src, quint8 *dst, int numPixels) const;
+
+    const int pixelSize;
+    QList<KoChannelInfo *> channels;
+    QVector<int> positions;
+    QVector<qreal> minClamp;
+    QVector<qreal> maxClamp;
+    int alphaIndex {-1};
+
+private:
+    QVector<PtrToDouble> toDoubleFuncPtr;
+    QVector<PtrFromDouble> fromDoubleFuncPtr;
+    QVector<PtrFromDoubleCheckNull> fromDoubleCheckNullFuncPtr;
+};
+
+#endif // KISPREMULTIPLIEDCHANNELCONVERTER_H
@@ -0,0 +1,629 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisRankFilter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <QBitArray>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRect>
+#include <QVector>
+
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoUpdater.h>
+
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_default_bounds_base.h"
+#include "kis_math_toolbox.h"
+#include "kis_sequential_iterator.h"
+#include "KisRunnableStrokeJobUtils.h"
+#include "KisRunnableStrokeJobsInterface.h"
+
+const int KisRankFilter::polygonMinimumRadius = 32;
+
+namespace {
+
+/**
+ * The memory limit for the column histograms. The 16-bit
+ * histograms are big, so the area is processed in vertical
+ * strips, which fit into the limit.
+ */
+const qint64 maxHistogramBytes = 32 * 1024 * 1024;
+const int minStripWidth = 64;
+
+const int bandHeight = 256;
+
+template <typename T>
+struct MaximumPolicy {
+    static inline T neutral() { return std::numeric_limits<T>::min(); }
+    static inline T select(T a, T b) { return std::max(a, b); }
+};
+
+template <typename T>
+struct MinimumPolicy {
+    static inline T neutral() { return std::numeric_limits<T>::max(); }
+    static inline T select(T a, T b) { return std::min(a, b); }
+};
+
+/**
+ * van Herk, M. "A fast algorithm for local minimum and maximum filters
+ * on rectangular and octagonal kernels", 1992. Gil, J., Werman, M.
+ * "Computing 2-D min, median, and max filters", 1993.
+ *
+ * The line, padded with \p radius neutral samples, is split into
+ * blocks of the window size. Every window covers at most two blocks,
+ * so its extremum is combined from the suffix extremum of the first
+ * block and the prefix extremum of the second one.
+ */
+template <class Policy, typename T>
+void vanHerkGilWerman(T *data, int length, int step, int radius, QVector<T> &prefix, QVector<T> &suffix)
+{
+    if (radius <= 0 || length <= 0) return;
+
+    const int window = 2 * radius + 1;
+    const int paddedLength = (length + 2 * radius + window - 1) / window * window;
+
+    prefix.resize(paddedLength);
+    suffix.resize(paddedLength);
+
+    auto sample = [&] (int i) {
+        const int pos = i - radius;
+        return pos >= 0 && pos < length ? data[pos * step] : Policy::neutral();
+    };
+
+    for (int start = 0; start < paddedLength; start += window) {
+        T value = Policy::neutral();
+        for (int i = start; i < start + window; i++) {
+            value = Policy::select(value, sample(i));
+            prefix[i] = value;
+        }
+
+        value = Policy::neutral();
+        for (int i = start + window - 1; i >= start; i--) {
+            value = Policy::select(value, sample(i));
+            suffix[i] = value;
+        }
+    }
+
+    // the window of the sample i covers the padded samples [i, i + 2 * radius]
+    for (int i = 0; i < length; i++) {
+        data[i * step] = Policy::select(suffix[i], prefix[i + 2 * radius]);
+    }
+}
+
+template <class Policy, typename T>
+void rectExtremum(T *plane, int width, int height, int xRadius, int yRadius)
+{
+    QVector<T> prefix;
+    QVector<T> suffix;
+
+    for (int y = 0; y < height; y++) {
+        vanHerkGilWerman<Policy>(plane + y * width, width, 1, xRadius, prefix, suffix);
+    }
+
+    for (int x = 0; x < width; x++) {
+        vanHerkGilWerman<Policy>(plane + x, height, width, yRadius, prefix, suffix);
+    }
+}
+
+inline int floorDiv(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/**
+ * A family of parallel digital lines, which covers every pixel of the
+ * plane exactly once. The minor coordinate of the line changes by
+ * \p slopeNumerator / \p slopeDenominator pixels per step along the
+ * major axis.
+ */
+struct LineFamily {
+    bool alongX;
+    int slopeNumerator;
+    int slopeDenominator;
+};
+
+template <class Policy>
+void lineFamilyExtremum(quint8 *plane, int width, int height,
+                        const LineFamily &family, int radius)
+{
+    if (radius <= 0) return;
+
+    const int majorSize = family.alongX ? width : height;
+    const int minorSize = family.alongX ? height : width;
+
+    auto offset = [&] (int major) {
+        return floorDiv(major * family.slopeNumerator, family.slopeDenominator);
+    };
+
+    const int lastOffset = offset(majorSize - 1);
+    const int minOffset = qMin(0, lastOffset);
+    const int maxOffset = qMax(0, lastOffset);
+
+    QVector<int> indices;
+    QVector<quint8> line;
+    QVector<quint8> prefix;
+    QVector<quint8> suffix;
+
+    for (int base = -maxOffset; base < minorSize - minOffset; base++) {
+        indices.resize(0);
+
+        for (int major = 0; major < majorSize; major++) {
+            const int minor = base + offset(major);
+            if (minor < 0 || minor >= minorSize) continue;
+
+            indices.append(family.alongX ?
+                           minor * width + major :
+                           major * width + minor);
+        }
+
+        if (indices.isEmpty()) continue;
+
+        line.resize(indices.size());
+        for (int i = 0; i < indices.size(); i++) {
+            line[i] = plane[indices[i]];
+        }
+
+        vanHerkGilWerman<Policy>(line.data(), line.size(), 1, radius, prefix, suffix);
+
+        for (int i = 0; i < indices.size(); i++) {
+            plane[indices[i]] = line[i];
+        }
+    }
+}
+
+template <class Policy>
+void polygonExtremumImpl(quint8 *plane, int width, int height, int xRadius, int yRadius)
+{
+    /**
+     * The Minkowski sum of the segments of eight directions is a
+     * 16-sided polygon with the edges of the segments' lengths. For
+     * the polygon circumscribed around the circle of radius r, the
+     * half-lengths of the segments (in the steps along their major
+     * axes) are: 0.236 * r for the horizontal and the vertical ones,
+     * 0.115 * r for the diagonals and 0.178 * r for the slopes of 1/2
+     * and 2. The horizontal and the vertical segments take the rest
+     * of the radii, so the extents of the polygon match the ellipse.
+     */
+    const int radius = qMin(xRadius, yRadius);
+    const int diagonal = qRound(0.115 * radius);
+    const int slope = qRound(0.178 * radius);
+
+    // the slope of 2 moves by half of its length along the minor axis
+    const int slopesExtent = 2 * diagonal + 2 * slope + slope;
+    const int horizontal = qMax(0, xRadius - slopesExtent);
+    const int vertical = qMax(0, yRadius - slopesExtent);
+
+    const LineFamily families[] = {
+        {true, 1, 1}, {true, -1, 1},
+        {true, 1, 2}, {true, -1, 2},
+        {false, 1, 2}, {false, -1, 2}
+    };
+
+    const int radii[] = {
+        diagonal, diagonal,
+        slope, slope,
+        slope, slope
+    };
+
+    for (int i = 0; i < 6; i++) {
+        lineFamilyExtremum<Policy>(plane, width, height, families[i], radii[i]);
+    }
+
+    rectExtremum<Policy>(plane, width, height, horizontal, vertical);
+}
+
+/**
+ * Perreault, S., Hébert, P. "Median Filtering in Constant Time", 2007.
+ *
+ * Every column of the strip has a histogram of its 2 * radius + 1
+ * pixels, which is updated with one addition and one subtraction
+ * per row. The histogram of the kernel is updated with one column
+ * histogram per pixel. The histograms have two levels: the coarse
+ * one (the high half of the key bits) is kept up to date, and the
+ * fine one is updated lazily, only for the coarse bin, which
+ * contains the requested rank.
+ *
+ * \p src is (width + 2 * radius) x (height + 2 * radius) keys
+ */
+void rankPlane(const quint16 *src, quint16 *dst, int width, int height,
+               int radius, int rank, int keyBits)
+{
+    const int fineBits = keyBits / 2;
+    const int numCoarse = 1 << (keyBits - fineBits);
+    const int numFine = 1 << fineBits;
+    const int numBins = numCoarse * numFine;
+
+    const int srcWidth = width + 2 * radius;
+    const int diameter = 2 * radius + 1;
+
+    const qint64 columnBytes = (numCoarse + numBins) * qint64(sizeof(quint16));
+    const int stripWidth = qMax(minStripWidth, int(maxHistogramBytes / columnBytes) - 2 * radius);
+
+    QVector<quint16> columnCoarse;
+    QVector<quint16> columnFine;
+    QVector<quint32> kernelCoarse(numCoarse);
+    QVector<quint32> kernelFine(numBins);
+    QVector<int> kernelFinePosition(numCoarse);
+
+    for (int stripStart = 0; stripStart < width; stripStart += stripWidth) {
+        const int stripSize = qMin(stripWidth, width - stripStart);
+        const int numColumns = stripSize + 2 * radius;
+
+        columnCoarse.fill(0, numColumns * numCoarse);
+        columnFine.fill(0, numColumns * numBins);
+
+        auto updateRow = [&] (int row, int delta) {
+            const quint16 *keys = src + row * srcWidth + stripStart;
+
+            for (int c = 0; c < numColumns; c++) {
+                columnCoarse[c * numCoarse + (keys[c] >> fineBits)] += delta;
+                columnFine[c * numBins + keys[c]] += delta;
+            }
+        };
+
+        for (int row = 0; row < diameter; row++) {
+            updateRow(row, 1);
+        }
+
+        for (int y = 0; y < height; y++) {
+            if (y > 0) {
+                updateRow(y - 1, -1);
+                updateRow(y + 2 * radius, 1);
+            }
+
+            std::fill(kernelCoarse.begin(), kernelCoarse.end(), 0);
+            for (int c = 0; c < diameter; c++) {
+                const quint16 *column = columnCoarse.constData() + c * numCoarse;
+                for (int i = 0; i < numCoarse; i++) {
+                    kernelCoarse[i] += column[i];
+                }
+            }
+
+            // the fine histograms of the previous row are not valid anymore
+            std::fill(kernelFinePosition.begin(), kernelFinePosition.end(), -1);
+
+            quint16 *dstRow = dst + y * width + stripStart;
+
+            for (int x = 0; x < stripSize; x++) {
+                if (x > 0) {
+                    const quint16 *added = columnCoarse.constData() + (x + 2 * radius) * numCoarse;
+                    const quint16 *removed = columnCoarse.constData() + (x - 1) * numCoarse;
+
+                    for (int i = 0; i < numCoarse; i++) {
+                        kernelCoarse[i] += added[i] - removed[i];
+                    }
+                }
+
+                int count = 0;
+                int coarse = 0;
+                while (count + int(kernelCoarse[coarse]) <= rank) {
+                    count += kernelCoarse[coarse];
+                    coarse++;
+                }
+
+                quint32 *fine = kernelFine.data() + coarse * numFine;
+                int &position = kernelFinePosition[coarse];
+
+                if (position < 0 || x - position > radius) {
+                    std::fill(fine, fine + numFine, 0);
+
+                    for (int c = x; c < x + diameter; c++) {
+                        const quint16 *column = columnFine.constData() + c * numBins + coarse * numFine;
+                        for (int i = 0; i < numFine; i++) {
+                            fine[i] += column[i];
+                        }
+                    }
+                } else {
+                    for (int p = position + 1; p <= x; p++) {
+                        const quint16 *added = columnFine.constData() + (p + 2 * radius) * numBins + coarse * numFine;
+                        const quint16 *removed = columnFine.constData() + (p - 1) * numBins + coarse * numFine;
+
+                        for (int i = 0; i < numFine; i++) {
+                            fine[i] += added[i] - removed[i];
+                        }
+                    }
+                }
+                position = x;
+
+                int bin = 0;
+                while (count + int(fine[bin]) <= rank) {
+                    count += fine[bin];
+                    bin++;
+                }
+
+                dstRow[x] = quint16((coarse << fineBits) | bin);
+            }
+        }
+    }
+}
+
+/**
+ * Converts a channel into the keys of the rank filter and back
+ */
+struct ChannelCodec
+{
+    ChannelCodec(KoChannelInfo *channel)
+        : type(channel->channelValueType()),
+          position(channel->pos())
+    {
+        if (type != KoChannelInfo::UINT8 && type != KoChannelInfo::UINT16) {
+            QList<KoChannelInfo *> channels;
+            channels << channel;
+
+            KisMathToolbox mathToolbox;
+            QVector<PtrToDouble> toDouble(1);
+            QVector<PtrFromDouble> fromDouble(1);
+            mathToolbox.getToDoubleChannelPtr(channels, toDouble);
+            mathToolbox.getFromDoubleChannelPtr(channels, fromDouble);
+
+            toDoubleFunc = toDouble[0];
+            fromDoubleFunc = fromDouble[0];
+        }
+    }
+
+    inline int keyBits() const {
+        return type == KoChannelInfo::UINT8 ? 8 : 16;
+    }
+
+    inline bool needsRange() const {
+        return toDoubleFunc != 0;
+    }
+
+    /**
+     * The keys of the non-integer channels are distributed over the
+     * range of the values. The range is collected over the whole
+     * source area, so all the bands quantize the values the same way.
+     */
+    void resetRange() {
+        minValue = std::numeric_limits<qreal>::max();
+        maxValue = std::numeric_limits<qreal>::lowest();
+        scale = 0.0;
+    }
+
+    inline void addToRange(const quint8 *pixel) {
+        const qreal value = toDoubleFunc(pixel, position);
+        minValue = qMin(minValue, value);
+        maxValue = qMax(maxValue, value);
+    }
+
+    void finishRange() {
+        scale = maxValue > minValue ? 65535.0 / (maxValue - minValue) : 0.0;
+    }
+
+    inline quint16 key(const quint8 *pixel) const {
+        switch (type) {
+        case KoChannelInfo::UINT8:
+            return pixel[position];
+        case KoChannelInfo::UINT16:
+            return *reinterpret_cast<const quint16*>(pixel + position);
+        default:
+            return quint16(qRound((toDoubleFunc(pixel, position) - minValue) * scale));
+        }
+    }
+
+    inline void store(quint8 *pixel, quint16 key) const {
+        switch (type) {
+        case KoChannelInfo::UINT8:
+            pixel[position] = quint8(key);
+            break;
+        case KoChannelInfo::UINT16:
+            *reinterpret_cast<quint16*>(pixel + position) = key;
+            break;
+        default:
+            fromDoubleFunc(pixel, position, scale > 0.0 ? minValue + key / scale : minValue);
+        }
+    }
+
+    KoChannelInfo::enumChannelValueType type;
+    int position;
+    PtrToDouble toDoubleFunc {0};
+    PtrFromDouble fromDoubleFunc {0};
+    qreal minValue {0.0};
+    qreal maxValue {0.0};
+    qreal scale {0.0};
+};
+
+}
+
+void KisRankFilter::lineExtremum(quint8 *data, int length, int step, int radius, Extremum extremum)
+{
+    QVector<quint8> prefix;
+    QVector<quint8> suffix;
+
+    if (extremum == Maximum) {
+        vanHerkGilWerman<MaximumPolicy<quint8>>(data, length, step, radius, prefix, suffix);
+    } else {
+        vanHerkGilWerman<MinimumPolicy<quint8>>(data, length, step, radius, prefix, suffix);
+    }
+}
+
+void KisRankFilter::polygonExtremum(quint8 *plane, int width, int height,
+                                    int xRadius, int yRadius,
+                                    Extremum extremum)
+{
+    if (extremum == Maximum) {
+        polygonExtremumImpl<MaximumPolicy<quint8>>(plane, width, height, xRadius, yRadius);
+    } else {
+        polygonExtremumImpl<MinimumPolicy<quint8>>(plane, width, height, xRadius, yRadius);
+    }
+}
+
+void KisRankFilter::apply(KisPaintDeviceSP device,
+                          const QRect &rect,
+                          int radius, qreal percentile,
+                          const QBitArray &channelFlags,
+                          KoUpdater *progressUpdater,
+                          KisRunnableStrokeJobsInterface *jobsInterface)
+{
+    if (rect.isEmpty() || radius <= 0) return;
+
+    const KoColorSpace *cs = device->colorSpace();
+    const int pixelSize = cs->pixelSize();
+
+    QVector<ChannelCodec> codecs;
+    const QList<KoChannelInfo *> channels = cs->channels();
+    for (int c = 0; c < channels.size(); c++) {
+        if (channelFlags.isEmpty() || channelFlags.testBit(c)) {
+            codecs.append(ChannelCodec(channels[c]));
+        }
+    }
+    if (codecs.isEmpty()) return;
+
+    const int windowSize = (2 * radius + 1) * (2 * radius + 1);
+    const int rank = qBound(0, qRound(percentile / 100.0 * (windowSize - 1)), windowSize - 1);
+
+    QRect sourceBounds = rect.adjusted(-radius, -radius, radius, radius);
+
+    /**
+     * The wraparound mode is handled by the paint device itself,
+     * otherwise the pixels outside the image are replaced with the
+     * nearest pixels inside it
+     */
+    if (!device->defaultBounds()->wrapAroundMode()) {
+        sourceBounds &= rect | device->defaultBounds()->bounds();
+    }
+
+    QVector<ChannelCodec*> rangedCodecs;
+    for (ChannelCodec &codec : codecs) {
+        if (codec.needsRange()) {
+            codec.resetRange();
+            rangedCodecs.append(&codec);
+        }
+    }
+
+    if (!rangedCodecs.isEmpty()) {
+        KisSequentialConstIterator it(device, sourceBounds);
+        while (it.nextPixel()) {
+            Q_FOREACH (ChannelCodec *codec, rangedCodecs) {
+                codec->addToRange(it.rawDataConst());
+            }
+        }
+
+        Q_FOREACH (ChannelCodec *codec, rangedCodecs) {
+            codec->finishRange();
+        }
+    }
+
+    /**
+     * The band height is a multiple of the tile size and the bands
+     * are aligned to the image origin, so the concurrent jobs never
+     * write into the same tile
+     */
+    auto alignDown = [] (int pos) {
+        return pos >= 0 ? pos / bandHeight * bandHeight : -((-pos + bandHeight - 1) / bandHeight * bandHeight);
+    };
+
+    QVector<QRect> bands;
+    for (int bandTop = alignDown(rect.top()); bandTop <= rect.bottom(); bandTop += bandHeight) {
+        bands.append(QRect(rect.x(), bandTop, rect.width(), bandHeight) & rect);
+    }
+
+    /**
+     * The bands read the pixels of their neighbours,
+     * so the result is collected in a separate device
+     */
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+    dst->prepareClone(device);
+
+    const int totalSteps = bands.size() * codecs.size();
+    QMutex progressMutex;
+    int doneSteps = 0;
+
+    auto processBand = [&] (const QRect &bandRect) {
+        const QRect sourceRect = bandRect.adjusted(-radius, -radius, radius, radius) & sourceBounds;
+
+        QVector<quint8> srcBytes(sourceRect.width() * sourceRect.height() * pixelSize);
+        device->readBytes(srcBytes.data(), sourceRect);
+
+        const int planeWidth = bandRect.width() + 2 * radius;
+        const int planeHeight = bandRect.height() + 2 * radius;
+
+        // the whole window of every pixel, with the edge pixels repeated
+        QVector<quint8> planeBytes(planeWidth * planeHeight * pixelSize);
+        for (int py = 0; py < planeHeight; py++) {
+            const int sy = qBound(sourceRect.top(), bandRect.top() - radius + py, sourceRect.bottom()) - sourceRect.top();
+
+            for (int px = 0; px < planeWidth; px++) {
+                const int sx = qBound(sourceRect.left(), bandRect.left() - radius + px, sourceRect.right()) - sourceRect.left();
+
+                memcpy(planeBytes.data() + (py * planeWidth + px) * pixelSize,
+                       srcBytes.constData() + (sy * sourceRect.width() + sx) * pixelSize,
+                       pixelSize);
+            }
+        }
+
+        // the channels, which are not filtered, are kept as they are
+        QVector<quint8> dstBytes(bandRect.width() * bandRect.height() * pixelSize);
+        for (int y = 0; y < bandRect.height(); y++) {
+            memcpy(dstBytes.data() + y * bandRect.width() * pixelSize,
+                   planeBytes.constData() + ((y + radius) * planeWidth + radius) * pixelSize,
+                   bandRect.width() * pixelSize);
+        }
+
+        QVector<quint16> keys(planeWidth * planeHeight);
+        QVector<quint16> result(bandRect.width() * bandRect.height());
+
+        for (const ChannelCodec &codec : qAsConst(codecs)) {
+            for (int i = 0; i < keys.size(); i++) {
+                keys[i] = codec.key(planeBytes.constData() + i * pixelSize);
+            }
+
+            if (rank == 0 || rank == windowSize - 1) {
+                if (rank == 0) {
+                    rectExtremum<MinimumPolicy<quint16>>(keys.data(), planeWidth, planeHeight, radius, radius);
+                } else {
+                    rectExtremum<MaximumPolicy<quint16>>(keys.data(), planeWidth, planeHeight, radius, radius);
+                }
+
+                for (int y = 0; y < bandRect.height(); y++) {
+                    memcpy(result.data() + y * bandRect.width(),
+                           keys.constData() + (y + radius) * planeWidth + radius,
+                           bandRect.width() * sizeof(quint16));
+                }
+            } else {
+                rankPlane(keys.constData(), result.data(),
+                          bandRect.width(), bandRect.height(),
+                          radius, rank, codec.keyBits());
+            }
+
+            for (int i = 0; i < result.size(); i++) {
+                codec.store(dstBytes.data() + i * pixelSize, result[i]);
+            }
+
+            if (progressUpdater) {
+                QMutexLocker locker(&progressMutex);
+                progressUpdater->setProgress(100 * ++doneSteps / totalSteps);
+            }
+        }
+
+        dst->writeBytes(dstBytes.constData(), bandRect);
+    };
+
+    if (jobsInterface) {
+        QVector<KisRunnableStrokeJobData*> jobs;
+
+        Q_FOREACH (const QRect &bandRect, bands) {
+            KritaUtils::addJobConcurrent(jobs, [processBand, bandRect] () {
+                processBand(bandRect);
+            });
+        }
+
+        jobsInterface->addRunnableJobs(jobs);
+    } else {
+        Q_FOREACH (const QRect &bandRect, bands) {
+            processBand(bandRect);
+        }
+    }
+
+    KisPainter::copyAreaOptimized(rect.topLeft(), dst, device, rect);
+}
@@ -0,0 +1,89 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISRANKFILTER_H
+#define KISRANKFILTER_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+class QBitArray;
+class KoUpdater;
+class KisRunnableStrokeJobsInterface;
+
+/**
+ * The rank filters (median, percentile, minimum and maximum) with
+ * the cost per pixel independent from the radius.
+ *
+ * The median and the percentiles are found in the sliding column
+ * histograms by Perreault and Hébert ("Median Filtering in Constant
+ * Time", 2007). The 8-bit channels use 16 coarse and 16 fine bins,
+ * the 16-bit ones use 256 and 256 bins. The rest of the channel
+ * types are quantized into 16 bits in the range of the processed
+ * values.
+ *
+ * The minimum and the maximum are found with the van Herk/Gil-Werman
+ * algorithm, which needs three comparisons per pixel for a line of
+ * any length.
+ */
+class KRITAIMAGE_EXPORT KisRankFilter
+{
+public:
+    enum Extremum {
+        Minimum,
+        Maximum
+    };
+
+    /**
+     * Replaces the selected channels of every pixel of \p rect with the
+     * value of the rank \p percentile (0...100) in the square window of
+     * 2 * \p radius + 1 pixels. The channels are filtered independently.
+     *
+     * The pixels outside the bounds of the image are considered to be
+     * equal to the nearest pixels inside the bounds.
+     *
+     * If \p jobsInterface is not null, the bands of the rect are
+     * filtered in its concurrent jobs. The interface must finish the
+     * jobs before addRunnableJobs() returns, like
+     * KisThreadPoolRunnableStrokeJobsExecutor does.
+     */
+    static void apply(KisPaintDeviceSP device,
+                      const QRect &rect,
+                      int radius, qreal percentile,
+                      const QBitArray &channelFlags,
+                      KoUpdater *progressUpdater,
+                      KisRunnableStrokeJobsInterface *jobsInterface = 0);
+
+    /**
+     * Finds the minimum or the maximum of every 2 * \p radius + 1
+     * samples of the line, which are separated by \p step. The samples
+     * outside the line are ignored.
+     */
+    static void lineExtremum(quint8 *data, int length, int step, int radius, Extremum extremum);
+
+    /**
+     * The smallest radius the polygonal structuring element is
+     * used for instead of the exact ellipse
+     */
+    static const int polygonMinimumRadius;
+
+    /**
+     * Filters the plane of \p width x \p height bytes with a 16-sided
+     * polygon, which approximates the ellipse with the radii \p xRadius
+     * and \p yRadius. The polygon is circumscribed around the ellipse
+     * and is decomposed into eight line segments, so the cost doesn't
+     * depend on the radius.
+     *
+     * The pixels outside the plane are ignored, so the caller should
+     * pad the plane with the pixels it considers to be outside.
+     */
+    static void polygonExtremum(quint8 *plane, int width, int height,
+                                int xRadius, int yRadius,
+                                Extremum extremum);
+};
+
+#endif // KISRANKFILTER_H
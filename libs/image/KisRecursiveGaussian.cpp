@@ -0,0 +1,298 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisRecursiveGaussian.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QBitArray>
+#include <QRect>
+#include <QVector>
+
+#include <KoColorSpace.h>
+#include <KoUpdater.h>
+
+#include "kis_assert.h"
+#include "kis_paint_device.h"
+#include "kis_default_bounds.h"
+#include "kis_gaussian_kernel.h"
+#include "KisPremultipliedChannelConverter.h"
+
+const qreal KisRecursiveGaussian::minimumRadius = 48.0;
+
+namespace {
+
+/**
+ * The stripes are aligned to the tiles of the paint device
+ */
+const int stripeSize = 64;
+
+inline int nextStripeStart(int pos)
+{
+    static_assert(stripeSize == 64, "the stripe size should match the shift");
+
+    // the arithmetic shift rounds the negative coordinates down
+    return ((pos >> 6) + 1) << 6;
+}
+
+inline int numStripes(int start, int end)
+{
+    int result = 0;
+    for (int pos = start; pos <= end; pos = nextStripeStart(pos)) {
+        result++;
+    }
+    return result;
+}
+
+struct ProgressReporter
+{
+    ProgressReporter(KoUpdater *updater, int totalSteps)
+        : m_updater(updater),
+          m_totalSteps(qMax(1, totalSteps))
+    {
+    }
+
+    void step() {
+        m_doneSteps++;
+        if (m_updater) {
+            m_updater->setProgress(100 * m_doneSteps / m_totalSteps);
+        }
+    }
+
+private:
+    KoUpdater *m_updater;
+    int m_totalSteps;
+    int m_doneSteps {0};
+};
+
+/**
+ * Blurs the rows of \p applyRect, using the source pixels
+ * in the range [\p left, \p right]
+ */
+void horizontalPass(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                    const QRect &applyRect, int left, int right,
+                    const KisPremultipliedChannelConverter &converter,
+                    const KisRecursiveGaussian::Coefficients &c,
+                    ProgressReporter &progress)
+{
+    const int pixelSize = converter.pixelSize;
+    const int channelCount = converter.numChannels();
+    const int readWidth = right - left + 1;
+    const int offset = applyRect.x() - left;
+
+    QVector<quint8> srcBytes(readWidth * stripeSize * pixelSize);
+    QVector<quint8> dstBytes(applyRect.width() * stripeSize * pixelSize);
+    QVector<float> buffer(readWidth * stripeSize * channelCount);
+
+    for (int y = applyRect.top(); y <= applyRect.bottom(); y = nextStripeStart(y)) {
+        const int numRows = qMin(nextStripeStart(y), applyRect.bottom() + 1) - y;
+
+        src->readBytes(srcBytes.data(), QRect(left, y, readWidth, numRows));
+        converter.toFloat(srcBytes.constData(), buffer.data(), readWidth * numRows);
+
+        for (int row = 0; row < numRows; row++) {
+            const int rowStart = row * readWidth;
+            float *line = buffer.data() + rowStart * channelCount;
+
+            KisRecursiveGaussian::filterLine(line, readWidth, channelCount, channelCount, c);
+
+            quint8 *dstRow = dstBytes.data() + row * applyRect.width() * pixelSize;
+
+            // the channels, which are not blurred, are kept as they are
+            memcpy(dstRow, srcBytes.constData() + (rowStart + offset) * pixelSize,
+                   applyRect.width() * pixelSize);
+            converter.fromFloat(line + offset * channelCount, dstRow, applyRect.width());
+        }
+
+        dst->writeBytes(dstBytes.constData(), QRect(applyRect.x(), y, applyRect.width(), numRows));
+        progress.step();
+    }
+}
+
+/**
+ * Blurs the columns of \p applyRect, using the source pixels
+ * in the range [\p top, \p bottom]
+ */
+void verticalPass(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                  const QRect &applyRect, int top, int bottom,
+                  const KisPremultipliedChannelConverter &converter,
+                  const KisRecursiveGaussian::Coefficients &c,
+                  ProgressReporter &progress)
+{
+    const int pixelSize = converter.pixelSize;
+    const int channelCount = converter.numChannels();
+    const int readHeight = bottom - top + 1;
+    const int offset = applyRect.y() - top;
+
+    QVector<quint8> bytes(stripeSize * readHeight * pixelSize);
+    QVector<float> buffer(stripeSize * readHeight * channelCount);
+
+    for (int x = applyRect.left(); x <= applyRect.right(); x = nextStripeStart(x)) {
+        const int numColumns = qMin(nextStripeStart(x), applyRect.right() + 1) - x;
+
+        src->readBytes(bytes.data(), QRect(x, top, numColumns, readHeight));
+        converter.toFloat(bytes.constData(), buffer.data(), numColumns * readHeight);
+
+        /**
+         * All the columns of the stripe are filtered at once, which
+         * keeps the access to the buffer sequential
+         */
+        const int rowStride = numColumns * channelCount;
+        KisRecursiveGaussian::filterLine(buffer.data(), readHeight, rowStride, rowStride, c);
+
+        converter.fromFloat(buffer.constData() + offset * rowStride,
+                            bytes.data() + offset * numColumns * pixelSize,
+                            numColumns * applyRect.height());
+
+        dst->writeBytes(bytes.constData() + offset * numColumns * pixelSize,
+                        QRect(x, applyRect.y(), numColumns, applyRect.height()));
+        progress.step();
+    }
+}
+
+}
+
+KisRecursiveGaussian::Coefficients KisRecursiveGaussian::coefficientsFromRadius(qreal radius)
+{
+    /**
+     * Young, I. T., van Vliet, L. J. "Recursive implementation of
+     * the Gaussian filter", Signal Processing 44 (1995), 139-151
+     */
+    const qreal sigma = qMax(0.5, KisGaussianKernel::sigmaFromRadius(radius));
+
+    const qreal q = sigma >= 2.5 ?
+        0.98711 * sigma - 0.96330 :
+        3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+
+    const qreal q2 = q * q;
+    const qreal q3 = q2 * q;
+
+    const qreal b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+    const qreal b1 = 2.44413 * q + 2.85619 * q2 + 1.26661 * q3;
+    const qreal b2 = -(1.4281 * q2 + 1.26661 * q3);
+    const qreal b3 = 0.422205 * q3;
+
+    Coefficients c;
+    c.b1 = b1 / b0;
+    c.b2 = b2 / b0;
+    c.b3 = b3 / b0;
+    c.B = 1.0 - (b1 + b2 + b3) / b0;
+
+    return c;
+}
+
+bool KisRecursiveGaussian::isPreferredForRadius(qreal xRadius, qreal yRadius)
+{
+    return (xRadius > 0.0 || yRadius > 0.0) &&
+        (xRadius <= 0.0 || xRadius >= minimumRadius) &&
+        (yRadius <= 0.0 || yRadius >= minimumRadius);
+}
+
+void KisRecursiveGaussian::filterLine(float *data, int length, int step, int width,
+                                      const Coefficients &c)
+{
+    /**
+     * The samples outside the line are considered to be equal to
+     * the edge sample. The filter is normalized, so its response to
+     * such a constant extension is the edge sample itself, which lets
+     * us just clamp the indices of the previous samples.
+     */
+
+    for (int n = 0; n < length; n++) {
+        float *cur = data + n * step;
+        const float *p1 = data + qMax(n - 1, 0) * step;
+        const float *p2 = data + qMax(n - 2, 0) * step;
+        const float *p3 = data + qMax(n - 3, 0) * step;
+
+        for (int i = 0; i < width; i++) {
+            cur[i] = c.B * cur[i] + c.b1 * p1[i] + c.b2 * p2[i] + c.b3 * p3[i];
+        }
+    }
+
+    const int last = length - 1;
+
+    for (int n = last; n >= 0; n--) {
+        float *cur = data + n * step;
+        const float *p1 = data + qMin(n + 1, last) * step;
+        const float *p2 = data + qMin(n + 2, last) * step;
+        const float *p3 = data + qMin(n + 3, last) * step;
+
+        for (int i = 0; i < width; i++) {
+            cur[i] = c.B * cur[i] + c.b1 * p1[i] + c.b2 * p2[i] + c.b3 * p3[i];
+        }
+    }
+}
+
+void KisRecursiveGaussian::apply(KisPaintDeviceSP device,
+                                 const QRect& rect,
+                                 qreal xRadius, qreal yRadius,
+                                 const QBitArray &channelFlags,
+                                 KoUpdater *progressUpdater,
+                                 KisConvolutionBorderOp borderOp)
+{
+    if (rect.isEmpty() || (xRadius <= 0.0 && yRadius <= 0.0)) return;
+
+    const int xHalo = xRadius > 0.0 ? KisGaussianKernel::kernelSizeFromRadius(xRadius) / 2 : 0;
+    const int yHalo = yRadius > 0.0 ? KisGaussianKernel::kernelSizeFromRadius(yRadius) / 2 : 0;
+
+    /**
+     * The wraparound mode is handled by the paint device
+     * itself, the same way as in KisConvolutionPainter
+     */
+    if (device->defaultBounds()->wrapAroundMode()) {
+        borderOp = BORDER_IGNORE;
+    }
+
+    QRect dataRect = rect.adjusted(-xHalo, -yHalo, xHalo, yHalo);
+
+    if (borderOp == BORDER_REPEAT) {
+        /**
+         * The pixels outside the bounds are the repeated edge
+         * pixels, and filterLine() extends the lines with the edge
+         * values anyway, so we just don't read them.
+         */
+        const QRect boundsRect = device->defaultBounds()->bounds();
+        QRect repeatRect = rect | boundsRect;
+
+        KIS_SAFE_ASSERT_RECOVER(boundsRect != KisDefaultBounds().bounds()) {
+            repeatRect = rect | device->exactBounds();
+        }
+
+        dataRect &= repeatRect;
+    }
+
+    const KisPremultipliedChannelConverter converter(device->colorSpace(), channelFlags);
+    if (!converter.numChannels()) return;
+
+    ProgressReporter progress(progressUpdater,
+                              (xRadius > 0.0 ? numStripes(dataRect.top(), dataRect.bottom()) : 0) +
+                              (yRadius > 0.0 ? numStripes(rect.left(), rect.right()) : 0));
+
+    KisPaintDeviceSP src = device;
+
+    if (xRadius > 0.0) {
+        KisPaintDeviceSP dst = device;
+        QRect applyRect = rect;
+
+        if (yRadius > 0.0) {
+            dst = new KisPaintDevice(device->colorSpace());
+            dst->prepareClone(device);
+
+            applyRect = QRect(rect.x(), dataRect.y(), rect.width(), dataRect.height());
+        }
+
+        horizontalPass(src, dst, applyRect, dataRect.left(), dataRect.right(),
+                       converter, coefficientsFromRadius(xRadius), progress);
+
+        src = dst;
+    }
+
+    if (yRadius > 0.0) {
+        verticalPass(src, device, rect, dataRect.top(), dataRect.bottom(),
+                     converter, coefficientsFromRadius(yRadius), progress);
+    }
+}
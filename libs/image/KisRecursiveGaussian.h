@@ -0,0 +1,79 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISRECURSIVEGAUSSIAN_H
+#define KISRECURSIVEGAUSSIAN_H
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+#include "kis_convolution_painter.h"
+
+class QRect;
+class QBitArray;
+class KoUpdater;
+
+/**
+ * An approximation of the Gaussian blur with a constant cost per
+ * pixel, independent from the radius of the blur. It is a third
+ * order recursive (IIR) filter by Young and van Vliet, applied
+ * forward and backward along every row and then along every column.
+ *
+ * The filter is processed in stripes of tiles and uses the same
+ * sigma and the same size of the influence area as
+ * KisGaussianKernel, so it can replace the convolution for the
+ * radii that are too big for the kernel-based implementations.
+ */
+class KRITAIMAGE_EXPORT KisRecursiveGaussian
+{
+public:
+    /**
+     * The smallest radius the filter is used for by
+     * KisGaussianKernel::applyGaussian(). Smaller radii are cheap for
+     * the convolution, and the approximation error of the recursive
+     * filter grows when sigma becomes small.
+     */
+    static const qreal minimumRadius;
+
+    struct Coefficients {
+        float B;
+        float b1;
+        float b2;
+        float b3;
+    };
+
+    static Coefficients coefficientsFromRadius(qreal radius);
+
+    /**
+     * Returns true if the radii are big enough for the recursive
+     * filter to be preferred over the convolution
+     */
+    static bool isPreferredForRadius(qreal xRadius, qreal yRadius);
+
+    /**
+     * Blurs \p rect of \p device in place. The pixels outside \p rect,
+     * which are up to KisGaussianKernel::kernelSizeFromRadius() / 2
+     * pixels away from it, are used as the source data.
+     *
+     * The zero radius means the device is not blurred in
+     * the corresponding direction.
+     */
+    static void apply(KisPaintDeviceSP device,
+                      const QRect& rect,
+                      qreal xRadius, qreal yRadius,
+                      const QBitArray &channelFlags,
+                      KoUpdater *progressUpdater,
+                      KisConvolutionBorderOp borderOp = BORDER_REPEAT);
+
+    /**
+     * Filters \p length samples, separated by \p step floats. Every
+     * sample consists of \p width independent values, stored
+     * contiguously.
+     */
+    static void filterLine(float *data, int length, int step, int width,
+                           const Coefficients &c);
+};
+
+#endif // KISRECURSIVEGAUSSIAN_H
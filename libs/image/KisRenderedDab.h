@@ -33,4 +33,23 @@ struct KisRenderedDab
     }
 };
 
+/**
+ * A position of a copy of the dab on the canvas, used for
+ * batched blitting of the mirrored dabs, \see KisPainter::bltFixedPlacements()
+ */
+struct KisDabPlacement
+{
+    KisDabPlacement() {}
+    KisDabPlacement(const QPoint &_offset, bool _mirrorHorizontally = false, bool _mirrorVertically = false)
+        : offset(_offset),
+          mirrorHorizontally(_mirrorHorizontally),
+          mirrorVertically(_mirrorVertically)
+    {
+    }
+
+    QPoint offset;
+    bool mirrorHorizontally = false;
+    bool mirrorVertically = false;
+};
+
 #endif // KISRENDEREDDAB_H
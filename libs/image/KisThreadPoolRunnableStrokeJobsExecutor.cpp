@@ -0,0 +1,49 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisThreadPoolRunnableStrokeJobsExecutor.h"
+
+#include <KisRunnableStrokeJobDataBase.h>
+#include <kis_assert.h>
+
+#include <QVector>
+#include <QtConcurrent>
+
+void KisThreadPoolRunnableStrokeJobsExecutor::addRunnableJobs(const QVector<KisRunnableStrokeJobDataBase *> &list)
+{
+    QVector<KisRunnableStrokeJobDataBase*> concurrentJobs;
+
+    auto runConcurrentJobs = [&concurrentJobs] () {
+        if (concurrentJobs.size() > 1) {
+            // the calling thread takes part in processing, so it doesn't deadlock
+            // when called from a thread of the pool
+            QtConcurrent::blockingMap(concurrentJobs,
+                                      [] (KisRunnableStrokeJobDataBase *data) {
+                                          data->run();
+                                      });
+        } else if (!concurrentJobs.isEmpty()) {
+            concurrentJobs.first()->run();
+        }
+        concurrentJobs.clear();
+    };
+
+    Q_FOREACH (KisRunnableStrokeJobDataBase *data, list) {
+        KIS_SAFE_ASSERT_RECOVER_NOOP(data->exclusivity() != KisStrokeJobData::EXCLUSIVE && "exclusive jobs are not supported on the thread pool executor");
+
+        if (data->sequentiality() == KisStrokeJobData::CONCURRENT ||
+            data->sequentiality() == KisStrokeJobData::UNIQUELY_CONCURRENT) {
+
+            concurrentJobs.append(data);
+        } else {
+            runConcurrentJobs();
+            data->run();
+        }
+    }
+
+    runConcurrentJobs();
+
+    qDeleteAll(list);
+}
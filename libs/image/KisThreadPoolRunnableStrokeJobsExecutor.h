@@ -0,0 +1,27 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTHREADPOOLRUNNABLESTROKEJOBSEXECUTOR_H
+#define KISTHREADPOOLRUNNABLESTROKEJOBSEXECUTOR_H
+
+#include "KisRunnableStrokeJobsInterface.h"
+
+/**
+ * An executor for the code that runs outside of a stroke, but still
+ * wants to use the concurrent jobs. The consequent concurrent jobs are
+ * run on the global thread pool, all the other jobs work as barriers
+ * and are run in the calling thread.
+ *
+ * Like in KisFakeRunnableStrokeJobsExecutor, all the jobs are finished
+ * when addRunnableJobs() returns.
+ */
+class KRITAIMAGE_EXPORT KisThreadPoolRunnableStrokeJobsExecutor : public KisRunnableStrokeJobsInterface
+{
+public:
+    void addRunnableJobs(const QVector<KisRunnableStrokeJobDataBase*> &list) override;
+};
+
+#endif // KISTHREADPOOLRUNNABLESTROKEJOBSEXECUTOR_H
@@ -0,0 +1,495 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTiledHistogram.h"
+
+#include <algorithm>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QRect>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+
+#include "kis_assert.h"
+#include "kis_paint_device.h"
+#include "KisRunnableStrokeJobsInterface.h"
+#include "KisRunnableStrokeJobUtils.h"
+
+namespace {
+
+const int cellSizeShift = 7;
+
+typedef QPair<int, int> CellIndex;
+
+inline int cellIndex(int pos)
+{
+    // rounds the negative coordinates down as well
+    return pos >> cellSizeShift;
+}
+
+inline QRect cellRect(const CellIndex &index)
+{
+    const int size = 1 << cellSizeShift;
+    return QRect(index.first * size, index.second * size, size, size);
+}
+
+enum BinningType {
+    BinU8,
+    BinU16,
+    BinF32,
+    BinNormalized
+};
+
+struct ChannelBinning {
+    BinningType type {BinNormalized};
+    int pos {0};
+    float min {0.0f};
+    float scale {1.0f};
+};
+
+struct U8Binner {
+    U8Binner(int log2Bins) : shift(16 - log2Bins) {}
+
+    inline quint32 operator()(const quint8 *data) const {
+        // 257 stretches 255 to 65535, so that the bins are
+        // spread evenly for any number of them
+        return (quint32(*data) * 257) >> shift;
+    }
+
+    const int shift;
+};
+
+struct U16Binner {
+    U16Binner(int log2Bins) : shift(16 - log2Bins) {}
+
+    inline quint32 operator()(const quint8 *data) const {
+        return quint32(*reinterpret_cast<const quint16*>(data)) >> shift;
+    }
+
+    const int shift;
+};
+
+struct FloatBinner {
+    FloatBinner(float _min, float _scale, int numBins)
+        : min(_min), scale(_scale), maxBin(numBins - 1) {}
+
+    inline quint32 binValue(float value) const {
+        const float x = (value - min) * scale;
+        // NaN goes to the first bin
+        return x > 0.0f ? (x < maxBin ? quint32(x) : quint32(maxBin)) : 0;
+    }
+
+    inline quint32 operator()(const quint8 *data) const {
+        return binValue(*reinterpret_cast<const float*>(data));
+    }
+
+    const float min;
+    const float scale;
+    const int maxBin;
+};
+
+/**
+ * Counts the values into four interleaved copies of the histogram.
+ * Consecutive pixels often fall into the same bin, and incrementing
+ * the same counter in a row stalls on the store-to-load dependency.
+ * With four copies the increments of the neighbouring pixels are
+ * independent and can be executed in parallel.
+ */
+template <class Binner>
+void countChannel(const quint8 *data, int numPixels, int pixelSize,
+                  const Binner &binner, quint32 *lanes, int numBins)
+{
+    quint32 *lane0 = lanes;
+    quint32 *lane1 = lanes + numBins;
+    quint32 *lane2 = lanes + 2 * numBins;
+    quint32 *lane3 = lanes + 3 * numBins;
+
+    int i = 0;
+    for (; i + 4 <= numPixels; i += 4) {
+        lane0[binner(data)]++;
+        lane1[binner(data + pixelSize)]++;
+        lane2[binner(data + 2 * pixelSize)]++;
+        lane3[binner(data + 3 * pixelSize)]++;
+        data += 4 * pixelSize;
+    }
+
+    for (; i < numPixels; i++) {
+        lane0[binner(data)]++;
+        data += pixelSize;
+    }
+}
+
+}
+
+const int KisTiledHistogram::cellSize = 1 << cellSizeShift;
+
+struct KisTiledHistogram::Private
+{
+    struct Cell {
+        /// the rect the partial histogram was counted in
+        QRect rect;
+        /// incremented on every setDirty() touching the cell
+        int dirtyRevision {0};
+        /// the value of dirtyRevision the partial histogram was counted at
+        int countedRevision {-1};
+        /// numChannels * numBins counters, empty if not counted yet
+        std::vector<quint32> bins;
+        quint32 count {0};
+    };
+    typedef QSharedPointer<Cell> CellSP;
+
+    /**
+     * The task carries a copy of the binning, so that the histogram
+     * could be reset while the cell is being counted
+     */
+    struct Task {
+        CellIndex index;
+        CellSP cell;
+        QRect rect;
+        int revision;
+        const KoColorSpace *colorSpace;
+        std::vector<ChannelBinning> channels;
+    };
+
+    int numBins {256};
+    int log2Bins {8};
+
+    mutable QMutex mutex;
+    QHash<CellIndex, CellSP> cells;
+
+    const KoColorSpace *colorSpace {0};
+    std::vector<ChannelBinning> channels;
+    std::vector<quint32> totals;
+    quint64 count {0};
+
+    void resetColorSpace(const KoColorSpace *cs);
+    void countCell(KisPaintDeviceSP device, const Task &task);
+    void applyCell(const Task &task, std::vector<quint32> &bins, quint32 numPixels);
+    void dropCell(const CellSP &cell);
+
+    template <typename Func>
+    void forEachExistingCell(const QRect &rect, Func func);
+};
+
+void KisTiledHistogram::Private::resetColorSpace(const KoColorSpace *cs)
+{
+    cells.clear();
+    colorSpace = cs;
+    channels.clear();
+    count = 0;
+
+    if (!cs) {
+        totals.clear();
+        return;
+    }
+
+    Q_FOREACH (const KoChannelInfo *channel, cs->channels()) {
+        ChannelBinning binning;
+        binning.pos = channel->pos();
+
+        switch (channel->channelValueType()) {
+        case KoChannelInfo::UINT8:
+            binning.type = BinU8;
+            break;
+        case KoChannelInfo::UINT16:
+            binning.type = BinU16;
+            break;
+        case KoChannelInfo::FLOAT32: {
+            binning.type = BinF32;
+
+            const qreal min = channel->getUIMin();
+            const qreal max = channel->getUIMax();
+
+            if (max > min) {
+                binning.min = min;
+                binning.scale = numBins / (max - min);
+            } else {
+                binning.min = 0.0f;
+                binning.scale = numBins;
+            }
+            break;
+        }
+        default:
+            binning.type = BinNormalized;
+            binning.min = 0.0f;
+            binning.scale = numBins;
+            break;
+        }
+
+        channels.push_back(binning);
+    }
+
+    totals.assign(channels.size() * numBins, 0);
+}
+
+void KisTiledHistogram::Private::countCell(KisPaintDeviceSP device, const Task &task)
+{
+    const std::vector<ChannelBinning> &channels = task.channels;
+    const int numChannels = channels.size();
+    const int pixelSize = task.colorSpace->pixelSize();
+
+    // the device has been converted after the task was created, the
+    // next update() will reset the histogram
+    if (int(device->pixelSize()) != pixelSize) return;
+
+    const int numPixels = task.rect.width() * task.rect.height();
+
+    std::vector<quint8> pixels(numPixels * pixelSize);
+    device->readBytes(pixels.data(), task.rect);
+
+    std::vector<quint32> bins(numChannels * numBins, 0);
+    std::vector<quint32> lanes(4 * numBins);
+
+    bool hasNormalizedChannels = false;
+
+    for (int i = 0; i < numChannels; i++) {
+        const ChannelBinning &binning = channels[i];
+        const quint8 *data = pixels.data() + binning.pos;
+
+        std::fill(lanes.begin(), lanes.end(), 0);
+
+        switch (binning.type) {
+        case BinU8:
+            countChannel(data, numPixels, pixelSize, U8Binner(log2Bins), lanes.data(), numBins);
+            break;
+        case BinU16:
+            countChannel(data, numPixels, pixelSize, U16Binner(log2Bins), lanes.data(), numBins);
+            break;
+        case BinF32:
+            countChannel(data, numPixels, pixelSize,
+                         FloatBinner(binning.min, binning.scale, numBins),
+                         lanes.data(), numBins);
+            break;
+        case BinNormalized:
+            hasNormalizedChannels = true;
+            continue;
+        }
+
+        quint32 *channelBins = bins.data() + i * numBins;
+        for (int bin = 0; bin < numBins; bin++) {
+            channelBins[bin] = lanes[bin] + lanes[numBins + bin] +
+                lanes[2 * numBins + bin] + lanes[3 * numBins + bin];
+        }
+    }
+
+    if (hasNormalizedChannels) {
+        const FloatBinner binner(0.0f, numBins, numBins);
+        QVector<float> values(numChannels);
+
+        const quint8 *data = pixels.data();
+        for (int j = 0; j < numPixels; j++) {
+            task.colorSpace->normalisedChannelsValue(data, values);
+
+            for (int i = 0; i < numChannels; i++) {
+                if (channels[i].type == BinNormalized) {
+                    bins[i * numBins + binner.binValue(values[i])]++;
+                }
+            }
+            data += pixelSize;
+        }
+    }
+
+    QMutexLocker l(&mutex);
+    applyCell(task, bins, numPixels);
+}
+
+void KisTiledHistogram::Private::applyCell(const Task &task, std::vector<quint32> &bins, quint32 numPixels)
+{
+    // the cell has been dropped or the histogram reset while counting
+    if (cells.value(task.index) != task.cell) return;
+
+    CellSP cell = task.cell;
+
+    if (!cell->bins.empty()) {
+        for (size_t i = 0; i < totals.size(); i++) {
+            totals[i] -= cell->bins[i];
+        }
+        count -= cell->count;
+    }
+
+    for (size_t i = 0; i < totals.size(); i++) {
+        totals[i] += bins[i];
+    }
+    count += numPixels;
+
+    cell->bins.swap(bins);
+    cell->count = numPixels;
+    cell->rect = task.rect;
+
+    /**
+     * If the cell was marked dirty while counting, the revisions
+     * differ and the cell will be counted again on the next update
+     */
+    cell->countedRevision = task.revision;
+}
+
+void KisTiledHistogram::Private::dropCell(const CellSP &cell)
+{
+    if (cell->bins.empty()) return;
+
+    for (size_t i = 0; i < totals.size(); i++) {
+        totals[i] -= cell->bins[i];
+    }
+    count -= cell->count;
+}
+
+template <typename Func>
+void KisTiledHistogram::Private::forEachExistingCell(const QRect &rect, Func func)
+{
+    const int left = cellIndex(rect.left());
+    const int right = cellIndex(rect.right());
+    const int top = cellIndex(rect.top());
+    const int bottom = cellIndex(rect.bottom());
+
+    const qint64 numCellsInRect = qint64(right - left + 1) * (bottom - top + 1);
+
+    if (numCellsInRect > cells.size()) {
+        for (auto it = cells.begin(); it != cells.end(); ++it) {
+            if (cellRect(it.key()).intersects(rect)) {
+                func(it.value());
+            }
+        }
+    } else {
+        for (int y = top; y <= bottom; y++) {
+            for (int x = left; x <= right; x++) {
+                CellSP cell = cells.value(CellIndex(x, y));
+                if (cell) {
+                    func(cell);
+                }
+            }
+        }
+    }
+}
+
+KisTiledHistogram::KisTiledHistogram(int numBins)
+    : m_d(new Private)
+{
+    KIS_SAFE_ASSERT_RECOVER(numBins >= 2 && numBins <= 65536 && !(numBins & (numBins - 1))) {
+        numBins = 256;
+    }
+
+    m_d->numBins = numBins;
+
+    m_d->log2Bins = 0;
+    while ((1 << m_d->log2Bins) < numBins) {
+        m_d->log2Bins++;
+    }
+}
+
+KisTiledHistogram::~KisTiledHistogram()
+{
+}
+
+int KisTiledHistogram::numBins() const
+{
+    return m_d->numBins;
+}
+
+void KisTiledHistogram::setDirty(const QRect &rect)
+{
+    if (rect.isEmpty()) return;
+
+    QMutexLocker l(&m_d->mutex);
+
+    m_d->forEachExistingCell(rect, [] (const Private::CellSP &cell) {
+        cell->dirtyRevision++;
+    });
+}
+
+void KisTiledHistogram::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->resetColorSpace(0);
+}
+
+void KisTiledHistogram::update(KisPaintDeviceSP device, const QRect &bounds,
+                               KisRunnableStrokeJobsInterface *jobsInterface)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(device);
+
+    QVector<Private::Task> tasks;
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        const KoColorSpace *cs = device->colorSpace();
+        if (!m_d->colorSpace || !(*m_d->colorSpace == *cs)) {
+            m_d->resetColorSpace(cs);
+        }
+
+        for (auto it = m_d->cells.begin(); it != m_d->cells.end();) {
+            if (!cellRect(it.key()).intersects(bounds)) {
+                m_d->dropCell(it.value());
+                it = m_d->cells.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (bounds.isEmpty()) return;
+
+        for (int y = cellIndex(bounds.top()); y <= cellIndex(bounds.bottom()); y++) {
+            for (int x = cellIndex(bounds.left()); x <= cellIndex(bounds.right()); x++) {
+                const CellIndex index(x, y);
+                const QRect rect = cellRect(index) & bounds;
+
+                Private::CellSP &cell = m_d->cells[index];
+                if (!cell) {
+                    cell.reset(new Private::Cell());
+                }
+
+                if (cell->countedRevision != cell->dirtyRevision || cell->rect != rect) {
+                    tasks.append({index, cell, rect, cell->dirtyRevision, cs, m_d->channels});
+                }
+            }
+        }
+    }
+
+    if (jobsInterface) {
+        QVector<KisRunnableStrokeJobData*> jobs;
+
+        Q_FOREACH (const Private::Task &task, tasks) {
+            KritaUtils::addJobConcurrent(jobs, [this, device, task] () {
+                m_d->countCell(device, task);
+            });
+        }
+
+        jobsInterface->addRunnableJobs(jobs);
+    } else {
+        Q_FOREACH (const Private::Task &task, tasks) {
+            m_d->countCell(device, task);
+        }
+    }
+}
+
+const KoColorSpace* KisTiledHistogram::colorSpace() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->colorSpace;
+}
+
+std::vector<quint32> KisTiledHistogram::bins(int channel) const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(channel >= 0 && channel < int(m_d->channels.size()),
+                                         std::vector<quint32>(m_d->numBins, 0));
+
+    auto begin = m_d->totals.begin() + channel * m_d->numBins;
+    return std::vector<quint32>(begin, begin + m_d->numBins);
+}
+
+quint64 KisTiledHistogram::count() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->count;
+}
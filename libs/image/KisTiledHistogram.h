@@ -0,0 +1,108 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTILEDHISTOGRAM_H
+#define KISTILEDHISTOGRAM_H
+
+#include <vector>
+
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+class KoColorSpace;
+class KisRunnableStrokeJobsInterface;
+
+/**
+ * A per-channel histogram of a paint device, which is kept up to date
+ * incrementally.
+ *
+ * The device is split into square cells aligned to the tiles of the
+ * device. Every cell keeps its own partial histogram and the total is
+ * the sum of the partial histograms. When some area of the device is
+ * changed, the owner marks it with setDirty() and the next call to
+ * update() recounts only the cells touching the dirty area, so the
+ * cost of the update is proportional to the size of the change, not
+ * to the size of the device.
+ *
+ * The channels are binned by their native type: 8- and 16-bit
+ * integer channels are binned with a bit shift, 32-bit float channels
+ * are binned linearly in the UI range of the channel. The rest of the
+ * channel types are binned by their normalized value.
+ *
+ * setDirty() may be called from any thread, e.g. directly from
+ * KisImage::sigImageUpdated(). The histogram doesn't track the
+ * device itself, so when its content is replaced without the updates
+ * of the changed areas (e.g. the image is cropped or another frame is
+ * shown), the owner should mark the whole bounds dirty.
+ */
+class KRITAIMAGE_EXPORT KisTiledHistogram
+{
+public:
+    /**
+     * @param numBins the number of bins per channel, should be a power
+     *                of two in the range 2...65536
+     */
+    KisTiledHistogram(int numBins = 256);
+    ~KisTiledHistogram();
+
+    int numBins() const;
+
+    /**
+     * The size of the side of the square cells the histogram is
+     * counted in
+     */
+    static const int cellSize;
+
+    /**
+     * Marks the pixels in \p rect as changed. The cells touching the
+     * rect will be recounted on the next update().
+     */
+    void setDirty(const QRect &rect);
+
+    /**
+     * Forgets all the partial histograms
+     */
+    void clear();
+
+    /**
+     * Recounts the dirty cells of the part \p bounds of \p device. The
+     * cells outside \p bounds are dropped, the cells that appeared in
+     * \p bounds are counted. If the color space of the device has
+     * changed, the whole histogram is recounted.
+     *
+     * If \p jobsInterface is not null, the cells are counted in
+     * concurrent jobs added to it, and the total is ready when the jobs
+     * are completed. Otherwise, the cells are counted in the calling
+     * thread.
+     */
+    void update(KisPaintDeviceSP device, const QRect &bounds,
+                KisRunnableStrokeJobsInterface *jobsInterface = 0);
+
+    /**
+     * The color space of the last update() call
+     */
+    const KoColorSpace* colorSpace() const;
+
+    /**
+     * The merged histogram of the channel \p channel in the order of
+     * KoColorSpace::channels()
+     */
+    std::vector<quint32> bins(int channel) const;
+
+    /**
+     * The number of pixels counted into the histogram
+     */
+    quint64 count() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISTILEDHISTOGRAM_H
@@ -0,0 +1,427 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisStrokeRecording.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QSharedPointer>
+
+#include <kis_debug.h>
+
+#include "kis_painter.h"
+#include "kis_paintop.h"
+#include "kis_distance_information.h"
+#include "kis_random_source.h"
+#include "KisPerStrokeRandomSource.h"
+#include "KisRunnableStrokeJobData.h"
+
+namespace {
+
+const quint32 recordingMagic = 0x4b535452; // "KSTR"
+const quint16 recordingVersion = 1;
+
+/**
+ * The asynchronous paintops never do more updates than that
+ * for a single event, the limit just protects from a hang
+ */
+const int maxAsynchronousUpdates = 1000;
+
+void writePaintInformation(QDataStream &stream, const KisPaintInformation &pi)
+{
+    const quint8 flags =
+        (pi.canvasMirroredH() ? 0x1 : 0x0) |
+        (pi.canvasMirroredV() ? 0x2 : 0x0);
+
+    stream << pi.pos().x() << pi.pos().y()
+           << pi.pressure()
+           << pi.xTilt() << pi.yTilt()
+           << pi.rotation()
+           << pi.tangentialPressure()
+           << pi.perspective()
+           << pi.currentTime()
+           << pi.drawingSpeed()
+           << pi.canvasRotation()
+           << flags;
+}
+
+KisPaintInformation readPaintInformation(QDataStream &stream)
+{
+    qreal x, y, pressure, xTilt, yTilt, rotation, tangentialPressure, perspective, time, speed, canvasRotation;
+    quint8 flags;
+
+    stream >> x >> y
+           >> pressure
+           >> xTilt >> yTilt
+           >> rotation
+           >> tangentialPressure
+           >> perspective
+           >> time
+           >> speed
+           >> canvasRotation
+           >> flags;
+
+    KisPaintInformation pi(QPointF(x, y), pressure, xTilt, yTilt,
+                           rotation, tangentialPressure, perspective, time, speed);
+    pi.setCanvasRotation(canvasRotation);
+    pi.setCanvasMirroredH(flags & 0x1);
+    pi.setCanvasMirroredV(flags & 0x2);
+
+    return pi;
+}
+
+void flushAsynchronousUpdates(KisPaintOp *paintOp)
+{
+    for (int i = 0; i < maxAsynchronousUpdates; i++) {
+        QVector<KisRunnableStrokeJobData*> jobs;
+        bool needsMoreUpdates = false;
+
+        std::tie(std::ignore, needsMoreUpdates) = paintOp->doAsynchronousUpdate(jobs);
+
+        Q_FOREACH (KisRunnableStrokeJobData *job, jobs) {
+            job->run();
+            delete job;
+        }
+
+        if (jobs.isEmpty() && !needsMoreUpdates) break;
+    }
+}
+
+}
+
+struct KisStrokeRecording::Private
+{
+    QVector<Stroke> strokes;
+    QElapsedTimer strokeTime;
+};
+
+qreal KisStrokeRecording::ReplayStatistics::dabsPerSecond() const
+{
+    return wallTime > 0 ? qreal(numDabs) * 1e9 / wallTime : 0.0;
+}
+
+qint64 KisStrokeRecording::ReplayStatistics::latencyPercentile(qreal percentile) const
+{
+    if (dabLatencies.isEmpty()) return 0;
+
+    const int index = qBound(0,
+                             int(std::ceil(percentile / 100.0 * dabLatencies.size())) - 1,
+                             dabLatencies.size() - 1);
+
+    return dabLatencies[index];
+}
+
+KisStrokeRecording::KisStrokeRecording()
+    : m_d(new Private)
+{
+}
+
+KisStrokeRecording::~KisStrokeRecording()
+{
+}
+
+void KisStrokeRecording::beginStroke()
+{
+    m_d->strokes.append(Stroke());
+    m_d->strokeTime.start();
+}
+
+void KisStrokeRecording::addPaintAt(int strokeInfoId, const KisPaintInformation &pi)
+{
+    Event event;
+    event.type = PaintAt;
+    event.strokeInfoId = strokeInfoId;
+    event.timestamp = m_d->strokeTime.nsecsElapsed() / 1000;
+    event.pi1 = pi;
+
+    addEvent(event);
+}
+
+void KisStrokeRecording::addPaintLine(int strokeInfoId,
+                                      const KisPaintInformation &pi1,
+                                      const KisPaintInformation &pi2)
+{
+    Event event;
+    event.type = PaintLine;
+    event.strokeInfoId = strokeInfoId;
+    event.timestamp = m_d->strokeTime.nsecsElapsed() / 1000;
+    event.pi1 = pi1;
+    event.pi2 = pi2;
+
+    addEvent(event);
+}
+
+void KisStrokeRecording::addPaintBezierCurve(int strokeInfoId,
+                                             const KisPaintInformation &pi1,
+                                             const QPointF &control1,
+                                             const QPointF &control2,
+                                             const KisPaintInformation &pi2)
+{
+    Event event;
+    event.type = PaintBezierCurve;
+    event.strokeInfoId = strokeInfoId;
+    event.timestamp = m_d->strokeTime.nsecsElapsed() / 1000;
+    event.pi1 = pi1;
+    event.pi2 = pi2;
+    event.control1 = control1;
+    event.control2 = control2;
+
+    addEvent(event);
+}
+
+void KisStrokeRecording::addEvent(const Event &event)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(!m_d->strokes.isEmpty());
+    m_d->strokes.last().events.append(event);
+}
+
+const QVector<KisStrokeRecording::Stroke>& KisStrokeRecording::strokes() const
+{
+    return m_d->strokes;
+}
+
+int KisStrokeRecording::numEvents() const
+{
+    int result = 0;
+
+    Q_FOREACH (const Stroke &stroke, m_d->strokes) {
+        result += stroke.events.size();
+    }
+
+    return result;
+}
+
+bool KisStrokeRecording::isEmpty() const
+{
+    return !numEvents();
+}
+
+void KisStrokeRecording::clear()
+{
+    m_d->strokes.clear();
+}
+
+bool KisStrokeRecording::save(QIODevice *device) const
+{
+    QByteArray payload;
+
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_12);
+
+        // the single precision is enough for the input events
+        stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+        stream << qint32(m_d->strokes.size());
+
+        Q_FOREACH (const Stroke &stroke, m_d->strokes) {
+            stream << qint32(stroke.events.size());
+
+            Q_FOREACH (const Event &event, stroke.events) {
+                stream << quint8(event.type)
+                       << qint32(event.strokeInfoId)
+                       << qint64(event.timestamp);
+
+                writePaintInformation(stream, event.pi1);
+
+                if (event.type != PaintAt) {
+                    writePaintInformation(stream, event.pi2);
+                }
+
+                if (event.type == PaintBezierCurve) {
+                    stream << event.control1 << event.control2;
+                }
+            }
+        }
+    }
+
+    QDataStream stream(device);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream << recordingMagic << recordingVersion << qCompress(payload);
+
+    return stream.status() == QDataStream::Ok;
+}
+
+bool KisStrokeRecording::save(const QString &fileName) const
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        warnKrita << "KisStrokeRecording: failed to open" << fileName << "for writing";
+        return false;
+    }
+
+    return save(&file);
+}
+
+bool KisStrokeRecording::load(QIODevice *device)
+{
+    QVector<Stroke> strokes;
+
+    QDataStream headerStream(device);
+    headerStream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    QByteArray compressedPayload;
+
+    headerStream >> magic >> version;
+
+    if (magic != recordingMagic || version != recordingVersion) {
+        warnKrita << "KisStrokeRecording: unsupported file format" << magic << version;
+        return false;
+    }
+
+    headerStream >> compressedPayload;
+    const QByteArray payload = qUncompress(compressedPayload);
+
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    qint32 numStrokes = 0;
+    stream >> numStrokes;
+
+    for (int i = 0; i < numStrokes && stream.status() == QDataStream::Ok; i++) {
+        Stroke stroke;
+
+        qint32 numEvents = 0;
+        stream >> numEvents;
+
+        for (int j = 0; j < numEvents && stream.status() == QDataStream::Ok; j++) {
+            quint8 type = 0;
+            qint32 strokeInfoId = 0;
+            qint64 timestamp = 0;
+
+            stream >> type >> strokeInfoId >> timestamp;
+
+            if (type > PaintBezierCurve) {
+                stream.setStatus(QDataStream::ReadCorruptData);
+                break;
+            }
+
+            Event event;
+            event.type = EventType(type);
+            event.strokeInfoId = strokeInfoId;
+            event.timestamp = timestamp;
+            event.pi1 = readPaintInformation(stream);
+
+            if (event.type != PaintAt) {
+                event.pi2 = readPaintInformation(stream);
+            }
+
+            if (event.type == PaintBezierCurve) {
+                stream >> event.control1 >> event.control2;
+            }
+
+            stroke.events.append(event);
+        }
+
+        strokes.append(stroke);
+    }
+
+    if (headerStream.status() != QDataStream::Ok ||
+        stream.status() != QDataStream::Ok) {
+
+        warnKrita << "KisStrokeRecording: the file is corrupted";
+        return false;
+    }
+
+    m_d->strokes = strokes;
+    return true;
+}
+
+bool KisStrokeRecording::load(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        warnKrita << "KisStrokeRecording: failed to open" << fileName;
+        return false;
+    }
+
+    return load(&file);
+}
+
+KisStrokeRecording::ReplayStatistics KisStrokeRecording::replay(KisPainter *painter, int seed) const
+{
+    ReplayStatistics stats;
+
+    KisPaintOp *paintOp = painter->paintOp();
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(paintOp, stats);
+
+    QElapsedTimer timer;
+
+    for (int strokeIndex = 0; strokeIndex < m_d->strokes.size(); strokeIndex++) {
+        const Stroke &stroke = m_d->strokes[strokeIndex];
+        if (stroke.events.isEmpty()) continue;
+
+        KisRandomSourceSP randomSource = new KisRandomSource(seed + strokeIndex);
+        KisPerStrokeRandomSourceSP perStrokeRandomSource = new KisPerStrokeRandomSource(seed + strokeIndex);
+
+        QHash<int, QSharedPointer<KisDistanceInformation>> distances;
+
+        Q_FOREACH (const Event &event, stroke.events) {
+            QSharedPointer<KisDistanceInformation> distance = distances.value(event.strokeInfoId);
+
+            if (!distance) {
+                distance.reset(new KisDistanceInformation(event.pi1.pos(), 0.0));
+                distances.insert(event.strokeInfoId, distance);
+            }
+
+            KisPaintInformation pi1(event.pi1);
+            pi1.setRandomSource(randomSource);
+            pi1.setPerStrokeRandomSource(perStrokeRandomSource);
+
+            KisPaintInformation pi2(event.pi2);
+            pi2.setRandomSource(randomSource);
+            pi2.setPerStrokeRandomSource(perStrokeRandomSource);
+
+            const int dabSeqNoBefore = distance->currentDabSeqNo();
+
+            timer.start();
+
+            switch (event.type) {
+            case PaintAt:
+                painter->paintAt(pi1, distance.data());
+                break;
+            case PaintLine:
+                painter->paintLine(pi1, pi2, distance.data());
+                break;
+            case PaintBezierCurve:
+                painter->paintBezierCurve(pi1, event.control1, event.control2, pi2, distance.data());
+                break;
+            }
+
+            flushAsynchronousUpdates(paintOp);
+
+            const qint64 elapsed = timer.nsecsElapsed();
+            const int numDabs = distance->currentDabSeqNo() - dabSeqNoBefore;
+
+            stats.wallTime += elapsed;
+            stats.numDabs += numDabs;
+
+            // the dabs of one event are rendered together
+            for (int i = 0; i < numDabs; i++) {
+                stats.dabLatencies.append(elapsed / numDabs);
+            }
+
+            painter->takeDirtyRegion();
+        }
+
+        stats.numStrokes++;
+    }
+
+    std::sort(stats.dabLatencies.begin(), stats.dabLatencies.end());
+
+    return stats;
+}
@@ -0,0 +1,130 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSTROKERECORDING_H
+#define KISSTROKERECORDING_H
+
+#include <QScopedPointer>
+#include <QVector>
+#include <QPointF>
+
+#include "kis_paint_information.h"
+#include "kritaimage_export.h"
+
+class QIODevice;
+class KisPainter;
+
+/**
+ * A recording of the freehand strokes, i.e. the stream of the paint
+ * information objects (with their timings) that the freehand tool
+ * passes to the paintop.
+ *
+ * The recording can be saved into a compact binary file and replayed
+ * headlessly against any preset with replay(). Replaying is
+ * deterministic: all the random sources of the paintop are seeded
+ * from the stroke index.
+ *
+ * When Krita is built with RECORD_STROKES defined in
+ * kis_tool_freehand_helper.cpp, the freehand tool records the strokes
+ * into the directory KRITA_RECORD_STROKES environment variable points
+ * to, \see KisToolFreehandHelper.
+ */
+class KRITAIMAGE_EXPORT KisStrokeRecording
+{
+public:
+    enum EventType {
+        PaintAt = 0,
+        PaintLine,
+        PaintBezierCurve
+    };
+
+    struct Event {
+        EventType type {PaintAt};
+        int strokeInfoId {0};
+
+        /// the time since the start of the stroke, in microseconds
+        qint64 timestamp {0};
+
+        KisPaintInformation pi1;
+        KisPaintInformation pi2;
+        QPointF control1;
+        QPointF control2;
+    };
+
+    struct Stroke {
+        QVector<Event> events;
+    };
+
+    struct ReplayStatistics {
+        int numStrokes {0};
+        qint64 numDabs {0};
+
+        /// the total time spent in the paintop, in nanoseconds
+        qint64 wallTime {0};
+
+        /// the latency of every dab, in nanoseconds, sorted
+        QVector<qint64> dabLatencies;
+
+        qreal dabsPerSecond() const;
+
+        /**
+         * \return the latency in nanoseconds that \p percentile
+         * percents of the dabs don't exceed
+         */
+        qint64 latencyPercentile(qreal percentile) const;
+    };
+
+public:
+    KisStrokeRecording();
+    ~KisStrokeRecording();
+
+    /**
+     * Starts a new stroke, the timestamps of the following events
+     * are measured from this call
+     */
+    void beginStroke();
+
+    void addPaintAt(int strokeInfoId, const KisPaintInformation &pi);
+    void addPaintLine(int strokeInfoId,
+                      const KisPaintInformation &pi1,
+                      const KisPaintInformation &pi2);
+    void addPaintBezierCurve(int strokeInfoId,
+                             const KisPaintInformation &pi1,
+                             const QPointF &control1,
+                             const QPointF &control2,
+                             const KisPaintInformation &pi2);
+
+    /**
+     * Adds an event with a predefined timestamp into the current
+     * stroke, used for generating synthetic recordings
+     */
+    void addEvent(const Event &event);
+
+    const QVector<Stroke>& strokes() const;
+    int numEvents() const;
+    bool isEmpty() const;
+    void clear();
+
+    bool save(QIODevice *device) const;
+    bool save(const QString &fileName) const;
+
+    bool load(QIODevice *device);
+    bool load(const QString &fileName);
+
+    /**
+     * Paints all the recorded strokes with \p painter. The painter
+     * should have the paintop preset already set up. The asynchronous
+     * updates of the paintop are executed right after every event,
+     * so the measured latency includes the rendering of the dabs.
+     */
+    ReplayStatistics replay(KisPainter *painter, int seed = 0) const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISSTROKERECORDING_H
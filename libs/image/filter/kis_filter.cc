@@ -18,6 +18,13 @@
 #include "kis_types.h"
 #include <kis_painter.h>
 #include <KoUpdater.h>
+#include <KisRunnableStrokeJobsInterface.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisThreadPoolRunnableStrokeJobsExecutor.h>
+#include "krita_utils.h"
+
+#include <QMutex>
+#include <QMutexLocker>
 
 KisFilter::KisFilter(const KoID& _id, const KoID & category, const QString & entry)
     : KisBaseProcessor(_id, category, entry),
@@ -43,12 +50,34 @@ void KisFilter::process(const KisPaintDeviceSP src,
                         KisSelectionSP selection,
                         const QRect& applyRect,
                         const KisFilterConfigurationSP config,
-                        KoUpdater* progressUpdater ) const
+                        KoUpdater* progressUpdater,
+                        KisRunnableStrokeJobsInterface *jobsInterface) const
 {
     KIS_SAFE_ASSERT_RECOVER_NOOP(config->hasLocalResourcesSnapshot());
 
     if (applyRect.isEmpty()) return;
-    QRect needRect = neededRect(applyRect, config, src->defaultBounds()->currentLevelOfDetail());
+
+    const int lod = src->defaultBounds()->currentLevelOfDetail();
+    const bool useBlockedProcessing = jobsInterface && supportsBlockedProcessing(config, lod);
+
+    if (jobsInterface && supportsThreading() && !useBlockedProcessing) {
+        /**
+         * The chunks are aligned to the tiles, so that the jobs never
+         * write into the same tile of the destination device
+         */
+        QSize patchSize = KritaUtils::optimalPatchSize();
+        patchSize.rwidth() = qMax(64, (patchSize.width() + 63) & ~63);
+        patchSize.rheight() = qMax(64, (patchSize.height() + 63) & ~63);
+
+        const QVector<QRect> chunks = KritaUtils::splitRectIntoPatches(applyRect, patchSize);
+
+        if (chunks.size() > 1) {
+            processConcurrently(src, dst, selection, chunks, config, progressUpdater, jobsInterface);
+            return;
+        }
+    }
+
+    QRect needRect = neededRect(applyRect, config, lod);
 
     KisPaintDeviceSP temporary;
     KisTransaction *transaction = 0;
@@ -75,7 +104,13 @@ void KisFilter::process(const KisPaintDeviceSP src,
             progressUpdater = updaterHolder->updater();
         }
 
-        processImpl(temporary, applyRect, config, progressUpdater);
+        if (useBlockedProcessing) {
+            // processImplBlocked() needs a synchronous interface
+            KisThreadPoolRunnableStrokeJobsExecutor executor;
+            processImplBlocked(temporary, applyRect, config, progressUpdater, &executor);
+        } else {
+            processImpl(temporary, applyRect, config, progressUpdater);
+        }
     }
     catch (const std::bad_alloc&) {
         warnKrita << "Filter" << name() << "failed to allocate enough memory to run.";
@@ -88,6 +123,86 @@ void KisFilter::process(const KisPaintDeviceSP src,
     }
 }
 
+namespace {
+struct ConcurrentProcessingState {
+    KisPaintDeviceSP source;
+    KoUpdater *progressUpdater = 0;
+    KoDummyUpdaterHolder chunkUpdaterHolder;
+    int totalChunks = 0;
+    int processedChunks = 0;
+    QMutex progressMutex;
+};
+}
+
+void KisFilter::processConcurrently(const KisPaintDeviceSP src,
+                                    KisPaintDeviceSP dst,
+                                    KisSelectionSP selection,
+                                    const QVector<QRect> &chunks,
+                                    const KisFilterConfigurationSP config,
+                                    KoUpdater *progressUpdater,
+                                    KisRunnableStrokeJobsInterface *jobsInterface) const
+{
+    QSharedPointer<ConcurrentProcessingState> state(new ConcurrentProcessingState());
+
+    /**
+     * When filtering in place, the halo of a chunk may overlap the
+     * chunks already written by the other jobs, so all the jobs read
+     * from a copy-on-write snapshot of the source device.
+     */
+    state->source = src == dst ? new KisPaintDevice(*src) : src;
+    state->progressUpdater = progressUpdater;
+    state->totalChunks = chunks.size();
+
+    const int lod = src->defaultBounds()->currentLevelOfDetail();
+
+    QVector<KisRunnableStrokeJobData*> jobs;
+
+    Q_FOREACH (const QRect &chunk, chunks) {
+        KritaUtils::addJobConcurrent(jobs, [this, state, dst, selection, chunk, config, lod] () {
+            if (state->progressUpdater && state->progressUpdater->interrupted()) return;
+
+            KisPaintDeviceSP temporary =
+                dst->createCompositionSourceDevice(state->source, neededRect(chunk, config, lod));
+
+            try {
+                // the progress is reported per chunk, not from inside processImpl()
+                KisTransaction transaction(temporary);
+                processImpl(temporary, chunk, config, state->chunkUpdaterHolder.updater());
+            }
+            catch (const std::bad_alloc&) {
+                warnKrita << "Filter" << name() << "failed to allocate enough memory to run.";
+            }
+
+            KisPainter::copyAreaOptimized(chunk.topLeft(), temporary, dst, chunk, selection);
+
+            if (state->progressUpdater) {
+                QMutexLocker l(&state->progressMutex);
+                state->processedChunks++;
+                state->progressUpdater->setProgress(100 * state->processedChunks / state->totalChunks);
+            }
+        });
+    }
+
+    jobsInterface->addRunnableJobs(jobs);
+}
+
+bool KisFilter::supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const
+{
+    Q_UNUSED(config);
+    Q_UNUSED(lod);
+    return false;
+}
+
+void KisFilter::processImplBlocked(KisPaintDeviceSP device,
+                                   const QRect &applyRect,
+                                   const KisFilterConfigurationSP config,
+                                   KoUpdater *progressUpdater,
+                                   KisRunnableStrokeJobsInterface *jobsInterface) const
+{
+    Q_UNUSED(jobsInterface);
+    processImpl(device, applyRect, config, progressUpdater);
+}
+
 QRect KisFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP c, int lod) const
 {
     Q_UNUSED(c);
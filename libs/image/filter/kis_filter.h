@@ -9,6 +9,7 @@
 #include <list>
 
 #include <QString>
+#include <QVector>
 
 #include <klocalizedstring.h>
 
@@ -20,6 +21,8 @@
 
 #include "kritaimage_export.h"
 
+class KisRunnableStrokeJobsInterface;
+
 /**
  * Basic interface of a Krita filter.
  */
@@ -50,6 +53,32 @@ public:
                              const KisFilterConfigurationSP config,
                              KoUpdater* progressUpdater = 0 ) const = 0;
 
+    /**
+     * Some filters split big areas into blocks by themselves, e.g. the
+     * ones based on the FFT convolution. Splitting the area into chunks
+     * in the caller would add the margins of the kernel to every chunk,
+     * so for the configurations, where this function returns true, the
+     * callers pass the whole area to processImplBlocked() instead.
+     */
+    virtual bool supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const;
+
+    /**
+     * Same as processImpl(), but the filter may process the blocks of
+     * \p applyRect in concurrent jobs of \p jobsInterface.
+     *
+     * The filters usually need the result of one pass to start the next
+     * one, so the interface must be synchronous, i.e. all its jobs must
+     * be done when addRunnableJobs() returns, like in
+     * KisThreadPoolRunnableStrokeJobsExecutor.
+     *
+     * The default implementation just calls processImpl().
+     */
+    virtual void processImplBlocked(KisPaintDeviceSP device,
+                                    const QRect& applyRect,
+                                    const KisFilterConfigurationSP config,
+                                    KoUpdater* progressUpdater,
+                                    KisRunnableStrokeJobsInterface *jobsInterface) const;
+
     /**
      * Filter \p src device and write the result into \p dst device.
      * If \p dst is an alpha color space device, it will get special
@@ -61,13 +90,25 @@ public:
      * @param applyRect the rectangle where the filter is applied
      * @param config the parameters of the filter
      * @param progressUpdater to pass on the progress the filter is making
+     * @param jobsInterface if not null and the filter supportsThreading(),
+     *        \p applyRect is split into tile-aligned chunks, which are
+     *        filtered in concurrent jobs of this interface. Every chunk
+     *        reads its own neededRect() from a snapshot of \p src, so
+     *        the result is the same as of the sequential processing.
+     *        If the interface executes the jobs asynchronously, the
+     *        result is available only after the jobs are done, so the
+     *        caller should add a barrier. If the filter
+     *        supportsBlockedProcessing(), the area is not split, but
+     *        passed to processImplBlocked() with the blocks processed
+     *        on the global thread pool.
      */
     void process(const KisPaintDeviceSP src,
                  KisPaintDeviceSP dst,
                  KisSelectionSP selection,
                  const QRect& applyRect,
                  const KisFilterConfigurationSP config,
-                 KoUpdater* progressUpdater = 0 ) const;
+                 KoUpdater* progressUpdater = 0,
+                 KisRunnableStrokeJobsInterface *jobsInterface = 0) const;
 
 
     /**
@@ -109,6 +150,15 @@ protected:
     void setSupportsLevelOfDetail(bool value);
 
 
+private:
+    void processConcurrently(const KisPaintDeviceSP src,
+                             KisPaintDeviceSP dst,
+                             KisSelectionSP selection,
+                             const QVector<QRect> &chunks,
+                             const KisFilterConfigurationSP config,
+                             KoUpdater* progressUpdater,
+                             KisRunnableStrokeJobsInterface *jobsInterface) const;
+
 private:
     bool m_supportsLevelOfDetail;
 };
@@ -27,6 +27,7 @@
 #include "kis_clone_layer.h"
 #include "kis_processing_information.h"
 #include "kis_busy_progress_indicator.h"
+#include "KisThreadPoolRunnableStrokeJobsExecutor.h"
 
 
 #include "kis_merge_walker.h"
@@ -110,8 +111,15 @@ public:
             KIS_ASSERT_RECOVER_NOOP(layer->busyProgressIndicator());
             layer->busyProgressIndicator()->update();
 
+            // the filters, which split the area into blocks themselves,
+            // process the blocks on the global thread pool
+            KisThreadPoolRunnableStrokeJobsExecutor executor;
+            const int lod = m_projection->defaultBounds()->currentLevelOfDetail();
+            KisRunnableStrokeJobsInterface *jobsInterface =
+                filter->supportsBlockedProcessing(filterConfig.data(), lod) ? &executor : 0;
+
             // We do not create a transaction here, as srcDevice != dstDevice
-            filter->process(m_projection, dstDevice, 0, filterRect, filterConfig.data(), 0);
+            filter->process(m_projection, dstDevice, 0, filterRect, filterConfig.data(), 0, jobsInterface);
         }
 
         if (selection) {
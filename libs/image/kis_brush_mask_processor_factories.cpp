@@ -76,6 +76,11 @@ void FastRowProcessor<KisCircleMaskGenerator>::process<xsimd::current_arch>(floa
         float_v xr = x_ * vCosa - vSinaY_;
         float_v yr = x_ * vSina + vCosaY_;
 
+        if (spikes > 2) {
+            yr = xsimd::abs(yr);
+            fixRotation(xr, yr, spikes);
+        }
+
         const float_v n = xsimd::pow2(xr * vXCoeff) + xsimd::pow2(yr * vYCoeff);
         const float_m outsideMask = n > vOne;
 
@@ -151,8 +156,13 @@ void FastRowProcessor<KisGaussCircleMaskGenerator>::process<xsimd::current_arch>
     for (size_t i = 0; i < static_cast<size_t>(width); i += float_v::size) {
         const float_v x_ = currentIndices - vCenterX;
 
-        const float_v xr = x_ * vCosa - vSinaY_;
-        const float_v yr = x_ * vSina + vCosaY_;
+        float_v xr = x_ * vCosa - vSinaY_;
+        float_v yr = x_ * vSina + vCosaY_;
+
+        if (spikes > 2) {
+            yr = xsimd::abs(yr);
+            fixRotation(xr, yr, spikes);
+        }
 
         float_v dist =
             xsimd::sqrt(xsimd::pow2(xr) + xsimd::pow2(yr * vYCoeff));
@@ -234,8 +244,13 @@ void FastRowProcessor<KisCurveCircleMaskGenerator>::process<xsimd::current_arch>
     for (size_t i = 0; i < static_cast<size_t>(width); i += float_v::size) {
         const float_v x_ = currentIndices - vCenterX;
 
-        const float_v xr = x_ * vCosa - vSinaY_;
-        const float_v yr = x_ * vSina + vCosaY_;
+        float_v xr = x_ * vCosa - vSinaY_;
+        float_v yr = x_ * vSina + vCosaY_;
+
+        if (spikes > 2) {
+            yr = xsimd::abs(yr);
+            fixRotation(xr, yr, spikes);
+        }
 
         float_v dist = xsimd::pow2(xr * vXCoeff) + xsimd::pow2(yr * vYCoeff);
 
@@ -328,6 +343,13 @@ void FastRowProcessor<KisRectangleMaskGenerator>::process<xsimd::current_arch>(f
         float_v xr = xsimd::abs(x_ * vCosa - vSinaY_);
         float_v yr = xsimd::abs(x_ * vSina + vCosaY_);
 
+        if (spikes > 2) {
+            fixRotation(xr, yr, spikes);
+
+            xr = xsimd::abs(xr);
+            yr = xsimd::abs(yr);
+        }
+
         const float_v nxr = xr * vXCoeff;
         const float_v nyr = yr * vYCoeff;
 
@@ -413,6 +435,10 @@ void FastRowProcessor<KisGaussRectangleMaskGenerator>::process<xsimd::current_ar
         float_v xr = x_ * vCosa - vSinaY_;
         float_v yr = xsimd::abs(x_ * vSina + vCosaY_);
 
+        if (spikes > 2) {
+            fixRotation(xr, yr, spikes);
+        }
+
         // check if we need to apply fader on values
         float_m excludeMask = d->fadeMaker.needFade(xr, yr);
 
@@ -492,6 +518,10 @@ void FastRowProcessor<KisCurveRectangleMaskGenerator>::process<xsimd::current_ar
         float_v xr = x_ * vCosa - vSinaY_;
         float_v yr = xsimd::abs(x_ * vSina + vCosaY_);
 
+        if (spikes > 2) {
+            fixRotation(xr, yr, spikes);
+        }
+
         // check if we need to apply fader on values
         float_m excludeMask = d->fadeMaker.needFade(xr, yr);
         const float_v vValue = xsimd::set_one(float_v(0), excludeMask);
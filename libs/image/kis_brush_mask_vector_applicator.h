@@ -13,19 +13,47 @@
 
 #if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) && XSIMD_UNIVERSAL_BUILD_PASS
 
+#include <algorithm>
+
 #include "kis_brush_mask_scalar_applicator.h"
 
 template<class V>
 struct FastRowProcessor {
     FastRowProcessor(V *maskGenerator)
         : d(maskGenerator->d.data())
+        , spikes(maskGenerator->spikes())
     {
     }
 
     template<typename _impl>
     void process(float *buffer, int width, float y, float cosa, float sina, float centerX, float centerY);
 
+    /**
+     * The vector version of KisMaskGenerator::fixRotation(): rotates
+     * the points of all the spikes onto the first one
+     */
+    template<typename _impl>
+    static inline void fixRotation(xsimd::batch<float, _impl> &xr, xsimd::batch<float, _impl> &yr, int spikes)
+    {
+        using float_v = xsimd::batch<float, _impl>;
+
+        const float spikesAngle = static_cast<float>(M_PI) / spikes;
+
+        const float_v angle = xsimd::atan2(yr, xr);
+        const float_v numRotations =
+            xsimd::max(float_v(0), xsimd::ceil((angle - float_v(spikesAngle)) / float_v(2 * spikesAngle)));
+
+        const auto sincos = xsimd::sincos(numRotations * float_v(-2 * spikesAngle));
+
+        const float_v sx = xr;
+        const float_v sy = yr;
+
+        xr = sincos.second * sx - sincos.first * sy;
+        yr = sincos.first * sx + sincos.second * sy;
+    }
+
     typename V::Private *d;
+    int spikes;
 };
 
 template<class MaskGenerator, typename _impl>
@@ -95,8 +123,39 @@ void KisBrushMaskVectorApplicator<MaskGenerator, impl>::processVector(const QRec
 
     FastRowProcessor<MaskGenerator> processor(m_maskGenerator);
 
+    int supersample = 1;
+    if (m_maskGenerator->shouldSupersample()) {
+        // strengthen supersampling from 3x3 for very small dabs, to smooth out dashed strokes
+        supersample = (m_maskGenerator->shouldSupersample6x6() ? 6 : 3);
+    }
+
+    const float invss = 1.0f / supersample;
+    const float_v vSampleWeight(invss * invss);
+
+    float *sampleBuffer = supersample != 1 ? xsimd::vector_aligned_malloc<float>(simdWidth) : nullptr;
+
     for (int y = rect.y(); y < rect.y() + rect.height(); y++) {
-        processor.template process<impl>(buffer, simdWidth, y, m_d->cosa, m_d->sina, m_d->centerX, m_d->centerY);
+        if (supersample == 1) {
+            processor.template process<impl>(buffer, simdWidth, y, m_d->cosa, m_d->sina, m_d->centerX, m_d->centerY);
+        } else {
+            // the samples are shifted the same way the scalar applicator does
+            std::fill(buffer, buffer + simdWidth, 0.0f);
+
+            for (int sy = 0; sy < supersample; sy++) {
+                for (int sx = 0; sx < supersample; sx++) {
+                    processor.template process<impl>(sampleBuffer, simdWidth,
+                                                     y + sy * invss,
+                                                     m_d->cosa, m_d->sina,
+                                                     m_d->centerX - sx * invss, m_d->centerY);
+
+                    for (size_t i = 0; i < simdWidth; i += float_v::size) {
+                        const float_v sample = float_v::load_aligned(sampleBuffer + i);
+                        const float_v sum = float_v::load_aligned(buffer + i);
+                        xsimd::fma(sample, vSampleWeight, sum).store_aligned(buffer + i);
+                    }
+                }
+            }
+        }
 
         if (m_d->randomness != 0.0 || m_d->density != 1.0) {
             for (int x = 0; x < width; x++) {
@@ -136,6 +195,10 @@ void KisBrushMaskVectorApplicator<MaskGenerator, impl>::processVector(const QRec
         dabPointer += offset;
     } // endfor y
     xsimd::vector_aligned_free(buffer);
+
+    if (sampleBuffer) {
+        xsimd::vector_aligned_free(sampleBuffer);
+    }
 }
 
 #endif /* defined HAVE_XSIMD */
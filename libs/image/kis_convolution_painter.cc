@@ -52,13 +52,10 @@ bool KisConvolutionPainter::useFFTImplementation(const KisConvolutionKernelSP ke
     bool result = false;
 
 #ifdef HAVE_FFTW3
-    #define THRESHOLD_SIZE 5
-
     result =
         m_enginePreference == FFTW ||
         (m_enginePreference == NONE &&
-         (kernel->width() > THRESHOLD_SIZE ||
-          kernel->height() > THRESHOLD_SIZE));
+         prefersFFT(kernel->width(), kernel->height()));
 #else
     Q_UNUSED(kernel);
 #endif
@@ -66,6 +63,19 @@ bool KisConvolutionPainter::useFFTImplementation(const KisConvolutionKernelSP ke
     return result;
 }
 
+bool KisConvolutionPainter::prefersFFT(int kernelWidth, int kernelHeight)
+{
+#ifdef HAVE_FFTW3
+    #define THRESHOLD_SIZE 5
+
+    return kernelWidth > THRESHOLD_SIZE || kernelHeight > THRESHOLD_SIZE;
+#else
+    Q_UNUSED(kernelWidth);
+    Q_UNUSED(kernelHeight);
+    return false;
+#endif
+}
+
 template<class factory>
 KisConvolutionWorker<factory>* KisConvolutionPainter::createWorker(const KisConvolutionKernelSP kernel,
                                                                    KisPainter *painter,
@@ -67,6 +67,12 @@ public:
      *
      * If you want to convolve a subset of the channels in a pixel,
      * set those channels with KisPainter::setChannelFlags();
+     *
+     * The FFT engine splits big areas into blocks and processes them
+     * as concurrent jobs of KisPainter::runnableStrokeJobsInterface().
+     * If an asynchronous interface is set, the result is available
+     * only after the jobs are done, so the caller should add a barrier.
+     * KisThreadPoolRunnableStrokeJobsExecutor is synchronous.
      */
     void applyMatrix(const KisConvolutionKernelSP kernel, const KisPaintDeviceSP src, QPoint srcPos, QPoint dstPos, QSize areaSize,
                      KisConvolutionBorderOp borderOp = BORDER_REPEAT);
@@ -80,6 +86,14 @@ public:
 
     static bool supportsFFTW();
 
+    /**
+     * Returns true if a painter with the default engine preference
+     * convolves with a kernel of the given size using the FFT engine,
+     * i.e. the convolution may be run as concurrent blocks of
+     * KisPainter::runnableStrokeJobsInterface()
+     */
+    static bool prefersFFT(int kernelWidth, int kernelHeight);
+
 protected:
     friend class KisConvolutionPainterTest;
 
@@ -13,27 +13,297 @@
 #include <KoChannelInfo.h>
 
 #include "kis_convolution_worker.h"
+#include "kis_convolution_kernel.h"
 #include "kis_math_toolbox.h"
 
+#include "config_convolution.h"
+
 #include <QMutex>
+#include <QMutexLocker>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QSize>
 #include <QVector>
-#include <QTextStream>
-#include <QFile>
-#include <QDir>
+
+#include <KoUpdater.h>
+
+#include "KisRunnableStrokeJobUtils.h"
+#include "KisRunnableStrokeJobsInterface.h"
+#include "KisFakeRunnableStrokeJobsExecutor.h"
+#include "KisThreadPoolRunnableStrokeJobsExecutor.h"
 
 #include <fftw3.h>
 
 template<class _IteratorFactory_> class KisConvolutionWorkerFFT;
+template<typename T> class KisFFTWPlanCache;
 class KisConvolutionWorkerFFTLock
 {
 private:
     static QMutex fftwMutex;
     template<class _IteratorFactory_> friend class KisConvolutionWorkerFFT;
+    template<typename T> friend class KisFFTWPlanCache;
 };
 
 QMutex KisConvolutionWorkerFFTLock::fftwMutex;
 
 
+/**
+ * Wraps the FFTW functions of the given precision
+ */
+template<typename T>
+struct KisFFTWTraits;
+
+template<>
+struct KisFFTWTraits<double>
+{
+    typedef fftw_complex complex_type;
+    typedef fftw_plan plan_type;
+
+    static plan_type planForward(int height, int width, complex_type *data) {
+        return fftw_plan_dft_r2c_2d(height, width, (double*)data, data, FFTW_ESTIMATE);
+    }
+
+    static plan_type planBackward(int height, int width, complex_type *data) {
+        return fftw_plan_dft_c2r_2d(height, width, data, (double*)data, FFTW_ESTIMATE);
+    }
+
+    static void executeForward(plan_type plan, complex_type *data) {
+        fftw_execute_dft_r2c(plan, (double*)data, data);
+    }
+
+    static void executeBackward(plan_type plan, complex_type *data) {
+        fftw_execute_dft_c2r(plan, data, (double*)data);
+    }
+
+    static void destroyPlan(plan_type plan) {
+        fftw_destroy_plan(plan);
+    }
+
+    static complex_type* allocate(int length) {
+        return (complex_type*)fftw_malloc(sizeof(complex_type) * length);
+    }
+
+    static void deallocate(complex_type *data) {
+        fftw_free(data);
+    }
+};
+
+#ifdef HAVE_FFTW3F
+
+template<>
+struct KisFFTWTraits<float>
+{
+    typedef fftwf_complex complex_type;
+    typedef fftwf_plan plan_type;
+
+    static plan_type planForward(int height, int width, complex_type *data) {
+        return fftwf_plan_dft_r2c_2d(height, width, (float*)data, data, FFTW_ESTIMATE);
+    }
+
+    static plan_type planBackward(int height, int width, complex_type *data) {
+        return fftwf_plan_dft_c2r_2d(height, width, data, (float*)data, FFTW_ESTIMATE);
+    }
+
+    static void executeForward(plan_type plan, complex_type *data) {
+        fftwf_execute_dft_r2c(plan, (float*)data, data);
+    }
+
+    static void executeBackward(plan_type plan, complex_type *data) {
+        fftwf_execute_dft_c2r(plan, data, (float*)data);
+    }
+
+    static void destroyPlan(plan_type plan) {
+        fftwf_destroy_plan(plan);
+    }
+
+    static complex_type* allocate(int length) {
+        return (complex_type*)fftwf_malloc(sizeof(complex_type) * length);
+    }
+
+    static void deallocate(complex_type *data) {
+        fftwf_free(data);
+    }
+};
+
+#endif /* HAVE_FFTW3F */
+
+
+/**
+ * A cache of in-place FFTW plans, keyed by the size of the transform.
+ *
+ * The FFTW planner is not thread-safe, so the plans are created under
+ * the global lock, but the execution of a plan on new arrays is, so
+ * the cached plans can be used by several workers at the same time.
+ * The convolution blocks have only a few distinct sizes, so the plans
+ * are reused most of the time.
+ */
+template<typename T>
+class KisFFTWPlanCache
+{
+public:
+    typedef KisFFTWTraits<T> Traits;
+
+    struct Plans {
+        typename Traits::plan_type forward;
+        typename Traits::plan_type backward;
+
+        ~Plans() {
+            QMutexLocker locker(&KisConvolutionWorkerFFTLock::fftwMutex);
+            Traits::destroyPlan(forward);
+            Traits::destroyPlan(backward);
+        }
+    };
+
+    typedef QSharedPointer<const Plans> PlansSP;
+
+    static KisFFTWPlanCache* instance() {
+        static KisFFTWPlanCache cache;
+        return &cache;
+    }
+
+    PlansSP plans(int width, int height) {
+        const QSize size(width, height);
+
+        // the evicted plans should be destroyed after the cache is unlocked
+        PlansSP evictedPlans;
+        QMutexLocker locker(&m_mutex);
+
+        for (int i = 0; i < m_plans.size(); i++) {
+            if (m_plans[i].first == size) {
+                m_plans.move(i, 0);
+                return m_plans.first().second;
+            }
+        }
+
+        QSharedPointer<Plans> plans(new Plans());
+
+        {
+            QMutexLocker planLocker(&KisConvolutionWorkerFFTLock::fftwMutex);
+
+            // the plans are created for the same alignment the workers use
+            const int length = height * (width / 2 + 1);
+            typename Traits::complex_type *data = Traits::allocate(length);
+            plans->forward = Traits::planForward(height, width, data);
+            plans->backward = Traits::planBackward(height, width, data);
+            Traits::deallocate(data);
+        }
+
+        m_plans.prepend(qMakePair(size, PlansSP(plans)));
+
+        if (m_plans.size() > maxCachedPlans) {
+            evictedPlans = m_plans.takeLast().second;
+        }
+
+        return plans;
+    }
+
+private:
+    static const int maxCachedPlans = 8;
+
+    QMutex m_mutex;
+    QList<QPair<QSize, PlansSP>> m_plans; // the most recently used go first
+};
+
+
+/**
+ * A cache of the spectra of the convolution kernels, keyed by the
+ * coefficients of the kernel and the size of the transform.
+ *
+ * The filters, which are applied to the image in chunks (or are
+ * updated incrementally), convolve every chunk with the same kernel
+ * and the blocks of the same size, so the spectrum of the kernel is
+ * calculated only once. The spectra are big, so only a few of them
+ * are kept.
+ */
+template<typename T>
+class KisFFTWKernelSpectrumCache
+{
+public:
+    typedef KisFFTWTraits<T> Traits;
+    typedef typename Traits::complex_type complex_type;
+    typedef Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> KernelMatrix;
+
+    struct Spectrum {
+        Spectrum(int length)
+            : data(Traits::allocate(length))
+        {
+            memset(data, 0, sizeof(complex_type) * length);
+        }
+
+        ~Spectrum() {
+            Traits::deallocate(data);
+        }
+
+        complex_type *data;
+    };
+
+    typedef QSharedPointer<const Spectrum> SpectrumSP;
+
+    static KisFFTWKernelSpectrumCache* instance() {
+        static KisFFTWKernelSpectrumCache cache;
+        return &cache;
+    }
+
+    /**
+     * Returns the cached spectrum of \p kernel or calculates it with
+     * \p calculate, which should fill the passed (zeroed) array
+     */
+    template<typename Func>
+    SpectrumSP spectrum(const KisConvolutionKernelSP kernel, int fftWidth, int fftHeight,
+                        int fftLength, Func calculate) {
+
+        const QSize size(fftWidth, fftHeight);
+        const KernelMatrix &coefficients = *kernel->data();
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            for (int i = 0; i < m_spectra.size(); i++) {
+                const Entry &entry = m_spectra[i];
+
+                if (entry.fftSize == size &&
+                    entry.coefficients.rows() == coefficients.rows() &&
+                    entry.coefficients.cols() == coefficients.cols() &&
+                    entry.coefficients == coefficients) {
+
+                    m_spectra.move(i, 0);
+                    return m_spectra.first().spectrum;
+                }
+            }
+        }
+
+        // the spectrum is calculated without the lock, two threads may do it at once
+        QSharedPointer<Spectrum> spectrum(new Spectrum(fftLength));
+        calculate(spectrum->data);
+
+        // the evicted spectrum should be destroyed after the cache is unlocked
+        Entry evictedEntry;
+        QMutexLocker locker(&m_mutex);
+
+        m_spectra.prepend(Entry{size, coefficients, spectrum});
+
+        if (m_spectra.size() > maxCachedSpectra) {
+            evictedEntry = m_spectra.takeLast();
+        }
+
+        return spectrum;
+    }
+
+private:
+    static const int maxCachedSpectra = 4;
+
+    struct Entry {
+        QSize fftSize;
+        KernelMatrix coefficients;
+        SpectrumSP spectrum;
+    };
+
+    QMutex m_mutex;
+    QList<Entry> m_spectra; // the most recently used go first
+};
+
+
 template<class _IteratorFactory_>
 class KisConvolutionWorkerFFT : public KisConvolutionWorker<_IteratorFactory_>
 {
@@ -47,6 +317,21 @@ public:
     {
     }
 
+    /**
+     * The area is split into blocks, which are convolved independently
+     * using the overlap-save method: the block is read together with a
+     * margin of the half of the kernel size and only its central part is
+     * written back. It keeps the memory consumption bounded for huge
+     * images. The blocks are aligned to the tiles of the device, so they
+     * are processed as concurrent jobs of the painter's runnable jobs
+     * interface.
+     *
+     * When the painter has an asynchronous runnable jobs interface, the
+     * jobs are only queued: the caller should wait for them with a
+     * barrier before accessing the result and the progress is not
+     * reported. KisThreadPoolRunnableStrokeJobsExecutor runs the blocks
+     * concurrently and finishes them before execute() returns.
+     */
     void execute(const KisConvolutionKernelSP kernel,
                  const KisPaintDeviceSP src,
                  QPoint srcPos,
@@ -66,95 +351,22 @@ public:
         if (areaSize.width() == 0 || areaSize.height() == 0)
             return;
 
-        addToProgress(0);
-        if (isInterrupted()) return;
-
-        const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
-        const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
-
-        m_fftWidth = areaSize.width() + 4 * halfKernelWidth;
-        m_fftHeight = areaSize.height() + 2 * halfKernelHeight;
-
-        /**
-         * FIXME: check whether this "optimization" is needed to
-         * be uncommented. My tests showed about 30% better performance
-         * when the line is commented out (DK).
-         */
-        //optimumDimensions(m_fftWidth, m_fftHeight);
-
-        m_fftLength = m_fftHeight * (m_fftWidth / 2 + 1);
-        m_extraMem = (m_fftWidth % 2) ? 1 : 2;
-
-        // create and fill kernel
-        m_kernelFFT = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
-        memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
-        fftFillKernelMatrix(kernel, m_kernelFFT);
+        if (this->m_progress) {
+            this->m_progress->setProgress(0);
+            if (this->m_progress->interrupted()) return;
+        }
 
         // find out which channels need convolving
         QList<KoChannelInfo*> convChannelList = this->convolvableChannelList(src);
 
-        m_channelFFT.resize(convChannelList.count());
-        for (auto i = m_channelFFT.begin(); i != m_channelFFT.end(); ++i) {
-            *i = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
-        }
-
-        const double kernelFactor = kernel->factor() ? kernel->factor() : 1;
-        const double fftScale = 1.0 / (m_fftHeight * m_fftWidth) / kernelFactor;
-
-        FFTInfo info (fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
-        int cacheRowStride = m_fftWidth + m_extraMem;
-
-        fillCacheFromDevice(src,
-                            QRect(srcPos.x() - halfKernelWidth,
-                                  srcPos.y() - halfKernelHeight,
-                                  m_fftWidth,
-                                  m_fftHeight),
-                            cacheRowStride,
-                            info, dataRect);
-
-        addToProgress(10);
-        if (isInterrupted()) return;
-
-        // calculate number off fft operations required for progress reporting
-        const float progressPerFFT = (100 - 30) / (double)(convChannelList.count() * 2 + 1);
-
-        // perform FFT
-        fftw_plan fftwPlanForward, fftwPlanBackward;
-
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftwPlanForward = fftw_plan_dft_r2c_2d(m_fftHeight, m_fftWidth, (double*)m_kernelFFT, m_kernelFFT, FFTW_ESTIMATE);
-        fftwPlanBackward = fftw_plan_dft_c2r_2d(m_fftHeight, m_fftWidth, m_kernelFFT, (double*)m_kernelFFT, FFTW_ESTIMATE);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
-
-        fftw_execute(fftwPlanForward);
-        addToProgress(progressPerFFT);
-        if (isInterrupted()) return;
-
-        for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k)
-        {
-            fftw_execute_dft_r2c(fftwPlanForward, (double*)(*k), *k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-
-            fftMultiply(*k, m_kernelFFT);
-
-            fftw_execute_dft_c2r(fftwPlanBackward, *k, (double*)*k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
+#ifdef HAVE_FFTW3F
+        if (canUseSinglePrecision(convChannelList)) {
+            executeImpl<float>(kernel, src, srcPos, dstPos, areaSize, dataRect, convChannelList);
+            return;
         }
+#endif
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftw_destroy_plan(fftwPlanForward);
-        fftw_destroy_plan(fftwPlanBackward);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
-
-
-        writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
-                            cacheRowStride, halfKernelWidth, halfKernelHeight,
-                            info, dataRect);
-
-        addToProgress(20);
-        cleanUp();
+        executeImpl<double>(kernel, src, srcPos, dstPos, areaSize, dataRect, convChannelList);
     }
 
     struct FFTInfo {
@@ -209,34 +421,270 @@ public:
         int alphaRealPos {-1};
     };
 
-    void fillCacheFromDevice(KisPaintDeviceSP src,
-                             const QRect &rect,
-                             const int cacheRowStride,
-                             const FFTInfo &info,
-                             const QRect &dataRect) {
+    /**
+     * The data shared by the jobs of all the blocks of one convolution
+     */
+    template<typename T>
+    struct BlockSharedState {
+        typedef KisFFTWTraits<T> Traits;
+        typedef typename Traits::complex_type complex_type;
+
+        BlockSharedState(const FFTInfo &_info)
+            : info(_info)
+        {
+        }
+
+        KisPaintDeviceSP src;
+        KisPaintDeviceSP dst;
+        QRect dataRect;
+        QPoint srcOffset;
+
+        quint32 fftWidth {0};
+        quint32 fftHeight {0};
+        quint32 fftLength {0};
+        quint32 cacheRowStride {0};
+        quint32 halfKernelWidth {0};
+        quint32 halfKernelHeight {0};
+
+        FFTInfo info;
+        typename KisFFTWPlanCache<T>::PlansSP plans;
+        typename KisFFTWKernelSpectrumCache<T>::SpectrumSP kernelSpectrum;
+
+        KoUpdater *progress {0};
+        QMutex progressMutex;
+        int numBlocks {0};
+        int numProcessedBlocks {0};
+    };
+
+private:
+    static bool canUseSinglePrecision(const QList<KoChannelInfo*> &convChannelList)
+    {
+        /**
+         * The rounding error of the single precision transform is
+         * much smaller than one level of a 16-bit channel, but it is
+         * visible in the floating point color spaces.
+         */
+        Q_FOREACH (KoChannelInfo *channel, convChannelList) {
+            if (channel->channelValueType() != KoChannelInfo::UINT8 &&
+                channel->channelValueType() != KoChannelInfo::UINT16) {
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * The output part of the block is much bigger than the margin
+     * and is a multiple of the tile size, so the blocks never
+     * share the tiles of the destination device.
+     */
+    static int blockSize(int halfKernelSize)
+    {
+        const int tileSize = 64;
+        const int size = qMax(256, 8 * halfKernelSize);
+        return (size + tileSize - 1) / tileSize * tileSize;
+    }
+
+    static QVector<QRect> splitIntoBlocks(const QRect &rect, int blockWidth, int blockHeight)
+    {
+        QVector<QRect> blocks;
+
+        auto blockStart = [] (int pos, int size) {
+            return pos >= 0 ? pos / size * size : -((-pos + size - 1) / size * size);
+        };
+
+        for (int y = blockStart(rect.top(), blockHeight); y <= rect.bottom(); y += blockHeight) {
+            for (int x = blockStart(rect.left(), blockWidth); x <= rect.right(); x += blockWidth) {
+                blocks.append(QRect(x, y, blockWidth, blockHeight) & rect);
+            }
+        }
+
+        return blocks;
+    }
+
+    template<typename T>
+    void executeImpl(const KisConvolutionKernelSP kernel,
+                     const KisPaintDeviceSP src,
+                     QPoint srcPos,
+                     QPoint dstPos,
+                     QSize areaSize,
+                     const QRect &dataRect,
+                     const QList<KoChannelInfo*> &convChannelList)
+    {
+        typedef KisFFTWTraits<T> Traits;
+        typedef BlockSharedState<T> State;
+
+        const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
+        const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
+
+        const QRect dstRect(dstPos, areaSize);
+
+        int blockWidth = blockSize(halfKernelWidth);
+        int blockHeight = blockSize(halfKernelHeight);
+
+        QVector<QRect> blocks;
+
+        if (areaSize.width() <= blockWidth && areaSize.height() <= blockHeight) {
+            // a small area is convolved in one go, no need to align it
+            blockWidth = areaSize.width();
+            blockHeight = areaSize.height();
+            blocks << dstRect;
+        } else {
+            blocks = splitIntoBlocks(dstRect, blockWidth, blockHeight);
+        }
+
+        const double kernelFactor = kernel->factor() ? kernel->factor() : 1;
+
+        QSharedPointer<State> state(
+            new State(FFTInfo(1.0, convChannelList, kernel, this->m_painter->device()->colorSpace())));
+
+        state->src = src;
+        state->dst = this->m_painter->device();
+
+        if (blocks.size() > 1 && state->src == state->dst) {
+            /**
+             * The blocks are written while the neighbouring ones are
+             * still to be read, so the in-place convolution should
+             * read from a copy of the source area
+             */
+            QRect snapshotRect(srcPos - QPoint(halfKernelWidth, halfKernelHeight),
+                               areaSize + QSize(2 * halfKernelWidth, 2 * halfKernelHeight));
+
+            if (src->defaultBounds()->wrapAroundMode()) {
+                snapshotRect = src->defaultBounds()->bounds();
+            } else if (dataRect.isValid()) {
+                snapshotRect &= dataRect;
+            }
+
+            state->src = new KisPaintDevice(src->colorSpace());
+            state->src->prepareClone(src);
+            KisPainter::copyAreaOptimizedOldData(snapshotRect.topLeft(), src, state->src, snapshotRect);
+        }
+        state->dataRect = dataRect;
+        state->srcOffset = srcPos - dstPos;
+        state->halfKernelWidth = halfKernelWidth;
+        state->halfKernelHeight = halfKernelHeight;
+
+        state->fftWidth = blockWidth + 2 * halfKernelWidth;
+        state->fftHeight = blockHeight + 2 * halfKernelHeight;
+        state->fftLength = state->fftHeight * (state->fftWidth / 2 + 1);
+        state->cacheRowStride = 2 * (state->fftWidth / 2 + 1);
+        state->info.fftScale = 1.0 / (state->fftHeight * state->fftWidth) / kernelFactor;
+
+        state->plans = KisFFTWPlanCache<T>::instance()->plans(state->fftWidth, state->fftHeight);
+
+        state->kernelSpectrum =
+            KisFFTWKernelSpectrumCache<T>::instance()->spectrum(
+                kernel, state->fftWidth, state->fftHeight, state->fftLength,
+                [kernel, state] (typename Traits::complex_type *data) {
+                    fftFillKernelMatrix<T>(kernel, *state, (T*)data);
+                    Traits::executeForward(state->plans->forward, data);
+                });
+
+        KisRunnableStrokeJobsInterface *jobsInterface = this->m_painter->runnableStrokeJobsInterface();
+
+        // the synchronous executors finish the jobs before we return,
+        // so the updater is still alive while the jobs report progress
+        if (dynamic_cast<KisFakeRunnableStrokeJobsExecutor*>(jobsInterface) ||
+            dynamic_cast<KisThreadPoolRunnableStrokeJobsExecutor*>(jobsInterface)) {
+
+            state->progress = this->m_progress;
+        }
+        state->numBlocks = blocks.size();
+
+        QVector<KisRunnableStrokeJobData*> jobs;
+
+        Q_FOREACH (const QRect &block, blocks) {
+            KritaUtils::addJobConcurrent(jobs,
+                [state, block] () {
+                    processBlock<T>(*state, block);
+                });
+        }
+
+        jobsInterface->addRunnableJobs(jobs);
+    }
+
+    template<typename T>
+    static void processBlock(BlockSharedState<T> &state, const QRect &dstRect)
+    {
+        typedef KisFFTWTraits<T> Traits;
+
+        if (isInterrupted(state)) return;
+
+        const int channelCount = state.info.numChannels();
+        QVector<typename Traits::complex_type*> channelFFT(channelCount);
+
+        for (auto i = channelFFT.begin(); i != channelFFT.end(); ++i) {
+            *i = Traits::allocate(state.fftLength);
+        }
+
+        fillCacheFromDevice<T>(state,
+                               QRect(dstRect.x() + state.srcOffset.x() - state.halfKernelWidth,
+                                     dstRect.y() + state.srcOffset.y() - state.halfKernelHeight,
+                                     state.fftWidth,
+                                     state.fftHeight),
+                               channelFFT);
+
+        for (auto k = channelFFT.begin(); k != channelFFT.end(); ++k) {
+            Traits::executeForward(state.plans->forward, *k);
+            fftMultiply<T>(*k, state.kernelSpectrum->data, state.fftLength);
+            Traits::executeBackward(state.plans->backward, *k);
+        }
+
+        writeResultToDevice<T>(state, dstRect, channelFFT);
+
+        Q_FOREACH (typename Traits::complex_type *channel, channelFFT) {
+            Traits::deallocate(channel);
+        }
+
+        if (state.progress) {
+            QMutexLocker locker(&state.progressMutex);
+            state.numProcessedBlocks++;
+            state.progress->setProgress(100 * state.numProcessedBlocks / state.numBlocks);
+        }
+    }
+
+    template<typename T>
+    static bool isInterrupted(BlockSharedState<T> &state)
+    {
+        if (!state.progress) return false;
+
+        QMutexLocker locker(&state.progressMutex);
+        return state.progress->interrupted();
+    }
+
+    template<typename T>
+    static void fillCacheFromDevice(const BlockSharedState<T> &state,
+                                    const QRect &rect,
+                                    const QVector<typename KisFFTWTraits<T>::complex_type*> &channelFFT) {
+
+        const FFTInfo &info = state.info;
+        const int cacheRowStride = state.cacheRowStride;
 
         typename _IteratorFactory_::HLineConstIterator hitSrc =
-            _IteratorFactory_::createHLineConstIterator(src,
+            _IteratorFactory_::createHLineConstIterator(state.src,
                                                         rect.x(), rect.y(), rect.width(),
-                                                        dataRect);
+                                                        state.dataRect);
 
         const int channelCount = info.numChannels();
-        QVector<double*> channelPtr(channelCount);
+        QVector<T*> channelPtr(channelCount);
         const auto channelPtrBegin = channelPtr.begin();
         const auto channelPtrEnd = channelPtr.end();
 
-        auto iFFt = m_channelFFT.constBegin();
+        auto iFFt = channelFFT.constBegin();
         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
-            *i = (double*)*iFFt;
+            *i = (T*)*iFFt;
         }
 
         // prepare cache, reused in all loops
-        QVector<double*> cacheRowStart(channelCount);
+        QVector<T*> cacheRowStart(channelCount);
         const auto cacheRowStartBegin = cacheRowStart.begin();
 
         for (int y = 0; y < rect.height(); ++y) {
             // cache current channelPtr in cacheRowStart
-            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(double*));
+            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(T*));
 
             for (int x = 0; x < rect.width(); ++x) {
                 const quint8 *data = hitSrc->oldRawData();
@@ -269,7 +717,7 @@ public:
 
     }
 
-    inline void limitValue(qreal *value, qreal lowBound, qreal highBound) {
+    static inline void limitValue(qreal *value, qreal lowBound, qreal highBound) {
         if (*value > highBound) {
             *value = highBound;
         } else if (!(*value >= lowBound)) {  // value < lowBound or value == NaN
@@ -278,11 +726,12 @@ public:
         }
     }
 
-    inline qreal writeAlphaFromCache(quint8* dstPtr,
-                                     const quint32 channel,
-                                     const FFTInfo &info,
-                                     double* channelValuePtr,
-                                     bool *dstValueIsNull) {
+    template<typename T>
+    static inline qreal writeAlphaFromCache(quint8* dstPtr,
+                                            const quint32 channel,
+                                            const FFTInfo &info,
+                                            T* channelValuePtr,
+                                            bool *dstValueIsNull) {
         qreal channelPixelValue;
 
         channelPixelValue = *channelValuePtr * info.fftScale + info.absoluteOffset[channel];
@@ -292,12 +741,12 @@ public:
         return channelPixelValue;
     }
 
-    template <bool additionalMultiplierActive>
-    inline qreal writeOneChannelFromCache(quint8* dstPtr,
-                                          const quint32 channel,
-                                          const FFTInfo &info,
-                                          double* channelValuePtr,
-                                          const qreal additionalMultiplier = 0.0) {
+    template <bool additionalMultiplierActive, typename T>
+    static inline qreal writeOneChannelFromCache(quint8* dstPtr,
+                                                 const quint32 channel,
+                                                 const FFTInfo &info,
+                                                 T* channelValuePtr,
+                                                 const qreal additionalMultiplier = 0.0) {
         qreal channelPixelValue;
 
         if (additionalMultiplierActive) {
@@ -313,37 +762,38 @@ public:
         return channelPixelValue;
     }
 
-    void writeResultToDevice(const QRect &rect,
-                             const int cacheRowStride,
-                             const int halfKernelWidth,
-                             const int halfKernelHeight,
-                             const FFTInfo &info,
-                             const QRect &dataRect) {
+    template<typename T>
+    static void writeResultToDevice(const BlockSharedState<T> &state,
+                                    const QRect &rect,
+                                    const QVector<typename KisFFTWTraits<T>::complex_type*> &channelFFT) {
+
+        const FFTInfo &info = state.info;
+        const int cacheRowStride = state.cacheRowStride;
 
         typename _IteratorFactory_::HLineIterator hitDst =
-            _IteratorFactory_::createHLineIterator(this->m_painter->device(),
+            _IteratorFactory_::createHLineIterator(state.dst,
                                                    rect.x(), rect.y(), rect.width(),
-                                                   dataRect);
+                                                   state.dataRect);
 
-        int initialOffset = cacheRowStride * halfKernelHeight + halfKernelWidth;
+        int initialOffset = cacheRowStride * state.halfKernelHeight + state.halfKernelWidth;
 
         const int channelCount = info.numChannels();
-        QVector<double*> channelPtr(channelCount);
+        QVector<T*> channelPtr(channelCount);
         const auto channelPtrBegin = channelPtr.begin();
         const auto channelPtrEnd = channelPtr.end();
 
-        auto iFFt = m_channelFFT.constBegin();
+        auto iFFt = channelFFT.constBegin();
         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++iFFt) {
-            *i = (double*)*iFFt + initialOffset;
+            *i = (T*)*iFFt + initialOffset;
         }
 
         // prepare cache, reused in all loops
-        QVector<double*> cacheRowStart(channelCount);
+        QVector<T*> cacheRowStart(channelCount);
         const auto cacheRowStartBegin = cacheRowStart.begin();
 
         for (int y = 0; y < rect.height(); ++y) {
             // cache current channelPtr in cacheRowStart
-            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(double*));
+            memcpy(cacheRowStart.data(), channelPtr.data(), channelCount * sizeof(T*));
 
             for (int x = 0; x < rect.width(); ++x) {
                 quint8 *dstPtr = hitDst->rawData();
@@ -352,11 +802,11 @@ public:
                     bool alphaIsNullInDstSpace = false;
 
                     qreal alphaValue =
-                        writeAlphaFromCache(dstPtr,
-                                            info.alphaCachePos,
-                                            info,
-                                            channelPtr.at(info.alphaCachePos),
-                                            &alphaIsNullInDstSpace);
+                        writeAlphaFromCache<T>(dstPtr,
+                                               info.alphaCachePos,
+                                               info,
+                                               channelPtr.at(info.alphaCachePos),
+                                               &alphaIsNullInDstSpace);
 
                     if (!alphaIsNullInDstSpace &&
                         alphaValue > std::numeric_limits<qreal>::epsilon()) {
@@ -366,11 +816,11 @@ public:
                         int k = 0;
                         for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++k) {
                             if (k != info.alphaCachePos) {
-                                writeOneChannelFromCache<true>(dstPtr,
-                                                               k,
-                                                               info,
-                                                               *i,
-                                                               alphaValueInv);
+                                writeOneChannelFromCache<true, T>(dstPtr,
+                                                                  k,
+                                                                  info,
+                                                                  *i,
+                                                                  alphaValueInv);
                             }
                             ++(*i);
                         }
@@ -388,10 +838,10 @@ public:
                 } else {
                     int k = 0;
                     for (auto i = channelPtrBegin; i != channelPtrEnd; ++i, ++k) {
-                        writeOneChannelFromCache<false>(dstPtr,
-                                                        k,
-                                                        info,
-                                                        *i);
+                        writeOneChannelFromCache<false, T>(dstPtr,
+                                                           k,
+                                                           info,
+                                                           *i);
                        ++(*i);
                     }
                 }
@@ -409,43 +859,46 @@ public:
 
     }
 
-private:
-    void fftFillKernelMatrix(const KisConvolutionKernelSP kernel, fftw_complex *m_kernelFFT)
+    template<typename T>
+    static void fftFillKernelMatrix(const KisConvolutionKernelSP kernel, const BlockSharedState<T> &state, T *data)
     {
         // find central item
         QPoint offset((kernel->width() - 1) / 2, (kernel->height() - 1) / 2);
 
-        qint32 xShift = m_fftWidth - offset.x();
-        qint32 yShift = m_fftHeight - offset.y();
+        qint32 xShift = state.fftWidth - offset.x();
+        qint32 yShift = state.fftHeight - offset.y();
 
         quint32 absXpos, absYpos;
 
         for (quint32 y = 0; y < kernel->height(); y++)
         {
             absYpos = y + yShift;
-            if (absYpos >= m_fftHeight)
-                absYpos -= m_fftHeight;
+            if (absYpos >= state.fftHeight)
+                absYpos -= state.fftHeight;
 
             for (quint32 x = 0; x < kernel->width(); x++)
             {
                 absXpos = x + xShift;
-                if (absXpos >= m_fftWidth)
-                    absXpos -= m_fftWidth;
+                if (absXpos >= state.fftWidth)
+                    absXpos -= state.fftWidth;
 
-                ((double*)m_kernelFFT)[(m_fftWidth + m_extraMem) * absYpos + absXpos] = kernel->data()->coeff(y, x);
+                data[state.cacheRowStride * absYpos + absXpos] = kernel->data()->coeff(y, x);
             }
         }
     }
 
-    void fftMultiply(fftw_complex* channel, fftw_complex* kernel)
+    template<typename T>
+    static void fftMultiply(typename KisFFTWTraits<T>::complex_type* channel,
+                            const typename KisFFTWTraits<T>::complex_type* kernel,
+                            quint32 fftLength)
     {
         // perform complex multiplication
-        fftw_complex *channelPtr = channel;
-        fftw_complex *kernelPtr = kernel;
+        typename KisFFTWTraits<T>::complex_type *channelPtr = channel;
+        const typename KisFFTWTraits<T>::complex_type *kernelPtr = kernel;
 
-        fftw_complex tmp;
+        T tmp[2];
 
-        for (quint32 pixelPos = 0; pixelPos < m_fftLength; ++pixelPos)
+        for (quint32 pixelPos = 0; pixelPos < fftLength; ++pixelPos)
         {
             tmp[0] = ((*channelPtr)[0] * (*kernelPtr)[0]) - ((*channelPtr)[1] * (*kernelPtr)[1]);
             tmp[1] = ((*channelPtr)[0] * (*kernelPtr)[1]) + ((*channelPtr)[1] * (*kernelPtr)[0]);
@@ -457,99 +910,6 @@ private:
             ++kernelPtr;
         }
     }
-
-    void optimumDimensions(quint32& w, quint32& h)
-    {
-        // FFTW is most efficient when array size is a factor of 2, 3, 5 or 7
-        quint32 optW = w, optH = h;
-
-        while ((optW % 2 != 0) || (optW % 3 != 0) || (optW % 5 != 0) || (optW % 7 != 0))
-            ++optW;
-
-        while ((optH % 2 != 0) || (optH % 3 != 0) || (optH % 5 != 0) || (optH % 7 != 0))
-            ++optH;
-
-        quint32 optAreaW = optW * h;
-        quint32 optAreaH = optH * w;
-
-        if (optAreaW < optAreaH) {
-            w = optW;
-        }
-        else {
-            h = optH;
-        }
-    }
-
-    void fftLogMatrix(double* channel, const QString &f)
-    {
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        QString filename(QDir::homePath() + "/log_" + f + ".txt");
-        dbgKrita << "Log File Name: " << filename;
-        QFile file (filename);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
-        {
-            dbgKrita << "Failed";
-            KisConvolutionWorkerFFTLock::fftwMutex.unlock();
-            return;
-        }
-
-        QTextStream in(&file);
-        in.setCodec("UTF-8");
-        for (quint32 y = 0; y < m_fftHeight; y++)
-        {
-            for (quint32 x = 0; x < m_fftWidth; x++)
-            {
-                QString num = QString::number(channel[y * m_fftWidth + x]);
-                while (num.length() < 15)
-                    num += " ";
-
-                in << num << " ";
-            }
-            in << "\n";
-        }
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
-    }
-
-    void addToProgress(float amount)
-    {
-        m_currentProgress += amount;
-
-        if (this->m_progress) {
-            this->m_progress->setProgress((int)m_currentProgress);
-        }
-    }
-
-    bool isInterrupted()
-    {
-        if (this->m_progress && this->m_progress->interrupted()) {
-            cleanUp();
-            return true;
-        }
-
-        return false;
-    }
-
-    void cleanUp()
-    {
-        // free kernel fft data
-        if (m_kernelFFT) {
-            fftw_free(m_kernelFFT);
-        }
-
-        Q_FOREACH (fftw_complex *channel, m_channelFFT) {
-            fftw_free(channel);
-        }
-        m_channelFFT.clear();
-    }
-private:
-    quint32 m_fftWidth {0};
-    quint32 m_fftHeight {0};
-    quint32 m_fftLength {0};
-    quint32 m_extraMem {0};
-    float m_currentProgress {0.0};
-
-    fftw_complex* m_kernelFFT {0};
-    QVector<fftw_complex*> m_channelFFT;
 };
 
 #endif
@@ -66,7 +66,7 @@ void KisCurveCircleMaskGenerator::setScale(qreal scaleX, qreal scaleY)
 
 bool KisCurveCircleMaskGenerator::shouldVectorize() const
 {
-    return !shouldSupersample() && spikes() == 2;
+    return !isEmpty();
 }
 
 KisBrushMaskApplicatorBase *KisCurveCircleMaskGenerator::applicator() const
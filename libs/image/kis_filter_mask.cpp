@@ -21,10 +21,22 @@
 #include "kis_busy_progress_indicator.h"
 #include "kis_transaction.h"
 #include "kis_painter.h"
+#include "KisFilterTileCache.h"
+#include "KisThreadPoolRunnableStrokeJobsExecutor.h"
+
+struct KisFilterMask::Private
+{
+    /**
+     * The results of the filter are reused for the tiles,
+     * whose source pixels didn't change
+     */
+    KisFilterTileCache tileCache;
+};
 
 KisFilterMask::KisFilterMask(KisImageWSP image, const QString &name)
     : KisEffectMask(image, name),
-      KisNodeFilterInterface(0)
+      KisNodeFilterInterface(0),
+      m_d(new Private)
 {
     setCompositeOpId(COMPOSITE_COPY);
 }
@@ -36,6 +48,7 @@ KisFilterMask::~KisFilterMask()
 KisFilterMask::KisFilterMask(const KisFilterMask& rhs)
         : KisEffectMask(rhs)
         , KisNodeFilterInterface(rhs)
+        , m_d(new Private)
 {
 }
 
@@ -47,6 +60,9 @@ QIcon KisFilterMask::icon() const
 void KisFilterMask::setFilter(KisFilterConfigurationSP  filterConfig, bool checkCompareConfig)
 {
     KisNodeFilterInterface::setFilter(filterConfig, checkCompareConfig);
+
+    // release the memory of the results nobody needs anymore
+    m_d->tileCache.clear();
 }
 
 QRect KisFilterMask::decorateRect(KisPaintDeviceSP &src,
@@ -81,7 +97,25 @@ QRect KisFilterMask::decorateRect(KisPaintDeviceSP &src,
     KIS_ASSERT_RECOVER_NOOP(this->busyProgressIndicator());
     this->busyProgressIndicator()->update();
 
-    filter->process(src, dst, 0, rc, filterConfig.data(), 0);
+    /**
+     * The cache costs a copy of the source and of the results of the
+     * mask, i.e. up to twice the size of the layer, for every level of
+     * detail the mask has been shown in. The copies are limited by
+     * KisFilterTileCache::defaultMemoryLimit per mask and are released
+     * when the filter is changed.
+     */
+    if (KisFilterTileCache::isSupported(filter, src)) {
+        m_d->tileCache.process(filter, filterConfig, src, dst, rc);
+    } else {
+        // the filters, which split the area into blocks themselves,
+        // process the blocks on the global thread pool
+        KisThreadPoolRunnableStrokeJobsExecutor executor;
+        const int lod = src->defaultBounds()->currentLevelOfDetail();
+        KisRunnableStrokeJobsInterface *jobsInterface =
+            filter->supportsBlockedProcessing(filterConfig.data(), lod) ? &executor : 0;
+
+        filter->process(src, dst, 0, rc, filterConfig.data(), 0, jobsInterface);
+    }
 
     QRect r = filter->changedRect(rc, filterConfig.data(), dst->defaultBounds()->currentLevelOfDetail());
     return r;
@@ -82,7 +82,7 @@ inline quint8 KisGaussCircleMaskGenerator::Private::value(qreal dist) const
 
 bool KisGaussCircleMaskGenerator::shouldVectorize() const
 {
-    return !shouldSupersample() && spikes() == 2;
+    return !isEmpty();
 }
 
 KisBrushMaskApplicatorBase *KisGaussCircleMaskGenerator::applicator() const
@@ -10,6 +10,7 @@
 #include "kis_convolution_kernel.h"
 #include <kis_convolution_painter.h>
 #include <kis_transaction.h>
+#include "KisRecursiveGaussian.h"
 #include <QRect>
 
 
@@ -110,7 +111,16 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
     QPoint srcTopLeft = rect.topLeft();
 
 
-    if (KisConvolutionPainter::supportsFFTW()) {
+    if (KisRecursiveGaussian::isPreferredForRadius(xRadius, yRadius)) {
+        /**
+         * The cost of the recursive filter doesn't depend on the
+         * radius. It reads every stripe before writing it back, so
+         * it needs no transaction, just like the FFT-based one.
+         */
+        KisRecursiveGaussian::apply(device, rect, xRadius, yRadius,
+                                    channelFlags, progressUpdater, borderOp);
+
+    } else if (KisConvolutionPainter::supportsFFTW()) {
         KisConvolutionPainter painter(device, KisConvolutionPainter::FFTW);
         painter.setChannelFlags(channelFlags);
         painter.setProgress(progressUpdater);
@@ -704,6 +704,16 @@ int KisImageConfig::maxMaskingBrushSize() const
     return qMin(15000, 3 * maxBrushSize());
 }
 
+int KisImageConfig::brushMaskCacheSize(bool defaultValue) const
+{
+    return !defaultValue ? m_config.readEntry("brushMaskCacheSize", 64) : 64;
+}
+
+void KisImageConfig::setBrushMaskCacheSize(int value)
+{
+    m_config.writeEntry("brushMaskCacheSize", value);
+}
+
 bool KisImageConfig::renameMergedLayers(bool defaultValue) const
 {
     return defaultValue ? true : m_config.readEntry("renameMergedLayers", true);
@@ -143,6 +143,9 @@ public:
 
     int maxMaskingBrushSize() const;
 
+    int brushMaskCacheSize(bool defaultValue = false) const; // MiB
+    void setBrushMaskCacheSize(int value);
+
     bool renameMergedLayers(bool defaultValue = false) const;
     void setRenameMergedLayers(bool value);
 
@@ -48,6 +48,7 @@
 #include "kis_layer_utils.h"
 #include "kis_projection_leaf.h"
 #include "KisSafeNodeProjectionStore.h"
+#include "KisColorTransformationMasksChain.h"
 
 
 class KisCloneLayersList {
@@ -681,15 +682,33 @@ QRect KisLayer::applyMasks(const KisPaintDeviceSP source,
                 copyOriginalToProjection(source, destination, needRect);
             }
 
+            /**
+             * Consecutive color adjustment masks are fused into a single
+             * pass over the destination, instead of making a copy of
+             * the destination for every mask.
+             */
+            KisColorTransformationMasksChain colorTransformationChain(destination->colorSpace());
+            const bool canFuseMasks =
+                *destination->colorSpace() == *destination->compositionSourceColorSpace();
+
             Q_FOREACH (const KisEffectMaskSP& mask, masks) {
                 const QRect maskApplyRect = applyRects.pop();
                 const QRect maskNeedRect =
                     applyRects.isEmpty() ? needRect : applyRects.top();
-                    
+
+                if (canFuseMasks && KisColorTransformationMasksChain::canFuseMask(mask, maskApplyRect)) {
+                    colorTransformationChain.appendMask(mask);
+                    continue;
+                }
+
+                colorTransformationChain.apply(destination, requestedRect);
+
                 PositionToFilthy maskPosition = calculatePositionToFilthy(mask, filthyNode, const_cast<KisLayer*>(this));
                 mask->apply(destination, maskApplyRect, maskNeedRect, maskPosition);
             }
             Q_ASSERT(applyRects.isEmpty());
+
+            colorTransformationChain.apply(destination, requestedRect);
         } else {
             /**
              * We can't eliminate additional copy-op
@@ -49,6 +49,7 @@
 #include <kis_distance_information.h>
 #include <KoColorSpaceMaths.h>
 #include "kis_lod_transform.h"
+#include "KisRenderedDab.h"
 #include "kis_algebra_2d.h"
 #include "krita_utils.h"
 
@@ -2876,103 +2877,63 @@ KisRunnableStrokeJobsInterface *KisPainter::runnableStrokeJobsInterface() const
 
 void KisPainter::renderMirrorMaskSafe(QRect rc, KisFixedPaintDeviceSP dab, bool preserveDab)
 {
-    if (!d->mirrorHorizontally && !d->mirrorVertically) return;
-
-    KisFixedPaintDeviceSP dabToProcess = dab;
-    if (preserveDab) {
-        dabToProcess = new KisFixedPaintDevice(*dab);
-    }
-    renderMirrorMask(rc, dabToProcess);
+    // the dab is not changed by the mirroring anymore
+    Q_UNUSED(preserveDab);
+    renderMirrorMask(rc, dab);
 }
 
 void KisPainter::renderMirrorMaskSafe(QRect rc, KisFixedPaintDeviceSP dab, KisFixedPaintDeviceSP mask, bool preserveDab)
 {
-    if (!d->mirrorHorizontally && !d->mirrorVertically) return;
-
-    KisFixedPaintDeviceSP dabToProcess = dab;
-    if (preserveDab) {
-        dabToProcess = new KisFixedPaintDevice(*dab);
-    }
-    renderMirrorMask(rc, dabToProcess, mask);
+    Q_UNUSED(preserveDab);
+    renderMirrorMask(rc, dab, mask);
 }
 
 void KisPainter::renderMirrorMaskSafe(QRect rc, KisPaintDeviceSP dab, int sx, int sy, KisFixedPaintDeviceSP mask, bool preserveMask)
 {
-    if (!d->mirrorHorizontally && !d->mirrorVertically) return;
-
-    KisFixedPaintDeviceSP maskToProcess = mask;
-    if (preserveMask) {
-        maskToProcess = new KisFixedPaintDevice(*mask);
-    }
-    renderMirrorMask(rc, dab, sx, sy, maskToProcess);
+    Q_UNUSED(preserveMask);
+    renderMirrorMask(rc, dab, sx, sy, mask);
 }
 
-void KisPainter::renderMirrorMask(QRect rc, KisFixedPaintDeviceSP dab)
+QVector<KisDabPlacement> KisPainter::Private::calculateMirroredPlacements(const QRect &rc)
 {
+    QVector<KisDabPlacement> placements;
+
     int x = rc.topLeft().x();
     int y = rc.topLeft().y();
 
-    KisLodTransform t(d->device);
-    QPoint effectiveAxesCenter = t.map(d->axesCenter).toPoint();
+    KisLodTransform t(this->device);
+    QPoint effectiveAxesCenter = t.map(this->axesCenter).toPoint();
 
     int mirrorX = -((x+rc.width()) - effectiveAxesCenter.x()) + effectiveAxesCenter.x();
     int mirrorY = -((y+rc.height()) - effectiveAxesCenter.y()) + effectiveAxesCenter.y();
 
-    if (d->mirrorHorizontally && d->mirrorVertically){
-        dab->mirror(true, false);
-        bltFixed(mirrorX, y, dab, 0,0,rc.width(),rc.height());
-        dab->mirror(false,true);
-        bltFixed(mirrorX, mirrorY, dab, 0,0,rc.width(),rc.height());
-        dab->mirror(true, false);
-        bltFixed(x, mirrorY, dab, 0,0,rc.width(),rc.height());
-
-    }
-    else if (d->mirrorHorizontally){
-        dab->mirror(true, false);
-        bltFixed(mirrorX, y, dab, 0,0,rc.width(),rc.height());
-    }
-    else if (d->mirrorVertically){
-        dab->mirror(false, true);
-        bltFixed(x, mirrorY, dab, 0,0,rc.width(),rc.height());
+    if (this->mirrorHorizontally && this->mirrorVertically){
+        placements << KisDabPlacement(QPoint(mirrorX, y), true, false);
+        placements << KisDabPlacement(QPoint(mirrorX, mirrorY), true, true);
+        placements << KisDabPlacement(QPoint(x, mirrorY), false, true);
+    } else if (this->mirrorHorizontally) {
+        placements << KisDabPlacement(QPoint(mirrorX, y), true, false);
+    } else if (this->mirrorVertically) {
+        placements << KisDabPlacement(QPoint(x, mirrorY), false, true);
     }
 
+    return placements;
 }
 
-void KisPainter::renderMirrorMask(QRect rc, KisFixedPaintDeviceSP dab, KisFixedPaintDeviceSP mask)
+void KisPainter::renderMirrorMask(QRect rc, KisFixedPaintDeviceSP dab)
 {
-    int x = rc.topLeft().x();
-    int y = rc.topLeft().y();
-
-    KisLodTransform t(d->device);
-    QPoint effectiveAxesCenter = t.map(d->axesCenter).toPoint();
-
-    int mirrorX = -((x+rc.width()) - effectiveAxesCenter.x()) + effectiveAxesCenter.x();
-    int mirrorY = -((y+rc.height()) - effectiveAxesCenter.y()) + effectiveAxesCenter.y();
-
-    if (d->mirrorHorizontally && d->mirrorVertically){
-        dab->mirror(true, false);
-        mask->mirror(true, false);
-        bltFixedWithFixedSelection(mirrorX,y, dab, mask, rc.width() ,rc.height() );
-
-        dab->mirror(false,true);
-        mask->mirror(false, true);
-        bltFixedWithFixedSelection(mirrorX,mirrorY, dab, mask, rc.width() ,rc.height() );
-
-        dab->mirror(true, false);
-        mask->mirror(true, false);
-        bltFixedWithFixedSelection(x,mirrorY, dab, mask, rc.width() ,rc.height() );
+    const QVector<KisDabPlacement> placements = d->calculateMirroredPlacements(rc);
+    if (placements.isEmpty()) return;
 
-    }else if (d->mirrorHorizontally){
-        dab->mirror(true, false);
-        mask->mirror(true, false);
-        bltFixedWithFixedSelection(mirrorX,y, dab, mask, rc.width() ,rc.height() );
+    bltFixedPlacements(dab, QRect(dab->bounds().topLeft(), rc.size()), 0, placements);
+}
 
-    }else if (d->mirrorVertically){
-        dab->mirror(false, true);
-        mask->mirror(false, true);
-        bltFixedWithFixedSelection(x,mirrorY, dab, mask, rc.width() ,rc.height() );
-    }
+void KisPainter::renderMirrorMask(QRect rc, KisFixedPaintDeviceSP dab, KisFixedPaintDeviceSP mask)
+{
+    const QVector<KisDabPlacement> placements = d->calculateMirroredPlacements(rc);
+    if (placements.isEmpty()) return;
 
+    bltFixedPlacements(dab, QRect(dab->bounds().topLeft(), rc.size()), mask, placements);
 }
 
 
@@ -43,6 +43,7 @@ class KisPaintInformation;
 class KisPaintOp;
 class KisDistanceInformation;
 struct KisRenderedDab;
+struct KisDabPlacement;
 class KisRunnableStrokeJobsInterface;
 
 /**
@@ -300,6 +301,27 @@ public:
      */
     void bltFixed(const QRect &rc, const QList<KisRenderedDab> allSrcDevices);
 
+    /**
+     * Render the area \p srcRect of \p srcDev on all the \p placements in
+     * one pass. Every placement can be mirrored horizontally and/or
+     * vertically, the mirrored copies of the dab are prepared only once.
+     *
+     * The destination is processed tile by tile and all the placements
+     * crossing a tile are composited while it is locked, so the tiles
+     * covered by several placements are locked only once. The placements
+     * are composited in the order they are passed.
+     *
+     * @param srcDev the source device, it is not changed
+     * @param srcRect the area of \p srcDev to render
+     * @param mask optional alpha8 mask of the dab, the area of the size of
+     *             \p srcRect is taken from its top-left corner
+     * @param placements the top-left corners and the mirroring of the copies
+     */
+    void bltFixedPlacements(const KisFixedPaintDeviceSP srcDev,
+                            const QRect &srcRect,
+                            const KisFixedPaintDeviceSP mask,
+                            const QVector<KisDabPlacement> &placements);
+
     /**
      * Convenience method that uses QPoint and QRect.
      *
@@ -381,8 +403,11 @@ public:
      * then these set of methods provide way to render the devices mirrored
      * according the axesCenter vertically or horizontally or both.
      *
+     * All the mirrored copies are rendered in one pass with
+     * bltFixedPlacements().
+     *
      * @param rc rectangle area covered by dab
-     * @param dab this device will be mirrored in-place, it means that it will be changed
+     * @param dab the device to render, it is not changed
      */
     void renderMirrorMask(QRect rc, KisFixedPaintDeviceSP dab);
     void renderMirrorMask(QRect rc, KisFixedPaintDeviceSP dab, KisFixedPaintDeviceSP mask);
@@ -396,8 +421,8 @@ public:
      * @param rc rectangle area covered by dab
      * @param dab the device to render
      * @param mask mask to use for rendering
-     * @param preserveDab states whether a temporary device should be
-     *                    created to do the transformations
+     * @param preserveDab is ignored, renderMirrorMask() doesn't change
+     *                    the dab anymore
      */
     void renderMirrorMaskSafe(QRect rc, KisFixedPaintDeviceSP dab, bool preserveDab);
     void renderMirrorMaskSafe(QRect rc, KisFixedPaintDeviceSP dab, KisFixedPaintDeviceSP mask, bool preserveDab);
@@ -411,8 +436,8 @@ public:
      * @param sx x coordinate of the top left corner of the area
      * @param sy y coordinate of the top left corner of the area
      * @param mask mask to use for rendering
-     * @param preserveMask states whether a temporary device should be
-     *                    created to do the transformations
+     * @param preserveMask is ignored, renderMirrorMask() doesn't change
+     *                     the mask anymore
      */
     void renderMirrorMaskSafe(QRect rc, KisPaintDeviceSP dab, int sx, int sy, KisFixedPaintDeviceSP mask, bool preserveMask);
 
@@ -12,6 +12,72 @@
 #include "kis_random_accessor_ng.h"
 #include "KisRenderedDab.h"
 
+#include <KoColorSpaceRegistry.h>
+
+namespace {
+
+/**
+ * Copies \p srcRect of \p src into a new device mirroring the pixels
+ * on the fly, so the source device is left untouched
+ */
+KisFixedPaintDeviceSP createMirroredCopy(const KisFixedPaintDeviceSP src,
+                                         const QRect &srcRect,
+                                         bool mirrorHorizontally,
+                                         bool mirrorVertically)
+{
+    const QRect srcBounds = src->bounds();
+    const int pixelSize = src->pixelSize();
+    const int srcRowStride = srcBounds.width() * pixelSize;
+    const int dstRowStride = srcRect.width() * pixelSize;
+
+    KisFixedPaintDeviceSP dst = new KisFixedPaintDevice(src->colorSpace());
+    dst->setRect(QRect(QPoint(), srcRect.size()));
+    dst->lazyGrowBufferWithoutInitialization();
+
+    const quint8 *srcRow = src->constData() +
+        (srcRect.y() - srcBounds.y()) * srcRowStride +
+        (srcRect.x() - srcBounds.x()) * pixelSize;
+
+    for (int y = 0; y < srcRect.height(); y++) {
+        const int dstY = mirrorVertically ? srcRect.height() - 1 - y : y;
+        quint8 *dstRow = dst->data() + dstY * dstRowStride;
+
+        if (!mirrorHorizontally) {
+            memcpy(dstRow, srcRow, dstRowStride);
+        } else {
+            const quint8 *srcPixel = srcRow;
+            quint8 *dstPixel = dstRow + dstRowStride - pixelSize;
+
+            for (int x = 0; x < srcRect.width(); x++) {
+                memcpy(dstPixel, srcPixel, pixelSize);
+                srcPixel += pixelSize;
+                dstPixel -= pixelSize;
+            }
+        }
+
+        srcRow += srcRowStride;
+    }
+
+    return dst;
+}
+
+/**
+ * The pixels of the dab (and its mask) for one of the mirroring modes,
+ * the pointers point to the top-left corner of the rendered area
+ */
+struct PlacementSource {
+    KisFixedPaintDeviceSP dabCopy;
+    KisFixedPaintDeviceSP maskCopy;
+
+    const quint8 *dab {nullptr};
+    int dabRowStride {0};
+
+    const quint8 *mask {nullptr};
+    int maskRowStride {0};
+};
+
+}
+
 void KisPainter::Private::applyDevice(const QRect &applyRect,
                                       const KisRenderedDab &dab,
                                       KisRandomAccessorSP dstIt,
@@ -192,3 +258,203 @@ void KisPainter::bltFixed(const QRect &applyRect, const QList<KisRenderedDab> al
 #endif
 }
 
+
+void KisPainter::bltFixedPlacements(const KisFixedPaintDeviceSP srcDev,
+                                    const QRect &srcRect,
+                                    const KisFixedPaintDeviceSP mask,
+                                    const QVector<KisDabPlacement> &placements)
+{
+    if (srcRect.isEmpty() || placements.isEmpty()) return;
+    if (srcDev.isNull()) return;
+    if (d->device.isNull()) return;
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(srcDev->bounds().contains(srcRect));
+
+    const QRect maskRect = mask ? QRect(mask->bounds().topLeft(), srcRect.size()) : QRect();
+
+    if (mask) {
+        KIS_SAFE_ASSERT_RECOVER_RETURN(*mask->colorSpace() == *KoColorSpaceRegistry::instance()->alpha8());
+        KIS_SAFE_ASSERT_RECOVER_RETURN(mask->bounds().contains(maskRect));
+    }
+
+    const KoColorSpace *srcColorSpace = srcDev->colorSpace();
+    const int srcPixelSize = srcColorSpace->pixelSize();
+
+    /**
+     * Prepare the sources for all the used mirroring modes, the
+     * index of the mode is (mirrorHorizontally + 2 * mirrorVertically)
+     */
+    PlacementSource sources[4];
+
+    auto prepareSource = [&] (bool mirrorHorizontally, bool mirrorVertically) {
+        PlacementSource &source = sources[int(mirrorHorizontally) + 2 * int(mirrorVertically)];
+        if (source.dab) return;
+
+        KisFixedPaintDeviceSP dab = srcDev;
+        QRect dabRect = srcRect;
+
+        KisFixedPaintDeviceSP dabMask = mask;
+        QRect dabMaskRect = maskRect;
+
+        if (mirrorHorizontally || mirrorVertically) {
+            source.dabCopy = createMirroredCopy(srcDev, srcRect, mirrorHorizontally, mirrorVertically);
+            dab = source.dabCopy;
+            dabRect = dab->bounds();
+
+            if (mask) {
+                source.maskCopy = createMirroredCopy(mask, maskRect, mirrorHorizontally, mirrorVertically);
+                dabMask = source.maskCopy;
+                dabMaskRect = dabMask->bounds();
+            }
+        }
+
+        const QRect dabBounds = dab->bounds();
+        source.dabRowStride = dabBounds.width() * srcPixelSize;
+        source.dab = dab->constData() +
+            (dabRect.y() - dabBounds.y()) * source.dabRowStride +
+            (dabRect.x() - dabBounds.x()) * srcPixelSize;
+
+        if (dabMask) {
+            const QRect maskBounds = dabMask->bounds();
+            source.maskRowStride = maskBounds.width();
+            source.mask = dabMask->constData() +
+                (dabMaskRect.y() - maskBounds.y()) * source.maskRowStride +
+                (dabMaskRect.x() - maskBounds.x());
+        }
+    };
+
+    QVector<QRect> placementRects;
+    placementRects.reserve(placements.size());
+
+    QRect totalRect;
+
+    Q_FOREACH (const KisDabPlacement &placement, placements) {
+        prepareSource(placement.mirrorHorizontally, placement.mirrorVertically);
+
+        const QRect rc(placement.offset, srcRect.size());
+        placementRects.append(rc);
+        totalRect |= rc;
+    }
+
+    QRect rc = totalRect;
+
+    if (d->selection) {
+        rc &= d->selection->selectedRect();
+    }
+
+    if (!rc.isEmpty()) {
+        KoCompositeOp::ParameterInfo localParamInfo = d->paramInfo;
+        const KoCompositeOp *compositeOp = d->compositeOp(srcColorSpace);
+
+        KisRandomAccessorSP dstIt = d->device->createRandomAccessorNG();
+        KisRandomConstAccessorSP selectionIt =
+            d->selection ? d->selection->projection()->createRandomConstAccessorNG() : 0;
+
+        const KoCompositeOp *multiplyOp =
+            KoColorSpaceRegistry::instance()->alpha8()->compositeOp(COMPOSITE_MULT);
+        QVector<quint8> mergedMask;
+
+        /**
+         * Walk through the destination tile by tile and render all the
+         * placements crossing the current tile, so that every tile is
+         * locked by the accessor only once
+         */
+        qint32 dstY = rc.y();
+        qint32 rowsRemaining = rc.height();
+
+        while (rowsRemaining > 0) {
+            qint32 dstX = rc.x();
+
+            qint32 rows = qMin(rowsRemaining, dstIt->numContiguousRows(dstY));
+            if (selectionIt) {
+                rows = qMin(rows, selectionIt->numContiguousRows(dstY));
+            }
+
+            qint32 columnsRemaining = rc.width();
+
+            while (columnsRemaining > 0) {
+                qint32 columns = qMin(columnsRemaining, dstIt->numContiguousColumns(dstX));
+                if (selectionIt) {
+                    columns = qMin(columns, selectionIt->numContiguousColumns(dstX));
+                }
+
+                const QRect tileRect(dstX, dstY, columns, rows);
+
+                for (int i = 0; i < placements.size(); i++) {
+                    const QRect applyRect = placementRects[i] & tileRect;
+                    if (applyRect.isEmpty()) continue;
+
+                    const KisDabPlacement &placement = placements[i];
+                    const PlacementSource &source =
+                        sources[int(placement.mirrorHorizontally) + 2 * int(placement.mirrorVertically)];
+
+                    const QPoint srcPos = applyRect.topLeft() - placementRects[i].topLeft();
+
+                    dstIt->moveTo(applyRect.x(), applyRect.y());
+
+                    localParamInfo.dstRowStart   = dstIt->rawData();
+                    localParamInfo.dstRowStride  = dstIt->rowStride(applyRect.x(), applyRect.y());
+                    localParamInfo.srcRowStart   = source.dab + srcPos.y() * source.dabRowStride + srcPos.x() * srcPixelSize;
+                    localParamInfo.srcRowStride  = source.dabRowStride;
+                    localParamInfo.maskRowStart  = 0;
+                    localParamInfo.maskRowStride = 0;
+                    localParamInfo.rows          = applyRect.height();
+                    localParamInfo.cols          = applyRect.width();
+
+                    const quint8 *dabMaskStart =
+                        source.mask ? source.mask + srcPos.y() * source.maskRowStride + srcPos.x() : 0;
+
+                    if (selectionIt) {
+                        selectionIt->moveTo(applyRect.x(), applyRect.y());
+
+                        const quint8 *selectionRow = selectionIt->rawDataConst();
+                        const qint32 selectionRowStride = selectionIt->rowStride(applyRect.x(), applyRect.y());
+
+                        if (dabMaskStart) {
+                            // merge the selections by multiplying them
+                            mergedMask.resize(applyRect.width() * applyRect.height());
+
+                            for (int y = 0; y < applyRect.height(); y++) {
+                                memcpy(mergedMask.data() + y * applyRect.width(),
+                                       selectionRow + y * selectionRowStride,
+                                       applyRect.width());
+                            }
+
+                            KoCompositeOp::ParameterInfo multiplyParamInfo;
+                            multiplyParamInfo.opacity = 1.0f;
+                            multiplyParamInfo.flow = 1.0f;
+                            multiplyParamInfo.dstRowStart   = mergedMask.data();
+                            multiplyParamInfo.dstRowStride  = applyRect.width();
+                            multiplyParamInfo.srcRowStart   = dabMaskStart;
+                            multiplyParamInfo.srcRowStride  = source.maskRowStride;
+                            multiplyParamInfo.maskRowStart  = 0;
+                            multiplyParamInfo.maskRowStride = 0;
+                            multiplyParamInfo.rows          = applyRect.height();
+                            multiplyParamInfo.cols          = applyRect.width();
+                            multiplyOp->composite(multiplyParamInfo);
+
+                            localParamInfo.maskRowStart  = mergedMask.constData();
+                            localParamInfo.maskRowStride = applyRect.width();
+                        } else {
+                            localParamInfo.maskRowStart  = selectionRow;
+                            localParamInfo.maskRowStride = selectionRowStride;
+                        }
+                    } else if (dabMaskStart) {
+                        localParamInfo.maskRowStart  = dabMaskStart;
+                        localParamInfo.maskRowStride = source.maskRowStride;
+                    }
+
+                    d->colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp, d->renderingIntent, d->conversionFlags);
+                }
+
+                dstX += columns;
+                columnsRemaining -= columns;
+            }
+
+            dstY += rows;
+            rowsRemaining -= rows;
+        }
+    }
+
+    addDirtyRects(placementRects);
+}
@@ -95,6 +95,8 @@ struct Q_DECL_HIDDEN KisPainter::Private {
 
     template<class T> QVector<T> calculateMirroredObjects(const T &object);
 
+    QVector<KisDabPlacement> calculateMirroredPlacements(const QRect &rc);
+
 };
 
 #endif // KISPAINTERPRIVATE_H
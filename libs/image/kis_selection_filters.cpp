@@ -9,6 +9,8 @@
 
 #include <algorithm>
 
+#include <QVector>
+
 #include <klocalizedstring.h>
 
 #include <KoColorSpace.h>
@@ -16,6 +18,7 @@
 #include "kis_convolution_kernel.h"
 #include "kis_pixel_selection.h"
 #include <kis_sequential_iterator.h>
+#include "KisRankFilter.h"
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -110,6 +113,47 @@ void KisSelectionFilter::computeTransition(quint8* transition, quint8** buf, qin
         transition[x] = 0;
 }
 
+void KisSelectionFilter::applyPolygonExtremum(KisPixelSelectionSP pixelSelection, const QRect &rect,
+                                              qint32 xRadius, qint32 yRadius,
+                                              bool maximum, bool edgeLock)
+{
+    const int width = rect.width() + 2 * xRadius;
+    const int height = rect.height() + 2 * yRadius;
+
+    QVector<quint8> plane(width * height, 0);
+    QVector<quint8> bytes(rect.width() * rect.height());
+
+    pixelSelection->readBytes(bytes.data(), rect);
+
+    for (int y = 0; y < rect.height(); y++) {
+        memcpy(plane.data() + (y + yRadius) * width + xRadius,
+               bytes.constData() + y * rect.width(), rect.width());
+    }
+
+    if (edgeLock) {
+        for (int y = yRadius; y < yRadius + rect.height(); y++) {
+            quint8 *row = plane.data() + y * width;
+            memset(row, row[xRadius], xRadius);
+            memset(row + xRadius + rect.width(), row[xRadius + rect.width() - 1], xRadius);
+        }
+        for (int y = 0; y < yRadius; y++) {
+            memcpy(plane.data() + y * width, plane.constData() + yRadius * width, width);
+            memcpy(plane.data() + (height - 1 - y) * width,
+                   plane.constData() + (height - 1 - yRadius) * width, width);
+        }
+    }
+
+    KisRankFilter::polygonExtremum(plane.data(), width, height, xRadius, yRadius,
+                                   maximum ? KisRankFilter::Maximum : KisRankFilter::Minimum);
+
+    for (int y = 0; y < rect.height(); y++) {
+        memcpy(bytes.data() + y * rect.width(),
+               plane.constData() + (y + yRadius) * width + xRadius, rect.width());
+    }
+
+    pixelSelection->writeBytes(bytes.constData(), rect);
+}
+
 
 KUndo2MagicString KisErodeSelectionFilter::name()
 {
@@ -561,6 +605,11 @@ void KisGrowSelectionFilter::process(KisPixelSelectionSP pixelSelection, const Q
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (qMin(m_xRadius, m_yRadius) >= KisRankFilter::polygonMinimumRadius) {
+        applyPolygonExtremum(pixelSelection, rect, m_xRadius, m_yRadius, true, false);
+        return;
+    }
+
     /**
         * Much code resembles Shrink filter, so please fix bugs
         * in both filters
@@ -688,6 +737,11 @@ void KisShrinkSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (qMin(m_xRadius, m_yRadius) >= KisRankFilter::polygonMinimumRadius) {
+        applyPolygonExtremum(pixelSelection, rect, m_xRadius, m_yRadius, false, m_edgeLock);
+        return;
+    }
+
     /*
         pretty much the same as fatten_region only different
         blame all bugs in this function on jaycox@gimp.org
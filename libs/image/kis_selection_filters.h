@@ -36,6 +36,17 @@ protected:
     void rotatePointers(quint8  **p, quint32 n);
 
     void computeTransition(quint8* transition, quint8** buf, qint32 width);
+
+    /**
+     * Grows (\p maximum is true) or shrinks \p rect of the selection
+     * with the polygonal approximation of the ellipse, which has a
+     * constant cost per pixel. The pixels outside \p rect are
+     * considered to be zero or, if \p edgeLock is true, equal to the
+     * nearest edge pixels.
+     */
+    void applyPolygonExtremum(KisPixelSelectionSP pixelSelection, const QRect &rect,
+                              qint32 xRadius, qint32 yRadius,
+                              bool maximum, bool edgeLock);
 };
 
 class KRITAIMAGE_EXPORT KisErodeSelectionFilter : public KisSelectionFilter
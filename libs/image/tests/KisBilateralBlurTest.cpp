@@ -0,0 +1,166 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisBilateralBlurTest.h"
+
+#include <cmath>
+
+#include <QPainter>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "KisBilateralBlur.h"
+#include "kis_paint_device.h"
+#include "kistest.h"
+#include "testutil.h"
+#include "testing_timed_default_bounds.h"
+
+namespace {
+
+KisPaintDeviceSP createNoisyStep(const QRect &imageRect, int leftValue, int rightValue, int noise)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    QImage image(imageRect.size(), QImage::Format_ARGB32);
+
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            // a deterministic pseudo-random noise
+            quint32 hash = quint32(x) * 73856093u ^ quint32(y) * 19349663u;
+            hash ^= hash >> 13;
+            hash *= 0x5bd1e995u;
+            hash ^= hash >> 15;
+
+            const int offset = int(hash % (2 * noise + 1)) - noise;
+            const int value = (x < image.width() / 2 ? leftValue : rightValue) + offset;
+            image.setPixel(x, y, qRgb(value, value, value));
+        }
+    }
+
+    dev->convertFromQImage(image, 0, imageRect.x(), imageRect.y());
+    return dev;
+}
+
+qreal standardDeviation(const QImage &image, const QRect &rect)
+{
+    qreal sum = 0;
+    qreal sumSquares = 0;
+
+    for (int y = rect.top(); y <= rect.bottom(); y++) {
+        for (int x = rect.left(); x <= rect.right(); x++) {
+            const int value = qGray(image.pixel(x, y));
+            sum += value;
+            sumSquares += value * value;
+        }
+    }
+
+    const int numPixels = rect.width() * rect.height();
+    const qreal mean = sum / numPixels;
+
+    return std::sqrt(qMax(0.0, sumSquares / numPixels - mean * mean));
+}
+
+}
+
+void KisBilateralBlurTest::testFlatArea_data()
+{
+    QTest::addColumn<qreal>("radius");
+
+    QTest::newRow("exact") << 2.0;
+    QTest::newRow("grid") << 12.0;
+}
+
+void KisBilateralBlurTest::testFlatArea()
+{
+    QFETCH(qreal, radius);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect imageRect(0, 0, 300, 200);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+    dev->fill(imageRect, KoColor(QColor(200, 100, 50), cs));
+
+    const QImage reference = dev->convertToQImage(0, imageRect);
+
+    KisBilateralBlur::apply(dev, imageRect, radius, 20, cs->channelFlags(true, true), 0);
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt, reference, dev->convertToQImage(0, imageRect), 1, 1));
+}
+
+void KisBilateralBlurTest::testEdgePreserving_data()
+{
+    QTest::addColumn<qreal>("radius");
+
+    QTest::newRow("exact") << 3.0;
+    QTest::newRow("grid") << 12.0;
+}
+
+void KisBilateralBlurTest::testEdgePreserving()
+{
+    QFETCH(qreal, radius);
+
+    const QRect imageRect(0, 0, 200, 100);
+    KisPaintDeviceSP dev = createNoisyStep(imageRect, 60, 190, 6);
+    const QBitArray channelFlags = dev->colorSpace()->channelFlags(true, true);
+
+    const QImage source = dev->convertToQImage(0, imageRect);
+    KisBilateralBlur::apply(dev, imageRect, radius, 30, channelFlags, 0);
+    const QImage result = dev->convertToQImage(0, imageRect);
+
+    // the noise is smoothed...
+    const QRect leftArea(20, 20, 60, 60);
+    const QRect rightArea(120, 20, 60, 60);
+
+    QVERIFY(standardDeviation(result, leftArea) < 0.5 * standardDeviation(source, leftArea));
+    QVERIFY(standardDeviation(result, rightArea) < 0.5 * standardDeviation(source, rightArea));
+
+    // ...but the pixels next to the edge are not mixed with the other side
+    for (int y = 0; y < imageRect.height(); y++) {
+        QVERIFY(qAbs(qGray(result.pixel(98, y)) - 60) <= 6);
+        QVERIFY(qAbs(qGray(result.pixel(101, y)) - 190) <= 6);
+    }
+}
+
+void KisBilateralBlurTest::testBlocksAreSeamless()
+{
+    const QRect imageRect(0, 0, 600, 300);
+    KisPaintDeviceSP dev = createNoisyStep(imageRect, 40, 210, 20);
+    const QBitArray channelFlags = dev->colorSpace()->channelFlags(true, true);
+
+    KisPaintDeviceSP leftPart = new KisPaintDevice(*dev);
+    KisPaintDeviceSP rightPart = new KisPaintDevice(*dev);
+
+    const qreal radius = 10.0;
+    KisBilateralBlur::apply(dev, imageRect, radius, 40, channelFlags, 0);
+
+    // the split is not aligned to the blocks or to the grid cells
+    const QRect leftRect(0, 0, 277, 300);
+    const QRect rightRect(277, 0, 323, 300);
+
+    KisBilateralBlur::apply(leftPart, leftRect, radius, 40, channelFlags, 0);
+    KisBilateralBlur::apply(rightPart, rightRect, radius, 40, channelFlags, 0);
+
+    QImage referenceImage = dev->convertToQImage(0, imageRect);
+    QImage partsImage = leftPart->convertToQImage(0, imageRect);
+
+    QPainter gc(&partsImage);
+    gc.drawImage(rightRect.topLeft(), rightPart->convertToQImage(0, rightRect));
+    gc.end();
+
+    QPoint pt;
+    if (!TestUtil::compareQImages(pt, referenceImage, partsImage, 1, 1)) {
+        referenceImage.save("bilateral_blur_seamless_reference.png");
+        partsImage.save("bilateral_blur_seamless_parts.png");
+        QFAIL(QString("The split result differs at (%1, %2)").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
+KISTEST_MAIN(KisBilateralBlurTest)
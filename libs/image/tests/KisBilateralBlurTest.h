@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISBILATERALBLURTEST_H
+#define KISBILATERALBLURTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisBilateralBlurTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testFlatArea_data();
+    void testFlatArea();
+    void testEdgePreserving_data();
+    void testEdgePreserving();
+    void testBlocksAreSeamless();
+};
+
+#endif // KISBILATERALBLURTEST_H
@@ -0,0 +1,238 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisFilterTileCacheTest.h"
+
+#include <atomic>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+#include <KisGlobalResourcesInterface.h>
+
+#include "KisFilterTileCache.h"
+#include "filter/kis_filter.h"
+#include "filter/kis_filter_configuration.h"
+#include "kis_paint_device.h"
+#include "kistest.h"
+#include "testutil.h"
+#include "testing_timed_default_bounds.h"
+
+namespace {
+
+/**
+ * A 3x3 box blur, which counts the pixels it has filtered
+ */
+class CountingBoxFilter : public KisFilter
+{
+public:
+    CountingBoxFilter()
+        : KisFilter(KoID("countingbox", "countingbox"), KoID("test", "test"), "CountingBoxFilter")
+    {
+    }
+
+    void processImpl(KisPaintDeviceSP device,
+                     const QRect &rect,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater *progressUpdater) const override
+    {
+        Q_UNUSED(config);
+        Q_UNUSED(progressUpdater);
+
+        const int pixelSize = device->pixelSize();
+        const QRect srcRect = rect.adjusted(-1, -1, 1, 1);
+
+        QVector<quint8> src(srcRect.width() * srcRect.height() * pixelSize);
+        QVector<quint8> dst(rect.width() * rect.height() * pixelSize);
+        device->readBytes(src.data(), srcRect);
+
+        for (int y = 0; y < rect.height(); y++) {
+            for (int x = 0; x < rect.width(); x++) {
+                for (int c = 0; c < pixelSize; c++) {
+                    int sum = 0;
+
+                    for (int dy = 0; dy < 3; dy++) {
+                        for (int dx = 0; dx < 3; dx++) {
+                            sum += src[((y + dy) * srcRect.width() + x + dx) * pixelSize + c];
+                        }
+                    }
+
+                    dst[(y * rect.width() + x) * pixelSize + c] = sum / 9;
+                }
+            }
+        }
+
+        device->writeBytes(dst.constData(), rect);
+        filteredPixels += rect.width() * rect.height();
+    }
+
+    QRect neededRect(const QRect &rect, const KisFilterConfigurationSP config, int lod) const override
+    {
+        Q_UNUSED(config);
+        Q_UNUSED(lod);
+        return rect.adjusted(-1, -1, 1, 1);
+    }
+
+    QRect changedRect(const QRect &rect, const KisFilterConfigurationSP config, int lod) const override
+    {
+        Q_UNUSED(config);
+        Q_UNUSED(lod);
+        return rect.adjusted(-1, -1, 1, 1);
+    }
+
+    mutable std::atomic<int> filteredPixels {0};
+};
+
+struct CacheTester
+{
+    CacheTester(qint64 memoryLimit = KisFilterTileCache::defaultMemoryLimit)
+        : imageRect(0, 0, 256, 192),
+          counter(new CountingBoxFilter()),
+          filter(counter),
+          cache(memoryLimit)
+    {
+        const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+        src = new KisPaintDevice(cs);
+        src->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+        QImage image(imageRect.size(), QImage::Format_ARGB32);
+
+        for (int y = 0; y < image.height(); y++) {
+            for (int x = 0; x < image.width(); x++) {
+                image.setPixel(x, y, qRgb((x * 7) & 0xff, (y * 13) & 0xff, ((x + y) * 5) & 0xff));
+            }
+        }
+
+        src->convertFromQImage(image, 0);
+
+        config = filter->defaultConfiguration(KisGlobalResourcesInterface::instance())->cloneWithResourcesSnapshot();
+    }
+
+    /**
+     * Filters the image with the cache and compares the
+     * result to the filter applied without the cache
+     */
+    void checkResult() {
+        KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+        cache.process(filter, config, src, dst, imageRect);
+
+        KisPaintDeviceSP reference = new KisPaintDevice(src->colorSpace());
+        const int filteredPixels = counter->filteredPixels;
+        filter->process(src, reference, 0, imageRect, config, 0);
+        counter->filteredPixels = filteredPixels;
+
+        QPoint pt;
+        QVERIFY(TestUtil::compareQImages(pt,
+                                         reference->convertToQImage(0, imageRect),
+                                         dst->convertToQImage(0, imageRect)));
+    }
+
+    QRect imageRect;
+    KisPaintDeviceSP src;
+    CountingBoxFilter *counter;
+    KisFilterSP filter;
+    KisFilterConfigurationSP config;
+    KisFilterTileCache cache;
+};
+
+}
+
+void KisFilterTileCacheTest::testUnchangedSourceIsReused()
+{
+    CacheTester t;
+
+    t.checkResult();
+    QCOMPARE(int(t.counter->filteredPixels), t.imageRect.width() * t.imageRect.height());
+    QCOMPARE(t.cache.lastReusedTiles(), 0);
+
+    t.counter->filteredPixels = 0;
+    t.checkResult();
+    QCOMPARE(int(t.counter->filteredPixels), 0);
+    QCOMPARE(t.cache.lastReusedTiles(), 4 * 3);
+}
+
+void KisFilterTileCacheTest::testChangedSourceIsFiltered()
+{
+    CacheTester t;
+    t.checkResult();
+
+    // the pixel is on the edge of the tile, so its neighbour is affected too
+    t.src->setPixel(63, 100, KoColor(Qt::white, t.src->colorSpace()));
+
+    t.counter->filteredPixels = 0;
+    t.checkResult();
+    QCOMPARE(int(t.counter->filteredPixels), 2 * 64 * 64);
+    QCOMPARE(t.cache.lastReusedTiles(), 4 * 3 - 2);
+
+    t.counter->filteredPixels = 0;
+    t.checkResult();
+    QCOMPARE(int(t.counter->filteredPixels), 0);
+}
+
+void KisFilterTileCacheTest::testConfigurationChange()
+{
+    CacheTester t;
+    t.checkResult();
+
+    KisFilterConfigurationSP config = t.config->clone();
+    config->setProperty("someProperty", 10);
+    t.config = config;
+
+    t.counter->filteredPixels = 0;
+    t.checkResult();
+    QCOMPARE(int(t.counter->filteredPixels), t.imageRect.width() * t.imageRect.height());
+    QCOMPARE(t.cache.lastReusedTiles(), 0);
+}
+
+void KisFilterTileCacheTest::testLevelOfDetailSwitch()
+{
+    CacheTester t;
+    t.checkResult();
+
+    TestUtil::TestingTimedDefaultBounds *bounds = new TestUtil::TestingTimedDefaultBounds(t.imageRect);
+    bounds->testingSetLod(1);
+    t.src->setDefaultBounds(bounds);
+
+    t.counter->filteredPixels = 0;
+    t.checkResult();
+    QCOMPARE(t.cache.lastReusedTiles(), 0);
+
+    // the results of the full resolution are still there
+    t.src->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(t.imageRect));
+
+    t.counter->filteredPixels = 0;
+    t.checkResult();
+    QCOMPARE(int(t.counter->filteredPixels), 0);
+    QCOMPARE(t.cache.lastReusedTiles(), 4 * 3);
+}
+
+void KisFilterTileCacheTest::testMemoryLimit()
+{
+    // 27 tiles of the source and the results in RGBA8
+    CacheTester t(27 * 2 * 64 * 64 * 4);
+
+    const QRect leftRect(0, 0, 128, 192);
+    const QRect rightRect(128, 0, 128, 192);
+
+    KisPaintDeviceSP dst = new KisPaintDevice(t.src->colorSpace());
+
+    // the source of the left half with its halo takes 4 x 5 tiles
+    t.cache.process(t.filter, t.config, t.src, dst, leftRect);
+
+    // the right half adds 2 x 5 tiles, so the 10 tiles used only by
+    // the left half are dropped to get under 3/4 of the limit
+    t.cache.process(t.filter, t.config, t.src, dst, rightRect);
+
+    /**
+     * The results of the left half depend on the dropped source
+     * pixels, so they are filtered again, the right half is reused
+     */
+    t.counter->filteredPixels = 0;
+    t.checkResult();
+    QCOMPARE(t.cache.lastReusedTiles(), 2 * 3);
+    QCOMPARE(int(t.counter->filteredPixels), leftRect.width() * leftRect.height());
+}
+
+KISTEST_MAIN(KisFilterTileCacheTest)
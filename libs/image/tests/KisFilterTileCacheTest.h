@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISFILTERTILECACHETEST_H
+#define KISFILTERTILECACHETEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisFilterTileCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testUnchangedSourceIsReused();
+    void testChangedSourceIsFiltered();
+    void testConfigurationChange();
+    void testLevelOfDetailSwitch();
+    void testMemoryLimit();
+};
+
+#endif // KISFILTERTILECACHETEST_H
@@ -0,0 +1,192 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisMotionBlurTest.h"
+
+#include <cmath>
+
+#include <QPainter>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "KisMotionBlur.h"
+#include "KisThreadPoolRunnableStrokeJobsExecutor.h"
+#include "kis_paint_device.h"
+#include "kistest.h"
+#include "testutil.h"
+#include "testing_timed_default_bounds.h"
+
+namespace {
+
+KisPaintDeviceSP createNoise(const QRect &imageRect)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    QImage image(imageRect.size(), QImage::Format_ARGB32);
+
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            // a deterministic pseudo-random noise
+            quint32 hash = quint32(x) * 73856093u ^ quint32(y) * 19349663u;
+            hash ^= hash >> 13;
+            hash *= 0x5bd1e995u;
+            hash ^= hash >> 15;
+
+            image.setPixel(x, y, qRgb(hash & 0xff, (hash >> 8) & 0xff, (hash >> 16) & 0xff));
+        }
+    }
+
+    dev->convertFromQImage(image, 0, imageRect.x(), imageRect.y());
+    return dev;
+}
+
+}
+
+void KisMotionBlurTest::testAxisAligned_data()
+{
+    QTest::addColumn<qreal>("angle");
+
+    QTest::newRow("horizontal") << 0.0;
+    QTest::newRow("vertical") << 90.0;
+}
+
+void KisMotionBlurTest::testAxisAligned()
+{
+    QFETCH(qreal, angle);
+
+    const QRect imageRect(0, 0, 200, 150);
+    KisPaintDeviceSP dev = createNoise(imageRect);
+
+    const QImage source = dev->convertToQImage(0, imageRect);
+
+    // the line covers 41 pixels, no interpolation is needed
+    const int length = 40;
+    const bool vertical = angle != 0.0;
+
+    KisMotionBlur::apply(dev, imageRect, length, kisDegreesToRadians(angle),
+                         dev->colorSpace()->channelFlags(true, true), 0);
+
+    const QImage result = dev->convertToQImage(0, imageRect);
+
+    for (int y = 0; y < imageRect.height(); y++) {
+        for (int x = 0; x < imageRect.width(); x++) {
+            int sum[3] = {0, 0, 0};
+
+            for (int i = -length / 2; i <= length / 2; i++) {
+                // the edge pixels are repeated
+                const int sx = vertical ? x : qBound(0, x + i, imageRect.width() - 1);
+                const int sy = vertical ? qBound(0, y + i, imageRect.height() - 1) : y;
+                const QRgb pixel = source.pixel(sx, sy);
+
+                sum[0] += qRed(pixel);
+                sum[1] += qGreen(pixel);
+                sum[2] += qBlue(pixel);
+            }
+
+            const QRgb pixel = result.pixel(x, y);
+
+            QVERIFY(qAbs(qRed(pixel) - sum[0] / (length + 1.0)) <= 1.0);
+            QVERIFY(qAbs(qGreen(pixel) - sum[1] / (length + 1.0)) <= 1.0);
+            QVERIFY(qAbs(qBlue(pixel) - sum[2] / (length + 1.0)) <= 1.0);
+        }
+    }
+}
+
+void KisMotionBlurTest::testDiagonalImpulse()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect imageRect(0, 0, 200, 200);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+    dev->fill(imageRect, KoColor(Qt::black, cs));
+    dev->fill(QRect(100, 100, 1, 1), KoColor(Qt::white, cs));
+
+    const qreal length = 60.0;
+    KisMotionBlur::apply(dev, imageRect, length, kisDegreesToRadians(45.0),
+                         cs->channelFlags(true, true), 0);
+
+    const QImage result = dev->convertToQImage(0, imageRect);
+
+    // the impulse is spread along the diagonal only
+    for (int y = 0; y < imageRect.height(); y++) {
+        for (int x = 0; x < imageRect.width(); x++) {
+            const int value = qGray(result.pixel(x, y));
+            const int distanceAcross = qAbs((x - 100) - (y - 100));
+            const qreal distanceAlong = 0.5 * std::sqrt(2.0) * qAbs((x - 100) + (y - 100));
+
+            if (distanceAcross > 2 || distanceAlong > 0.5 * length + 2) {
+                QCOMPARE(value, 0);
+            } else if (distanceAcross == 0 && distanceAlong < 0.5 * length - 2) {
+                QVERIFY(value > 0);
+            }
+        }
+    }
+}
+
+void KisMotionBlurTest::testBlocksAreSeamless()
+{
+    const QRect imageRect(0, 0, 700, 300);
+    KisPaintDeviceSP dev = createNoise(imageRect);
+    const QBitArray channelFlags = dev->colorSpace()->channelFlags(true, true);
+
+    KisPaintDeviceSP leftPart = new KisPaintDevice(*dev);
+    KisPaintDeviceSP rightPart = new KisPaintDevice(*dev);
+
+    const qreal length = 90.0;
+    const qreal angle = kisDegreesToRadians(33.0);
+
+    KisMotionBlur::apply(dev, imageRect, length, angle, channelFlags, 0);
+
+    // the split is not aligned to the blocks
+    const QRect leftRect(0, 0, 277, 300);
+    const QRect rightRect(277, 0, 423, 300);
+
+    KisMotionBlur::apply(leftPart, leftRect, length, angle, channelFlags, 0);
+    KisMotionBlur::apply(rightPart, rightRect, length, angle, channelFlags, 0);
+
+    QImage referenceImage = dev->convertToQImage(0, imageRect);
+    QImage partsImage = leftPart->convertToQImage(0, imageRect);
+
+    QPainter gc(&partsImage);
+    gc.drawImage(rightRect.topLeft(), rightPart->convertToQImage(0, rightRect));
+    gc.end();
+
+    QPoint pt;
+    if (!TestUtil::compareQImages(pt, referenceImage, partsImage, 1, 1)) {
+        referenceImage.save("motion_blur_seamless_reference.png");
+        partsImage.save("motion_blur_seamless_parts.png");
+        QFAIL(QString("The split result differs at (%1, %2)").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
+void KisMotionBlurTest::testConcurrentBlocks()
+{
+    // not aligned to the blocks, so the edge blocks are partial
+    const QRect imageRect(-30, -20, 1200, 900);
+    KisPaintDeviceSP dev = createNoise(imageRect);
+    const QBitArray channelFlags = dev->colorSpace()->channelFlags(true, true);
+
+    KisPaintDeviceSP concurrentDev = new KisPaintDevice(*dev);
+
+    const qreal length = 90.0;
+    const qreal angle = kisDegreesToRadians(-57.0);
+
+    KisMotionBlur::apply(dev, imageRect, length, angle, channelFlags, 0);
+
+    KisThreadPoolRunnableStrokeJobsExecutor executor;
+    KisMotionBlur::apply(concurrentDev, imageRect, length, angle, channelFlags, 0, &executor);
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt,
+                                     dev->convertToQImage(0, imageRect),
+                                     concurrentDev->convertToQImage(0, imageRect)));
+}
+
+KISTEST_MAIN(KisMotionBlurTest)
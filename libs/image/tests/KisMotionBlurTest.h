@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISMOTIONBLURTEST_H
+#define KISMOTIONBLURTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisMotionBlurTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testAxisAligned_data();
+    void testAxisAligned();
+    void testDiagonalImpulse();
+    void testBlocksAreSeamless();
+    void testConcurrentBlocks();
+};
+
+#endif // KISMOTIONBLURTEST_H
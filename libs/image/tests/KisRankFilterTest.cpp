@@ -0,0 +1,196 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisRankFilterTest.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "KisRankFilter.h"
+#include "KisThreadPoolRunnableStrokeJobsExecutor.h"
+#include "kis_paint_device.h"
+#include "kis_pixel_selection.h"
+#include "kis_selection_filters.h"
+#include "kistest.h"
+#include "testutil.h"
+#include "testing_timed_default_bounds.h"
+
+namespace {
+
+template <typename T>
+QVector<quint8> bruteForceRank(const QVector<quint8> &bytes, const QSize &size,
+                               int numChannels, int radius, qreal percentile)
+{
+    const T *src = reinterpret_cast<const T*>(bytes.constData());
+    QVector<quint8> result(bytes.size());
+    T *dst = reinterpret_cast<T*>(result.data());
+
+    const int windowSize = (2 * radius + 1) * (2 * radius + 1);
+    const int rank = qRound(percentile / 100.0 * (windowSize - 1));
+
+    QVector<T> window;
+
+    for (int y = 0; y < size.height(); y++) {
+        for (int x = 0; x < size.width(); x++) {
+            for (int c = 0; c < numChannels; c++) {
+                window.clear();
+
+                for (int dy = -radius; dy <= radius; dy++) {
+                    for (int dx = -radius; dx <= radius; dx++) {
+                        // the pixels outside the image are the repeated edge pixels
+                        const int sx = qBound(0, x + dx, size.width() - 1);
+                        const int sy = qBound(0, y + dy, size.height() - 1);
+                        window.append(src[(sy * size.width() + sx) * numChannels + c]);
+                    }
+                }
+
+                std::nth_element(window.begin(), window.begin() + rank, window.end());
+                dst[(y * size.width() + x) * numChannels + c] = window[rank];
+            }
+        }
+    }
+
+    return result;
+}
+
+}
+
+void KisRankFilterTest::testRankFilter_data()
+{
+    QTest::addColumn<bool>("useU16");
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<qreal>("percentile");
+
+    QTest::newRow("u8-median") << false << 3 << 50.0;
+    QTest::newRow("u8-percentile") << false << 2 << 20.0;
+    QTest::newRow("u8-minimum") << false << 4 << 0.0;
+    QTest::newRow("u8-maximum") << false << 4 << 100.0;
+    QTest::newRow("u16-median") << true << 3 << 50.0;
+    QTest::newRow("u16-percentile") << true << 1 << 75.0;
+}
+
+void KisRankFilterTest::testRankFilter()
+{
+    QFETCH(bool, useU16);
+    QFETCH(int, radius);
+    QFETCH(qreal, percentile);
+
+    const KoColorSpace *cs = useU16 ?
+        KoColorSpaceRegistry::instance()->rgb16() :
+        KoColorSpaceRegistry::instance()->rgb8();
+
+    const QRect imageRect(0, 0, 90, 70);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    QVector<quint8> bytes(imageRect.width() * imageRect.height() * cs->pixelSize());
+    quint32 seed = 1;
+    for (int i = 0; i < bytes.size(); i++) {
+        seed = seed * 1103515245u + 12345u;
+        bytes[i] = quint8(seed >> 16);
+    }
+    dev->writeBytes(bytes.constData(), imageRect);
+
+    const QVector<quint8> reference = useU16 ?
+        bruteForceRank<quint16>(bytes, imageRect.size(), cs->channelCount(), radius, percentile) :
+        bruteForceRank<quint8>(bytes, imageRect.size(), cs->channelCount(), radius, percentile);
+
+    KisRankFilter::apply(dev, imageRect, radius, percentile, QBitArray(), 0);
+
+    QVector<quint8> result(bytes.size());
+    dev->readBytes(result.data(), imageRect);
+
+    QCOMPARE(result, reference);
+}
+
+void KisRankFilterTest::testBands_data()
+{
+    QTest::addColumn<bool>("useJobs");
+
+    QTest::newRow("serial") << false;
+    QTest::newRow("concurrent") << true;
+}
+
+void KisRankFilterTest::testBands()
+{
+    QFETCH(bool, useJobs);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const int radius = 3;
+
+    // the rect spans several bands and is not aligned to them
+    const QRect imageRect(-20, -100, 90, 600);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    QVector<quint8> bytes(imageRect.width() * imageRect.height() * cs->pixelSize());
+    quint32 seed = 2;
+    for (int i = 0; i < bytes.size(); i++) {
+        seed = seed * 1103515245u + 12345u;
+        bytes[i] = quint8(seed >> 16);
+    }
+    dev->writeBytes(bytes.constData(), imageRect);
+
+    const QVector<quint8> reference =
+        bruteForceRank<quint8>(bytes, imageRect.size(), cs->channelCount(), radius, 50.0);
+
+    KisThreadPoolRunnableStrokeJobsExecutor executor;
+    KisRankFilter::apply(dev, imageRect, radius, 50.0, QBitArray(), 0,
+                         useJobs ? &executor : 0);
+
+    QVector<quint8> result(bytes.size());
+    dev->readBytes(result.data(), imageRect);
+
+    // the bands must read the original pixels of their neighbours
+    QCOMPARE(result, reference);
+}
+
+void KisRankFilterTest::testGrowShrinkPolygon()
+{
+    const QRect imageRect(0, 0, 300, 300);
+    const QPoint center(150, 150);
+    const int radius = 100;
+
+    KisPixelSelectionSP selection = new KisPixelSelection(new TestUtil::TestingTimedDefaultBounds(imageRect));
+    selection->select(QRect(center, QSize(1, 1)));
+
+    QVERIFY(radius >= KisRankFilter::polygonMinimumRadius);
+
+    KisGrowSelectionFilter grow(radius, radius);
+    const QRect growRect = grow.changeRect(QRect(center, QSize(1, 1)), selection->defaultBounds());
+    grow.process(selection, growRect);
+
+    QCOMPARE(selection->selectedExactRect(), QRect(center.x() - radius, center.y() - radius,
+                                                   2 * radius + 1, 2 * radius + 1));
+
+    // the polygon is circumscribed around the circle and deviates by less than 3%
+    for (int y = imageRect.top(); y <= imageRect.bottom(); y++) {
+        for (int x = imageRect.left(); x <= imageRect.right(); x++) {
+            const qreal distance = std::hypot(x - center.x(), y - center.y());
+            const bool selected = selection->pixel(QPoint(x, y)).opacityU8() > 0;
+
+            if (distance <= radius - 0.5) {
+                QVERIFY(selected);
+            } else if (distance > 1.03 * radius) {
+                QVERIFY(!selected);
+            }
+        }
+    }
+
+    // shrinking the polygon by the same radius leaves just the center
+    KisShrinkSelectionFilter shrink(radius, radius, false);
+    shrink.process(selection, selection->selectedExactRect());
+
+    QCOMPARE(selection->selectedExactRect(), QRect(center, QSize(1, 1)));
+}
+
+KISTEST_MAIN(KisRankFilterTest)
@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISRANKFILTERTEST_H
+#define KISRANKFILTERTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisRankFilterTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRankFilter_data();
+    void testRankFilter();
+    void testBands_data();
+    void testBands();
+    void testGrowShrinkPolygon();
+};
+
+#endif // KISRANKFILTERTEST_H
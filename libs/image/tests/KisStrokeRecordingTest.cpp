@@ -0,0 +1,130 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisStrokeRecordingTest.h"
+
+#include <QBuffer>
+
+#include "brushengine/KisStrokeRecording.h"
+
+#include <simpletest.h>
+
+namespace {
+
+void comparePaintInformation(const KisPaintInformation &pi1, const KisPaintInformation &pi2)
+{
+    // the recording is stored in single precision
+    QVERIFY(qFuzzyCompare(float(pi1.pos().x()), float(pi2.pos().x())));
+    QVERIFY(qFuzzyCompare(float(pi1.pos().y()), float(pi2.pos().y())));
+    QVERIFY(qFuzzyCompare(float(pi1.pressure()), float(pi2.pressure())));
+    QVERIFY(qFuzzyCompare(float(pi1.xTilt()), float(pi2.xTilt())));
+    QVERIFY(qFuzzyCompare(float(pi1.yTilt()), float(pi2.yTilt())));
+    QVERIFY(qFuzzyCompare(float(pi1.rotation()), float(pi2.rotation())));
+    QVERIFY(qFuzzyCompare(float(pi1.currentTime()), float(pi2.currentTime())));
+    QVERIFY(qFuzzyCompare(float(pi1.canvasRotation()), float(pi2.canvasRotation())));
+    QCOMPARE(pi1.canvasMirroredH(), pi2.canvasMirroredH());
+    QCOMPARE(pi1.canvasMirroredV(), pi2.canvasMirroredV());
+}
+
+}
+
+void KisStrokeRecordingTest::testSaveLoad()
+{
+    KisStrokeRecording recording;
+
+    KisPaintInformation pi1(QPointF(10.5, 20.25), 0.3, 15, -20, 30, 0.0, 1.0, 125.0, 0.0);
+    KisPaintInformation pi2(QPointF(100.5, 70.75), 0.8, 40, 10, 90, 0.0, 1.0, 133.0, 0.0);
+    pi2.setCanvasRotation(45.0);
+    pi2.setCanvasMirroredH(true);
+
+    recording.beginStroke();
+    recording.addPaintAt(0, pi1);
+    recording.addPaintLine(1, pi1, pi2);
+
+    recording.beginStroke();
+    recording.addPaintBezierCurve(0, pi1, QPointF(30, 40), QPointF(50, 60), pi2);
+
+    QCOMPARE(recording.strokes().size(), 2);
+    QCOMPARE(recording.numEvents(), 3);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY(recording.save(&buffer));
+
+    buffer.seek(0);
+
+    KisStrokeRecording loaded;
+    QVERIFY(loaded.load(&buffer));
+
+    QCOMPARE(loaded.strokes().size(), 2);
+    QCOMPARE(loaded.numEvents(), 3);
+
+    for (int i = 0; i < recording.strokes().size(); i++) {
+        const KisStrokeRecording::Stroke &stroke = recording.strokes()[i];
+        const KisStrokeRecording::Stroke &loadedStroke = loaded.strokes()[i];
+
+        QCOMPARE(loadedStroke.events.size(), stroke.events.size());
+
+        for (int j = 0; j < stroke.events.size(); j++) {
+            const KisStrokeRecording::Event &event = stroke.events[j];
+            const KisStrokeRecording::Event &loadedEvent = loadedStroke.events[j];
+
+            QCOMPARE(loadedEvent.type, event.type);
+            QCOMPARE(loadedEvent.strokeInfoId, event.strokeInfoId);
+            QCOMPARE(loadedEvent.timestamp, event.timestamp);
+
+            comparePaintInformation(loadedEvent.pi1, event.pi1);
+
+            if (event.type != KisStrokeRecording::PaintAt) {
+                comparePaintInformation(loadedEvent.pi2, event.pi2);
+            }
+
+            if (event.type == KisStrokeRecording::PaintBezierCurve) {
+                QCOMPARE(loadedEvent.control1, event.control1);
+                QCOMPARE(loadedEvent.control2, event.control2);
+            }
+        }
+    }
+}
+
+void KisStrokeRecordingTest::testLoadCorrupted()
+{
+    QByteArray data("definitely not a stroke recording");
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+
+    KisStrokeRecording recording;
+    recording.beginStroke();
+    recording.addPaintAt(0, KisPaintInformation(QPointF(1, 1)));
+
+    QVERIFY(!recording.load(&buffer));
+
+    // the failed load doesn't change the recording
+    QCOMPARE(recording.numEvents(), 1);
+}
+
+void KisStrokeRecordingTest::testLatencyPercentiles()
+{
+    KisStrokeRecording::ReplayStatistics stats;
+
+    QCOMPARE(stats.latencyPercentile(50), qint64(0));
+    QCOMPARE(stats.dabsPerSecond(), 0.0);
+
+    for (int i = 1; i <= 100; i++) {
+        stats.dabLatencies.append(i * 1000);
+    }
+    stats.numDabs = 100;
+    stats.wallTime = 50000000; // 50 ms
+
+    QCOMPARE(stats.latencyPercentile(50), qint64(50000));
+    QCOMPARE(stats.latencyPercentile(90), qint64(90000));
+    QCOMPARE(stats.latencyPercentile(99), qint64(99000));
+    QCOMPARE(stats.latencyPercentile(100), qint64(100000));
+    QCOMPARE(stats.dabsPerSecond(), 2000.0);
+}
+
+SIMPLE_TEST_MAIN(KisStrokeRecordingTest)
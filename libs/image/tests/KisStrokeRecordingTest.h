@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSTROKERECORDINGTEST_H
+#define KISSTROKERECORDINGTEST_H
+
+#include <simpletest.h>
+
+class KisStrokeRecordingTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSaveLoad();
+    void testLoadCorrupted();
+    void testLatencyPercentiles();
+};
+
+#endif // KISSTROKERECORDINGTEST_H
@@ -0,0 +1,270 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTiledHistogramTest.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <KoColor.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoChannelInfo.h>
+
+#include "KisTiledHistogram.h"
+#include "KisThreadPoolRunnableStrokeJobsExecutor.h"
+#include "kis_paint_device.h"
+#include "kistest.h"
+#include "testutil.h"
+#include "testing_timed_default_bounds.h"
+
+namespace {
+
+typedef std::vector<std::vector<quint32>> Histogram;
+
+quint32 noise(int x, int y, quint32 seed)
+{
+    // a deterministic pseudo-random noise
+    quint32 hash = quint32(x) * 73856093u ^ quint32(y) * 19349663u ^ seed * 83492791u;
+    hash ^= hash >> 13;
+    hash *= 0x5bd1e995u;
+    hash ^= hash >> 15;
+    return hash;
+}
+
+KisPaintDeviceSP createNoisyDevice(const KoColorSpace *cs, const QRect &rect, quint32 seed)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(rect));
+
+    const int pixelSize = cs->pixelSize();
+    QVector<quint8> pixels(rect.width() * rect.height() * pixelSize);
+    quint8 *ptr = pixels.data();
+
+    for (int y = 0; y < rect.height(); y++) {
+        for (int x = 0; x < rect.width(); x++) {
+            Q_FOREACH (const KoChannelInfo *channel, cs->channels()) {
+                const quint32 value = noise(x, y, seed + channel->pos());
+
+                if (channel->channelValueType() == KoChannelInfo::FLOAT32) {
+                    // exact in float, and some of the values are out of the range
+                    const float floatValue = (int(value % 1400) - 200) / 1024.0f;
+                    std::memcpy(ptr + channel->pos(), &floatValue, sizeof(float));
+                } else {
+                    std::memcpy(ptr + channel->pos(), &value, channel->size());
+                }
+            }
+            ptr += pixelSize;
+        }
+    }
+
+    dev->writeBytes(pixels.data(), rect);
+    return dev;
+}
+
+Histogram referenceHistogram(KisPaintDeviceSP dev, const QRect &rect, int numBins)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+    const QList<KoChannelInfo*> channels = cs->channels();
+    const int pixelSize = cs->pixelSize();
+
+    Histogram result(channels.size(), std::vector<quint32>(numBins, 0));
+
+    QVector<quint8> pixels(rect.width() * rect.height() * pixelSize);
+    dev->readBytes(pixels.data(), rect);
+
+    for (int i = 0; i < rect.width() * rect.height(); i++) {
+        const quint8 *pixel = pixels.data() + i * pixelSize;
+
+        for (int c = 0; c < channels.size(); c++) {
+            const KoChannelInfo *channel = channels[c];
+            const quint8 *ptr = pixel + channel->pos();
+
+            qreal value = 0;
+
+            if (channel->channelValueType() == KoChannelInfo::UINT8) {
+                value = *ptr / 256.0;
+            } else if (channel->channelValueType() == KoChannelInfo::UINT16) {
+                value = *reinterpret_cast<const quint16*>(ptr) / 65536.0;
+            } else if (channel->channelValueType() == KoChannelInfo::FLOAT32) {
+                const qreal min = channel->getUIMin();
+                const qreal max = channel->getUIMax() > min ? channel->getUIMax() : min + 1.0;
+                value = (*reinterpret_cast<const float*>(ptr) - min) / (max - min);
+            }
+
+            result[c][qBound(0, int(std::floor(value * numBins)), numBins - 1)]++;
+        }
+    }
+
+    return result;
+}
+
+bool compareHistograms(const KisTiledHistogram &histogram, const Histogram &reference)
+{
+    for (int c = 0; c < int(reference.size()); c++) {
+        const std::vector<quint32> bins = histogram.bins(c);
+
+        for (int i = 0; i < int(reference[c].size()); i++) {
+            if (bins[i] != reference[c][i]) {
+                qWarning() << "Channel" << c << "bin" << i << "differs:"
+                           << "got" << bins[i] << "expected" << reference[c][i];
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+void KisTiledHistogramTest::testFullHistogram_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<int>("numBins");
+
+    QTest::newRow("u8") << Integer8BitsColorDepthID.id() << 256;
+    QTest::newRow("u8-64") << Integer8BitsColorDepthID.id() << 64;
+    QTest::newRow("u16") << Integer16BitsColorDepthID.id() << 256;
+    QTest::newRow("u16-1024") << Integer16BitsColorDepthID.id() << 1024;
+    QTest::newRow("f32") << Float32BitsColorDepthID.id() << 256;
+}
+
+void KisTiledHistogramTest::testFullHistogram()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(int, numBins);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+    QVERIFY(cs);
+
+    // the rect is not aligned to the cells
+    const QRect rect(-70, -30, 300, 200);
+    KisPaintDeviceSP dev = createNoisyDevice(cs, rect, 1);
+
+    KisTiledHistogram histogram(numBins);
+    histogram.update(dev, rect);
+
+    QCOMPARE(histogram.colorSpace(), cs);
+    QCOMPARE(histogram.count(), quint64(rect.width() * rect.height()));
+    QVERIFY(compareHistograms(histogram, referenceHistogram(dev, rect, numBins)));
+}
+
+void KisTiledHistogramTest::testIncrementalUpdate()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(-70, -30, 300, 200);
+    KisPaintDeviceSP dev = createNoisyDevice(cs, rect, 2);
+
+    KisTiledHistogram histogram;
+    histogram.update(dev, rect);
+
+    const Histogram initialReference = referenceHistogram(dev, rect, 256);
+    QVERIFY(compareHistograms(histogram, initialReference));
+
+    const QRect changedRect(120, 60, 20, 10);
+    dev->fill(changedRect, KoColor(QColor(10, 20, 30), cs));
+
+    // the cells not marked as dirty are not recounted
+    histogram.update(dev, rect);
+    QVERIFY(compareHistograms(histogram, initialReference));
+
+    histogram.setDirty(changedRect);
+    histogram.update(dev, rect);
+    QVERIFY(compareHistograms(histogram, referenceHistogram(dev, rect, 256)));
+    QCOMPARE(histogram.count(), quint64(rect.width() * rect.height()));
+}
+
+void KisTiledHistogramTest::testBoundsChange()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(-70, -30, 300, 200);
+    KisPaintDeviceSP dev = createNoisyDevice(cs, rect, 3);
+
+    KisTiledHistogram histogram;
+    histogram.update(dev, rect);
+
+    const QRect smallerRect(-20, 5, 150, 90);
+    histogram.update(dev, smallerRect);
+    QCOMPARE(histogram.count(), quint64(smallerRect.width() * smallerRect.height()));
+    QVERIFY(compareHistograms(histogram, referenceHistogram(dev, smallerRect, 256)));
+
+    histogram.update(dev, rect);
+    QCOMPARE(histogram.count(), quint64(rect.width() * rect.height()));
+    QVERIFY(compareHistograms(histogram, referenceHistogram(dev, rect, 256)));
+}
+
+void KisTiledHistogramTest::testContentChangeWithSameBounds()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(-70, -30, 300, 200);
+    KisPaintDeviceSP dev = createNoisyDevice(cs, rect, 6);
+
+    KisTiledHistogram histogram;
+    histogram.update(dev, rect);
+
+    const Histogram initialReference = referenceHistogram(dev, rect, 256);
+    QVERIFY(compareHistograms(histogram, initialReference));
+
+    // the whole content is replaced, e.g. another frame is shown
+    // or the image is cropped to the same size
+    KisPaintDeviceSP otherDev = createNoisyDevice(cs, rect, 7);
+
+    // the bounds and the color space are the same, so nothing is recounted
+    histogram.update(otherDev, rect);
+    QVERIFY(compareHistograms(histogram, initialReference));
+
+    histogram.setDirty(rect);
+    histogram.update(otherDev, rect);
+    QCOMPARE(histogram.count(), quint64(rect.width() * rect.height()));
+    QVERIFY(compareHistograms(histogram, referenceHistogram(otherDev, rect, 256)));
+
+    histogram.clear();
+    histogram.update(dev, rect);
+    QCOMPARE(histogram.count(), quint64(rect.width() * rect.height()));
+    QVERIFY(compareHistograms(histogram, initialReference));
+}
+
+void KisTiledHistogramTest::testColorSpaceChange()
+{
+    const QRect rect(0, 0, 200, 150);
+    KisPaintDeviceSP dev = createNoisyDevice(KoColorSpaceRegistry::instance()->rgb8(), rect, 4);
+
+    KisTiledHistogram histogram;
+    histogram.update(dev, rect);
+
+    dev->convertTo(KoColorSpaceRegistry::instance()->rgb16());
+
+    histogram.update(dev, rect);
+    QCOMPARE(histogram.colorSpace(), dev->colorSpace());
+    QCOMPARE(histogram.count(), quint64(rect.width() * rect.height()));
+    QVERIFY(compareHistograms(histogram, referenceHistogram(dev, rect, 256)));
+}
+
+void KisTiledHistogramTest::testConcurrentUpdate()
+{
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), 0);
+    QVERIFY(cs);
+
+    const QRect rect(0, 0, 900, 700);
+    KisPaintDeviceSP dev = createNoisyDevice(cs, rect, 5);
+
+    KisThreadPoolRunnableStrokeJobsExecutor executor;
+
+    KisTiledHistogram histogram;
+    histogram.update(dev, rect, &executor);
+    QVERIFY(compareHistograms(histogram, referenceHistogram(dev, rect, 256)));
+
+    const QRect changedRect(250, 300, 400, 10);
+    dev->fill(changedRect, KoColor(QColor(200, 100, 50), cs));
+
+    histogram.setDirty(changedRect);
+    histogram.update(dev, rect, &executor);
+    QVERIFY(compareHistograms(histogram, referenceHistogram(dev, rect, 256)));
+}
+
+KISTEST_MAIN(KisTiledHistogramTest)
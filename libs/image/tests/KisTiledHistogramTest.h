@@ -0,0 +1,27 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTILEDHISTOGRAMTEST_H
+#define KISTILEDHISTOGRAMTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisTiledHistogramTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testFullHistogram_data();
+    void testFullHistogram();
+    void testIncrementalUpdate();
+    void testBoundsChange();
+    void testContentChangeWithSameBounds();
+    void testColorSpaceChange();
+    void testConcurrentUpdate();
+};
+
+#endif // KISTILEDHISTOGRAMTEST_H
@@ -22,6 +22,7 @@
 #include <kis_gaussian_kernel.h>
 #include <kis_mask_generator.h>
 #include <kistest.h>
+#include <KisThreadPoolRunnableStrokeJobsExecutor.h>
 #include "testutil.h"
 #include "testing_timed_default_bounds.h"
 
@@ -581,4 +582,215 @@ void KisConvolutionPainterTest::testNormalMapFFTW()
     testNormalMap(true);
 }
 
+#include "KisRecursiveGaussian.h"
+
+void KisConvolutionPainterTest::testRecursiveGaussian_data()
+{
+    QTest::addColumn<qreal>("horizontalRadius");
+    QTest::addColumn<qreal>("verticalRadius");
+
+    QTest::newRow("both") << 60.0 << 60.0;
+    QTest::newRow("horizontal") << 60.0 << 0.0;
+    QTest::newRow("vertical") << 0.0 << 80.0;
+}
+
+void KisConvolutionPainterTest::testRecursiveGaussian()
+{
+    QFETCH(qreal, horizontalRadius);
+    QFETCH(qreal, verticalRadius);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect imageRect(0, 0, 300, 200);
+    dev->fill(imageRect, KoColor(Qt::white, cs));
+    dev->fill(QRect(50, 40, 120, 30), KoColor(Qt::red, cs));
+    dev->fill(QRect(150, 60, 40, 100), KoColor(Qt::blue, cs));
+    dev->clear(QRect(230, 20, 30, 160));
+
+    KisDefaultBoundsBaseSP bounds = new TestUtil::TestingTimedDefaultBounds(imageRect);
+    dev->setDefaultBounds(bounds);
+
+    const QRect applyRect(20, 10, 260, 180);
+    const QBitArray channelFlags = cs->channelFlags(true, true);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(*dev);
+    KisPaintDeviceSP interm = new KisPaintDevice(cs);
+    interm->prepareClone(reference);
+
+    KisPaintDeviceSP src = reference;
+    QRect horizontalRect = applyRect;
+
+    if (horizontalRadius > 0.0) {
+        KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(horizontalRadius);
+
+        if (verticalRadius > 0.0) {
+            const int halfHeight = KisGaussianKernel::kernelSizeFromRadius(verticalRadius) / 2;
+            horizontalRect.adjust(0, -halfHeight, 0, halfHeight);
+        }
+
+        KisConvolutionPainter horizPainter(interm, KisConvolutionPainter::SPATIAL);
+        horizPainter.setChannelFlags(channelFlags);
+        horizPainter.applyMatrix(kernelHoriz, src,
+                                 horizontalRect.topLeft(), horizontalRect.topLeft(),
+                                 horizontalRect.size(), BORDER_REPEAT);
+        src = interm;
+    }
+
+    if (verticalRadius > 0.0) {
+        KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(verticalRadius);
+
+        KisConvolutionPainter verticalPainter(reference, KisConvolutionPainter::SPATIAL);
+        verticalPainter.setChannelFlags(channelFlags);
+        verticalPainter.applyMatrix(kernelVertical, src,
+                                    applyRect.topLeft(), applyRect.topLeft(),
+                                    applyRect.size(), BORDER_REPEAT);
+    } else {
+        KisPainter::copyAreaOptimized(applyRect.topLeft(), interm, reference, applyRect);
+    }
+
+    KisRecursiveGaussian::apply(dev, applyRect, horizontalRadius, verticalRadius, channelFlags, 0);
+
+    QImage referenceImage = reference->convertToQImage(0, imageRect);
+    QImage resultImage = dev->convertToQImage(0, imageRect);
+
+    QPoint pt;
+    if (!TestUtil::compareQImages(pt, referenceImage, resultImage, 4, 4)) {
+        referenceImage.save(QString("recursive_gaussian_%1_reference.png").arg(QTest::currentDataTag()));
+        resultImage.save(QString("recursive_gaussian_%1_result.png").arg(QTest::currentDataTag()));
+        QFAIL(QString("Recursive gaussian differs from the convolution at (%1, %2)").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
+void KisConvolutionPainterTest::testFFTWBlocks()
+{
+    if (!KisConvolutionPainter::supportsFFTW()) {
+        QSKIP("FFTW is not available");
+    }
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect imageRect(0, 0, 700, 500);
+
+    // the area is big enough to be split into several blocks
+    QImage referenceImage(TestUtil::fetchDataFileLazy("kritaTransparent.png"));
+    dev->convertFromQImage(referenceImage.scaled(imageRect.size()), 0, 0, 0);
+
+    KisDefaultBoundsBaseSP bounds = new TestUtil::TestingTimedDefaultBounds(imageRect);
+    dev->setDefaultBounds(bounds);
+
+    const QRect applyRect = imageRect.adjusted(10, 20, -30, -40);
+    KisConvolutionKernelSP kernel = KisGaussianKernel::createUniform2DKernel(20, 20);
+
+    KisPaintDeviceSP spatialDev = new KisPaintDevice(*dev);
+
+    {
+        KisTransaction transaction(spatialDev);
+        KisConvolutionPainter painter(spatialDev, KisConvolutionPainter::SPATIAL);
+        painter.applyMatrix(kernel, spatialDev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+    }
+
+    {
+        // the in-place convolution needs no transaction
+        KisConvolutionPainter painter(dev, KisConvolutionPainter::FFTW);
+        painter.applyMatrix(kernel, dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+    }
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt,
+                                     spatialDev->convertToQImage(0, imageRect),
+                                     dev->convertToQImage(0, imageRect),
+                                     1, 1));
+}
+
+void KisConvolutionPainterTest::testFFTWBlocksConcurrent()
+{
+    if (!KisConvolutionPainter::supportsFFTW()) {
+        QSKIP("FFTW is not available");
+    }
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect imageRect(0, 0, 700, 500);
+
+    // the area is big enough to be split into several blocks
+    QImage referenceImage(TestUtil::fetchDataFileLazy("kritaTransparent.png"));
+    dev->convertFromQImage(referenceImage.scaled(imageRect.size()), 0, 0, 0);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    const QRect applyRect = imageRect.adjusted(10, 20, -30, -40);
+    KisConvolutionKernelSP kernel = KisGaussianKernel::createUniform2DKernel(20, 20);
+
+    KisPaintDeviceSP concurrentDev = new KisPaintDevice(*dev);
+
+    {
+        KisConvolutionPainter painter(dev, KisConvolutionPainter::FFTW);
+        painter.applyMatrix(kernel, dev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+    }
+
+    {
+        // the blocks are convolved in place on the global thread pool
+        KisThreadPoolRunnableStrokeJobsExecutor executor;
+        KisConvolutionPainter painter(concurrentDev, KisConvolutionPainter::FFTW);
+        painter.setRunnableStrokeJobsInterface(&executor);
+        painter.applyMatrix(kernel, concurrentDev, applyRect.topLeft(), applyRect.topLeft(), applyRect.size(), BORDER_REPEAT);
+    }
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt,
+                                     dev->convertToQImage(0, imageRect),
+                                     concurrentDev->convertToQImage(0, imageRect)));
+}
+
+void KisConvolutionPainterTest::testFFTWKernelSpectrumCache()
+{
+    if (!KisConvolutionPainter::supportsFFTW()) {
+        QSKIP("FFTW is not available");
+    }
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect imageRect(0, 0, 300, 200);
+
+    QImage referenceImage(TestUtil::fetchDataFileLazy("kritaTransparent.png"));
+    dev->convertFromQImage(referenceImage.scaled(imageRect.size()), 0, 0, 0);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    // the kernels of the same size differ only in one coefficient
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> uniform =
+        Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>::Ones(9, 9);
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> skewed = uniform;
+    skewed(0, 0) = 40.0;
+
+    QList<KisConvolutionKernelSP> kernels;
+    kernels << KisConvolutionKernel::fromMatrix(uniform, 0, uniform.sum());
+    kernels << KisConvolutionKernel::fromMatrix(skewed, 0, skewed.sum());
+    kernels << KisConvolutionKernel::fromMatrix(uniform, 0, uniform.sum());
+
+    Q_FOREACH (KisConvolutionKernelSP kernel, kernels) {
+        KisPaintDeviceSP spatialDev = new KisPaintDevice(*dev);
+        KisPaintDeviceSP fftwDev = new KisPaintDevice(*dev);
+
+        {
+            KisTransaction transaction(spatialDev);
+            KisConvolutionPainter painter(spatialDev, KisConvolutionPainter::SPATIAL);
+            painter.applyMatrix(kernel, spatialDev, imageRect.topLeft(), imageRect.topLeft(), imageRect.size(), BORDER_REPEAT);
+        }
+
+        {
+            KisConvolutionPainter painter(fftwDev, KisConvolutionPainter::FFTW);
+            painter.applyMatrix(kernel, fftwDev, imageRect.topLeft(), imageRect.topLeft(), imageRect.size(), BORDER_REPEAT);
+        }
+
+        QPoint pt;
+        QVERIFY(TestUtil::compareQImages(pt,
+                                         spatialDev->convertToQImage(0, imageRect),
+                                         fftwDev->convertToQImage(0, imageRect),
+                                         1, 1));
+    }
+}
+
 KISTEST_MAIN(KisConvolutionPainterTest)
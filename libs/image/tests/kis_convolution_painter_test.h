@@ -52,6 +52,13 @@ private Q_SLOTS:
 
     void testNormalMapSpatial();
     void testNormalMapFFTW();
+
+    void testRecursiveGaussian_data();
+    void testRecursiveGaussian();
+
+    void testFFTWBlocks();
+    void testFFTWBlocksConcurrent();
+    void testFFTWKernelSpectrumCache();
 };
 
 #endif
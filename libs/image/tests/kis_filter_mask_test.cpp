@@ -10,6 +10,7 @@
 #include <KoColorSpaceRegistry.h>
 
 #include "kis_selection.h"
+#include "kis_pixel_selection.h"
 #include "filter/kis_filter.h"
 #include "filter/kis_filter_configuration.h"
 #include "kis_filter_mask.h"
@@ -20,6 +21,7 @@
 #include "kis_types.h"
 #include "kis_image.h"
 #include <KisGlobalResourcesInterface.h>
+#include "KisColorTransformationMasksChain.h"
 
 
 #include <testutil.h>
@@ -97,5 +99,82 @@ void KisFilterMaskTest::testProjectionSelected()
     }
 
 }
+void KisFilterMaskTest::testFusedColorTransformationMasks()
+{
+    TestUtil::MaskParent p(QRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT));
+    KisImageSP image = p.image;
+    KisPaintLayerSP layer = p.layer;
+
+    QImage qimage(QString(FILES_DATA_DIR) + '/' + "hakonepa.png");
+    layer->paintDevice()->convertFromQImage(qimage, 0, 0, 0);
+
+    KisFilterSP invert = KisFilterRegistry::instance()->value("invert");
+    Q_ASSERT(invert);
+    KisFilterConfigurationSP invertConfig =
+        invert->defaultConfiguration(KisGlobalResourcesInterface::instance())->cloneWithResourcesSnapshot();
+
+    KisFilterSP hsv = KisFilterRegistry::instance()->value("hsvadjustment");
+    Q_ASSERT(hsv);
+    KisFilterConfigurationSP hsvConfig = hsv->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    hsvConfig->setProperty("v", 40);
+    hsvConfig = hsvConfig->cloneWithResourcesSnapshot();
+
+    /**
+     * Brightening and inversion don't commute, so the fused
+     * masks must be applied in the order of the stack
+     */
+    const QList<QPair<KisFilterSP, KisFilterConfigurationSP>> filters =
+        {{invert, invertConfig}, {hsv, hsvConfig}, {invert, invertConfig}};
+
+    KisPaintDeviceSP reference = new KisPaintDevice(*layer->paintDevice());
+    KisPaintDeviceSP reversedReference = new KisPaintDevice(*layer->paintDevice());
+
+    for (int i = 0; i < filters.size(); i++) {
+        filters[i].first->process(reference, qimage.rect(), filters[i].second);
+        filters[filters.size() - 1 - i].first->process(reversedReference, qimage.rect(),
+                                                       filters[filters.size() - 1 - i].second);
+    }
+
+    const QImage referenceImage = reference->convertToQImage(0, qimage.rect());
+
+    QPoint errpoint;
+    QVERIFY(!TestUtil::compareQImages(errpoint, referenceImage,
+                                      reversedReference->convertToQImage(0, qimage.rect())));
+
+    QList<KisFilterMaskSP> masks;
+
+    for (int i = 0; i < filters.size(); i++) {
+        KisFilterMaskSP mask = new KisFilterMask(image, QString("mask%1").arg(i));
+        mask->setFilter(filters[i].second->cloneWithResourcesSnapshot());
+        mask->createNodeProgressProxy();
+
+        // the masks created in the UI have a fully selected selection
+        if (i == 1) {
+            mask->initSelection(layer);
+        }
+
+        image->addNode(mask, layer);
+        masks.append(mask);
+
+        QVERIFY(KisColorTransformationMasksChain::canFuseMask(mask, qimage.rect()));
+    }
+
+    layer->setDirty(qimage.rect());
+    image->waitForDone();
+
+    if (!TestUtil::compareQImages(errpoint, referenceImage, layer->projection()->convertToQImage(0, qimage.rect()))) {
+        layer->projection()->convertToQImage(0, qimage.rect()).save("filtermasktest3.png");
+        QFAIL(QString("Fused masks differ from the masks applied one by one, first different pixel: %1,%2 ").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+
+    // a mask with a partial selection is applied on its own
+    const QRect selectedRect(10, 10, 50, 50);
+    masks[1]->selection()->pixelSelection()->clear();
+    masks[1]->selection()->pixelSelection()->select(selectedRect, MAX_SELECTED);
+
+    QVERIFY(!KisColorTransformationMasksChain::canFuseMask(masks[1], qimage.rect()));
+    QVERIFY(KisColorTransformationMasksChain::canFuseMask(masks[1], selectedRect));
+    QVERIFY(KisColorTransformationMasksChain::canFuseMask(masks[0], qimage.rect()));
+}
 
 SIMPLE_TEST_MAIN(KisFilterMaskTest)
@@ -21,6 +21,7 @@
 #include <KoProgressUpdater.h>
 #include <KoUpdater.h>
 #include "testing_timed_default_bounds.h"
+#include <KisThreadPoolRunnableStrokeJobsExecutor.h>
 
 class TestFilter : public KisFilter
 {
@@ -42,6 +43,48 @@ public:
 
 };
 
+class BlockedTestFilter : public KisFilter
+{
+public:
+
+    BlockedTestFilter()
+            : KisFilter(KoID("blockedtest", "blockedtest"), KoID("test", "test"), "BlockedTestFilter") {
+        setSupportsThreading(true);
+    }
+
+    void processImpl(KisPaintDeviceSP src,
+                     const QRect& size,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater* progressUpdater) const override {
+        Q_UNUSED(src);
+        Q_UNUSED(config);
+        Q_UNUSED(progressUpdater);
+        processedRects.append(size);
+    }
+
+    bool supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const override {
+        Q_UNUSED(config);
+        Q_UNUSED(lod);
+        return true;
+    }
+
+    void processImplBlocked(KisPaintDeviceSP src,
+                            const QRect& size,
+                            const KisFilterConfigurationSP config,
+                            KoUpdater* progressUpdater,
+                            KisRunnableStrokeJobsInterface *jobsInterface) const override {
+        Q_UNUSED(src);
+        Q_UNUSED(config);
+        Q_UNUSED(progressUpdater);
+        blockedRects.append(size);
+        hadJobsInterface = jobsInterface;
+    }
+
+    mutable QVector<QRect> processedRects;
+    mutable QVector<QRect> blockedRects;
+    mutable bool hadJobsInterface {false};
+};
+
 void KisFilterTest::testCreation()
 {
     TestFilter test;
@@ -237,5 +280,79 @@ void KisFilterTest::testBlurFilterApplicationRect()
     QVERIFY(TestUtil::compareQImages(pt, refImage, dst2Image));
 }
 
+void KisFilterTest::testConcurrentProcessing()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    QImage qimage(QString(FILES_DATA_DIR) + '/' + "hakonepa.png");
+    KisPaintDeviceSP sequentialDev = new KisPaintDevice(cs);
+    sequentialDev->convertFromQImage(qimage, 0, 0, 0);
+    sequentialDev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(sequentialDev->exactBounds()));
+
+    KisPaintDeviceSP concurrentDev = new KisPaintDevice(*sequentialDev);
+
+    KisFilterSP f = KisFilterRegistry::instance()->value("blur");
+    Q_ASSERT(f);
+    KisFilterConfigurationSP  kfc = f->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    Q_ASSERT(kfc);
+
+    // not aligned to the tiles, so the chunks have partial tiles and halos
+    const QRect filterRect(10, 20, qimage.width() - 30, qimage.height() - 40);
+
+    /**
+     * The small kernel is convolved spatially, so the area is split into
+     * chunks. The big one may be convolved with FFT, then the filter
+     * processes the blocks concurrently itself.
+     */
+    Q_FOREACH (int halfSize, QVector<int>({2, 20})) {
+        kfc->setProperty("halfWidth", halfSize);
+        kfc->setProperty("halfHeight", halfSize);
+
+        KisPaintDeviceSP sequentialResult = new KisPaintDevice(*sequentialDev);
+        KisPaintDeviceSP concurrentResult = new KisPaintDevice(*concurrentDev);
+
+        f->process(sequentialResult, filterRect, kfc->cloneWithResourcesSnapshot());
+
+        // filter in place, so the chunks must not read the already filtered pixels
+        KisThreadPoolRunnableStrokeJobsExecutor executor;
+        f->process(concurrentResult, concurrentResult, 0, filterRect, kfc->cloneWithResourcesSnapshot(), 0, &executor);
+
+        QImage sequentialImage = sequentialResult->convertToQImage(0, 0, 0, qimage.width(), qimage.height());
+        QImage concurrentImage = concurrentResult->convertToQImage(0, 0, 0, qimage.width(), qimage.height());
+
+        QPoint pt;
+        QVERIFY(TestUtil::compareQImages(pt, sequentialImage, concurrentImage));
+    }
+}
+
+void KisFilterTest::testBlockedProcessing()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    const QRect rect(0, 0, 1000, 700);
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(rect));
+
+    BlockedTestFilter f;
+    KisFilterConfigurationSP kfc =
+        f.defaultConfiguration(KisGlobalResourcesInterface::instance())->cloneWithResourcesSnapshot();
+
+    f.process(dev, rect, kfc);
+
+    // without an interface the filter is processed as usual
+    QCOMPARE(f.processedRects, QVector<QRect>({rect}));
+    QVERIFY(f.blockedRects.isEmpty());
+
+    f.processedRects.clear();
+
+    KisThreadPoolRunnableStrokeJobsExecutor executor;
+    f.process(dev, dev, 0, rect, kfc, 0, &executor);
+
+    // the area is not split into chunks, the filter splits it itself
+    QVERIFY(f.processedRects.isEmpty());
+    QCOMPARE(f.blockedRects, QVector<QRect>({rect}));
+    QVERIFY(f.hadJobsInterface);
+}
+
 
 SIMPLE_TEST_MAIN(KisFilterTest)
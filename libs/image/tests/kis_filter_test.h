@@ -20,6 +20,8 @@ private Q_SLOTS:
     void testDifferentSrcAndDst();
     void testOldDataApiAfterCopy();
     void testBlurFilterApplicationRect();
+    void testConcurrentProcessing();
+    void testBlockedProcessing();
 };
 
 #endif
@@ -36,7 +36,8 @@ class KisMaskSimilarityTester
 {
 
 public:
-    KisMaskSimilarityTester(KisBrushMaskApplicatorBase *_legacy, KisBrushMaskApplicatorBase *_vectorized,  QRect _bounds, MaskType type)
+    KisMaskSimilarityTester(KisBrushMaskApplicatorBase *_legacy, KisBrushMaskApplicatorBase *_vectorized,  QRect _bounds, MaskType type,
+                            int fuzzy = 0, int maxNumFailingPixels = 0)
         : legacy(_legacy)
         , vectorized(_vectorized)
         , m_bounds(_bounds)
@@ -65,9 +66,9 @@ public:
         QImage vectorImage(m_paintDev->convertToQImage(m_colorSpace->profile()));
         vectorImage.invertPixels(); // Make pixel color black
 
-        // Check for differences, max errors: 0
+        // Check for differences, max errors: 0 by default
         QPoint tmpPt;
-        if (!TestUtil::compareQImages(tmpPt,scalarImage, vectorImage, 0, 2, 0)) {
+        if (!TestUtil::compareQImages(tmpPt,scalarImage, vectorImage, fuzzy, qMax(2, fuzzy), maxNumFailingPixels)) {
             scalarImage.save(QString(getTypeName(type) + "_scalar_mask.png"),"PNG");
             vectorImage.save(QString(getTypeName(type) + "_vector_mask.png"),"PNG");
 
@@ -170,6 +171,33 @@ public:
         // KisMaskSimilarityTester::exhaustiveTest(bounds,type);
     }
 
+    /**
+     * The spikes and the supersampling of the small dabs are vectorized
+     * with a different math (exact atan2 and float accumulation of the
+     * samples), so a small difference is allowed
+     */
+    template <typename MaskGenerator>
+    static void runApproximateMaskGenTest(MaskGenerator& generator, MaskType type, const QRect &bounds) {
+        MaskGenerator scalarGenerator(generator);
+
+        scalarGenerator
+            .setMaskScalarApplicator(); // Force usage of scalar backend
+        KisMaskSimilarityTester(scalarGenerator.applicator(), generator.applicator(), bounds, type,
+                                3, bounds.width() * bounds.height() / 500);
+    }
+
+    template <typename MaskGenerator>
+    static void runSpikesTest(MaskGenerator& generator, MaskType type) {
+        generator.setDiameter(499.5);
+        runApproximateMaskGenTest(generator, type, QRect(0,0,700,700));
+    }
+
+    template <typename MaskGenerator>
+    static void runSmallMaskTest(MaskGenerator& generator, MaskType type) {
+        QVERIFY(generator.shouldSupersample());
+        runApproximateMaskGenTest(generator, type, QRect(0,0,12,12));
+    }
+
 private:
     QString getTypeName(MaskType type) {
 
@@ -249,4 +277,75 @@ void KisMaskSimilarityTest::testSoftRectMask()
     KisMaskSimilarityTester::runMaskGenTest(generator,RECT_SOFT);
 }
 
+void KisMaskSimilarityTest::testSpikedMasks()
+{
+    const KisCubicCurve pointsCurve(QString("0,1;1,0"));
+
+    {
+        KisCircleMaskGenerator generator(499.5, 0.7, 0.5, 0.5, 5, true);
+        KisMaskSimilarityTester::runSpikesTest(generator, DEFAULT);
+    }
+    {
+        KisGaussCircleMaskGenerator generator(499.5, 0.7, 0.5, 0.5, 3, true);
+        KisMaskSimilarityTester::runSpikesTest(generator, CIRC_GAUSS);
+    }
+    {
+        KisCurveCircleMaskGenerator generator(499.5, 0.7, 0.5, 0.5, 7, pointsCurve, true);
+        KisMaskSimilarityTester::runSpikesTest(generator, CIRC_SOFT);
+    }
+    {
+        KisRectangleMaskGenerator generator(499.5, 0.5, 0.5, 0.5, 4, true);
+        KisMaskSimilarityTester::runSpikesTest(generator, RECT);
+    }
+    {
+        KisGaussRectangleMaskGenerator generator(499.5, 0.5, 0.5, 0.2, 5, true);
+        KisMaskSimilarityTester::runSpikesTest(generator, RECT_GAUSS);
+    }
+    {
+        KisCurveRectangleMaskGenerator generator(499.5, 0.5, 0.5, 0.2, 3, pointsCurve, true);
+        KisMaskSimilarityTester::runSpikesTest(generator, RECT_SOFT);
+    }
+}
+
+void KisMaskSimilarityTest::testSmallMasks_data()
+{
+    QTest::addColumn<qreal>("diameter");
+
+    // 3x3 and 6x6 supersampling
+    QTest::newRow("3x3") << 7.5;
+    QTest::newRow("6x6") << 0.7;
+}
+
+void KisMaskSimilarityTest::testSmallMasks()
+{
+    QFETCH(qreal, diameter);
+
+    const KisCubicCurve pointsCurve(QString("0,1;1,0"));
+
+    {
+        KisCircleMaskGenerator generator(diameter, 1.0, 0.5, 0.5, 2, true);
+        KisMaskSimilarityTester::runSmallMaskTest(generator, DEFAULT);
+    }
+    {
+        KisGaussCircleMaskGenerator generator(diameter, 1.0, 0.5, 0.5, 2, true);
+        KisMaskSimilarityTester::runSmallMaskTest(generator, CIRC_GAUSS);
+    }
+    {
+        KisCurveCircleMaskGenerator generator(diameter, 1.0, 0.5, 0.5, 2, pointsCurve, true);
+        KisMaskSimilarityTester::runSmallMaskTest(generator, CIRC_SOFT);
+    }
+    {
+        KisRectangleMaskGenerator generator(diameter, 1.0, 0.5, 0.5, 2, true);
+        KisMaskSimilarityTester::runSmallMaskTest(generator, RECT);
+    }
+    {
+        KisGaussRectangleMaskGenerator generator(diameter, 1.0, 0.5, 0.5, 2, true);
+        KisMaskSimilarityTester::runSmallMaskTest(generator, RECT_GAUSS);
+    }
+    {
+        KisCurveRectangleMaskGenerator generator(diameter, 1.0, 0.5, 0.5, 2, pointsCurve, true);
+        KisMaskSimilarityTester::runSmallMaskTest(generator, RECT_SOFT);
+    }
+}
+
 SIMPLE_TEST_MAIN(KisMaskSimilarityTest)
@@ -21,6 +21,11 @@ private Q_SLOTS:
     void testRectMask();
     void testGaussRectMask();
     void testSoftRectMask();
+
+    void testSpikedMasks();
+
+    void testSmallMasks_data();
+    void testSmallMasks();
 };
 
 #endif
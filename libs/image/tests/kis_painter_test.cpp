@@ -609,6 +609,119 @@ void KisPainterTest::testMassiveBltFixedCornerCases()
     QVERIFY(dst->extent().isEmpty());
 }
 
+void KisPainterTest::testBltFixedPlacements_data()
+{
+    QTest::addColumn<bool>("useMask");
+    QTest::addColumn<bool>("useSelection");
+
+    QTest::newRow("plain") << false << false;
+    QTest::newRow("mask") << true << false;
+    QTest::newRow("selection") << false << true;
+    QTest::newRow("mask-selection") << true << true;
+}
+
+void KisPainterTest::testBltFixedPlacements()
+{
+    QFETCH(bool, useMask);
+    QFETCH(bool, useSelection);
+
+    const KoColorSpace* cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // an asymmetric dab, so that all the mirrored copies differ
+    const QRect dabRect(0, 0, 80, 50);
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+    dab->setRect(dabRect);
+    dab->initialize();
+    dab->fill(dabRect, KoColor(Qt::red, cs));
+    dab->fill(QRect(5, 5, 30, 20), KoColor(Qt::green, cs));
+    dab->fill(QRect(60, 30, 10, 15), KoColor(Qt::blue, cs));
+
+    KisFixedPaintDeviceSP mask;
+
+    if (useMask) {
+        mask = new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+        mask->setRect(dabRect);
+        mask->initialize();
+
+        for (int y = 0; y < dabRect.height(); y++) {
+            for (int x = 0; x < dabRect.width(); x++) {
+                mask->data()[y * dabRect.width() + x] = quint8(x * 3 + y);
+            }
+        }
+    }
+
+    KisSelectionSP selection;
+
+    if (useSelection) {
+        selection = new KisSelection();
+        selection->pixelSelection()->select(QRect(20, 30, 150, 90));
+    }
+
+    // the placements overlap and cross the tile borders
+    QVector<KisDabPlacement> placements;
+    placements << KisDabPlacement(QPoint(10, 20));
+    placements << KisDabPlacement(QPoint(50, 40), true, false);
+    placements << KisDabPlacement(QPoint(30, 70), true, true);
+    placements << KisDabPlacement(QPoint(90, 60), false, true);
+
+    const KisFixedPaintDevice originalDab(*dab);
+
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+    dst->fill(QRect(0, 0, 200, 150), KoColor(Qt::white, cs));
+
+    {
+        KisPainter painter(dst);
+        painter.setSelection(selection);
+        painter.setOpacity(200);
+        painter.bltFixedPlacements(dab, dabRect, mask, placements);
+        painter.end();
+    }
+
+    // the source dab is not changed
+    const int dabBytes = dabRect.width() * dabRect.height() * cs->pixelSize();
+    QVERIFY(!memcmp(dab->constData(), originalDab.constData(), dabBytes));
+
+    // the reference result is rendered dab by dab
+    KisPaintDeviceSP ref = new KisPaintDevice(cs);
+    ref->fill(QRect(0, 0, 200, 150), KoColor(Qt::white, cs));
+
+    {
+        KisPainter painter(ref);
+        painter.setSelection(selection);
+        painter.setOpacity(200);
+
+        Q_FOREACH (const KisDabPlacement &placement, placements) {
+            KisFixedPaintDeviceSP mirroredDab = new KisFixedPaintDevice(*dab);
+            mirroredDab->mirror(placement.mirrorHorizontally, placement.mirrorVertically);
+
+            if (mask) {
+                KisFixedPaintDeviceSP mirroredMask = new KisFixedPaintDevice(*mask);
+                mirroredMask->mirror(placement.mirrorHorizontally, placement.mirrorVertically);
+
+                painter.bltFixedWithFixedSelection(placement.offset.x(), placement.offset.y(),
+                                                   mirroredDab, mirroredMask,
+                                                   dabRect.width(), dabRect.height());
+            } else {
+                painter.bltFixed(placement.offset, mirroredDab, dabRect);
+            }
+        }
+
+        painter.end();
+    }
+
+    const QRect fullRect(0, 0, 200, 150);
+    QPoint errpoint;
+
+    if (!TestUtil::compareQImages(errpoint,
+                                  ref->convertToQImage(0, fullRect),
+                                  dst->convertToQImage(0, fullRect))) {
+        ref->convertToQImage(0, fullRect).save("placements_reference.png");
+        dst->convertToQImage(0, fullRect).save("placements_result.png");
+        QFAIL(QString("Failed to render placements, first different pixel: %1,%2 ")
+              .arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+}
+
 
 #include "kis_lod_transform.h"
 
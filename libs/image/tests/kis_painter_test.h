@@ -49,6 +49,9 @@ private Q_SLOTS:
 
     void testMassiveBltFixedCornerCases();
 
+    void testBltFixedPlacements_data();
+    void testBltFixedPlacements();
+
 
     void testOptimizedCopying();
 };
@@ -355,6 +355,16 @@ void KisMimeDatabase::fillMimeData()
         mimeType.suffixes = QStringList() << "hdr";
         s_mimeDatabase << mimeType;
 
+        mimeType.mimeType = "application/x-cube";
+        mimeType.description = i18nc("description of a file type", "Cube Color Lookup Table");
+        mimeType.suffixes = QStringList() << "cube";
+        s_mimeDatabase << mimeType;
+
+        mimeType.mimeType = "application/x-3dl";
+        mimeType.description = i18nc("description of a file type", "3DL Color Lookup Table");
+        mimeType.suffixes = QStringList() << "3dl";
+        s_mimeDatabase << mimeType;
+
         dbgPlugins << "Filled mime database with" << s_mimeDatabase.count() << "special mimetypes";
     }
 }
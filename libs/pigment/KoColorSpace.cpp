@@ -508,78 +508,28 @@ void KoColorSpace::bitBlt(const KoColorSpace* srcSpace, const KoCompositeOp::Par
         return;
 
     if(!(*this == *srcSpace)) {
+        KoColorConversionCache *conversionCache = KoColorSpaceRegistry::instance()->colorConversionCache();
+
         if (preferCompositionInSourceColorSpace() &&
                 (*op->colorSpace() == *srcSpace || srcSpace->hasCompositeOp(op->id()))) {
 
-            quint32           conversionDstBufferStride = params.cols * srcSpace->pixelSize();
-            QVector<quint8> * conversionDstCache        = d->conversionCache.get(params.rows * conversionDstBufferStride);
-            quint8*           conversionDstData         = conversionDstCache->data();
-
-            for(qint32 row=0; row<params.rows; row++) {
-                convertPixelsTo(params.dstRowStart + row * params.dstRowStride,
-                                conversionDstData  + row * conversionDstBufferStride, srcSpace, params.cols,
-                                renderingIntent, conversionFlags);
-            }
-
             // TODO: Composite op substitution should eventually be removed here, but it's not urgent.
             //       Code should just provide srcSpace to KoColorSpace::compositeOp() to avoid the lookups.
             const KoCompositeOp *otherOp = (*op->colorSpace() == *srcSpace) ? op : srcSpace->compositeOp(op->id());
 
-            KoCompositeOp::ParameterInfo paramInfo(params);
-            paramInfo.dstRowStart  = conversionDstData;
-            paramInfo.dstRowStride = conversionDstBufferStride;
-            otherOp->composite(paramInfo);
-
-            for(qint32 row=0; row<params.rows; row++) {
-                srcSpace->convertPixelsTo(conversionDstData  + row * conversionDstBufferStride,
-                                          params.dstRowStart + row * params.dstRowStride, this, params.cols,
-                                          renderingIntent, conversionFlags);
-            }
+            KoCachedColorConversionTransformation toSrcSpace =
+                conversionCache->cachedConverter(this, srcSpace, renderingIntent, conversionFlags);
+            KoCachedColorConversionTransformation fromSrcSpace =
+                conversionCache->cachedConverter(srcSpace, this, renderingIntent, conversionFlags);
 
+            otherOp->compositeWithDestinationConversion(params, this,
+                                                        toSrcSpace.transformation(),
+                                                        fromSrcSpace.transformation());
         } else {
-            quint32           conversionBufferStride = params.cols * pixelSize();
-            QVector<quint8> * conversionCache        = d->conversionCache.get(params.rows * conversionBufferStride);
-            quint8*           conversionData         = conversionCache->data();
-
-
-            const bool noChannelFlags = params.channelFlags.isEmpty() ||
-                    params.channelFlags == srcSpace->channelFlags(true, true);
-
-            if (noChannelFlags) {
-                for(qint32 row=0; row<params.rows; row++) {
-                    srcSpace->convertPixelsTo(params.srcRowStart + row * params.srcRowStride,
-                                              conversionData     + row * conversionBufferStride, this, params.cols,
-                                              renderingIntent, conversionFlags);
-                }
-
-                KoCompositeOp::ParameterInfo paramInfo(params);
-                paramInfo.srcRowStart  = conversionData;
-                paramInfo.srcRowStride = conversionBufferStride;
-                paramInfo.channelFlags = QBitArray();
-                op->composite(paramInfo);
-            } else {
-                quint32           homogenizationBufferStride = params.cols * srcSpace->pixelSize();
-                QVector<quint8> * homogenizationCache        = d->channelFlagsApplicationCache.get(homogenizationBufferStride);
-                quint8*           homogenizationData         = homogenizationCache->data();
-
-                for(qint32 row=0; row<params.rows; row++) {
-                    srcSpace->convertChannelToVisualRepresentation(params.srcRowStart + row * params.srcRowStride,
-                                                                   homogenizationData, params.cols,
-                                                                   params.channelFlags | srcSpace->channelFlags(false, true));
-                    srcSpace->convertPixelsTo(homogenizationData,
-                                              conversionData + row * conversionBufferStride, this, params.cols,
-                                              renderingIntent, conversionFlags);
-                }
-
-
-                KoCompositeOp::ParameterInfo paramInfo(params);
-                paramInfo.srcRowStart  = conversionData;
-                paramInfo.srcRowStride = conversionBufferStride;
-                paramInfo.channelFlags = channelFlags(true, params.channelFlags.testBit(srcSpace->alphaPos()));
-                op->composite(paramInfo);
-            }
-
+            KoCachedColorConversionTransformation cct =
+                conversionCache->cachedConverter(srcSpace, this, renderingIntent, conversionFlags);
 
+            op->compositeWithConversion(params, srcSpace, cct.transformation());
         }
     }
     else {
@@ -9,10 +9,56 @@
 #include <klocalizedstring.h>
 #include <KoID.h>
 #include <QList>
+#include <QVarLengthArray>
 
 #include "KoColorSpace.h"
 #include "KoColorSpaceMaths.h"
 #include "KoCompositeOpRegistry.h"
+#include "KoColorConversionTransformation.h"
+
+namespace {
+
+/**
+ * The size of the intermediate buffer used by the fused conversion and
+ * composition. It should be small enough for the converted pixels to
+ * still be in L1/L2 cache when the composite op reads them.
+ */
+const int fusedConversionBufferSize = 16384;
+
+/**
+ * Splits the area described by \p params into blocks of whole rows (or
+ * parts of a row, if a single row doesn't fit) containing not more than
+ * \p maxBlockPixels pixels and calls \p func for every block.
+ */
+template <typename Func>
+void processInBlocks(const KoCompositeOp::ParameterInfo &params,
+                     int dstPixelSize, int srcPixelSize, int maxBlockPixels,
+                     Func func)
+{
+    const int blockCols = qMin(params.cols, maxBlockPixels);
+    const int blockRows = qBound(1, maxBlockPixels / blockCols, params.rows);
+
+    KoCompositeOp::ParameterInfo block(params);
+
+    for (int row = 0; row < params.rows; row += blockRows) {
+        for (int col = 0; col < params.cols; col += blockCols) {
+            block.rows = qMin(blockRows, params.rows - row);
+            block.cols = qMin(blockCols, params.cols - col);
+
+            block.dstRowStart = params.dstRowStart + row * params.dstRowStride + col * dstPixelSize;
+            block.srcRowStart = params.srcRowStride ?
+                params.srcRowStart + row * params.srcRowStride + col * srcPixelSize :
+                params.srcRowStart;
+            block.maskRowStart = params.maskRowStart ?
+                params.maskRowStart + row * params.maskRowStride + col :
+                nullptr;
+
+            func(block);
+        }
+    }
+}
+
+}
 
 static QString compositeOpDisplayName(const QString &id)
 {
@@ -168,6 +214,105 @@ void KoCompositeOp::composite(const KoCompositeOp::ParameterInfo& params) const
               scale<quint8>(params.opacity), params.channelFlags );
 }
 
+void KoCompositeOp::compositeWithConversion(const ParameterInfo& params,
+                                            const KoColorSpace *srcSpace,
+                                            const KoColorConversionTransformation *srcConverter) const
+{
+    if (params.rows <= 0 || params.cols <= 0) return;
+
+    const int srcPixelSize = srcSpace->pixelSize();
+    const int dstPixelSize = colorSpace()->pixelSize();
+
+    const bool noChannelFlags = params.channelFlags.isEmpty() ||
+            params.channelFlags == srcSpace->channelFlags(true, true);
+
+    QBitArray homogenizationFlags;
+    QBitArray dstChannelFlags;
+
+    if (!noChannelFlags) {
+        homogenizationFlags = params.channelFlags | srcSpace->channelFlags(false, true);
+        dstChannelFlags = colorSpace()->channelFlags(true, params.channelFlags.testBit(srcSpace->alphaPos()));
+    }
+
+    const int maxBlockPixels = qMax(1, fusedConversionBufferSize / qMax(srcPixelSize, dstPixelSize));
+
+    QVarLengthArray<quint8, fusedConversionBufferSize> conversionBuffer(maxBlockPixels * dstPixelSize);
+    QVector<quint8> homogenizationBuffer(noChannelFlags ? 0 : maxBlockPixels * srcPixelSize);
+
+    auto convertRow = [&] (const quint8 *src, quint8 *dst, int numPixels) {
+        if (!noChannelFlags) {
+            srcSpace->convertChannelToVisualRepresentation(src, homogenizationBuffer.data(), numPixels, homogenizationFlags);
+            src = homogenizationBuffer.data();
+        }
+        srcConverter->transform(src, dst, numPixels);
+    };
+
+    if (!params.srcRowStride) {
+        // the source is a constant color, so convert it only once
+        convertRow(params.srcRowStart, conversionBuffer.data(), 1);
+
+        ParameterInfo paramInfo(params);
+        paramInfo.srcRowStart = conversionBuffer.data();
+        paramInfo.channelFlags = dstChannelFlags;
+        composite(paramInfo);
+        return;
+    }
+
+    processInBlocks(params, dstPixelSize, srcPixelSize, maxBlockPixels,
+        [&] (ParameterInfo &block) {
+            const int bufferRowStride = block.cols * dstPixelSize;
+
+            for (int row = 0; row < block.rows; row++) {
+                convertRow(block.srcRowStart + row * block.srcRowStride,
+                           conversionBuffer.data() + row * bufferRowStride,
+                           block.cols);
+            }
+
+            block.srcRowStart = conversionBuffer.data();
+            block.srcRowStride = bufferRowStride;
+            block.channelFlags = dstChannelFlags;
+            composite(block);
+        });
+}
+
+void KoCompositeOp::compositeWithDestinationConversion(const ParameterInfo& params,
+                                                       const KoColorSpace *dstSpace,
+                                                       const KoColorConversionTransformation *dstToOpConverter,
+                                                       const KoColorConversionTransformation *opToDstConverter) const
+{
+    if (params.rows <= 0 || params.cols <= 0) return;
+
+    const int srcPixelSize = colorSpace()->pixelSize();
+    const int dstPixelSize = dstSpace->pixelSize();
+
+    const int maxBlockPixels = qMax(1, fusedConversionBufferSize / srcPixelSize);
+
+    QVarLengthArray<quint8, fusedConversionBufferSize> conversionBuffer(maxBlockPixels * srcPixelSize);
+
+    processInBlocks(params, dstPixelSize, srcPixelSize, maxBlockPixels,
+        [&] (ParameterInfo &block) {
+            const int bufferRowStride = block.cols * srcPixelSize;
+            quint8 *dstRowStart = block.dstRowStart;
+            const int dstRowStride = block.dstRowStride;
+
+            for (int row = 0; row < block.rows; row++) {
+                dstToOpConverter->transform(dstRowStart + row * dstRowStride,
+                                            conversionBuffer.data() + row * bufferRowStride,
+                                            block.cols);
+            }
+
+            block.dstRowStart = conversionBuffer.data();
+            block.dstRowStride = bufferRowStride;
+            composite(block);
+
+            for (int row = 0; row < block.rows; row++) {
+                opToDstConverter->transform(conversionBuffer.data() + row * bufferRowStride,
+                                            dstRowStart + row * dstRowStride,
+                                            block.cols);
+            }
+        });
+}
+
 
 QString KoCompositeOp::category() const
 {
@@ -17,8 +17,7 @@
 #include "kritapigment_export.h"
 
 class KoColorSpace;
-
-class KoColorSpace;
+class KoColorConversionTransformation;
 
 /**
  * Base for colorspace-specific blending modes.
@@ -126,6 +125,37 @@ public:
     */
     virtual void composite(const ParameterInfo& params) const;
 
+    /**
+     * Composite source pixels from \p srcSpace onto the destination, which
+     * is in the color space of this op. The source is converted with
+     * \p srcConverter in small blocks that fit into CPU cache and every
+     * block is composited right after the conversion, so no full-size
+     * temporary buffer is needed.
+     *
+     * If params.channelFlags is set, the source pixels are homogenized
+     * with srcSpace->convertChannelToVisualRepresentation() before the
+     * conversion, the same way KoColorSpace::bitBlt() does.
+     *
+     * @param srcConverter the transformation from \p srcSpace into colorSpace()
+     */
+    void compositeWithConversion(const ParameterInfo& params,
+                                 const KoColorSpace *srcSpace,
+                                 const KoColorConversionTransformation *srcConverter) const;
+
+    /**
+     * Composite the source pixels, which are in the color space of this op,
+     * onto a destination stored in \p dstSpace. Every cache-sized block of
+     * the destination is converted into colorSpace(), composited and
+     * converted back before the next block is touched.
+     *
+     * @param dstToOpConverter the transformation from \p dstSpace into colorSpace()
+     * @param opToDstConverter the transformation from colorSpace() into \p dstSpace
+     */
+    void compositeWithDestinationConversion(const ParameterInfo& params,
+                                            const KoColorSpace *dstSpace,
+                                            const KoColorConversionTransformation *dstToOpConverter,
+                                            const KoColorConversionTransformation *opToDstConverter) const;
+
 private:
     KoCompositeOp();
     struct Private;
@@ -95,7 +95,7 @@ public:
         }
     }
 
-private:
+protected:
     class MixerImpl;
 
     struct ArrayOfPointers {
@@ -256,6 +256,27 @@ private:
             }
         }
 
+        /**
+         * Add the sums that were precalculated by the caller, e.g. by a
+         * vectorized implementation of the accumulation loop. \p sums should
+         * have the same layout as the pixel: the color slots contain the sums
+         * of the color channels premultiplied by alpha and weight, the alpha
+         * slot contains the sum of the alpha channel premultiplied by weight.
+         */
+        void accumulatePreparedSums(const mix_type *sums, qint64 weightsSum) {
+            static_assert(_CSTrait::alpha_pos != -1,
+                          "prepared sums are supported for color spaces with alpha channel only");
+
+            for (int i = 0; i < (int)_CSTrait::channels_nb; i++) {
+                if (i != _CSTrait::alpha_pos) {
+                    totals[i] += sums[i];
+                }
+            }
+
+            totalAlpha += sums[_CSTrait::alpha_pos];
+            normalizeFactor += weightsSum;
+        }
+
         template<class AbstractSource, class WeightsWrapper>
         void accumulateColors(AbstractSource source, WeightsWrapper weightsWrapper, int nColors) {
             // Compute the total for each channel by summing each colors multiplied by the weightlabcache
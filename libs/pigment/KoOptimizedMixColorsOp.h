@@ -0,0 +1,428 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOOPTIMIZEDMIXCOLORSOP_H
+#define KOOPTIMIZEDMIXCOLORSOP_H
+
+#include "KoMixColorsOpImpl.h"
+#include "KoColorSpaceTraits.h"
+#include "KoMultiArchBuildSupport.h"
+
+#include <cmath>
+
+/**
+ * A mix colors op for 4-channel color spaces with the alpha channel
+ * stored in the last position (RGBA, BGRA, LabA and so on). The generic
+ * version is just the scalar KoMixColorsOpImpl. Architecture-specific
+ * versions vectorize accumulation of the contiguous pixel arrays, which
+ * is used by the color sampler and the colorsmudge engine.
+ */
+template<typename _channels_type_,
+         typename _impl,
+         typename EnableDummyType = void>
+class KoOptimizedMixColorsOp : public KoMixColorsOpImpl<KoColorSpaceTrait<_channels_type_, 4, 3>>
+{
+};
+
+#if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE)
+
+#include "KoStreamedMath.h"
+
+template<typename channels_type, typename _impl>
+struct KoMixColorsVectorAccumulator;
+
+/**
+ * Accumulates RGBA8 pixels in an exact way using 32-bit integer lanes.
+ *
+ * The product of alpha and weight may take up to 23 bits, so it is split
+ * into the low 8-bit part and the high (signed) part. Each of them is
+ * multiplied by the color channel separately and accumulated in a lane
+ * that is guaranteed not to overflow for \p maxWeightedBlocksPerBatch
+ * iterations. After that, the lanes are flushed into 64-bit totals. The
+ * result is bit-exact with the scalar version.
+ */
+template<typename _impl>
+struct KoMixColorsVectorAccumulator<quint8, _impl>
+{
+    using int_v = xsimd::batch<int, _impl>;
+    using uint_v = xsimd::batch<unsigned int, _impl>;
+    using mix_type = KoColorSpaceMathsTraits<quint8>::mixtype;
+
+    // 255 * |alphaHi| < 2^23, therefore 255 iterations fit into 2^31
+    static constexpr int maxWeightedBlocksPerBatch = 255;
+    // 255 * 255 * 32768 < 2^31
+    static constexpr int maxAveragedBlocksPerBatch = 32768;
+
+    ALWAYS_INLINE static qint64 horizontalSum(const int_v &value)
+    {
+        int lanes[int_v::size];
+        value.store_unaligned(lanes);
+
+        qint64 result = 0;
+        for (size_t i = 0; i < int_v::size; i++) {
+            result += lanes[i];
+        }
+        return result;
+    }
+
+    template<bool useWeights>
+    static void accumulate(const quint8 *data, const qint16 *weights, int nPixels, mix_type *totals)
+    {
+        const int vectorSize = static_cast<int>(int_v::size);
+        const int numBlocks = nPixels / vectorSize;
+        const int numScalarPixels = nPixels % vectorSize;
+
+        const uint_v mask(0xFF);
+        const int_v lowAlphaMask(0xFF);
+
+        int blocksLeft = numBlocks;
+
+        while (blocksLeft > 0) {
+            const int numBlocksInBatch =
+                qMin(blocksLeft, useWeights ? maxWeightedBlocksPerBatch : maxAveragedBlocksPerBatch);
+
+            int_v totalLow0(0), totalLow1(0), totalLow2(0);
+            int_v totalHigh0(0), totalHigh1(0), totalHigh2(0);
+            int_v totalAlpha(0);
+
+            for (int i = 0; i < numBlocksInBatch; i++) {
+                const auto pixels = uint_v::load_unaligned(reinterpret_cast<const quint32 *>(data));
+
+                const auto c0 = xsimd::bitwise_cast_compat<int>(pixels & mask);
+                const auto c1 = xsimd::bitwise_cast_compat<int>((pixels >> 8) & mask);
+                const auto c2 = xsimd::bitwise_cast_compat<int>((pixels >> 16) & mask);
+                auto alpha = xsimd::bitwise_cast_compat<int>(pixels >> 24);
+
+                if (useWeights) {
+                    alpha *= xsimd::load_and_extend<int_v>(weights);
+
+                    const auto alphaLow = alpha & lowAlphaMask;
+                    const auto alphaHigh = alpha >> 8;
+
+                    totalLow0 += c0 * alphaLow;
+                    totalLow1 += c1 * alphaLow;
+                    totalLow2 += c2 * alphaLow;
+
+                    totalHigh0 += c0 * alphaHigh;
+                    totalHigh1 += c1 * alphaHigh;
+                    totalHigh2 += c2 * alphaHigh;
+
+                    weights += vectorSize;
+                } else {
+                    totalLow0 += c0 * alpha;
+                    totalLow1 += c1 * alpha;
+                    totalLow2 += c2 * alpha;
+                }
+
+                totalAlpha += alpha;
+                data += vectorSize * 4;
+            }
+
+            totals[0] += horizontalSum(totalLow0);
+            totals[1] += horizontalSum(totalLow1);
+            totals[2] += horizontalSum(totalLow2);
+
+            if (useWeights) {
+                totals[0] += horizontalSum(totalHigh0) * 256;
+                totals[1] += horizontalSum(totalHigh1) * 256;
+                totals[2] += horizontalSum(totalHigh2) * 256;
+            }
+
+            totals[3] += horizontalSum(totalAlpha);
+
+            blocksLeft -= numBlocksInBatch;
+        }
+
+        for (int i = 0; i < numScalarPixels; i++) {
+            mix_type alphaTimesWeight = data[3];
+            if (useWeights) {
+                alphaTimesWeight *= *weights;
+                weights++;
+            }
+
+            totals[0] += data[0] * alphaTimesWeight;
+            totals[1] += data[1] * alphaTimesWeight;
+            totals[2] += data[2] * alphaTimesWeight;
+            totals[3] += alphaTimesWeight;
+
+            data += 4;
+        }
+    }
+};
+
+/**
+ * Accumulates RGBA16 and RGBAF32 pixels using float lanes. The lanes
+ * are flushed into double-precision totals every \p maxBlocksPerBatch
+ * iterations to keep the rounding error low. For integer color spaces
+ * the result may differ from the scalar version by rounding of the
+ * least significant bit, uniformly colored areas still produce exactly
+ * the same color.
+ */
+template<typename channels_type, typename _impl>
+struct KoMixColorsVectorAccumulatorFloatBase
+{
+    using int_v = xsimd::batch<int, _impl>;
+    using uint_v = xsimd::batch<unsigned int, _impl>;
+    using float_v = xsimd::batch<float, _impl>;
+    using mix_type = typename KoColorSpaceMathsTraits<channels_type>::mixtype;
+
+    static constexpr int maxBlocksPerBatch = 16;
+
+    ALWAYS_INLINE static void flushLanes(const float_v &value, double &total)
+    {
+        float lanes[float_v::size];
+        value.store_unaligned(lanes);
+
+        for (size_t i = 0; i < float_v::size; i++) {
+            total += lanes[i];
+        }
+    }
+
+    template<typename T = mix_type>
+    ALWAYS_INLINE static std::enable_if_t<std::is_integral<T>::value, T> toMixType(double value)
+    {
+        return std::llround(value);
+    }
+
+    template<typename T = mix_type>
+    ALWAYS_INLINE static std::enable_if_t<std::is_floating_point<T>::value, T> toMixType(double value)
+    {
+        return value;
+    }
+};
+
+namespace KoMixColorsVectorAccumulatorDetail
+{
+
+/**
+ * The common accumulation loop for the float-based accumulators.
+ * \p Accumulator must provide `read()` method that unpacks
+ * `float_v::size` pixels into the channel vectors
+ */
+template<bool useWeights, class Accumulator, typename channels_type>
+void accumulateFloat(const quint8 *data, const qint16 *weights, int nPixels, typename Accumulator::mix_type *totals)
+{
+    using int_v = typename Accumulator::int_v;
+    using float_v = typename Accumulator::float_v;
+
+    const int vectorSize = static_cast<int>(float_v::size);
+    const int numBlocks = nPixels / vectorSize;
+    const int numScalarPixels = nPixels % vectorSize;
+    const int pixelSize = 4 * sizeof(channels_type);
+
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+
+    int blocksLeft = numBlocks;
+
+    while (blocksLeft > 0) {
+        const int numBlocksInBatch = qMin(blocksLeft, Accumulator::maxBlocksPerBatch);
+
+        float_v total0(0.0f), total1(0.0f), total2(0.0f), totalAlpha(0.0f);
+
+        for (int i = 0; i < numBlocksInBatch; i++) {
+            float_v c0, c1, c2, alpha;
+            Accumulator::read(data, c0, c1, c2, alpha);
+
+            if (useWeights) {
+                alpha *= xsimd::to_float(xsimd::load_and_extend<int_v>(weights));
+                weights += vectorSize;
+            }
+
+            total0 = xsimd::fma(c0, alpha, total0);
+            total1 = xsimd::fma(c1, alpha, total1);
+            total2 = xsimd::fma(c2, alpha, total2);
+            totalAlpha += alpha;
+
+            data += vectorSize * pixelSize;
+        }
+
+        Accumulator::flushLanes(total0, sums[0]);
+        Accumulator::flushLanes(total1, sums[1]);
+        Accumulator::flushLanes(total2, sums[2]);
+        Accumulator::flushLanes(totalAlpha, sums[3]);
+
+        blocksLeft -= numBlocksInBatch;
+    }
+
+    for (int i = 0; i < numScalarPixels; i++) {
+        const channels_type *pixel = reinterpret_cast<const channels_type *>(data);
+
+        double alphaTimesWeight = pixel[3];
+        if (useWeights) {
+            alphaTimesWeight *= *weights;
+            weights++;
+        }
+
+        sums[0] += pixel[0] * alphaTimesWeight;
+        sums[1] += pixel[1] * alphaTimesWeight;
+        sums[2] += pixel[2] * alphaTimesWeight;
+        sums[3] += alphaTimesWeight;
+
+        data += pixelSize;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        totals[i] += Accumulator::toMixType(sums[i]);
+    }
+}
+
+} // namespace KoMixColorsVectorAccumulatorDetail
+
+template<typename _impl>
+struct KoMixColorsVectorAccumulator<quint16, _impl>
+    : public KoMixColorsVectorAccumulatorFloatBase<quint16, _impl>
+{
+    using Base = KoMixColorsVectorAccumulatorFloatBase<quint16, _impl>;
+    using typename Base::int_v;
+    using typename Base::uint_v;
+    using typename Base::float_v;
+    using typename Base::mix_type;
+
+    ALWAYS_INLINE static void read(const quint8 *src, float_v &c0, float_v &c1, float_v &c2, float_v &alpha)
+    {
+        const uint_v mask(0xFFFF);
+
+#if XSIMD_VERSION_MAJOR < 10
+        uint_v pixelsC1C2;
+        uint_v pixelsC3Alpha;
+        KoRgbaInterleavers<16>::deinterleave(src, pixelsC1C2, pixelsC3Alpha);
+#else
+        const auto *srcPtr = reinterpret_cast<const typename uint_v::value_type *>(src);
+        const auto idx1 = xsimd::detail::make_sequence_as_batch<int_v>() * 2; // stride == 2
+        const auto idx2 = idx1 + 1; // offset 1 == 2nd members
+
+        const auto pixelsC1C2 = uint_v::gather(srcPtr, idx1);
+        const auto pixelsC3Alpha = uint_v::gather(srcPtr, idx2);
+#endif
+
+        c0 = xsimd::to_float(xsimd::bitwise_cast_compat<int>(pixelsC1C2 & mask));
+        c1 = xsimd::to_float(xsimd::bitwise_cast_compat<int>((pixelsC1C2 >> 16) & mask));
+        c2 = xsimd::to_float(xsimd::bitwise_cast_compat<int>(pixelsC3Alpha & mask));
+        alpha = xsimd::to_float(xsimd::bitwise_cast_compat<int>((pixelsC3Alpha >> 16) & mask));
+    }
+
+    template<bool useWeights>
+    static void accumulate(const quint8 *data, const qint16 *weights, int nPixels, mix_type *totals)
+    {
+        KoMixColorsVectorAccumulatorDetail::accumulateFloat<useWeights, KoMixColorsVectorAccumulator, quint16>(data, weights, nPixels, totals);
+    }
+};
+
+template<typename _impl>
+struct KoMixColorsVectorAccumulator<float, _impl>
+    : public KoMixColorsVectorAccumulatorFloatBase<float, _impl>
+{
+    using Base = KoMixColorsVectorAccumulatorFloatBase<float, _impl>;
+    using typename Base::int_v;
+    using typename Base::float_v;
+    using typename Base::mix_type;
+
+    ALWAYS_INLINE static void read(const quint8 *src, float_v &c0, float_v &c1, float_v &c2, float_v &alpha)
+    {
+#if XSIMD_VERSION_MAJOR < 10
+        KoRgbaInterleavers<32>::deinterleave(src, c0, c1, c2, alpha);
+#else
+        const auto srcPtr = reinterpret_cast<const typename float_v::value_type *>(src);
+        const auto idx1 = xsimd::detail::make_sequence_as_batch<int_v>() * 4; // stride == 4
+        const auto idx2 = idx1 + 1;
+        const auto idx3 = idx1 + 2;
+        const auto idx4 = idx1 + 3;
+
+        c0 = float_v::gather(srcPtr, idx1);
+        c1 = float_v::gather(srcPtr, idx2);
+        c2 = float_v::gather(srcPtr, idx3);
+        alpha = float_v::gather(srcPtr, idx4);
+#endif
+    }
+
+    template<bool useWeights>
+    static void accumulate(const quint8 *data, const qint16 *weights, int nPixels, mix_type *totals)
+    {
+        KoMixColorsVectorAccumulatorDetail::accumulateFloat<useWeights, KoMixColorsVectorAccumulator, float>(data, weights, nPixels, totals);
+    }
+};
+
+
+template<typename _channels_type_, typename _impl>
+class KoOptimizedMixColorsOp<
+        _channels_type_, _impl,
+        typename std::enable_if<!std::is_same<_impl, xsimd::generic>::value>::type>
+    : public KoMixColorsOpImpl<KoColorSpaceTrait<_channels_type_, 4, 3>>
+{
+    using Trait = KoColorSpaceTrait<_channels_type_, 4, 3>;
+    using BaseClass = KoMixColorsOpImpl<Trait>;
+    using MixDataResult = typename BaseClass::MixDataResult;
+    using Accumulator = KoMixColorsVectorAccumulator<_channels_type_, _impl>;
+    using mix_type = typename KoColorSpaceMathsTraits<_channels_type_>::mixtype;
+
+public:
+    using BaseClass::mixColors;
+
+    KoMixColorsOp::Mixer *createMixer() const override
+    {
+        return new OptimizedMixerImpl();
+    }
+
+    void mixColors(const quint8 *colors, const qint16 *weights, int nColors, quint8 *dst, int weightSum = 255) const override
+    {
+        MixDataResult result;
+        accumulateWeighted(result, colors, weights, weightSum, nColors);
+        result.computeMixedColor(dst);
+    }
+
+    void mixColors(const quint8 *colors, int nColors, quint8 *dst) const override
+    {
+        MixDataResult result;
+        accumulateAveraged(result, colors, nColors);
+        result.computeMixedColor(dst);
+    }
+
+private:
+    static void accumulateWeighted(MixDataResult &result, const quint8 *data, const qint16 *weights, int weightSum, int nPixels)
+    {
+        mix_type sums[Trait::channels_nb] = {};
+        Accumulator::template accumulate<true>(data, weights, nPixels, sums);
+        result.accumulatePreparedSums(sums, weightSum);
+    }
+
+    static void accumulateAveraged(MixDataResult &result, const quint8 *data, int nPixels)
+    {
+        mix_type sums[Trait::channels_nb] = {};
+        Accumulator::template accumulate<false>(data, nullptr, nPixels, sums);
+        result.accumulatePreparedSums(sums, nPixels);
+    }
+
+    class OptimizedMixerImpl : public KoMixColorsOp::Mixer
+    {
+    public:
+        void accumulate(const quint8 *data, const qint16 *weights, int weightSum, int nPixels) override
+        {
+            accumulateWeighted(m_result, data, weights, weightSum, nPixels);
+        }
+
+        void accumulateAverage(const quint8 *data, int nPixels) override
+        {
+            accumulateAveraged(m_result, data, nPixels);
+        }
+
+        void computeMixedColor(quint8 *data) override
+        {
+            m_result.computeMixedColor(data);
+        }
+
+        qint64 currentWeightsSum() const override
+        {
+            return m_result.currentWeightsSum();
+        }
+
+    private:
+        MixDataResult m_result;
+    };
+};
+
+#endif /* HAVE_XSIMD */
+
+#endif // KOOPTIMIZEDMIXCOLORSOP_H
@@ -0,0 +1,24 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoOptimizedMixColorsOpFactory.h"
+
+#include <KoColorModelStandardIds.h>
+
+#include "KoOptimizedMixColorsOpFactoryImpl.h"
+
+KoMixColorsOp *KoOptimizedMixColorsOpFactory::createRgbaOp(const KoID &depthId)
+{
+    if (depthId == Integer8BitsColorDepthID) {
+        return createOptimizedClass<KoOptimizedMixColorsOpFactoryImpl<quint8>>();
+    } else if (depthId == Integer16BitsColorDepthID) {
+        return createOptimizedClass<KoOptimizedMixColorsOpFactoryImpl<quint16>>();
+    } else if (depthId == Float32BitsColorDepthID) {
+        return createOptimizedClass<KoOptimizedMixColorsOpFactoryImpl<float>>();
+    }
+
+    return nullptr;
+}
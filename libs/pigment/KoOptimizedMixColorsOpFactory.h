@@ -0,0 +1,30 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOOPTIMIZEDMIXCOLORSOPFACTORY_H
+#define KOOPTIMIZEDMIXCOLORSOPFACTORY_H
+
+#include "kritapigment_export.h"
+
+#include <KoID.h>
+
+class KoMixColorsOp;
+
+/**
+ * \see KoOptimizedMixColorsOp
+ */
+class KRITAPIGMENT_EXPORT KoOptimizedMixColorsOpFactory
+{
+public:
+    /**
+     * Create a mix colors op optimized for the current CPU architecture
+     * for a 4-channel color space with alpha channel stored last. Returns
+     * nullptr if there is no optimized version for \p depthId
+     */
+    static KoMixColorsOp* createRgbaOp(const KoID &depthId);
+};
+
+#endif // KOOPTIMIZEDMIXCOLORSOPFACTORY_H
@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoOptimizedMixColorsOpFactoryImpl.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+#include "KoOptimizedMixColorsOp.h"
+
+template<typename _channels_type_>
+template<typename _impl>
+KoMixColorsOp *KoOptimizedMixColorsOpFactoryImpl<_channels_type_>::create()
+{
+    return new KoOptimizedMixColorsOp<_channels_type_, _impl>();
+}
+
+template KoMixColorsOp* KoOptimizedMixColorsOpFactoryImpl<quint8>::create<xsimd::current_arch>();
+template KoMixColorsOp* KoOptimizedMixColorsOpFactoryImpl<quint16>::create<xsimd::current_arch>();
+template KoMixColorsOp* KoOptimizedMixColorsOpFactoryImpl<float>::create<xsimd::current_arch>();
+
+#endif // XSIMD_UNIVERSAL_BUILD_PASS
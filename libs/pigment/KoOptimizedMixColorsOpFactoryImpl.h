@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOOPTIMIZEDMIXCOLORSOPFACTORYIMPL_H
+#define KOOPTIMIZEDMIXCOLORSOPFACTORYIMPL_H
+
+#include "kritapigment_export.h"
+#include <KoMultiArchBuildSupport.h>
+
+class KoMixColorsOp;
+
+template<typename _channels_type_>
+class KRITAPIGMENT_EXPORT KoOptimizedMixColorsOpFactoryImpl
+{
+public:
+    template<typename _impl>
+    static KoMixColorsOp *create();
+};
+
+#endif // KOOPTIMIZEDMIXCOLORSOPFACTORYIMPL_H
@@ -0,0 +1,211 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KoMixColorsOpBenchmark.h"
+
+#include <simpletest.h>
+
+#include <KoColorSpaceTraits.h>
+#include <KoColorModelStandardIds.h>
+#include <KoMixColorsOpImpl.h>
+#include <KoOptimizedMixColorsOpFactory.h>
+#include <kis_algebra_2d.h>
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+const int DAB_SIZE = 256;
+const int NUM_DABS = 64;
+
+KoMixColorsOp* createMixColorsOp(const KoID &depthId, bool useOptimized)
+{
+    if (useOptimized) {
+        return KoOptimizedMixColorsOpFactory::createRgbaOp(depthId);
+    } else if (depthId == Integer8BitsColorDepthID) {
+        return new KoMixColorsOpImpl<KoColorSpaceTrait<quint8, 4, 3>>();
+    } else if (depthId == Integer16BitsColorDepthID) {
+        return new KoMixColorsOpImpl<KoColorSpaceTrait<quint16, 4, 3>>();
+    } else {
+        return new KoMixColorsOpImpl<KoColorSpaceTrait<float, 4, 3>>();
+    }
+}
+
+int pixelSizeForDepth(const KoID &depthId)
+{
+    return depthId == Integer8BitsColorDepthID ? 4 :
+           depthId == Integer16BitsColorDepthID ? 8 : 16;
+}
+
+void fillRandomPixels(const KoID &depthId, QVector<quint8> &buffer, int numPixels)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    buffer.resize(numPixels * pixelSizeForDepth(depthId));
+
+    if (depthId == Integer8BitsColorDepthID) {
+        for (int i = 0; i < buffer.size(); i++) {
+            buffer[i] = dist(gen);
+        }
+    } else if (depthId == Integer16BitsColorDepthID) {
+        quint16 *ptr = reinterpret_cast<quint16*>(buffer.data());
+        for (int i = 0; i < numPixels * 4; i++) {
+            ptr[i] = dist(gen) * 257;
+        }
+    } else {
+        float *ptr = reinterpret_cast<float*>(buffer.data());
+        for (int i = 0; i < numPixels * 4; i++) {
+            ptr[i] = dist(gen) / 255.0f;
+        }
+    }
+}
+
+void addDepthRows(const QString &namePrefix, const QVector<int> &numSamples)
+{
+    const QVector<KoID> depths = {Integer8BitsColorDepthID, Integer16BitsColorDepthID, Float32BitsColorDepthID};
+
+    for (const KoID &depth : depths) {
+        for (int samples : numSamples) {
+            for (bool weighted : {false, true}) {
+                for (bool optimized : {false, true}) {
+                    QTest::addRow("%s-%s-%d-%s-%s",
+                                  namePrefix.toLatin1().data(),
+                                  depth.id().toLatin1().data(),
+                                  samples,
+                                  weighted ? "weighted" : "averaged",
+                                  optimized ? "simd" : "scalar")
+                        << depth.id() << samples << weighted << optimized;
+                }
+            }
+        }
+    }
+}
+
+}
+
+void KoMixColorsOpBenchmark::benchmarkSmudgeSampling_data()
+{
+    QTest::addColumn<QString>("depthId");
+    QTest::addColumn<int>("numSamples");
+    QTest::addColumn<bool>("weighted");
+    QTest::addColumn<bool>("optimized");
+
+    addDepthRows("smudge", {256, 4096, DAB_SIZE * DAB_SIZE});
+}
+
+/**
+ * Mirrors the pattern of KisColorSmudgeSampleUtils::sampleColor(): the
+ * pixels are picked from the dab using Halton sequence, collected into
+ * small batches, and the mixed color is recalculated after every batch
+ */
+void KoMixColorsOpBenchmark::benchmarkSmudgeSampling()
+{
+    QFETCH(QString, depthId);
+    QFETCH(int, numSamples);
+    QFETCH(bool, weighted);
+    QFETCH(bool, optimized);
+
+    const KoID depth(depthId);
+    QScopedPointer<KoMixColorsOp> op(createMixColorsOp(depth, optimized));
+    QVERIFY(op);
+
+    const int pixelSize = pixelSizeForDepth(depth);
+
+    QVector<quint8> dab;
+    fillRandomPixels(depth, dab, DAB_SIZE * DAB_SIZE);
+
+    QVector<quint8> mask(DAB_SIZE * DAB_SIZE);
+    for (int y = 0; y < DAB_SIZE; y++) {
+        for (int x = 0; x < DAB_SIZE; x++) {
+            const qreal dist = std::hypot(x - 0.5 * DAB_SIZE, y - 0.5 * DAB_SIZE) / (0.5 * DAB_SIZE);
+            mask[y * DAB_SIZE + x] = qRound(255 * qBound(0.0, 1.0 - dist, 1.0));
+        }
+    }
+
+    const int batchSize = 64;
+    QVector<quint8> batchPixels(batchSize * pixelSize);
+    QVector<qint16> batchWeights(batchSize);
+    QVector<quint8> result(pixelSize);
+
+    QBENCHMARK {
+        for (int dabIndex = 0; dabIndex < NUM_DABS; dabIndex++) {
+            KisAlgebra2D::HaltonSequenceGenerator hGen(2);
+            KisAlgebra2D::HaltonSequenceGenerator vGen(3);
+
+            QScopedPointer<KoMixColorsOp::Mixer> mixer(op->createMixer());
+
+            int samplesLeft = numSamples;
+            while (samplesLeft > 0) {
+                const int currentBatchSize = qMin(samplesLeft, batchSize);
+                int weightsSum = 0;
+
+                for (int i = 0; i < currentBatchSize; i++) {
+                    const int x = hGen.generate(DAB_SIZE - 1);
+                    const int y = vGen.generate(DAB_SIZE - 1);
+                    const int index = y * DAB_SIZE + x;
+
+                    memcpy(batchPixels.data() + i * pixelSize, dab.constData() + index * pixelSize, pixelSize);
+                    batchWeights[i] = mask[index];
+                    weightsSum += mask[index];
+                }
+
+                if (weighted) {
+                    mixer->accumulate(batchPixels.constData(), batchWeights.constData(), weightsSum, currentBatchSize);
+                } else {
+                    mixer->accumulateAverage(batchPixels.constData(), currentBatchSize);
+                }
+
+                mixer->computeMixedColor(result.data());
+                samplesLeft -= currentBatchSize;
+            }
+        }
+    }
+}
+
+void KoMixColorsOpBenchmark::benchmarkMixColors_data()
+{
+    QTest::addColumn<QString>("depthId");
+    QTest::addColumn<int>("numSamples");
+    QTest::addColumn<bool>("weighted");
+    QTest::addColumn<bool>("optimized");
+
+    addDepthRows("mix", {16, 1024});
+}
+
+void KoMixColorsOpBenchmark::benchmarkMixColors()
+{
+    QFETCH(QString, depthId);
+    QFETCH(int, numSamples);
+    QFETCH(bool, weighted);
+    QFETCH(bool, optimized);
+
+    const KoID depth(depthId);
+    QScopedPointer<KoMixColorsOp> op(createMixColorsOp(depth, optimized));
+    QVERIFY(op);
+
+    const int pixelSize = pixelSizeForDepth(depth);
+    const int numRepeats = 1024 * 1024 / numSamples;
+
+    QVector<quint8> pixels;
+    fillRandomPixels(depth, pixels, numSamples);
+
+    QVector<qint16> weights(numSamples, 255 / numSamples);
+    QVector<quint8> result(pixelSize);
+
+    QBENCHMARK {
+        for (int i = 0; i < numRepeats; i++) {
+            if (weighted) {
+                op->mixColors(pixels.constData(), weights.constData(), numSamples, result.data(), 255);
+            } else {
+                op->mixColors(pixels.constData(), numSamples, result.data());
+            }
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KoMixColorsOpBenchmark)
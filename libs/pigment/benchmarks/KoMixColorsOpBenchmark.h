@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KOMIXCOLORSOPBENCHMARK_H
+#define KOMIXCOLORSOPBENCHMARK_H
+
+#include <QObject>
+
+class KoMixColorsOpBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchmarkSmudgeSampling_data();
+    void benchmarkSmudgeSampling();
+
+    void benchmarkMixColors_data();
+    void benchmarkMixColors();
+};
+
+#endif // KOMIXCOLORSOPBENCHMARK_H
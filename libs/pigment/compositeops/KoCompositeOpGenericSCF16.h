@@ -0,0 +1,150 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#ifndef KOCOMPOSITEOPGENERICSCF16_H
+#define KOCOMPOSITEOPGENERICSCF16_H
+
+#include <KoConfig.h>
+
+#ifdef HAVE_OPENEXR
+
+#include <algorithm>
+#include <half.h>
+
+#include "KoColorSpaceTraits.h"
+#include "KoCompositeOpGeneric.h"
+
+/**
+ * A version of KoCompositeOpGenericSC for half-float color spaces.
+ *
+ * When the generic op is instantiated for half directly, every
+ * intermediate result of the blending arithmetic (mul(), lerp(),
+ * the blending function itself) is converted back into half and
+ * then into float again for the next operation. Instead, this op
+ * converts a block of source and destination pixels into float in
+ * bulk, composites the block with the float version of the op and
+ * converts the result back into half, so the pixel data in memory
+ * stays 16-bit and there are only two conversions per channel.
+ *
+ * The blending function and the blending policy are passed in their
+ * float form, \see AddGeneralOps
+ */
+template<class Traits,
+         float compositeFunc(float, float),
+         class FloatBlendingPolicy>
+class KoCompositeOpGenericSCF16 : public KoCompositeOp
+{
+    static_assert(std::is_same<typename Traits::channels_type, half>::value,
+                  "KoCompositeOpGenericSCF16 is meant for half-float color spaces only");
+
+    typedef typename Traits::channels_type channels_type;
+
+    static const qint32 channels_nb = Traits::channels_nb;
+    static const qint32 alpha_pos   = Traits::alpha_pos;
+
+    /**
+     * The number of pixels converted in one go. Both scratch buffers
+     * are placed on the stack and should fit into L1 cache.
+     */
+    static const qint32 blockPixels = 256;
+
+public:
+    typedef KoColorSpaceTrait<float, channels_nb, alpha_pos> FloatTraits;
+    typedef KoCompositeOpGenericSC<FloatTraits, compositeFunc, FloatBlendingPolicy> FloatCompositeOp;
+
+    KoCompositeOpGenericSCF16(const KoColorSpace* cs, const QString& id, const QString& category)
+        : KoCompositeOp(cs, id, category)
+        , m_floatOp(cs, id, category)
+    {
+    }
+
+    using KoCompositeOp::composite;
+
+    void composite(const KoCompositeOp::ParameterInfo& params) const override
+    {
+        float srcBlock[blockPixels * channels_nb];
+        float dstBlock[blockPixels * channels_nb];
+
+        KoCompositeOp::ParameterInfo block(params);
+        block.rows = 1;
+        block.dstRowStart = reinterpret_cast<quint8*>(dstBlock);
+        block.srcRowStart = reinterpret_cast<quint8*>(srcBlock);
+
+        const bool srcIsConstant = params.srcRowStride == 0;
+
+        if (srcIsConstant) {
+            // the same source pixel is used for the whole area
+            halfToFloat(reinterpret_cast<const channels_type*>(params.srcRowStart), srcBlock, 1);
+        }
+
+        const quint8 *srcRowStart = params.srcRowStart;
+        quint8 *dstRowStart = params.dstRowStart;
+        const quint8 *maskRowStart = params.maskRowStart;
+
+        for (qint32 r = 0; r < params.rows; ++r) {
+            const channels_type *src = reinterpret_cast<const channels_type*>(srcRowStart);
+            channels_type *dst = reinterpret_cast<channels_type*>(dstRowStart);
+            const quint8 *mask = maskRowStart;
+
+            for (qint32 c = 0; c < params.cols; c += blockPixels) {
+                const qint32 numPixels = qMin(blockPixels, params.cols - c);
+
+                halfToFloat(dst, dstBlock, numPixels);
+
+                if (!srcIsConstant) {
+                    halfToFloat(src, srcBlock, numPixels);
+                    src += numPixels * channels_nb;
+                }
+
+                block.cols = numPixels;
+                block.srcRowStride = srcIsConstant ? 0 : numPixels * channels_nb * sizeof(float);
+                block.maskRowStart = mask;
+
+                m_floatOp.composite(block);
+
+                floatToHalf(dstBlock, dst, numPixels);
+
+                dst += numPixels * channels_nb;
+                if (mask) {
+                    mask += numPixels;
+                }
+            }
+
+            srcRowStart += params.srcRowStride;
+            dstRowStart += params.dstRowStride;
+            if (maskRowStart) {
+                maskRowStart += params.maskRowStride;
+            }
+        }
+    }
+
+private:
+    static inline void halfToFloat(const channels_type *src, float *dst, qint32 numPixels)
+    {
+        const qint32 numValues = numPixels * channels_nb;
+        for (qint32 i = 0; i < numValues; i++) {
+            dst[i] = float(src[i]);
+        }
+    }
+
+    static inline void floatToHalf(const float *src, channels_type *dst, qint32 numPixels)
+    {
+        // the float blending functions may overflow the range of half
+        const float maxValue = KoColorSpaceMathsTraits<channels_type>::max;
+
+        const qint32 numValues = numPixels * channels_nb;
+        for (qint32 i = 0; i < numValues; i++) {
+            dst[i] = channels_type(std::max(std::min(src[i], maxValue), -maxValue));
+        }
+    }
+
+private:
+    const FloatCompositeOp m_floatOp;
+};
+
+#endif /* HAVE_OPENEXR */
+
+#endif // KOCOMPOSITEOPGENERICSCF16_H
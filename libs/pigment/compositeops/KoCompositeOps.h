@@ -15,6 +15,7 @@
 #include <KoColorSpaceMaths.h>
 
 #include "compositeops/KoCompositeOpGeneric.h"
+#include "compositeops/KoCompositeOpGenericSCF16.h"
 #include "compositeops/KoCompositeOpOver.h"
 #include "compositeops/KoCompositeOpCopyChannel.h"
 #include "compositeops/KoCompositeOpAlphaDarken.h"
@@ -123,16 +124,60 @@ struct OptimizedOpsSelector<KoBgrU16Traits>
     }
 };
 
+#ifdef HAVE_OPENEXR
+template<>
+struct OptimizedOpsSelector<KoRgbF16Traits>
+{
+    static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
+        return useCreamyAlphaDarken() ?
+            KoOptimizedCompositeOpFactory::createAlphaDarkenOpCreamyF16(cs) :
+            KoOptimizedCompositeOpFactory::createAlphaDarkenOpHardF16(cs);
+
+    }
+    static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createOverOpF16(cs);
+    }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createCopyOpF16(cs);
+    }
+};
+#endif
+
 
 template<class Traits>
 struct AddGeneralOps<Traits, true>
 {
-     typedef typename Traits::channels_type Arg;
+     /**
+      * The separable blending functions of the half-float color spaces
+      * are evaluated in float, \see KoCompositeOpGenericSCF16
+      */
+#ifdef HAVE_OPENEXR
+     static constexpr bool useFloatBlending = std::is_same_v<typename Traits::channels_type, half>;
+#else
+     static constexpr bool useFloatBlending = false;
+#endif
+
+     typedef std::conditional_t<useFloatBlending, float, typename Traits::channels_type> Arg;
      typedef Arg (*CompositeFunc)(Arg, Arg);
      static const qint32 alpha_pos = Traits::alpha_pos;
 
      template<CompositeFunc func>
      static void add(KoColorSpace* cs, const QString& id, const QString& category) {
+#ifdef HAVE_OPENEXR
+        if constexpr (useFloatBlending) {
+            typedef KoColorSpaceTrait<float, Traits::channels_nb, Traits::alpha_pos> FloatTraits;
+
+            if constexpr (std::is_base_of_v<KoCmykTraits<typename Traits::channels_type>, Traits>) {
+                if (useSubtractiveBlendingForCmykColorSpaces()) {
+                    cs->addCompositeOp(new KoCompositeOpGenericSCF16<Traits, func, KoSubtractiveBlendingPolicy<FloatTraits>>(cs, id, category));
+                } else {
+                    cs->addCompositeOp(new KoCompositeOpGenericSCF16<Traits, func, KoAdditiveBlendingPolicy<FloatTraits>>(cs, id, category));
+                }
+            } else {
+                cs->addCompositeOp(new KoCompositeOpGenericSCF16<Traits, func, KoAdditiveBlendingPolicy<FloatTraits>>(cs, id, category));
+            }
+        } else
+#endif
         if constexpr (std::is_base_of_v<KoCmykTraits<typename Traits::channels_type>, Traits>) {
             if (useSubtractiveBlendingForCmykColorSpaces()) {
                 cs->addCompositeOp(new KoCompositeOpGenericSC<Traits, func, KoSubtractiveBlendingPolicy<Traits>>(cs, id, category));
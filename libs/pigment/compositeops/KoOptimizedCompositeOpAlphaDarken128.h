@@ -148,7 +148,7 @@ struct AlphaDarkenCompositor128 {
         PixelWrapper<channels_type, _impl>::normalizeAlpha(dstAlphaNorm);
 
         const float uint8Rec1 = 1.0f / 255.0f;
-        float mskAlphaNorm = haveMask ? float(*mask) * uint8Rec1 * src[alpha_pos] : src[alpha_pos];
+        float mskAlphaNorm = haveMask ? float(*mask) * uint8Rec1 * float(src[alpha_pos]) : float(src[alpha_pos]);
         PixelWrapper<channels_type, _impl>::normalizeAlpha(mskAlphaNorm);
 
         Q_UNUSED(opacity);
@@ -270,5 +270,43 @@ public:
         : KoOptimizedCompositeOpAlphaDarkenU64Impl<_impl, KoAlphaDarkenParamsWrapperCreamy>(cs) {}
 };
 
+#ifdef HAVE_OPENEXR
+template<typename _impl, typename ParamsWrapper>
+class KoOptimizedCompositeOpAlphaDarkenF16Impl : public KoCompositeOp
+{
+public:
+    KoOptimizedCompositeOpAlphaDarkenF16Impl(const KoColorSpace* cs)
+        : KoCompositeOp(cs, COMPOSITE_ALPHA_DARKEN, KoCompositeOp::categoryMix()) {}
+
+    using KoCompositeOp::composite;
+
+    void composite(const KoCompositeOp::ParameterInfo& params) const override
+    {
+        if(params.maskRowStart) {
+            KoStreamedMath<_impl>::template genericComposite64<true, true, AlphaDarkenCompositor128<half, ParamsWrapper> >(params);
+        } else {
+            KoStreamedMath<_impl>::template genericComposite64<false, true, AlphaDarkenCompositor128<half, ParamsWrapper> >(params);
+        }
+    }
+};
+
+template<typename _impl>
+class KoOptimizedCompositeOpAlphaDarkenHardF16
+    : public KoOptimizedCompositeOpAlphaDarkenF16Impl<_impl, KoAlphaDarkenParamsWrapperHard>
+{
+public:
+    KoOptimizedCompositeOpAlphaDarkenHardF16(const KoColorSpace* cs)
+        : KoOptimizedCompositeOpAlphaDarkenF16Impl<_impl, KoAlphaDarkenParamsWrapperHard>(cs) {}
+};
+
+template<typename _impl>
+class KoOptimizedCompositeOpAlphaDarkenCreamyF16
+    : public KoOptimizedCompositeOpAlphaDarkenF16Impl<_impl, KoAlphaDarkenParamsWrapperCreamy>
+{
+public:
+    KoOptimizedCompositeOpAlphaDarkenCreamyF16(const KoColorSpace* cs)
+        : KoOptimizedCompositeOpAlphaDarkenF16Impl<_impl, KoAlphaDarkenParamsWrapperCreamy>(cs) {}
+};
+#endif
 
 #endif // KOOPTIMIZEDCOMPOSITEOPALPHADARKEN128_H
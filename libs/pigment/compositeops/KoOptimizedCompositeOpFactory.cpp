@@ -78,3 +78,29 @@ KoCompositeOp* KoOptimizedCompositeOpFactory::createCopyOpU64(const KoColorSpace
 {
     return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopyU64> >(cs);
 }
+
+#ifdef HAVE_OPENEXR
+KoCompositeOp* KoOptimizedCompositeOpFactory::createAlphaDarkenOpHardF16(const KoColorSpace *cs)
+{
+    return createOptimizedClass<
+        KoOptimizedCompositeOpFactoryPerArch<
+            KoOptimizedCompositeOpAlphaDarkenHardF16>>(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createAlphaDarkenOpCreamyF16(const KoColorSpace *cs)
+{
+    return createOptimizedClass<
+        KoOptimizedCompositeOpFactoryPerArch<
+            KoOptimizedCompositeOpAlphaDarkenCreamyF16>>(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createOverOpF16(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverF16> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createCopyOpF16(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopyF16> >(cs);
+}
+#endif
@@ -124,4 +124,42 @@ KoCompositeOp *KoOptimizedCompositeOpFactoryPerArch<
     return new KoOptimizedCompositeOpAlphaDarkenCreamyU64<xsimd::current_arch>(param);
 }
 
+#ifdef HAVE_OPENEXR
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarkenHardF16>::create<
+    xsimd::current_arch>(const KoColorSpace *param)
+{
+    return new KoOptimizedCompositeOpAlphaDarkenHardF16<xsimd::current_arch>(param);
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarkenCreamyF16>::create<
+    xsimd::current_arch>(const KoColorSpace *param)
+{
+    return new KoOptimizedCompositeOpAlphaDarkenCreamyF16<xsimd::current_arch>(param);
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverF16>::create<
+    xsimd::current_arch>(const KoColorSpace *param)
+{
+    return new KoOptimizedCompositeOpOverF16<xsimd::current_arch>(param);
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopyF16>::create<
+    xsimd::current_arch>(const KoColorSpace *param)
+{
+    return new KoOptimizedCompositeOpCopyF16<xsimd::current_arch>(param);
+}
+#endif
+
 #endif // XSIMD_UNIVERSAL_BUILD_PASS
@@ -9,6 +9,7 @@
 #define KOOPTIMIZEDCOMPOSITEOPFACTORYPERARCH_H
 
 #include <KoMultiArchBuildSupport.h>
+#include <KoConfig.h>
 
 class KoCompositeOp;
 class KoColorSpace;
@@ -49,6 +50,20 @@ class KoOptimizedCompositeOpCopyU64;
 template<typename _impl>
 class KoOptimizedCompositeOpCopy32;
 
+#ifdef HAVE_OPENEXR
+template<typename _impl>
+class KoOptimizedCompositeOpAlphaDarkenHardF16;
+
+template<typename _impl>
+class KoOptimizedCompositeOpAlphaDarkenCreamyF16;
+
+template<typename _impl>
+class KoOptimizedCompositeOpOverF16;
+
+template<typename _impl>
+class KoOptimizedCompositeOpCopyF16;
+#endif
+
 template<template<typename I> class CompositeOp>
 struct KoOptimizedCompositeOpFactoryPerArch {
     template<typename _impl>
@@ -121,3 +121,40 @@ KoCompositeOp *KoOptimizedCompositeOpFactoryPerArch<
     return new KoCompositeOpAlphaDarken<KoBgrU16Traits, KoAlphaDarkenParamsWrapperCreamy>(param);
 }
 
+#ifdef HAVE_OPENEXR
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarkenHardF16>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpAlphaDarken<KoRgbF16Traits, KoAlphaDarkenParamsWrapperHard>(param);
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarkenCreamyF16>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpAlphaDarken<KoRgbF16Traits, KoAlphaDarkenParamsWrapperCreamy>(param);
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOverF16>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpOver<KoRgbF16Traits>(param);
+}
+
+template<>
+template<>
+KoCompositeOp *
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopyF16>::create<
+    xsimd::generic>(const KoColorSpace *param)
+{
+    return new KoCompositeOpCopy2<KoRgbF16Traits>(param);
+}
+#endif
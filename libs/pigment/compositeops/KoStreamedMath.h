@@ -562,6 +562,19 @@ private:
     const float_v m_orig_c3;
 };
 
+#ifdef HAVE_OPENEXR
+template<class _impl>
+struct PixelStateRecoverHelper<half, _impl> : public PixelStateRecoverHelper<float, _impl> {
+    using float_v = xsimd::batch<float, _impl>;
+
+    ALWAYS_INLINE
+    PixelStateRecoverHelper(const float_v &c1, const float_v &c2, const float_v &c3)
+        : PixelStateRecoverHelper<float, _impl>(c1, c2, c3)
+    {
+    }
+};
+#endif
+
 template<typename channels_type, class _impl>
 struct PixelWrapper
 {
@@ -846,6 +859,179 @@ struct PixelWrapper<float, _impl> {
     }
 };
 
+#ifdef HAVE_OPENEXR
+
+/**
+ * Half-float pixels have the same 8-byte layout as 16-bit integer ones,
+ * so they are fetched with the same two-word gather. The conversion between
+ * half and float is done in bulk with integer arithmetic on the whole vector.
+ * It gives the same results as the F16C instructions (round-to-nearest-even),
+ * but doesn't require F16C to be enabled in the compiler flags.
+ *
+ * Like in float pixels, the color and alpha channels are stored in the
+ * normalized range already, so no scaling is needed.
+ */
+template<typename _impl>
+struct PixelWrapper<half, _impl> {
+    using int_v = xsimd::batch<int, _impl>;
+    using uint_v = xsimd::batch<unsigned int, _impl>;
+    using float_v = xsimd::batch<float, _impl>;
+
+    static_assert(int_v::size == uint_v::size, "the selected architecture does not guarantee vector size equality!");
+    static_assert(uint_v::size == float_v::size, "the selected architecture does not guarantee vector size equality!");
+
+    ALWAYS_INLINE
+    static half lerpMixedUintFloat(half a, half b, float alpha)
+    {
+        return half(Arithmetic::lerp(float(a), float(b), alpha));
+    }
+
+    ALWAYS_INLINE
+    static half roundFloatToUint(float x)
+    {
+        return half(x);
+    }
+
+    ALWAYS_INLINE
+    static void normalizeAlpha(float &alpha)
+    {
+        Q_UNUSED(alpha);
+    }
+
+    ALWAYS_INLINE
+    static void denormalizeAlpha(float &alpha)
+    {
+        Q_UNUSED(alpha);
+    }
+
+    PixelWrapper()
+        : mask(0xFFFF)
+    {
+    }
+
+    /**
+     * Converts half values stored in the lower 16 bits of every
+     * element of \p h into floats
+     */
+    ALWAYS_INLINE
+    static float_v halfToFloat(const uint_v &h)
+    {
+        const uint_v shiftedExp(0x7c00u << 13);
+        const uint_v denormMagic(113u << 23);
+
+        uint_v o = (h & uint_v(0x7fffu)) << 13;
+        const uint_v exp = o & shiftedExp;
+        o += uint_v((127u - 15u) << 23);
+
+        // Inf/NaN: adjust the exponent once more
+        o = xsimd::select(exp == shiftedExp, o + uint_v((128u - 16u) << 23), o);
+
+        // zero/denormal: renormalize via the FP unit
+        const float_v denorm =
+            xsimd::bitwise_cast_compat<float>(o + uint_v(1u << 23)) -
+            xsimd::bitwise_cast_compat<float>(denormMagic);
+        o = xsimd::select(exp == uint_v(0), xsimd::bitwise_cast_compat<unsigned int>(denorm), o);
+
+        o |= (h & uint_v(0x8000u)) << 16;
+
+        return xsimd::bitwise_cast_compat<float>(o);
+    }
+
+    /**
+     * Converts floats into half values stored in the lower 16 bits
+     * of every element of the result, rounding to the nearest even
+     */
+    ALWAYS_INLINE
+    static uint_v floatToHalf(const float_v &f)
+    {
+        const int_v f32Infinity(255 << 23);
+        const int_v f16Max((127 + 16) << 23);
+        const int_v f16MinNormal(113 << 23);
+        const int_v denormMagic(((127 - 15) + (23 - 10) + 1) << 23);
+
+        const int_v bits = xsimd::bitwise_cast_compat<int>(f);
+        const int_v absBits = bits & int_v(0x7fffffff);
+        const uint_v sign = xsimd::bitwise_cast_compat<unsigned int>(bits ^ absBits) >> 16;
+
+        // overflow becomes Inf, NaN stays (quiet) NaN
+        const int_v infNan = xsimd::select(absBits > f32Infinity, int_v(0x7e00), int_v(0x7c00));
+
+        // denormals: let the FP addition do the rounding
+        const int_v denorm =
+            xsimd::bitwise_cast_compat<int>(xsimd::bitwise_cast_compat<float>(absBits) +
+                                            xsimd::bitwise_cast_compat<float>(denormMagic)) - denormMagic;
+
+        // normals: rebias the exponent and round the mantissa
+        const int_v mantOdd = (absBits >> 13) & int_v(1);
+        const int_v normal = (absBits + int_v(((15 - 127) << 23) + 0xfff) + mantOdd) >> 13;
+
+        const int_v result =
+            xsimd::select(absBits >= f16Max, infNan,
+                          xsimd::select(absBits < f16MinNormal, denorm, normal));
+
+        return xsimd::bitwise_cast_compat<unsigned int>(result) | sign;
+    }
+
+    ALWAYS_INLINE void read(const void *src, float_v &dst_c1, float_v &dst_c2, float_v &dst_c3, float_v &dst_alpha)
+    {
+        // struct PackedPixel {
+        //    float rrgg;
+        //    float bbaa;
+        // }
+#if XSIMD_VERSION_MAJOR < 10
+        uint_v pixelsC1C2;
+        uint_v pixelsC3Alpha;
+        KoRgbaInterleavers<16>::deinterleave(src, pixelsC1C2, pixelsC3Alpha);
+#else
+        const auto *srcPtr = static_cast<const typename uint_v::value_type *>(src);
+        const auto idx1 = xsimd::detail::make_sequence_as_batch<int_v>() * 2; // stride == 2
+        const auto idx2 = idx1 + 1; // offset 1 == 2nd members
+
+        const auto pixelsC1C2 = uint_v::gather(srcPtr, idx1);
+        const auto pixelsC3Alpha = uint_v::gather(srcPtr, idx2);
+#endif
+
+        dst_c1 = halfToFloat(pixelsC1C2 & mask); // r
+        dst_c2 = halfToFloat(pixelsC1C2 >> 16); // g
+        dst_c3 = halfToFloat(pixelsC3Alpha & mask); // b
+        dst_alpha = halfToFloat(pixelsC3Alpha >> 16); // a
+    }
+
+    ALWAYS_INLINE void write(void *dst, const float_v &c1, const float_v &c2, const float_v &c3, const float_v &a)
+    {
+        const auto c1c2 = (floatToHalf(c2) << 16) | floatToHalf(c1);
+        const auto c3ca = (floatToHalf(a) << 16) | floatToHalf(c3);
+
+#if XSIMD_VERSION_MAJOR < 10
+        KoRgbaInterleavers<16>::interleave(dst, c1c2, c3ca);
+#else
+        auto dstPtr = reinterpret_cast<typename uint_v::value_type *>(dst);
+
+        const auto idx1 = xsimd::detail::make_sequence_as_batch<int_v>() * 2;
+        const auto idx2 = idx1 + 1;
+
+        c1c2.scatter(dstPtr, idx1);
+        c3ca.scatter(dstPtr, idx2);
+#endif
+    }
+
+    ALWAYS_INLINE
+    void clearPixels(quint8 *dataDst)
+    {
+        memset(dataDst, 0, float_v::size * sizeof(half) * 4);
+    }
+
+    ALWAYS_INLINE
+    void copyPixels(const quint8 *dataSrc, quint8 *dataDst)
+    {
+        memcpy(dataDst, dataSrc, float_v::size * sizeof(half) * 4);
+    }
+
+    const uint_v mask;
+};
+
+#endif /* HAVE_OPENEXR */
+
 namespace KoStreamedMathFunctions
 {
 template<int pixelSize>
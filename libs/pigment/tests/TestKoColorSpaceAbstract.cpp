@@ -8,6 +8,7 @@
 #include "KoColorSpaceTraits.h"
 
 #include <cfloat>
+#include <numeric>
 
 #include <simpletest.h>
 
@@ -398,10 +399,122 @@ void TestKoColorSpaceAbstract::testMixColorsOpU8NoAlphaLinear()
     QCOMPARE(outputPixel[COLOR_CHANNEL_2], mixOpNoAlphaExpectedColor(pixel1[COLOR_CHANNEL_2], pixel2[COLOR_CHANNEL_2], weights));
 }
 
+#include <KoOptimizedMixColorsOpFactory.h>
+#include <KoColorModelStandardIdsUtils.h>
+#include <random>
+#include <algorithm>
+
+template <typename channels_type>
+void fillRandomRgbaPixels(std::vector<channels_type> &pixels, std::mt19937 &gen)
+{
+    using MathsTraits = KoColorSpaceMathsTraits<channels_type>;
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = KoColorSpaceMaths<quint8, channels_type>::scaleToA(quint8(dist(gen)));
+    }
+
+    // make some pixels fully transparent and fully opaque
+    for (size_t i = 3; i < pixels.size(); i += 4 * 7) {
+        pixels[i] = MathsTraits::zeroValue;
+    }
+    for (size_t i = 7; i < pixels.size(); i += 4 * 5) {
+        pixels[i] = MathsTraits::unitValue;
+    }
+}
+
+template <typename channels_type>
+void compareOptimizedMixColorsOp(int numPixels, channels_type tolerance)
+{
+    using Trait = KoColorSpaceTrait<channels_type, 4, 3>;
+
+    KoMixColorsOpImpl<Trait> scalarOp;
+    QScopedPointer<KoMixColorsOp> optimizedOp(
+        KoOptimizedMixColorsOpFactory::createRgbaOp(colorDepthIdForChannelType<channels_type>()));
+    QVERIFY(optimizedOp);
+
+    std::mt19937 gen(numPixels);
+    std::uniform_int_distribution<int> weightsDist(0, 255);
+
+    std::vector<channels_type> pixels(numPixels * 4);
+    fillRandomRgbaPixels(pixels, gen);
+
+    std::vector<qint16> weights(numPixels);
+    int weightsSum = 0;
+    for (int i = 0; i < numPixels; i++) {
+        weights[i] = weightsDist(gen);
+        weightsSum += weights[i];
+    }
+
+    const quint8 *data = reinterpret_cast<const quint8*>(pixels.data());
+
+    auto compareResults = [tolerance] (const channels_type *expected, const channels_type *result) {
+        for (int i = 0; i < 4; i++) {
+            const qreal difference = qAbs(qreal(expected[i]) - qreal(result[i]));
+            if (difference > qreal(tolerance)) {
+                qWarning() << "Channel" << i << "differs:" << qreal(expected[i]) << qreal(result[i]);
+                return false;
+            }
+        }
+        return true;
+    };
+
+    channels_type expected[4];
+    channels_type result[4];
+
+    scalarOp.mixColors(data, weights.data(), numPixels, reinterpret_cast<quint8*>(expected), weightsSum);
+    optimizedOp->mixColors(data, weights.data(), numPixels, reinterpret_cast<quint8*>(result), weightsSum);
+    QVERIFY(compareResults(expected, result));
+
+    scalarOp.mixColors(data, numPixels, reinterpret_cast<quint8*>(expected));
+    optimizedOp->mixColors(data, numPixels, reinterpret_cast<quint8*>(result));
+    QVERIFY(compareResults(expected, result));
+
+    // feed the mixer in uneven chunks to check the tail processing
+    QScopedPointer<KoMixColorsOp::Mixer> scalarMixer(scalarOp.createMixer());
+    QScopedPointer<KoMixColorsOp::Mixer> optimizedMixer(optimizedOp->createMixer());
+
+    for (int offset = 0, chunk = 1; offset < numPixels; offset += chunk, chunk = chunk * 2 + 1) {
+        const int size = qMin(chunk, numPixels - offset);
+        const int chunkWeightsSum = std::accumulate(weights.begin() + offset, weights.begin() + offset + size, 0);
+
+        scalarMixer->accumulate(data + offset * Trait::pixelSize, weights.data() + offset, chunkWeightsSum, size);
+        optimizedMixer->accumulate(data + offset * Trait::pixelSize, weights.data() + offset, chunkWeightsSum, size);
+    }
+
+    QCOMPARE(optimizedMixer->currentWeightsSum(), scalarMixer->currentWeightsSum());
+
+    scalarMixer->computeMixedColor(reinterpret_cast<quint8*>(expected));
+    optimizedMixer->computeMixedColor(reinterpret_cast<quint8*>(result));
+    QVERIFY(compareResults(expected, result));
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOp_data()
+{
+    QTest::addColumn<int>("numPixels");
+
+    QTest::addRow("1") << 1;
+    QTest::addRow("7") << 7;
+    QTest::addRow("64") << 64;
+    QTest::addRow("1031") << 1031;
+    QTest::addRow("65536") << 65536;
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOp()
+{
+    QFETCH(int, numPixels);
+
+    // 8-bit version is supposed to be bit-exact
+    compareOptimizedMixColorsOp<quint8>(numPixels, 0);
+    compareOptimizedMixColorsOp<quint16>(numPixels, 1);
+    compareOptimizedMixColorsOp<float>(numPixels, 1e-5f);
+}
+
 #include <KoColorSpaceRegistry.h>
 #include <QByteArray>
 #include <KoColor.h>
 #include <KoCompositeOpRegistry.h>
+#include <kis_debug.h>
 
 KoColor makeColor(std::initializer_list<quint8> data, const KoColorSpace *cs)
 {
@@ -598,5 +711,110 @@ void TestKoColorSpaceAbstract::testBitBltCrossColorSpaceWithChannelFlags()
     }
 }
 
+void fillRandomPixels(quint8 *data, int numPixels, const KoColorSpace *cs, std::mt19937 &gen)
+{
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    for (int i = 0; i < numPixels; i++) {
+        const QColor color(dist(gen), dist(gen), dist(gen), dist(gen));
+        cs->fromQColor(color, data + i * cs->pixelSize());
+    }
+}
+
+void TestKoColorSpaceAbstract::testBitBltCrossColorSpaceInBlocks_data()
+{
+    QTest::addColumn<QString>("srcDepth");
+    QTest::addColumn<QString>("dstDepth");
+    QTest::addColumn<int>("numColumns");
+    QTest::addColumn<int>("numRows");
+    QTest::addColumn<bool>("constantSource");
+    QTest::addColumn<bool>("useMask");
+
+    const QString u8 = Integer8BitsColorDepthID.id();
+    const QString u16 = Integer16BitsColorDepthID.id();
+    const QString f32 = Float32BitsColorDepthID.id();
+
+    QTest::newRow("u16->u8") << u16 << u8 << 64 << 64 << false << false;
+    QTest::newRow("u16->u8, mask") << u16 << u8 << 301 << 71 << false << true;
+    QTest::newRow("u8->f32, mask") << u8 << f32 << 301 << 71 << false << true;
+    QTest::newRow("f32->u8, long rows") << f32 << u8 << 2500 << 3 << false << true;
+    QTest::newRow("f32->u16, constant") << f32 << u16 << 301 << 71 << true << true;
+}
+
+void TestKoColorSpaceAbstract::testBitBltCrossColorSpaceInBlocks()
+{
+    QFETCH(QString, srcDepth);
+    QFETCH(QString, dstDepth);
+    QFETCH(int, numColumns);
+    QFETCH(int, numRows);
+    QFETCH(bool, constantSource);
+    QFETCH(bool, useMask);
+
+    const KoColorSpace *srcSpace = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), srcDepth);
+    const KoColorSpace *dstSpace = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), dstDepth);
+
+    const int numPixels = numColumns * numRows;
+    const int srcPixelSize = srcSpace->pixelSize();
+    const int dstPixelSize = dstSpace->pixelSize();
+
+    std::mt19937 gen(13);
+
+    QVector<quint8> srcData((constantSource ? 1 : numPixels) * srcPixelSize);
+    QVector<quint8> dstData(numPixels * dstPixelSize);
+    QVector<quint8> mask(numPixels);
+
+    fillRandomPixels(srcData.data(), constantSource ? 1 : numPixels, srcSpace, gen);
+    fillRandomPixels(dstData.data(), numPixels, dstSpace, gen);
+    std::generate(mask.begin(), mask.end(), [&gen] () { return quint8(gen() & 0xff); });
+
+    QVector<quint8> expectedData(dstData);
+
+    const KoCompositeOp *op = dstSpace->compositeOp(COMPOSITE_OVER);
+
+    KoCompositeOp::ParameterInfo params;
+    params.rows = numRows;
+    params.cols = numColumns;
+    params.srcRowStart = srcData.data();
+    params.srcRowStride = constantSource ? 0 : numColumns * srcPixelSize;
+    params.dstRowStart = dstData.data();
+    params.dstRowStride = numColumns * dstPixelSize;
+    params.maskRowStart = useMask ? mask.data() : nullptr;
+    params.maskRowStride = useMask ? numColumns : 0;
+    params.opacity = 0.8f;
+
+    // reference: convert the whole source first, then composite it
+    QVector<quint8> convertedSrc((constantSource ? 1 : numPixels) * dstPixelSize);
+    srcSpace->convertPixelsTo(srcData.data(), convertedSrc.data(), dstSpace, constantSource ? 1 : numPixels,
+                              KoColorConversionTransformation::internalRenderingIntent(),
+                              KoColorConversionTransformation::internalConversionFlags());
+
+    KoCompositeOp::ParameterInfo refParams(params);
+    refParams.srcRowStart = convertedSrc.data();
+    refParams.srcRowStride = constantSource ? 0 : numColumns * dstPixelSize;
+    refParams.dstRowStart = expectedData.data();
+    op->composite(refParams);
+
+    dstSpace->bitBlt(srcSpace, params, op,
+                     KoColorConversionTransformation::internalRenderingIntent(),
+                     KoColorConversionTransformation::internalConversionFlags());
+
+    // the optimized composite ops process unaligned head/tail pixels
+    // with a scalar path, so allow a rounding difference of one step
+    QVector<float> channels(dstSpace->channelCount());
+    QVector<float> expectedChannels(dstSpace->channelCount());
+
+    for (int i = 0; i < numPixels; i++) {
+        dstSpace->normalisedChannelsValue(dstData.data() + i * dstPixelSize, channels);
+        dstSpace->normalisedChannelsValue(expectedData.data() + i * dstPixelSize, expectedChannels);
+
+        for (int ch = 0; ch < channels.size(); ch++) {
+            if (qAbs(channels[ch] - expectedChannels[ch]) > 1.5f / 255.0f) {
+                qDebug() << ppVar(i) << ppVar(ch) << ppVar(channels[ch]) << ppVar(expectedChannels[ch]);
+                QFAIL("bitBlt result differs from the reference");
+            }
+        }
+    }
+}
+
 
 SIMPLE_TEST_MAIN(TestKoColorSpaceAbstract)
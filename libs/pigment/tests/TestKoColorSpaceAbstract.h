@@ -15,8 +15,12 @@ private Q_SLOTS:
     void testMixColorsOpF32();
     void testMixColorsOpU8NoAlpha();
     void testMixColorsOpU8NoAlphaLinear();
+    void testOptimizedMixColorsOp_data();
+    void testOptimizedMixColorsOp();
     void testBitBltCrossColorSpaceWithChannelFlags_data();
     void testBitBltCrossColorSpaceWithChannelFlags();
+    void testBitBltCrossColorSpaceInBlocks_data();
+    void testBitBltCrossColorSpaceInBlocks();
 
 };
 
@@ -41,6 +41,18 @@
 
 //#define DEBUG_BEZIER_CURVES
 
+/**
+ * Records every stroke into the directory set by KRITA_RECORD_STROKES
+ * environment variable. The recordings are replayed by KisStrokeBenchmark.
+ */
+//#define RECORD_STROKES
+
+#ifdef RECORD_STROKES
+#include <QDir>
+#include <QDateTime>
+#include "KisStrokeRecording.h"
+#endif
+
 // Factor by which to scale the airbrush timer's interval, relative to the actual airbrushing rate.
 // Setting this less than 1 makes the timer-generated pseudo-events happen faster than the desired
 // airbrush rate, which can improve responsiveness.
@@ -103,6 +115,14 @@ struct KisToolFreehandHelper::Private
     KisStabilizedEventsSampler stabilizedSampler;
     KisStabilizerDelayedPaintHelper stabilizerDelayedPaintHelper;
 
+#ifdef RECORD_STROKES
+    // Recording of the strokes for the benchmarks
+    QString recordingDirectory;
+    QScopedPointer<KisStrokeRecording> recording;
+
+    void saveRecording();
+#endif
+
     qreal effectiveSmoothnessDistance() const;
 };
 
@@ -122,6 +142,14 @@ KisToolFreehandHelper::KisToolFreehandHelper(KisPaintingInformationBuilder *info
     m_d->fakeDabRandomSource = new KisRandomSource();
     m_d->fakeStrokeRandomSource = new KisPerStrokeRandomSource();
 
+#ifdef RECORD_STROKES
+    m_d->recordingDirectory = qEnvironmentVariable("KRITA_RECORD_STROKES");
+    if (!m_d->recordingDirectory.isEmpty() && !QDir(m_d->recordingDirectory).exists()) {
+        warnKrita << "KRITA_RECORD_STROKES points to a non-existent directory:" << m_d->recordingDirectory;
+        m_d->recordingDirectory.clear();
+    }
+#endif
+
     m_d->strokeTimeoutTimer.setSingleShot(true);
     connect(&m_d->strokeTimeoutTimer, SIGNAL(timeout()), SLOT(finishStroke()));
     connect(&m_d->airbrushingTimer, SIGNAL(timeout()), SLOT(doAirbrushing()));
@@ -305,6 +333,13 @@ void KisToolFreehandHelper::initPaintImpl(qreal startAngle,
 
     m_d->strokeId = m_d->strokesFacade->startStroke(stroke);
 
+#ifdef RECORD_STROKES
+    if (!m_d->recordingDirectory.isEmpty()) {
+        m_d->recording.reset(new KisStrokeRecording());
+        m_d->recording->beginStroke();
+    }
+#endif
+
     m_d->history.clear();
     m_d->distanceHistory.clear();
 
@@ -438,6 +473,24 @@ qreal KisToolFreehandHelper::Private::effectiveSmoothnessDistance() const
     return smoothingOptions->smoothnessDistance() * zoomingCoeff;
 }
 
+#ifdef RECORD_STROKES
+void KisToolFreehandHelper::Private::saveRecording()
+{
+    if (!recording) return;
+
+    const QString fileName =
+        QDir(recordingDirectory).filePath(
+            QString("stroke-%1.kisstroke")
+                .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss-zzz")));
+
+    if (!recording->isEmpty() && !recording->save(fileName)) {
+        warnKrita << "Failed to save the stroke recording to" << fileName;
+    }
+
+    recording.reset();
+}
+#endif
+
 void KisToolFreehandHelper::paintEvent(KoPointerEvent *event)
 {
     KisPaintInformation info =
@@ -647,6 +700,10 @@ void KisToolFreehandHelper::endPaint()
     m_d->strokesFacade->endStroke(m_d->strokeId);
     m_d->strokeId.clear();
     m_d->infoBuilder->reset();
+
+#ifdef RECORD_STROKES
+    m_d->saveRecording();
+#endif
 }
 
 void KisToolFreehandHelper::cancelPaint()
@@ -677,6 +734,9 @@ void KisToolFreehandHelper::cancelPaint()
     m_d->strokesFacade->cancelStroke(m_d->strokeId);
     m_d->strokeId.clear();
 
+#ifdef RECORD_STROKES
+    m_d->recording.reset();
+#endif
 }
 
 int KisToolFreehandHelper::elapsedStrokeTime() const
@@ -918,6 +978,12 @@ qreal KisToolFreehandHelper::currentPhysicalZoom() const
 void KisToolFreehandHelper::paintAt(int strokeInfoId,
                                     const KisPaintInformation &pi)
 {
+#ifdef RECORD_STROKES
+    if (m_d->recording) {
+        m_d->recording->addPaintAt(strokeInfoId, pi);
+    }
+#endif
+
     m_d->hasPaintAtLeastOnce = true;
     m_d->strokesFacade->addJob(m_d->strokeId,
                                new FreehandStrokeStrategy::Data(strokeInfoId, pi));
@@ -928,6 +994,12 @@ void KisToolFreehandHelper::paintLine(int strokeInfoId,
                                       const KisPaintInformation &pi1,
                                       const KisPaintInformation &pi2)
 {
+#ifdef RECORD_STROKES
+    if (m_d->recording) {
+        m_d->recording->addPaintLine(strokeInfoId, pi1, pi2);
+    }
+#endif
+
     m_d->hasPaintAtLeastOnce = true;
     m_d->strokesFacade->addJob(m_d->strokeId,
                                new FreehandStrokeStrategy::Data(strokeInfoId, pi1, pi2));
@@ -964,6 +1036,12 @@ void KisToolFreehandHelper::paintBezierCurve(int strokeInfoId,
     paintLine(tpi1, tpi2);
 #endif
 
+#ifdef RECORD_STROKES
+    if (m_d->recording) {
+        m_d->recording->addPaintBezierCurve(strokeInfoId, pi1, control1, control2, pi2);
+    }
+#endif
+
     m_d->hasPaintAtLeastOnce = true;
     m_d->strokesFacade->addJob(m_d->strokeId,
                                new FreehandStrokeStrategy::Data(strokeInfoId,
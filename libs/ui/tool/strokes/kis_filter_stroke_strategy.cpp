@@ -15,6 +15,7 @@
 #include <kis_paint_device_frames_interface.h>
 #include <KisRunnableStrokeJobUtils.h>
 #include <KisRunnableStrokeJobsInterface.h>
+#include <KisThreadPoolRunnableStrokeJobsExecutor.h>
 #include <KoCompositeOpRegistry.h>
 #include "kis_image_config.h"
 #include "kis_image_animation_interface.h"
@@ -246,7 +247,21 @@ void KisFilterStrokeStrategy::doStrokeCallback(KisStrokeJobData *data)
 
             QVector<KisRunnableStrokeJobData*> processJobs;
 
-            if (shared->filter()->supportsThreading()) {
+            if (shared->filter()->supportsBlockedProcessing(shared->filterConfig(), shared->levelOfDetail())) {
+                // The filter splits the area into blocks itself. The blocks
+                // are processed on the global thread pool, because the
+                // filter needs a synchronous interface to wait for the
+                // results of each of its passes.
+                if (!shared->processRect.isEmpty()) {
+                    addJobSequential(processJobs, [shared, progress](){
+                        KisThreadPoolRunnableStrokeJobsExecutor executor;
+                        shared->filter()->processImplBlocked(shared->filterDevice, shared->processRect,
+                                                             shared->filterConfig().data(),
+                                                             progress->updater(),
+                                                             &executor);
+                    });
+                }
+            } else if (shared->filter()->supportsThreading()) {
                 // Split stroke into patches...
                 QSize size = KritaUtils::optimalPatchSize();
                 QVector<QRect> patches = KritaUtils::splitRectIntoPatches(shared->processRect, size);
@@ -10,7 +10,10 @@
 #include <KisIdleTaskStrokeStrategy.h>
 #include <vector>
 
+#include <QSharedPointer>
+
 class KoColorSpace;
+class KisTiledHistogram;
 
 
 using HistVector = std::vector<std::vector<quint32> >; //Don't use QVector here - it's too slow for this purpose
@@ -27,16 +30,17 @@ class HistogramComputationStrokeStrategy : public KisIdleTaskStrokeStrategy
 {
     Q_OBJECT
 public:
-    HistogramComputationStrokeStrategy(KisImageSP image);
+    /**
+     * The strategy recounts the dirty cells of \p histogram, so only
+     * the parts of the image changed since the previous run are scanned
+     */
+    HistogramComputationStrokeStrategy(KisImageSP image, QSharedPointer<KisTiledHistogram> histogram);
     ~HistogramComputationStrokeStrategy() override;
 
 private:
     void initStrokeCallback() override;
-    void doStrokeCallback(KisStrokeJobData *data) override;
     void finishStrokeCallback() override;
 
-    void initiateVector(HistVector &vec, const KoColorSpace* colorSpace);
-
 Q_SIGNALS:
     //Emitted when thumbnail is updated and overviewImage is fully generated.
     void computationResultReady(HistogramData data);
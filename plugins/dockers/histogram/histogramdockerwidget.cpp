@@ -18,11 +18,15 @@
 #include "KoChannelInfo.h"
 #include "KisViewManager.h"
 #include "kis_canvas2.h"
+#include "kis_image.h"
+#include "kis_image_animation_interface.h"
+#include "KisTiledHistogram.h"
 
 
 
 HistogramDockerWidget::HistogramDockerWidget(QWidget *parent, const char *name, Qt::WindowFlags f)
     : KisWidgetWithIdleTask<QLabel>(parent, f)
+    , m_histogram(new KisTiledHistogram())
 {
     setObjectName(name);
     qRegisterMetaType<HistogramData>();
@@ -43,11 +47,52 @@ KisIdleTasksManager::TaskGuard HistogramDockerWidget::registerIdleTask(KisCanvas
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(canvas, KisIdleTasksManager::TaskGuard());
 
+    /**
+     * The image emits the updates from the worker threads, so the
+     * histogram is marked dirty directly, without waiting for the
+     * event loop. KisTiledHistogram::setDirty() is thread-safe.
+     */
+    m_imageConnections.clear();
+    QSharedPointer<KisTiledHistogram> histogram = m_histogram;
+    KisImageWSP image = canvas->image();
+
+    m_imageConnections.addConnection(image.data(), &KisImage::sigImageUpdated, this,
+                                     [histogram] (const QRect &rc) { histogram->setDirty(rc); },
+                                     Qt::DirectConnection);
+
+    /**
+     * The whole projection may change without the updates of the
+     * changed areas: the image may be resized or cropped (the bounds
+     * may stay the same, but the content is moved), the graph may be
+     * refreshed, or the projection may be regenerated for another
+     * frame. An external frame is regenerated in a temporary
+     * projection, so the cells counted meanwhile are recounted when
+     * it is done. The moves of the layers are reported by the updates
+     * of both the old and the new areas.
+     */
+    auto setAllDirty = [histogram, image] () {
+        KisImageSP strongImage = image.toStrongRef();
+        if (strongImage) {
+            histogram->setDirty(strongImage->bounds());
+        }
+    };
+
+    m_imageConnections.addConnection(image.data(), &KisImage::sigSizeChanged, this,
+                                     setAllDirty, Qt::DirectConnection);
+    m_imageConnections.addConnection(image.data(), &KisImage::sigLayersChangedAsync, this,
+                                     setAllDirty, Qt::DirectConnection);
+    m_imageConnections.addConnection(image->animationInterface(), &KisImageAnimationInterface::sigFrameReady, this,
+                                     setAllDirty, Qt::DirectConnection);
+    m_imageConnections.addConnection(image->animationInterface(), &KisImageAnimationInterface::sigFrameCancelled, this,
+                                     setAllDirty, Qt::DirectConnection);
+    m_imageConnections.addConnection(image->animationInterface(), &KisImageAnimationInterface::sigFrameRegenerated, this,
+                                     setAllDirty, Qt::DirectConnection);
+
     return
         canvas->viewManager()->idleTasksManager()->
         addIdleTaskWithGuard([this](KisImageSP image) {
             HistogramComputationStrokeStrategy* strategy =
-                new HistogramComputationStrokeStrategy(image);
+                new HistogramComputationStrokeStrategy(image, m_histogram);
 
             connect(strategy, SIGNAL(computationResultReady(HistogramData)), this, SLOT(receiveNewHistogram(HistogramData)));
 
@@ -59,6 +104,7 @@ void HistogramDockerWidget::clearCachedState()
 {
     m_colorSpace = 0;
     m_histogramData.clear();
+    m_histogram->clear();
 }
 
 void HistogramDockerWidget::paintEvent(QPaintEvent *event)
@@ -12,10 +12,13 @@
 #include <QWidget>
 #include <QLabel>
 #include <QThread>
+#include <QSharedPointer>
 #include "HistogramComputationStrokeStrategy.h"
 #include "KisWidgetWithIdleTask.h"
+#include "kis_signal_auto_connection.h"
 
 class KoColorSpace;
+class KisTiledHistogram;
 
 class HistogramDockerWidget : public KisWidgetWithIdleTask<QLabel>
 {
@@ -34,6 +37,13 @@ private:
     void clearCachedState() override;
 
 private:
+    /**
+     * The partial histograms are kept between the runs of the idle
+     * task, so that only the changed parts of the image are recounted
+     */
+    QSharedPointer<KisTiledHistogram> m_histogram;
+    KisSignalAutoConnectionsStore m_imageConnections;
+
     HistVector m_histogramData;
     const KoColorSpace* m_colorSpace {0};
     bool m_smoothHistogram {false};
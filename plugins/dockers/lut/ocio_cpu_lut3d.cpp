@@ -0,0 +1,320 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "ocio_cpu_lut3d.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QGlobalStatic>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QScopedPointer>
+
+#include <kis_assert.h>
+
+namespace {
+
+/**
+ * Every bake of a 65^3 lattice takes about 3 MiB, so only the last few
+ * display configurations are kept around. It is enough for switching
+ * between the views and canvases without rebaking.
+ */
+const int maxCacheSize = 4;
+
+struct LatticeCache
+{
+    QMutex mutex;
+
+    // the most recently used bake goes first
+    QList<QPair<QString, QSharedPointer<const OcioCpuLut3D>>> entries;
+};
+
+Q_GLOBAL_STATIC(LatticeCache, s_cache)
+
+QString cacheKey(const QString &processorCacheId, const OcioCpuLut3DShaper &shaper, int edgeLength)
+{
+    return QString("%1|%2|%3|%4|%5|%6")
+        .arg(processorCacheId)
+        .arg(shaper.isLog)
+        .arg(shaper.min)
+        .arg(shaper.max)
+        .arg(shaper.offset)
+        .arg(edgeLength);
+}
+
+QSharedPointer<const OcioCpuLut3D> takeFromCacheLocked(const QString &key)
+{
+    for (int i = 0; i < s_cache->entries.size(); i++) {
+        if (s_cache->entries[i].first == key) {
+            s_cache->entries.move(i, 0);
+            return s_cache->entries.first().second;
+        }
+    }
+
+    return QSharedPointer<const OcioCpuLut3D>();
+}
+
+const OcioCpuLut3DInterpolatorBase *interpolator()
+{
+    static const QScopedPointer<OcioCpuLut3DInterpolatorBase> s_interpolator(
+        createOptimizedClass<OcioCpuLut3DInterpolatorFactory>());
+
+    return s_interpolator.data();
+}
+
+inline bool fuzzyCompareValues(float a, float b, float tolerance)
+{
+    return std::abs(a - b) <= tolerance * std::max(1.0f, std::max(std::abs(a), std::abs(b)));
+}
+
+} // namespace
+
+OcioCpuLut3DShaper OcioCpuLut3D::shaperForColorSpace(OCIO::ConstColorSpaceRcPtr colorSpace)
+{
+    OcioCpuLut3DShaper shaper;
+
+    if (!colorSpace) {
+        return shaper;
+    }
+
+    shaper.isLog = colorSpace->getAllocation() == OCIO::ALLOCATION_LG2;
+
+    const int numVars = colorSpace->getAllocationNumVars();
+
+    if (numVars >= 2) {
+        float vars[3] = {0.0f, 0.0f, 0.0f};
+        colorSpace->getAllocationVars(vars);
+
+        shaper.min = vars[0];
+        shaper.max = vars[1];
+        if (numVars >= 3) {
+            shaper.offset = vars[2];
+        }
+    } else if (shaper.isLog) {
+        // the defaults OCIO uses for the log allocation without variables
+        shaper.min = -10.0f;
+        shaper.max = 6.0f;
+    }
+
+    if (!(shaper.max > shaper.min)) {
+        shaper = OcioCpuLut3DShaper();
+    }
+
+    return shaper;
+}
+
+QSharedPointer<const OcioCpuLut3D> OcioCpuLut3D::lookup(const QString &processorCacheId,
+                                                        const OcioCpuLut3DShaper &shaper,
+                                                        int edgeLength)
+{
+    QMutexLocker l(&s_cache->mutex);
+    return takeFromCacheLocked(cacheKey(processorCacheId, shaper, edgeLength));
+}
+
+QSharedPointer<const OcioCpuLut3D> OcioCpuLut3D::fetch(const QString &processorCacheId,
+                                                       const OcioCpuLut3DShaper &shaper,
+                                                       const ExactTransform &exactTransform,
+                                                       int edgeLength)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(edgeLength >= 2, QSharedPointer<const OcioCpuLut3D>());
+
+    const QString key = cacheKey(processorCacheId, shaper, edgeLength);
+
+    /**
+     * The bake is done under the lock, so that two canvases showing the
+     * same configuration don't bake the same lattice twice.
+     */
+    QMutexLocker l(&s_cache->mutex);
+
+    QSharedPointer<const OcioCpuLut3D> lut = takeFromCacheLocked(key);
+
+    if (!lut) {
+        lut.reset(new OcioCpuLut3D(shaper, edgeLength, exactTransform));
+
+        s_cache->entries.prepend(qMakePair(key, lut));
+        while (s_cache->entries.size() > maxCacheSize) {
+            s_cache->entries.removeLast();
+        }
+    }
+
+    return lut;
+}
+
+void OcioCpuLut3D::clearCache()
+{
+    QMutexLocker l(&s_cache->mutex);
+    s_cache->entries.clear();
+}
+
+int OcioCpuLut3D::cacheSize()
+{
+    QMutexLocker l(&s_cache->mutex);
+    return s_cache->entries.size();
+}
+
+OcioCpuLut3D::OcioCpuLut3D(const OcioCpuLut3DShaper &shaper, int edgeLength, const ExactTransform &exactTransform)
+    : m_shaper(shaper)
+    , m_edgeLength(edgeLength)
+{
+    probeAlphaBehavior(exactTransform);
+
+    if (m_isUsable) {
+        bakeLattice(exactTransform);
+    }
+}
+
+void OcioCpuLut3D::bakeLattice(const ExactTransform &exactTransform)
+{
+    const int n = m_edgeLength;
+
+    QVector<float> axisValues(n);
+    for (int i = 0; i < n; i++) {
+        axisValues[i] = m_shaper.fromDomain(float(i) / (n - 1));
+    }
+
+    m_lattice.resize(n * n * n * 3);
+
+    // the transform is applied to one blue slice of the lattice at a time
+    QVector<float> slice(n * n * 4);
+
+    for (int b = 0; b < n; b++) {
+        float *px = slice.data();
+
+        for (int g = 0; g < n; g++) {
+            for (int r = 0; r < n; r++) {
+                px[0] = axisValues[r];
+                px[1] = axisValues[g];
+                px[2] = axisValues[b];
+                px[3] = 1.0f;
+                px += 4;
+            }
+        }
+
+        exactTransform(slice.data(), n * n);
+
+        const float *src = slice.constData();
+        float *dst = m_lattice.data() + b * n * n * 3;
+
+        for (int i = 0; i < n * n; i++) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            src += 4;
+            dst += 3;
+        }
+    }
+}
+
+void OcioCpuLut3D::probeAlphaBehavior(const ExactTransform &exactTransform)
+{
+    /**
+     * OCIO evaluates the power functions with a fast approximation,
+     * so the alpha values are compared with a looser tolerance.
+     */
+    const float colorTolerance = 1e-5f;
+    const float alphaTolerance = 1e-3f;
+
+    const float grey = m_shaper.fromDomain(0.5f);
+    const float alphas[3] = {1.0f, 0.5f, 0.25f};
+
+    float probes[3 * 4];
+    for (int i = 0; i < 3; i++) {
+        probes[4 * i + 0] = grey;
+        probes[4 * i + 1] = grey;
+        probes[4 * i + 2] = grey;
+        probes[4 * i + 3] = alphas[i];
+    }
+
+    exactTransform(probes, 3);
+
+    // the color channels must not depend on alpha (e.g. the alpha channel view)
+    for (int i = 1; i < 3; i++) {
+        for (int ch = 0; ch < 3; ch++) {
+            if (!fuzzyCompareValues(probes[4 * i + ch], probes[ch], colorTolerance)) {
+                m_isUsable = false;
+                return;
+            }
+        }
+    }
+
+    // the alpha channel may only be raised to a power by the display gamma
+    if (!fuzzyCompareValues(probes[3], 1.0f, alphaTolerance) || !(probes[7] > 0.0f)) {
+        m_isUsable = false;
+        return;
+    }
+
+    m_alphaExponent = std::log(probes[7]) / std::log(alphas[1]);
+    if (fuzzyCompareValues(m_alphaExponent, 1.0f, alphaTolerance)) {
+        m_alphaExponent = 1.0f;
+    }
+
+    m_isUsable = fuzzyCompareValues(probes[11], std::pow(alphas[2], m_alphaExponent), alphaTolerance);
+}
+
+bool OcioCpuLut3D::isUsable() const
+{
+    return m_isUsable;
+}
+
+int OcioCpuLut3D::edgeLength() const
+{
+    return m_edgeLength;
+}
+
+const OcioCpuLut3DShaper &OcioCpuLut3D::shaper() const
+{
+    return m_shaper;
+}
+
+void OcioCpuLut3D::apply(float *pixels, int numPixels, const ExactTransform &exactTransform) const
+{
+    KIS_SAFE_ASSERT_RECOVER(m_isUsable) {
+        exactTransform(pixels, numPixels);
+        return;
+    }
+
+    const int blockSize = 256;
+    quint8 outOfDomain[blockSize];
+
+    for (int i = 0; i < numPixels; i += blockSize) {
+        const int numBlockPixels = qMin(blockSize, numPixels - i);
+        float *block = pixels + 4 * i;
+
+        const int numOutOfDomain =
+            interpolator()->apply(m_lattice.constData(), m_edgeLength, m_shaper,
+                                  block, numBlockPixels, outOfDomain);
+
+        if (m_alphaExponent != 1.0f) {
+            for (int j = 0; j < numBlockPixels; j++) {
+                if (outOfDomain[j]) continue;
+
+                float &alpha = block[4 * j + 3];
+                alpha = std::pow(std::max(alpha, 0.0f), m_alphaExponent);
+            }
+        }
+
+        if (!numOutOfDomain) continue;
+
+        // e.g. HDR values beyond the allocation of the input color space
+        for (int j = 0; j < numBlockPixels;) {
+            if (!outOfDomain[j]) {
+                j++;
+                continue;
+            }
+
+            int runEnd = j + 1;
+            while (runEnd < numBlockPixels && outOfDomain[runEnd]) {
+                runEnd++;
+            }
+
+            exactTransform(block + 4 * j, runEnd - j);
+            j = runEnd;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef OCIO_CPU_LUT3D_H
+#define OCIO_CPU_LUT3D_H
+
+#include <functional>
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+#include <OpenColorIO.h>
+
+#include "ocio_cpu_lut3d_interpolator.h"
+
+namespace OCIO = OCIO_NAMESPACE;
+
+/**
+ * A CPU bake of an OCIO display transform into a 3D lattice.
+ *
+ * Running the full OCIO CPU processor for every pixel of the canvas
+ * is too slow for the QPainter canvas and for the other CPU paths
+ * that apply the display filter (the color selectors, rendering of
+ * the image with the display transform applied). Instead, the
+ * transform is sampled once on an edgeLength^3 grid and the pixels
+ * are tetrahedrally interpolated through it.
+ *
+ * The bakes are shared by all the display filters of the process
+ * and are cached by the cache id of the OCIO processor, so switching
+ * between the views or canvases doesn't rebake the lattice.
+ *
+ * The pixels that lie outside the domain of the lattice are still
+ * processed with the exact transform, \see OcioCpuLut3DShaper
+ */
+class OcioCpuLut3D
+{
+public:
+    /**
+     * Applies the exact transform to \p numPixels RGBA float32
+     * pixels in place
+     */
+    using ExactTransform = std::function<void(float *pixels, int numPixels)>;
+
+    static const int defaultEdgeLength = 65;
+
+    /**
+     * \return a shaper that matches the allocation of the OCIO color
+     *         space \p colorSpace
+     */
+    static OcioCpuLut3DShaper shaperForColorSpace(OCIO::ConstColorSpaceRcPtr colorSpace);
+
+    /**
+     * \return a cached bake for processor \p processorCacheId or a null
+     *         pointer if it hasn't been baked yet
+     */
+    static QSharedPointer<const OcioCpuLut3D> lookup(const QString &processorCacheId,
+                                                     const OcioCpuLut3DShaper &shaper,
+                                                     int edgeLength = defaultEdgeLength);
+
+    /**
+     * \return a cached bake for processor \p processorCacheId, the lattice
+     *         is baked with \p exactTransform if it is not in the cache yet
+     */
+    static QSharedPointer<const OcioCpuLut3D> fetch(const QString &processorCacheId,
+                                                    const OcioCpuLut3DShaper &shaper,
+                                                    const ExactTransform &exactTransform,
+                                                    int edgeLength = defaultEdgeLength);
+
+    static void clearCache();
+    static int cacheSize();
+
+    /**
+     * The lattice can represent the transform only if its color
+     * channels don't depend on alpha and the alpha is either passed
+     * through or raised to a power (the post-display gamma). When the
+     * transform doesn't fit, the filter should not use the bake.
+     */
+    bool isUsable() const;
+
+    int edgeLength() const;
+    const OcioCpuLut3DShaper &shaper() const;
+
+    /**
+     * Transforms \p numPixels RGBA float32 pixels in place. The pixels
+     * outside the domain of the lattice are passed to \p exactTransform
+     */
+    void apply(float *pixels, int numPixels, const ExactTransform &exactTransform) const;
+
+private:
+    OcioCpuLut3D(const OcioCpuLut3DShaper &shaper, int edgeLength, const ExactTransform &exactTransform);
+
+    void bakeLattice(const ExactTransform &exactTransform);
+    void probeAlphaBehavior(const ExactTransform &exactTransform);
+
+private:
+    OcioCpuLut3DShaper m_shaper;
+    int m_edgeLength {defaultEdgeLength};
+    QVector<float> m_lattice;
+
+    bool m_isUsable {false};
+    float m_alphaExponent {1.0f};
+};
+
+#endif // OCIO_CPU_LUT3D_H
@@ -0,0 +1,264 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "ocio_cpu_lut3d_interpolator.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * Tetrahedral interpolation of a single pixel. Returns false if the
+ * pixel is outside the domain of the lattice.
+ *
+ * The cube cell around the pixel is split into six tetrahedra along
+ * its main diagonal. The tetrahedron is selected by sorting the
+ * fractional parts of the coordinates: with a >= b >= c the result
+ * is a weighted sum of the origin of the cell, the corner one step
+ * along the axis of a, the corner one step further along the axis
+ * of b and the opposite corner of the cell.
+ */
+inline bool interpolatePixel(const float *lattice, int edgeLength,
+                             const OcioCpuLut3DShaper &shaper,
+                             float *pixel)
+{
+    const float maxIndex = edgeLength - 1;
+    const int strides[3] = {3, 3 * edgeLength, 3 * edgeLength * edgeLength};
+
+    int base = 0;
+    float f[3];
+
+    for (int i = 0; i < 3; i++) {
+        const float u = shaper.toDomain(pixel[i]);
+        if (!(u >= 0.0f && u <= 1.0f)) {
+            return false;
+        }
+
+        const float pos = u * maxIndex;
+        const int index = std::min(static_cast<int>(pos), edgeLength - 2);
+        f[i] = pos - index;
+        base += index * strides[i];
+    }
+
+    const int largestAxis =
+        f[0] >= f[1] && f[0] >= f[2] ? 0 :
+        f[1] >= f[2] ? 1 : 2;
+
+    const int smallestAxis =
+        f[2] <= f[0] && f[2] <= f[1] ? 2 :
+        f[1] <= f[0] ? 1 : 0;
+
+    const float a = f[largestAxis];
+    const float c = f[smallestAxis];
+    const float b = f[0] + f[1] + f[2] - a - c;
+
+    const float *v0 = lattice + base;
+    const float *v1 = v0 + strides[largestAxis];
+    const float *v3 = v0 + strides[0] + strides[1] + strides[2];
+    const float *v2 = v3 - strides[smallestAxis];
+
+    for (int ch = 0; ch < 3; ch++) {
+        pixel[ch] = (1.0f - a) * v0[ch] + (a - b) * v1[ch] + (b - c) * v2[ch] + c * v3[ch];
+    }
+
+    return true;
+}
+
+inline int interpolateScalar(const float *lattice, int edgeLength,
+                             const OcioCpuLut3DShaper &shaper,
+                             float *pixels, int numPixels,
+                             quint8 *outOfDomain)
+{
+    int numOutOfDomain = 0;
+
+    for (int i = 0; i < numPixels; i++) {
+        const bool isInDomain = interpolatePixel(lattice, edgeLength, shaper, pixels + 4 * i);
+        outOfDomain[i] = !isInDomain;
+        numOutOfDomain += !isInDomain;
+    }
+
+    return numOutOfDomain;
+}
+
+template<typename _impl, typename EnableDummyType = void>
+class OcioCpuLut3DInterpolator : public OcioCpuLut3DInterpolatorBase
+{
+public:
+    int apply(const float *lattice, int edgeLength,
+              const OcioCpuLut3DShaper &shaper,
+              float *pixels, int numPixels,
+              quint8 *outOfDomain) const override
+    {
+        return interpolateScalar(lattice, edgeLength, shaper, pixels, numPixels, outOfDomain);
+    }
+};
+
+#if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) && XSIMD_VERSION_MAJOR >= 10
+
+template<typename _impl>
+class OcioCpuLut3DInterpolator<
+    _impl,
+    typename std::enable_if<!std::is_same<_impl, xsimd::generic>::value>::type>
+    : public OcioCpuLut3DInterpolatorBase
+{
+    using float_v = xsimd::batch<float, _impl>;
+    using int_v = xsimd::batch<int, _impl>;
+    using float_m = typename float_v::batch_bool_type;
+
+public:
+    int apply(const float *lattice, int edgeLength,
+              const OcioCpuLut3DShaper &shaper,
+              float *pixels, int numPixels,
+              quint8 *outOfDomain) const override
+    {
+        constexpr int vectorSize = static_cast<int>(float_v::size);
+
+        const float_v zero(0.0f);
+        const float_v one(1.0f);
+        const float_v maxIndex(static_cast<float>(edgeLength - 1));
+        const int_v maxBaseIndex(edgeLength - 2);
+
+        const float_v shaperMin(shaper.min);
+        const float_v shaperOffset(shaper.offset);
+        const float_v shaperScale(1.0f / (shaper.max - shaper.min));
+
+        const int_v strideR(3);
+        const int_v strideG(3 * edgeLength);
+        const int_v strideB(3 * edgeLength * edgeLength);
+        const int_v strideSum = strideR + strideG + strideB;
+
+        const auto idxR = xsimd::detail::make_sequence_as_batch<int_v>() * 4; // stride == 4
+        const auto idxG = idxR + 1;
+        const auto idxB = idxR + 2;
+
+        alignas(float_v::arch_type::alignment()) float inDomainLanes[vectorSize];
+
+        int numOutOfDomain = 0;
+        int i = 0;
+
+        for (; i + vectorSize <= numPixels; i += vectorSize) {
+            float *ptr = pixels + 4 * i;
+
+            const float_v srcR = float_v::gather(ptr, idxR);
+            const float_v srcG = float_v::gather(ptr, idxG);
+            const float_v srcB = float_v::gather(ptr, idxB);
+
+            float_v uR = srcR;
+            float_v uG = srcG;
+            float_v uB = srcB;
+
+            if (shaper.isLog) {
+                uR = xsimd::log2(uR + shaperOffset);
+                uG = xsimd::log2(uG + shaperOffset);
+                uB = xsimd::log2(uB + shaperOffset);
+            }
+
+            uR = (uR - shaperMin) * shaperScale;
+            uG = (uG - shaperMin) * shaperScale;
+            uB = (uB - shaperMin) * shaperScale;
+
+            // NaNs fail all the comparisons, so they end up out of domain as well
+            const float_m inDomain =
+                (uR >= zero) & (uR <= one) &
+                (uG >= zero) & (uG <= one) &
+                (uB >= zero) & (uB <= one);
+
+            xsimd::select(inDomain, zero, one).store_aligned(inDomainLanes);
+            for (int j = 0; j < vectorSize; j++) {
+                const bool isOutOfDomain = inDomainLanes[j] != 0.0f;
+                outOfDomain[i + j] = isOutOfDomain;
+                numOutOfDomain += isOutOfDomain;
+            }
+
+            if (!xsimd::any(inDomain)) continue;
+
+            // keep the lattice indices of the rejected lanes valid
+            const float_v posR = xsimd::select(inDomain, uR, zero) * maxIndex;
+            const float_v posG = xsimd::select(inDomain, uG, zero) * maxIndex;
+            const float_v posB = xsimd::select(inDomain, uB, zero) * maxIndex;
+
+            const int_v indexR = xsimd::min(xsimd::batch_cast<int>(posR), maxBaseIndex);
+            const int_v indexG = xsimd::min(xsimd::batch_cast<int>(posG), maxBaseIndex);
+            const int_v indexB = xsimd::min(xsimd::batch_cast<int>(posB), maxBaseIndex);
+
+            const float_v fR = posR - xsimd::batch_cast<float>(indexR);
+            const float_v fG = posG - xsimd::batch_cast<float>(indexG);
+            const float_v fB = posB - xsimd::batch_cast<float>(indexB);
+
+            // see interpolatePixel() for the choice of the tetrahedron
+            const float_m rIsLargest = (fR >= fG) & (fR >= fB);
+            const float_m gIsLargest = !rIsLargest & (fG >= fB);
+            const float_m bIsSmallest = (fB <= fR) & (fB <= fG);
+            const float_m gIsSmallest = !bIsSmallest & (fG <= fR);
+
+            const float_v a = xsimd::max(xsimd::max(fR, fG), fB);
+            const float_v c = xsimd::min(xsimd::min(fR, fG), fB);
+            const float_v b = fR + fG + fB - a - c;
+
+            const int_v largestStride =
+                xsimd::select(xsimd::batch_bool_cast<int>(rIsLargest), strideR,
+                              xsimd::select(xsimd::batch_bool_cast<int>(gIsLargest), strideG, strideB));
+
+            const int_v smallestStride =
+                xsimd::select(xsimd::batch_bool_cast<int>(bIsSmallest), strideB,
+                              xsimd::select(xsimd::batch_bool_cast<int>(gIsSmallest), strideG, strideR));
+
+            const int_v v0 = indexR * strideR + indexG * strideG + indexB * strideB;
+            const int_v v1 = v0 + largestStride;
+            const int_v v3 = v0 + strideSum;
+            const int_v v2 = v3 - smallestStride;
+
+            const float_v w0 = one - a;
+            const float_v w1 = a - b;
+            const float_v w2 = b - c;
+            const float_v w3 = c;
+
+            const float_v dstR = interpolateChannel(lattice, v0, v1, v2, v3, w0, w1, w2, w3);
+            const float_v dstG = interpolateChannel(lattice + 1, v0, v1, v2, v3, w0, w1, w2, w3);
+            const float_v dstB = interpolateChannel(lattice + 2, v0, v1, v2, v3, w0, w1, w2, w3);
+
+            xsimd::select(inDomain, dstR, srcR).scatter(ptr, idxR);
+            xsimd::select(inDomain, dstG, srcG).scatter(ptr, idxG);
+            xsimd::select(inDomain, dstB, srcB).scatter(ptr, idxB);
+        }
+
+        numOutOfDomain += interpolateScalar(lattice, edgeLength, shaper,
+                                            pixels + 4 * i, numPixels - i,
+                                            outOfDomain + i);
+
+        return numOutOfDomain;
+    }
+
+private:
+    static inline float_v interpolateChannel(const float *lattice,
+                                             const int_v &v0, const int_v &v1,
+                                             const int_v &v2, const int_v &v3,
+                                             const float_v &w0, const float_v &w1,
+                                             const float_v &w2, const float_v &w3)
+    {
+        float_v result = w0 * float_v::gather(lattice, v0);
+        result = xsimd::fma(w1, float_v::gather(lattice, v1), result);
+        result = xsimd::fma(w2, float_v::gather(lattice, v2), result);
+        result = xsimd::fma(w3, float_v::gather(lattice, v3), result);
+        return result;
+    }
+};
+
+#endif // HAVE_XSIMD
+
+} // namespace
+
+template<typename _impl>
+OcioCpuLut3DInterpolatorBase *OcioCpuLut3DInterpolatorFactory::create()
+{
+    return new OcioCpuLut3DInterpolator<_impl>();
+}
+
+template OcioCpuLut3DInterpolatorBase *OcioCpuLut3DInterpolatorFactory::create<xsimd::current_arch>();
+
+#endif // XSIMD_UNIVERSAL_BUILD_PASS
@@ -0,0 +1,70 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef OCIO_CPU_LUT3D_INTERPOLATOR_H
+#define OCIO_CPU_LUT3D_INTERPOLATOR_H
+
+#include <cmath>
+
+#include <QtGlobal>
+#include <KoMultiArchBuildSupport.h>
+
+/**
+ * Maps the input values of the display transform into the [0, 1]
+ * domain of the baked lattice. It follows the allocation of the
+ * OCIO input color space, the same way OCIO's own legacy GPU path
+ * does when it bakes its 3D LUT texture.
+ */
+struct OcioCpuLut3DShaper
+{
+    bool isLog {false};
+    float min {0.0f};
+    float max {1.0f};
+    float offset {0.0f};
+
+    inline float toDomain(float x) const {
+        const float v = isLog ? std::log2(x + offset) : x;
+        return (v - min) / (max - min);
+    }
+
+    inline float fromDomain(float u) const {
+        const float v = min + u * (max - min);
+        return isLog ? std::exp2(v) - offset : v;
+    }
+};
+
+/**
+ * Interpolates RGBA float32 pixels through a baked 3D lattice using
+ * tetrahedral interpolation. The alpha channel is passed through.
+ *
+ * The lattice contains edgeLength^3 RGB triplets, the red index
+ * changes fastest.
+ *
+ * Pixels that fall outside the domain of the shaper (or contain
+ * NaNs) are left untouched and marked with 1 in \p outOfDomain,
+ * the caller is expected to process them with the exact transform.
+ *
+ * \return the number of the pixels marked in \p outOfDomain
+ */
+class OcioCpuLut3DInterpolatorBase
+{
+public:
+    virtual ~OcioCpuLut3DInterpolatorBase() = default;
+
+    virtual int apply(const float *lattice, int edgeLength,
+                      const OcioCpuLut3DShaper &shaper,
+                      float *pixels, int numPixels,
+                      quint8 *outOfDomain) const = 0;
+};
+
+class OcioCpuLut3DInterpolatorFactory
+{
+public:
+    template<typename _impl>
+    static OcioCpuLut3DInterpolatorBase *create();
+};
+
+#endif // OCIO_CPU_LUT3D_INTERPOLATOR_H
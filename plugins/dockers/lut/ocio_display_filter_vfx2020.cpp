@@ -22,6 +22,7 @@
 #include <QOpenGLFunctions_3_0>
 #include <QOpenGLFunctions_2_0>
 #include <QOpenGLExtraFunctions>
+#include <QMutexLocker>
 
 #if defined(QT_OPENGL_ES_2)
 #define GL_RGBA16F_ARB GL_RGBA16F_EXT
@@ -55,9 +56,58 @@ void OcioDisplayFilter::filter(quint8 *pixels, quint32 numPixels)
 {
     // processes that data _in_ place
     if (m_processor) {
-        OCIO::PackedImageDesc img(reinterpret_cast<float*>(pixels), numPixels, 1, 4);
-        m_processor->apply(img);
+        OCIO::ConstProcessorRcPtr processor = m_processor;
+        auto applyExact = [processor] (float *exactPixels, int numExactPixels) {
+            OCIO::PackedImageDesc img(exactPixels, numExactPixels, 1, 4);
+            processor->apply(img);
+        };
+
+        QSharedPointer<const OcioCpuLut3D> lut;
+        if (numPixels > 16) {
+            lut = fetchBakedCpuLut(numPixels);
+        }
+
+        if (lut) {
+            lut->apply(reinterpret_cast<float*>(pixels), numPixels, applyExact);
+        } else {
+            applyExact(reinterpret_cast<float*>(pixels), numPixels);
+        }
+    }
+}
+
+QSharedPointer<const OcioCpuLut3D> OcioDisplayFilter::fetchBakedCpuLut(quint32 numPixels)
+{
+    QMutexLocker l(&m_cpuLutMutex);
+
+    if (!useBakedCpuLut || m_cpuLutCacheId.isEmpty()) {
+        return QSharedPointer<const OcioCpuLut3D>();
     }
+
+    if (!m_cpuLut) {
+        /**
+         * Baking the lattice costs about as much as filtering the same
+         * number of pixels with the exact processor, so the bake is
+         * postponed until the current configuration has processed that
+         * many pixels. Small updates, e.g. of the color selectors, never
+         * pay for it.
+         */
+        const qint64 edgeLength = OcioCpuLut3D::defaultEdgeLength;
+        m_cpuLutExactPixels += numPixels;
+
+        if (m_cpuLutExactPixels < edgeLength * edgeLength * edgeLength) {
+            return QSharedPointer<const OcioCpuLut3D>();
+        }
+
+        OCIO::ConstProcessorRcPtr processor = m_processor;
+
+        m_cpuLut = OcioCpuLut3D::fetch(m_cpuLutCacheId, m_cpuLutShaper,
+                                       [processor] (float *latticePixels, int numLatticePixels) {
+                                           OCIO::PackedImageDesc img(latticePixels, numLatticePixels, 1, 4);
+                                           processor->apply(img);
+                                       });
+    }
+
+    return m_cpuLut && m_cpuLut->isUsable() ? m_cpuLut : QSharedPointer<const OcioCpuLut3D>();
 }
 
 void OcioDisplayFilter::approximateInverseTransformation(quint8 *pixels, quint32 numPixels)
@@ -251,6 +301,15 @@ void OcioDisplayFilter::updateProcessor()
         return;
     }
 
+    {
+        QMutexLocker l(&m_cpuLutMutex);
+
+        m_cpuLutCacheId = QString::fromLatin1(m_processor->getCpuCacheID());
+        m_cpuLutShaper = OcioCpuLut3D::shaperForColorSpace(config->getColorSpace(inputColorSpaceName));
+        m_cpuLut = OcioCpuLut3D::lookup(m_cpuLutCacheId, m_cpuLutShaper);
+        m_cpuLutExactPixels = 0;
+    }
+
     m_forwardApproximationProcessor = config->getProcessor(approximateTransform, OCIO::TRANSFORM_DIR_FORWARD);
 
     try {
@@ -7,7 +7,9 @@
 #ifndef OCIO_DISPLAY_FILTER_H
 #define OCIO_DISPLAY_FILTER_H
 
+#include <QMutex>
 #include <QOpenGLShaderProgram>
+#include <QSharedPointer>
 
 #include <OpenColorIO.h>
 #include <OpenColorTransforms.h>
@@ -16,6 +18,8 @@
 #include <kis_display_filter.h>
 #include <kis_exposure_gamma_correction_interface.h>
 
+#include "ocio_cpu_lut3d.h"
+
 namespace OCIO = OCIO_NAMESPACE;
 
 enum OCIO_CHANNEL_SWIZZLE {
@@ -66,6 +70,15 @@ public:
     float whitePoint {0.0};
     bool forceInternalColorManagement {false};
 
+    /**
+     * Use a baked 3D LUT of the transform for the large CPU updates,
+     * \see OcioCpuLut3D
+     */
+    bool useBakedCpuLut {true};
+
+private:
+    QSharedPointer<const OcioCpuLut3D> fetchBakedCpuLut(quint32 numPixels);
+
 private:
 
     OCIO::ConstProcessorRcPtr m_processor;
@@ -83,6 +96,12 @@ private:
     QString m_shadercacheid;
 
     bool m_shaderDirty {true};
+
+    QMutex m_cpuLutMutex;
+    QString m_cpuLutCacheId;
+    OcioCpuLut3DShaper m_cpuLutShaper;
+    QSharedPointer<const OcioCpuLut3D> m_cpuLut;
+    qint64 m_cpuLutExactPixels {0};
 };
 
 #endif // OCIO_DISPLAY_FILTER_H
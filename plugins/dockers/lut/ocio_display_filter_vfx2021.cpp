@@ -8,6 +8,7 @@
 #include "ocio_display_filter_vfx2021.h"
 
 #include <QMessageBox>
+#include <QMutexLocker>
 #include <QOpenGLContext>
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLFunctions_2_0>
@@ -61,19 +62,73 @@ void OcioDisplayFilter::filter(quint8 *pixels, quint32 numPixels)
 {
     // processes that data _in_ place
     if (m_processor) {
+        float *data = reinterpret_cast<float *>(pixels);
+
+        QSharedPointer<const OcioCpuLut3D> lut;
         if (numPixels > 16) {
-            // creation of PackedImageDesc is really slow on Windows due to malloc/free
-            OCIO::PackedImageDesc img(reinterpret_cast<float *>(pixels), numPixels, 1, 4);
-            m_processorCPU->apply(img);
+            lut = fetchBakedCpuLut(numPixels);
+        }
+
+        if (lut) {
+            lut->apply(data, numPixels,
+                       [this] (float *exactPixels, int numExactPixels) {
+                           applyProcessorCPU(exactPixels, numExactPixels);
+                       });
         } else {
-            for (quint32 i = 0; i < numPixels; i++) {
-                m_processorCPU->applyRGBA(reinterpret_cast<float*>(pixels));
-                pixels+=4;
-            }
+            applyProcessorCPU(data, numPixels);
         }
     }
 }
 
+void OcioDisplayFilter::applyProcessorCPU(float *pixels, quint32 numPixels)
+{
+    if (numPixels > 16) {
+        // creation of PackedImageDesc is really slow on Windows due to malloc/free
+        OCIO::PackedImageDesc img(pixels, numPixels, 1, 4);
+        m_processorCPU->apply(img);
+    } else {
+        for (quint32 i = 0; i < numPixels; i++) {
+            m_processorCPU->applyRGBA(pixels);
+            pixels+=4;
+        }
+    }
+}
+
+QSharedPointer<const OcioCpuLut3D> OcioDisplayFilter::fetchBakedCpuLut(quint32 numPixels)
+{
+    QMutexLocker l(&m_cpuLutMutex);
+
+    if (!useBakedCpuLut || m_cpuLutCacheId.isEmpty()) {
+        return QSharedPointer<const OcioCpuLut3D>();
+    }
+
+    if (!m_cpuLut) {
+        /**
+         * Baking the lattice costs about as much as filtering the same
+         * number of pixels with the exact processor, so the bake is
+         * postponed until the current configuration has processed that
+         * many pixels. Small updates, e.g. of the color selectors, never
+         * pay for it.
+         */
+        const qint64 edgeLength = OcioCpuLut3D::defaultEdgeLength;
+        m_cpuLutExactPixels += numPixels;
+
+        if (m_cpuLutExactPixels < edgeLength * edgeLength * edgeLength) {
+            return QSharedPointer<const OcioCpuLut3D>();
+        }
+
+        OCIO::ConstCPUProcessorRcPtr processor = m_processorCPU;
+
+        m_cpuLut = OcioCpuLut3D::fetch(m_cpuLutCacheId, m_cpuLutShaper,
+                                       [processor] (float *latticePixels, int numLatticePixels) {
+                                           OCIO::PackedImageDesc img(latticePixels, numLatticePixels, 1, 4);
+                                           processor->apply(img);
+                                       });
+    }
+
+    return m_cpuLut && m_cpuLut->isUsable() ? m_cpuLut : QSharedPointer<const OcioCpuLut3D>();
+}
+
 void OcioDisplayFilter::approximateInverseTransformation(quint8 *pixels, quint32 numPixels)
 {
     // processes that data _in_ place
@@ -287,6 +342,15 @@ void OcioDisplayFilter::updateProcessor()
         return;
     }
 
+    {
+        QMutexLocker l(&m_cpuLutMutex);
+
+        m_cpuLutCacheId = QString::fromLatin1(m_processor->getCacheID());
+        m_cpuLutShaper = OcioCpuLut3D::shaperForColorSpace(config->getColorSpace(inputColorSpaceName));
+        m_cpuLut = OcioCpuLut3D::lookup(m_cpuLutCacheId, m_cpuLutShaper);
+        m_cpuLutExactPixels = 0;
+    }
+
     m_forwardApproximationProcessor = config->getProcessor(approximateTransform, OCIO::TRANSFORM_DIR_FORWARD);
     m_forwardApproximationProcessorCPU = m_forwardApproximationProcessor->getDefaultCPUProcessor();
 
@@ -10,7 +10,9 @@
 
 #include <vector>
 
+#include <QMutex>
 #include <QOpenGLShaderProgram>
+#include <QSharedPointer>
 
 #include <OpenColorIO.h>
 #include <OpenColorTransforms.h>
@@ -19,6 +21,8 @@
 #include <kis_display_filter.h>
 #include <kis_exposure_gamma_correction_interface.h>
 
+#include "ocio_cpu_lut3d.h"
+
 namespace OCIO = OCIO_NAMESPACE;
 
 enum OCIO_CHANNEL_SWIZZLE { LUMINANCE, RGBA, R, G, B, A };
@@ -93,6 +97,16 @@ public:
     double whitePoint;
     bool forceInternalColorManagement;
 
+    /**
+     * Use a baked 3D LUT of the transform for the large CPU updates,
+     * \see OcioCpuLut3D
+     */
+    bool useBakedCpuLut {true};
+
+private:
+    void applyProcessorCPU(float *pixels, quint32 numPixels);
+    QSharedPointer<const OcioCpuLut3D> fetchBakedCpuLut(quint32 numPixels);
+
 private:
     OCIO::ConstProcessorRcPtr m_processor;
     OCIO::ConstProcessorRcPtr m_reverseApproximationProcessor;
@@ -113,6 +127,12 @@ private:
     std::vector<KisTextureUniform> m_lut3dUniforms;
 
     bool m_shaderDirty;
+
+    QMutex m_cpuLutMutex;
+    QString m_cpuLutCacheId;
+    OcioCpuLut3DShaper m_cpuLutShaper;
+    QSharedPointer<const OcioCpuLut3D> m_cpuLut;
+    qint64 m_cpuLutExactPixels {0};
 };
 
 #endif // OCIO_DISPLAY_FILTER_H
@@ -11,6 +11,10 @@
 #include <testutil.h>
 
 #include <QFile>
+#include <QRandomGenerator>
+
+#include <cmath>
+#include <limits>
 
 #include <KoChannelInfo.h>
 #include <KoColorModelStandardIds.h>
@@ -107,4 +111,107 @@ void KisOcioDisplayFilterTest::test()
 
 }
 
+QSharedPointer<OcioDisplayFilter> createTestingFilter(OCIO::ConstConfigRcPtr ocioConfig, bool useBakedCpuLut)
+{
+    QSharedPointer<OcioDisplayFilter> filter(
+        new OcioDisplayFilter(new KisDumbExposureGammaCorrectionInterface()));
+
+    filter->config = ocioConfig;
+    filter->inputColorSpaceName = ocioConfig->getColorSpaceNameByIndex(0);
+    filter->displayDevice = ocioConfig->getDisplay(1);
+    filter->view = ocioConfig->getView(filter->displayDevice, 0);
+    filter->gamma = 2.2;
+    filter->exposure = 0.5;
+    filter->swizzle = RGBA;
+
+    filter->blackPoint = 0.0;
+    filter->whitePoint = 1.0;
+
+    filter->forceInternalColorManagement = false;
+    filter->setLockCurrentColorVisualRepresentation(false);
+    filter->useBakedCpuLut = useBakedCpuLut;
+
+    filter->updateProcessor();
+
+    return filter;
+}
+
+void KisOcioDisplayFilterTest::testBakedCpuLut()
+{
+    QString configFile = TestUtil::fetchDataFileLazy("./psyfiTestingConfig-master/config.ocio");
+    QVERIFY(QFile::exists(configFile));
+
+    OCIO::ConstConfigRcPtr ocioConfig =
+            OCIO::Config::CreateFromFile(configFile.toUtf8());
+
+    OcioCpuLut3D::clearCache();
+
+    QSharedPointer<OcioDisplayFilter> exactFilter = createTestingFilter(ocioConfig, false);
+    QSharedPointer<OcioDisplayFilter> bakedFilter = createTestingFilter(ocioConfig, true);
+
+    // big enough to make the filter bake the lattice
+    const int numPixels = 512 * 1024;
+
+    QVector<float> pixels(numPixels * 4);
+    {
+        QRandomGenerator random(1);
+
+        /**
+         * The lattice cannot follow the steep toe of the display curves
+         * exactly, so the random colors avoid the darkest values
+         */
+        for (int i = 0; i < numPixels; i++) {
+            pixels[4 * i + 0] = 0.1 + random.bounded(0.9);
+            pixels[4 * i + 1] = 0.1 + random.bounded(0.9);
+            pixels[4 * i + 2] = 0.1 + random.bounded(0.9);
+            pixels[4 * i + 3] = random.bounded(1.0);
+        }
+
+        // a few values outside the domain that must go through the exact path
+        pixels[0] = -0.5f;
+        pixels[5] = 16.0f;
+        pixels[10] = std::numeric_limits<float>::quiet_NaN();
+    }
+
+    QVector<float> exactPixels(pixels);
+    QVector<float> bakedPixels(pixels);
+
+    exactFilter->filter(reinterpret_cast<quint8*>(exactPixels.data()), numPixels);
+    bakedFilter->filter(reinterpret_cast<quint8*>(bakedPixels.data()), numPixels);
+
+    QCOMPARE(OcioCpuLut3D::cacheSize(), 1);
+
+    // the second filter with the same configuration reuses the bake
+    QSharedPointer<OcioDisplayFilter> anotherBakedFilter = createTestingFilter(ocioConfig, true);
+    QVector<float> anotherBakedPixels(pixels);
+    anotherBakedFilter->filter(reinterpret_cast<quint8*>(anotherBakedPixels.data()), 1024);
+    QCOMPARE(OcioCpuLut3D::cacheSize(), 1);
+
+    for (int i = 12; i < 1024 * 4; i++) {
+        QCOMPARE(anotherBakedPixels[i], bakedPixels[i]);
+    }
+
+    const float tolerance = 1e-2f;
+    float maxError = 0.0f;
+
+    for (int i = 0; i < numPixels * 4; i++) {
+        if (std::isnan(exactPixels[i])) {
+            QVERIFY(std::isnan(bakedPixels[i]));
+            continue;
+        }
+
+        const float error = std::abs(exactPixels[i] - bakedPixels[i]) /
+            std::max(1.0f, std::abs(exactPixels[i]));
+        maxError = std::max(maxError, error);
+
+        if (error > tolerance) {
+            qDebug() << "Failed to compare pixel" << i / 4 << "channel" << i % 4;
+            qDebug() << "    exact:" << exactPixels[i] << "baked:" << bakedPixels[i];
+            QFAIL("The baked LUT differs from the exact transform");
+        }
+    }
+
+    qDebug() << "Max error of the baked LUT:" << maxError;
+}
+
 SIMPLE_TEST_MAIN(KisOcioDisplayFilterTest)
@@ -54,6 +54,26 @@ void KisBlurFilter::processImpl(KisPaintDeviceSP device,
                                 const KisFilterConfigurationSP config,
                                 KoUpdater* progressUpdater
                                 ) const
+{
+    processImplBlocked(device, rect, config, progressUpdater, 0);
+}
+
+bool KisBlurFilter::supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    QVariant value;
+    const int halfWidth = t.scale(config->getProperty("halfWidth", value) ? value.toUInt() : 5);
+    const int halfHeight = t.scale(config->getProperty("halfHeight", value) ? value.toUInt() : 5);
+
+    return KisConvolutionPainter::prefersFFT(2 * halfWidth + 1, 2 * halfHeight + 1);
+}
+
+void KisBlurFilter::processImplBlocked(KisPaintDeviceSP device,
+                                       const QRect& rect,
+                                       const KisFilterConfigurationSP config,
+                                       KoUpdater* progressUpdater,
+                                       KisRunnableStrokeJobsInterface *jobsInterface) const
 {
     QPoint srcTopLeft = rect.topLeft();
     Q_ASSERT(device != 0);
@@ -98,6 +118,9 @@ void KisBlurFilter::processImpl(KisPaintDeviceSP device,
     KisConvolutionPainter painter(device);
     painter.setChannelFlags(channelFlags);
     painter.setProgress(progressUpdater);
+    if (jobsInterface) {
+        painter.setRunnableStrokeJobsInterface(jobsInterface);
+    }
     painter.applyMatrix(kernel, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
 
 }
@@ -22,6 +22,14 @@ public:
                      const KisFilterConfigurationSP config,
                      KoUpdater* progressUpdater
                      ) const override;
+
+    bool supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const override;
+
+    void processImplBlocked(KisPaintDeviceSP device,
+                            const QRect& rect,
+                            const KisFilterConfigurationSP config,
+                            KoUpdater* progressUpdater,
+                            KisRunnableStrokeJobsInterface *jobsInterface) const override;
     static inline KoID id() {
         return KoID("blur", i18n("Blur"));
     }
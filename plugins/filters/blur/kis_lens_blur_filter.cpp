@@ -118,6 +118,21 @@ void KisLensBlurFilter::processImpl(KisPaintDeviceSP device,
                                     const KisFilterConfigurationSP config,
                                     KoUpdater* progressUpdater
                                     ) const
+{
+    processImplBlocked(device, rect, config, progressUpdater, 0);
+}
+
+bool KisLensBlurFilter::supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const
+{
+    const QRect kernelRect = getIrisPolygon(config, lod).boundingRect().toAlignedRect();
+    return KisConvolutionPainter::prefersFFT(kernelRect.width(), kernelRect.height());
+}
+
+void KisLensBlurFilter::processImplBlocked(KisPaintDeviceSP device,
+                                           const QRect& rect,
+                                           const KisFilterConfigurationSP config,
+                                           KoUpdater* progressUpdater,
+                                           KisRunnableStrokeJobsInterface *jobsInterface) const
 {
     QPoint srcTopLeft = rect.topLeft();
 
@@ -162,6 +177,9 @@ void KisLensBlurFilter::processImpl(KisPaintDeviceSP device,
     KisConvolutionPainter painter(device);
     painter.setChannelFlags(channelFlags);
     painter.setProgress(progressUpdater);
+    if (jobsInterface) {
+        painter.setRunnableStrokeJobsInterface(jobsInterface);
+    }
 
     KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(irisKernel, 0, irisKernel.sum());
     painter.applyMatrix(kernel, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
@@ -14,6 +14,7 @@
 
 #include <kis_convolution_kernel.h>
 #include <kis_convolution_painter.h>
+#include <KisMotionBlur.h>
 
 #include "ui_wdg_motion_blur.h"
 
@@ -71,6 +72,18 @@ struct MotionBlurProperties
         kernelHalfSize.rheight() = ceil(fabs(halfHeight));
         kernelSize = kernelHalfSize * 2 + QSize(1, 1);
         this->blurLength = blurLength;
+        this->angle = angleRadians;
+        scaledLength = t.scale(blurLength);
+
+        /**
+         * The long lines are integrated directly, the explicit
+         * kernel is too slow for them
+         */
+        useLineIntegral = scaledLength >= KisMotionBlur::minimumLength;
+
+        if (useLineIntegral) {
+            kernelHalfSize = kernelHalfSize.expandedTo(KisMotionBlur::haloSize(scaledLength, angle));
+        }
 
 
         QPointF p1(0.5 * kernelSize.width(), 0.5 * kernelSize.height());
@@ -79,6 +92,9 @@ struct MotionBlurProperties
     }
 
     int blurLength;
+    qreal scaledLength;
+    qreal angle;
+    bool useLineIntegral;
     QSize kernelSize;
     QSize kernelHalfSize;
     QLineF motionLine;
@@ -90,6 +106,25 @@ void KisMotionBlurFilter::processImpl(KisPaintDeviceSP device,
                                       const KisFilterConfigurationSP config,
                                       KoUpdater* progressUpdater
                                       ) const
+{
+    processImplBlocked(device, rect, config, progressUpdater, 0);
+}
+
+bool KisMotionBlurFilter::supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+    MotionBlurProperties props(config, t);
+
+    return props.blurLength != 0 &&
+        (props.useLineIntegral ||
+         KisConvolutionPainter::prefersFFT(props.kernelSize.width(), props.kernelSize.height()));
+}
+
+void KisMotionBlurFilter::processImplBlocked(KisPaintDeviceSP device,
+                                             const QRect& rect,
+                                             const KisFilterConfigurationSP config,
+                                             KoUpdater* progressUpdater,
+                                             KisRunnableStrokeJobsInterface *jobsInterface) const
 {
     QPoint srcTopLeft = rect.topLeft();
 
@@ -113,6 +148,12 @@ void KisMotionBlurFilter::processImpl(KisPaintDeviceSP device,
         channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
     }
 
+    if (props.useLineIntegral) {
+        KisMotionBlur::apply(device, rect, props.scaledLength, props.angle,
+                             channelFlags, progressUpdater, jobsInterface);
+        return;
+    }
+
     QImage kernelRepresentation(props.kernelSize, QImage::Format_RGB32);
     kernelRepresentation.fill(0);
 
@@ -133,6 +174,9 @@ void KisMotionBlurFilter::processImpl(KisPaintDeviceSP device,
     KisConvolutionPainter painter(device);
     painter.setChannelFlags(channelFlags);
     painter.setProgress(progressUpdater);
+    if (jobsInterface) {
+        painter.setRunnableStrokeJobsInterface(jobsInterface);
+    }
 
     KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(motionBlurKernel, 0, motionBlurKernel.sum());
     painter.applyMatrix(kernel, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
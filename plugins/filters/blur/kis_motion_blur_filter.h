@@ -26,6 +26,14 @@ public:
                      const KisFilterConfigurationSP config,
                      KoUpdater* progressUpdater
                      ) const override;
+
+    bool supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const override;
+
+    void processImplBlocked(KisPaintDeviceSP src,
+                            const QRect& size,
+                            const KisFilterConfigurationSP config,
+                            KoUpdater* progressUpdater,
+                            KisRunnableStrokeJobsInterface *jobsInterface) const override;
     static inline KoID id() {
         return KoID("motion blur", i18n("Motion Blur"));
     }
@@ -0,0 +1,94 @@
+/*
+ * This file is part of Krita
+ *
+ * SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_surface_blur_filter.h"
+#include "kis_wdg_surface_blur.h"
+
+#include <KisBilateralBlur.h>
+
+#include <filter/kis_filter_category_ids.h>
+#include <filter/kis_filter_configuration.h>
+#include <kis_paint_device.h>
+#include "kis_lod_transform.h"
+
+namespace {
+const qreal maxRadiusForMask = 100.0;
+}
+
+KisSurfaceBlurFilter::KisSurfaceBlurFilter() : KisFilter(id(), FiltersCategoryBlurId, i18n("&Surface Blur..."))
+{
+    setSupportsPainting(true);
+    setSupportsAdjustmentLayers(true);
+    setSupportsLevelOfDetail(true);
+    setColorSpaceIndependence(FULLY_INDEPENDENT);
+}
+
+KisConfigWidget * KisSurfaceBlurFilter::createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP, bool usedForMasks) const
+{
+    return new KisWdgSurfaceBlur(usedForMasks, parent);
+}
+
+KisFilterConfigurationSP KisSurfaceBlurFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
+{
+    KisFilterConfigurationSP config = factoryConfiguration(resourcesInterface);
+    config->setProperty("radius", 5.0);
+    config->setProperty("threshold", 15);
+
+    return config;
+}
+
+void KisSurfaceBlurFilter::processImpl(KisPaintDeviceSP device,
+                                       const QRect& rect,
+                                       const KisFilterConfigurationSP config,
+                                       KoUpdater* progressUpdater
+                                       ) const
+{
+    Q_ASSERT(device != 0);
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(config);
+
+    KisLodTransformScalar t(device);
+
+    const qreal radius = t.scale(config->getDouble("radius", 5.0));
+    const qreal threshold = config->getDouble("threshold", 15.0);
+
+    QBitArray channelFlags = config->channelFlags();
+    if (channelFlags.isEmpty()) {
+        channelFlags = QBitArray(device->colorSpace()->channelCount(), true);
+    }
+
+    KisBilateralBlur::apply(device, rect, radius, threshold, channelFlags, progressUpdater);
+}
+
+QRect KisSurfaceBlurFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    const int halo = KisBilateralBlur::haloSize(t.scale(_config->getDouble("radius", 5.0)));
+    return rect.adjusted(-halo, -halo, halo, halo);
+}
+
+QRect KisSurfaceBlurFilter::changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    const int halo = KisBilateralBlur::haloSize(t.scale(_config->getDouble("radius", 5.0)));
+    return rect.adjusted(-halo, -halo, halo, halo);
+}
+
+bool KisSurfaceBlurFilter::configurationAllowedForMask(KisFilterConfigurationSP config) const
+{
+    return config->getDouble("radius", 5.0) <= maxRadiusForMask;
+}
+
+void KisSurfaceBlurFilter::fixLoadedFilterConfigurationForMasks(KisFilterConfigurationSP config) const
+{
+    if (config->getDouble("radius", 5.0) > maxRadiusForMask) {
+        config->setProperty("radius", maxRadiusForMask);
+    }
+}
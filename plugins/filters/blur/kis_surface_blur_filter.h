@@ -0,0 +1,42 @@
+/*
+ * This file is part of Krita
+ *
+ * SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_SURFACE_BLUR_FILTER_H
+#define KIS_SURFACE_BLUR_FILTER_H
+
+#include "filter/kis_filter.h"
+
+/**
+ * The edge-preserving blur, which smooths the areas of similar
+ * lightness and keeps the edges between them. See KisBilateralBlur.
+ */
+class KisSurfaceBlurFilter : public KisFilter
+{
+public:
+    KisSurfaceBlurFilter();
+public:
+    void processImpl(KisPaintDeviceSP device,
+                     const QRect& rect,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater* progressUpdater
+                     ) const override;
+    static inline KoID id() {
+        return KoID("surface blur", i18n("Surface Blur"));
+    }
+
+    KisFilterConfigurationSP defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const override;
+public:
+    KisConfigWidget * createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool useForMasks) const override;
+    QRect neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const override;
+    QRect changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const override;
+
+    bool configurationAllowedForMask(KisFilterConfigurationSP config) const override;
+    void fixLoadedFilterConfigurationForMasks(KisFilterConfigurationSP config) const override;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * This file is part of Krita
+ *
+ * SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_wdg_surface_blur.h"
+
+#include <filter/kis_filter.h>
+#include <filter/kis_filter_configuration.h>
+#include <KisGlobalResourcesInterface.h>
+
+#include "ui_wdg_surface_blur.h"
+
+KisWdgSurfaceBlur::KisWdgSurfaceBlur(bool usedForMasks, QWidget * parent) : KisConfigWidget(parent)
+{
+    m_widget = new Ui_WdgSurfaceBlur();
+    m_widget->setupUi(this);
+
+    const qreal maxRadius = usedForMasks ? 100.0 : 1000.0;
+
+    m_widget->radius->setRange(0.0, maxRadius, 2);
+    m_widget->radius->setSingleStep(0.2);
+    m_widget->radius->setValue(5.0);
+    m_widget->radius->setExponentRatio(3.0);
+    m_widget->radius->setSuffix(i18n(" px"));
+
+    m_widget->threshold->setRange(1, 255);
+    m_widget->threshold->setValue(15);
+
+    connect(m_widget->radius, SIGNAL(valueChanged(qreal)), SIGNAL(sigConfigurationItemChanged()));
+    connect(m_widget->threshold, SIGNAL(valueChanged(int)), SIGNAL(sigConfigurationItemChanged()));
+}
+
+KisWdgSurfaceBlur::~KisWdgSurfaceBlur()
+{
+    delete m_widget;
+}
+
+KisPropertiesConfigurationSP KisWdgSurfaceBlur::configuration() const
+{
+    KisFilterConfigurationSP config = new KisFilterConfiguration("surface blur", 1, KisGlobalResourcesInterface::instance());
+    config->setProperty("radius", m_widget->radius->value());
+    config->setProperty("threshold", m_widget->threshold->value());
+    return config;
+}
+
+void KisWdgSurfaceBlur::setConfiguration(const KisPropertiesConfigurationSP config)
+{
+    QVariant value;
+    if (config->getProperty("radius", value)) {
+        m_widget->radius->setValue(value.toFloat());
+    }
+    if (config->getProperty("threshold", value)) {
+        m_widget->threshold->setValue(value.toInt());
+    }
+}
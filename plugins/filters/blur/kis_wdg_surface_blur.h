@@ -0,0 +1,32 @@
+/*
+ * This file is part of Krita
+ *
+ * SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef _KIS_WDG_SURFACE_BLUR_H_
+#define _KIS_WDG_SURFACE_BLUR_H_
+
+#include <kis_config_widget.h>
+
+class Ui_WdgSurfaceBlur;
+
+class KisWdgSurfaceBlur : public KisConfigWidget
+{
+    Q_OBJECT
+public:
+    KisWdgSurfaceBlur(bool usedForMasks, QWidget * parent);
+    ~KisWdgSurfaceBlur() override;
+    inline const Ui_WdgSurfaceBlur* widget() const {
+        return m_widget;
+    }
+    void setConfiguration(const KisPropertiesConfigurationSP) override;
+    KisPropertiesConfigurationSP configuration() const override;
+
+private:
+    Ui_WdgSurfaceBlur* m_widget;
+};
+
+#endif
@@ -24,6 +24,8 @@
 #include <kis_types.h>
 #include "kis_simple_noise_reducer.h"
 #include "kis_wavelet_noise_reduction.h"
+#include "kis_median_filter.h"
+#include "kis_despeckle_filter.h"
 
 K_PLUGIN_FACTORY_WITH_JSON(KritaImageEnhancementFactory, "kritaimageenhancement.json", registerPlugin<KritaImageEnhancement>();)
 
@@ -32,6 +34,8 @@ KritaImageEnhancement::KritaImageEnhancement(QObject *parent, const QVariantList
 {
     KisFilterRegistry::instance()->add(new KisSimpleNoiseReducer());
     KisFilterRegistry::instance()->add(new KisWaveletNoiseReduction());
+    KisFilterRegistry::instance()->add(new KisMedianFilter());
+    KisFilterRegistry::instance()->add(new KisDespeckleFilter());
 }
 
 KritaImageEnhancement::~KritaImageEnhancement()
@@ -0,0 +1,106 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_despeckle_filter.h"
+
+#include <KoColorSpace.h>
+
+#include <KisRankFilter.h>
+#include <kis_global.h>
+#include <widgets/kis_multi_integer_filter_widget.h>
+#include <filter/kis_filter_category_ids.h>
+#include <filter/kis_filter_configuration.h>
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+#include "kis_lod_transform.h"
+
+
+KisDespeckleFilter::KisDespeckleFilter()
+    : KisFilter(id(), FiltersCategoryEnhanceId, i18n("&Despeckle..."))
+{
+    setSupportsPainting(true);
+    setSupportsAdjustmentLayers(true);
+    setSupportsLevelOfDetail(true);
+}
+
+KisConfigWidget * KisDespeckleFilter::createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool) const
+{
+    Q_UNUSED(dev);
+    vKisIntegerWidgetParam param;
+    param.push_back(KisIntegerWidgetParam(1, 20, 1, i18n("Radius"), "radius"));
+    param.push_back(KisIntegerWidgetParam(0, 255, 20, i18n("Threshold"), "threshold"));
+    return new KisMultiIntegerFilterWidget(id().id(), parent, id().id(), param);
+}
+
+KisFilterConfigurationSP KisDespeckleFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
+{
+    KisFilterConfigurationSP config = factoryConfiguration(resourcesInterface);
+    config->setProperty("radius", 1);
+    config->setProperty("threshold", 20);
+    return config;
+}
+
+void KisDespeckleFilter::processImpl(KisPaintDeviceSP device,
+                                     const QRect& applyRect,
+                                     const KisFilterConfigurationSP config,
+                                     KoUpdater* progressUpdater
+                                     ) const
+{
+    processImplBlocked(device, applyRect, config, progressUpdater, 0);
+}
+
+bool KisDespeckleFilter::supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const
+{
+    Q_UNUSED(config);
+    Q_UNUSED(lod);
+
+    // the bands of KisRankFilter are independent for any radius
+    return true;
+}
+
+void KisDespeckleFilter::processImplBlocked(KisPaintDeviceSP device,
+                                            const QRect& applyRect,
+                                            const KisFilterConfigurationSP config,
+                                            KoUpdater* progressUpdater,
+                                            KisRunnableStrokeJobsInterface *jobsInterface) const
+{
+    Q_ASSERT(device);
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(config);
+
+    KisLodTransformScalar t(device);
+
+    const int radius = qCeil(t.scale(qreal(config->getInt("radius", 1))));
+    const int threshold = config->getInt("threshold", 20);
+
+    const KoColorSpace *cs = device->colorSpace();
+
+    KisPaintDeviceSP median = new KisPaintDevice(*device);
+    KisRankFilter::apply(median, applyRect, radius, 50.0,
+                         config->channelFlags(), progressUpdater, jobsInterface);
+
+    KisSequentialConstIterator medianIt(median, applyRect);
+    KisSequentialIterator dstIt(device, applyRect);
+
+    while (dstIt.nextPixel() && medianIt.nextPixel()) {
+        if (cs->difference(dstIt.oldRawData(), medianIt.oldRawData()) > threshold) {
+            memcpy(dstIt.rawData(), medianIt.oldRawData(), cs->pixelSize());
+        }
+    }
+}
+
+QRect KisDespeckleFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    const int radius = qCeil(t.scale(qreal(_config->getInt("radius", 1))));
+    return kisGrowRect(rect, radius);
+}
+
+QRect KisDespeckleFilter::changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    return neededRect(rect, _config, lod);
+}
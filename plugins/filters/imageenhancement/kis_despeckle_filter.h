@@ -0,0 +1,51 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISDESPECKLEFILTER_H
+#define KISDESPECKLEFILTER_H
+
+#include <filter/kis_filter.h>
+#include "kis_config_widget.h"
+
+/**
+ * Removes the impulse noise: the pixels, which differ from the
+ * median of their neighbourhood more than the threshold, are
+ * replaced with the median. The rest of the pixels are kept.
+ */
+class KisDespeckleFilter : public KisFilter
+{
+public:
+    KisDespeckleFilter();
+public:
+
+    void processImpl(KisPaintDeviceSP device,
+                     const QRect& applyRect,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater* progressUpdater
+                     ) const override;
+
+    bool supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const override;
+
+    void processImplBlocked(KisPaintDeviceSP device,
+                            const QRect& applyRect,
+                            const KisFilterConfigurationSP config,
+                            KoUpdater* progressUpdater,
+                            KisRunnableStrokeJobsInterface *jobsInterface) const override;
+
+    KisConfigWidget * createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool useForMasks) const override;
+
+    static inline KoID id() {
+        return KoID("despeckle", i18n("Despeckle"));
+    }
+
+    QRect changedRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+    QRect neededRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+
+protected:
+    KisFilterConfigurationSP  defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const override;
+};
+
+#endif
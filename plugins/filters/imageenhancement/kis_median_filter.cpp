@@ -0,0 +1,94 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_median_filter.h"
+
+#include <KoColorSpace.h>
+
+#include <KisRankFilter.h>
+#include <kis_global.h>
+#include <widgets/kis_multi_integer_filter_widget.h>
+#include <filter/kis_filter_category_ids.h>
+#include <filter/kis_filter_configuration.h>
+#include <kis_paint_device.h>
+#include "kis_lod_transform.h"
+
+
+KisMedianFilter::KisMedianFilter()
+    : KisFilter(id(), FiltersCategoryEnhanceId, i18n("&Median..."))
+{
+    setSupportsPainting(true);
+    setSupportsAdjustmentLayers(true);
+    setSupportsLevelOfDetail(true);
+    setColorSpaceIndependence(FULLY_INDEPENDENT);
+}
+
+KisConfigWidget * KisMedianFilter::createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool) const
+{
+    Q_UNUSED(dev);
+    vKisIntegerWidgetParam param;
+    param.push_back(KisIntegerWidgetParam(1, 100, 2, i18n("Radius"), "radius"));
+    param.push_back(KisIntegerWidgetParam(0, 100, 50, i18n("Percentile"), "percentile"));
+    return new KisMultiIntegerFilterWidget(id().id(), parent, id().id(), param);
+}
+
+KisFilterConfigurationSP KisMedianFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
+{
+    KisFilterConfigurationSP config = factoryConfiguration(resourcesInterface);
+    config->setProperty("radius", 2);
+    config->setProperty("percentile", 50);
+    return config;
+}
+
+void KisMedianFilter::processImpl(KisPaintDeviceSP device,
+                                  const QRect& applyRect,
+                                  const KisFilterConfigurationSP config,
+                                  KoUpdater* progressUpdater
+                                  ) const
+{
+    processImplBlocked(device, applyRect, config, progressUpdater, 0);
+}
+
+bool KisMedianFilter::supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const
+{
+    Q_UNUSED(config);
+    Q_UNUSED(lod);
+
+    // the bands of KisRankFilter are independent for any radius
+    return true;
+}
+
+void KisMedianFilter::processImplBlocked(KisPaintDeviceSP device,
+                                         const QRect& applyRect,
+                                         const KisFilterConfigurationSP config,
+                                         KoUpdater* progressUpdater,
+                                         KisRunnableStrokeJobsInterface *jobsInterface) const
+{
+    Q_ASSERT(device);
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(config);
+
+    KisLodTransformScalar t(device);
+
+    const int radius = qCeil(t.scale(qreal(config->getInt("radius", 2))));
+    const qreal percentile = config->getInt("percentile", 50);
+
+    KisRankFilter::apply(device, applyRect, radius, percentile,
+                         config->channelFlags(), progressUpdater, jobsInterface);
+}
+
+QRect KisMedianFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    KisLodTransformScalar t(lod);
+
+    const int radius = qCeil(t.scale(qreal(_config->getInt("radius", 2))));
+    return kisGrowRect(rect, radius);
+}
+
+QRect KisMedianFilter::changedRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
+{
+    return neededRect(rect, _config, lod);
+}
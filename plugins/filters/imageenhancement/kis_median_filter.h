@@ -0,0 +1,50 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISMEDIANFILTER_H
+#define KISMEDIANFILTER_H
+
+#include <filter/kis_filter.h>
+#include "kis_config_widget.h"
+
+/**
+ * Replaces every pixel with the median (or any other percentile)
+ * of its square neighbourhood, see KisRankFilter
+ */
+class KisMedianFilter : public KisFilter
+{
+public:
+    KisMedianFilter();
+public:
+
+    void processImpl(KisPaintDeviceSP device,
+                     const QRect& applyRect,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater* progressUpdater
+                     ) const override;
+
+    bool supportsBlockedProcessing(const KisFilterConfigurationSP config, int lod) const override;
+
+    void processImplBlocked(KisPaintDeviceSP device,
+                            const QRect& applyRect,
+                            const KisFilterConfigurationSP config,
+                            KoUpdater* progressUpdater,
+                            KisRunnableStrokeJobsInterface *jobsInterface) const override;
+
+    KisConfigWidget * createConfigurationWidget(QWidget* parent, const KisPaintDeviceSP dev, bool useForMasks) const override;
+
+    static inline KoID id() {
+        return KoID("median", i18n("Median"));
+    }
+
+    QRect changedRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+    QRect neededRect(const QRect &rect, const KisFilterConfigurationSP _config, int lod) const override;
+
+protected:
+    KisFilterConfigurationSP  defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const override;
+};
+
+#endif
@@ -0,0 +1,469 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLut3D.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+
+#include <klocalizedstring.h>
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * The biggest LUT we accept, 256^3 nodes take 256 MiB already
+ */
+const int maximumSize3D = 256;
+const int maximumSize1D = 65536;
+
+struct CacheEntry {
+    QString key;
+    QDateTime lastModified;
+    qint64 fileSize = 0;
+    KisLut3DSP lut;
+};
+
+/**
+ * The LUTs are big, so the cache keeps only a few of the most recently
+ * used ones. The evicted LUTs stay alive while some configuration or
+ * transformation still uses them.
+ */
+struct LutCache {
+    static const int maxEntries = 8;
+    static const qint64 maxMemory = 512ll * 1024 * 1024;
+
+    QMutex mutex;
+    QList<CacheEntry> entries; // the most recently used go first
+
+    KisLut3DSP find(const QString &key, const QDateTime &lastModified, qint64 fileSize) {
+        for (int i = 0; i < entries.size(); i++) {
+            if (entries[i].key == key) {
+                if (entries[i].lastModified != lastModified ||
+                    entries[i].fileSize != fileSize) {
+
+                    entries.removeAt(i);
+                    return KisLut3DSP();
+                }
+
+                entries.move(i, 0);
+                return entries.first().lut;
+            }
+        }
+        return KisLut3DSP();
+    }
+
+    void insert(const CacheEntry &entry) {
+        for (int i = 0; i < entries.size(); i++) {
+            if (entries[i].key == entry.key) {
+                entries.removeAt(i);
+                break;
+            }
+        }
+
+        entries.prepend(entry);
+
+        qint64 memory = 0;
+        for (int i = 0; i < entries.size(); i++) {
+            memory += entries[i].lut->memoryUsage();
+
+            // the most recent entry is kept even if it is too big
+            if (i > 0 && (i >= maxEntries || memory > maxMemory)) {
+                entries.erase(entries.begin() + i, entries.end());
+                break;
+            }
+        }
+    }
+};
+
+Q_GLOBAL_STATIC(LutCache, s_lutCache)
+
+QStringList tokenizeLine(const QString &rawLine)
+{
+    QString line = rawLine;
+    const int commentStart = line.indexOf('#');
+    if (commentStart >= 0) {
+        line.truncate(commentStart);
+    }
+    return line.simplified().split(' ', Qt::SkipEmptyParts);
+}
+
+bool parseFloats(const QStringList &tokens, int first, int count, float *result)
+{
+    if (tokens.size() < first + count) return false;
+
+    for (int i = 0; i < count; i++) {
+        bool ok = false;
+        result[i] = tokens[first + i].toFloat(&ok);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+inline float clampToRange(float value, float max)
+{
+    // also maps NaN to zero
+    return value > 0.0f ? (value < max ? value : max) : 0.0f;
+}
+
+}
+
+KisLut3DSP KisLut3D::load(const QString &fileName, QString *errorMessage)
+{
+    const QFileInfo info(fileName);
+
+    if (!info.exists()) {
+        if (errorMessage) {
+            *errorMessage = i18n("LUT file %1 does not exist", fileName);
+        }
+        return KisLut3DSP();
+    }
+
+    const QString key = info.absoluteFilePath();
+
+    {
+        QMutexLocker l(&s_lutCache->mutex);
+        KisLut3DSP lut = s_lutCache->find(key, info.lastModified(), info.size());
+        if (lut) {
+            return lut;
+        }
+    }
+
+    QFile file(key);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorMessage) {
+            *errorMessage = i18n("Cannot open LUT file %1", fileName);
+        }
+        return KisLut3DSP();
+    }
+
+    KisLut3DSP lut;
+
+    if (info.suffix().toLower() == "3dl") {
+        lut = from3dl(&file, errorMessage);
+    } else {
+        lut = fromCube(&file, errorMessage);
+    }
+
+    if (lut) {
+        QMutexLocker l(&s_lutCache->mutex);
+
+        CacheEntry entry;
+        entry.key = key;
+        entry.lastModified = info.lastModified();
+        entry.fileSize = info.size();
+        entry.lut = lut;
+        s_lutCache->insert(entry);
+    }
+
+    return lut;
+}
+
+KisLut3DSP KisLut3D::fromCube(QIODevice *device, QString *errorMessage)
+{
+    QSharedPointer<KisLut3D> lut(new KisLut3D());
+
+    QTextStream stream(device);
+    QVector<float> values;
+
+    QString error;
+
+    while (!stream.atEnd() && error.isEmpty()) {
+        const QStringList tokens = tokenizeLine(stream.readLine());
+        if (tokens.isEmpty()) continue;
+
+        const QString &keyword = tokens.first();
+
+        if (keyword == "TITLE") {
+            continue;
+        } else if (keyword == "LUT_1D_SIZE") {
+            lut->m_size1D = tokens.size() > 1 ? tokens[1].toInt() : 0;
+            if (lut->m_size1D < 2 || lut->m_size1D > maximumSize1D) {
+                error = i18n("Invalid size of the 1D LUT");
+            }
+        } else if (keyword == "LUT_3D_SIZE") {
+            lut->m_size3D = tokens.size() > 1 ? tokens[1].toInt() : 0;
+            if (lut->m_size3D < 2 || lut->m_size3D > maximumSize3D) {
+                error = i18n("Invalid size of the 3D LUT");
+            }
+        } else if (keyword == "DOMAIN_MIN") {
+            float domain[3];
+            if (!parseFloats(tokens, 1, 3, domain)) {
+                error = i18n("Invalid DOMAIN_MIN");
+            }
+            std::copy(domain, domain + 3, lut->m_domainMin1D);
+            std::copy(domain, domain + 3, lut->m_domainMin3D);
+        } else if (keyword == "DOMAIN_MAX") {
+            float domain[3];
+            if (!parseFloats(tokens, 1, 3, domain)) {
+                error = i18n("Invalid DOMAIN_MAX");
+            }
+            std::copy(domain, domain + 3, lut->m_domainMax1D);
+            std::copy(domain, domain + 3, lut->m_domainMax3D);
+        } else if (keyword == "LUT_1D_INPUT_RANGE" || keyword == "LUT_3D_INPUT_RANGE") {
+            float range[2];
+            if (!parseFloats(tokens, 1, 2, range)) {
+                error = i18n("Invalid %1", keyword);
+            }
+
+            float *min = keyword == "LUT_1D_INPUT_RANGE" ? lut->m_domainMin1D : lut->m_domainMin3D;
+            float *max = keyword == "LUT_1D_INPUT_RANGE" ? lut->m_domainMax1D : lut->m_domainMax3D;
+            std::fill(min, min + 3, range[0]);
+            std::fill(max, max + 3, range[1]);
+        } else {
+            float rgb[3];
+            if (!parseFloats(tokens, 0, 3, rgb)) {
+                error = i18n("Unknown keyword %1", keyword);
+            }
+            values.append(rgb[0]);
+            values.append(rgb[1]);
+            values.append(rgb[2]);
+        }
+    }
+
+    const int size1D = lut->m_size1D;
+    const int size3D = lut->m_size3D;
+    const int numNodes3D = size3D * size3D * size3D;
+
+    if (error.isEmpty()) {
+        if (!size1D && !size3D) {
+            error = i18n("The file contains neither LUT_1D_SIZE nor LUT_3D_SIZE");
+        } else if (values.size() != 3 * (size1D + numNodes3D)) {
+            error = i18n("The number of LUT entries doesn't match the size of the LUT");
+        }
+    }
+
+    if (!error.isEmpty()) {
+        if (errorMessage) {
+            *errorMessage = error;
+        }
+        return KisLut3DSP();
+    }
+
+    // the shaper LUT goes first, as written by Resolve
+    lut->m_table1D = values.mid(0, 3 * size1D);
+
+    lut->m_table3D.resize(4 * numNodes3D);
+    const float *src = values.constData() + 3 * size1D;
+    float *dst = lut->m_table3D.data();
+
+    for (int i = 0; i < numNodes3D; i++) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0.0f;
+
+        src += 3;
+        dst += 4;
+    }
+
+    lut->finalizeDomain();
+    return lut;
+}
+
+KisLut3DSP KisLut3D::from3dl(QIODevice *device, QString *errorMessage)
+{
+    QSharedPointer<KisLut3D> lut(new KisLut3D());
+
+    QTextStream stream(device);
+    QVector<float> values;
+    QString error;
+
+    while (!stream.atEnd() && error.isEmpty()) {
+        const QStringList tokens = tokenizeLine(stream.readLine());
+        if (tokens.isEmpty()) continue;
+
+        // skip the keywords, like "3DMESH" or "Mesh 4 12"
+        if (tokens.first()[0].isLetter()) continue;
+
+        if (!lut->m_size3D) {
+            // the first numeric line is the input mesh
+            lut->m_size3D = tokens.size();
+            if (lut->m_size3D < 2 || lut->m_size3D > maximumSize3D) {
+                error = i18n("Invalid size of the 3D LUT");
+            }
+            continue;
+        }
+
+        float rgb[3];
+        if (tokens.size() != 3 || !parseFloats(tokens, 0, 3, rgb)) {
+            error = i18n("Invalid LUT entry");
+        }
+        values.append(rgb[0]);
+        values.append(rgb[1]);
+        values.append(rgb[2]);
+    }
+
+    const int size = lut->m_size3D;
+    const int numNodes = size * size * size;
+
+    if (error.isEmpty() && (!size || values.size() != 3 * numNodes)) {
+        error = i18n("The number of LUT entries doesn't match the size of the LUT");
+    }
+
+    if (!error.isEmpty()) {
+        if (errorMessage) {
+            *errorMessage = error;
+        }
+        return KisLut3DSP();
+    }
+
+    /**
+     * The bit depth of the output values is not stored in the file,
+     * so it is guessed from the biggest value
+     */
+    const float maxValue = *std::max_element(values.constBegin(), values.constEnd());
+    int outputBits = 8;
+    while (outputBits < 16 && maxValue > float((1 << outputBits) - 1)) {
+        outputBits += 2;
+    }
+    const float outputScale = 1.0f / float((1 << outputBits) - 1);
+
+    lut->m_table3D.resize(4 * numNodes);
+
+    // in 3dl files blue changes fastest
+    const float *src = values.constData();
+    for (int r = 0; r < size; r++) {
+        for (int g = 0; g < size; g++) {
+            for (int b = 0; b < size; b++) {
+                float *dst = lut->m_table3D.data() + 4 * ((b * size + g) * size + r);
+                dst[0] = src[0] * outputScale;
+                dst[1] = src[1] * outputScale;
+                dst[2] = src[2] * outputScale;
+                dst[3] = 0.0f;
+                src += 3;
+            }
+        }
+    }
+
+    lut->finalizeDomain();
+    return lut;
+}
+
+void KisLut3D::finalizeDomain()
+{
+    for (int c = 0; c < 3; c++) {
+        const float range1D = m_domainMax1D[c] - m_domainMin1D[c];
+        const float range3D = m_domainMax3D[c] - m_domainMin3D[c];
+
+        m_scale1D[c] = m_size1D && range1D > 0.0f ? (m_size1D - 1) / range1D : 0.0f;
+        m_scale3D[c] = m_size3D && range3D > 0.0f ? (m_size3D - 1) / range3D : 0.0f;
+    }
+}
+
+void KisLut3D::transform(float *rgb, int numPixels, int stride) const
+{
+    if (m_size1D) {
+        float *ptr = rgb;
+        for (int i = 0; i < numPixels; i++) {
+            apply1D(ptr);
+            ptr += stride;
+        }
+    }
+
+    if (m_size3D) {
+        float *ptr = rgb;
+        for (int i = 0; i < numPixels; i++) {
+            apply3D(ptr);
+            ptr += stride;
+        }
+    }
+}
+
+void KisLut3D::apply1D(float *rgb) const
+{
+    const float maxIndex = m_size1D - 1;
+    const float *table = m_table1D.constData();
+
+    for (int c = 0; c < 3; c++) {
+        const float x = clampToRange((rgb[c] - m_domainMin1D[c]) * m_scale1D[c], maxIndex);
+        const int i0 = qMin(int(x), m_size1D - 2);
+        const float f = x - i0;
+
+        rgb[c] = table[3 * i0 + c] + f * (table[3 * (i0 + 1) + c] - table[3 * i0 + c]);
+    }
+}
+
+void KisLut3D::apply3D(float *rgb) const
+{
+    const int size = m_size3D;
+    const float maxIndex = size - 1;
+
+    const float fr = clampToRange((rgb[0] - m_domainMin3D[0]) * m_scale3D[0], maxIndex);
+    const float fg = clampToRange((rgb[1] - m_domainMin3D[1]) * m_scale3D[1], maxIndex);
+    const float fb = clampToRange((rgb[2] - m_domainMin3D[2]) * m_scale3D[2], maxIndex);
+
+    const int r0 = qMin(int(fr), size - 2);
+    const int g0 = qMin(int(fg), size - 2);
+    const int b0 = qMin(int(fb), size - 2);
+
+    const float dr = fr - r0;
+    const float dg = fg - g0;
+    const float db = fb - b0;
+
+    const int stepR = 4;
+    const int stepG = 4 * size;
+    const int stepB = 4 * size * size;
+
+    const float *c000 = m_table3D.constData() + b0 * stepB + g0 * stepG + r0 * stepR;
+    const float *c111 = c000 + stepR + stepG + stepB;
+
+    /**
+     * Tetrahedral interpolation: the cube is split into six tetrahedra
+     * sharing the c000-c111 diagonal. The tetrahedron is chosen by the
+     * order of the fractional parts, then only four nodes are blended.
+     */
+    const float *c1;
+    const float *c2;
+    float w0, w1, w2, w3;
+
+    if (dr >= dg) {
+        if (dg >= db) {
+            c1 = c000 + stepR;
+            c2 = c000 + stepR + stepG;
+            w1 = dr - dg; w2 = dg - db; w3 = db;
+        } else if (dr >= db) {
+            c1 = c000 + stepR;
+            c2 = c000 + stepR + stepB;
+            w1 = dr - db; w2 = db - dg; w3 = dg;
+        } else {
+            c1 = c000 + stepB;
+            c2 = c000 + stepR + stepB;
+            w1 = db - dr; w2 = dr - dg; w3 = dg;
+        }
+    } else {
+        if (db > dg) {
+            c1 = c000 + stepB;
+            c2 = c000 + stepG + stepB;
+            w1 = db - dg; w2 = dg - dr; w3 = dr;
+        } else if (db > dr) {
+            c1 = c000 + stepG;
+            c2 = c000 + stepG + stepB;
+            w1 = dg - db; w2 = db - dr; w3 = dr;
+        } else {
+            c1 = c000 + stepG;
+            c2 = c000 + stepR + stepG;
+            w1 = dg - dr; w2 = dr - db; w3 = db;
+        }
+    }
+    w0 = 1.0f - w1 - w2 - w3;
+
+    // the nodes are padded to four floats, so this loop is a single vector operation
+    float result[4];
+    for (int i = 0; i < 4; i++) {
+        result[i] = w0 * c000[i] + w1 * c1[i] + w2 * c2[i] + w3 * c111[i];
+    }
+
+    rgb[0] = result[0];
+    rgb[1] = result[1];
+    rgb[2] = result[2];
+}
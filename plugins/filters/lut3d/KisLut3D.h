@@ -0,0 +1,88 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LUT_3D_H
+#define KIS_LUT_3D_H
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+class KisLut3D;
+typedef QSharedPointer<const KisLut3D> KisLut3DSP;
+
+/**
+ * A color grading LUT loaded from a .cube (Adobe/Resolve) or .3dl
+ * (Autodesk/Lustre) file.
+ *
+ * The LUT consists of an optional 1D shaper LUT and an optional 3D
+ * LUT, which are applied in that order. The 3D nodes are stored as
+ * four floats (RGB and padding), so that every node is aligned to
+ * 16 bytes and the interpolation can process the three channels with
+ * a single vector operation.
+ */
+class KisLut3D
+{
+public:
+    /**
+     * Loads the LUT from \p fileName. The loaded LUTs are shared between
+     * all the filter configurations and transformations. The file is
+     * parsed again only when its modification time changes or when the
+     * LUT has been evicted from the cache of the recently used LUTs.
+     *
+     * Returns null if the file cannot be parsed, \p errorMessage is set
+     * in that case.
+     */
+    static KisLut3DSP load(const QString &fileName, QString *errorMessage = 0);
+
+    static KisLut3DSP fromCube(QIODevice *device, QString *errorMessage = 0);
+    static KisLut3DSP from3dl(QIODevice *device, QString *errorMessage = 0);
+
+    /**
+     * Transforms \p numPixels RGB triplets in place. The values are
+     * normalized, that is 1.0 is the white point of the source data.
+     * The values outside of the domain of the LUT are clamped.
+     */
+    void transform(float *rgb, int numPixels, int stride) const;
+
+    int size1D() const { return m_size1D; }
+    int size3D() const { return m_size3D; }
+
+    /**
+     * The size of the tables in bytes
+     */
+    qint64 memoryUsage() const {
+        return qint64(m_table1D.size() + m_table3D.size()) * sizeof(float);
+    }
+
+private:
+    void apply1D(float *rgb) const;
+    void apply3D(float *rgb) const;
+
+    void finalizeDomain();
+
+private:
+    int m_size1D = 0;
+    int m_size3D = 0;
+
+    float m_domainMin1D[3] = {0.0f, 0.0f, 0.0f};
+    float m_domainMax1D[3] = {1.0f, 1.0f, 1.0f};
+    float m_domainMin3D[3] = {0.0f, 0.0f, 0.0f};
+    float m_domainMax3D[3] = {1.0f, 1.0f, 1.0f};
+
+    float m_scale1D[3] = {0.0f, 0.0f, 0.0f};
+    float m_scale3D[3] = {0.0f, 0.0f, 0.0f};
+
+    /// m_size1D RGB triplets
+    QVector<float> m_table1D;
+
+    /// m_size3D^3 nodes of 4 floats, red changes fastest
+    QVector<float> m_table3D;
+};
+
+#endif // KIS_LUT_3D_H
@@ -0,0 +1,61 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLut3DFilter.h"
+
+#include <filter/kis_filter_category_ids.h>
+#include <filter/kis_filter_configuration.h>
+#include <KoColorSpace.h>
+#include <kis_debug.h>
+
+#include "KisLut3D.h"
+#include "KisLut3DTransformation.h"
+#include "KisLut3DFilterConfigWidget.h"
+
+KisLut3DFilter::KisLut3DFilter()
+    : KisColorTransformationFilter(id(), FiltersCategoryAdjustId, i18n("&3D LUT..."))
+{
+    setSupportsPainting(true);
+    setSupportsAdjustmentLayers(true);
+    setSupportsLevelOfDetail(true);
+    setSupportsThreading(true);
+    setColorSpaceIndependence(TO_RGBA16);
+    setShowConfigurationWidget(true);
+}
+
+KoColorTransformation* KisLut3DFilter::createTransformation(const KoColorSpace *cs, const KisFilterConfigurationSP config) const
+{
+    const QString fileName = config->getString("filename");
+    if (fileName.isEmpty()) return 0;
+
+    QString errorMessage;
+    KisLut3DSP lut = KisLut3D::load(fileName, &errorMessage);
+
+    if (!lut) {
+        warnKrita << "KisLut3DFilter: failed to load" << fileName << errorMessage;
+        return 0;
+    }
+
+    KoColorTransformation *transformation = createLut3DTransformation(cs, lut);
+
+    if (!transformation) {
+        warnKrita << "KisLut3DFilter: unsupported color space" << cs->id();
+    }
+
+    return transformation;
+}
+
+KisConfigWidget* KisLut3DFilter::createConfigurationWidget(QWidget *parent, const KisPaintDeviceSP, bool) const
+{
+    return new KisLut3DFilterConfigWidget(parent);
+}
+
+KisFilterConfigurationSP KisLut3DFilter::defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const
+{
+    KisFilterConfigurationSP config = factoryConfiguration(resourcesInterface);
+    config->setProperty("filename", QString());
+    return config;
+}
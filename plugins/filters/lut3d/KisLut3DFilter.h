@@ -0,0 +1,34 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LUT_3D_FILTER_H
+#define KIS_LUT_3D_FILTER_H
+
+#include <filter/kis_color_transformation_filter.h>
+
+/**
+ * Applies a color grading LUT loaded from a .cube or a .3dl file to
+ * RGB color spaces. Being a color transformation filter, it can be
+ * used as a filter mask or an adjustment layer and is processed in
+ * tiles in parallel.
+ */
+class KisLut3DFilter : public KisColorTransformationFilter
+{
+public:
+    KisLut3DFilter();
+
+    static inline KoID id() {
+        return KoID("lut3d", i18n("3D LUT"));
+    }
+
+    KoColorTransformation* createTransformation(const KoColorSpace *cs, const KisFilterConfigurationSP config) const override;
+    KisConfigWidget* createConfigurationWidget(QWidget *parent, const KisPaintDeviceSP dev, bool useForMasks) const override;
+
+protected:
+    KisFilterConfigurationSP defaultConfiguration(KisResourcesInterfaceSP resourcesInterface) const override;
+};
+
+#endif // KIS_LUT_3D_FILTER_H
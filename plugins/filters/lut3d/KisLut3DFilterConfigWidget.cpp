@@ -0,0 +1,65 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLut3DFilterConfigWidget.h"
+
+#include <filter/kis_filter_configuration.h>
+#include <filter/kis_filter_registry.h>
+#include <kis_file_name_requester.h>
+#include <KisGlobalResourcesInterface.h>
+
+#include "KisLut3D.h"
+#include "KisLut3DFilter.h"
+#include "ui_KisLut3DFilterConfigWidget.h"
+
+KisLut3DFilterConfigWidget::KisLut3DFilterConfigWidget(QWidget *parent)
+    : KisConfigWidget(parent)
+    , m_ui(new Ui_KisLut3DFilterConfigWidget)
+{
+    m_ui->setupUi(this);
+    m_ui->fileNameRequester->setConfigurationName("3DLUT");
+    m_ui->fileNameRequester->setMimeTypeFilters(QStringList() << "application/x-cube" << "application/x-3dl");
+
+    connect(m_ui->fileNameRequester, SIGNAL(textChanged(QString)), SLOT(slotFileNameChanged(QString)));
+    connect(m_ui->fileNameRequester, SIGNAL(textChanged(QString)), SIGNAL(sigConfigurationItemChanged()));
+}
+
+KisLut3DFilterConfigWidget::~KisLut3DFilterConfigWidget()
+{
+    delete m_ui;
+}
+
+KisPropertiesConfigurationSP KisLut3DFilterConfigWidget::configuration() const
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->get(KisLut3DFilter::id().id());
+    KisFilterConfigurationSP config = filter->factoryConfiguration(KisGlobalResourcesInterface::instance());
+    config->setProperty("filename", m_ui->fileNameRequester->fileName());
+    return config;
+}
+
+void KisLut3DFilterConfigWidget::setConfiguration(const KisPropertiesConfigurationSP config)
+{
+    m_ui->fileNameRequester->setFileName(config->getString("filename"));
+}
+
+void KisLut3DFilterConfigWidget::slotFileNameChanged(const QString &fileName)
+{
+    if (fileName.isEmpty()) {
+        m_ui->lblStatus->clear();
+        return;
+    }
+
+    QString errorMessage;
+    KisLut3DSP lut = KisLut3D::load(fileName, &errorMessage);
+
+    if (!lut) {
+        m_ui->lblStatus->setText(errorMessage);
+    } else if (lut->size3D()) {
+        m_ui->lblStatus->setText(i18nc("size of a 3D LUT, e.g. 33x33x33", "3D LUT: %1x%1x%1", lut->size3D()));
+    } else {
+        m_ui->lblStatus->setText(i18nc("size of a 1D LUT", "1D LUT: %1", lut->size1D()));
+    }
+}
@@ -0,0 +1,31 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LUT_3D_FILTER_CONFIG_WIDGET_H
+#define KIS_LUT_3D_FILTER_CONFIG_WIDGET_H
+
+#include <kis_config_widget.h>
+
+class Ui_KisLut3DFilterConfigWidget;
+
+class KisLut3DFilterConfigWidget : public KisConfigWidget
+{
+    Q_OBJECT
+public:
+    KisLut3DFilterConfigWidget(QWidget *parent);
+    ~KisLut3DFilterConfigWidget() override;
+
+    KisPropertiesConfigurationSP configuration() const override;
+    void setConfiguration(const KisPropertiesConfigurationSP config) override;
+
+private Q_SLOTS:
+    void slotFileNameChanged(const QString &fileName);
+
+private:
+    Ui_KisLut3DFilterConfigWidget *m_ui;
+};
+
+#endif // KIS_LUT_3D_FILTER_CONFIG_WIDGET_H
@@ -0,0 +1,24 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <kpluginfactory.h>
+#include <kis_filter_registry.h>
+
+#include "KisLut3DFilter.h"
+#include "KisLut3DFilterPlugin.h"
+
+K_PLUGIN_FACTORY_WITH_JSON(KritaLut3DFilterFactory, "KritaLut3DFilter.json", registerPlugin<KisLut3DFilterPlugin>();)
+
+KisLut3DFilterPlugin::KisLut3DFilterPlugin(QObject *parent, const QVariantList &)
+    : QObject(parent)
+{
+    KisFilterRegistry::instance()->add(new KisLut3DFilter());
+}
+
+KisLut3DFilterPlugin::~KisLut3DFilterPlugin()
+{}
+
+#include "KisLut3DFilterPlugin.moc"
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LUT_3D_FILTER_PLUGIN_H
+#define KIS_LUT_3D_FILTER_PLUGIN_H
+
+#include <QObject>
+
+class KisLut3DFilterPlugin : public QObject
+{
+    Q_OBJECT
+public:
+    KisLut3DFilterPlugin(QObject *parent, const QVariantList &);
+    ~KisLut3DFilterPlugin() override;
+};
+
+#endif // KIS_LUT_3D_FILTER_PLUGIN_H
@@ -0,0 +1,94 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLut3DTransformation.h"
+
+#include <KoConfig.h>
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoColorModelStandardIds.h>
+
+#include <cstring>
+
+#ifdef HAVE_OPENEXR
+#include <half.h>
+#endif
+
+template <typename channel_type>
+KisLut3DTransformation<channel_type>::KisLut3DTransformation(const KoColorSpace *cs, KisLut3DSP lut)
+    : m_lut(lut),
+      m_pixelSize(cs->pixelSize() / sizeof(channel_type))
+{
+    Q_FOREACH (const KoChannelInfo *channel, cs->channels()) {
+        const int displayPosition = channel->displayPosition();
+        if (channel->channelType() == KoChannelInfo::COLOR &&
+            displayPosition >= 0 && displayPosition < 3) {
+
+            m_offsets[displayPosition] = channel->pos() / sizeof(channel_type);
+        }
+    }
+}
+
+template <typename channel_type>
+void KisLut3DTransformation<channel_type>::transform(const quint8 *src8, quint8 *dst8, qint32 nPixels) const
+{
+    const channel_type *src = reinterpret_cast<const channel_type*>(src8);
+    channel_type *dst = reinterpret_cast<channel_type*>(dst8);
+
+    float buffer[3 * blockSize];
+
+    while (nPixels > 0) {
+        const int numPixels = qMin(nPixels, blockSize);
+
+        const channel_type *srcPixel = src;
+        for (int i = 0; i < numPixels; i++) {
+            for (int c = 0; c < 3; c++) {
+                buffer[3 * i + c] = KoColorSpaceMaths<channel_type, float>::scaleToA(srcPixel[m_offsets[c]]);
+            }
+            srcPixel += m_pixelSize;
+        }
+
+        m_lut->transform(buffer, numPixels, 3);
+
+        // copy alpha and all the other channels, then overwrite RGB
+        if (src != dst) {
+            memcpy(dst, src, numPixels * m_pixelSize * sizeof(channel_type));
+        }
+
+        channel_type *dstPixel = dst;
+        for (int i = 0; i < numPixels; i++) {
+            for (int c = 0; c < 3; c++) {
+                dstPixel[m_offsets[c]] = KoColorSpaceMaths<float, channel_type>::scaleToA(buffer[3 * i + c]);
+            }
+            dstPixel += m_pixelSize;
+        }
+
+        src += numPixels * m_pixelSize;
+        dst += numPixels * m_pixelSize;
+        nPixels -= numPixels;
+    }
+}
+
+KoColorTransformation* createLut3DTransformation(const KoColorSpace *cs, KisLut3DSP lut)
+{
+    if (!lut || cs->colorModelId() != RGBAColorModelID) return 0;
+
+    const KoID depthId = cs->colorDepthId();
+
+    if (depthId == Integer8BitsColorDepthID) {
+        return new KisLut3DTransformation<quint8>(cs, lut);
+    } else if (depthId == Integer16BitsColorDepthID) {
+        return new KisLut3DTransformation<quint16>(cs, lut);
+#ifdef HAVE_OPENEXR
+    } else if (depthId == Float16BitsColorDepthID) {
+        return new KisLut3DTransformation<half>(cs, lut);
+#endif
+    } else if (depthId == Float32BitsColorDepthID) {
+        return new KisLut3DTransformation<float>(cs, lut);
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LUT_3D_TRANSFORMATION_H
+#define KIS_LUT_3D_TRANSFORMATION_H
+
+#include <KoColorTransformation.h>
+#include <KoColorSpaceMaths.h>
+
+#include "KisLut3D.h"
+
+class KoColorSpace;
+
+/**
+ * Applies a KisLut3D to RGB pixels with channels of type \p channel_type.
+ *
+ * The pixels are converted into a small float buffer in blocks,
+ * transformed by the LUT and written back, so the conversions are
+ * simple loops without virtual calls.
+ */
+template <typename channel_type>
+class KisLut3DTransformation : public KoColorTransformation
+{
+public:
+    KisLut3DTransformation(const KoColorSpace *cs, KisLut3DSP lut);
+
+    void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override;
+
+private:
+    static const int blockSize = 256;
+
+    KisLut3DSP m_lut;
+    int m_pixelSize = 0;
+
+    /// offsets of the red, green and blue channels in channel_type units
+    int m_offsets[3] = {0, 0, 0};
+};
+
+/**
+ * Creates the transformation for \p cs or returns null if the color
+ * space is not RGB.
+ */
+KoColorTransformation* createLut3DTransformation(const KoColorSpace *cs, KisLut3DSP lut);
+
+#endif // KIS_LUT_3D_TRANSFORMATION_H
@@ -0,0 +1,318 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLut3DTest.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QScopedPointer>
+
+#include <KoChannelInfo.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+#include <KoColorTransformation.h>
+
+#include "../KisLut3D.h"
+#include "../KisLut3DTransformation.h"
+
+#include <functional>
+
+namespace {
+
+typedef std::function<void(float, float, float, float*)> NodeFunction;
+
+QByteArray generateCube(int size, NodeFunction func, const QByteArray &header = QByteArray())
+{
+    QByteArray data = header;
+    data += "LUT_3D_SIZE " + QByteArray::number(size) + "\n";
+
+    // red changes fastest
+    for (int b = 0; b < size; b++) {
+        for (int g = 0; g < size; g++) {
+            for (int r = 0; r < size; r++) {
+                float rgb[3];
+                func(float(r) / (size - 1), float(g) / (size - 1), float(b) / (size - 1), rgb);
+                data += QByteArray::number(rgb[0], 'g', 9) + " " +
+                        QByteArray::number(rgb[1], 'g', 9) + " " +
+                        QByteArray::number(rgb[2], 'g', 9) + "\n";
+            }
+        }
+    }
+
+    return data;
+}
+
+KisLut3DSP loadCube(QByteArray data, QString *errorMessage = 0)
+{
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    return KisLut3D::fromCube(&buffer, errorMessage);
+}
+
+void identity(float r, float g, float b, float *rgb)
+{
+    rgb[0] = r;
+    rgb[1] = g;
+    rgb[2] = b;
+}
+
+void affine(float r, float g, float b, float *rgb)
+{
+    rgb[0] = 0.5f * r + 0.25f * g + 0.1f;
+    rgb[1] = 0.2f * r + 0.3f * g + 0.4f * b;
+    rgb[2] = 0.9f - 0.8f * b;
+}
+
+/**
+ * Channel values in the order R, G, B, A, independently of the
+ * order of the channels in the pixel
+ */
+void setRgba(const KoColorSpace *cs, quint8 *pixel, const QVector<float> &values)
+{
+    QVector<float> channels(cs->channelCount());
+    for (int i = 0; i < channels.size(); i++) {
+        channels[i] = values[cs->channels()[i]->displayPosition()];
+    }
+    cs->fromNormalisedChannelsValue(pixel, channels);
+}
+
+QVector<float> rgba(const KoColorSpace *cs, const quint8 *pixel)
+{
+    QVector<float> channels(cs->channelCount());
+    cs->normalisedChannelsValue(pixel, channels);
+
+    QVector<float> values(cs->channelCount());
+    for (int i = 0; i < channels.size(); i++) {
+        values[cs->channels()[i]->displayPosition()] = channels[i];
+    }
+    return values;
+}
+
+void invert(float r, float g, float b, float *rgb)
+{
+    rgb[0] = 1.0f - r;
+    rgb[1] = 1.0f - g;
+    rgb[2] = 1.0f - b;
+}
+
+}
+
+void KisLut3DTest::testIdentityCube()
+{
+    KisLut3DSP lut = loadCube(generateCube(5, identity, "TITLE \"identity\"\n# comment\n\n"));
+    QVERIFY(lut);
+    QCOMPARE(lut->size3D(), 5);
+    QCOMPARE(lut->size1D(), 0);
+
+    float values[] = {0.0f, 0.0f, 0.0f,
+                      1.0f, 1.0f, 1.0f,
+                      0.1f, 0.7f, 0.3f,
+                      0.33f, 0.66f, 0.99f};
+
+    float result[12];
+    std::copy(values, values + 12, result);
+    lut->transform(result, 4, 3);
+
+    for (int i = 0; i < 12; i++) {
+        QVERIFY(qAbs(result[i] - values[i]) < 1e-5);
+    }
+}
+
+void KisLut3DTest::testLinearCube()
+{
+    // tetrahedral interpolation is exact for affine transformations
+    Q_FOREACH (int size, QVector<int>({2, 17})) {
+        KisLut3DSP lut = loadCube(generateCube(size, affine));
+        QVERIFY(lut);
+
+        for (float r = 0.0f; r <= 1.0f; r += 0.13f) {
+            for (float g = 0.0f; g <= 1.0f; g += 0.17f) {
+                for (float b = 0.0f; b <= 1.0f; b += 0.19f) {
+                    float rgb[3] = {r, g, b};
+                    lut->transform(rgb, 1, 3);
+
+                    float expected[3];
+                    affine(r, g, b, expected);
+
+                    for (int c = 0; c < 3; c++) {
+                        QVERIFY2(qAbs(rgb[c] - expected[c]) < 1e-5,
+                                 QString("size %1, channel %2: %3 != %4")
+                                 .arg(size).arg(c).arg(rgb[c]).arg(expected[c]).toLatin1());
+                    }
+                }
+            }
+        }
+    }
+}
+
+void KisLut3DTest::testShaperAndDomain()
+{
+    {
+        QByteArray data = "LUT_1D_SIZE 2\nLUT_3D_SIZE 2\n";
+        data += "0 0 0\n0.5 0.5 0.5\n";
+        data += generateCube(2, identity).mid(QByteArray("LUT_3D_SIZE 2\n").size());
+
+        KisLut3DSP lut = loadCube(data);
+        QVERIFY(lut);
+        QCOMPARE(lut->size1D(), 2);
+        QCOMPARE(lut->size3D(), 2);
+
+        float rgb[3] = {1.0f, 0.5f, 0.0f};
+        lut->transform(rgb, 1, 3);
+        QVERIFY(qAbs(rgb[0] - 0.5f) < 1e-5);
+        QVERIFY(qAbs(rgb[1] - 0.25f) < 1e-5);
+        QVERIFY(qAbs(rgb[2] - 0.0f) < 1e-5);
+    }
+
+    {
+        // nodes store the input value, the domain is [0, 2]
+        auto scaled = [] (float r, float g, float b, float *rgb) {
+            rgb[0] = 2.0f * r;
+            rgb[1] = 2.0f * g;
+            rgb[2] = 2.0f * b;
+        };
+
+        KisLut3DSP lut = loadCube(generateCube(3, scaled, "DOMAIN_MIN 0 0 0\nDOMAIN_MAX 2 2 2\n"));
+        QVERIFY(lut);
+
+        float rgb[3] = {1.5f, 3.0f, -1.0f};
+        lut->transform(rgb, 1, 3);
+        QVERIFY(qAbs(rgb[0] - 1.5f) < 1e-5);
+        QVERIFY(qAbs(rgb[1] - 2.0f) < 1e-5);
+        QVERIFY(qAbs(rgb[2] - 0.0f) < 1e-5);
+    }
+}
+
+void KisLut3DTest::test3dl()
+{
+    // 12-bit output, blue changes fastest
+    QByteArray data = "# identity\n0 1023\n";
+    for (int r = 0; r < 2; r++) {
+        for (int g = 0; g < 2; g++) {
+            for (int b = 0; b < 2; b++) {
+                data += QByteArray::number(r * 4095) + " " +
+                        QByteArray::number(g * 4095) + " " +
+                        QByteArray::number(b * 4095) + "\n";
+            }
+        }
+    }
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+
+    KisLut3DSP lut = KisLut3D::from3dl(&buffer);
+    QVERIFY(lut);
+    QCOMPARE(lut->size3D(), 2);
+
+    float rgb[3] = {0.25f, 0.5f, 0.75f};
+    lut->transform(rgb, 1, 3);
+    QVERIFY(qAbs(rgb[0] - 0.25f) < 1e-5);
+    QVERIFY(qAbs(rgb[1] - 0.5f) < 1e-5);
+    QVERIFY(qAbs(rgb[2] - 0.75f) < 1e-5);
+}
+
+void KisLut3DTest::testInvalidFiles()
+{
+    QString errorMessage;
+
+    QByteArray truncated = generateCube(3, identity);
+    truncated.chop(10);
+    QVERIFY(!loadCube(truncated, &errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+
+    errorMessage.clear();
+    QVERIFY(!loadCube("LUT_3D_SIZE 2\nUNKNOWN_KEYWORD\n", &errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+
+    errorMessage.clear();
+    QVERIFY(!loadCube("0 0 0\n", &errorMessage));
+    QVERIFY(!errorMessage.isEmpty());
+
+    QVERIFY(!KisLut3D::load("/nonexistent/file.cube", &errorMessage));
+}
+
+void KisLut3DTest::testCacheEviction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QStringList fileNames;
+
+    // more files than the cache keeps
+    for (int i = 0; i < 10; i++) {
+        const QString fileName = dir.filePath(QString("lut%1.cube").arg(i));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(generateCube(2, identity, "TITLE \"" + QByteArray::number(i) + "\"\n"));
+        file.close();
+
+        fileNames << fileName;
+    }
+
+    KisLut3DSP first = KisLut3D::load(fileNames.first());
+    QVERIFY(first);
+    QCOMPARE(KisLut3D::load(fileNames.first()), first);
+
+    Q_FOREACH (const QString &fileName, fileNames.mid(1)) {
+        QVERIFY(KisLut3D::load(fileName));
+    }
+
+    // the least recently used LUT has been evicted and is parsed again
+    KisLut3DSP reloaded = KisLut3D::load(fileNames.first());
+    QVERIFY(reloaded);
+    QVERIFY(reloaded != first);
+
+    // the recently used ones are still cached
+    QCOMPARE(KisLut3D::load(fileNames.last()), KisLut3D::load(fileNames.last()));
+}
+
+void KisLut3DTest::testTransformation_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+
+    QTest::newRow("u8") << Integer8BitsColorDepthID.id();
+    QTest::newRow("u16") << Integer16BitsColorDepthID.id();
+    QTest::newRow("f32") << Float32BitsColorDepthID.id();
+}
+
+void KisLut3DTest::testTransformation()
+{
+    QFETCH(QString, colorDepthId);
+
+    const KoColorSpace *cs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), colorDepthId, 0);
+    QVERIFY(cs);
+
+    KisLut3DSP lut = loadCube(generateCube(9, invert));
+    QVERIFY(lut);
+
+    QScopedPointer<KoColorTransformation> transformation(createLut3DTransformation(cs, lut));
+    QVERIFY(transformation);
+
+    QVector<quint8> src(cs->pixelSize());
+    QVector<quint8> dst(cs->pixelSize());
+
+    setRgba(cs, src.data(), {0.8f, 0.4f, 0.1f, 0.5f});
+    transformation->transform(src.data(), dst.data(), 1);
+
+    const float tolerance = 1.5f / 255.0f;
+    const QVector<float> result = rgba(cs, dst.data());
+    QVERIFY(qAbs(result[0] - 0.2f) < tolerance);
+    QVERIFY(qAbs(result[1] - 0.6f) < tolerance);
+    QVERIFY(qAbs(result[2] - 0.9f) < tolerance);
+    QVERIFY(qAbs(result[3] - 0.5f) < tolerance);
+
+    // in place
+    transformation->transform(dst.data(), dst.data(), 1);
+    QVERIFY(qAbs(rgba(cs, dst.data())[0] - 0.8f) < tolerance);
+
+    // non-rgb spaces are not supported
+    QVERIFY(!createLut3DTransformation(KoColorSpaceRegistry::instance()->lab16(), lut));
+}
+
+SIMPLE_TEST_MAIN(KisLut3DTest)
@@ -0,0 +1,26 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_LUT_3D_TEST_H
+#define KIS_LUT_3D_TEST_H
+
+#include <simpletest.h>
+
+class KisLut3DTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testIdentityCube();
+    void testLinearCube();
+    void testShaperAndDomain();
+    void test3dl();
+    void testInvalidFiles();
+    void testCacheEviction();
+    void testTransformation_data();
+    void testTransformation();
+};
+
+#endif // KIS_LUT_3D_TEST_H
@@ -196,6 +196,10 @@ void KisAllFilterTest::testAllFilters()
     // let's just exclude it
     excludeFilters << "halftone";
 
+    // the reference images of these filters have not been generated yet
+    excludeFilters << "surface blur";
+    excludeFilters << "despeckle";
+
     QStringList failures;
     QStringList successes;
 
@@ -227,6 +231,10 @@ void KisAllFilterTest::testAllFiltersSrcNotIsDev()
     // let's just exclude it
     excludeFilters << "halftone";
 
+    // the reference images of these filters have not been generated yet
+    excludeFilters << "surface blur";
+    excludeFilters << "despeckle";
+
     QStringList failures;
     QStringList successes;
 
@@ -259,6 +267,10 @@ void KisAllFilterTest::testAllFiltersWithSelections()
     // let's just exclude it
     excludeFilters << "halftone";
 
+    // the reference images of these filters have not been generated yet
+    excludeFilters << "surface blur";
+    excludeFilters << "despeckle";
+
     QStringList failures;
     QStringList successes;
 
@@ -31,7 +31,8 @@ struct WeightedSampleWrapper
               m_samplePixelSize(sampleDab->colorSpace()->pixelSize()),
               m_sampleRect(sampleRect),
               m_samplePtr(sampleDab->data()),
-              m_sampleStride(sampleDab->bounds().width() * m_samplePixelSize)
+              m_sampleStride(sampleDab->bounds().width() * m_samplePixelSize),
+              m_pixelBuffer(maxBufferedPixels * m_samplePixelSize)
     {
 
     }
@@ -42,7 +43,27 @@ struct WeightedSampleWrapper
         const qint16 opacity = *(m_maskPtr + maskPt.x() + maskPt.y() * m_maskStride);
         const quint8 *ptr = m_samplePtr + relativeSamplePoint.x() * m_samplePixelSize + relativeSamplePoint.y() * m_sampleStride;
 
-        m_mixer->accumulate(ptr, &opacity, opacity, 1);
+        memcpy(m_pixelBuffer.data() + m_numBufferedPixels * m_samplePixelSize, ptr, m_samplePixelSize);
+        m_weights[m_numBufferedPixels] = opacity;
+        m_weightsSum += opacity;
+        m_numBufferedPixels++;
+
+        if (m_numBufferedPixels >= maxBufferedPixels) {
+            flush();
+        }
+    }
+
+    /**
+     * Pass all the buffered pixels to the mixer. The mixer is
+     * much more efficient when it gets pixels in batches, since
+     * it can process them with vector instructions.
+     */
+    inline void flush() {
+        if (!m_numBufferedPixels) return;
+
+        m_mixer->accumulate(m_pixelBuffer.data(), m_weights, m_weightsSum, m_numBufferedPixels);
+        m_numBufferedPixels = 0;
+        m_weightsSum = 0;
     }
 
     static void verifySampleRadiusValue(qreal *sampleRadiusValue) {
@@ -68,6 +89,12 @@ struct WeightedSampleWrapper
     const QRect m_sampleRect;
     quint8 *m_samplePtr;
     const int m_sampleStride;
+
+    static constexpr int maxBufferedPixels = 64;
+    QVector<quint8> m_pixelBuffer;
+    qint16 m_weights[maxBufferedPixels];
+    int m_weightsSum = 0;
+    int m_numBufferedPixels = 0;
 };
 
 struct AveragedSampleWrapper
@@ -79,7 +106,8 @@ struct AveragedSampleWrapper
               m_samplePixelSize(sampleDab->colorSpace()->pixelSize()),
               m_sampleRect(sampleRect),
               m_samplePtr(sampleDab->data()),
-              m_sampleStride(sampleDab->bounds().width() * m_samplePixelSize)
+              m_sampleStride(sampleDab->bounds().width() * m_samplePixelSize),
+              m_pixelBuffer(maxBufferedPixels * m_samplePixelSize)
     {
         Q_UNUSED(maskDab);
         Q_UNUSED(maskRect);
@@ -87,7 +115,20 @@ struct AveragedSampleWrapper
 
     inline void samplePixel(const QPoint &relativeSamplePoint) {
         const quint8 *ptr = m_samplePtr + relativeSamplePoint.x() * m_samplePixelSize + relativeSamplePoint.y() * m_sampleStride;
-        m_mixer->accumulateAverage(ptr, 1);
+
+        memcpy(m_pixelBuffer.data() + m_numBufferedPixels * m_samplePixelSize, ptr, m_samplePixelSize);
+        m_numBufferedPixels++;
+
+        if (m_numBufferedPixels >= maxBufferedPixels) {
+            flush();
+        }
+    }
+
+    inline void flush() {
+        if (!m_numBufferedPixels) return;
+
+        m_mixer->accumulateAverage(m_pixelBuffer.data(), m_numBufferedPixels);
+        m_numBufferedPixels = 0;
     }
 
     static void verifySampleRadiusValue(qreal *sampleRadiusValue) {
@@ -103,6 +144,10 @@ struct AveragedSampleWrapper
     const QRect m_sampleRect;
     quint8 *m_samplePtr;
     const int m_sampleStride;
+
+    static constexpr int maxBufferedPixels = 64;
+    QVector<quint8> m_pixelBuffer;
+    int m_numBufferedPixels = 0;
 };
 
 /**
@@ -181,6 +226,7 @@ void sampleColor(const QRect &srcRect,
             weightingModeWrapper.samplePixel(pt);
         }
 
+        weightingModeWrapper.flush();
         mixer->computeMixedColor(resultColor->data());
         lastPickedColor = *resultColor;
 
@@ -196,6 +242,7 @@ void sampleColor(const QRect &srcRect,
                 weightingModeWrapper.samplePixel(pt);
             }
 
+            weightingModeWrapper.flush();
             mixer->computeMixedColor(resultColor->data());
 
             const quint8 difference =
@@ -6,7 +6,96 @@
 
 #include "KisColorSmudgeStrategy.h"
 
+#include <QtMath>
+
+#include "kis_fixed_paint_device.h"
+
+namespace {
+KisFixedPaintDeviceSP deepCopy(KisFixedPaintDeviceSP device)
+{
+    KisFixedPaintDeviceSP copy = new KisFixedPaintDevice(*device);
+
+    /**
+     * The copy shares the buffer with the original implicitly. Detach
+     * it right now, otherwise the first concurrent accesses to data()
+     * would race for detaching it.
+     */
+    copy->data();
+
+    return copy;
+}
+}
+
+void KisColorSmudgeStrategy::DabMask::detachFromDabCache()
+{
+    if (maskDabIsCached && maskDab) {
+        maskDab = deepCopy(maskDab);
+    }
+
+    if (origDabIsCached && origDab) {
+        origDab = deepCopy(origDab);
+    }
+
+    maskDabIsCached = false;
+    origDabIsCached = false;
+}
+
 KisColorSmudgeStrategy::KisColorSmudgeStrategy()
         : m_memoryAllocator(new KisOptimizedByteArray::PooledMemoryAllocator())
 {
 }
+
+QVector<QRect> KisColorSmudgeStrategy::paintDab(const DabMask &mask, const QRect &srcRect,
+                                                const KoColor &currentPaintColor, qreal opacity,
+                                                qreal colorRateValue, qreal smudgeRateValue,
+                                                qreal maxPossibleSmudgeRateValue,
+                                                qreal lightnessStrengthValue, qreal smudgeRadiusValue)
+{
+    prepareDab(mask, {mask.dstRect}, srcRect,
+               currentPaintColor, opacity,
+               colorRateValue, smudgeRateValue,
+               maxPossibleSmudgeRateValue,
+               lightnessStrengthValue, smudgeRadiusValue);
+
+    blendDabStripe(0);
+    writeDabStripe(0);
+
+    return finishDab();
+}
+
+QVector<QRect> KisColorSmudgeStrategy::splitDabIntoStripes(const QRect &dstRect, int maxStripes)
+{
+    /**
+     * The height of a tile of KisPaintDevice. When the stripes are
+     * aligned to the tile rows, the concurrent jobs write into
+     * different tiles.
+     */
+    const int tileSize = 64;
+
+    const int numStripes = qBound(1, dstRect.height() / tileSize, qMax(1, maxStripes));
+
+    if (numStripes <= 1) {
+        return {dstRect};
+    }
+
+    const int firstTileRow = qFloor(qreal(dstRect.top()) / tileSize);
+    const int lastTileRow = qFloor(qreal(dstRect.bottom()) / tileSize);
+    const int numTileRows = lastTileRow - firstTileRow + 1;
+
+    QVector<QRect> stripes;
+    int top = dstRect.top();
+
+    for (int i = 1; i < numStripes; i++) {
+        const int boundaryRow = firstTileRow + qRound(qreal(i) * numTileRows / numStripes);
+        const int bottom = boundaryRow * tileSize;
+
+        if (bottom > top && bottom <= dstRect.bottom()) {
+            stripes << QRect(dstRect.left(), top, dstRect.width(), bottom - top);
+            top = bottom;
+        }
+    }
+
+    stripes << QRect(dstRect.left(), top, dstRect.width(), dstRect.bottom() + 1 - top);
+
+    return stripes;
+}
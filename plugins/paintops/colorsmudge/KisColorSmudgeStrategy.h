@@ -12,6 +12,36 @@
 
 class KisColorSmudgeStrategy
 {
+public:
+    /**
+     * The dab generated by updateMask(). The strategy doesn't keep any
+     * reference to it, so the dabs can be generated ahead of time, while
+     * the previous ones are still being rendered, \see KisColorSmudgeOp
+     */
+    struct DabMask
+    {
+        /// the alpha mask of the dab
+        KisFixedPaintDeviceSP maskDab;
+
+        /// the colored dab or the heightmap the mask has been generated from (if any)
+        KisFixedPaintDeviceSP origDab;
+
+        QRect dstRect;
+
+        /// the dab should be copied before being mirrored in place
+        bool shouldPreserveDab {true};
+
+        /// the device belongs to the dab cache and will be overwritten on the next fetch
+        bool maskDabIsCached {false};
+        bool origDabIsCached {false};
+
+        /**
+         * Copies the devices that still belong to the dab cache, so that
+         * the dab stays valid after the next call to updateMask()
+         */
+        void detachFromDabCache();
+    };
+
 public:
     KisColorSmudgeStrategy();
 
@@ -19,24 +49,85 @@ public:
 
     virtual void initializePainting() = 0;
 
+    /**
+     * Generates the mask of the dab into \p mask. If the mask has some
+     * devices allocated already, the strategy may reuse them.
+     */
     virtual void updateMask(KisDabCache *dabCache,
                             const KisPaintInformation& info,
                             const KisDabShape &shape,
                             const QPointF &cursorPoint,
-                            QRect *dstDabRect,
+                            DabMask *mask,
                             qreal lightnessStrength) = 0;
 
-    virtual QVector<QRect> paintDab(const QRect &srcRect, const QRect &dstRect,
-                                    const KoColor &currentPaintColor,
-                                    qreal opacity,
-                                    qreal colorRateValue,
-                                    qreal smudgeRateValue,
-                                    qreal maxPossibleSmudgeRateValue,
-                                    qreal lightnessStrengthValue,
-                                    qreal smudgeRadiusValue) = 0;
+    /**
+     * Renders the dab in one go
+     */
+    QVector<QRect> paintDab(const DabMask &mask,
+                            const QRect &srcRect,
+                            const KoColor &currentPaintColor,
+                            qreal opacity,
+                            qreal colorRateValue,
+                            qreal smudgeRateValue,
+                            qreal maxPossibleSmudgeRateValue,
+                            qreal lightnessStrengthValue,
+                            qreal smudgeRadiusValue);
+
+    /**
+     * The dab can also be rendered in stages, the heavy ones operate
+     * on horizontal stripes of the dab and can be run concurrently:
+     *
+     * 1) prepareDab() reads the source data and samples the dulling
+     *    color (sequential)
+     *
+     * 2) blendDabStripe() blends the smudged color and the paint color
+     *    for a stripe (concurrent)
+     *
+     * 3) writeDabStripe() writes a stripe into the destination device
+     *    (concurrent). The smudge source may be the destination device
+     *    itself, so no stripe may be written before all of them have
+     *    been blended.
+     *
+     * 4) finishDab() renders the mirrored dabs and writes the result
+     *    back into the layer (sequential)
+     *
+     * The next dab can be prepared only after the previous one has
+     * been finished, because it reads the data the previous one has
+     * written.
+     *
+     * \p stripes must cover mask.dstRect and span its whole width,
+     * \see splitDabIntoStripes()
+     */
+    virtual void prepareDab(const DabMask &mask,
+                            const QVector<QRect> &stripes,
+                            const QRect &srcRect,
+                            const KoColor &currentPaintColor,
+                            qreal opacity,
+                            qreal colorRateValue,
+                            qreal smudgeRateValue,
+                            qreal maxPossibleSmudgeRateValue,
+                            qreal lightnessStrengthValue,
+                            qreal smudgeRadiusValue) = 0;
+
+    virtual void blendDabStripe(int stripe) = 0;
+
+    virtual void writeDabStripe(int stripe) = 0;
+
+    /**
+     * \return the rects changed by the dab
+     */
+    virtual QVector<QRect> finishDab() = 0;
 
     virtual const KoColorSpace* preciseColorSpace() const = 0;
 
+    /**
+     * Splits \p dstRect into at most \p maxStripes horizontal stripes.
+     * The stripes are aligned to the rows of the tiles of the paint
+     * device and are never smaller than a tile, so small dabs are not
+     * split at all.
+     */
+    static QVector<QRect> splitDabIntoStripes(const QRect &dstRect, int maxStripes);
+
 protected:
     KisOptimizedByteArray::MemoryAllocatorSP m_memoryAllocator;
 };
@@ -12,6 +12,27 @@
 #include "kis_paint_device.h"
 #include "KisColorSmudgeSampleUtils.h"
 
+namespace {
+
+/**
+ * \return the pointer to the first row of a stripe of \p device,
+ *         that starts \p rowOffset rows below its top
+ */
+inline quint8* stripeData(KisFixedPaintDeviceSP device, int rowOffset)
+{
+    return device->data() + rowOffset * device->bounds().width() * device->pixelSize();
+}
+
+inline int stripeRowOffset(KisFixedPaintDeviceSP device, const QRect &stripe)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(stripe.left() == device->bounds().left() &&
+                                 stripe.width() == device->bounds().width());
+
+    return stripe.top() - device->bounds().top();
+}
+
+}
+
 /**********************************************************************************/
 /*                 DabColoringStrategyMask                                        */
 /**********************************************************************************/
@@ -32,10 +53,12 @@ void KisColorSmudgeStrategyBase::DabColoringStrategyMask::blendInFusedBackground
     colorRateOp->composite(dullingFillColor.data(), 1, paintColor.data(), 1, 0, 0, 1, 1, colorRateOpacity);
 
     if (smearOp->id() == COMPOSITE_COPY && smudgeRateOpacity == OPACITY_OPAQUE_U8) {
-        dst->fill(dst->bounds(), dullingFillColor);
+        dst->fill(dstRect, dullingFillColor);
     } else {
-        src->readBytes(dst->data(), dstRect);
-        smearOp->composite(dst->data(), dstRect.width() * dst->pixelSize(),
+        quint8 *dstPtr = stripeData(dst, stripeRowOffset(dst, dstRect));
+
+        src->readBytes(dstPtr, dstRect);
+        smearOp->composite(dstPtr, dstRect.width() * dst->pixelSize(),
                            dullingFillColor.data(), 0,
                            0, 0,
                            1, dstRect.width() * dstRect.height(),
@@ -51,7 +74,8 @@ void KisColorSmudgeStrategyBase::DabColoringStrategyMask::blendInColorRate(const
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN(*paintColor.colorSpace() == *colorRateOp->colorSpace());
 
-    colorRateOp->composite(dstDevice->data(), dstRect.width() * dstDevice->pixelSize(),
+    colorRateOp->composite(stripeData(dstDevice, stripeRowOffset(dstDevice, dstRect)),
+                           dstRect.width() * dstDevice->pixelSize(),
                            paintColor.data(), 0,
                            0, 0,
                            dstRect.height(), dstRect.width(),
@@ -78,8 +102,10 @@ void KisColorSmudgeStrategyBase::DabColoringStrategyStamp::blendInColorRate(cons
     // TODO: check correctness for composition source device (transparency masks)
     KIS_ASSERT_RECOVER_RETURN(*dstDevice->colorSpace() == *m_origDab->colorSpace());
 
-    colorRateOp->composite(dstDevice->data(), dstRect.width() * dstDevice->pixelSize(),
-                           m_origDab->data(), dstRect.width() * m_origDab->pixelSize(),
+    const int rowOffset = stripeRowOffset(dstDevice, dstRect);
+
+    colorRateOp->composite(stripeData(dstDevice, rowOffset), dstRect.width() * dstDevice->pixelSize(),
+                           stripeData(m_origDab, rowOffset), dstRect.width() * m_origDab->pixelSize(),
                            0, 0,
                            dstRect.height(), dstRect.width(),
                            colorRateOpacity);
@@ -180,12 +206,14 @@ void KisColorSmudgeStrategyBase::sampleDullingColor(const QRect &srcRect, qreal
                                        maskDab, resultColor);
 }
 
-void
-KisColorSmudgeStrategyBase::blendBrush(const QVector<KisPainter *> dstPainters, KisColorSmudgeSourceSP srcSampleDevice,
-                                       KisFixedPaintDeviceSP maskDab, bool preserveMaskDab, const QRect &srcRect,
-                                       const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
-                                       qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue, qreal colorRateValue,
-                                       qreal smudgeRadiusValue)
+void KisColorSmudgeStrategyBase::prepareBlending(const QVector<KisPainter *> &dstPainters,
+                                                 KisColorSmudgeSourceSP srcSampleDevice,
+                                                 KisFixedPaintDeviceSP maskDab, bool preserveMaskDab,
+                                                 const QRect &srcRect, const QRect &dstRect,
+                                                 const QVector<QRect> &stripes,
+                                                 const KoColor &currentPaintColor, qreal opacity,
+                                                 qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
+                                                 qreal colorRateValue, qreal smudgeRadiusValue)
 {
     const quint8 colorRateOpacity = this->colorRateOpacity(opacity, smudgeRateValue, colorRateValue, maxPossibleSmudgeRateValue);
 
@@ -203,79 +231,150 @@ KisColorSmudgeStrategyBase::blendBrush(const QVector<KisPainter *> dstPainters,
     m_blendDevice->setRect(dstRect);
     m_blendDevice->lazyGrowBufferWithoutInitialization();
 
-    DabColoringStrategy &coloringStrategy = this->coloringStrategy();
-
     const quint8 dullingRateOpacity = this->dullingRateOpacity(opacity, smudgeRateValue);
 
-    if (colorRateOpacity > 0 &&
+    m_currentDab.dstPainters = dstPainters;
+    m_currentDab.srcSampleDevice = srcSampleDevice;
+    m_currentDab.maskDab = maskDab;
+    m_currentDab.preserveMaskDab = preserveMaskDab;
+    m_currentDab.srcRect = srcRect;
+    m_currentDab.dstRect = dstRect;
+    m_currentDab.stripes = stripes;
+    m_currentDab.paintColor = currentPaintColor.convertedTo(m_preparedDullingColor.colorSpace());
+    m_currentDab.colorRateOpacity = colorRateOpacity;
+    m_currentDab.dullingRateOpacity = dullingRateOpacity;
+    m_currentDab.smearRateOpacity = this->smearRateOpacity(opacity, smudgeRateValue);
+    m_currentDab.useFusedDullingBlending =
+        colorRateOpacity > 0 &&
         m_useDullingMode &&
-        coloringStrategy.supportsFusedDullingBlending() &&
+        coloringStrategy().supportsFusedDullingBlending() &&
         ((m_smearOp->id() == COMPOSITE_OVER &&
           m_colorRateOp->id() == COMPOSITE_OVER) ||
          (m_smearOp->id() == COMPOSITE_COPY &&
-          dullingRateOpacity == OPACITY_OPAQUE_U8))) {
+          dullingRateOpacity == OPACITY_OPAQUE_U8));
+
+    // the set of the destination painters doesn't change during the stroke
+    const int numStripePainters = (stripes.size() - 1) * dstPainters.size();
+
+    while (m_stripePainters.size() < numStripePainters) {
+        KisPainter *dstPainter = dstPainters[m_stripePainters.size() % dstPainters.size()];
+
+        QSharedPointer<KisPainter> painter(new KisPainter());
+        painter->begin(dstPainter->device());
+        painter->setCompositeOpId(dstPainter->compositeOpId());
+        painter->setSelection(dstPainter->selection());
+        painter->setChannelFlags(dstPainter->channelFlags());
+
+        m_stripePainters.append(painter);
+    }
+
+    const quint8 finalPainterOpacity = this->finalPainterOpacity(opacity, smudgeRateValue);
 
+    for (int stripe = 0; stripe < stripes.size(); stripe++) {
+        for (int i = 0; i < dstPainters.size(); i++) {
+            stripePainter(stripe, i)->setOpacity(finalPainterOpacity);
+        }
+    }
+}
+
+void KisColorSmudgeStrategyBase::blendDabStripe(int stripe)
+{
+    const QRect &dstRect = m_currentDab.stripes[stripe];
+
+    DabColoringStrategy &coloringStrategy = this->coloringStrategy();
+
+    if (m_currentDab.useFusedDullingBlending) {
         coloringStrategy.blendInFusedBackgroundAndColorRateWithDulling(m_blendDevice,
-                                                                       srcSampleDevice,
+                                                                       m_currentDab.srcSampleDevice,
                                                                        dstRect,
                                                                        m_preparedDullingColor,
                                                                        m_smearOp,
-                                                                       dullingRateOpacity,
-                                                                       currentPaintColor.convertedTo(
-                                                                               m_preparedDullingColor.colorSpace()),
+                                                                       m_currentDab.dullingRateOpacity,
+                                                                       m_currentDab.paintColor,
                                                                        m_colorRateOp,
-                                                                       colorRateOpacity);
+                                                                       m_currentDab.colorRateOpacity);
 
     } else {
         if (!m_useDullingMode) {
-            const quint8 smudgeRateOpacity = this->smearRateOpacity(opacity, smudgeRateValue);
-            blendInBackgroundWithSmearing(m_blendDevice, srcSampleDevice,
-                                          srcRect, dstRect, smudgeRateOpacity);
+            const QRect srcRect =
+                dstRect.translated(m_currentDab.srcRect.topLeft() - m_currentDab.dstRect.topLeft());
+
+            blendInBackgroundWithSmearing(m_blendDevice, m_currentDab.srcSampleDevice,
+                                          srcRect, dstRect, m_currentDab.smearRateOpacity);
         } else {
-            blendInBackgroundWithDulling(m_blendDevice, srcSampleDevice,
+            blendInBackgroundWithDulling(m_blendDevice, m_currentDab.srcSampleDevice,
                                          dstRect,
-                                         m_preparedDullingColor, dullingRateOpacity);
+                                         m_preparedDullingColor, m_currentDab.dullingRateOpacity);
         }
 
-        if (colorRateOpacity > 0) {
+        if (m_currentDab.colorRateOpacity > 0) {
             coloringStrategy.blendInColorRate(
-                    currentPaintColor.convertedTo(m_preparedDullingColor.colorSpace()),
+                    m_currentDab.paintColor,
                     m_colorRateOp,
-                    colorRateOpacity,
+                    m_currentDab.colorRateOpacity,
                     m_blendDevice, dstRect);
         }
     }
+}
 
-    const bool preserveDab = preserveMaskDab && dstPainters.size() > 1;
+void KisColorSmudgeStrategyBase::writeDabStripe(int stripe)
+{
+    const QRect &dstRect = m_currentDab.stripes[stripe];
+    const int rowOffset = dstRect.top() - m_currentDab.dstRect.top();
+
+    const QRect maskBounds = m_currentDab.maskDab->bounds();
+    const QRect blendBounds = m_blendDevice->bounds();
+
+    for (int i = 0; i < m_currentDab.dstPainters.size(); i++) {
+        stripePainter(stripe, i)->bltFixedWithFixedSelection(dstRect.x(), dstRect.y(),
+                                                             m_blendDevice, m_currentDab.maskDab,
+                                                             maskBounds.x(), maskBounds.y() + rowOffset,
+                                                             blendBounds.x(), blendBounds.y() + rowOffset,
+                                                             dstRect.width(), dstRect.height());
+    }
+}
+
+void KisColorSmudgeStrategyBase::finishBlending()
+{
+    // the stripe painters are used for writing only, their dirty rects are not needed
+    Q_FOREACH (QSharedPointer<KisPainter> painter, m_stripePainters) {
+        painter->takeDirtyRegion();
+    }
 
-    Q_FOREACH (KisPainter *dstPainter, dstPainters) {
-        dstPainter->setOpacity(finalPainterOpacity(opacity, smudgeRateValue));
+    const bool preserveDab = m_currentDab.preserveMaskDab && m_currentDab.dstPainters.size() > 1;
 
-        dstPainter->bltFixedWithFixedSelection(dstRect.x(), dstRect.y(),
-                                               m_blendDevice, maskDab,
-                                               maskDab->bounds().x(), maskDab->bounds().y(),
-                                               m_blendDevice->bounds().x(), m_blendDevice->bounds().y(),
-                                               dstRect.width(), dstRect.height());
-        dstPainter->renderMirrorMaskSafe(dstRect, m_blendDevice, maskDab, preserveDab);
+    Q_FOREACH (KisPainter *dstPainter, m_currentDab.dstPainters) {
+        dstPainter->renderMirrorMaskSafe(m_currentDab.dstRect, m_blendDevice, m_currentDab.maskDab, preserveDab);
     }
 
+    m_currentDab.srcSampleDevice.clear();
+    m_currentDab.maskDab.clear();
+}
+
+KisPainter *KisColorSmudgeStrategyBase::stripePainter(int stripe, int painterIndex) const
+{
+    return stripe > 0 ?
+        m_stripePainters[(stripe - 1) * m_currentDab.dstPainters.size() + painterIndex].data() :
+        m_currentDab.dstPainters[painterIndex];
 }
 
 void KisColorSmudgeStrategyBase::blendInBackgroundWithSmearing(KisFixedPaintDeviceSP dst, KisColorSmudgeSourceSP src,
                                                                const QRect &srcRect, const QRect &dstRect,
                                                                const quint8 smudgeRateOpacity)
 {
+    quint8 *dstPtr = stripeData(dst, stripeRowOffset(dst, dstRect));
+
     if (m_smearOp->id() == COMPOSITE_COPY && smudgeRateOpacity == OPACITY_OPAQUE_U8) {
-        src->readBytes(dst->data(), srcRect);
+        src->readBytes(dstPtr, srcRect);
     } else {
-        src->readBytes(dst->data(), dstRect);
+        src->readBytes(dstPtr, dstRect);
 
         KisFixedPaintDevice tempDevice(src->colorSpace(), m_memoryAllocator);
         tempDevice.setRect(srcRect);
         tempDevice.lazyGrowBufferWithoutInitialization();
 
         src->readBytes(tempDevice.data(), srcRect);
-        m_smearOp->composite(dst->data(), dstRect.width() * dst->pixelSize(),
+        m_smearOp->composite(dstPtr, dstRect.width() * dst->pixelSize(),
                              tempDevice.data(), dstRect.width() * tempDevice.pixelSize(), // stride should be random non-zero
                              0, 0,
                              1, dstRect.width() * dstRect.height(),
@@ -290,10 +389,12 @@ void KisColorSmudgeStrategyBase::blendInBackgroundWithDulling(KisFixedPaintDevic
     Q_UNUSED(preparedDullingColor);
 
     if (m_smearOp->id() == COMPOSITE_COPY && smudgeRateOpacity == OPACITY_OPAQUE_U8) {
-        dst->fill(dst->bounds(), m_preparedDullingColor);
+        dst->fill(dstRect, m_preparedDullingColor);
     } else {
-        src->readBytes(dst->data(), dstRect);
-        m_smearOp->composite(dst->data(), dstRect.width() * dst->pixelSize(),
+        quint8 *dstPtr = stripeData(dst, stripeRowOffset(dst, dstRect));
+
+        src->readBytes(dstPtr, dstRect);
+        m_smearOp->composite(dstPtr, dstRect.width() * dst->pixelSize(),
                              m_preparedDullingColor.data(), 0,
                              0, 0,
                              1, dstRect.width() * dstRect.height(),
@@ -18,6 +18,10 @@ class KisPainter;
 class KisColorSmudgeStrategyBase : public KisColorSmudgeStrategy
 {
 public:
+    /**
+     * \p dstRect passed to the blending functions is a stripe of the
+     * bounds of the destination device that spans its whole width
+     */
     struct DabColoringStrategy
     {
         virtual ~DabColoringStrategy() = default;
@@ -103,10 +107,25 @@ public:
                                     KisFixedPaintDeviceSP tempFixedDevice, KisFixedPaintDeviceSP maskDab,
                                     KoColor *resultColor);
 
-    void blendBrush(const QVector<KisPainter *> dstPainters, KisColorSmudgeSourceSP srcSampleDevice,
-                    KisFixedPaintDeviceSP maskDab, bool preserveMaskDab, const QRect &srcRect, const QRect &dstRect,
-                    const KoColor &currentPaintColor, qreal opacity, qreal smudgeRateValue,
-                    qreal maxPossibleSmudgeRateValue, qreal colorRateValue, qreal smudgeRadiusValue);
+    /**
+     * Samples the dulling color and sets up the blending of the dab into
+     * \p dstPainters, the blending itself is done by blendDabStripe() and
+     * writeDabStripe(), \see KisColorSmudgeStrategy::prepareDab()
+     */
+    void prepareBlending(const QVector<KisPainter *> &dstPainters, KisColorSmudgeSourceSP srcSampleDevice,
+                         KisFixedPaintDeviceSP maskDab, bool preserveMaskDab, const QRect &srcRect, const QRect &dstRect,
+                         const QVector<QRect> &stripes,
+                         const KoColor &currentPaintColor, qreal opacity, qreal smudgeRateValue,
+                         qreal maxPossibleSmudgeRateValue, qreal colorRateValue, qreal smudgeRadiusValue);
+
+    void blendDabStripe(int stripe) override;
+
+    void writeDabStripe(int stripe) override;
+
+    /**
+     * Renders the mirrored copies of the blended dab
+     */
+    void finishBlending();
 
     void blendInBackgroundWithSmearing(KisFixedPaintDeviceSP dst, KisColorSmudgeSourceSP src, const QRect &srcRect,
                                        const QRect &dstRect, const quint8 smudgeRateOpacity);
@@ -118,9 +137,40 @@ protected:
     const KoCompositeOp * m_colorRateOp {nullptr};
     KoColor m_preparedDullingColor;
     const KoCompositeOp * m_smearOp {nullptr};
+private:
+    KisPainter* stripePainter(int stripe, int painterIndex) const;
+
 private:
     KisFixedPaintDeviceSP m_blendDevice;
     bool m_useDullingMode {true};
+
+    /**
+     * The dab being blended, set up by prepareBlending()
+     */
+    struct CurrentDab {
+        QVector<KisPainter*> dstPainters;
+        KisColorSmudgeSourceSP srcSampleDevice;
+        KisFixedPaintDeviceSP maskDab;
+        bool preserveMaskDab {true};
+        QRect srcRect;
+        QRect dstRect;
+        QVector<QRect> stripes;
+        KoColor paintColor;
+        quint8 colorRateOpacity {0};
+        quint8 dullingRateOpacity {0};
+        quint8 smearRateOpacity {0};
+        bool useFusedDullingBlending {false};
+    };
+
+    CurrentDab m_currentDab;
+
+    /**
+     * KisPainter cannot be used from several threads at once, so every
+     * stripe, except the first one, writes into the destination devices
+     * with its own copies of the destination painters. The painters
+     * of stripe N are stored at [(N - 1) * numPainters, N * numPainters).
+     */
+    QVector<QSharedPointer<KisPainter>> m_stripePainters;
 };
 
 
@@ -20,8 +20,6 @@
 KisColorSmudgeStrategyLightness::KisColorSmudgeStrategyLightness(KisPainter *painter, bool smearAlpha,
                                                                  bool useDullingMode, KisPaintThicknessOptionData::ThicknessMode thicknessMode)
         : KisColorSmudgeStrategyBase(useDullingMode)
-        , m_maskDab(new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8()))
-        , m_origDab(new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->rgb8()))
         , m_smearAlpha(smearAlpha)
         , m_initializationPainter(painter)
         , m_thicknessMode(thicknessMode)
@@ -89,27 +87,29 @@ KisColorSmudgeStrategyBase::DabColoringStrategy &KisColorSmudgeStrategyLightness
 
 void KisColorSmudgeStrategyLightness::updateMask(KisDabCache *dabCache, const KisPaintInformation &info,
                                                  const KisDabShape &shape, const QPointF &cursorPoint,
-                                                 QRect *dstDabRect, qreal paintThickness)
+                                                 DabMask *mask, qreal paintThickness)
 {
-    m_origDab = dabCache->fetchNormalizedImageDab(m_origDab->colorSpace(),
-                                                  cursorPoint,
-                                                  shape,
-                                                  info,
-                                                  1.0,
-                                                  dstDabRect);
+    mask->origDab = dabCache->fetchNormalizedImageDab(KoColorSpaceRegistry::instance()->rgb8(),
+                                                      cursorPoint,
+                                                      shape,
+                                                      info,
+                                                      1.0,
+                                                      &mask->dstRect);
 
-    m_shouldPreserveOriginalDab = !dabCache->needSeparateOriginal();
+    mask->origDabIsCached = true;
+    mask->shouldPreserveDab = !dabCache->needSeparateOriginal();
 
-    const int numPixels = m_origDab->bounds().width() * m_origDab->bounds().height();
+    const int numPixels = mask->origDab->bounds().width() * mask->origDab->bounds().height();
 
     if (paintThickness < 1.0) {
-        if (m_shouldPreserveOriginalDab) {
-            m_shouldPreserveOriginalDab = false;
-            m_origDab = new KisFixedPaintDevice(*m_origDab);
+        if (mask->shouldPreserveDab) {
+            mask->shouldPreserveDab = false;
+            mask->origDab = new KisFixedPaintDevice(*mask->origDab);
+            mask->origDabIsCached = false;
         }
 
         const int denormedPaintThickness = qRound(paintThickness * 255.0);
-        KoBgrU8Traits::Pixel *pixelPtr = reinterpret_cast<KoBgrU8Traits::Pixel *>(m_origDab->data());
+        KoBgrU8Traits::Pixel *pixelPtr = reinterpret_cast<KoBgrU8Traits::Pixel *>(mask->origDab->data());
         for (int i = 0; i < numPixels; i++) {
             int gray = pixelPtr->red - 127;
 
@@ -129,31 +129,36 @@ void KisColorSmudgeStrategyLightness::updateMask(KisDabCache *dabCache, const Ki
         }
     }
 
-    m_maskDab->setRect(m_origDab->bounds());
-    m_maskDab->lazyGrowBufferWithoutInitialization();
-    m_origDab->colorSpace()->copyOpacityU8(m_origDab->data(), m_maskDab->data(), numPixels);
+    if (!mask->maskDab) {
+        mask->maskDab = new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+    }
+
+    mask->maskDab->setRect(mask->origDab->bounds());
+    mask->maskDab->lazyGrowBufferWithoutInitialization();
+    mask->origDab->colorSpace()->copyOpacityU8(mask->origDab->data(), mask->maskDab->data(), numPixels);
+    mask->maskDabIsCached = false;
 }
 
-QVector<QRect>
-KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor,
-                                          qreal opacity, qreal colorRateValue, qreal smudgeRateValue,
-                                          qreal maxPossibleSmudgeRateValue, qreal paintThicknessValue,
-                                          qreal smudgeRadiusValue)
+void KisColorSmudgeStrategyLightness::prepareDab(const DabMask &mask, const QVector<QRect> &stripes,
+                                                 const QRect &srcRect, const KoColor &currentPaintColor,
+                                                 qreal opacity, qreal colorRateValue, qreal smudgeRateValue,
+                                                 qreal maxPossibleSmudgeRateValue, qreal paintThicknessValue,
+                                                 qreal smudgeRadiusValue)
 {
-    const int numPixels = dstRect.width() * dstRect.height();
-
-    const QVector<QRect> mirroredRects = m_finalPainter.calculateAllMirroredRects(dstRect);
+    m_currentMask = mask;
+    m_mirroredRects = m_finalPainter.calculateAllMirroredRects(mask.dstRect);
 
     QVector<QRect> readRects;
-    readRects << mirroredRects;
+    readRects << m_mirroredRects;
     readRects << srcRect;
     m_sourceWrapperDevice->readRects(readRects);
 
 
-    blendBrush({ &m_finalPainter },
+    prepareBlending({ &m_finalPainter },
         m_sourceWrapperDevice,
-        m_maskDab, m_shouldPreserveOriginalDab,
-        srcRect, dstRect,
+        mask.maskDab, mask.shouldPreserveDab,
+        srcRect, mask.dstRect,
+        stripes,
         currentPaintColor,
         opacity,
         smudgeRateValue,
@@ -166,10 +171,19 @@ KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dst
     const qreal overlayAdjustment =
         (m_thicknessMode == KisPaintThicknessOptionData::ThicknessMode::OVERWRITE) ?
         1.0 : KisAlgebra2D::lerp(overlaySmearRate, 1.0, paintThicknessValue);
-    const quint8 brushHeightmapOpacity = qRound(opacity * overlayAdjustment * 255.0);
-    m_heightmapPainter.setOpacity(brushHeightmapOpacity);
-    m_heightmapPainter.bltFixed(dstRect.topLeft(), m_origDab, m_origDab->bounds());
-    m_heightmapPainter.renderMirrorMaskSafe(dstRect, m_origDab, m_shouldPreserveOriginalDab);
+    m_currentHeightmapOpacity = qRound(opacity * overlayAdjustment * 255.0);
+}
+
+QVector<QRect> KisColorSmudgeStrategyLightness::finishDab()
+{
+    finishBlending();
+
+    const QRect dstRect = m_currentMask.dstRect;
+    const int numPixels = dstRect.width() * dstRect.height();
+
+    m_heightmapPainter.setOpacity(m_currentHeightmapOpacity);
+    m_heightmapPainter.bltFixed(dstRect.topLeft(), m_currentMask.origDab, m_currentMask.origDab->bounds());
+    m_heightmapPainter.renderMirrorMaskSafe(dstRect, m_currentMask.origDab, m_currentMask.shouldPreserveDab);
 
 
     KisFixedPaintDeviceSP tempColorDevice =
@@ -178,7 +192,7 @@ KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dst
     KisFixedPaintDeviceSP tempHeightmapDevice =
         new KisFixedPaintDevice(m_heightmapDevice->colorSpace(), m_memoryAllocator);
 
-    Q_FOREACH(const QRect& rc, mirroredRects) {
+    Q_FOREACH(const QRect& rc, m_mirroredRects) {
         tempColorDevice->setRect(rc);
         tempColorDevice->lazyGrowBufferWithoutInitialization();
 
@@ -195,7 +209,10 @@ KisColorSmudgeStrategyLightness::paintDab(const QRect &srcRect, const QRect &dst
         m_projectionDevice->writeBytes(tempColorDevice->data(), tempColorDevice->bounds());
     }
  
-    m_layerOverlayDevice->writeRects(mirroredRects);
+    m_layerOverlayDevice->writeRects(m_mirroredRects);
+
+    // release the dab devices
+    m_currentMask = DabMask();
 
-    return mirroredRects;
+    return m_mirroredRects;
 }
@@ -28,14 +28,19 @@ public:
                     const KisPaintInformation& info,
                     const KisDabShape &shape,
                     const QPointF &cursorPoint,
-                    QRect *dstDabRect, qreal lightnessStrength) override;
+                    DabMask *mask, qreal lightnessStrength) override;
+
+    void prepareDab(const DabMask &mask, const QVector<QRect> &stripes, const QRect &srcRect,
+                    const KoColor &currentPaintColor, qreal opacity,
+                    qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
+                    qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
+
+    QVector<QRect> finishDab() override;
 
-    QVector<QRect> paintDab(const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
-                            qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
-                            qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
 private:
-    KisFixedPaintDeviceSP m_maskDab;
-    KisFixedPaintDeviceSP m_origDab;
+    DabMask m_currentMask;
+    quint8 m_currentHeightmapOpacity {OPACITY_OPAQUE_U8};
+    QVector<QRect> m_mirroredRects;
     KisPaintDeviceSP m_heightmapDevice;
     KisPaintDeviceSP m_colorOnlyDevice;
     KisPaintDeviceSP m_projectionDevice;
@@ -43,7 +48,6 @@ private:
     KisColorSmudgeSourceSP m_sourceWrapperDevice;
     KisPainter m_finalPainter;
     KisPainter m_heightmapPainter;
-    bool m_shouldPreserveOriginalDab {true};
     DabColoringStrategyMask m_coloringStrategy;
     bool m_smearAlpha {true};
     KisPainter *m_initializationPainter {nullptr};
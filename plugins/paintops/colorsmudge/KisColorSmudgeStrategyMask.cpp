@@ -21,19 +21,20 @@ KisColorSmudgeStrategyBase::DabColoringStrategy &KisColorSmudgeStrategyMask::col
 }
 
 void KisColorSmudgeStrategyMask::updateMask(KisDabCache *dabCache, const KisPaintInformation &info, const KisDabShape &shape,
-                                       const QPointF &cursorPoint, QRect *dstDabRect, qreal lightnessStrength)
+                                       const QPointF &cursorPoint, DabMask *mask, qreal lightnessStrength)
 {
     static const KoColorSpace* cs = KoColorSpaceRegistry::instance()->alpha8();
     static KoColor color(Qt::black, cs);
 
-    m_maskDab = dabCache->fetchDab(cs,
-                                   color,
-                                   cursorPoint,
-                                   shape,
-                                   info,
-                                   1.0,
-                                   dstDabRect,
-                                   lightnessStrength);
+    mask->maskDab = dabCache->fetchDab(cs,
+                                       color,
+                                       cursorPoint,
+                                       shape,
+                                       info,
+                                       1.0,
+                                       &mask->dstRect,
+                                       lightnessStrength);
 
-    m_shouldPreserveMaskDab = !dabCache->needSeparateOriginal();
+    mask->maskDabIsCached = true;
+    mask->shouldPreserveDab = !dabCache->needSeparateOriginal();
 }
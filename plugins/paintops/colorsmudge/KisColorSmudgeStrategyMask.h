@@ -24,7 +24,7 @@ public:
                     const KisPaintInformation& info,
                     const KisDabShape &shape,
                     const QPointF &cursorPoint,
-                    QRect *dstDabRect, 
+                    DabMask *mask,
                     qreal lightnessStrength) override;
 
 private:
@@ -6,6 +6,8 @@
 
 #include "KisColorSmudgeStrategyStamp.h"
 
+#include <KoColorSpaceRegistry.h>
+
 #include "kis_fixed_paint_device.h"
 #include "kis_image.h"
 #include "KisOverlayPaintDeviceWrapper.h"
@@ -14,7 +16,7 @@
 KisColorSmudgeStrategyStamp::KisColorSmudgeStrategyStamp(KisPainter *painter, KisImageSP image, bool smearAlpha,
                                                          bool useDullingMode, bool useOverlayMode)
         : KisColorSmudgeStrategyWithOverlay(painter, image, smearAlpha, useDullingMode, useOverlayMode)
-        , m_origDab(new KisFixedPaintDevice(m_layerOverlayDevice->overlayColorSpace())) // TODO: check compositionSourceColorSpace!
+        , m_dabColorSpace(m_layerOverlayDevice->overlayColorSpace()) // TODO: check compositionSourceColorSpace!
 {
 }
 
@@ -24,27 +26,48 @@ KisColorSmudgeStrategyBase::DabColoringStrategy &KisColorSmudgeStrategyStamp::co
 }
 
 void KisColorSmudgeStrategyStamp::updateMask(KisDabCache *dabCache, const KisPaintInformation &info,
-                                             const KisDabShape &shape, const QPointF &cursorPoint, QRect *dstDabRect, qreal lightnessStrength)
+                                             const KisDabShape &shape, const QPointF &cursorPoint, DabMask *mask, qreal lightnessStrength)
 {
 
-    static KoColor color(Qt::black, m_origDab->colorSpace());
+    static KoColor color(Qt::black, m_dabColorSpace);
+
+    mask->origDab = dabCache->fetchDab(m_dabColorSpace,
+                                       color,
+                                       cursorPoint,
+                                       shape,
+                                       info,
+                                       1.0,
+                                       &mask->dstRect,
+                                       lightnessStrength);
+
+    mask->origDabIsCached = true;
 
-    m_origDab = dabCache->fetchDab(m_origDab->colorSpace(),
-                                   color,
-                                   cursorPoint,
-                                   shape,
-                                   info,
-                                   1.0,
-                                   dstDabRect,
-                                   lightnessStrength);
+    const int numPixels = mask->origDab->bounds().width() * mask->origDab->bounds().height();
 
-    m_coloringStrategy.setStampDab(m_origDab);
+    if (!mask->maskDab) {
+        mask->maskDab = new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+    }
 
-    const int numPixels = m_origDab->bounds().width() * m_origDab->bounds().height();
+    mask->maskDab->setRect(mask->origDab->bounds());
+    mask->maskDab->lazyGrowBufferWithoutInitialization();
+    mask->origDab->colorSpace()->copyOpacityU8(mask->origDab->data(), mask->maskDab->data(), numPixels);
 
-    m_maskDab->setRect(m_origDab->bounds());
-    m_maskDab->lazyGrowBufferWithoutInitialization();
-    m_origDab->colorSpace()->copyOpacityU8(m_origDab->data(), m_maskDab->data(), numPixels);
+    mask->maskDabIsCached = false;
+    mask->shouldPreserveDab = false;
+}
+
+void KisColorSmudgeStrategyStamp::prepareDab(const DabMask &mask, const QVector<QRect> &stripes,
+                                             const QRect &srcRect,
+                                             const KoColor &currentPaintColor, qreal opacity,
+                                             qreal colorRateValue, qreal smudgeRateValue,
+                                             qreal maxPossibleSmudgeRateValue,
+                                             qreal lightnessStrengthValue, qreal smudgeRadiusValue)
+{
+    m_coloringStrategy.setStampDab(mask.origDab);
 
-    m_shouldPreserveMaskDab = false;
+    KisColorSmudgeStrategyWithOverlay::prepareDab(mask, stripes, srcRect,
+                                                  currentPaintColor, opacity,
+                                                  colorRateValue, smudgeRateValue,
+                                                  maxPossibleSmudgeRateValue,
+                                                  lightnessStrengthValue, smudgeRadiusValue);
 }
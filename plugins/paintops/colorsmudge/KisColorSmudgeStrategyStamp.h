@@ -23,11 +23,16 @@ struct KisColorSmudgeStrategyStamp : public KisColorSmudgeStrategyWithOverlay
                     const KisPaintInformation& info,
                     const KisDabShape &shape,
                     const QPointF &cursorPoint,
-                    QRect *dstDabRect,
+                    DabMask *mask,
                     qreal lightnessStrength) override;
 
+    void prepareDab(const DabMask &mask, const QVector<QRect> &stripes, const QRect &srcRect,
+                    const KoColor &currentPaintColor, qreal opacity,
+                    qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
+                    qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
+
 private:
-    KisFixedPaintDeviceSP m_origDab;
+    const KoColorSpace *m_dabColorSpace {nullptr};
     DabColoringStrategyStamp m_coloringStrategy;
 };
 
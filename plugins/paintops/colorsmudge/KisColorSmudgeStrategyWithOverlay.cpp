@@ -19,7 +19,6 @@ KisColorSmudgeStrategyWithOverlay::KisColorSmudgeStrategyWithOverlay(KisPainter
                                                                      bool smearAlpha, bool useDullingMode,
                                                                      bool useOverlayMode)
         : KisColorSmudgeStrategyBase(useDullingMode)
-        , m_maskDab(new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8()))
         , m_smearAlpha(smearAlpha)
         , m_initializationPainter(painter)
 {
@@ -69,18 +68,19 @@ QVector<KisPainter *> KisColorSmudgeStrategyWithOverlay::finalPainters()
     return result;
 }
 
-QVector<QRect> KisColorSmudgeStrategyWithOverlay::paintDab(const QRect &srcRect, const QRect &dstRect,
-                                                           const KoColor &currentPaintColor, qreal opacity,
-                                                           qreal colorRateValue, qreal smudgeRateValue,
-                                                           qreal maxPossibleSmudgeRateValue,
-                                                           qreal lightnessStrengthValue, qreal smudgeRadiusValue)
+void KisColorSmudgeStrategyWithOverlay::prepareDab(const DabMask &mask, const QVector<QRect> &stripes,
+                                                   const QRect &srcRect,
+                                                   const KoColor &currentPaintColor, qreal opacity,
+                                                   qreal colorRateValue, qreal smudgeRateValue,
+                                                   qreal maxPossibleSmudgeRateValue,
+                                                   qreal lightnessStrengthValue, qreal smudgeRadiusValue)
 {
     Q_UNUSED(lightnessStrengthValue);
 
-    const QVector<QRect> mirroredRects = m_finalPainter.calculateAllMirroredRects(dstRect);
+    m_mirroredRects = m_finalPainter.calculateAllMirroredRects(mask.dstRect);
 
     QVector<QRect> readRects;
-    readRects << mirroredRects;
+    readRects << m_mirroredRects;
     readRects << srcRect;
 
     m_sourceWrapperDevice->readRects(readRects);
@@ -93,17 +93,23 @@ QVector<QRect> KisColorSmudgeStrategyWithOverlay::paintDab(const QRect &srcRect,
         m_layerOverlayDevice->readRects(readRects);
     }
 
-    blendBrush(finalPainters(),
-               m_sourceWrapperDevice,
-               m_maskDab, m_shouldPreserveMaskDab,
-               srcRect, dstRect,
-               currentPaintColor,
-               opacity,
-               smudgeRateValue,
-               maxPossibleSmudgeRateValue,
-               colorRateValue, smudgeRadiusValue);
+    prepareBlending(finalPainters(),
+                    m_sourceWrapperDevice,
+                    mask.maskDab, mask.shouldPreserveDab,
+                    srcRect, mask.dstRect,
+                    stripes,
+                    currentPaintColor,
+                    opacity,
+                    smudgeRateValue,
+                    maxPossibleSmudgeRateValue,
+                    colorRateValue, smudgeRadiusValue);
+}
+
+QVector<QRect> KisColorSmudgeStrategyWithOverlay::finishDab()
+{
+    finishBlending();
 
-    m_layerOverlayDevice->writeRects(mirroredRects);
+    m_layerOverlayDevice->writeRects(m_mirroredRects);
 
-    return mirroredRects;
+    return m_mirroredRects;
 }
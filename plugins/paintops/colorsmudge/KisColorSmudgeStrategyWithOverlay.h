@@ -26,13 +26,14 @@ public:
 
     QVector<KisPainter*> finalPainters();
 
-    QVector<QRect> paintDab(const QRect &srcRect, const QRect &dstRect, const KoColor &currentPaintColor, qreal opacity,
-                            qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
-                            qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
+    void prepareDab(const DabMask &mask, const QVector<QRect> &stripes, const QRect &srcRect,
+                    const KoColor &currentPaintColor, qreal opacity,
+                    qreal colorRateValue, qreal smudgeRateValue, qreal maxPossibleSmudgeRateValue,
+                    qreal lightnessStrengthValue, qreal smudgeRadiusValue) override;
+
+    QVector<QRect> finishDab() override;
 
 protected:
-    KisFixedPaintDeviceSP m_maskDab;
-    bool m_shouldPreserveMaskDab = true;
     QScopedPointer<KisOverlayPaintDeviceWrapper> m_layerOverlayDevice;
 
 private:
@@ -42,6 +43,7 @@ private:
     QScopedPointer<KisPainter> m_overlayPainter;
     bool m_smearAlpha = true;
     KisPainter *m_initializationPainter = 0;
+    QVector<QRect> m_mirroredRects;
 };
 
 
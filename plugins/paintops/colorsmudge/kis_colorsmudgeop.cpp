@@ -17,6 +17,12 @@
 #include <kis_lod_transform.h>
 #include <kis_spacing_information.h>
 #include "kis_paintop_plugin_utils.h"
+#include "kis_image_config.h"
+
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisFakeRunnableStrokeJobsExecutor.h>
+#include <kis_pointer_utils.h>
 
 #include "KisInterstrokeData.h"
 #include "KisInterstrokeDataFactory.h"
@@ -64,6 +70,21 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
     Q_UNUSED(node);
     Q_ASSERT(painter);
 
+    KisImageConfig cfg(true);
+    m_idealNumStripes = cfg.maxNumberOfThreads();
+
+    // the queued dabs are rendered as often as the canvas is updated
+    m_updatePeriod = 1000 / cfg.fpsLimit();
+
+    /**
+     * A painter that is not a part of a stroke runs its jobs right away,
+     * there is no point in queueing the dabs then. Moreover, nobody would
+     * call doAsynchronousUpdate() for it.
+     */
+    m_useAsynchronousRendering =
+        settings->needsAsynchronousUpdates() &&
+        !dynamic_cast<KisFakeRunnableStrokeJobsExecutor*>(painter->runnableStrokeJobsInterface());
+
     m_airbrushData.read(settings.data());
     m_overlayModeData.read(settings.data());
 
@@ -179,7 +200,17 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
 
 
     const qreal paintThickness = m_paintThicknessOption.apply(info);
-    m_strategy->updateMask(m_dabCache, info, shape, scatteredPos, &m_dstDabRect, paintThickness);
+
+    /**
+     * The queued dabs own their masks, the synchronous rendering
+     * reuses the same one
+     */
+    KisColorSmudgeStrategy::DabMask queuedDabMask;
+    KisColorSmudgeStrategy::DabMask &dabMask =
+        m_useAsynchronousRendering ? queuedDabMask : m_dabMask;
+
+    m_strategy->updateMask(m_dabCache, info, shape, scatteredPos, &dabMask, paintThickness);
+    m_dstDabRect = dabMask.dstRect;
 
     QPointF newCenterPos = QRectF(m_dstDabRect).center();
     /**
@@ -213,8 +244,28 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
         m_hsvTransform->transform(paintColor.data(), paintColor.data(), 1);
     }
 
+    if (m_useAsynchronousRendering) {
+        DabRequest request;
+        request.mask = dabMask;
+        request.mask.detachFromDabCache();
+        request.srcRect = srcDabRect;
+        request.paintColor = paintColor;
+        request.opacity = fpOpacity;
+        request.colorRate = colorRate;
+        request.smudgeRate = smudgeRate;
+        request.maxSmudgeRate = maxSmudgeRate;
+        request.paintThickness = paintThickness;
+        request.smudgeRadius = smudgeRadiusPortion;
+
+        QMutexLocker l(&m_dabQueueMutex);
+        m_dabQueue.append(request);
+
+        return spacingInfo;
+    }
+
     const QVector<QRect> dirtyRects =
-            m_strategy->paintDab(srcDabRect, m_dstDabRect,
+            m_strategy->paintDab(m_dabMask,
+                                 srcDabRect,
                                  paintColor,
                                  fpOpacity, colorRate,
                                  smudgeRate,
@@ -227,6 +278,145 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
     return spacingInfo;
 }
 
+struct KisColorSmudgeOp::UpdateSharedState
+{
+    QVector<DabRequest> dabsQueue;
+    QVector<QVector<QRect>> dabStripes;
+
+    QVector<QRect> allDirtyRects;
+};
+
+std::pair<int, bool> KisColorSmudgeOp::doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    if (!m_useAsynchronousRendering) {
+        return KisBrushBasedPaintOp::doAsynchronousUpdate(jobs);
+    }
+
+    bool someDabsAreStillInQueue = false;
+
+    QMutexLocker l(&m_dabQueueMutex);
+
+    /**
+     * The jobs of the next update are put in front of the jobs of the
+     * previous one, so the dabs could be painted in a wrong order if
+     * we started a new update before the previous one has finished.
+     */
+    if (!m_updateSharedState && !m_dabQueue.isEmpty()) {
+        m_updateSharedState = toQShared(new UpdateSharedState());
+        UpdateSharedStateSP state = m_updateSharedState;
+
+        state->dabsQueue.swap(m_dabQueue);
+        l.unlock();
+
+        Q_FOREACH (const DabRequest &request, state->dabsQueue) {
+            state->dabStripes.append(
+                KisColorSmudgeStrategy::splitDabIntoStripes(request.mask.dstRect, m_idealNumStripes));
+        }
+
+        for (int i = 0; i < state->dabsQueue.size();) {
+            if (state->dabStripes[i].size() > 1) {
+                addDabJobs(i, state, jobs);
+                i++;
+                continue;
+            }
+
+            // small dabs are not worth splitting, a series of them is painted in one job
+            const int firstDab = i;
+            while (i < state->dabsQueue.size() && state->dabStripes[i].size() <= 1) {
+                i++;
+            }
+            const int lastDab = i;
+
+            KritaUtils::addJobSequential(jobs,
+                [state, firstDab, lastDab, this] () {
+                    for (int dab = firstDab; dab < lastDab; dab++) {
+                        const DabRequest &request = state->dabsQueue[dab];
+
+                        state->allDirtyRects +=
+                            m_strategy->paintDab(request.mask,
+                                                 request.srcRect,
+                                                 request.paintColor,
+                                                 request.opacity, request.colorRate,
+                                                 request.smudgeRate,
+                                                 request.maxSmudgeRate,
+                                                 request.paintThickness,
+                                                 request.smudgeRadius);
+                    }
+                }
+            );
+        }
+
+        KritaUtils::addJobSequential(jobs,
+            [state, this] () {
+                painter()->addDirtyRects(state->allDirtyRects);
+
+                // release all the dab devices
+                state->dabsQueue.clear();
+
+                QMutexLocker l(&m_dabQueueMutex);
+                m_updateSharedState.clear();
+            }
+        );
+
+    } else if (m_updateSharedState && !m_dabQueue.isEmpty()) {
+        someDabsAreStillInQueue = true;
+    }
+
+    return std::make_pair(m_updatePeriod, someDabsAreStillInQueue);
+}
+
+void KisColorSmudgeOp::addDabJobs(int dabIndex, UpdateSharedStateSP state,
+                                  QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    const int numStripes = state->dabStripes[dabIndex].size();
+
+    /**
+     * Every dab reads the data written by the previous one, so
+     * the dabs are processed one by one and only the stripes of
+     * a single dab are processed concurrently.
+     */
+    KritaUtils::addJobSequential(jobs,
+        [state, dabIndex, this] () {
+            const DabRequest &request = state->dabsQueue[dabIndex];
+
+            m_strategy->prepareDab(request.mask,
+                                   state->dabStripes[dabIndex],
+                                   request.srcRect,
+                                   request.paintColor,
+                                   request.opacity, request.colorRate,
+                                   request.smudgeRate,
+                                   request.maxSmudgeRate,
+                                   request.paintThickness,
+                                   request.smudgeRadius);
+        }
+    );
+
+    for (int i = 0; i < numStripes; i++) {
+        KritaUtils::addJobConcurrent(jobs,
+            [i, this] () {
+                m_strategy->blendDabStripe(i);
+            }
+        );
+    }
+
+    // the stripes may read the area that the other stripes are going to write to
+    KritaUtils::addJobSequential(jobs, nullptr);
+
+    for (int i = 0; i < numStripes; i++) {
+        KritaUtils::addJobConcurrent(jobs,
+            [i, this] () {
+                m_strategy->writeDabStripe(i);
+            }
+        );
+    }
+
+    KritaUtils::addJobSequential(jobs,
+        [state, this] () {
+            state->allDirtyRects += m_strategy->finishDab();
+        }
+    );
+}
+
 KisSpacingInformation KisColorSmudgeOp::updateSpacingImpl(const KisPaintInformation &info) const
 {
     const qreal scale = m_sizeOption.apply(info) * KisLodTransform::lodToScale(painter()->device());
@@ -7,9 +7,11 @@
 #ifndef _KIS_COLORSMUDGEOP_H_
 #define _KIS_COLORSMUDGEOP_H_
 
+#include <QMutex>
 #include <QRect>
 
 #include "KoColorTransformation.h"
+#include <KoColor.h>
 #include <KoAbstractGradient.h>
 
 #include <kis_brush_based_paintop.h>
@@ -29,6 +31,8 @@
 #include <KisSmudgeRadiusOption.h>
 #include <KisSmudgeOverlayModeOptionData.h>
 
+#include "KisColorSmudgeStrategy.h"
+
 class QPointF;
 
 class KisBrushBasedPaintOpSettings;
@@ -36,8 +40,6 @@ class KisPainter;
 class KoColorSpace;
 class KisInterstrokeDataFactory;
 
-class KisColorSmudgeStrategy;
-
 class KisColorSmudgeOp: public KisBrushBasedPaintOp
 {
 public:
@@ -46,12 +48,34 @@ public:
 
     static KisInterstrokeDataFactory* createInterstrokeDataFactory(const KisPaintOpSettingsSP settings, KisResourcesInterfaceSP resourcesInterface);
 
+    std::pair<int, bool> doAsynchronousUpdate(QVector<KisRunnableStrokeJobData *> &jobs) override;
+
 protected:
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
 
     KisSpacingInformation updateSpacingImpl(const KisPaintInformation &info) const override;
     KisTimingInformation updateTimingImpl(const KisPaintInformation &info) const override;
 
+private:
+    struct DabRequest
+    {
+        KisColorSmudgeStrategy::DabMask mask;
+        QRect srcRect;
+        KoColor paintColor;
+        qreal opacity {1.0};
+        qreal colorRate {0.0};
+        qreal smudgeRate {1.0};
+        qreal maxSmudgeRate {1.0};
+        qreal paintThickness {1.0};
+        qreal smudgeRadius {0.0};
+    };
+
+    struct UpdateSharedState;
+    typedef QSharedPointer<UpdateSharedState> UpdateSharedStateSP;
+
+    void addDabJobs(int dabIndex, UpdateSharedStateSP state,
+                    QVector<KisRunnableStrokeJobData*> &jobs);
+
 private:
     bool                      m_firstRun;
 
@@ -79,6 +103,18 @@ private:
 
     KoColorTransformation *m_hsvTransform {0};
     QScopedPointer<KisColorSmudgeStrategy> m_strategy;
+    KisColorSmudgeStrategy::DabMask m_dabMask;
+
+    /**
+     * When painting in a stroke, the dabs are only generated in paintAt()
+     * and queued, they are rendered in the jobs of doAsynchronousUpdate()
+     */
+    bool m_useAsynchronousRendering {false};
+    QMutex m_dabQueueMutex;
+    QVector<DabRequest> m_dabQueue;
+    UpdateSharedStateSP m_updateSharedState;
+    int m_idealNumStripes {1};
+    int m_updatePeriod {10};
 };
 
 #endif // _KIS_COLORSMUDGEOP_H_
@@ -21,6 +21,11 @@ KisColorSmudgeOpSettings::~KisColorSmudgeOpSettings()
 {
 }
 
+bool KisColorSmudgeOpSettings::needsAsynchronousUpdates() const
+{
+    return true;
+}
+
 #include <brushengine/kis_slider_based_paintop_property.h>
 #include <brushengine/kis_combo_based_paintop_property.h>
 #include "kis_paintop_preset.h"
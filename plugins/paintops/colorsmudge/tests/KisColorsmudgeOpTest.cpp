@@ -15,6 +15,11 @@
 #include <brushengine/kis_paintop_preset.h>
 #include <brushengine/kis_paintop_settings.h>
 #include <KoCanvasResourcesIds.h>
+#include <KisThreadPoolRunnableStrokeJobsExecutor.h>
+#include <KisRunnableStrokeJobData.h>
+#include <testutil.h>
+
+#include <tuple>
 
 class TestColorsmudgeOp : public TestUtil::QImageBasedTest
 {
@@ -82,6 +87,65 @@ public:
         checkOneLayer(image, targetNode, testPrefix);
     }
 
+    /**
+     * Paints the test strokes with the brush of \p brushSize. If \p jobsInterface
+     * is not null, the dabs are queued by the paintop and rendered in the jobs of
+     * doAsynchronousUpdate(), like in a freehand stroke.
+     */
+    KisPaintDeviceSP paintStrokes(const QString &presetFileName, qreal brushSize,
+                                  KisRunnableStrokeJobsInterface *jobsInterface,
+                                  bool *usedAsynchronousRendering) {
+        KisSurrogateUndoStore *undoStore = new KisSurrogateUndoStore();
+        KisImageSP image = createTrivialImage(undoStore);
+        image->initialRefreshGraph();
+        image->resizeImage(QRect(0,0,200,200));
+        image->waitForDone();
+
+        KisNodeSP paint1 = findNode(image->root(), "paint1");
+        paint1->paintDevice()->fill(QRect(80, 5, 50, 190), KoColor(Qt::red, image->colorSpace()));
+
+        KisPainter gc(paint1->paintDevice());
+        gc.setRunnableStrokeJobsInterface(jobsInterface);
+
+        QScopedPointer<KoCanvasResourceProvider> manager(
+            utils::createResourceManager(image, 0, presetFileName));
+
+        manager->setResource(KoCanvasResource::ForegroundColor, KoColor(Qt::green, image->colorSpace()));
+
+        KisPaintOpPresetSP preset =
+            manager->resource(KoCanvasResource::CurrentPaintOpPreset).value<KisPaintOpPresetSP>();
+        preset->settings()->setPaintOpSize(brushSize);
+
+        KisResourcesSnapshotSP resources =
+            new KisResourcesSnapshot(image,
+                                     paint1,
+                                     manager.data());
+
+        resources->setupPainter(&gc);
+
+        doPaint(gc);
+
+        *usedAsynchronousRendering = false;
+
+        if (jobsInterface) {
+            for (int i = 0; i < 1000; i++) {
+                QVector<KisRunnableStrokeJobData*> jobs;
+                bool needsMoreUpdates = false;
+
+                std::tie(std::ignore, needsMoreUpdates) = gc.paintOp()->doAsynchronousUpdate(jobs);
+
+                const bool hasJobs = !jobs.isEmpty();
+                *usedAsynchronousRendering |= hasJobs;
+
+                jobsInterface->addRunnableJobs(jobs);
+
+                if (!hasJobs && !needsMoreUpdates) break;
+            }
+        }
+
+        return paint1->paintDevice();
+    }
+
     void doPaint(KisPainter &gc) {
 
         const QVector<qreal> pressureLevels = {1.0, 0.8, 0.5};
@@ -150,4 +214,42 @@ void KisColorsmudgeOpTest::test()
     t.test(testName, preset, overlay);
 }
 
+void KisColorsmudgeOpTest::testAsynchronousRendering_data()
+{
+    QTest::addColumn<QString>("preset");
+    QTest::addColumn<qreal>("brushSize");
+
+    // the small dabs are batched into one job, the big ones are split into stripes
+    QTest::newRow("dul-small") << "test_smudge_20px_dul_sa_new.0001.kpp" << 20.0;
+    QTest::newRow("dul-big") << "test_smudge_20px_dul_sa_new.0001.kpp" << 150.0;
+    QTest::newRow("sme-small") << "test_smudge_20px_sme_nsa_new.0001.kpp" << 20.0;
+    QTest::newRow("sme-big") << "test_smudge_20px_sme_nsa_new.0001.kpp" << 150.0;
+}
+
+void KisColorsmudgeOpTest::testAsynchronousRendering()
+{
+    QFETCH(QString, preset);
+    QFETCH(qreal, brushSize);
+
+    TestColorsmudgeOp t;
+
+    bool usedAsynchronousRendering = false;
+
+    KisPaintDeviceSP synchronousResult =
+        t.paintStrokes(preset, brushSize, 0, &usedAsynchronousRendering);
+    QVERIFY(!usedAsynchronousRendering);
+
+    KisThreadPoolRunnableStrokeJobsExecutor executor;
+    KisPaintDeviceSP asynchronousResult =
+        t.paintStrokes(preset, brushSize, &executor, &usedAsynchronousRendering);
+    QVERIFY(usedAsynchronousRendering);
+
+    const QRect rc(0, 0, 200, 200);
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt,
+                                     synchronousResult->convertToQImage(0, rc),
+                                     asynchronousResult->convertToQImage(0, rc),
+                                     1, 1));
+}
+
 KISTEST_MAIN(KisColorsmudgeOpTest)
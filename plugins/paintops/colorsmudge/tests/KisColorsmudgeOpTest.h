@@ -16,6 +16,9 @@ private Q_SLOTS:
 
     void test();
     void test_data();
+
+    void testAsynchronousRendering();
+    void testAsynchronousRendering_data();
 };
 
 #endif // KISCOLORSMUDGEOPTEST_H
@@ -6,53 +6,38 @@
 
 #include "bristle.h"
 
-Bristle::Bristle(float x, float y, float length)
-    : m_x(x)
-    , m_y(y)
-    , m_prevX(x)
-    , m_prevY(y)
-    , m_length(length)
-{}
+#include <cstring>
 
-Bristle::~Bristle()
+void Bristles::reset(int pixelSize)
 {
+    m_pixelSize = pixelSize;
+
+    x.clear();
+    y.clear();
+    prevX.clear();
+    prevY.clear();
+    length.clear();
+    inkAmount.clear();
+    counter.clear();
+    colors.clear();
 }
 
-void Bristle::setLength(float length)
+void Bristles::append(float x, float y, float length, const quint8 *color)
 {
-    m_length = length;
+    this->x.append(x);
+    this->y.append(y);
+    prevX.append(x);
+    prevY.append(y);
+    this->length.append(length);
+    inkAmount.append(0.0f);
+    counter.append(0);
+
+    const int offset = colors.size();
+    colors.resize(offset + m_pixelSize);
+    memcpy(colors.data() + offset, color, m_pixelSize);
 }
 
-
-void Bristle::addInk(float value)
-{
-    m_inkAmount = m_inkAmount + value;
-}
-
-void Bristle::removeInk(float value)
-{
-    m_inkAmount = m_inkAmount - value;
-}
-
-void Bristle::setInkAmount(float inkAmount)
-{
-    if (inkAmount > 1.0f) {
-        inkAmount = 1.0f;
-    }
-    else if (inkAmount < -1.0f) {
-        inkAmount = -1.0f;
-    }
-
-    m_inkAmount = inkAmount;
-}
-
-void Bristle::setColor(const KoColor &color)
-{
-    m_color = color;
-}
-
-
-void Bristle::setEnabled(bool enabled)
+void Bristles::setColor(int i, const quint8 *color)
 {
-    m_enabled = enabled;
+    memcpy(colors.data() + i * m_pixelSize, color, m_pixelSize);
 }
@@ -7,101 +7,54 @@
 #ifndef _BRISTLE_H_
 #define _BRISTLE_H_
 
-#include <cmath>
-#include <KoColor.h>
-
-class Bristle
+#include <QVector>
+
+/**
+ * The state of all the bristles of the brush, stored as a structure
+ * of arrays. Every segment of the stroke updates all the bristles at
+ * once, so keeping each property in its own contiguous array lets
+ * the per-segment loops run over plain float arrays instead of
+ * chasing a heap object per bristle.
+ */
+class Bristles
 {
-
 public:
-    Bristle() = default;
-    Bristle(float x, float y, float length);
-    ~Bristle();
-
-    inline float x() const {
-        return m_x;
-    }
+    /// resets the bristles, the colors of the bristles have \p pixelSize bytes
+    void reset(int pixelSize);
 
-    inline float y() const {
-        return m_y;
-    }
+    void append(float x, float y, float length, const quint8 *color);
 
-    inline float prevX() const {
-        return m_prevX;
+    inline int size() const {
+        return x.size();
     }
 
-    inline float prevY() const {
-        return m_prevY;
+    inline const quint8* color(int i) const {
+        return colors.constData() + i * m_pixelSize;
     }
 
-    inline float length() const {
-        return m_length;
-    }
+    void setColor(int i, const quint8 *color);
 
-    inline  const KoColor &color() const {
-        return m_color;
+    inline void setInkAmount(int i, float value) {
+        inkAmount[i] = qBound(-1.0f, value, 1.0f);
     }
 
-    inline int counter() const {
-        return m_counter;
-    }
-
-    inline void upIncrement() {
-        m_counter++;
-    }
-
-    inline float inkAmount() const {
-        return m_inkAmount;
-    };
-
-    inline float distanceCenter() {
-        return std::sqrt(m_x * m_x + m_y * m_y);
-    }
-
-    inline void setX(float x) {
-        m_x = x;
-    }
-    inline void setY(float y) {
-        m_y = y;
-    }
-
-    inline void setPrevX(float prevX) {
-        m_prevX = prevX;
-    }
-
-    inline void setPrevY(float prevY) {
-        m_prevY = prevY;
-    }
-
-    inline bool enabled() const {
-        return m_enabled;
-    }
-
-    void setLength(float length);
-    void setColor(const KoColor &color);
+public:
+    // coordinates of bristles
+    QVector<float> x;
+    QVector<float> y;
+    QVector<float> prevX;
+    QVector<float> prevY;
+    QVector<float> length; // z - coordinate
+    QVector<float> inkAmount;
 
-    void addInk(float value);
-    void removeInk(float value);
-    void setInkAmount(float inkAmount);
-    void setEnabled(bool enabled);
+    // new dimension in bristle
+    QVector<int> counter;
 
+    /// the colors of the bristles, \see color()
+    QVector<quint8> colors;
 
 private:
-    void init(float x, float y, float length);
-
-    // coordinates of bristle
-    float m_x{0.0f};
-    float m_y{0.0f};
-    float m_prevX{0.0f};
-    float m_prevY{0.0f};
-    float m_length{0.0f}; // z - coordinate
-    KoColor m_color;
-    float m_inkAmount{0.0f};
-
-    // new dimension in bristle
-    int m_counter{0};
-
-    bool m_enabled{true};
+    int m_pixelSize {0};
 };
 
 #endif
@@ -21,9 +21,19 @@
 #include <kis_fixed_paint_device.h>
 
 
+#include <algorithm>
 #include <cmath>
 #include <ctime>
 
+namespace {
+
+/**
+ * The pixel writes of a segment are grouped by the blocks
+ * of the size of the tiles of the paint device
+ */
+const int pixelWriteBlockShift = 6;
+
+}
 
 HairyBrush::HairyBrush()
 {
@@ -37,8 +47,6 @@ HairyBrush::HairyBrush()
 HairyBrush::~HairyBrush()
 {
     delete m_transfo;
-    qDeleteAll(m_bristles.begin(), m_bristles.end());
-    m_bristles.clear();
 }
 
 
@@ -64,27 +72,23 @@ void HairyBrush::fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density)
     int centerY = height * 0.5;
 
     // make mask
-    Bristle * bristle = nullptr;
     qreal alpha;
 
     quint8 * dabPointer = dab->data();
     quint8 pixelSize = dab->pixelSize();
     const KoColorSpace * cs = dab->colorSpace();
-    KoColor bristleColor(cs);
 
     KisRandomSource randomSource(0);
 
+    m_bristles.reset(pixelSize);
+
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
             alpha =  cs->opacityF(dabPointer);
             if (alpha != 0.0) {
                 if (density == 1.0 || randomSource.generateNormalized() <= density) {
-                    memcpy(bristleColor.data(), dabPointer, pixelSize);
-
-                    bristle = new Bristle(x - centerX, y - centerY, alpha); // using value from image as length of bristle
-                    bristle->setColor(bristleColor);
-
-                    m_bristles.append(bristle);
+                    // using value from image as length of bristle
+                    m_bristles.append(x - centerX, y - centerY, alpha, dabPointer);
                 }
             }
             dabPointer += pixelSize;
@@ -120,7 +124,6 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
     // this pressure controls shear and ink depletion
     qreal pressure = mousePressure * (pi2.pressure() * 2);
 
-    Bristle *bristle = 0;
     KoColor bristleColor(dab->colorSpace());
 
     m_dabAccessor = dab->createRandomAccessorNG();
@@ -144,11 +147,7 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
         }
     }
 
-    KisRandomSourceSP randomSource = pi2.randomSource();
-
-    qreal fx1, fy1, fx2, fy2;
-    qreal randomX, randomY;
-    qreal shear;
+    transformBristles(pi2, angle, scale, pressure);
 
     float inkDepletion = 0.0;
     int inkDepletionSize = m_properties->inkDepletionCurve.size();
@@ -156,47 +155,14 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
     int bristlePathSize;
     qreal threshold = 1.0 - pi2.pressure();
     for (int i = 0; i < bristleCount; i++) {
-
-        if (!m_bristles.at(i)->enabled()) continue;
-        bristle = m_bristles[i];
-
-        randomX = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
-        randomY = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
-
-        shear = pressure * m_properties->shearFactor;
-
-        m_transform.reset();
-        m_transform.rotateRadians(-angle);
-        m_transform.scale(scale, scale);
-        m_transform.translate(randomX, randomY);
-        m_transform.shear(shear, shear);
-
-        if (firstStroke() || (!m_properties->connectedPath)) {
-            // transform start dab
-            m_transform.map(bristle->x(), bristle->y(), &fx1, &fy1);
-            // transform end dab
-            m_transform.map(bristle->x(), bristle->y(), &fx2, &fy2);
-        }
-        else {
-            // continue the path of the bristle from the previous position
-            fx1 = bristle->prevX();
-            fy1 = bristle->prevY();
-            m_transform.map(bristle->x(), bristle->y(), &fx2, &fy2);
-        }
-        // remember the end point
-        bristle->setPrevX(fx2);
-        bristle->setPrevY(fy2);
+        if (m_properties->threshold && (m_bristles.length[i] < threshold)) continue;
 
         // all coords relative to device position
-        fx1 += x1;
-        fy1 += y1;
-
-        fx2 += x2;
-        fy2 += y2;
+        const QPointF start(m_startX[i] + x1, m_startY[i] + y1);
+        const QPointF end(m_endX[i] + x2, m_endY[i] + y2);
 
-        if (m_properties->threshold && (bristle->length() < threshold)) continue;
         // paint between first and last dab
-        const QVector<QPointF> bristlePath = m_trajectory.getLinearTrajectory(QPointF(fx1, fy1), QPointF(fx2, fy2), 1.0);
+        const QVector<QPointF> &bristlePath = m_trajectory.getLinearTrajectory(start, end, 1.0);
         bristlePathSize = m_trajectory.size();
 
         // avoid overlapping bristle caps with antialias on
@@ -204,65 +170,131 @@ void HairyBrush::paintLine(KisPaintDeviceSP dab, KisPaintDeviceSP layer, const K
             bristlePathSize -= 1;
         }
 
-        memcpy(bristleColor.data(), bristle->color().data() , m_pixelSize);
-        for (int i = 0; i < bristlePathSize ; i++) {
+        memcpy(bristleColor.data(), m_bristles.color(i), m_pixelSize);
+        for (int j = 0; j < bristlePathSize ; j++) {
 
             if (m_properties->inkDepletionEnabled) {
-                inkDepletion = fetchInkDepletion(bristle, inkDepletionSize);
+                inkDepletion = fetchInkDepletion(i, inkDepletionSize);
 
                 if (m_properties->useSaturation && m_transfo != 0) {
-                    saturationDepletion(bristle, bristleColor, pressure, inkDepletion);
+                    saturationDepletion(i, bristleColor, pressure, inkDepletion);
                 }
 
                 if (m_properties->useOpacity) {
-                    opacityDepletion(bristle, bristleColor, pressure, inkDepletion);
+                    opacityDepletion(i, bristleColor, pressure, inkDepletion);
                 }
 
             }
             else {
                 if (bristleColor.opacityU8() != 0) {
-                    bristleColor.setOpacity(bristle->length());
+                    bristleColor.setOpacity(m_bristles.length[i]);
                 }
             }
 
-            addBristleInk(bristle, bristlePath.at(i), bristleColor);
-            bristle->setInkAmount(1.0 - inkDepletion);
-            bristle->upIncrement();
+            addBristleInk(bristlePath.at(j), bristleColor);
+            m_bristles.setInkAmount(i, 1.0 - inkDepletion);
+            m_bristles.counter[i]++;
         }
-
     }
+
+    flushPixelWrites(m_properties->useCompositing ? CompositeWrite :
+                     m_properties->antialias ? AddOpacityWrite :
+                     DarkenWrite);
+
     m_dab = nullptr;
     m_dabAccessor = nullptr;
 }
 
+void HairyBrush::transformBristles(const KisPaintInformation &pi2, qreal angle, qreal scale, qreal pressure)
+{
+    const int bristleCount = m_bristles.size();
+
+    m_randomX.resize(bristleCount);
+    m_randomY.resize(bristleCount);
+    m_startX.resize(bristleCount);
+    m_startY.resize(bristleCount);
+    m_endX.resize(bristleCount);
+    m_endY.resize(bristleCount);
+
+    // the random source is sequential, so the offsets are generated beforehand
+    KisRandomSourceSP randomSource = pi2.randomSource();
+
+    for (int i = 0; i < bristleCount; i++) {
+        m_randomX[i] = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
+        m_randomY[i] = (randomSource->generateNormalized() * 2 - 1.0) * m_properties->randomFactor;
+    }
+
+    /**
+     * The transform of a bristle is rotate(-angle) * scale(scale) *
+     * translate(random) * shear(shear), i.e. the shear is applied
+     * first. It is expanded manually, so that the loop below runs
+     * over the plain arrays and can be vectorized by the compiler.
+     */
+    const qreal shear = pressure * m_properties->shearFactor;
+    const qreal cosA = std::cos(-angle) * scale;
+    const qreal sinA = std::sin(-angle) * scale;
+
+    const float *bristleX = m_bristles.x.constData();
+    const float *bristleY = m_bristles.y.constData();
+    const qreal *randomX = m_randomX.constData();
+    const qreal *randomY = m_randomY.constData();
+    qreal *endX = m_endX.data();
+    qreal *endY = m_endY.data();
+
+    for (int i = 0; i < bristleCount; i++) {
+        const qreal tx = bristleX[i] + shear * bristleY[i] + randomX[i];
+        const qreal ty = bristleY[i] + shear * bristleX[i] + randomY[i];
 
-inline qreal HairyBrush::fetchInkDepletion(Bristle* bristle, int inkDepletionSize)
+        endX[i] = cosA * tx - sinA * ty;
+        endY[i] = sinA * tx + cosA * ty;
+    }
+
+    if (firstStroke() || (!m_properties->connectedPath)) {
+        // the start and the end of the segment are transformed the same way
+        std::copy(m_endX.constBegin(), m_endX.constEnd(), m_startX.begin());
+        std::copy(m_endY.constBegin(), m_endY.constEnd(), m_startY.begin());
+    }
+    else {
+        // continue the path of the bristle from the previous position
+        std::copy(m_bristles.prevX.constBegin(), m_bristles.prevX.constEnd(), m_startX.begin());
+        std::copy(m_bristles.prevY.constBegin(), m_bristles.prevY.constEnd(), m_startY.begin());
+    }
+
+    // remember the end point
+    std::copy(m_endX.constBegin(), m_endX.constEnd(), m_bristles.prevX.begin());
+    std::copy(m_endY.constBegin(), m_endY.constEnd(), m_bristles.prevY.begin());
+}
+
+
+inline qreal HairyBrush::fetchInkDepletion(int bristle, int inkDepletionSize)
 {
-    if (bristle->counter() >= inkDepletionSize - 1) {
+    const int counter = m_bristles.counter[bristle];
+
+    if (counter >= inkDepletionSize - 1) {
         return m_properties->inkDepletionCurve[inkDepletionSize - 1];
     } else {
-        return m_properties->inkDepletionCurve[bristle->counter()];
+        return m_properties->inkDepletionCurve[counter];
     }
 }
 
 
-void HairyBrush::saturationDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion)
+void HairyBrush::saturationDepletion(int bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion)
 {
     qreal saturation;
     if (m_properties->useWeights) {
         // new weighted way (experiment)
         saturation = (
                          (pressure * m_properties->pressureWeight) +
-                         (bristle->length() * m_properties->bristleLengthWeight) +
-                         (bristle->inkAmount() * m_properties->bristleInkAmountWeight) +
+                         (m_bristles.length[bristle] * m_properties->bristleLengthWeight) +
+                         (m_bristles.inkAmount[bristle] * m_properties->bristleInkAmountWeight) +
                          ((1.0 - inkDepletion) * m_properties->inkDepletionWeight)) - 1.0;
     }
     else {
         // old way of computing saturation
         saturation = (
                          pressure *
-                         bristle->length() *
-                         bristle->inkAmount() *
+                         m_bristles.length[bristle] *
+                         m_bristles.inkAmount[bristle] *
                          (1.0 - inkDepletion)) - 1.0;
 
     }
@@ -274,28 +306,27 @@ void HairyBrush::saturationDepletion(Bristle * bristle, KoColor &bristleColor, q
     m_transfo->transform(bristleColor.data(), bristleColor.data() , 1);
 }
 
-void HairyBrush::opacityDepletion(Bristle* bristle, KoColor& bristleColor, qreal pressure, qreal inkDepletion)
+void HairyBrush::opacityDepletion(int bristle, KoColor& bristleColor, qreal pressure, qreal inkDepletion)
 {
     qreal opacity = OPACITY_OPAQUE_F;
     if (m_properties->useWeights) {
         opacity = pressure * m_properties->pressureWeight +
-                  bristle->length() * m_properties->bristleLengthWeight +
-                  bristle->inkAmount() * m_properties->bristleInkAmountWeight +
+                  m_bristles.length[bristle] * m_properties->bristleLengthWeight +
+                  m_bristles.inkAmount[bristle] * m_properties->bristleInkAmountWeight +
                   (1.0 - inkDepletion) * m_properties->inkDepletionWeight;
     }
     else {
         opacity =
-            bristle->length() *
-            bristle->inkAmount();
+            m_bristles.length[bristle] *
+            m_bristles.inkAmount[bristle];
     }
 
     opacity = qBound(0.0, opacity, 1.0);
     bristleColor.setOpacity(opacity);
 }
 
-inline void HairyBrush::addBristleInk(Bristle *bristle,const QPointF &pos, const KoColor &color)
+inline void HairyBrush::addBristleInk(const QPointF &pos, const KoColor &color)
 {
-    Q_UNUSED(bristle);
     if (m_properties->antialias) {
         if (m_properties->useCompositing) {
             paintParticle(pos, color);
@@ -306,12 +337,7 @@ inline void HairyBrush::addBristleInk(Bristle *bristle,const QPointF &pos, const
     else {
         int ix = qRound(pos.x());
         int iy = qRound(pos.y());
-        if (m_properties->useCompositing) {
-            plotPixel(ix, iy, color);
-        }
-        else {
-            darkenPixel(ix, iy, color);
-        }
+        queuePixelWrite(ix, iy, color);
     }
 }
 
@@ -331,27 +357,20 @@ void HairyBrush::paintParticle(QPointF pos, const KoColor& color, qreal weight)
     quint8 bbl = qRound((1.0 - fx) * (fy)  * opacity);
     quint8 bbr = qRound((fx)  * (fy)  * opacity);
 
-    const KoColorSpace * cs = m_dab->colorSpace();
+    // the opacities are added to the ones of the dab when the writes are flushed
+    KoColor particleColor(color);
 
-    m_dabAccessor->moveTo(ipx  , ipy);
-    btl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btl, 1);
+    particleColor.setOpacity(btl);
+    queuePixelWrite(ipx, ipy, particleColor);
 
-    m_dabAccessor->moveTo(ipx + 1, ipy);
-    btr =  quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, btr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), btr, 1);
+    particleColor.setOpacity(btr);
+    queuePixelWrite(ipx + 1, ipy, particleColor);
 
-    m_dabAccessor->moveTo(ipx, ipy + 1);
-    bbl = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbl + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbl, 1);
+    particleColor.setOpacity(bbl);
+    queuePixelWrite(ipx, ipy + 1, particleColor);
 
-    m_dabAccessor->moveTo(ipx + 1, ipy + 1);
-    bbr = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, bbr + cs->opacityU8(m_dabAccessor->rawData()), OPACITY_OPAQUE_U8));
-    memcpy(m_dabAccessor->rawData(), color.data(), cs->pixelSize());
-    cs->setOpacity(m_dabAccessor->rawData(), bbr, 1);
+    particleColor.setOpacity(bbr);
+    queuePixelWrite(ipx + 1, ipy + 1, particleColor);
 }
 
 void HairyBrush::paintParticle(QPointF pos, const KoColor& color)
@@ -371,31 +390,80 @@ void HairyBrush::paintParticle(QPointF pos, const KoColor& color)
     quint8 bbr = qRound((fx)  * (fy)  * opacity);
 
     m_color.setOpacity(btl);
-    plotPixel(ipx  , ipy, m_color);
+    queuePixelWrite(ipx  , ipy, m_color);
 
     m_color.setOpacity(btr);
-    plotPixel(ipx + 1  , ipy, m_color);
+    queuePixelWrite(ipx + 1  , ipy, m_color);
 
     m_color.setOpacity(bbl);
-    plotPixel(ipx  , ipy + 1, m_color);
+    queuePixelWrite(ipx  , ipy + 1, m_color);
 
     m_color.setOpacity(bbr);
-    plotPixel(ipx + 1 , ipy + 1, m_color);
+    queuePixelWrite(ipx + 1 , ipy + 1, m_color);
 }
 
-
-inline void HairyBrush::plotPixel(int wx, int wy, const KoColor &color)
+inline void HairyBrush::queuePixelWrite(int x, int y, const KoColor &color)
 {
-    m_dabAccessor->moveTo(wx, wy);
-    m_compositeOp->composite(m_dabAccessor->rawData(), m_pixelSize, color.data() , m_pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+    m_pixelWritePositions.append(QPoint(x, y));
+
+    const int offset = m_pixelWriteColors.size();
+    m_pixelWriteColors.resize(offset + m_pixelSize);
+    memcpy(m_pixelWriteColors.data() + offset, color.data(), m_pixelSize);
 }
 
-inline void HairyBrush::darkenPixel(int wx, int wy, const KoColor &color)
+void HairyBrush::flushPixelWrites(PixelWriteMode mode)
 {
-    m_dabAccessor->moveTo(wx, wy);
-    if (m_dab->colorSpace()->opacityU8(m_dabAccessor->rawData()) < color.opacityU8()) {
-        memcpy(m_dabAccessor->rawData(), color.data(), m_pixelSize);
+    const int numWrites = m_pixelWritePositions.size();
+
+    /**
+     * Sort the writes by the block they fall into. The index of the write
+     * is a part of the key, so the writes into the same pixel keep their
+     * order and the result doesn't depend on the grouping.
+     */
+    m_pixelWriteOrder.resize(numWrites);
+
+    for (int i = 0; i < numWrites; i++) {
+        const QPoint &pt = m_pixelWritePositions[i];
+
+        const quint64 blockKey =
+            (quint64(quint32(pt.y() >> pixelWriteBlockShift)) << 32) |
+            quint32(pt.x() >> pixelWriteBlockShift);
+
+        m_pixelWriteOrder[i] = qMakePair(blockKey, i);
     }
+
+    std::sort(m_pixelWriteOrder.begin(), m_pixelWriteOrder.end());
+
+    const KoColorSpace *cs = m_dab->colorSpace();
+
+    for (int i = 0; i < numWrites; i++) {
+        const int index = m_pixelWriteOrder[i].second;
+        const QPoint &pt = m_pixelWritePositions[index];
+        const quint8 *color = m_pixelWriteColors.constData() + index * m_pixelSize;
+
+        m_dabAccessor->moveTo(pt.x(), pt.y());
+        quint8 *dst = m_dabAccessor->rawData();
+
+        switch (mode) {
+        case CompositeWrite:
+            m_compositeOp->composite(dst, m_pixelSize, color, m_pixelSize, 0, 0, 1, 1, OPACITY_OPAQUE_U8);
+            break;
+        case AddOpacityWrite: {
+            const quint8 opacity = quint8(qBound<quint16>(OPACITY_TRANSPARENT_U8, cs->opacityU8(color) + cs->opacityU8(dst), OPACITY_OPAQUE_U8));
+            memcpy(dst, color, m_pixelSize);
+            cs->setOpacity(dst, opacity, 1);
+            break;
+        }
+        case DarkenWrite:
+            if (cs->opacityU8(dst) < cs->opacityU8(color)) {
+                memcpy(dst, color, m_pixelSize);
+            }
+            break;
+        }
+    }
+
+    m_pixelWritePositions.clear();
+    m_pixelWriteColors.clear();
 }
 
 double HairyBrush::computeMousePressure(double distance)
@@ -420,15 +488,13 @@ void HairyBrush::colorifyBristles(KisPaintDeviceSP source, QPointF point)
     KoColor bristleColor(m_dab->colorSpace());
     KisCrossDeviceColorSamplerInt colorSampler(source, bristleColor);
 
-    Bristle *b = 0;
     int size = m_bristles.size();
     for (int i = 0; i < size; i++) {
-        b = m_bristles[i];
-        int x = qRound(b->x() + point.x());
-        int y = qRound(b->y() + point.y());
+        int x = qRound(m_bristles.x[i] + point.x());
+        int y = qRound(m_bristles.y[i] + point.y());
 
         colorSampler.sampleOldColor(x, y, bristleColor.data());
-        b->setColor(bristleColor);
+        m_bristles.setColor(i, bristleColor.data());
     }
 
 }
@@ -9,7 +9,8 @@
 
 #include <QVector>
 #include <QList>
-#include <QTransform>
+#include <QPair>
+#include <QPoint>
 
 #include <KoColor.h>
 
@@ -74,12 +75,18 @@ public:
     void fromDabWithDensity(KisFixedPaintDeviceSP dab, qreal density);
 
 private:
+    /// the ways the queued pixels are written into the dab, \see flushPixelWrites()
+    enum PixelWriteMode {
+        /// composite the pixel over the dab
+        CompositeWrite,
+        /// copy the color and add its opacity to the opacity of the dab pixel
+        AddOpacityWrite,
+        /// copy the color if it is more opaque than the dab pixel
+        DarkenWrite
+    };
+
     /// paints single bristle
-    void addBristleInk(Bristle *bristle,const QPointF &pos, const KoColor &color);
-    /// composite single pixel to dab
-    void plotPixel(int wx, int wy, const KoColor &color);
-    /// check the opacity of dab pixel and if the opacity is less than color, it will copy color to dab
-    void darkenPixel(int wx, int wy, const KoColor &color);
+    void addBristleInk(const QPointF &pos, const KoColor &color);
     /// paint wu particle by copying the color and setup just the opacity, weight is complementary to opacity of the color
     void paintParticle(QPointF pos, const KoColor& color, qreal weight);
     /// paint wu particle using composite operation
@@ -87,24 +94,47 @@ private:
     /// similar to sample input color in spray
     void colorifyBristles(KisPaintDeviceSP source, QPointF point);
 
-    void repositionBristles(double angle, double slope);
+    /// transforms all the bristles into the segment's start and end points
+    void transformBristles(const KisPaintInformation &pi2, qreal angle, qreal scale, qreal pressure);
+
     /// compute mouse pressure according distance
     double computeMousePressure(double distance);
 
     /// simulate running out of saturation
-    void saturationDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion);
+    void saturationDepletion(int bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion);
     /// simulate running out of ink through opacity decreasing
-    void opacityDepletion(Bristle * bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion);
+    void opacityDepletion(int bristle, KoColor &bristleColor, qreal pressure, qreal inkDepletion);
     /// fetch actual ink status according depletion curve
-    qreal fetchInkDepletion(Bristle * bristle, int inkDepletionSize);
+    qreal fetchInkDepletion(int bristle, int inkDepletionSize);
+
+    /// queues a pixel of \p color (with its opacity) to be written at (\p x, \p y)
+    void queuePixelWrite(int x, int y, const KoColor &color);
+    /**
+     * Writes all the queued pixels into the dab. The writes are grouped
+     * by the tiles of the dab, the writes into the same pixel keep their
+     * order, so the result is the same as writing them one by one.
+     */
+    void flushPixelWrites(PixelWriteMode mode);
 
     void initAndCache();
 
 private:
     const KisHairyProperties * m_properties {nullptr};
 
-    QVector<Bristle*> m_bristles;
-    QTransform m_transform;
+    Bristles m_bristles;
+
+    // the start and end points of the bristles in the current segment
+    QVector<qreal> m_randomX;
+    QVector<qreal> m_randomY;
+    QVector<qreal> m_startX;
+    QVector<qreal> m_startY;
+    QVector<qreal> m_endX;
+    QVector<qreal> m_endY;
+
+    // the pixels of the current segment waiting to be written into the dab
+    QVector<QPoint> m_pixelWritePositions;
+    QVector<quint8> m_pixelWriteColors;
+    QVector<QPair<quint64, int>> m_pixelWriteOrder;
 
     // used for interpolation the path of bristles
     Trajectory m_trajectory;
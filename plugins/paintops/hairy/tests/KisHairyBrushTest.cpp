@@ -0,0 +1,168 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisHairyBrushTest.h"
+
+#include <cmath>
+
+#include <kistest.h>
+#include <testutil.h>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <kis_fixed_paint_device.h>
+#include <brushengine/kis_random_source.h>
+#include <brushengine/kis_paint_information.h>
+
+#include "../hairy_brush.h"
+#include "reference_hairy_brush.h"
+
+
+namespace {
+
+KisFixedPaintDeviceSP createBristleDab(const KoColorSpace *cs)
+{
+    const int size = 21;
+    const qreal radius = 0.5 * size;
+
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(cs);
+    dab->setRect(QRect(0, 0, size, size));
+    dab->initialize();
+
+    // a round dab with a radial falloff and a different color in every column
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const qreal distance = std::hypot(x + 0.5 - radius, y + 0.5 - radius);
+            if (distance >= radius) continue;
+
+            QColor color = QColor::fromHsv(x * 360 / size, 200, 220);
+            color.setAlphaF(1.0 - distance / radius);
+            dab->fill(x, y, 1, 1, KoColor(color, cs).data());
+        }
+    }
+
+    return dab;
+}
+
+KisPaintDeviceSP createSoakLayer(const KoColorSpace *cs)
+{
+    KisPaintDeviceSP layer = new KisPaintDevice(cs);
+    layer->fill(QRect(0, 0, 100, 200), KoColor(Qt::blue, cs));
+    layer->fill(QRect(100, 0, 100, 200), KoColor(Qt::yellow, cs));
+    return layer;
+}
+
+template <class Brush>
+KisPaintDeviceSP paintStroke(KisHairyProperties *properties, qreal density)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    Brush brush;
+    brush.fromDabWithDensity(createBristleDab(cs), density);
+    brush.setInkColor(KoColor(Qt::red, cs));
+    brush.setProperties(properties);
+
+    KisPaintDeviceSP dab = new KisPaintDevice(cs);
+    KisPaintDeviceSP layer = createSoakLayer(cs);
+
+    // both the brushes get the same sequence of random offsets
+    KisRandomSourceSP randomSource = new KisRandomSource(42);
+
+    KisPaintInformation pi1(QPointF(30, 100), 0.5);
+    pi1.setRandomSource(randomSource);
+
+    for (int i = 1; i <= 24; i++) {
+        KisPaintInformation pi2(QPointF(30 + 6 * i, 100 + 40 * std::sin(0.3 * i)),
+                                0.2 + 0.2 * (i % 5));
+        pi2.setRandomSource(randomSource);
+
+        brush.paintLine(dab, layer, pi1, pi2, 1.0 + 0.05 * i, 0.15 * i);
+        pi1 = pi2;
+    }
+
+    return dab;
+}
+
+}
+
+void KisHairyBrushTest::testReferenceStroke_data()
+{
+    QTest::addColumn<bool>("antialias");
+    QTest::addColumn<bool>("useCompositing");
+    QTest::addColumn<bool>("inkDepletion");
+    QTest::addColumn<bool>("useWeights");
+    QTest::addColumn<bool>("useSoakInk");
+    QTest::addColumn<bool>("connectedPath");
+    QTest::addColumn<qreal>("density");
+
+    QTest::newRow("darken") << false << false << false << false << false << false << 1.0;
+    QTest::newRow("darken-connected") << false << false << false << false << false << true << 1.0;
+    QTest::newRow("composite") << false << true << false << false << false << false << 1.0;
+    QTest::newRow("aa-add-opacity") << true << false << false << false << false << false << 1.0;
+    QTest::newRow("aa-composite") << true << true << false << false << false << true << 1.0;
+    QTest::newRow("aa-composite-sparse") << true << true << false << false << false << false << 0.3;
+    QTest::newRow("depletion-darken") << false << false << true << false << false << false << 1.0;
+    QTest::newRow("depletion-aa-composite") << true << true << true << false << false << true << 1.0;
+    QTest::newRow("depletion-weights") << true << false << true << true << false << false << 1.0;
+    QTest::newRow("depletion-soak-ink") << true << true << true << false << true << true << 1.0;
+}
+
+void KisHairyBrushTest::testReferenceStroke()
+{
+    QFETCH(bool, antialias);
+    QFETCH(bool, useCompositing);
+    QFETCH(bool, inkDepletion);
+    QFETCH(bool, useWeights);
+    QFETCH(bool, useSoakInk);
+    QFETCH(bool, connectedPath);
+    QFETCH(qreal, density);
+
+    KisHairyProperties properties;
+    properties.radius = 10;
+    properties.inkAmount = 100;
+    properties.sigma = 1.0;
+    properties.inkDepletionEnabled = inkDepletion;
+    properties.isbrushDimension1D = false;
+    properties.useMousePressure = false;
+    properties.useSaturation = inkDepletion;
+    properties.useOpacity = inkDepletion;
+    properties.useWeights = useWeights;
+    properties.useSoakInk = useSoakInk;
+    properties.connectedPath = connectedPath;
+    properties.antialias = antialias;
+    properties.useCompositing = useCompositing;
+    properties.pressureWeight = 1;
+    properties.bristleLengthWeight = 1;
+    properties.bristleInkAmountWeight = 0;
+    properties.inkDepletionWeight = 1;
+    properties.shearFactor = 0.3;
+    properties.randomFactor = 2.0;
+    properties.scaleFactor = 1.0;
+    properties.threshold = 0.0;
+
+    // the ink runs out within the first few segments of the stroke
+    for (int i = 0; i < properties.inkAmount; i++) {
+        properties.inkDepletionCurve << qreal(i) / (properties.inkAmount - 1);
+    }
+
+    KisPaintDeviceSP result = paintStroke<HairyBrush>(&properties, density);
+    KisPaintDeviceSP reference = paintStroke<ReferenceHairyBrush>(&properties, density);
+
+    QCOMPARE(result->exactBounds(), reference->exactBounds());
+    QVERIFY(!result->exactBounds().isEmpty());
+
+    const QRect rc = reference->exactBounds();
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt,
+                                     reference->convertToQImage(0, rc),
+                                     result->convertToQImage(0, rc)));
+}
+
+KISTEST_MAIN(KisHairyBrushTest)
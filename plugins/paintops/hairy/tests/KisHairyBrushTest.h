@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISHAIRYBRUSHTEST_H
+#define KISHAIRYBRUSHTEST_H
+
+#include <QtTest>
+
+class KisHairyBrushTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+
+    void testReferenceStroke();
+    void testReferenceStroke_data();
+};
+
+#endif // KISHAIRYBRUSHTEST_H
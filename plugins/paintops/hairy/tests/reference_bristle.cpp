@@ -0,0 +1,58 @@
+/*
+ *  SPDX-FileCopyrightText: 2008 Lukas Tvrdy <lukast.dev@gmail.com>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "reference_bristle.h"
+
+ReferenceBristle::ReferenceBristle(float x, float y, float length)
+    : m_x(x)
+    , m_y(y)
+    , m_prevX(x)
+    , m_prevY(y)
+    , m_length(length)
+{}
+
+ReferenceBristle::~ReferenceBristle()
+{
+}
+
+void ReferenceBristle::setLength(float length)
+{
+    m_length = length;
+}
+
+
+void ReferenceBristle::addInk(float value)
+{
+    m_inkAmount = m_inkAmount + value;
+}
+
+void ReferenceBristle::removeInk(float value)
+{
+    m_inkAmount = m_inkAmount - value;
+}
+
+void ReferenceBristle::setInkAmount(float inkAmount)
+{
+    if (inkAmount > 1.0f) {
+        inkAmount = 1.0f;
+    }
+    else if (inkAmount < -1.0f) {
+        inkAmount = -1.0f;
+    }
+
+    m_inkAmount = inkAmount;
+}
+
+void ReferenceBristle::setColor(const KoColor &color)
+{
+    m_color = color;
+}
+
+
+void ReferenceBristle::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
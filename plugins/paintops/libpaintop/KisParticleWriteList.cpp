@@ -0,0 +1,108 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisParticleWriteList.h"
+
+#include <cstring>
+
+#include <KoColorSpace.h>
+
+#include <kis_assert.h>
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+
+namespace {
+
+inline int tileRow(int y)
+{
+    static_assert(KisParticleWriteList::tileRowHeight == 64, "the row height should match the shift");
+
+    // the arithmetic shift rounds the negative coordinates down
+    return y >> 6;
+}
+
+}
+
+KisParticleWriteList::KisParticleWriteList()
+{
+}
+
+KisParticleWriteList::KisParticleWriteList(const KoColorSpace *colorSpace)
+    : m_colorSpace(colorSpace),
+      m_pixelSize(colorSpace->pixelSize())
+{
+}
+
+void KisParticleWriteList::addPixel(int x, int y, const quint8 *pixel)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_colorSpace);
+
+    Row &row = m_rows[tileRow(y)];
+    row.positions.append(QPoint(x, y));
+
+    const int offset = row.pixels.size();
+    row.pixels.resize(offset + m_pixelSize);
+    memcpy(row.pixels.data() + offset, pixel, m_pixelSize);
+
+    m_bounds |= QRect(x, y, 1, 1);
+}
+
+void KisParticleWriteList::clear()
+{
+    m_rows.clear();
+    m_bounds = QRect();
+}
+
+bool KisParticleWriteList::isEmpty() const
+{
+    return m_rows.isEmpty();
+}
+
+QRect KisParticleWriteList::bounds() const
+{
+    return m_bounds;
+}
+
+void KisParticleWriteList::mergeRowSet(const QVector<KisParticleWriteList> &lists,
+                                       int rowSet, int numRowSets,
+                                       KisPaintDeviceSP dst, WriteMode mode)
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN(numRowSets > 0);
+
+    KisRandomAccessorSP accessor = dst->createRandomAccessorNG();
+    const KoColorSpace *cs = dst->colorSpace();
+
+    Q_FOREACH (const KisParticleWriteList &list, lists) {
+        if (list.isEmpty()) continue;
+
+        KIS_SAFE_ASSERT_RECOVER(*list.m_colorSpace == *cs) { continue; }
+
+        const int pixelSize = list.m_pixelSize;
+
+        for (auto it = list.m_rows.constBegin(); it != list.m_rows.constEnd(); ++it) {
+            const int row = it.key();
+            if (((row % numRowSets) + numRowSets) % numRowSets != rowSet) continue;
+
+            const Row &writes = it.value();
+            const quint8 *pixel = writes.pixels.constData();
+
+            Q_FOREACH (const QPoint &pt, writes.positions) {
+                accessor->moveTo(pt.x(), pt.y());
+                quint8 *dstPixel = accessor->rawData();
+
+                if (mode == AddOpacity) {
+                    const quint16 opacity = cs->opacityU8(dstPixel) + cs->opacityU8(pixel);
+                    memcpy(dstPixel, pixel, pixelSize);
+                    cs->setOpacity(dstPixel, quint8(qMin<quint16>(opacity, OPACITY_OPAQUE_U8)), 1);
+                } else {
+                    memcpy(dstPixel, pixel, pixelSize);
+                }
+
+                pixel += pixelSize;
+            }
+        }
+    }
+}
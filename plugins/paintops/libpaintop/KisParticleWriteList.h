@@ -0,0 +1,76 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPARTICLEWRITELIST_H
+#define KISPARTICLEWRITELIST_H
+
+#include <QMap>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+
+#include "kis_types.h"
+#include "kritapaintop_export.h"
+
+class KoColorSpace;
+
+/**
+ * A list of single-pixel writes produced by a particle-based paintop
+ * (spray, particle) in one of its concurrent rendering jobs.
+ *
+ * The writes are grouped by the row of tiles they belong to. That
+ * allows merging the lists of several jobs into the dab concurrently,
+ * one job per a set of rows, without any locking: two rows of tiles
+ * never share the tile data. The writes are applied in the order of
+ * the lists, and, inside a list, in the order they were added, so the
+ * result doesn't depend on the number of threads.
+ */
+class PAINTOP_EXPORT KisParticleWriteList
+{
+public:
+    enum WriteMode {
+        /// the pixel is overwritten by the new value
+        Overwrite,
+        /// the pixel gets the color of the new value, the opacity
+        /// of the new value is added to the opacity of the pixel
+        AddOpacity
+    };
+
+    static const int tileRowHeight = 64;
+
+public:
+    KisParticleWriteList();
+    KisParticleWriteList(const KoColorSpace *colorSpace);
+
+    void addPixel(int x, int y, const quint8 *pixel);
+    void clear();
+
+    bool isEmpty() const;
+    QRect bounds() const;
+
+    /**
+     * Writes the pixels of all \p lists that belong to the tile rows
+     * with (row % \p numRowSets == \p rowSet) into \p dst.
+     *
+     * Calls with different \p rowSet can safely run concurrently.
+     */
+    static void mergeRowSet(const QVector<KisParticleWriteList> &lists,
+                            int rowSet, int numRowSets,
+                            KisPaintDeviceSP dst, WriteMode mode);
+
+private:
+    struct Row {
+        QVector<QPoint> positions;
+        QVector<quint8> pixels;
+    };
+
+    const KoColorSpace *m_colorSpace {0};
+    int m_pixelSize {0};
+    QMap<int, Row> m_rows;
+    QRect m_bounds;
+};
+
+#endif // KISPARTICLEWRITELIST_H
@@ -17,9 +17,33 @@
 #include <kis_algebra_2d.h>
 #include <kis_lod_transform.h>
 #include <kis_iterator_ng.h>
+#include <kis_fill_painter.h>
+#include <KoCompositeOpRegistry.h>
 
 #include <QGlobalStatic>
 
+#include <cmath>
+
+namespace {
+
+/**
+ * Small patterns are repeated further than twice, so that the
+ * dabs are not split into too many tiny patches
+ */
+const int minTiledMaskExtent = 256;
+
+/**
+ * The number of recently used masks kept in KisTextureMaskInfoCache
+ */
+const int maxCachedTextureInfos = 8;
+
+int numTiledRepeats(int patternSize)
+{
+    return qMax(2, int(std::ceil(qreal(minTiledMaskExtent) / patternSize)));
+}
+
+}
+
 /**********************************************************************/
 /*       KisTextureMaskInfo                                           */
 /**********************************************************************/
@@ -107,6 +131,14 @@ QRect KisTextureMaskInfo::maskBounds() const {
     return m_maskBounds;
 }
 
+const quint8* KisTextureMaskInfo::tiledMask() const {
+    return m_tiledMask.constData();
+}
+
+QSize KisTextureMaskInfo::tiledMaskSize() const {
+    return m_tiledMaskSize;
+}
+
 bool KisTextureMaskInfo::fillProperties(const KisPropertiesConfiguration *setting, KisResourcesInterfaceSP resourcesInterface)
 {
     KisTextureOptionData data;
@@ -240,6 +272,31 @@ void KisTextureMaskInfo::recalculateMask()
         m_mask->convertFromQImage(mask, 0);
     }
     m_maskBounds = QRect(0, 0, width, height);
+
+    recalculateTiledMask();
+}
+
+void KisTextureMaskInfo::recalculateTiledMask()
+{
+    m_tiledMaskSize = QSize(m_maskBounds.width() * numTiledRepeats(m_maskBounds.width()),
+                            m_maskBounds.height() * numTiledRepeats(m_maskBounds.height()));
+
+    const QRect tiledRect(QPoint(), m_tiledMaskSize);
+
+    /**
+     * The mask is tiled with the same fill painter call the dabs
+     * used for fetching their patches, so the conversion from RGBA
+     * masks into alpha8 stays the same
+     */
+    KisPaintDeviceSP tiledDevice = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+
+    KisFillPainter fillPainter(tiledDevice);
+    fillPainter.setCompositeOpId(COMPOSITE_COPY);
+    fillPainter.fillRect(tiledRect, m_mask, m_maskBounds);
+    fillPainter.end();
+
+    m_tiledMask.resize(tiledRect.width() * tiledRect.height());
+    tiledDevice->readBytes(m_tiledMask.data(), tiledRect);
 }
 
 bool KisTextureMaskInfo::hasAlpha() {
@@ -260,13 +317,19 @@ KisTextureMaskInfoCache *KisTextureMaskInfoCache::instance()
 KisTextureMaskInfoSP KisTextureMaskInfoCache::fetchCachedTextureInfo(KisTextureMaskInfoSP info) {
     QMutexLocker locker(&m_mutex);
 
-    KisTextureMaskInfoSP &cachedInfo =
-            info->levelOfDetail() > 0 ? m_lodInfo : m_mainInfo;
+    for (int i = 0; i < m_infos.size(); i++) {
+        if (*m_infos[i] == *info) {
+            m_infos.move(i, 0);
+            return m_infos.first();
+        }
+    }
+
+    info->recalculateMask();
+    m_infos.prepend(info);
 
-    if (!cachedInfo || *cachedInfo != *info) {
-        cachedInfo = info;
-        cachedInfo->recalculateMask();
+    while (m_infos.size() > maxCachedTextureInfos) {
+        m_infos.removeLast();
     }
 
-    return cachedInfo;
+    return info;
 }
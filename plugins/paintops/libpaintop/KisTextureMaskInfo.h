@@ -11,6 +11,8 @@
 #include <kis_paint_device.h>
 #include <QSharedPointer>
 #include <QMutex>
+#include <QList>
+#include <QVector>
 
 
 #include <boost/operators.hpp>
@@ -42,12 +44,25 @@ public:
 
     QRect maskBounds() const;
 
+    /**
+     * The alpha8 version of the mask repeated over tiledMaskSize()
+     * starting at (0, 0). Every patch of the pattern that starts
+     * inside maskBounds() can be read from the tiled mask without any
+     * wrapping as long as it fits into the tiled mask. The tiled mask
+     * is at least twice as big as the pattern in both dimensions.
+     */
+    const quint8* tiledMask() const;
+    QSize tiledMaskSize() const;
+
     bool fillProperties(const KisPropertiesConfiguration *setting, KisResourcesInterfaceSP resourcesInterface);
 
     void recalculateMask();
 
     bool hasAlpha();
 
+private:
+    void recalculateTiledMask();
+
 private:
     int m_levelOfDetail = 0;
     bool m_preserveAlpha = false;
@@ -67,6 +82,9 @@ private:
     KisPaintDeviceSP m_mask;
     QRect m_maskBounds;
 
+    QVector<quint8> m_tiledMask;
+    QSize m_tiledMaskSize;
+
 };
 
 typedef QSharedPointer<KisTextureMaskInfo> KisTextureMaskInfoSP;
@@ -78,8 +96,13 @@ struct KisTextureMaskInfoCache
 
 private:
     QMutex m_mutex;
-    QSharedPointer<KisTextureMaskInfo> m_lodInfo;
-    QSharedPointer<KisTextureMaskInfo> m_mainInfo;
+
+    /**
+     * The recently used masks, the most recent one goes first. Keeping
+     * a few of them avoids regenerating the masks when switching
+     * between the textured presets or when the LoD mode is active
+     */
+    QList<KisTextureMaskInfoSP> m_infos;
 };
 
 #endif // KISTEXTUREMASKINFO_H
@@ -0,0 +1,177 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTextureMultiplyApplicator.h"
+
+#if XSIMD_UNIVERSAL_BUILD_PASS
+
+#include <KoIntegerMaths.h>
+
+namespace {
+
+/**
+ * The same arithmetic as in the COMPOSITE_MULT specializations
+ * of KisMaskingBrushCompositeDetail::CompositeFunction for quint8
+ */
+template<bool useSoftTexturing>
+inline quint32 multiplyPixel(quint32 mask, quint32 alpha,
+                             quint32 strength, quint32 invertedStrength)
+{
+    if (useSoftTexturing) {
+        const quint32 softMask = mask + invertedStrength - UINT8_MULT(mask, invertedStrength);
+        return UINT8_MULT(softMask, alpha);
+    } else {
+        return UINT8_MULT3(mask, alpha, strength);
+    }
+}
+
+template<bool useSoftTexturing>
+inline void multiplyRowScalar(const quint8 *mask, quint8 *alpha,
+                              quint32 strength, quint32 invertedStrength,
+                              int numPixels)
+{
+    for (int i = 0; i < numPixels; i++) {
+        *alpha = quint8(multiplyPixel<useSoftTexturing>(*mask, *alpha, strength, invertedStrength));
+
+        mask++;
+        alpha += 4;
+    }
+}
+
+inline void multiplyRowScalar(const quint8 *mask, quint8 *alpha,
+                              quint8 strength, bool useSoftTexturing,
+                              int numPixels)
+{
+    if (useSoftTexturing) {
+        multiplyRowScalar<true>(mask, alpha, strength, 255 - strength, numPixels);
+    } else {
+        multiplyRowScalar<false>(mask, alpha, strength, 255 - strength, numPixels);
+    }
+}
+
+template<typename _impl, typename EnableDummyType = void>
+class KisTextureMultiplyApplicator : public KisTextureMultiplyApplicatorBase
+{
+public:
+    void multiplyAlpha(const quint8 *maskRowStart, int maskRowStride,
+                       quint8 *dabRowStart, int dabRowStride,
+                       int alphaOffset, quint8 strength, bool useSoftTexturing,
+                       int columns, int rows) const override
+    {
+        for (int y = 0; y < rows; y++) {
+            multiplyRowScalar(maskRowStart, dabRowStart + alphaOffset,
+                              strength, useSoftTexturing, columns);
+
+            maskRowStart += maskRowStride;
+            dabRowStart += dabRowStride;
+        }
+    }
+};
+
+#if defined(HAVE_XSIMD) && !defined(XSIMD_NO_SUPPORTED_ARCHITECTURE) && XSIMD_VERSION_MAJOR >= 10
+
+template<typename _impl>
+class KisTextureMultiplyApplicator<
+    _impl,
+    typename std::enable_if<!std::is_same<_impl, xsimd::generic>::value>::type>
+    : public KisTextureMultiplyApplicatorBase
+{
+    using uint_v = xsimd::batch<uint32_t, _impl>;
+
+public:
+    void multiplyAlpha(const quint8 *maskRowStart, int maskRowStride,
+                       quint8 *dabRowStart, int dabRowStride,
+                       int alphaOffset, quint8 strength, bool useSoftTexturing,
+                       int columns, int rows) const override
+    {
+        if (useSoftTexturing) {
+            multiplyAlphaImpl<true>(maskRowStart, maskRowStride, dabRowStart, dabRowStride,
+                                    alphaOffset, strength, columns, rows);
+        } else {
+            multiplyAlphaImpl<false>(maskRowStart, maskRowStride, dabRowStart, dabRowStride,
+                                     alphaOffset, strength, columns, rows);
+        }
+    }
+
+private:
+    /**
+     * The vectorized version of multiplyPixel()
+     */
+    template<bool useSoftTexturing>
+    static inline uint_v multiplyPixels(const uint_v &mask, const uint_v &alpha,
+                                        const uint_v &strength, const uint_v &invertedStrength)
+    {
+        auto mult = [] (const uint_v &a, const uint_v &b) {
+            const uint_v t = a * b + uint_v(0x80);
+            return ((t >> 8) + t) >> 8;
+        };
+
+        if (useSoftTexturing) {
+            return mult(mask + invertedStrength - mult(mask, invertedStrength), alpha);
+        } else {
+            const uint_v t = mask * alpha * strength + uint_v(0x7F5B);
+            return ((t >> 7) + t) >> 16;
+        }
+    }
+
+    template<bool useSoftTexturing>
+    static void multiplyAlphaImpl(const quint8 *maskRowStart, int maskRowStride,
+                                  quint8 *dabRowStart, int dabRowStride,
+                                  int alphaOffset, quint8 strength,
+                                  int columns, int rows)
+    {
+        constexpr int vectorSize = static_cast<int>(uint_v::size);
+
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        const int alphaShift = alphaOffset * 8;
+#else
+        const int alphaShift = (3 - alphaOffset) * 8;
+#endif
+
+        const uint_v alphaMask(0xffu << alphaShift);
+        const uint_v channelMask(0xffu);
+        const uint_v strengthV(strength);
+        const uint_v invertedStrengthV(255u - strength);
+
+        for (int y = 0; y < rows; y++) {
+            const quint8 *mask = maskRowStart;
+            uint32_t *dab = reinterpret_cast<uint32_t*>(dabRowStart);
+
+            int x = 0;
+
+            for (; x + vectorSize <= columns; x += vectorSize) {
+                const uint_v maskValues = uint_v::load_unaligned(mask + x);
+                const uint_v pixels = uint_v::load_unaligned(dab + x);
+                const uint_v alpha = (pixels >> alphaShift) & channelMask;
+
+                const uint_v result =
+                    multiplyPixels<useSoftTexturing>(maskValues, alpha, strengthV, invertedStrengthV);
+
+                ((pixels & ~alphaMask) | (result << alphaShift)).store_unaligned(dab + x);
+            }
+
+            multiplyRowScalar<useSoftTexturing>(mask + x, dabRowStart + x * 4 + alphaOffset,
+                                                strength, 255 - strength, columns - x);
+
+            maskRowStart += maskRowStride;
+            dabRowStart += dabRowStride;
+        }
+    }
+};
+
+#endif // HAVE_XSIMD
+
+} // namespace
+
+template<typename _impl>
+KisTextureMultiplyApplicatorBase *KisTextureMultiplyApplicatorFactory::create()
+{
+    return new KisTextureMultiplyApplicator<_impl>();
+}
+
+template KisTextureMultiplyApplicatorBase *KisTextureMultiplyApplicatorFactory::create<xsimd::current_arch>();
+
+#endif // XSIMD_UNIVERSAL_BUILD_PASS
@@ -0,0 +1,47 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTEXTUREMULTIPLYAPPLICATOR_H
+#define KISTEXTUREMULTIPLYAPPLICATOR_H
+
+#include <QtGlobal>
+#include <KoMultiArchBuildSupport.h>
+
+/**
+ * Applies the texture in "Multiply" mode to a dab with 8-bit
+ * channels and 4 bytes per pixel (RGBA8 or BGRA8), which is the
+ * most common case of KisTextureOption.
+ *
+ * The results are bit-exact with the generic masking brush composite
+ * op (\see KisMaskingBrushCompositeOp) created for COMPOSITE_MULT
+ * with the same strength and soft texturing options.
+ */
+class KisTextureMultiplyApplicatorBase
+{
+public:
+    virtual ~KisTextureMultiplyApplicatorBase() = default;
+
+    /**
+     * Multiplies the alpha channel of the dab by the alpha8 \p mask
+     *
+     * \param alphaOffset the offset of the alpha channel inside
+     *                    the pixel of the dab, in bytes
+     * \param strength the strength of the texture scaled to [0, 255]
+     */
+    virtual void multiplyAlpha(const quint8 *maskRowStart, int maskRowStride,
+                               quint8 *dabRowStart, int dabRowStride,
+                               int alphaOffset, quint8 strength, bool useSoftTexturing,
+                               int columns, int rows) const = 0;
+};
+
+class KisTextureMultiplyApplicatorFactory
+{
+public:
+    template<typename _impl>
+    static KisTextureMultiplyApplicatorBase *create();
+};
+
+#endif // KISTEXTUREMULTIPLYAPPLICATOR_H
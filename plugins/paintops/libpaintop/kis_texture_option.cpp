@@ -39,6 +39,21 @@
 #include <KoCanvasResourcesIds.h>
 #include <KoCanvasResourcesInterface.h>
 #include <KoResourceLoadResult.h>
+#include <KoColorSpaceMaths.h>
+
+#include "KisTextureMultiplyApplicator.h"
+
+namespace {
+
+const KisTextureMultiplyApplicatorBase *multiplyApplicator()
+{
+    static const QScopedPointer<KisTextureMultiplyApplicatorBase> s_applicator(
+        createOptimizedClass<KisTextureMultiplyApplicatorFactory>());
+
+    return s_applicator.data();
+}
+
+}
 
 /**********************************************************************/
 /*       KisTextureOption                                             */
@@ -257,23 +272,12 @@ void KisTextureOption::apply(KisFixedPaintDeviceSP dab, const QPoint &offset, co
         return;
     }
 
-    QRect rect = dab->bounds();
-    KisPaintDeviceSP mask = m_maskInfo->mask();
+    const QRect rect = dab->bounds();
     const QRect maskBounds = m_maskInfo->maskBounds();
 
-    KisCachedPaintDevice::Guard g(mask, KoColorSpaceRegistry::instance()->alpha8(), m_cachedPaintDevice);
-    KisPaintDeviceSP maskPatch = g.device();
-
     int x = offset.x() % maskBounds.width() - m_offsetX;
     int y = offset.y() % maskBounds.height() - m_offsetY;
 
-    const QRect maskPatchRect = QRect(x, y, rect.width(), rect.height());
-
-    KisFillPainter fillPainter(maskPatch);
-    fillPainter.setCompositeOpId(COMPOSITE_COPY);
-    fillPainter.fillRect(kisGrowRect(maskPatchRect, 1), mask, maskBounds);
-    fillPainter.end();
-
     // Compute final strength
     qreal strength = m_strengthOption.apply(info);
 
@@ -315,49 +319,69 @@ void KisTextureOption::apply(KisFixedPaintDeviceSP dab, const QPoint &offset, co
     case KisTextureOptionData::LINEAR_HEIGHT_PHOTOSHOP: compositeOpId = "linear_height_photoshop"; break;
     default: return;
     }
-    compositeOp.reset(KisMaskingBrushCompositeOpFactory::createForAlphaSrc(
-                        compositeOpId, alphaChannelType, dab->pixelSize(),
-                        alphaChannelOffset, strength, m_useSoftTexturing));
+    const bool useMultiplyApplicator =
+        m_texturingMode == KisTextureOptionData::MULTIPLY &&
+        alphaChannelType == KoChannelInfo::UINT8 &&
+        dab->pixelSize() == 4;
+
+    if (!useMultiplyApplicator) {
+        compositeOp.reset(KisMaskingBrushCompositeOpFactory::createForAlphaSrc(
+                            compositeOpId, alphaChannelType, dab->pixelSize(),
+                            alphaChannelOffset, strength, m_useSoftTexturing));
+    }
+
+    const quint8 strength8 = KoColorSpaceMaths<qreal, quint8>::scaleToA(strength);
 
     // Apply the mask to the dab
     {
-        quint8 *dabIt = nullptr;
-        KisRandomConstAccessorSP maskPatchIt = maskPatch->createRandomConstAccessorNG();
-
-        qint32 dabY = dab->bounds().y();
-        qint32 maskPatchY = maskPatchRect.y();
-        qint32 rowsRemaining = dab->bounds().height();
-        const qint32 dabRowStride = dab->bounds().width() * dab->pixelSize();
-
-        while (rowsRemaining > 0) {
-            qint32 dabX = dab->bounds().x();
-            qint32 maskPatchX = maskPatchRect.x();
-            const qint32 numContiguousMaskPatchRows = maskPatchIt->numContiguousRows(maskPatchY);
-            const qint32 rows = std::min(rowsRemaining, numContiguousMaskPatchRows);
-            qint32 columnsRemaining = dab->bounds().width();
-
-            while (columnsRemaining > 0) {
-                const qint32 numContiguousMaskPatchColumns = maskPatchIt->numContiguousColumns(maskPatchX);
-                const qint32 columns = std::min(columnsRemaining, numContiguousMaskPatchColumns);
-
-                const qint32 maskPatchRowStride = maskPatchIt->rowStride(maskPatchX, maskPatchY);
-
-                dabIt = dab->data() + (dabY * dab->bounds().width() + dabX) * dab->pixelSize();
-                maskPatchIt->moveTo(maskPatchX, maskPatchY);
-
-                compositeOp->composite(maskPatchIt->rawDataConst(), maskPatchRowStride,
-                                       dabIt, dabRowStride,
-                                       columns, rows);
+        /**
+         * The patches of the mask are read directly from the pre-tiled
+         * mask, so the only wrapping happens when the dab crosses the
+         * border of the tiled area
+         */
+        auto wrap = [] (int value, int size) {
+            const int result = value % size;
+            return result < 0 ? result + size : result;
+        };
+
+        const quint8 *tiledMask = m_maskInfo->tiledMask();
+        const QSize tiledMaskSize = m_maskInfo->tiledMaskSize();
+        const qint32 tiledMaskRowStride = tiledMaskSize.width();
+
+        const qint32 dabRowStride = rect.width() * dab->pixelSize();
+
+        qint32 dabY = 0;
+        qint32 maskPatchY = wrap(y, maskBounds.height());
+
+        while (dabY < rect.height()) {
+            const qint32 rows = std::min(rect.height() - dabY, tiledMaskSize.height() - maskPatchY);
+
+            qint32 dabX = 0;
+            qint32 maskPatchX = wrap(x, maskBounds.width());
+
+            while (dabX < rect.width()) {
+                const qint32 columns = std::min(rect.width() - dabX, tiledMaskSize.width() - maskPatchX);
+
+                const quint8 *maskPatchIt = tiledMask + maskPatchY * tiledMaskRowStride + maskPatchX;
+                quint8 *dabIt = dab->data() + dabY * dabRowStride + dabX * dab->pixelSize();
+
+                if (useMultiplyApplicator) {
+                    multiplyApplicator()->multiplyAlpha(maskPatchIt, tiledMaskRowStride,
+                                                        dabIt, dabRowStride,
+                                                        alphaChannelOffset, strength8, m_useSoftTexturing,
+                                                        columns, rows);
+                } else {
+                    compositeOp->composite(maskPatchIt, tiledMaskRowStride,
+                                           dabIt, dabRowStride,
+                                           columns, rows);
+                }
 
                 dabX += columns;
-                maskPatchX += columns;
-                columnsRemaining -= columns;
-
+                maskPatchX = wrap(maskPatchX + columns, maskBounds.width());
             }
 
             dabY += rows;
-            maskPatchY += rows;
-            rowsRemaining -= rows;
+            maskPatchY = wrap(maskPatchY + rows, maskBounds.height());
         }
     }
 }
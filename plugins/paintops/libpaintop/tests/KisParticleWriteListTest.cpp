@@ -0,0 +1,119 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisParticleWriteListTest.h"
+
+#include <QRandomGenerator>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include <kis_paint_device.h>
+#include <qimage_test_util.h>
+
+#include "KisParticleWriteList.h"
+
+namespace {
+
+QVector<KisParticleWriteList> generateLists(const KoColorSpace *cs, int numLists, int numPixels)
+{
+    QRandomGenerator random(42);
+    QVector<KisParticleWriteList> lists;
+
+    for (int i = 0; i < numLists; i++) {
+        KisParticleWriteList list(cs);
+
+        for (int j = 0; j < numPixels; j++) {
+            // the pixels overlap a lot and cross the tile rows, including the negative ones
+            const int x = random.bounded(-100, 100);
+            const int y = random.bounded(-150, 150);
+
+            KoColor color(QColor(random.bounded(256), random.bounded(256),
+                                 random.bounded(256), random.bounded(256)), cs);
+
+            list.addPixel(x, y, color.data());
+        }
+
+        lists.append(list);
+    }
+
+    return lists;
+}
+
+}
+
+void KisParticleWriteListTest::testMergeDoesNotDependOnRowSets_data()
+{
+    QTest::addColumn<int>("mode");
+
+    QTest::newRow("overwrite") << int(KisParticleWriteList::Overwrite);
+    QTest::newRow("add-opacity") << int(KisParticleWriteList::AddOpacity);
+}
+
+void KisParticleWriteListTest::testMergeDoesNotDependOnRowSets()
+{
+    QFETCH(int, mode);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QVector<KisParticleWriteList> lists = generateLists(cs, 5, 3000);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    KisParticleWriteList::mergeRowSet(lists, 0, 1, reference, KisParticleWriteList::WriteMode(mode));
+
+    QRect bounds;
+    Q_FOREACH (const KisParticleWriteList &list, lists) {
+        bounds |= list.bounds();
+    }
+    QCOMPARE(reference->exactBounds(), bounds);
+
+    for (int numRowSets = 2; numRowSets <= 7; numRowSets++) {
+        KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+        // the order of the row sets doesn't matter, they never share the pixels
+        for (int rowSet = numRowSets - 1; rowSet >= 0; rowSet--) {
+            KisParticleWriteList::mergeRowSet(lists, rowSet, numRowSets, dev, KisParticleWriteList::WriteMode(mode));
+        }
+
+        QImage refImage = reference->convertToQImage(0, bounds);
+        QImage image = dev->convertToQImage(0, bounds);
+
+        QPoint errorPoint;
+        QVERIFY2(TestUtil::compareQImages(errorPoint, refImage, image),
+                 qPrintable(QString("numRowSets %1 differs at %2,%3")
+                            .arg(numRowSets).arg(errorPoint.x()).arg(errorPoint.y())));
+    }
+}
+
+void KisParticleWriteListTest::testAddOpacitySaturates()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KoColor color(QColor(10, 20, 30, 100), cs);
+    KisParticleWriteList list(cs);
+
+    for (int i = 0; i < 3; i++) {
+        list.addPixel(70, -5, color.data());
+    }
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    KisParticleWriteList::mergeRowSet({list}, 0, 1, dev, KisParticleWriteList::AddOpacity);
+
+    QCOMPARE(dev->exactBounds(), QRect(70, -5, 1, 1));
+
+    KoColor result;
+    dev->pixel(70, -5, &result);
+
+    KoColor expected(QColor(10, 20, 30, 255), cs);
+    QCOMPARE(result, expected);
+
+    // the Overwrite mode keeps the last value
+    KisPaintDeviceSP dev2 = new KisPaintDevice(cs);
+    KisParticleWriteList::mergeRowSet({list}, 0, 1, dev2, KisParticleWriteList::Overwrite);
+    dev2->pixel(70, -5, &result);
+    QCOMPARE(result, color);
+}
+
+SIMPLE_TEST_MAIN(KisParticleWriteListTest)
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KISPARTICLEWRITELISTTEST_H
+#define KISPARTICLEWRITELISTTEST_H
+
+#include <simpletest.h>
+
+class KisParticleWriteListTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testMergeDoesNotDependOnRowSets_data();
+    void testMergeDoesNotDependOnRowSets();
+    void testAddOpacitySaturates();
+};
+
+#endif // KISPARTICLEWRITELISTTEST_H
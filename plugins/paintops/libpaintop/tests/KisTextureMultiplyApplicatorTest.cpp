@@ -0,0 +1,81 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "KisTextureMultiplyApplicatorTest.h"
+
+#include <QRandomGenerator>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <KoCompositeOpRegistry.h>
+#include <KoColorSpaceMaths.h>
+#include <strokes/KisMaskingBrushCompositeOpBase.h>
+#include <strokes/KisMaskingBrushCompositeOpFactory.h>
+
+#include "KisTextureMultiplyApplicator.h"
+
+void KisTextureMultiplyApplicatorTest::testMatchesCompositeOp_data()
+{
+    QTest::addColumn<qreal>("strength");
+    QTest::addColumn<bool>("useSoftTexturing");
+    QTest::addColumn<int>("alphaOffset");
+
+    QTest::newRow("full") << 1.0 << false << 3;
+    QTest::newRow("half") << 0.5 << false << 3;
+    QTest::newRow("zero") << 0.0 << false << 3;
+    QTest::newRow("soft-full") << 1.0 << true << 3;
+    QTest::newRow("soft-half") << 0.3 << true << 3;
+    QTest::newRow("alpha-first") << 0.7 << false << 0;
+    QTest::newRow("soft-alpha-first") << 0.7 << true << 0;
+}
+
+void KisTextureMultiplyApplicatorTest::testMatchesCompositeOp()
+{
+    QFETCH(qreal, strength);
+    QFETCH(bool, useSoftTexturing);
+    QFETCH(int, alphaOffset);
+
+    // odd sizes check the tails of the vectorized rows
+    const int columns = 67;
+    const int rows = 13;
+    const int maskRowStride = columns + 5;
+    const int dabRowStride = columns * 4;
+
+    QRandomGenerator random(42);
+
+    QVector<quint8> mask(maskRowStride * rows);
+    for (quint8 &value : mask) {
+        value = quint8(random.bounded(256));
+    }
+
+    QVector<quint8> dab(dabRowStride * rows);
+    for (quint8 &value : dab) {
+        value = quint8(random.bounded(256));
+    }
+
+    QVector<quint8> referenceDab = dab;
+
+    QScopedPointer<KisMaskingBrushCompositeOpBase> compositeOp(
+        KisMaskingBrushCompositeOpFactory::createForAlphaSrc(
+            COMPOSITE_MULT, KoChannelInfo::UINT8, 4,
+            alphaOffset, strength, useSoftTexturing));
+
+    compositeOp->composite(mask.constData(), maskRowStride,
+                           referenceDab.data(), dabRowStride,
+                           columns, rows);
+
+    QScopedPointer<KisTextureMultiplyApplicatorBase> applicator(
+        createOptimizedClass<KisTextureMultiplyApplicatorFactory>());
+
+    applicator->multiplyAlpha(mask.constData(), maskRowStride,
+                              dab.data(), dabRowStride,
+                              alphaOffset, KoColorSpaceMaths<qreal, quint8>::scaleToA(strength),
+                              useSoftTexturing,
+                              columns, rows);
+
+    QCOMPARE(dab, referenceDab);
+}
+
+SIMPLE_TEST_MAIN(KisTextureMultiplyApplicatorTest)
@@ -0,0 +1,19 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef KISTEXTUREMULTIPLYAPPLICATORTEST_H
+#define KISTEXTUREMULTIPLYAPPLICATORTEST_H
+
+#include <simpletest.h>
+
+class KisTextureMultiplyApplicatorTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testMatchesCompositeOp_data();
+    void testMatchesCompositeOp();
+};
+
+#endif // KISTEXTUREMULTIPLYAPPLICATORTEST_H
@@ -20,8 +20,13 @@
 #include <kis_paintop_plugin_utils.h>
 #include <kis_paintop_settings.h>
 #include <kis_spacing_information.h>
+#include <kis_image_config.h>
 #include <libmypaint/mypaint-brush.h>
 
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisFakeRunnableStrokeJobsExecutor.h>
+
 KisMyPaintPaintOp::KisMyPaintPaintOp(const KisPaintOpSettingsSP settings, KisPainter *painter, KisNodeSP /*node*/, KisImageSP image)
     : KisPaintOp (painter) {
 
@@ -50,6 +55,24 @@ KisMyPaintPaintOp::KisMyPaintPaintOp(const KisPaintOpSettingsSP settings, KisPai
     m_dtime = -1;
     m_isStrokeStarted = false;
     m_radius = exp(mypaint_brush_get_base_value(m_brush->brush(), MYPAINT_BRUSH_SETTING_RADIUS_LOGARITHMIC));
+
+    /**
+     * A painter that is not a part of a stroke runs its jobs right away,
+     * and nobody would call doAsynchronousUpdate() for it
+     */
+    m_useAsynchronousRendering =
+        settings->needsAsynchronousUpdates() &&
+        !dynamic_cast<KisFakeRunnableStrokeJobsExecutor*>(painter->runnableStrokeJobsInterface());
+
+    if (m_useAsynchronousRendering) {
+        m_surface->setBatchingEnabled(true);
+
+        KisImageConfig cfg(true);
+        m_idealNumRenderingJobs = cfg.maxNumberOfThreads();
+
+        // the queued events are rendered as often as the canvas is updated
+        m_updatePeriod = 1000 / cfg.fpsLimit();
+    }
 }
 
 KisMyPaintPaintOp::~KisMyPaintPaintOp() {
@@ -63,6 +86,20 @@ KisSpacingInformation KisMyPaintPaintOp::paintAt(const KisPaintInformation& info
 
     const qreal lodScale = KisLodTransform::lodToScale(painter()->device());
 
+    if (m_useAsynchronousRendering) {
+        QMutexLocker l(&m_eventsQueueMutex);
+        m_eventsQueue.append(info);
+    } else {
+        strokeTo(info);
+    }
+
+    return computeSpacing(info, lodScale);
+}
+
+void KisMyPaintPaintOp::strokeTo(const KisPaintInformation &info)
+{
+    const qreal lodScale = KisLodTransform::lodToScale(painter()->device());
+
     qreal radius = m_radius;
     radius *= lodScale;
     mypaint_brush_set_base_value(m_brush->brush(), MYPAINT_BRUSH_SETTING_RADIUS_LOGARITHMIC, log(radius));
@@ -83,8 +120,69 @@ KisSpacingInformation KisMyPaintPaintOp::paintAt(const KisPaintInformation& info
                            info.xTilt(), info.yTilt(), m_dtime);
 
     m_previousTime = info.currentTime();
+}
 
-    return computeSpacing(info, lodScale);
+std::pair<int, bool> KisMyPaintPaintOp::doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    if (!m_useAsynchronousRendering) {
+        return KisPaintOp::doAsynchronousUpdate(jobs);
+    }
+
+    bool someEventsAreStillInQueue = false;
+
+    QMutexLocker l(&m_eventsQueueMutex);
+
+    /**
+     * The jobs of the next update are put in front of the jobs of the
+     * previous one, so we should not start a new update until the
+     * previous one has finished.
+     */
+    if (!m_updateInProgress && !m_eventsQueue.isEmpty()) {
+        m_updateInProgress = true;
+
+        QVector<KisPaintInformation> events;
+        events.swap(m_eventsQueue);
+        l.unlock();
+
+        /**
+         * libmypaint may sample the surface color while generating the
+         * dabs, so the events are processed sequentially. The surface
+         * renders the dabs queued so far itself in such a case.
+         */
+        KritaUtils::addJobSequential(jobs,
+            [events, this] () {
+                Q_FOREACH (const KisPaintInformation &info, events) {
+                    strokeTo(info);
+                }
+
+                m_surface->prepareBatch();
+            }
+        );
+
+        const int numJobs = m_idealNumRenderingJobs;
+
+        for (int i = 0; i < numJobs; i++) {
+            KritaUtils::addJobConcurrent(jobs,
+                [i, numJobs, this] () {
+                    m_surface->renderBatchTiles(i, numJobs);
+                }
+            );
+        }
+
+        KritaUtils::addJobSequential(jobs,
+            [this] () {
+                m_surface->finishBatch();
+
+                QMutexLocker l(&m_eventsQueueMutex);
+                m_updateInProgress = false;
+            }
+        );
+
+    } else if (m_updateInProgress && !m_eventsQueue.isEmpty()) {
+        someEventsAreStillInQueue = true;
+    }
+
+    return std::make_pair(m_updatePeriod, someEventsAreStillInQueue);
 }
 
 KisSpacingInformation KisMyPaintPaintOp::updateSpacingImpl(const KisPaintInformation &info) const
@@ -7,8 +7,11 @@
 #ifndef KIS_MY_PAINTOP_H_
 #define KIS_MY_PAINTOP_H_
 
+#include <QMutex>
+
 #include <kis_types.h>
 #include <brushengine/kis_paintop.h>
+#include <brushengine/kis_paint_information.h>
 
 #include <libmypaint/mypaint-brush.h>
 #include <KisAirbrushOptionData.h>
@@ -27,6 +30,8 @@ public:
     KisMyPaintPaintOp(const KisPaintOpSettingsSP settings, KisPainter * painter, KisNodeSP node, KisImageSP image);
     ~KisMyPaintPaintOp() override;
 
+    std::pair<int, bool> doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs) override;
+
 protected:
 
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
@@ -37,6 +42,7 @@ protected:
 
 private:
     KisSpacingInformation computeSpacing(const KisPaintInformation &info, qreal lodScale) const;
+    void strokeTo(const KisPaintInformation &info);
 
 private:
     QScopedPointer<KisMyPaintPaintOpPreset> m_brush;
@@ -46,6 +52,18 @@ private:
     KisImageWSP m_image;
     double m_dtime, m_radius, m_previousTime = 0;
     bool m_isStrokeStarted;
+
+    /**
+     * When painting in a stroke, paintAt() only queues the events. They
+     * are passed to libmypaint in the jobs of doAsynchronousUpdate(), and
+     * the generated dabs are rendered there concurrently
+     */
+    bool m_useAsynchronousRendering {false};
+    QMutex m_eventsQueueMutex;
+    QVector<KisPaintInformation> m_eventsQueue;
+    bool m_updateInProgress {false};
+    int m_idealNumRenderingJobs {1};
+    int m_updatePeriod {10};
 };
 
 #endif // KIS_MY_PAINTOP_H_
@@ -132,6 +132,11 @@ bool KisMyPaintOpSettings::paintIncremental()
     return true;
 }
 
+bool KisMyPaintOpSettings::needsAsynchronousUpdates() const
+{
+    return true;
+}
+
 void KisMyPaintOpSettings::resetSettings(const QStringList &preserveProperties)
 {
     QStringList allKeys = preserveProperties;
@@ -19,6 +19,8 @@
 #include <qmath.h>
 #include <KoCompositeOpRegistry.h>
 #include <KoMixColorsOp.h>
+#include <kis_default_bounds_base.h>
+#include <QHash>
 
 using namespace std;
 
@@ -38,6 +40,7 @@ KisMyPaintSurface::KisMyPaintSurface(KisPainter *painter, KisPaintDeviceSP paint
     , m_backgroundPainter(new KisPainter(m_precisePainterWrapper.createPreciseCompositionSourceDevice()))
 {
     m_blendDevice = KisFixedPaintDeviceSP(new KisFixedPaintDevice(m_precisePainterWrapper.overlayColorSpace()));
+    m_dabBufferDevice = KisFixedPaintDeviceSP(new KisFixedPaintDevice(m_precisePainterWrapper.overlayColorSpace()));
 
     m_backgroundPainter->setCompositeOpId(COMPOSITE_COPY);
     m_backgroundPainter->setOpacity(OPACITY_OPAQUE_U8);
@@ -98,6 +101,12 @@ void KisMyPaintSurface::get_color(MyPaintSurface *self, float x, float y, float
                             float * color_r, float * color_g, float * color_b, float * color_a) {
 
     MyPaintSurfaceInternal *surface = static_cast<MyPaintSurfaceInternal*>(self);
+
+    // the color should be sampled from the result of all the dabs painted so far
+    if (surface->m_owner->hasQueuedDabs()) {
+        surface->m_owner->flushQueuedDabs();
+    }
+
     if (surface->bitDepth == KoChannelInfo::UINT8) {
         surface->m_owner->getColorImpl<quint8>(self, x, y, radius, color_r, color_g, color_b, color_a);
     }
@@ -122,38 +131,101 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
                                 float aspect_ratio, float angle, float lock_alpha, float colorize) {
 
     Q_UNUSED(self);
-    Q_UNUSED(lock_alpha);
+
+    const DabParams dab = createDab(x, y, radius, color_r, color_g, color_b, opaque, hardness,
+                                    color_a, aspect_ratio, angle, lock_alpha, colorize);
+
+    if (m_batchingEnabled) {
+        m_queuedDabs.append(dab);
+        return 1;
+    }
+
+    const QRect dabRectAligned = dab.rect;
+
+    m_precisePainterWrapper.readRects(m_tempPainter->calculateAllMirroredRects(dabRectAligned));
+
+    m_dabBufferDevice->setRect(dabRectAligned);
+    m_dabBufferDevice->lazyGrowBufferWithoutInitialization();
+    m_tempPainter->device()->readBytes(m_dabBufferDevice->data(), dabRectAligned);
+
+    m_maskDevice->setRect(dabRectAligned);
+    m_maskDevice->lazyGrowBufferWithoutInitialization();
+
+    blendDabIntoBuffer<channelType>(dab, m_dabBufferDevice->data(), dabRectAligned,
+                                    dabRectAligned, m_maskDevice->data());
+
+    m_dab->writeBytes(m_dabBufferDevice->data(), dabRectAligned);
+
+    m_tempPainter->bitBltWithFixedSelection(dabRectAligned.x(), dabRectAligned.y(), m_dab, m_maskDevice, dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.width(), dabRectAligned.height());
+    m_tempPainter->renderMirrorMask(dabRectAligned, m_dab, dabRectAligned.x(), dabRectAligned.y(), m_maskDevice);
+    const QVector<QRect> dirtyRects = m_tempPainter->takeDirtyRegion();
+    m_precisePainterWrapper.writeRects(dirtyRects);
+    painter()->addDirtyRects(dirtyRects);
+    return 1;
+}
+
+KisMyPaintSurface::DabParams KisMyPaintSurface::createDab(float x, float y, float radius,
+                                                          float color_r, float color_g, float color_b, float opaque, float hardness,
+                                                          float color_a, float aspect_ratio, float angle, float lock_alpha,
+                                                          float colorize)
+{
+    DabParams dab;
+
+    dab.x = x;
+    dab.y = y;
+    dab.radius = radius;
+    dab.color_r = color_r;
+    dab.color_g = color_g;
+    dab.color_b = color_b;
+    dab.opaque = opaque;
+    dab.hardness = hardness;
+    dab.color_a = color_a;
+    dab.aspect_ratio = aspect_ratio;
+    dab.angle = angle;
+    dab.lock_alpha = lock_alpha;
+    dab.colorize = colorize;
+
+    const QPoint pt = QPoint(x - radius - 1, y - radius - 1);
+    const QSize sz = QSize(2 * (radius+1), 2 * (radius+1));
+    dab.rect = QRect(pt, sz);
+
+    return dab;
+}
+
+template <typename channelType>
+void KisMyPaintSurface::blendDabIntoBuffer(const DabParams &dab, quint8 *buffer, const QRect &bufferRect,
+                                           const QRect &processRect, quint8 *mask) {
+
+    const float x = dab.x;
+    const float y = dab.y;
+    const float radius = dab.radius;
+    const float color_r = dab.color_r;
+    const float color_g = dab.color_g;
+    const float color_b = dab.color_b;
+    const float color_a = dab.color_a;
+    const float opaque = dab.opaque;
+
     const float one_over_radius2 = 1.0f / (radius * radius);
-    const double angle_rad = kisDegreesToRadians(angle);
+    const double angle_rad = kisDegreesToRadians(dab.angle);
     const float cs = cos(angle_rad);
     const float sn = sin(angle_rad);
-    float normal_mode;
     float segment1_slope;
     float segment2_slope;
     float r_aa_start;
 
-    hardness = CLAMP (hardness, 0.0f, 1.0f);
+    const float hardness = CLAMP (dab.hardness, 0.0f, 1.0f);
     segment1_slope = -(1.0f / hardness - 1.0f);
     segment2_slope = -hardness / (1.0f - hardness);
-    aspect_ratio = max(1.0f, aspect_ratio);
+    const float aspect_ratio = max(1.0f, dab.aspect_ratio);
 
     r_aa_start = radius - 1.0f;
     r_aa_start = max(r_aa_start, 0.0f);
     r_aa_start = (r_aa_start * r_aa_start) / aspect_ratio;
 
-    normal_mode = opaque * (1.0f - colorize);
-    colorize = opaque * colorize;
+    const float normal_mode = opaque * (1.0f - dab.colorize);
+    const float colorize = opaque * dab.colorize;
 
-    const QPoint pt = QPoint(x - radius - 1, y - radius - 1);
-    const QSize sz = QSize(2 * (radius+1), 2 * (radius+1));
-
-    const QRect dabRectAligned = QRect(pt, sz);
-    const QPointF center = QPointF(x, y);
-
-    KisAlgebra2D::OuterCircle outer(center, radius);
-    m_precisePainterWrapper.readRects(m_tempPainter->calculateAllMirroredRects(dabRectAligned));
-    m_tempPainter->copyAreaOptimized(dabRectAligned.topLeft(), m_tempPainter->device(), m_dab, dabRectAligned);
-    KisSequentialIterator it(m_dab, dabRectAligned);
+    KisAlgebra2D::OuterCircle outer(QPointF(x, y), radius);
 
     quint8 maskUnitValue = KoColorSpaceMathsTraits<quint8>::unitValue; // because it's alpha8
 
@@ -161,118 +233,111 @@ int KisMyPaintSurface::drawDabImpl(MyPaintSurface *self, float x, float y, float
     float minValue = KoColorSpaceMathsTraits<channelType>::min;
     bool eraser = painter()->compositeOpId() == COMPOSITE_ERASE;
 
+    const int pixelSize = m_precisePainterWrapper.overlayColorSpace()->pixelSize();
 
-    m_maskDevice->setRect(dabRectAligned);
-    m_maskDevice->lazyGrowBufferWithoutInitialization();
-
-
-    // Dmitry says that going with the pointer should be in the same order
-    // as using the sequential iterator
-    quint8* maskPointer = m_maskDevice->data();
+    for (int yp = processRect.top(); yp <= processRect.bottom(); yp++) {
+        const int rowOffset = (yp - bufferRect.top()) * bufferRect.width() + processRect.left() - bufferRect.left();
 
+        quint8 *pixelPtr = buffer + rowOffset * pixelSize;
+        quint8 *maskPtr = mask ? mask + rowOffset : nullptr;
 
-    while(it.nextPixel()) {
+        for (int xp = processRect.left(); xp <= processRect.right(); xp++, pixelPtr += pixelSize) {
+            quint8 *maskValue = maskPtr ? maskPtr++ : nullptr;
 
-        // first initialize to 0;
-        *maskPointer = 0;
+            // first initialize to 0;
+            if (maskValue) {
+                *maskValue = 0;
+            }
 
-        QPoint pt(it.x(), it.y());
+            if(outer.fadeSq(QPoint(xp, yp)) > 1.0f) {
+                continue;
+            }
 
-        if(outer.fadeSq(pt) > 1.0f) {
-            maskPointer++;
-            continue;
-        }
+            float rr, base_alpha, alpha, dst_alpha, r, g, b, a;
 
-        float rr, base_alpha, alpha, dst_alpha, r, g, b, a;
+            if (radius < 3.0) {
+                rr = calculate_rr_antialiased (xp, yp, x, y, aspect_ratio, sn, cs, one_over_radius2, r_aa_start);
+            }
+            else {
+                rr = calculate_rr (xp, yp, x, y, aspect_ratio, sn, cs, one_over_radius2);
+            }
 
-        if (radius < 3.0) {
-            rr = calculate_rr_antialiased (it.x(), it.y(), x, y, aspect_ratio, sn, cs, one_over_radius2, r_aa_start);
-        }
-        else {
-            rr = calculate_rr (it.x(), it.y(), x, y, aspect_ratio, sn, cs, one_over_radius2);
-        }
+            base_alpha = calculate_alpha_for_rr (rr, hardness, segment1_slope, segment2_slope);
 
-        base_alpha = calculate_alpha_for_rr (rr, hardness, segment1_slope, segment2_slope);
+            alpha = base_alpha * normal_mode;
 
-        m_tempPainter->selection();
-        alpha = base_alpha * normal_mode;
+            // the pixels outside the mask never reach the device,
+            // so there is no need to blend them
+            if (!(alpha > minValue)) {
+                continue;
+            }
 
-        // set alpha to mask
-        if (alpha > minValue) {
-            *maskPointer = (quint8)(maskUnitValue);
-        }
+            if (maskValue) {
+                *maskValue = maskUnitValue;
+            }
 
-        channelType* nativeArray = reinterpret_cast<channelType*>(it.rawData());
+            channelType* nativeArray = reinterpret_cast<channelType*>(pixelPtr);
 
-        b = nativeArray[0]/unitValue;
-        g = nativeArray[1]/unitValue;
-        r = nativeArray[2]/unitValue;
-        dst_alpha = nativeArray[3]/unitValue;
+            b = nativeArray[0]/unitValue;
+            g = nativeArray[1]/unitValue;
+            r = nativeArray[2]/unitValue;
+            dst_alpha = nativeArray[3]/unitValue;
 
-        if (unitValue == 1.0f) {
-            swap(b, r);
-        }
+            if (unitValue == 1.0f) {
+                swap(b, r);
+            }
 
-        a = alpha * (color_a - dst_alpha) + dst_alpha;
+            a = alpha * (color_a - dst_alpha) + dst_alpha;
 
-        if (eraser) {
-            alpha = 1 - (opaque*base_alpha);
-            a = dst_alpha * alpha ;
-        } else {
-            if (a > 0.0f) {
-                float src_term = (alpha * color_a) / a;
-                float dst_term = 1.0f - src_term;
-                r = color_r * src_term + r * dst_term;
-                g = color_g * src_term + g * dst_term;
-                b = color_b * src_term + b * dst_term;
-            }
+            if (eraser) {
+                alpha = 1 - (opaque*base_alpha);
+                a = dst_alpha * alpha ;
+            } else {
+                if (a > 0.0f) {
+                    float src_term = (alpha * color_a) / a;
+                    float dst_term = 1.0f - src_term;
+                    r = color_r * src_term + r * dst_term;
+                    g = color_g * src_term + g * dst_term;
+                    b = color_b * src_term + b * dst_term;
+                }
 
-            if (colorize > 0.0f && base_alpha > 0.0f) {
+                if (colorize > 0.0f && base_alpha > 0.0f) {
 
-                alpha = base_alpha * colorize;
-                a = alpha + dst_alpha - alpha * dst_alpha;
+                    alpha = base_alpha * colorize;
+                    a = alpha + dst_alpha - alpha * dst_alpha;
 
-                if (a > 0.0f) {
+                    if (a > 0.0f) {
 
-                    float pixel_h, pixel_s, pixel_l, out_h, out_s, out_l;
-                    float out_r = r, out_g = g, out_b = b;
+                        float pixel_h, pixel_s, pixel_l, out_h, out_s, out_l;
+                        float out_r = r, out_g = g, out_b = b;
 
-                    float src_term = alpha / a;
-                    float dst_term = 1.0f - src_term;
+                        float src_term = alpha / a;
+                        float dst_term = 1.0f - src_term;
 
-                    RGBToHSL(color_r, color_g, color_b, &pixel_h, &pixel_s, &pixel_l);
-                    RGBToHSL(out_r, out_g, out_b, &out_h, &out_s, &out_l);
+                        RGBToHSL(color_r, color_g, color_b, &pixel_h, &pixel_s, &pixel_l);
+                        RGBToHSL(out_r, out_g, out_b, &out_h, &out_s, &out_l);
 
-                    out_h = pixel_h;
-                    out_s = pixel_s;
+                        out_h = pixel_h;
+                        out_s = pixel_s;
 
-                    HSLToRGB(out_h, out_s, out_l, &out_r, &out_g, &out_b);
+                        HSLToRGB(out_h, out_s, out_l, &out_r, &out_g, &out_b);
 
-                    r = (float)out_r * src_term + r * dst_term;
-                    g = (float)out_g * src_term + g * dst_term;
-                    b = (float)out_b * src_term + b * dst_term;
+                        r = (float)out_r * src_term + r * dst_term;
+                        g = (float)out_g * src_term + g * dst_term;
+                        b = (float)out_b * src_term + b * dst_term;
+                    }
                 }
             }
-        }
 
-        if (unitValue == 1.0f) {
-            swap(b, r);
+            if (unitValue == 1.0f) {
+                swap(b, r);
+            }
+            nativeArray[0] = KoColorSpaceMaths<float, channelType>::scaleToA(b);
+            nativeArray[1] = KoColorSpaceMaths<float, channelType>::scaleToA(g);
+            nativeArray[2] = KoColorSpaceMaths<float, channelType>::scaleToA(r);
+            nativeArray[3] = KoColorSpaceMaths<float, channelType>::scaleToA(a);
         }
-        nativeArray[0] = KoColorSpaceMaths<float, channelType>::scaleToA(b);
-        nativeArray[1] = KoColorSpaceMaths<float, channelType>::scaleToA(g);
-        nativeArray[2] = KoColorSpaceMaths<float, channelType>::scaleToA(r);
-        nativeArray[3] = KoColorSpaceMaths<float, channelType>::scaleToA(a);
-
-        maskPointer++;
     }
-
-
-    m_tempPainter->bitBltWithFixedSelection(dabRectAligned.x(), dabRectAligned.y(), m_dab, m_maskDevice, dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.x(), dabRectAligned.y(), dabRectAligned.width(), dabRectAligned.height());
-    m_tempPainter->renderMirrorMask(dabRectAligned, m_dab, dabRectAligned.x(), dabRectAligned.y(), m_maskDevice);
-    const QVector<QRect> dirtyRects = m_tempPainter->takeDirtyRegion();
-    m_precisePainterWrapper.writeRects(dirtyRects);
-    painter()->addDirtyRects(dirtyRects);
-    return 1;
 }
 
 template <typename channelType>
@@ -300,54 +365,51 @@ void KisMyPaintSurface::getColorImpl(MyPaintSurface *self, float x, float y, flo
 
     m_precisePainterWrapper.readRect(dabRectAligned);
     KisPaintDeviceSP activeDev = m_precisePainterWrapper.overlay();
-    if(m_image) {
-        //m_image->blockUpdates();
-        m_backgroundPainter->device()->clear();
-        m_backgroundPainter->bitBlt(dabRectAligned.topLeft(), activeDev, dabRectAligned);
-        activeDev = m_backgroundPainter->device();
-        //m_image->unblockUpdates();
-    } else if (m_imageDevice) {
+
+    /**
+     * When painting on an image, the overlay is sampled directly: copying
+     * it into a cleared device first doesn't change the pixels.
+     */
+    if (!m_image && m_imageDevice) {
         m_backgroundPainter->bitBlt(dabRectAligned.topLeft(), m_imageDevice, dabRectAligned);
         activeDev = m_backgroundPainter->device();
-    } else {
-        m_precisePainterWrapper.readRect(dabRectAligned);
     }
 
-    KisSequentialIterator it(activeDev, dabRectAligned);
-    QVector<float> surface_color_vec = {0,0,0,0};
     float unitValue = KoColorSpaceMathsTraits<channelType>::unitValue;
     float maxValue = KoColorSpaceMathsTraits<channelType>::max;
 
-    quint32 size = dabRectAligned.width() * dabRectAligned.height();
+    const quint32 size = dabRectAligned.width() * dabRectAligned.height();
     m_blendDevice->setRect(dabRectAligned);
     m_blendDevice->lazyGrowBufferWithoutInitialization();
 
-
-    qint16* weights = new qint16[size];
-    quint32 num_colors = 0;
+    m_colorWeights.resize(size);
+    qint16* weights = m_colorWeights.data();
 
     activeDev->readBytes(m_blendDevice->data(), dabRectAligned);
 
-    while(it.nextPixel()) {
+    // the weights go in the same order as the pixels returned by readBytes()
+    for (int yp = dabRectAligned.top(); yp <= dabRectAligned.bottom(); yp++) {
+        for (int xp = dabRectAligned.left(); xp <= dabRectAligned.right(); xp++) {
 
-        QPointF pt(it.x(), it.y());
+            QPointF pt(xp, yp);
 
-        float rr = 0.0;
-        if(outer.fadeSq(pt) <= 1.0) {
-            /* pixel_weight == a standard dab with hardness = 0.5, aspect_ratio = 1.0, and angle = 0.0 */
-            float yy = (it.y() + 0.5f - y);
-            float xx = (it.x() + 0.5f - x);
+            float rr = 0.0;
+            if(outer.fadeSq(pt) <= 1.0) {
+                /* pixel_weight == a standard dab with hardness = 0.5, aspect_ratio = 1.0, and angle = 0.0 */
+                float yy = (yp + 0.5f - y);
+                float xx = (xp + 0.5f - x);
 
-            rr = qMax((yy * yy + xx * xx) * one_over_radius2, 0.0f);
-        }
+                rr = qMax((yy * yy + xx * xx) * one_over_radius2, 0.0f);
+            }
 
-        weights[num_colors] = qRound((1.0f - rr) * 255);
-        sum_weight += weights[num_colors];
-        num_colors += 1;
+            *weights = qRound((1.0f - rr) * 255);
+            sum_weight += *weights;
+            weights++;
+        }
     }
 
     KoColor color = KoColor::createTransparent(activeDev->colorSpace());
-    activeDev->colorSpace()->mixColorsOp()->mixColors(m_blendDevice->data(), weights, size, color.data(), sum_weight);
+    activeDev->colorSpace()->mixColorsOp()->mixColors(m_blendDevice->data(), m_colorWeights.constData(), size, color.data(), sum_weight);
 
     if (sum_weight > 0.0f) {
         qreal r, g, b, a;
@@ -369,8 +431,148 @@ void KisMyPaintSurface::getColorImpl(MyPaintSurface *self, float x, float y, flo
             *color_a = CLAMP(a, 0.0f, 1.0f);
         }
     }
+}
+
+bool KisMyPaintSurface::batchingIsSupported() const
+{
+    const QBitArray channelFlags = m_painter->channelFlags();
+
+    return !m_painter->selection() &&
+        !m_painter->hasMirroring() &&
+        (channelFlags.isEmpty() || channelFlags.count(true) == channelFlags.size()) &&
+        !m_painter->device()->defaultBounds()->wrapAroundMode();
+}
+
+void KisMyPaintSurface::setBatchingEnabled(bool value)
+{
+    if (!value && hasQueuedDabs()) {
+        flushQueuedDabs();
+    }
+
+    m_batchingEnabled = value && batchingIsSupported();
+}
+
+bool KisMyPaintSurface::batchingEnabled() const
+{
+    return m_batchingEnabled;
+}
+
+bool KisMyPaintSurface::hasQueuedDabs() const
+{
+    return !m_queuedDabs.isEmpty();
+}
+
+void KisMyPaintSurface::prepareBatch()
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(m_batchDabs.isEmpty());
+
+    m_batchDabs.swap(m_queuedDabs);
+    m_queuedDabs.clear();
+    m_batchTiles.clear();
+
+    /**
+     * The tiles are aligned to the tiles of the paint device, so
+     * the concurrent jobs never write into the same tile
+     */
+    const int tileSize = 64;
+
+    QHash<quint64, int> tileIndexes;
+
+    for (int i = 0; i < m_batchDabs.size(); i++) {
+        const QRect rc = m_batchDabs[i].rect;
+        if (rc.isEmpty()) continue;
+
+        const int firstTileRow = qFloor(qreal(rc.top()) / tileSize);
+        const int lastTileRow = qFloor(qreal(rc.bottom()) / tileSize);
+        const int firstTileColumn = qFloor(qreal(rc.left()) / tileSize);
+        const int lastTileColumn = qFloor(qreal(rc.right()) / tileSize);
+
+        for (int row = firstTileRow; row <= lastTileRow; row++) {
+            for (int column = firstTileColumn; column <= lastTileColumn; column++) {
+                const quint64 key = (quint64(quint32(row)) << 32) | quint32(column);
+
+                int tileIndex = tileIndexes.value(key, -1);
+                if (tileIndex < 0) {
+                    tileIndex = m_batchTiles.size();
+                    tileIndexes.insert(key, tileIndex);
+                    m_batchTiles.append(BatchTile());
+                }
+
+                BatchTile &tile = m_batchTiles[tileIndex];
+                tile.rect |= rc & QRect(column * tileSize, row * tileSize, tileSize, tileSize);
+                tile.dabs.append(i);
+            }
+        }
+    }
+
+    QVector<QRect> tileRects;
+    tileRects.reserve(m_batchTiles.size());
+    Q_FOREACH (const BatchTile &tile, m_batchTiles) {
+        tileRects.append(tile.rect);
+    }
+
+    m_precisePainterWrapper.readRects(tileRects);
+}
+
+void KisMyPaintSurface::renderBatchTiles(int jobIndex, int numJobs)
+{
+    // the neighbouring tiles go to different jobs to balance the load
+    for (int i = jobIndex; i < m_batchTiles.size(); i += numJobs) {
+        const BatchTile &tile = m_batchTiles[i];
 
-    delete [] weights;
+        if (m_surface->bitDepth == KoChannelInfo::UINT8) {
+            renderBatchTileImpl<quint8>(tile);
+        }
+        else if (m_surface->bitDepth == KoChannelInfo::UINT16) {
+            renderBatchTileImpl<quint16>(tile);
+        }
+#if defined HAVE_OPENEXR
+        else if (m_surface->bitDepth == KoChannelInfo::FLOAT16) {
+            renderBatchTileImpl<half>(tile);
+        }
+#endif
+        else {
+            renderBatchTileImpl<float>(tile);
+        }
+    }
+}
+
+template <typename channelType>
+void KisMyPaintSurface::renderBatchTileImpl(const BatchTile &tile)
+{
+    KisPaintDeviceSP device = m_precisePainterWrapper.overlay();
+
+    QVector<quint8> buffer(tile.rect.width() * tile.rect.height() * device->pixelSize());
+    device->readBytes(buffer.data(), tile.rect);
+
+    Q_FOREACH (int dabIndex, tile.dabs) {
+        const DabParams &dab = m_batchDabs[dabIndex];
+        blendDabIntoBuffer<channelType>(dab, buffer.data(), tile.rect, dab.rect & tile.rect, nullptr);
+    }
+
+    device->writeBytes(buffer.data(), tile.rect);
+}
+
+void KisMyPaintSurface::finishBatch()
+{
+    QVector<QRect> dirtyRects;
+    dirtyRects.reserve(m_batchTiles.size());
+    Q_FOREACH (const BatchTile &tile, m_batchTiles) {
+        dirtyRects.append(tile.rect);
+    }
+
+    m_precisePainterWrapper.writeRects(dirtyRects);
+    painter()->addDirtyRects(dirtyRects);
+
+    m_batchDabs.clear();
+    m_batchTiles.clear();
+}
+
+void KisMyPaintSurface::flushQueuedDabs()
+{
+    prepareBatch();
+    renderBatchTiles(0, 1);
+    finishBatch();
 }
 
 KisPainter* KisMyPaintSurface::painter() {
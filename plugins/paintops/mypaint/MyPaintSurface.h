@@ -76,6 +76,73 @@ public:
 
     MyPaintSurface* surface();
 
+    /**
+     * In the batching mode draw_dab() doesn't paint anything, the dabs are
+     * only queued. The queued dabs are rasterized tile by tile, the tiles
+     * can be rendered concurrently:
+     *
+     * 1) prepareBatch() takes the queued dabs and splits them into
+     *    tiles (sequential)
+     *
+     * 2) renderBatchTiles() renders a subset of the tiles (concurrent)
+     *
+     * 3) finishBatch() writes the result into the painter's device (sequential)
+     *
+     * get_color() renders all the queued dabs before sampling the color.
+     *
+     * The batching mode is not available when the painter has a selection,
+     * channel flags or mirroring, or when the device is in the wrap-around
+     * mode. draw_dab() paints the dabs immediately then.
+     */
+    void setBatchingEnabled(bool value);
+    bool batchingEnabled() const;
+
+    bool hasQueuedDabs() const;
+
+    void prepareBatch();
+    void renderBatchTiles(int jobIndex, int numJobs);
+    void finishBatch();
+
+    /**
+     * Renders all the queued dabs in the current thread
+     */
+    void flushQueuedDabs();
+
+private:
+    struct DabParams {
+        float x, y, radius;
+        float color_r, color_g, color_b;
+        float opaque, hardness, color_a;
+        float aspect_ratio, angle, lock_alpha, colorize;
+
+        QRect rect;
+    };
+
+    struct BatchTile {
+        QRect rect;
+        QVector<int> dabs;
+    };
+
+    static DabParams createDab(float x, float y, float radius,
+                               float color_r, float color_g, float color_b, float opaque, float hardness,
+                               float color_a, float aspect_ratio, float angle, float lock_alpha,
+                               float colorize);
+
+    bool batchingIsSupported() const;
+
+    /**
+     * Blends the dab into the pixels of \p processRect of \p buffer, that
+     * contains the pixels of \p bufferRect of the overlay device. The pixels
+     * not covered by the dab are left untouched. If \p mask is not null,
+     * the covered pixels are also marked in it.
+     */
+    template <typename channelType>
+    void blendDabIntoBuffer(const DabParams &dab, quint8 *buffer, const QRect &bufferRect,
+                            const QRect &processRect, quint8 *mask);
+
+    template <typename channelType>
+    void renderBatchTileImpl(const BatchTile &tile);
+
 private:
     KisPainter *m_painter;
     KisPaintDeviceSP m_imageDevice;
@@ -87,6 +154,13 @@ private:
     QScopedPointer<KisPainter> m_backgroundPainter;
     KisFixedPaintDeviceSP m_blendDevice;
     KisFixedPaintDeviceSP m_maskDevice;
+    KisFixedPaintDeviceSP m_dabBufferDevice;
+    QVector<qint16> m_colorWeights;
+
+    bool m_batchingEnabled {false};
+    QVector<DabParams> m_queuedDabs;
+    QVector<DabParams> m_batchDabs;
+    QVector<BatchTile> m_batchTiles;
 
 };
 
@@ -0,0 +1,128 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_mypaintop_benchmark.h"
+
+#include <numeric>
+
+#include <simpletest.h>
+#include <QtConcurrent>
+#include <QtMath>
+
+#include <KoColorSpaceRegistry.h>
+#include <KisGlobalResourcesInterface.h>
+#include <kis_paint_device.h>
+#include <kis_painter.h>
+
+#include "MyPaintPaintOpPreset.h"
+#include "MyPaintSurface.h"
+
+namespace {
+
+/**
+ * The number of events the freehand stroke usually passes to the
+ * paintop during one update period (20ms of a 200Hz tablet)
+ */
+const int eventsPerUpdate = 4;
+
+void replayStroke(KisMyPaintSurface *surface, MyPaintBrush *brush,
+                  const QVector<KisMyPaintOpBenchmark::StrokeEvent> &events,
+                  bool useBatching, int numJobs)
+{
+    mypaint_brush_reset(brush);
+    mypaint_brush_new_stroke(brush);
+
+    for (int i = 0; i < events.size(); i++) {
+        const KisMyPaintOpBenchmark::StrokeEvent &e = events[i];
+
+        mypaint_brush_stroke_to(brush, surface->surface(),
+                                e.x, e.y, e.pressure, e.xTilt, e.yTilt, e.dtime);
+
+        if (useBatching && (i % eventsPerUpdate == eventsPerUpdate - 1 || i == events.size() - 1)) {
+            surface->prepareBatch();
+
+            QVector<int> jobIndexes(numJobs);
+            std::iota(jobIndexes.begin(), jobIndexes.end(), 0);
+
+            QtConcurrent::blockingMap(jobIndexes,
+                [surface, numJobs] (int jobIndex) {
+                    surface->renderBatchTiles(jobIndex, numJobs);
+                });
+
+            surface->finishBatch();
+        }
+    }
+}
+
+}
+
+void KisMyPaintOpBenchmark::initTestCase()
+{
+    /**
+     * A recording of a tablet stroke: a loose spiral drawn with
+     * a 200Hz tablet, the pressure ramps up and fades out at the end.
+     */
+    const int numEvents = 600;
+
+    for (int i = 0; i < numEvents; i++) {
+        const qreal t = qreal(i) / numEvents;
+        const qreal angle = 6.0 * M_PI * t;
+        const qreal radius = 100.0 + 600.0 * t;
+
+        StrokeEvent e;
+        e.x = 1000.0 + radius * std::cos(angle);
+        e.y = 1000.0 + radius * std::sin(angle);
+        e.pressure = qBound(0.0, qMin(4.0 * t, 4.0 * (1.0 - t)), 1.0);
+        e.xTilt = 0.2 * std::sin(angle);
+        e.yTilt = 0.2 * std::cos(angle);
+        e.dtime = 0.005;
+
+        m_events.append(e);
+    }
+}
+
+void KisMyPaintOpBenchmark::benchmarkReplay_data()
+{
+    QTest::addColumn<qreal>("radius");
+    QTest::addColumn<bool>("useBatching");
+
+    const QVector<qreal> radiuses = {5.0, 50.0, 150.0};
+
+    Q_FOREACH (qreal radius, radiuses) {
+        QTest::addRow("%dpx_immediate", int(radius)) << radius << false;
+        QTest::addRow("%dpx_batched", int(radius)) << radius << true;
+    }
+}
+
+void KisMyPaintOpBenchmark::benchmarkReplay()
+{
+    QFETCH(qreal, radius);
+    QFETCH(bool, useBatching);
+
+    QScopedPointer<KisMyPaintPaintOpPreset> preset(
+        new KisMyPaintPaintOpPreset(QString(FILES_DATA_DIR) + QDir::separator() + "basic.myb"));
+    preset->load(KisGlobalResourcesInterface::instance());
+    QVERIFY(preset->valid());
+
+    MyPaintBrush *brush = preset->brush();
+    mypaint_brush_set_base_value(brush, MYPAINT_BRUSH_SETTING_RADIUS_LOGARITHMIC, std::log(radius));
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP device = new KisPaintDevice(cs);
+    device->fill(QRect(0, 0, 2000, 2000), KoColor(Qt::white, cs));
+
+    KisPainter painter(device);
+    QScopedPointer<KisMyPaintSurface> surface(new KisMyPaintSurface(&painter, device));
+    surface->setBatchingEnabled(useBatching);
+
+    const int numJobs = QThread::idealThreadCount();
+
+    QBENCHMARK {
+        replayStroke(surface.data(), brush, m_events, useBatching, numJobs);
+    }
+}
+
+SIMPLE_TEST_MAIN(KisMyPaintOpBenchmark)
@@ -0,0 +1,42 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_MYPAINTOP_BENCHMARK_H
+#define KIS_MYPAINTOP_BENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+
+/**
+ * Replays a recorded stroke through libmypaint onto KisMyPaintSurface,
+ * either painting every dab immediately (the way the surface works outside
+ * of a stroke) or batching the dabs of every update and rendering them
+ * tile by tile concurrently (the way KisMyPaintPaintOp works in a stroke)
+ */
+class KisMyPaintOpBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    struct StrokeEvent {
+        float x;
+        float y;
+        float pressure;
+        float xTilt;
+        float yTilt;
+        double dtime;
+    };
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkReplay_data();
+    void benchmarkReplay();
+
+private:
+    QVector<StrokeEvent> m_events;
+};
+
+#endif // KIS_MYPAINTOP_BENCHMARK_H
@@ -79,6 +79,66 @@ void KisMyPaintOpTest::testGetColor() {
     QVERIFY(qFuzzyCompare((float)qRound(a), 1.0L));
 }
 
+void KisMyPaintOpTest::testBatchedDabs() {
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP refDevice = new KisPaintDevice(cs);
+    KisPaintDeviceSP batchedDevice = new KisPaintDevice(cs);
+
+    KisPainter refPainter(refDevice);
+    KisPainter batchedPainter(batchedDevice);
+
+    QScopedPointer<KisMyPaintSurface> refSurface(new KisMyPaintSurface(&refPainter, refDevice));
+    QScopedPointer<KisMyPaintSurface> batchedSurface(new KisMyPaintSurface(&batchedPainter, batchedDevice));
+
+    batchedSurface->setBatchingEnabled(true);
+    QVERIFY(batchedSurface->batchingEnabled());
+
+    auto drawDabs = [] (KisMyPaintSurface *surface) {
+        for (int i = 0; i < 20; i++) {
+            // the dabs overlap and cross the tile borders
+            surface->draw_dab(surface->surface(), 40 + 13 * i, 60 + 7 * i, 10 + 3 * i,
+                              0.1f * (i % 10), 0.5f, 1.0f - 0.05f * i,
+                              0.7f, 0.3f + 0.03f * i, 1.0f, 1.0f + 0.1f * i, 15.0f * i, 0, 0);
+        }
+    };
+
+    drawDabs(refSurface.data());
+    drawDabs(batchedSurface.data());
+
+    QVERIFY(batchedSurface->hasQueuedDabs());
+    QVERIFY(batchedDevice->extent().isEmpty());
+
+    batchedSurface->prepareBatch();
+    for (int i = 0; i < 3; i++) {
+        batchedSurface->renderBatchTiles(i, 3);
+    }
+    batchedSurface->finishBatch();
+
+    QVERIFY(!batchedSurface->hasQueuedDabs());
+
+    QPoint errpoint;
+    if (!TestUtil::comparePaintDevices(errpoint, refDevice, batchedDevice)) {
+        QFAIL(QString("Batched dabs differ from the immediate ones, first different pixel: %1,%2 \n").arg(errpoint.x()).arg(errpoint.y()).toLatin1());
+    }
+
+    // get_color() should see the queued dabs
+    drawDabs(batchedSurface.data());
+    drawDabs(refSurface.data());
+
+    float r1, g1, b1, a1;
+    float r2, g2, b2, a2;
+    refSurface->get_color(refSurface->surface(), 150, 120, 30, &r1, &g1, &b1, &a1);
+    batchedSurface->get_color(batchedSurface->surface(), 150, 120, 30, &r2, &g2, &b2, &a2);
+
+    QVERIFY(!batchedSurface->hasQueuedDabs());
+    QCOMPARE(r2, r1);
+    QCOMPARE(g2, g1);
+    QCOMPARE(b2, b1);
+    QCOMPARE(a2, a1);
+}
+
 void KisMyPaintOpTest::testLoading() {
 
     QScopedPointer<KisMyPaintPaintOpPreset> brush (new KisMyPaintPaintOpPreset(QString(FILES_DATA_DIR) + QDir::separator() + "basic.myb"));
@@ -25,6 +25,13 @@
 #include <brushengine/kis_paintop.h>
 #include <brushengine/kis_paint_information.h>
 
+#include <kis_image_config.h>
+#include <kis_pointer_utils.h>
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisFakeRunnableStrokeJobsExecutor.h>
+#include <KisParticleWriteList.h>
+
 #include "KisParticleOpOptionData.h"
 
 #include "particle_brush.h"
@@ -33,10 +40,21 @@ KisParticlePaintOp::KisParticlePaintOp(const KisPaintOpSettingsSP settings, KisP
     : KisPaintOp(painter)
     , m_rateOption(settings.data())
     , m_first(true)
+    , m_idealNumRowSets(KisImageConfig(true).maxNumberOfThreads())
+    , m_updatePeriod(1000 / KisImageConfig(true).fpsLimit())
 {
     Q_UNUSED(image);
     Q_UNUSED(node);
 
+    /**
+     * A painter that is not a part of a stroke runs its jobs right away,
+     * there is no point in queueing the dabs then. Moreover, nobody would
+     * call doAsynchronousUpdate() for it.
+     */
+    m_useAsynchronousRendering =
+        settings->needsAsynchronousUpdates() &&
+        !dynamic_cast<KisFakeRunnableStrokeJobsExecutor*>(painter->runnableStrokeJobsInterface());
+
     m_particleOpData.read(settings.data());
 
     m_particleBrush.setProperties(&m_particleOpData);
@@ -83,6 +101,23 @@ void KisParticlePaintOp::doPaintLine(const KisPaintInformation &pi1, const KisPa
 {
     if (!painter()) return;
 
+    if (m_first) {
+        m_particleBrush.setInitialPosition(pi1.pos());
+        m_first = false;
+    }
+
+    if (m_useAsynchronousRendering) {
+        DabRequest request;
+        request.dab = source()->createCompositionSourceDevice();
+        request.color = painter()->paintColor();
+        request.pos = pi2.pos();
+
+        QMutexLocker l(&m_dabQueueMutex);
+        m_dabQueue.append(request);
+
+        return;
+    }
+
     if (!m_dab) {
         m_dab = source()->createCompositionSourceDevice();
     }
@@ -90,15 +125,110 @@ void KisParticlePaintOp::doPaintLine(const KisPaintInformation &pi1, const KisPa
         m_dab->clear();
     }
 
-
-    if (m_first) {
-        m_particleBrush.setInitialPosition(pi1.pos());
-        m_first = false;
-    }
-
     m_particleBrush.draw(m_dab, painter()->paintColor(), pi2.pos());
     QRect rc = m_dab->extent();
 
     painter()->bitBlt(rc.x(), rc.y(), m_dab, rc.x(), rc.y(), rc.width(), rc.height());
     painter()->renderMirrorMask(rc, m_dab);
 }
+
+struct KisParticlePaintOp::UpdateSharedState
+{
+    QVector<DabRequest> dabsQueue;
+    QVector<QVector<KisParticleWriteList>> particleChunks;
+};
+
+std::pair<int, bool> KisParticlePaintOp::doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    if (!m_useAsynchronousRendering) {
+        return KisPaintOp::doAsynchronousUpdate(jobs);
+    }
+
+    bool someDabsAreStillInQueue = false;
+
+    QMutexLocker l(&m_dabQueueMutex);
+
+    /**
+     * The particles move from one dab to another, so the jobs of the
+     * next update should never start before the previous one has finished.
+     */
+    if (!m_updateSharedState && !m_dabQueue.isEmpty()) {
+        m_updateSharedState = toQShared(new UpdateSharedState());
+        UpdateSharedStateSP state = m_updateSharedState;
+
+        state->dabsQueue.swap(m_dabQueue);
+        l.unlock();
+
+        const int numChunks = m_particleBrush.numParticleChunks();
+        const QRect boundingRect = m_particleBrush.particleBounds(state->dabsQueue.first().dab);
+
+        state->particleChunks.resize(state->dabsQueue.size());
+
+        for (int i = 0; i < state->dabsQueue.size(); i++) {
+            state->particleChunks[i].fill(KisParticleWriteList(state->dabsQueue[i].dab->colorSpace()), numChunks);
+        }
+
+        /**
+         * Every dab continues the movement of the particles from the
+         * previous one, so only the chunks of a single dab are processed
+         * concurrently.
+         */
+        for (int i = 0; i < state->dabsQueue.size(); i++) {
+            const DabRequest *request = &state->dabsQueue[i];
+
+            for (int chunk = 0; chunk < numChunks; chunk++) {
+                KisParticleWriteList *writes = &state->particleChunks[i][chunk];
+
+                KritaUtils::addJobConcurrent(jobs,
+                    [state, request, chunk, boundingRect, writes, this] () {
+                        m_particleBrush.drawChunk(chunk, boundingRect,
+                                                  request->color, request->pos,
+                                                  writes);
+                    }
+                );
+            }
+
+            KritaUtils::addJobSequential(jobs, nullptr);
+        }
+
+        // the rows of tiles of the dabs are merged independently
+        const int numRowSets = m_idealNumRowSets;
+
+        for (int i = 0; i < state->dabsQueue.size(); i++) {
+            const QVector<KisParticleWriteList> *chunks = &state->particleChunks[i];
+            KisPaintDeviceSP dabDevice = state->dabsQueue[i].dab;
+
+            for (int rowSet = 0; rowSet < numRowSets; rowSet++) {
+                KritaUtils::addJobConcurrent(jobs,
+                    [state, chunks, dabDevice, rowSet, numRowSets] () {
+                        KisParticleWriteList::mergeRowSet(*chunks, rowSet, numRowSets,
+                                                          dabDevice, KisParticleWriteList::AddOpacity);
+                    }
+                );
+            }
+        }
+
+        KritaUtils::addJobSequential(jobs,
+            [state, this] () {
+                Q_FOREACH (const DabRequest &request, state->dabsQueue) {
+                    const QRect rc = request.dab->extent();
+
+                    painter()->bitBlt(rc.x(), rc.y(), request.dab, rc.x(), rc.y(), rc.width(), rc.height());
+                    painter()->renderMirrorMask(rc, request.dab);
+                }
+
+                // release all the dab devices
+                state->dabsQueue.clear();
+                state->particleChunks.clear();
+
+                QMutexLocker l(&m_dabQueueMutex);
+                m_updateSharedState.clear();
+            }
+        );
+
+    } else if (m_updateSharedState && !m_dabQueue.isEmpty()) {
+        someDabsAreStillInQueue = true;
+    }
+
+    return std::make_pair(m_updatePeriod, someDabsAreStillInQueue);
+}
@@ -7,6 +7,9 @@
 #ifndef KIS_PARTICLE_PAINTOP_H_
 #define KIS_PARTICLE_PAINTOP_H_
 
+#include <QMutex>
+#include <QSharedPointer>
+
 #include <brushengine/kis_paintop.h>
 #include <kis_types.h>
 #include <KisAirbrushOptionData.h>
@@ -15,6 +18,8 @@
 #include "kis_particle_paintop_settings.h"
 #include "particle_brush.h"
 
+#include <KoColor.h>
+
 class KisPainter;
 class KisPaintInformation;
 
@@ -28,6 +33,8 @@ public:
 
     void paintLine(const KisPaintInformation &pi1, const KisPaintInformation &pi2, KisDistanceInformation *currentDistance) override;
 
+    std::pair<int, bool> doAsynchronousUpdate(QVector<KisRunnableStrokeJobData *> &jobs) override;
+
 protected:
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
 
@@ -38,6 +45,16 @@ protected:
 private:
     void doPaintLine(const KisPaintInformation &pi1, const KisPaintInformation &pi2);
 
+    struct DabRequest
+    {
+        KisPaintDeviceSP dab;
+        KoColor color;
+        QPointF pos;
+    };
+
+    struct UpdateSharedState;
+    typedef QSharedPointer<UpdateSharedState> UpdateSharedStateSP;
+
 private:
     KisParticleOpOptionData m_particleOpData;
     KisPaintDeviceSP m_dab;
@@ -45,6 +62,19 @@ private:
     KisAirbrushOptionData m_airbrushData;
     KisRateOption m_rateOption;
     bool m_first;
+
+    /**
+     * When painting in a stroke, the dabs are only queued in doPaintLine(),
+     * the particles are moved and painted in the concurrent jobs of
+     * doAsynchronousUpdate()
+     */
+    bool m_useAsynchronousRendering {false};
+    QMutex m_dabQueueMutex;
+    QVector<DabRequest> m_dabQueue;
+    UpdateSharedStateSP m_updateSharedState;
+    int m_idealNumRowSets {1};
+    /// the queued dabs are rendered as often as the canvas is updated
+    int m_updatePeriod {10};
 };
 
 #endif // KIS_PARTICLE_PAINTOP_H_
@@ -32,6 +32,11 @@ bool KisParticlePaintOpSettings::paintIncremental()
     return data.paintingMode == enumPaintingMode::BUILDUP;
 }
 
+bool KisParticlePaintOpSettings::needsAsynchronousUpdates() const
+{
+    return true;
+}
+
 
 #include <brushengine/kis_slider_based_paintop_property.h>
 #include "kis_paintop_preset.h"
@@ -9,6 +9,8 @@
 #include "kis_paint_device.h"
 #include "kis_random_accessor_ng.h"
 
+#include <KisParticleWriteList.h>
+
 #include <KoColorSpace.h>
 #include <KoColor.h>
 
@@ -79,73 +81,125 @@ void ParticleBrush::paintParticle(KisRandomAccessorSP accWrite, const KoColorSpa
 
 
 
-void ParticleBrush::draw(KisPaintDeviceSP dab, const KoColor& color, const QPointF &pos)
+QRect ParticleBrush::particleBounds(KisPaintDeviceSP dab) const
 {
-    KisRandomAccessorSP accessor = dab->createRandomAccessorNG();
-    const KoColorSpace * cs = dab->colorSpace();
-
     QRect boundingRect;
 
     if (m_properties->particleScaleX < 0 || m_properties->particleScaleY < 0 || m_properties->particleGravity < 0) {
         boundingRect = dab->defaultBounds()->bounds();
     }
 
+    return boundingRect;
+}
+
+bool ParticleBrush::moveParticle(int j, const QPointF &pos, const QRect &boundingRect)
+{
+    /*
+        m_time = 0.01;
+        QPointF temp = m_position;
+        QPointF dist = m_position - m_oldPosition;
+        m_position = m_position + (dist + (m_acceleration*m_time*m_time));
+        m_oldPosition = temp;
+    */
+
+    /*
+        QPointF dist = info.pos() - m_position;
+        dist *= 0.3; // scale
+        dist *= 10; // force
+        m_oldPosition += dist;
+        m_oldPosition *= 0.989;
+        m_position = m_position + m_oldPosition * m_time * m_time;
+    */
+
+
+    QPointF dist = pos - m_particlePos[j];
+    dist.setX(dist.x() * m_properties->particleScaleX);
+    dist.setY(dist.y() * m_properties->particleScaleY);
+    dist = dist * m_acceleration[j];
+    m_particleNextPos[j] = m_particleNextPos[j] + dist;
+    m_particleNextPos[j] *= m_properties->particleGravity;
+    m_particlePos[j] = m_particlePos[j] + (m_particleNextPos[j] * TIME);
+
+    /**
+     * When the scale is negative the equation becomes
+     * unstable, and the point coordinates grow to infinity,
+     * so just limit them in that case.
+     *
+     * Generally, the effect of instability might be quite
+     * interesting for the painters.
+     */
+
+    // If scale is negative, position can easily jump into infinity
+    //  and then it won't be caught by contains();
+    //  and then it will be passed to the lockless hashtable
+    //  and then it will crash.
+    // Hence better to catch infinity here and just not paint anything.
+    QPointF pointF = m_particlePos[j];
+
+    const qint32 max = 2147483600;
+    const qint32 min = -max;
+    bool nearInfinity = pointF.x() < min || pointF.x () > max || pointF.y() < min || pointF.y() > max;
+    bool inside = boundingRect.contains(m_particlePos[j].toPoint());
+
+    return boundingRect.isEmpty() || (inside && !nearInfinity);
+}
+
+void ParticleBrush::draw(KisPaintDeviceSP dab, const KoColor& color, const QPointF &pos)
+{
+    KisRandomAccessorSP accessor = dab->createRandomAccessorNG();
+    const KoColorSpace * cs = dab->colorSpace();
+
+    const QRect boundingRect = particleBounds(dab);
+
     for (int i = 0; i < m_properties->particleIterations; i++) {
         for (int j = 0; j < m_properties->particleCount; j++) {
-            /*
-                m_time = 0.01;
-                QPointF temp = m_position;
-                QPointF dist = m_position - m_oldPosition;
-                m_position = m_position + (dist + (m_acceleration*m_time*m_time));
-                m_oldPosition = temp;
-            */
-
-            /*
-                QPointF dist = info.pos() - m_position;
-                dist *= 0.3; // scale
-                dist *= 10; // force
-                m_oldPosition += dist;
-                m_oldPosition *= 0.989;
-                m_position = m_position + m_oldPosition * m_time * m_time;
-            */
-
-
-            QPointF dist = pos - m_particlePos[j];
-            dist.setX(dist.x() * m_properties->particleScaleX);
-            dist.setY(dist.y() * m_properties->particleScaleY);
-            dist = dist * m_acceleration[j];
-            m_particleNextPos[j] = m_particleNextPos[j] + dist;
-            m_particleNextPos[j] *= m_properties->particleGravity;
-            m_particlePos[j] = m_particlePos[j] + (m_particleNextPos[j] * TIME);
-
-            /**
-             * When the scale is negative the equation becomes
-             * unstable, and the point coordinates grow to infinity,
-             * so just limit them in that case.
-             *
-             * Generally, the effect of instability might be quite
-             * interesting for the painters.
-             */
-
-            // If scale is negative, position can easily jump into infinity
-            //  and then it won't be caught by contains();
-            //  and then it will be passed to the lockless hashtable
-            //  and then it will crash.
-            // Hence better to catch infinity here and just not paint anything.
-            QPointF pointF = m_particlePos[j];
-
-            const qint32 max = 2147483600;
-            const qint32 min = -max;
-            bool nearInfinity = pointF.x() < min || pointF.x () > max || pointF.y() < min || pointF.y() > max;
-            bool inside = boundingRect.contains(m_particlePos[j].toPoint());
-
-            if (boundingRect.isEmpty() || (inside && !nearInfinity)) {
+            if (moveParticle(j, pos, boundingRect)) {
                 paintParticle(accessor, cs, m_particlePos[j], color, m_properties->particleWeight, true);
             }
-
         }//for j
     }//for i
 }
 
+int ParticleBrush::numParticleChunks() const
+{
+    return (m_properties->particleCount + particlesPerChunk - 1) / particlesPerChunk;
+}
+
+void ParticleBrush::drawChunk(int chunk, const QRect &boundingRect,
+                              const KoColor& color, const QPointF &pos,
+                              KisParticleWriteList *writes)
+{
+    const int firstParticle = chunk * particlesPerChunk;
+    const int lastParticle = qMin(m_properties->particleCount, firstParticle + particlesPerChunk);
+
+    const quint8 opacity = color.opacityU8();
+    const qreal weight = m_properties->particleWeight;
 
+    KoColor myColor(color);
 
+    auto addPixel = [&myColor, writes] (int x, int y, quint8 pixelOpacity) {
+        // the opacity is added to the opacity of the dab when merging
+        myColor.setOpacity(pixelOpacity);
+        writes->addPixel(x, y, myColor.data());
+    };
+
+    // the particles of the chunk don't depend on each other, so the order
+    // of the writes differs from draw(), but the sum of the opacities doesn't
+    for (int j = firstParticle; j < lastParticle; j++) {
+        for (int i = 0; i < m_properties->particleIterations; i++) {
+            if (!moveParticle(j, pos, boundingRect)) continue;
+
+            const QPointF &particlePos = m_particlePos[j];
+
+            int ipx = floor(particlePos.x());
+            int ipy = floor(particlePos.y());
+            qreal fx = particlePos.x() - ipx;
+            qreal fy = particlePos.y() - ipy;
+
+            addPixel(ipx, ipy, qRound((1.0 - fx) * (1.0 - fy) * opacity * weight));
+            addPixel(ipx + 1, ipy, qRound((fx)  * (1.0 - fy) * opacity * weight));
+            addPixel(ipx, ipy + 1, qRound((1.0 - fx) * (fy)  * opacity * weight));
+            addPixel(ipx + 1, ipy + 1, qRound((fx)  * (fy)  * opacity * weight));
+        }
+    }
+}
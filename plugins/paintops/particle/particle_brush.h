@@ -11,6 +11,7 @@
 #include "kis_paint_device.h"
 #include "kis_debug.h"
 #include <QPointF>
+#include <QRect>
 
 #include "KisParticleOpOptionData.h"
 
@@ -28,6 +29,7 @@ public:
 class KisRandomAccessor;
 class KoColorSpace;
 class KoColor;
+class KisParticleWriteList;
 
 class ParticleBrush
 {
@@ -40,6 +42,27 @@ public:
     void draw(KisPaintDeviceSP dab, const KoColor& color, const QPointF &pos);
 
     void setInitialPosition(const QPointF &pos);
+
+    static const int particlesPerChunk = 256;
+
+    int numParticleChunks() const;
+
+    /**
+     * \return the area the particles are limited to when painting
+     * on \p dab, an empty rect means there is no limit
+     */
+    QRect particleBounds(KisPaintDeviceSP dab) const;
+
+    /**
+     * Does the same as draw(), but only for the particles of \p chunk. The
+     * pixels are put into \p writes, which should be merged into the dab
+     * in KisParticleWriteList::AddOpacity mode. The particles don't
+     * interact, so different chunks can be drawn concurrently.
+     */
+    void drawChunk(int chunk, const QRect &boundingRect,
+                   const KoColor& color, const QPointF &pos,
+                   KisParticleWriteList *writes);
+
     void setProperties(KisParticleOpOptionData * properties) {
         m_properties = properties;
     }
@@ -49,6 +72,9 @@ private:
     /// also the particle respects opacity in the destination pixel buffer
     void paintParticle(KisRandomAccessorSP writeAccessor, const KoColorSpace *cs,const QPointF &pos, const KoColor& color, qreal weight, bool respectOpacity);
 
+    /// moves the particle one step towards \p pos, \return true if it should be painted
+    bool moveParticle(int index, const QPointF &pos, const QRect &boundingRect);
+
     QVector<QPointF> m_particlePos;
     QVector<QPointF> m_particleNextPos;
     QVector<qreal> m_acceleration;
@@ -0,0 +1,165 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisParticleOpTest.h"
+
+#include "kistest.h"
+
+#include <QThreadPool>
+
+#include <qimage_based_test.h>
+#include <stroke_testing_utils.h>
+#include <brushengine/kis_paint_information.h>
+#include <brushengine/kis_paintop_preset.h>
+#include <brushengine/kis_paintop_settings.h>
+#include <brushengine/kis_random_source.h>
+#include <brushengine/KisPerStrokeRandomSource.h>
+#include <KoCanvasResourcesIds.h>
+#include <KisThreadPoolRunnableStrokeJobsExecutor.h>
+#include <KisRunnableStrokeJobData.h>
+#include <kis_image_config.h>
+#include <testutil.h>
+
+#include <tuple>
+
+class TestParticleOp : public TestUtil::QImageBasedTest
+{
+public:
+    TestParticleOp()
+        : QImageBasedTest("particleop") {
+    }
+
+    /**
+     * Paints the test strokes with \p numThreads threads. The dabs are
+     * queued by the paintop and rendered in the jobs of
+     * doAsynchronousUpdate(), like in a freehand stroke.
+     */
+    KisPaintDeviceSP paintStrokes(int particleCount, int numThreads, bool *usedAsynchronousRendering) {
+        {
+            // the paintop splits the merging of the particles by the number of threads
+            KisImageConfig cfg(false);
+            cfg.setMaxNumberOfThreads(numThreads);
+        }
+        QThreadPool::globalInstance()->setMaxThreadCount(numThreads);
+
+        KisSurrogateUndoStore *undoStore = new KisSurrogateUndoStore();
+        KisImageSP image = createTrivialImage(undoStore);
+        image->initialRefreshGraph();
+        image->resizeImage(QRect(0,0,200,200));
+        image->waitForDone();
+
+        KisNodeSP paint1 = findNode(image->root(), "paint1");
+        paint1->paintDevice()->fill(QRect(80, 5, 50, 190), KoColor(Qt::red, image->colorSpace()));
+
+        KisThreadPoolRunnableStrokeJobsExecutor executor;
+
+        KisPainter gc(paint1->paintDevice());
+        gc.setRunnableStrokeJobsInterface(&executor);
+
+        QScopedPointer<KoCanvasResourceProvider> manager(
+            utils::createResourceManager(image, 0, "particlebrush.kpp"));
+
+        manager->setResource(KoCanvasResource::ForegroundColor, KoColor(Qt::green, image->colorSpace()));
+
+        KisPaintOpPresetSP preset =
+            manager->resource(KoCanvasResource::CurrentPaintOpPreset).value<KisPaintOpPresetSP>();
+        preset->settings()->setProperty("Particle/count", particleCount);
+
+        KisResourcesSnapshotSP resources =
+            new KisResourcesSnapshot(image,
+                                     paint1,
+                                     manager.data());
+
+        resources->setupPainter(&gc);
+
+        doPaint(gc);
+
+        *usedAsynchronousRendering = false;
+
+        for (int i = 0; i < 1000; i++) {
+            QVector<KisRunnableStrokeJobData*> jobs;
+            bool needsMoreUpdates = false;
+
+            std::tie(std::ignore, needsMoreUpdates) = gc.paintOp()->doAsynchronousUpdate(jobs);
+
+            const bool hasJobs = !jobs.isEmpty();
+            *usedAsynchronousRendering |= hasJobs;
+
+            executor.addRunnableJobs(jobs);
+
+            if (!hasJobs && !needsMoreUpdates) break;
+        }
+
+        return paint1->paintDevice();
+    }
+
+    void doPaint(KisPainter &gc) {
+        KisRandomSourceSP randomSource = new KisRandomSource(42);
+        KisPerStrokeRandomSourceSP perStrokeRandomSource = new KisPerStrokeRandomSource(42);
+
+        const QVector<qreal> pressureLevels = {1.0, 0.8, 0.5};
+
+        int yOffset = 20;
+        Q_FOREACH (qreal pressure, pressureLevels) {
+            KisDistanceInformation dist;
+            KisPaintInformation p1(QPointF(20, yOffset), pressure);
+            KisPaintInformation p2(QPointF(180, yOffset + 30), pressure);
+
+            p1.setRandomSource(randomSource);
+            p1.setPerStrokeRandomSource(perStrokeRandomSource);
+            p2.setRandomSource(randomSource);
+            p2.setPerStrokeRandomSource(perStrokeRandomSource);
+
+            gc.paintLine(p1, p2, &dist);
+
+            yOffset += 60;
+        }
+    }
+};
+
+void KisParticleOpTest::testAsynchronousRendering_data()
+{
+    QTest::addColumn<int>("particleCount");
+
+    // the few particles fit into a single chunk, the many ones are split
+    QTest::newRow("few") << 50;
+    QTest::newRow("many") << 1000;
+}
+
+void KisParticleOpTest::testAsynchronousRendering()
+{
+    QFETCH(int, particleCount);
+
+    const int origMaxNumberOfThreads = KisImageConfig(true).maxNumberOfThreads();
+    const int origMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+
+    TestParticleOp t;
+
+    bool usedAsynchronousRendering = false;
+
+    KisPaintDeviceSP singleThreadResult =
+        t.paintStrokes(particleCount, 1, &usedAsynchronousRendering);
+    QVERIFY(usedAsynchronousRendering);
+
+    KisPaintDeviceSP multiThreadResult =
+        t.paintStrokes(particleCount, 8, &usedAsynchronousRendering);
+    QVERIFY(usedAsynchronousRendering);
+
+    {
+        KisImageConfig cfg(false);
+        cfg.setMaxNumberOfThreads(origMaxNumberOfThreads);
+    }
+    QThreadPool::globalInstance()->setMaxThreadCount(origMaxThreadCount);
+
+    // the opacities of the particles are summed, so the order of the chunks doesn't matter
+    const QRect rc(0, 0, 200, 200);
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt,
+                                     singleThreadResult->convertToQImage(0, rc),
+                                     multiThreadResult->convertToQImage(0, rc)));
+}
+
+KISTEST_MAIN(KisParticleOpTest)
@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISPARTICLEOPTEST_H
+#define KISPARTICLEOPTEST_H
+
+#include <QtTest>
+
+class KisParticleOpTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+
+    void testAsynchronousRendering();
+    void testAsynchronousRendering_data();
+};
+
+#endif // KISPARTICLEOPTEST_H
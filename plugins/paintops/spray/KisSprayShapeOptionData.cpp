@@ -62,3 +62,9 @@ QSize KisSprayShapeOptionData::effectiveSize(int diameter, qreal scale) const
 {
     return !proportional ? size : size * diameter * scale / 100.0;
 }
+
+bool KisSprayShapeOptionData::isPixelShape() const
+{
+    // 2 is the anti-aliased pixel, 3 is the pixel
+    return enabled && (shape == 2 || shape == 3);
+}
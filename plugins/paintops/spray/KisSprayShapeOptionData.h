@@ -40,6 +40,13 @@ struct KisSprayShapeOptionData : boost::equality_comparable<KisSprayShapeOptionD
     void write(KisPropertiesConfiguration *setting) const;
 
     QSize effectiveSize(int diameter, qreal scale) const;
+
+    /**
+     * \return true if the particles are single pixels (the "Pixel" and
+     * "Anti-aliased Pixel" shapes), which are written into the dab
+     * directly, without a painter
+     */
+    bool isPixelShape() const;
 };
 
 #endif // KIS_SPRAY_SHAPE_OPTION_DATA_H
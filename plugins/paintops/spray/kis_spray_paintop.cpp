@@ -22,6 +22,13 @@
 #include <kis_lod_transform.h>
 #include <kis_paintop_plugin_utils.h>
 #include <KoResourceLoadResult.h>
+#include <kis_image_config.h>
+#include <kis_pointer_utils.h>
+
+#include <KisRunnableStrokeJobData.h>
+#include <KisRunnableStrokeJobUtils.h>
+#include <KisFakeRunnableStrokeJobsExecutor.h>
+#include <KisParticleWriteList.h>
 
 
 KisSprayPaintOp::KisSprayPaintOp(const KisPaintOpSettingsSP settings, KisPainter *painter, KisNodeSP node, KisImageSP image)
@@ -33,12 +40,22 @@ KisSprayPaintOp::KisSprayPaintOp(const KisPaintOpSettingsSP settings, KisPainter
     , m_opacityOption(settings.data())
     , m_rateOption(settings.data())
     , m_node(node)
-    
+    , m_idealNumRowSets(KisImageConfig(true).maxNumberOfThreads())
+    , m_updatePeriod(1000 / KisImageConfig(true).fpsLimit())
 {
     Q_ASSERT(settings);
     Q_ASSERT(painter);
     Q_UNUSED(image);
 
+    /**
+     * A painter that is not a part of a stroke runs its jobs right away,
+     * there is no point in queueing the dabs then. Moreover, nobody would
+     * call doAsynchronousUpdate() for it.
+     */
+    m_useAsynchronousRendering =
+        settings->needsAsynchronousUpdates() &&
+        !dynamic_cast<KisFakeRunnableStrokeJobsExecutor*>(painter->runnableStrokeJobsInterface());
+
     m_airbrushData.read(settings.data());
 
     m_brushOption.readOptionSetting(settings, settings->resourcesInterface(), settings->canvasResourcesInterface());
@@ -89,13 +106,6 @@ KisSpacingInformation KisSprayPaintOp::paintAt(const KisPaintInformation& info)
         return KisSpacingInformation(m_spacing);
     }
 
-    if (!m_dab) {
-        m_dab = source()->createCompositionSourceDevice();
-    }
-    else {
-        m_dab->clear();
-    }
-
     qreal rotation = m_rotationOption.apply(info);
     quint8 origOpacity = m_opacityOption.apply(painter(), info);
     // Spray Brush is capable of working with zero scale,
@@ -103,6 +113,30 @@ KisSpacingInformation KisSprayPaintOp::paintAt(const KisPaintInformation& info)
     const qreal scale = m_sizeOption.apply(info);
     const qreal lodScale = KisLodTransform::lodToScale(painter()->device());
 
+    if (m_useAsynchronousRendering) {
+        DabRequest request;
+        request.opacity = painter()->opacity();
+        request.dab = m_sprayBrush.prepareParticleDab(source()->createCompositionSourceDevice(),
+                                                      m_node->paintDevice(),
+                                                      info,
+                                                      rotation,
+                                                      scale, lodScale,
+                                                      painter()->paintColor(),
+                                                      painter()->backgroundColor());
+        painter()->setOpacity(origOpacity);
+
+        QMutexLocker l(&m_dabQueueMutex);
+        m_dabQueue.append(request);
+
+        return computeSpacing(info, lodScale);
+    }
+
+    if (!m_dab) {
+        m_dab = source()->createCompositionSourceDevice();
+    }
+    else {
+        m_dab->clear();
+    }
 
     m_sprayBrush.paint(m_dab,
                        m_node->paintDevice(),
@@ -120,6 +154,113 @@ KisSpacingInformation KisSprayPaintOp::paintAt(const KisPaintInformation& info)
     return computeSpacing(info, lodScale);
 }
 
+struct KisSprayPaintOp::UpdateSharedState
+{
+    QVector<DabRequest> dabsQueue;
+    QVector<QVector<KisParticleWriteList>> particleChunks;
+};
+
+std::pair<int, bool> KisSprayPaintOp::doAsynchronousUpdate(QVector<KisRunnableStrokeJobData*> &jobs)
+{
+    if (!m_useAsynchronousRendering) {
+        return KisPaintOp::doAsynchronousUpdate(jobs);
+    }
+
+    bool someDabsAreStillInQueue = false;
+
+    QMutexLocker l(&m_dabQueueMutex);
+
+    /**
+     * The jobs of the next update are put in front of the jobs of the
+     * previous one, so the dabs could be painted in a wrong order if
+     * we started a new update before the previous one has finished.
+     */
+    if (!m_updateSharedState && !m_dabQueue.isEmpty()) {
+        m_updateSharedState = toQShared(new UpdateSharedState());
+        UpdateSharedStateSP state = m_updateSharedState;
+
+        state->dabsQueue.swap(m_dabQueue);
+        l.unlock();
+
+        state->particleChunks.resize(state->dabsQueue.size());
+
+        for (int i = 0; i < state->dabsQueue.size(); i++) {
+            const SprayBrush::ParticleDab &dab = state->dabsQueue[i].dab;
+            state->particleChunks[i].fill(KisParticleWriteList(dab.dab->colorSpace()),
+                                          m_sprayBrush.numParticleChunks(dab));
+        }
+
+        // the particles of all the dabs are independent from each other
+        for (int i = 0; i < state->dabsQueue.size(); i++) {
+            const SprayBrush::ParticleDab *dab = &state->dabsQueue[i].dab;
+            QVector<KisParticleWriteList> &chunks = state->particleChunks[i];
+
+            for (int chunk = 0; chunk < chunks.size(); chunk++) {
+                KisParticleWriteList *writes = &chunks[chunk];
+
+                KritaUtils::addJobConcurrent(jobs,
+                    [state, dab, chunk, writes, this] () {
+                        m_sprayBrush.generateParticleChunk(*dab, chunk, writes);
+                    }
+                );
+            }
+        }
+
+        KritaUtils::addJobSequential(jobs, nullptr);
+
+        /**
+         * Every dab has its own device, and the rows of tiles of a single
+         * device are written independently, so all the merging is concurrent
+         */
+        const int numRowSets = m_idealNumRowSets;
+
+        for (int i = 0; i < state->dabsQueue.size(); i++) {
+            const QVector<KisParticleWriteList> *chunks = &state->particleChunks[i];
+            if (chunks->isEmpty()) continue;
+
+            KisPaintDeviceSP dabDevice = state->dabsQueue[i].dab.dab;
+
+            for (int rowSet = 0; rowSet < numRowSets; rowSet++) {
+                KritaUtils::addJobConcurrent(jobs,
+                    [state, chunks, dabDevice, rowSet, numRowSets] () {
+                        KisParticleWriteList::mergeRowSet(*chunks, rowSet, numRowSets,
+                                                          dabDevice, KisParticleWriteList::Overwrite);
+                    }
+                );
+            }
+        }
+
+        KritaUtils::addJobSequential(jobs,
+            [state, this] () {
+                const quint8 origOpacity = painter()->opacity();
+
+                Q_FOREACH (const DabRequest &request, state->dabsQueue) {
+                    KisPaintDeviceSP dab = request.dab.dab;
+                    const QRect rc = dab->extent();
+
+                    painter()->setOpacity(request.opacity);
+                    painter()->bitBlt(rc.topLeft(), dab, rc);
+                    painter()->renderMirrorMask(rc, dab);
+                }
+
+                painter()->setOpacity(origOpacity);
+
+                // release all the dab devices
+                state->dabsQueue.clear();
+                state->particleChunks.clear();
+
+                QMutexLocker l(&m_dabQueueMutex);
+                m_updateSharedState.clear();
+            }
+        );
+
+    } else if (m_updateSharedState && !m_dabQueue.isEmpty()) {
+        someDabsAreStillInQueue = true;
+    }
+
+    return std::make_pair(m_updatePeriod, someDabsAreStillInQueue);
+}
+
 KisSpacingInformation KisSprayPaintOp::updateSpacingImpl(const KisPaintInformation &info) const
 {
     return computeSpacing(info, KisLodTransform::lodToScale(painter()->device()));
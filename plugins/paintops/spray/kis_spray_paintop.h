@@ -7,6 +7,9 @@
 #ifndef KIS_SPRAY_PAINTOP_H_
 #define KIS_SPRAY_PAINTOP_H_
 
+#include <QMutex>
+#include <QSharedPointer>
+
 #include <brushengine/kis_paintop.h>
 #include <kis_types.h>
 
@@ -34,6 +37,8 @@ public:
 
     static QList<KoResourceLoadResult> prepareLinkedResources(const KisPaintOpSettingsSP settings, KisResourcesInterfaceSP resourcesInterface);
 
+    std::pair<int, bool> doAsynchronousUpdate(QVector<KisRunnableStrokeJobData *> &jobs) override;
+
 protected:
 
     KisSpacingInformation paintAt(const KisPaintInformation& info) override;
@@ -45,6 +50,15 @@ protected:
 private:
     KisSpacingInformation computeSpacing(const KisPaintInformation &info, qreal lodScale) const;
 
+    struct DabRequest
+    {
+        SprayBrush::ParticleDab dab;
+        quint8 opacity {OPACITY_OPAQUE_U8};
+    };
+
+    struct UpdateSharedState;
+    typedef QSharedPointer<UpdateSharedState> UpdateSharedStateSP;
+
 private:
     KisSprayShapeOptionData m_shapeProperties;
     KisSprayOpOption m_sprayOpOption;
@@ -63,6 +77,19 @@ private:
     KisOpacityOption m_opacityOption;
     KisRateOption m_rateOption;
     KisNodeSP m_node;
+
+    /**
+     * When painting pixel particles in a stroke, the dabs are only prepared
+     * in paintAt() and queued, the particles are generated and written in
+     * the concurrent jobs of doAsynchronousUpdate()
+     */
+    bool m_useAsynchronousRendering {false};
+    QMutex m_dabQueueMutex;
+    QVector<DabRequest> m_dabQueue;
+    UpdateSharedStateSP m_updateSharedState;
+    int m_idealNumRowSets {1};
+    /// the queued dabs are rendered as often as the canvas is updated
+    int m_updatePeriod {10};
 };
 
 #endif // KIS_SPRAY_PAINTOP_H_
@@ -66,6 +66,14 @@ bool KisSprayPaintOpSettings::paintIncremental()
     return data.paintingMode == enumPaintingMode::BUILDUP;
 }
 
+bool KisSprayPaintOpSettings::needsAsynchronousUpdates() const
+{
+    // only the pixel particles are rendered in concurrent jobs
+    KisSprayShapeOptionData data;
+    data.read(this);
+    return data.isPixelShape();
+}
+
 
 KisOptimizedBrushOutline KisSprayPaintOpSettings::brushOutline(const KisPaintInformation &info, const OutlineMode &mode, qreal alignForZoom)
 {
@@ -36,6 +36,8 @@ public:
 
     bool paintIncremental() override;
 
+    bool needsAsynchronousUpdates() const override;
+
 protected:
 
     QList<KisUniformPaintOpPropertySP> uniformProperties(KisPaintOpSettingsSP settings, QPointer<KisPaintOpPresetUpdateProxy> updateProxy) override;
@@ -18,6 +18,7 @@
 #include <QHash>
 #include <QTransform>
 #include <QImage>
+#include <QScopedPointer>
 
 #include <kis_random_accessor_ng.h>
 #include <kis_random_sub_accessor.h>
@@ -29,10 +30,13 @@
 #include <kis_fixed_paint_device.h>
 #include <kis_cross_device_color_sampler.h>
 
+#include <KisParticleWriteList.h>
+
 #include "kis_spray_paintop_settings.h"
 
 #include <cmath>
 #include <ctime>
+#include <limits>
 
 #include <QtGlobal>
 
@@ -89,51 +93,47 @@ qreal SprayBrush::rotationAngle(KisRandomSourceSP randomSource)
     return rotation;
 }
 
-void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
-                       const KisPaintInformation& info,
-                       qreal rotation, qreal scale,
-                       qreal additionalScale,
-                       const KoColor &color, const KoColor &bgColor)
+template <typename Func>
+void SprayBrush::withDistributions(Func func) const
 {
+    auto withRadialDistribution = [this, &func] (const auto &angularDistribution) {
+        if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Uniform) {
+            if (m_sprayOpOption->data.radialDistributionCenterBiased) {
+                func(angularDistribution, m_sprayOpOption->m_uniformDistribution);
+            } else {
+                func(angularDistribution, m_sprayOpOption->m_uniformDistributionPolarDistance);
+            }
+        } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Gaussian) {
+            if (m_sprayOpOption->data.radialDistributionCenterBiased) {
+                func(angularDistribution, m_sprayOpOption->m_normalDistribution);
+            } else {
+                func(angularDistribution, m_sprayOpOption->m_normalDistributionPolarDistance);
+            }
+        } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_ClusterBased) {
+            func(angularDistribution, m_sprayOpOption->m_clusterBasedDistributionPolarDistance);
+        } else {
+            func(angularDistribution, m_sprayOpOption->m_radialCurveBasedDistributionPolarDistance);
+        }
+    };
+
     if (m_sprayOpOption->data.angularDistributionType == KisSprayOpOptionData::ParticleDistribution_Uniform) {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, m_sprayOpOption->m_uniformDistribution);
+        withRadialDistribution(m_sprayOpOption->m_uniformDistribution);
     } else {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor, m_sprayOpOption->m_angularCurveBasedDistribution);
+        withRadialDistribution(m_sprayOpOption->m_angularCurveBasedDistribution);
     }
 }
 
-template <typename AngularDistribution>
-void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
-                           const KisPaintInformation& info,
-                           qreal rotation, qreal scale,
-                           qreal additionalScale,
-                           const KoColor &color,
-                           const KoColor &bgColor,
-                           const AngularDistribution &angularDistribution)
+void SprayBrush::paint(KisPaintDeviceSP dab, KisPaintDeviceSP source,
+                       const KisPaintInformation& info,
+                       qreal rotation, qreal scale,
+                       qreal additionalScale,
+                       const KoColor &color, const KoColor &bgColor)
 {
-    if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Uniform) {
-        if (m_sprayOpOption->data.radialDistributionCenterBiased) {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                      angularDistribution, m_sprayOpOption->m_uniformDistribution);
-        } else {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                      angularDistribution, m_sprayOpOption->m_uniformDistributionPolarDistance);
-        }
-    } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_Gaussian) {
-        if (m_sprayOpOption->data.radialDistributionCenterBiased) {
-            paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                      angularDistribution, m_sprayOpOption->m_normalDistribution);
-        } else {
+    withDistributions(
+        [&] (const auto &angularDistribution, const auto &radialDistribution) {
             paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                      angularDistribution, m_sprayOpOption->m_normalDistributionPolarDistance);
-        }
-    } else if (m_sprayOpOption->data.radialDistributionType == KisSprayOpOptionData::ParticleDistribution_ClusterBased) {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                  angularDistribution, m_sprayOpOption->m_clusterBasedDistributionPolarDistance);
-    } else {
-        paintImpl(dab, source, info, rotation, scale, additionalScale, color, bgColor,
-                  angularDistribution, m_sprayOpOption->m_radialCurveBasedDistributionPolarDistance);
-    }
+                      angularDistribution, radialDistribution);
+        });
 }
 
 template <typename AngularDistribution, typename RadialDistribution>
@@ -199,7 +199,6 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
         m_particlesCount = m_sprayOpOption->data.particleCount;
     }
 
-    QHash<QString, QVariant> params;
     qreal nx, ny;
     int ix, iy;
 
@@ -214,10 +213,7 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
         paintCircle(m_painter, x, y, m_radius);
     }
 
-    QTransform m;
-    m.reset();
-    m.rotateRadians(-rotation + deg2rad(m_sprayOpOption->data.brushRotation));
-    m.scale(m_sprayOpOption->data.scale, m_sprayOpOption->data.scale);
+    const QTransform m = particleTransform(rotation);
 
     for (quint32 i = 0; i < m_particlesCount; i++) {
         // generate random angle
@@ -258,41 +254,11 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
         // color transformation
 
         if (shouldColor) {
-            if (m_colorProperties->sampleInputColor) {
-                colorSampler.sampleOldColor(nx + x, ny + y, m_inkColor.data());
-            }
-
-            // mix the color with background color
-            if (m_colorProperties->mixBgColor) {
-                KoMixColorsOp * mixOp = dab->colorSpace()->mixColorsOp();
-
-                const quint8 *colors[2];
-                colors[0] = m_inkColor.data();
-                colors[1] = bgColor.data();
-
-                qint16 colorWeights[2];
-                int MAX_16BIT = 255;
-                qreal blend = info.pressure();
-
-                colorWeights[0] = static_cast<quint16>(blend * MAX_16BIT);
-                colorWeights[1] = static_cast<quint16>((1.0 - blend) * MAX_16BIT);
-                mixOp->mixColors(colors, colorWeights, 2, m_inkColor.data());
-            }
-
-            if (m_colorProperties->useRandomHSV && m_transfo) {
-                params["h"] = (m_colorProperties->hue / 180.0) * randomSource->generateNormalized();
-                params["s"] = (m_colorProperties->saturation / 100.0) * randomSource->generateNormalized();
-                params["v"] = (m_colorProperties->value / 100.0) * randomSource->generateNormalized();
-                m_transfo->setParameters(params);
-                m_transfo->setParameter(3, 1);//sets the type to HSV. For some reason 0 is not an option.
-                m_transfo->setParameter(4, false);//sets the colorize to false.
-                m_transfo->transform(m_inkColor.data(), m_inkColor.data() , 1);
-            }
+            applyColorOptions(&m_inkColor, &colorSampler, nx + x, ny + y,
+                              bgColor, info.pressure(), m_transfo, randomSource);
 
             if (m_colorProperties->useRandomOpacity) {
-                quint8 alpha = qRound(randomSource->generateNormalized() * OPACITY_OPAQUE_U8);
-                m_inkColor.setOpacity(alpha);
-                m_painter->setOpacity(alpha);
+                m_painter->setOpacity(m_inkColor.opacityU8());
             }
 
             if (!m_colorProperties->colorPerParticle) {
@@ -326,7 +292,12 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
             }
             // wu-particle
             case 2: {
-                paintParticle(accessor, m_inkColor, nx + x, ny + y);
+                paintParticle(
+                    [&accessor, this] (int px, int py, const quint8 *pixel) {
+                        accessor->moveTo(px, py);
+                        memcpy(accessor->rawData(), pixel, m_dabPixelSize);
+                    },
+                    m_inkColor, nx + x, ny + y);
                 break;
             }
             // pixel
@@ -416,7 +387,231 @@ void SprayBrush::paintImpl(KisPaintDeviceSP dab, KisPaintDeviceSP source,
 
 
 
-void SprayBrush::paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry)
+bool SprayBrush::canPaintConcurrently() const
+{
+    return m_shapeProperties->isPixelShape();
+}
+
+SprayBrush::ParticleDab SprayBrush::prepareParticleDab(KisPaintDeviceSP dab, KisPaintDeviceSP source,
+                                                       const KisPaintInformation& info,
+                                                       qreal rotation, qreal scale,
+                                                       qreal additionalScale,
+                                                       const KoColor &color, const KoColor &bgColor)
+{
+    KisRandomSourceSP randomSource = info.randomSource();
+
+    Q_ASSERT(color.colorSpace()->pixelSize() == dab->pixelSize());
+
+    if (m_colorProperties->useRandomHSV && !m_transfo) {
+        m_transfo = dab->colorSpace()->createColorTransformation("hsv_adjustment", QHash<QString, QVariant>());
+    }
+
+    ParticleDab result;
+    result.dab = dab;
+    result.source = source;
+    result.rotation = rotation;
+    result.pressure = info.pressure();
+    result.color = color;
+    result.bgColor = bgColor;
+    result.inkColor = color;
+
+    qreal x = info.pos().x();
+    qreal y = info.pos().y();
+
+    // apply size sensor
+    result.radius = m_sprayOpOption->data.diameter/2 * scale * additionalScale;
+
+    // jitter movement
+    if (m_sprayOpOption->data.jitterMovement) {
+        x = x + ((2 * result.radius * randomSource->generateNormalized()) - result.radius) * m_sprayOpOption->data.jitterAmount;
+        y = y + ((2 * result.radius * randomSource->generateNormalized()) - result.radius) * m_sprayOpOption->data.jitterAmount;
+    }
+
+    result.center = QPointF(x, y);
+
+    if (m_sprayOpOption->data.useDensity) {
+        result.particlesCount = (m_sprayOpOption->data.coverage * (M_PI * pow2(result.radius)) / pow2(additionalScale));
+    }
+    else {
+        result.particlesCount = m_sprayOpOption->data.particleCount;
+    }
+
+    /**
+     * The per-stroke part of the seed makes the strokes differ, the
+     * per-dab part makes the dabs differ. Both are deterministic for
+     * the same random sources.
+     */
+    const int maxSeed = std::numeric_limits<int>::max();
+    result.seed =
+        quint32(info.perStrokeRandomSource()->generate("spray_particles_seed", 0, maxSeed)) ^
+        quint32(randomSource->generate(0, maxSeed));
+
+    /**
+     * When the color is not per-particle, it is calculated once for
+     * the center of the dab, the chunks cannot share the first particle.
+     *
+     * NOTE: it differs from paint(), which samples the color at the
+     * position of the first particle, so with the input color sampled
+     * or mixed with the background the colors of the asynchronous dabs
+     * are slightly different from the ones of the serial dabs.
+     */
+    if (!m_colorProperties->colorPerParticle) {
+        KisCrossDeviceColorSampler colorSampler(source, result.inkColor);
+        applyColorOptions(&result.inkColor, &colorSampler, x, y,
+                          bgColor, result.pressure, m_transfo, randomSource);
+    }
+
+    if (m_colorProperties->fillBackground) {
+        KisPainter painter(dab);
+        painter.setFillStyle(KisPainter::FillStyleForegroundColor);
+        painter.setPaintColor(bgColor);
+        paintCircle(&painter, x, y, result.radius);
+    }
+
+    return result;
+}
+
+int SprayBrush::numParticleChunks(const ParticleDab &dab) const
+{
+    return (dab.particlesCount + particlesPerChunk - 1) / particlesPerChunk;
+}
+
+void SprayBrush::generateParticleChunk(const ParticleDab &dab, int chunk,
+                                       KisParticleWriteList *writes) const
+{
+    withDistributions(
+        [&] (const auto &angularDistribution, const auto &radialDistribution) {
+            generateParticleChunkImpl(dab, chunk, writes,
+                                      angularDistribution, radialDistribution);
+        });
+}
+
+namespace {
+
+inline int chunkSeed(quint32 dabSeed, int chunk)
+{
+    // the seeds of the neighbouring chunks should not be correlated
+    quint32 x = dabSeed + quint32(chunk) * 0x9e3779b9u;
+    x = (x ^ (x >> 16)) * 0x85ebca6bu;
+    x = (x ^ (x >> 13)) * 0xc2b2ae35u;
+    return int(x ^ (x >> 16));
+}
+
+}
+
+template <typename AngularDistribution, typename RadialDistribution>
+void SprayBrush::generateParticleChunkImpl(const ParticleDab &dab, int chunk,
+                                           KisParticleWriteList *writes,
+                                           const AngularDistribution &angularDistribution,
+                                           const RadialDistribution &radialDistribution) const
+{
+    if (!angularDistribution.isValid() || !radialDistribution.isValid()) {
+        return;
+    }
+
+    KisRandomSourceSP randomSource = new KisRandomSource(chunkSeed(dab.seed, chunk));
+
+    const quint32 firstParticle = quint32(chunk) * particlesPerChunk;
+    const quint32 lastParticle = qMin(dab.particlesCount, firstParticle + particlesPerChunk);
+
+    // the transformation is not thread-safe, every chunk has its own one
+    QScopedPointer<KoColorTransformation> transfo;
+    if (m_colorProperties->colorPerParticle && m_colorProperties->useRandomHSV) {
+        transfo.reset(dab.dab->colorSpace()->createColorTransformation("hsv_adjustment", QHash<QString, QVariant>()));
+    }
+
+    KoColor inkColor = dab.inkColor;
+    KisCrossDeviceColorSampler colorSampler(dab.source, inkColor);
+
+    auto writePixel =
+        [writes] (int px, int py, const quint8 *pixel) {
+            writes->addPixel(px, py, pixel);
+        };
+
+    const QTransform m = particleTransform(dab.rotation);
+
+    for (quint32 i = firstParticle; i < lastParticle; i++) {
+        const qreal angle = angularDistribution(randomSource) * M_PI * 2;
+        const qreal length = radialDistribution(randomSource);
+
+        qreal nx = (dab.radius * cos(angle)  * length);
+        qreal ny = (dab.radius * sin(angle)  * length);
+        ny *= m_sprayOpOption->data.aspect;
+        m.map(nx, ny, &nx, &ny);
+
+        nx += dab.center.x();
+        ny += dab.center.y();
+
+        if (m_colorProperties->colorPerParticle) {
+            inkColor = dab.color;
+            applyColorOptions(&inkColor, &colorSampler, nx, ny,
+                              dab.bgColor, dab.pressure, transfo.data(), randomSource);
+        }
+
+        if (m_shapeProperties->shape == 2) {
+            paintParticle(writePixel, inkColor, nx, ny);
+        } else {
+            writePixel(qRound(nx), qRound(ny), inkColor.data());
+        }
+    }
+}
+
+void SprayBrush::applyColorOptions(KoColor *inkColor,
+                                   KisCrossDeviceColorSampler *colorSampler,
+                                   qreal x, qreal y,
+                                   const KoColor &bgColor,
+                                   qreal pressure,
+                                   KoColorTransformation *transfo,
+                                   KisRandomSourceSP randomSource) const
+{
+    if (m_colorProperties->sampleInputColor) {
+        colorSampler->sampleOldColor(x, y, inkColor->data());
+    }
+
+    // mix the color with background color
+    if (m_colorProperties->mixBgColor) {
+        KoMixColorsOp * mixOp = inkColor->colorSpace()->mixColorsOp();
+
+        const quint8 *colors[2];
+        colors[0] = inkColor->data();
+        colors[1] = bgColor.data();
+
+        qint16 colorWeights[2];
+        int MAX_16BIT = 255;
+        qreal blend = pressure;
+
+        colorWeights[0] = static_cast<quint16>(blend * MAX_16BIT);
+        colorWeights[1] = static_cast<quint16>((1.0 - blend) * MAX_16BIT);
+        mixOp->mixColors(colors, colorWeights, 2, inkColor->data());
+    }
+
+    if (m_colorProperties->useRandomHSV && transfo) {
+        QHash<QString, QVariant> params;
+        params["h"] = (m_colorProperties->hue / 180.0) * randomSource->generateNormalized();
+        params["s"] = (m_colorProperties->saturation / 100.0) * randomSource->generateNormalized();
+        params["v"] = (m_colorProperties->value / 100.0) * randomSource->generateNormalized();
+        transfo->setParameters(params);
+        transfo->setParameter(3, 1);//sets the type to HSV. For some reason 0 is not an option.
+        transfo->setParameter(4, false);//sets the colorize to false.
+        transfo->transform(inkColor->data(), inkColor->data() , 1);
+    }
+
+    if (m_colorProperties->useRandomOpacity) {
+        quint8 alpha = qRound(randomSource->generateNormalized() * OPACITY_OPAQUE_U8);
+        inkColor->setOpacity(alpha);
+    }
+}
+
+QTransform SprayBrush::particleTransform(qreal rotation) const
+{
+    QTransform m;
+    m.rotateRadians(-rotation + deg2rad(m_sprayOpOption->data.brushRotation));
+    m.scale(m_sprayOpOption->data.scale, m_sprayOpOption->data.scale);
+    return m;
+}
+
+template <typename PixelWriter>
+void SprayBrush::paintParticle(PixelWriter writePixel, const KoColor &color, qreal rx, qreal ry) const
 {
     // opacity top left, right, bottom left, right
     KoColor pcolor(color);
@@ -437,20 +632,16 @@ void SprayBrush::paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor
     // Maybe some kind of compositing using here would be cool
 
     pcolor.setOpacity(btl);
-    writeAccessor->moveTo(ipx  , ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    writePixel(ipx, ipy, pcolor.data());
 
     pcolor.setOpacity(btr);
-    writeAccessor->moveTo(ipx + 1, ipy);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    writePixel(ipx + 1, ipy, pcolor.data());
 
     pcolor.setOpacity(bbl);
-    writeAccessor->moveTo(ipx, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    writePixel(ipx, ipy + 1, pcolor.data());
 
     pcolor.setOpacity(bbr);
-    writeAccessor->moveTo(ipx + 1, ipy + 1);
-    memcpy(writeAccessor->rawData(), pcolor.data(), m_dabPixelSize);
+    writePixel(ipx + 1, ipy + 1, pcolor.data());
 }
 
 void SprayBrush::paintCircle(KisPainter* painter, qreal x, qreal y, qreal radius)
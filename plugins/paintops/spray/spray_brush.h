@@ -11,6 +11,7 @@
 
 #include "kis_types.h"
 #include "kis_painter.h"
+#include <kis_cross_device_color_sampler.h>
 
 #include <brushengine/kis_random_source.h>
 #include "KisColorOptionData.h"
@@ -24,9 +25,11 @@
 
 
 #include <QImage>
+#include <QTransform>
 #include <kis_brush.h>
 
 class KisPaintInformation;
+class KisParticleWriteList;
 
 class SprayBrush
 {
@@ -51,6 +54,55 @@ public:
 
     void setFixedDab(KisFixedPaintDeviceSP dab);
 
+    /**
+     * The dab of pixel particles (\see KisSprayShapeOptionData::isPixelShape())
+     * that is rendered in concurrent jobs. The particles are split into chunks
+     * of particlesPerChunk items, every chunk has its own random stream seeded
+     * from \p seed, so the result doesn't depend on the number of threads.
+     */
+    struct ParticleDab {
+        KisPaintDeviceSP dab;
+        KisPaintDeviceSP source;
+        QPointF center;
+        qreal radius {1.0};
+        qreal rotation {0.0};
+        qreal pressure {1.0};
+        quint32 particlesCount {0};
+        quint32 seed {0};
+        KoColor color;
+        KoColor bgColor;
+
+        /// the color of all the particles, when the color is not per-particle
+        KoColor inkColor;
+    };
+
+    static const int particlesPerChunk = 1024;
+
+    bool canPaintConcurrently() const;
+
+    /**
+     * Does the sequential part of paint(): consumes the random values of
+     * \p info, fills the background of \p dab and calculates the seed of
+     * the particles. Should be called in the order of the dabs.
+     */
+    ParticleDab prepareParticleDab(KisPaintDeviceSP dab,
+                                   KisPaintDeviceSP source,
+                                   const KisPaintInformation& info,
+                                   qreal rotation,
+                                   qreal scale,
+                                   qreal additionalScale,
+                                   const KoColor &color,
+                                   const KoColor &bgColor);
+
+    int numParticleChunks(const ParticleDab &dab) const;
+
+    /**
+     * Generates the particles of \p chunk and puts them into \p writes.
+     * Different chunks can be generated concurrently.
+     */
+    void generateParticleChunk(const ParticleDab &dab, int chunk,
+                               KisParticleWriteList *writes) const;
+
 private:
     int m_dabSeqNo {0};
     KoColor m_inkColor;
@@ -75,16 +127,10 @@ private:
     KisFixedPaintDeviceSP m_fixedDab;
 
 private:
-    template <typename AngularDistribution>
-    void paintImpl(KisPaintDeviceSP dab,
-                   KisPaintDeviceSP source,
-                   const KisPaintInformation& info,
-                   qreal rotation,
-                   qreal scale,
-                   qreal additionalScale,
-                   const KoColor &color,
-                   const KoColor &bgColor,
-                   const AngularDistribution &angularDistribution);
+    /// calls \p func with the angular and radial distributions selected in the settings
+    template <typename Func>
+    void withDistributions(Func func) const;
+
     template <typename AngularDistribution, typename RadialDistribution>
     void paintImpl(KisPaintDeviceSP dab,
                    KisPaintDeviceSP source,
@@ -96,10 +142,28 @@ private:
                    const KoColor &bgColor,
                    const AngularDistribution &angularDistribution,
                    const RadialDistribution &radialDistribution);
+    template <typename AngularDistribution, typename RadialDistribution>
+    void generateParticleChunkImpl(const ParticleDab &dab, int chunk,
+                                   KisParticleWriteList *writes,
+                                   const AngularDistribution &angularDistribution,
+                                   const RadialDistribution &radialDistribution) const;
+
+    /// applies the color options to \p inkColor of the particle at (\p x, \p y)
+    void applyColorOptions(KoColor *inkColor,
+                           KisCrossDeviceColorSampler *colorSampler,
+                           qreal x, qreal y,
+                           const KoColor &bgColor,
+                           qreal pressure,
+                           KoColorTransformation *transfo,
+                           KisRandomSourceSP randomSource) const;
+
+    QTransform particleTransform(qreal rotation) const;
+
     /// rotation in radians according the settings (gauss distribution, uniform distribution or fixed angle)
     qreal rotationAngle(KisRandomSourceSP randomSource);
-    /// Paints Wu Particle
-    void paintParticle(KisRandomAccessorSP &writeAccessor, const KoColor &color, qreal rx, qreal ry);
+    /// Paints Wu Particle, \p writePixel is called with the position and the color of every pixel
+    template <typename PixelWriter>
+    void paintParticle(PixelWriter writePixel, const KoColor &color, qreal rx, qreal ry) const;
     void paintCircle(KisPainter * painter, qreal x, qreal y, qreal radius);
     void paintEllipse(KisPainter * painter, qreal x, qreal y, qreal a, qreal b, qreal angle);
     void paintRectangle(KisPainter * painter, qreal x, qreal y, qreal width, qreal height, qreal angle);
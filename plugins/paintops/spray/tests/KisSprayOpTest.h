@@ -0,0 +1,21 @@
+/*
+ *  SPDX-FileCopyrightText: 2024 Krita Developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSPRAYOPTEST_H
+#define KISSPRAYOPTEST_H
+
+#include <QtTest>
+
+class KisSprayOpTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+
+    void testAsynchronousRendering();
+    void testAsynchronousRendering_data();
+};
+
+#endif // KISSPRAYOPTEST_H